@@ -0,0 +1,150 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// cpu_features.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// It is not enough for the CPU to support AVX. The OS also has to save and restore the wider
+// registers on a context switch, which we check with xgetbv.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include "cpu_features.h"
+
+# if CPU_FEATURES_X86
+#   if defined( _MSC_VER )
+#     include <intrin.h>
+#   else
+#     include <cpuid.h>
+#   endif
+# endif
+
+// _______________________________________________________________________________________________
+//
+namespace cpu_features {
+// _______________________________________________________________________________________________
+
+namespace /* anonymous */ {
+
+# if CPU_FEATURES_X86
+
+  void
+get_cpuid( unsigned leaf, unsigned sub_leaf, unsigned regs[ 4 ])
+  //
+  // regs are eax, ebx, ecx, edx.
+{
+#   if defined( _MSC_VER )
+    int r[ 4 ];
+    __cpuidex( r, static_cast< int >( leaf), static_cast< int >( sub_leaf));
+    for ( int i = 0 ; i < 4 ; ++ i ) { regs[ i ] = static_cast< unsigned >( r[ i ]); }
+#   else
+    regs[ 0 ] = regs[ 1 ] = regs[ 2 ] = regs[ 3 ] = 0;
+    if ( static_cast< unsigned >( __get_cpuid_max( 0, 0)) >= leaf ) {
+        __cpuid_count( leaf, sub_leaf, regs[ 0 ], regs[ 1 ], regs[ 2 ], regs[ 3 ]);
+    }
+#   endif
+}
+
+  boost::uint64_t
+get_xcr0( )
+  //
+  // Only call this if cpuid says OSXSAVE is enabled.
+{
+#   if defined( _MSC_VER )
+    return _xgetbv( 0);
+#   else
+    boost::uint32_t lo = 0;
+    boost::uint32_t hi = 0;
+    __asm__ __volatile__ ( "xgetbv" : "=a" ( lo), "=d" ( hi) : "c" ( 0));
+    return (static_cast< boost::uint64_t >( hi) << 32) | lo;
+#   endif
+}
+
+  simd_level_type
+find_simd_level( )
+{
+    unsigned regs[ 4 ];
+    get_cpuid( 0, 0, regs);
+    unsigned const max_leaf = regs[ 0 ];
+    if ( max_leaf < 1 ) return e_scalar;
+
+    get_cpuid( 1, 0, regs);
+    bool const is_sse2    = 0 != (regs[ 3 ] & (1u << 26));
+    bool const is_osxsave = 0 != (regs[ 2 ] & (1u << 27));
+    bool const is_avx     = 0 != (regs[ 2 ] & (1u << 28));
+    if ( ! is_sse2 ) return e_scalar;
+    if ( (! is_osxsave) || (! is_avx) || (max_leaf < 7) ) return e_sse2;
+
+    // The OS must save the xmm and ymm registers (bits 1 and 2).
+    boost::uint64_t const xcr0 = get_xcr0( );
+    if ( 0x6 != (xcr0 & 0x6) ) return e_sse2;
+
+    get_cpuid( 7, 0, regs);
+    bool const is_avx2    = 0 != (regs[ 1 ] & (1u <<  5));
+    bool const is_avx512f = 0 != (regs[ 1 ] & (1u << 16));
+    if ( ! is_avx2 ) return e_sse2;
+
+    // The OS must also save the opmask and zmm registers (bits 5, 6 and 7).
+    if ( is_avx512f && (0xe0 == (xcr0 & 0xe0)) ) return e_avx512;
+    return e_avx2;
+}
+
+# else
+
+  simd_level_type
+find_simd_level( )
+{
+    return e_scalar;
+}
+
+# endif
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+
+  simd_level_type
+get_simd_level( )
+{
+    static simd_level_type const level = find_simd_level( );
+    return level;
+}
+
+  char const *
+get_simd_level_name( simd_level_type level)
+{
+    switch ( level ) {
+      case e_scalar : return "Scalar" ;
+      case e_sse2   : return "SSE2"   ;
+      case e_avx2   : return "AVX2"   ;
+      case e_avx512 : return "AVX-512";
+    }
+    d_assert( false);
+    return "";
+}
+
+// _______________________________________________________________________________________________
+//
+} /* end namespace cpu_features */
+// _______________________________________________________________________________________________
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// cpu_features.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,62 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// cpu_features.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef CPU_FEATURES_H
+# define CPU_FEATURES_H
+// _______________________________________________________________________________________________
+//
+//   Finds out, at run time, which vector instruction sets the CPU (and the OS) support.
+//   The solver kernels use this to pick the fastest version of themselves
+//   (see finite_diff_simd.h).
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#   define CPU_FEATURES_X86 1
+# else
+#   define CPU_FEATURES_X86 0
+# endif
+
+namespace cpu_features {
+
+// _______________________________________________________________________________________________
+
+  enum
+simd_level_type
+  //
+  // Ordered, so (a < b) means b has everything a has.
+{   e_scalar
+  , e_sse2
+  , e_avx2
+  , e_avx512
+};
+
+// The best level this CPU supports. Calculated once, the first time you ask.
+simd_level_type  get_simd_level( )                       ;
+
+// Name for the UI, like "AVX2".
+char const *     get_simd_level_name( simd_level_type )  ;
+
+} /* end namespace cpu_features */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef CPU_FEATURES_H
+//
+// cpu_features.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
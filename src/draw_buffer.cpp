@@ -0,0 +1,91 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// draw_buffer.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include "draw_buffer.h"
+
+// _______________________________________________________________________________________________
+
+  /* ctor */
+  draw_buffer_type::
+draw_buffer_type( )
+  //
+  // Nothing is published yet. take_latest( ) returns an empty (reset) sheet until something is.
+  : middle_state_ ( 1)
+  , back_index_   ( 2)
+  , front_index_  ( 0)
+  , x_draw_size_  ( 0)
+  , y_draw_size_  ( 0)
+{
+}
+
+// _______________________________________________________________________________________________
+
+  void
+  draw_buffer_type::
+set_draw_size( size_type x_count, size_type y_count)
+{
+    d_assert( (0 == x_count) == (0 == y_count));
+    x_draw_size_ = x_count;
+    y_draw_size_ = y_count;
+}
+
+  void
+  draw_buffer_type::
+publish( sheet_type const & src)
+{
+    d_assert( src.not_reset( ));
+
+    // Fill the back slot. Nobody else looks at it.
+    sheet_type & back = sheets_[ back_index_ ];
+    if ( 0 == x_draw_size_ ) {
+        back = src;
+    } else {
+        if ( (back.get_x_count( ) != x_draw_size_) || (back.get_y_count( ) != y_draw_size_) ) {
+            d_verify( back.set_xy_counts_raw_values( x_draw_size_, y_draw_size_));
+        }
+        d_verify( sheet_type::copy_preserve_heights( src, back));
+    }
+
+    // Swap it into the middle. The ordered exchange makes sure the drawing thread sees the
+    // values we just wrote. What was in the middle becomes the new back slot.
+    int const old_state = middle_state_.fetchAndStoreOrdered( back_index_ | e_fresh_bit);
+    back_index_ = old_state & e_index_mask;
+}
+
+// _______________________________________________________________________________________________
+
+  sheet_type const &
+  draw_buffer_type::
+take_latest( )
+{
+    // Only swap if the middle has something new. Otherwise we'd swap back an older sheet.
+    // If the publisher swaps in an even newer sheet after we look, we get that one.
+    if ( middle_state_.fetchAndAddOrdered( 0) & e_fresh_bit ) {
+        int const old_state = middle_state_.fetchAndStoreOrdered( front_index_);
+        front_index_ = old_state & e_index_mask;
+    }
+    return sheets_[ front_index_ ];
+}
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// draw_buffer.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,102 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// draw_buffer.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef DRAW_BUFFER_H
+# define DRAW_BUFFER_H
+// _______________________________________________________________________________________________
+//
+//   Three sheets that hand finished generations from the solver to the drawing code.
+//
+//   One thread publishes: it writes a sheet into the back slot and then swaps the back slot with
+//   the middle one. The drawing thread takes: if the middle slot has something new it swaps it
+//   with the front slot, and then draws the front. The swaps are a single atomic exchange, so
+//   neither side ever waits for the other, and the drawing side always gets the latest sheet.
+//
+//   The published sheet is a copy of the solved sheet, shrunk to the draw size when the draw
+//   size is limited, so the drawing code never reads a sheet the solver is working on.
+//
+//   Only one thread can publish at a time. The solver's worker thread publishes during a solve
+//   and the UI thread publishes at other times. The queued signals between them keep the two
+//   from overlapping.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "sheet.h"
+# include <QtCore/QAtomicInt>
+
+// _______________________________________________________________________________________________
+
+  class
+draw_buffer_type
+{
+  public:
+    typedef sheet_type::size_type  size_type ;
+
+  // ---------------------------------------------------------------------------------------
+  // Ctor
+  public:
+    /* ctor */      draw_buffer_type( )                            ;
+
+  // Disable copy
+  private:
+    /* copy */      draw_buffer_type(  draw_buffer_type const &)   ; // no implementation
+    void            operator =( draw_buffer_type const &)          ; // no implementation
+
+  // ---------------------------------------------------------------------------------------
+  // Publish side
+  public:
+    // The size of the published sheets. Zeros mean the full size of the sheet published.
+    // Only change this from the publishing side, when nobody else is publishing.
+    void            set_draw_size( size_type x_count, size_type y_count) ;
+    size_type       get_x_draw_size( )                       const { return x_draw_size_; }
+    size_type       get_y_draw_size( )                       const { return y_draw_size_; }
+
+    void            publish( sheet_type const &)                   ;
+
+  // ---------------------------------------------------------------------------------------
+  // Draw side
+  public:
+    // The latest published sheet. This stays put until the next call, even if more sheets are
+    // published in the meantime.
+    sheet_type const &
+                    take_latest( )                                 ;
+
+  // ---------------------------------------------------------------------------------------
+  // Member vars
+  private:
+    enum { e_index_mask = 3, e_fresh_bit = 4 };
+
+    sheet_type      sheets_[ 3 ]    ;
+
+    // The middle slot index, plus e_fresh_bit when it has not been taken yet.
+    QAtomicInt      middle_state_   ;
+
+    int             back_index_     ; /* publish side only */
+    int             front_index_    ; /* draw side only */
+
+    size_type       x_draw_size_    ; /* publish side only */
+    size_type       y_draw_size_    ;
+
+}; /* end class draw_buffer_type */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef DRAW_BUFFER_H
+//
+// draw_buffer.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
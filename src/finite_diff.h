@@ -32,7 +32,12 @@
 
 # include <iterator>
 # include <algorithm>
+# include <vector>
+# include <limits>
+# include <cstddef>
 # include "tri_diag.h"
+# include "uniform_scalar.h"
+# include "finite_diff_simd.h"
 
 // This #define is here so we can experiment with solves will rates like -1 or 2, that blow up.
 // This is also defined in other files.
@@ -83,6 +88,29 @@ assign3_damping_type
       RATE_TYPE const one_minus_damp_;
 };
 
+  template< typename ASSIGN3_FUNCTOR_TYPE, typename ITEM_TYPE >
+  struct
+assign3_clamp_type
+  //
+  // Wraps one of the above and clamps the result to [-limit, +limit]. Use this when the solve
+  // might blow up (see clamp_limit below).
+  //
+  // The tests are in the same order as min(..) and then max(..) in the vector kernels, so a NaN
+  // becomes +limit in both.
+{
+    void operator ()( ITEM_TYPE & trg, ITEM_TYPE const & src, ITEM_TYPE const & side)
+      { assign3_( trg, src, side);
+        trg = (trg < hi_) ? trg : hi_;
+        trg = (trg > lo_) ? trg : lo_;
+      }
+
+    assign3_clamp_type( ASSIGN3_FUNCTOR_TYPE const & assign3, ITEM_TYPE const & limit)
+      : assign3_( assign3), lo_( - limit), hi_( limit) { }
+      ASSIGN3_FUNCTOR_TYPE        assign3_ ;
+      ITEM_TYPE            const  lo_      ;
+      ITEM_TYPE            const  hi_      ;
+};
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 // Damping function to use with backward and central diff
@@ -149,6 +177,78 @@ init_wave_damping
     }
 }
 
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Leapfrog wave
+//
+//   The wave solves above keep the older generation in trg, and the assign3 functors work out
+//   to trg = side + ((1 - damping) * (src - history)). The leapfrog wave keeps the velocity
+//   (src - history) in a sheet of its own instead, so nothing has to be copied around to set up
+//   the history. It is the same step written as
+//     velocity = ((1 - damping) * velocity) + (side - src)
+//     trg      = src + velocity
+//   where side is what the heat step (a solve with damping 1) puts in trg.
+//
+// calc_leapfrog_velocity
+//  (  damping, count
+//   , src_iter, velocity_iter, trg_iter
+//   , clamp_limit
+//  )
+//
+//   Finishes the wave step for count cells, after the heat step has filled trg. If clamp_limit
+//   is not zero trg is clamped, and the velocity is how far the cell actually moved.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  void
+calc_leapfrog_velocity
+ (  RATE_TYPE      const  damping
+  , std::ptrdiff_t        count
+  , SRC_ITER_TYPE         src_iter
+  , TRG_ITER_TYPE         velocity_iter
+  , TRG_ITER_TYPE         trg_iter
+  , RATE_TYPE      const  clamp_limit
+ )
+{
+    // Use the vector kernel if the rows are contiguous floats (see finite_diff_simd.h).
+    if ( simd::try_calc_leapfrog_velocity( damping, count, src_iter, velocity_iter, trg_iter, clamp_limit) ) {
+        return;
+    }
+
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+    item_type const  one_minus_damp  = static_cast< item_type >( static_cast< RATE_TYPE >( 1) - damping);
+    item_type const  hi              = static_cast< item_type >(   clamp_limit );
+    item_type const  lo              = static_cast< item_type >( - clamp_limit );
+
+    if ( clamp_limit == 0 ) {
+        for ( ; count > 0 ; -- count ) {
+            item_type const src       = *src_iter;
+            item_type const velocity  = (one_minus_damp * (*velocity_iter)) + (*trg_iter - src);
+            *velocity_iter  = velocity;
+            *trg_iter       = src + velocity;
+            ++ src_iter;
+            ++ velocity_iter;
+            ++ trg_iter;
+        }
+    } else {
+        // Same tests, in the same order, as assign3_clamp_type.
+        for ( ; count > 0 ; -- count ) {
+            item_type const  src  = *src_iter;
+            item_type        trg  = src + ((one_minus_damp * (*velocity_iter)) + (*trg_iter - src));
+            trg = (trg < hi) ? trg : hi;
+            trg = (trg > lo) ? trg : lo;
+            *velocity_iter  = trg - src;
+            *trg_iter       = trg;
+            ++ src_iter;
+            ++ velocity_iter;
+            ++ trg_iter;
+        }
+    }
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 // calc_forward_diff_..(..)
@@ -201,10 +301,10 @@ calc_forward_diff_2d_middle_
         ++ src_iter_side_a;
         ++ src_iter_side_b;
 
-        // If the src has only one cell we should just copy to the trg.
+        // If the src has only one cell it only mixes with the sides.
         // This does not leak heat off the edges.
         if ( src_iter == src_iter_limit ) {
-            assign3_functor( *trg_iter, src_0, src_0 + side_contrib);
+            assign3_functor( *trg_iter, src_0, ((base - (rate_side + rate_side)) * src_0) + side_contrib);
         }
         else {
             d_assert( src_iter < src_iter_limit);
@@ -303,10 +403,10 @@ calc_forward_diff_2d_edge_
         item_type side_contrib = (*src_iter_side) * rate_side;
         ++ src_iter_side;
 
-        // If the src has only one cell we should just copy to the trg.
+        // If the src has only one cell it only mixes with the sides.
         // This does not leak heat off the edges.
         if ( src_iter == src_iter_limit ) {
-            assign3_functor( *trg_iter, src_0, src_0 + side_contrib);
+            assign3_functor( *trg_iter, src_0, ((base - rate_side) * src_0) + side_contrib);
         }
         else {
             d_assert( src_iter < src_iter_limit);
@@ -452,9 +552,139 @@ calc_forward_diff_thin_strip_
     }
 }
 
+// _______________________________________________________________________________________________
+// calc_forward_diff_..._maybe_clamp_(..)
+//
+//   Same as the calc_forward_diff_..._(..) functions above, with an extra clamp_limit param.
+//   If clamp_limit is zero these are the same. Otherwise they wrap assign3_functor in
+//   assign3_clamp_type<..>, so the clamp happens as each value is stored.
+
+  template
+   <  typename ASSIGN3_FUNCTOR_TYPE
+    , typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  void
+calc_forward_diff_2d_middle_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE  const &  assign3_functor
+  , RATE_TYPE             const    rate
+  , RATE_TYPE             const    rate_side
+  , SRC_ITER_TYPE         const &  src_iter
+  , SRC_ITER_TYPE         const &  src_iter_limit
+  , SRC_ITER_TYPE         const &  src_iter_side_a
+  , SRC_ITER_TYPE         const &  src_iter_side_b
+  , TRG_ITER_TYPE         const &  trg_iter
+  , RATE_TYPE             const    clamp_limit
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_2d_middle_
+         (  assign3_functor
+          , rate, rate_side
+          , src_iter, src_iter_limit
+          , src_iter_side_a
+          , src_iter_side_b
+          , trg_iter
+         );
+    } else {
+        calc_forward_diff_2d_middle_
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE, item_type >( assign3_functor, clamp_limit)
+          , rate, rate_side
+          , src_iter, src_iter_limit
+          , src_iter_side_a
+          , src_iter_side_b
+          , trg_iter
+         );
+    }
+}
+
+  template
+   <  typename ASSIGN3_FUNCTOR_TYPE
+    , typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  void
+calc_forward_diff_2d_edge_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE  const &  assign3_functor
+  , RATE_TYPE             const    rate
+  , RATE_TYPE             const    rate_side
+  , SRC_ITER_TYPE         const &  src_iter
+  , SRC_ITER_TYPE         const &  src_iter_limit
+  , SRC_ITER_TYPE         const &  src_iter_side
+  , TRG_ITER_TYPE         const &  trg_iter
+  , RATE_TYPE             const    clamp_limit
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_2d_edge_
+         (  assign3_functor
+          , rate, rate_side
+          , src_iter, src_iter_limit
+          , src_iter_side
+          , trg_iter
+         );
+    } else {
+        calc_forward_diff_2d_edge_
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE, item_type >( assign3_functor, clamp_limit)
+          , rate, rate_side
+          , src_iter, src_iter_limit
+          , src_iter_side
+          , trg_iter
+         );
+    }
+}
+
+  template
+   <  typename ASSIGN3_FUNCTOR_TYPE
+    , typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  void
+calc_forward_diff_thin_strip_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE  const &  assign3_functor
+  , RATE_TYPE             const    base
+  , RATE_TYPE             const    rate
+  , SRC_ITER_TYPE         const &  src_iter
+  , SRC_ITER_TYPE         const &  src_iter_limit
+  , TRG_ITER_TYPE         const &  trg_iter
+  , RATE_TYPE             const    clamp_limit
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_thin_strip_
+         (  assign3_functor
+          , base
+          , rate
+          , src_iter, src_iter_limit
+          , trg_iter
+         );
+    } else {
+        calc_forward_diff_thin_strip_
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE, item_type >( assign3_functor, clamp_limit)
+          , base
+          , rate
+          , src_iter, src_iter_limit
+          , trg_iter
+         );
+    }
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 // calc_next_generation_forward_difference_2d_..(..)
+//
+//   clamp_limit is zero unless the solve might blow up (a wave, or rates past the stability
+//   limit). Otherwise each result is clamped to [-clamp_limit, +clamp_limit] as it is stored,
+//   so the caller does not need another pass over the sheet to keep it in bounds.
 
 // _______________________________________________________________________________________________
 // calc_next_generation_forward_difference_2d_middle
@@ -463,6 +693,7 @@ calc_forward_diff_thin_strip_
 //   , src_iter, src_iter_limit
 //   , src_iter_side_a, src_iter_side_b
 //   , trg_iter
+//   , clamp_limit
 //  )
 
   template
@@ -480,40 +711,57 @@ calc_next_generation_forward_difference_2d_middle
   , SRC_ITER_TYPE const &  src_iter_side_a  // previous state, not changed, next to src iter
   , SRC_ITER_TYPE const &  src_iter_side_b  // previous state, not changed, next to src iter
   , TRG_ITER_TYPE const &  trg_iter         // result, same size as src
+  , RATE_TYPE     const    clamp_limit      // zero means no clamp
  )
 {
     d_assert( get_no_init_damping_set_value< RATE_TYPE >( ) != damping);
     d_assert( get_no_init_damping_sum_value< RATE_TYPE >( ) != damping);
 
+    // Use the vector kernel if the rows are contiguous floats (see finite_diff_simd.h).
+    if ( simd::try_calc_forward_diff_2d_middle
+          (  damping, rate, rate_side
+           , src_iter, src_iter_limit
+           , src_iter_side_a
+           , src_iter_side_b
+           , trg_iter
+           , clamp_limit
+          ) )
+    {
+        return;
+    }
+
     typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
 
     if ( damping == 0 ) {
-        calc_forward_diff_2d_middle_
+        calc_forward_diff_2d_middle_maybe_clamp_
          (  assign3_src_minus_trg_type< item_type >( )
           , rate, rate_side
           , src_iter, src_iter_limit
           , src_iter_side_a
           , src_iter_side_b
           , trg_iter
+          , clamp_limit
          );
     } else
     if ( damping == 1 ) {
-        calc_forward_diff_2d_middle_
+        calc_forward_diff_2d_middle_maybe_clamp_
          (  assign3_set_type< item_type >( )
           , rate, rate_side
           , src_iter, src_iter_limit
           , src_iter_side_a
           , src_iter_side_b
           , trg_iter
+          , clamp_limit
          );
     } else {
-        calc_forward_diff_2d_middle_
+        calc_forward_diff_2d_middle_maybe_clamp_
          (  assign3_damping_type< item_type, RATE_TYPE >( damping)
           , rate, rate_side
           , src_iter, src_iter_limit
           , src_iter_side_a
           , src_iter_side_b
           , trg_iter
+          , clamp_limit
          );
     }
 }
@@ -524,6 +772,7 @@ calc_next_generation_forward_difference_2d_middle
 //   , src_iter, src_iter_limit
 //   , src_iter_side
 //   , trg_iter
+//   , clamp_limit
 //  )
 
   template
@@ -540,37 +789,53 @@ calc_next_generation_forward_difference_2d_edge
   , SRC_ITER_TYPE const &  src_iter_limit  // one past the end
   , SRC_ITER_TYPE const &  src_iter_side   // previous state, not changed, next to src iter
   , TRG_ITER_TYPE const &  trg_iter        // result, same size as src
+  , RATE_TYPE     const    clamp_limit     // zero means no clamp
  )
 {
     d_assert( get_no_init_damping_set_value< RATE_TYPE >( ) != damping);
     d_assert( get_no_init_damping_sum_value< RATE_TYPE >( ) != damping);
 
+    // Use the vector kernel if the rows are contiguous floats (see finite_diff_simd.h).
+    if ( simd::try_calc_forward_diff_2d_edge
+          (  damping, rate, rate_side
+           , src_iter, src_iter_limit
+           , src_iter_side
+           , trg_iter
+           , clamp_limit
+          ) )
+    {
+        return;
+    }
+
     typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
 
     if ( damping == 0 ) {
-        calc_forward_diff_2d_edge_
+        calc_forward_diff_2d_edge_maybe_clamp_
          (  assign3_src_minus_trg_type< item_type >( )
           , rate, rate_side
           , src_iter, src_iter_limit
           , src_iter_side
           , trg_iter
+          , clamp_limit
          );
     } else
     if ( damping == 1 ) {
-        calc_forward_diff_2d_edge_
+        calc_forward_diff_2d_edge_maybe_clamp_
          (  assign3_set_type< item_type >( )
           , rate, rate_side
           , src_iter, src_iter_limit
           , src_iter_side
           , trg_iter
+          , clamp_limit
          );
     } else {
-        calc_forward_diff_2d_edge_
+        calc_forward_diff_2d_edge_maybe_clamp_
          (  assign3_damping_type< item_type, RATE_TYPE >( damping)
           , rate, rate_side
           , src_iter, src_iter_limit
           , src_iter_side
           , trg_iter
+          , clamp_limit
          );
     }
 }
@@ -580,6 +845,7 @@ calc_next_generation_forward_difference_2d_edge
 //  (  damping, rate
 //   , src_iter, src_iter_limit
 //   , trg_iter
+//   , clamp_limit
 //  )
 
   template
@@ -594,6 +860,7 @@ calc_next_generation_forward_difference_2d_thin_strip
   , SRC_ITER_TYPE const &  src_iter        // previous state, not changed, can be same as trg_iter
   , SRC_ITER_TYPE const &  src_iter_limit  // one past the end
   , TRG_ITER_TYPE const &  trg_iter        // result, same size as src
+  , RATE_TYPE     const    clamp_limit     // zero means no clamp
  )
 {
     d_assert( get_no_init_damping_set_value< RATE_TYPE >( ) != damping);
@@ -602,125 +869,930 @@ calc_next_generation_forward_difference_2d_thin_strip
     typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
     RATE_TYPE const base = 1;
 
+    // Use the vector kernel if the row is contiguous floats (see finite_diff_simd.h).
+    if ( simd::try_calc_forward_diff_thin_strip( damping, base, rate, src_iter, src_iter_limit, trg_iter, clamp_limit) ) {
+        return;
+    }
+
     if ( damping == 0 ) {
-        calc_forward_diff_thin_strip_
+        calc_forward_diff_thin_strip_maybe_clamp_
          (  assign3_src_minus_trg_type< item_type >( )
           , base
           , rate
           , src_iter, src_iter_limit
           , trg_iter
+          , clamp_limit
          );
     } else
     if ( damping == 1 ) {
-        calc_forward_diff_thin_strip_
+        calc_forward_diff_thin_strip_maybe_clamp_
          (  assign3_set_type< item_type >( )
           , base
           , rate
           , src_iter, src_iter_limit
           , trg_iter
+          , clamp_limit
          );
     } else {
-        calc_forward_diff_thin_strip_
+        calc_forward_diff_thin_strip_maybe_clamp_
          (  assign3_damping_type< item_type, RATE_TYPE >( damping)
           , base
           , rate
           , src_iter, src_iter_limit
           , trg_iter
+          , clamp_limit
          );
     }
 }
 
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
-// calc_next_generation_forward_difference_1d
-//  (  rate
-//   , src_iter, src_iter_limit
+// Wide forward-diff stencils
+//
+//   The 2d functions above use the 5-point stencil: a cell and its 4 neighbors. These use more
+//   neighbors, so the error is smaller or less lopsided. They are still forward diff, and they
+//   have their own stability limits (see heat_solver::get_stable_rate_fraction(..)).
+//
+//   9 point (isotropic). Adds the corners with the cross term:
+//     side = src + rate*dxx + rate_side*dyy + ((rate + rate_side)/12)*dxx*dyy
+//   With equal rates this is the usual [1 4 1, 4 -20 4, 1 4 1]/6 stencil, where the leading
+//   error does not depend on direction, so round spots stay round.
+//
+//   4th order. Uses 2 cells each way along each axis:
+//     side = src + (rate/12)*(16*(x-1 + x+1) - (x-2 + x+2) - 30*x) + (same for y with rate_side)
+//
+//   The cells past the insulated edges mirror the cells just inside (index -1 is 0, -2 is 1,
+//   count is count-1, and so on). Like the 5-point edges, this does not leak heat. The caller
+//   passes in all 5 rows [y-2, y-1, y, y+1, y+2], already mirrored at the top and bottom, and
+//   we mirror the columns here. The 9-point stencil ignores the outer two rows.
+
+  enum
+stencil_type
+ {  e_stencil_5_point
+  , e_stencil_9_point
+  , e_stencil_4th_order
+ };
+
+  inline
+  std::ptrdiff_t
+get_mirror_index( std::ptrdiff_t index, std::ptrdiff_t const count)
+  //
+  // Folds an index that may be past either edge back into [0, count).
+{
+    d_assert( count > 0);
+    std::ptrdiff_t const period = 2 * count;
+    index %= period;
+    if ( index < 0 ) index += period;
+    return (index < count) ? index : (period - 1 - index);
+}
+
+// _______________________________________________________________________________________________
+// calc_forward_diff_9_point_cell_(..)
+// calc_forward_diff_4th_order_cell_(..)
+//
+//   One cell of the wide stencils. The vector kernels (finite_diff_simd_kernels.h) use these
+//   for the edge cells, and repeat the same operations in the same order for the middle cells.
+
+  template< typename ITEM_TYPE, typename RATE_TYPE >
+  inline
+  ITEM_TYPE
+calc_forward_diff_9_point_cell_
+ (  RATE_TYPE const  rate
+  , RATE_TYPE const  rate_side
+  , RATE_TYPE const  rate_corner  /* (rate + rate_side) / 12 */
+  , ITEM_TYPE const  a_lo, ITEM_TYPE const  a_mid, ITEM_TYPE const  a_hi  /* side a row */
+  , ITEM_TYPE const  c_lo, ITEM_TYPE const  c_mid, ITEM_TYPE const  c_hi  /* src row */
+  , ITEM_TYPE const  b_lo, ITEM_TYPE const  b_mid, ITEM_TYPE const  b_hi  /* side b row */
+ )
+{
+    ITEM_TYPE const  dy_lo   = (a_lo  + b_lo ) - (c_lo  + c_lo );
+    ITEM_TYPE const  dy_mid  = (a_mid + b_mid) - (c_mid + c_mid);
+    ITEM_TYPE const  dy_hi   = (a_hi  + b_hi ) - (c_hi  + c_hi );
+    ITEM_TYPE const  dx      = (c_lo  + c_hi ) - (c_mid + c_mid);
+    ITEM_TYPE const  dxy     = (dy_lo + dy_hi) - (dy_mid + dy_mid);
+    return c_mid + (((rate * dx) + (rate_side * dy_mid)) + (rate_corner * dxy));
+}
+
+  template< typename ITEM_TYPE, typename RATE_TYPE >
+  inline
+  ITEM_TYPE
+calc_forward_diff_4th_order_cell_
+ (  RATE_TYPE const  rate_12       /* rate / 12 */
+  , RATE_TYPE const  rate_side_12  /* rate_side / 12 */
+  , ITEM_TYPE const  x_lo_2, ITEM_TYPE const  x_lo_1, ITEM_TYPE const  src
+  , ITEM_TYPE const  x_hi_1, ITEM_TYPE const  x_hi_2
+  , ITEM_TYPE const  y_lo_2, ITEM_TYPE const  y_lo_1
+  , ITEM_TYPE const  y_hi_1, ITEM_TYPE const  y_hi_2
+ )
+{
+    ITEM_TYPE const  sixteen  = 16;
+    ITEM_TYPE const  thirty   = 30;
+    ITEM_TYPE const  dx       = (((x_lo_1 + x_hi_1) * sixteen) - (x_lo_2 + x_hi_2)) - (src * thirty);
+    ITEM_TYPE const  dy       = (((y_lo_1 + y_hi_1) * sixteen) - (y_lo_2 + y_hi_2)) - (src * thirty);
+    return src + ((rate_12 * dx) + (rate_side_12 * dy));
+}
+
+// _______________________________________________________________________________________________
+// calc_forward_diff_2d_wide_
+//  (  assign3_functor
+//   , stencil
+//   , rate, rate_side
+//   , p_rows, count
 //   , trg_iter
 //  )
 
   template
-   <  typename RATE_TYPE      // double, float
-    , typename SRC_ITER_TYPE  // std::vector< float >::const_iterator
-    , typename TRG_ITER_TYPE  // std::vector< float >::iterator
+   <  typename ASSIGN3_FUNCTOR_TYPE
+    , typename RATE_TYPE        // double, float
+    , typename SRC_ITER_TYPE    // std::vector< float >::const_iterator
+    , typename TRG_ITER_TYPE    // std::vector< float >::iterator
    >
   void
-calc_next_generation_forward_difference_1d
- (  RATE_TYPE     const    rate            // 0 < rate <= 0.5
-  , SRC_ITER_TYPE const &  src_iter        // previous state
-  , SRC_ITER_TYPE const &  src_iter_limit  // one past the end
-  , TRG_ITER_TYPE const &  trg_iter        // result, as big as src
+calc_forward_diff_2d_wide_
+ (  ASSIGN3_FUNCTOR_TYPE  assign3_functor
+  , stencil_type const    stencil
+  , RATE_TYPE const       rate
+  , RATE_TYPE const       rate_side
+  , SRC_ITER_TYPE const * p_rows  // 5 rows [y-2 .. y+2], previous state, not changed
+  , std::ptrdiff_t const  count
+  , TRG_ITER_TYPE         trg_iter        // result, same size as the rows, not one of the rows
  )
 {
     typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
 
-    // For each value in src, calculate a value and store it in trg (where r is the rate):
-    //   trg[i] <- (1 - 2r)src[i] + r(src[i-1] + src[i+1])
-    // Treat the rate values off the ends as zero, so as not to spill heat off the edges.
-    //   trg[0] <- (1 - r)src[0] + r(src[1])
-    //   trg[count-1] <- (1 - r)src[count-1] + r(src[count-2])
-    RATE_TYPE const base = 1;
-    calc_forward_diff_thin_strip_
-     (  assign3_set_type< item_type >( )
-      , base
-      , rate
-      , src_iter, src_iter_limit
-      , trg_iter
-     );
+    SRC_ITER_TYPE const &  y_lo_2  = p_rows[ 0 ];
+    SRC_ITER_TYPE const &  y_lo_1  = p_rows[ 1 ];
+    SRC_ITER_TYPE const &  src     = p_rows[ 2 ];
+    SRC_ITER_TYPE const &  y_hi_1  = p_rows[ 3 ];
+    SRC_ITER_TYPE const &  y_hi_2  = p_rows[ 4 ];
+
+    if ( stencil == e_stencil_9_point ) {
+        RATE_TYPE const rate_corner = (rate + rate_side) / 12;
+        for ( std::ptrdiff_t index = 0 ; index < count ; ++ index, ++ trg_iter ) {
+            std::ptrdiff_t const  lo  = get_mirror_index( index - 1, count);
+            std::ptrdiff_t const  hi  = get_mirror_index( index + 1, count);
+            item_type const src_mid = *(src + index);
+            assign3_functor( *trg_iter, src_mid,
+                calc_forward_diff_9_point_cell_< item_type, RATE_TYPE >
+                 (  rate, rate_side, rate_corner
+                  , *(y_lo_1 + lo), *(y_lo_1 + index), *(y_lo_1 + hi)
+                  , *(src    + lo), src_mid          , *(src    + hi)
+                  , *(y_hi_1 + lo), *(y_hi_1 + index), *(y_hi_1 + hi)
+                 ));
+        }
+    } else {
+        d_assert( stencil == e_stencil_4th_order);
+        RATE_TYPE const  rate_12       = rate      / 12;
+        RATE_TYPE const  rate_side_12  = rate_side / 12;
+        for ( std::ptrdiff_t index = 0 ; index < count ; ++ index, ++ trg_iter ) {
+            item_type const src_mid = *(src + index);
+            assign3_functor( *trg_iter, src_mid,
+                calc_forward_diff_4th_order_cell_< item_type, RATE_TYPE >
+                 (  rate_12, rate_side_12
+                  , *(src + get_mirror_index( index - 2, count))
+                  , *(src + get_mirror_index( index - 1, count))
+                  , src_mid
+                  , *(src + get_mirror_index( index + 1, count))
+                  , *(src + get_mirror_index( index + 2, count))
+                  , *(y_lo_2 + index), *(y_lo_1 + index)
+                  , *(y_hi_1 + index), *(y_hi_2 + index)
+                 ));
+        }
+    }
 }
 
-// _______________________________________________________________________________________________
-// _______________________________________________________________________________________________
-// calc_matrix_diagonal( base, rate, src_iter, src_iter_limit, diag_iter)
-
   template
-   <  typename RATE_TYPE
+   <  typename ASSIGN3_FUNCTOR_TYPE
+    , typename RATE_TYPE
     , typename SRC_ITER_TYPE
-    , typename DIAG_ITER_TYPE
+    , typename TRG_ITER_TYPE
    >
-  size_t /* returns count */
-calc_matrix_diagonal
- (  RATE_TYPE const  base           // 1 (for backward diff) or 2 (for central diff)
-  , RATE_TYPE const  rate           // 0 < rate
-  , SRC_ITER_TYPE    src_iter       // previous state
-  , SRC_ITER_TYPE    src_iter_limit // one past the end
-  , DIAG_ITER_TYPE   diag_iter      // return, as big as (src_iter_limit - src_iter)
+  void
+calc_forward_diff_2d_wide_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE  const &  assign3_functor
+  , stencil_type          const    stencil
+  , RATE_TYPE             const    rate
+  , RATE_TYPE             const    rate_side
+  , SRC_ITER_TYPE         const *  p_rows
+  , std::ptrdiff_t        const    count
+  , TRG_ITER_TYPE         const &  trg_iter
+  , RATE_TYPE             const    clamp_limit
  )
 {
-    // carry_middle (1 + 2r) is all the middle values of the diagonal.
-    // carry_edge (1 + r) is used at the two ends, which are floating and insulated and conserves energy.
-    RATE_TYPE const carry_edge   = base + rate;
-    RATE_TYPE const carry_middle = carry_edge + rate;
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
 
-    // Fill in the diagonal, and count at the same time.
-    // Set the first and last values in the diagonal to the edge values.
-    // If we had the count we'd do this instead:
-    //   if ( count > 1 ) {
-    //     (*diag_iter) = carry_edge;
-    //     if ( count > 2 ) {
-    //       std::fill_n( diag_iter + 1, count - 2, carry_middle);
-    //       (*(diag_iter + (count - 1))) = carry_edge;
-    //   } }
-    //
-    // If rate was a vector of count-2 values (one value for each boundaries between cells),
-    // we'd still use (- rate) for both the super- and sub-diagonals, and the diagonal values
-    // would be:
-    //   diag[ 0 ] = 1 + r[ 0 ]
-    //   diag[ i ] = 1 + r[ i-1 ] + r[ i ]
-    //   diag[ count-1 ] = 1 + r[ count-2 ]
-    //
-    // Speedup: The caller could pre-calc the diag, along with the count.
-    // But we'd still have to copy the diag to a scratch buffer, so the savings is slight.
-    // And remember rate should really be a vector and not a single value.
-    // Of course if rate is a vector, we could pre-calculate the carry edges for every cell border
-    // in the entire sheet. (Rates only apply to cell borders, not to the cells themselves.)
-    size_t count = 0;
-    if ( src_iter < src_iter_limit ) {
-        (*diag_iter) = carry_edge;
-        ++ count;
-        ++ src_iter;
-        ++ diag_iter;
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_2d_wide_
+         (  assign3_functor
+          , stencil, rate, rate_side
+          , p_rows, count
+          , trg_iter
+         );
+    } else {
+        calc_forward_diff_2d_wide_
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE, item_type >( assign3_functor, clamp_limit)
+          , stencil, rate, rate_side
+          , p_rows, count
+          , trg_iter
+         );
+    }
+}
 
-        if ( src_iter < src_iter_limit ) {
+// _______________________________________________________________________________________________
+// calc_next_generation_forward_difference_2d_wide
+//  (  stencil
+//   , damping, rate, rate_side
+//   , p_rows, src_iter_limit
+//   , trg_iter
+//   , clamp_limit
+//  )
+
+  template
+   <  typename RATE_TYPE        // double, float
+    , typename SRC_ITER_TYPE    // std::vector< float >::const_iterator
+    , typename TRG_ITER_TYPE    // std::vector< float >::iterator
+   >
+  void
+calc_next_generation_forward_difference_2d_wide
+ (  stencil_type  const    stencil         // e_stencil_9_point or e_stencil_4th_order
+  , RATE_TYPE     const    damping
+  , RATE_TYPE     const    rate
+  , RATE_TYPE     const    rate_side
+  , SRC_ITER_TYPE const *  p_rows          // 5 rows [y-2 .. y+2], mirrored at the top and bottom
+  , SRC_ITER_TYPE const &  src_iter_limit  // one past the end of the src row, p_rows[ 2 ]
+  , TRG_ITER_TYPE const &  trg_iter        // result, same size as src, not one of the rows
+  , RATE_TYPE     const    clamp_limit     // zero means no clamp
+ )
+{
+    d_assert( get_no_init_damping_set_value< RATE_TYPE >( ) != damping);
+    d_assert( get_no_init_damping_sum_value< RATE_TYPE >( ) != damping);
+    d_assert( (stencil == e_stencil_9_point) || (stencil == e_stencil_4th_order));
+
+    // Use the vector kernel if the rows are contiguous floats (see finite_diff_simd.h).
+    if ( (stencil == e_stencil_9_point) ?
+            simd::try_calc_forward_diff_2d_9_point
+             ( damping, rate, rate_side, p_rows, src_iter_limit, trg_iter, clamp_limit) :
+            simd::try_calc_forward_diff_2d_4th_order
+             ( damping, rate, rate_side, p_rows, src_iter_limit, trg_iter, clamp_limit) )
+    {
+        return;
+    }
+
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+    std::ptrdiff_t const count = src_iter_limit - p_rows[ 2 ];
+
+    if ( damping == 0 ) {
+        calc_forward_diff_2d_wide_maybe_clamp_
+         (  assign3_src_minus_trg_type< item_type >( )
+          , stencil, rate, rate_side
+          , p_rows, count
+          , trg_iter
+          , clamp_limit
+         );
+    } else
+    if ( damping == 1 ) {
+        calc_forward_diff_2d_wide_maybe_clamp_
+         (  assign3_set_type< item_type >( )
+          , stencil, rate, rate_side
+          , p_rows, count
+          , trg_iter
+          , clamp_limit
+         );
+    } else {
+        calc_forward_diff_2d_wide_maybe_clamp_
+         (  assign3_damping_type< item_type, RATE_TYPE >( damping)
+          , stencil, rate, rate_side
+          , p_rows, count
+          , trg_iter
+          , clamp_limit
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Boundaries
+//
+//   The kernels above treat the edges as insulated: the cells past an edge mirror the cells just
+//   inside, so no heat leaks out. The 2d forward-diff solving functor (finite_diff_solver.h)
+//   applies the other boundaries to each row in the same sweep, right after the kernel writes
+//   the row and while it is still in the cache:
+//
+//   Fixed (Dirichlet). The top and bottom rows, and the end cells of the other rows, keep their
+//   src values. The cells next to them see them as ordinary neighbors.
+//
+//   Periodic. The edges wrap around, so the row above the top row is the bottom row and the cell
+//   before the first cell is the last one. The functor wraps the rows it hands the kernels. The
+//   kernels always mirror the columns, so wrap_forward_diff_row_ends(..) fixes the end cells
+//   afterwards. The stencils are linear, and the assign3 functors all add the side value with a
+//   weight of one, so the fix is just the rates times the change in the neighbors.
+//
+//   Absorbing (waves). The damping climbs to 1 in a layer along the edges (a sponge), so waves
+//   die out in the layer instead of bouncing back. See get_absorbing_damping(..). This is the
+//   graded-damping stand-in for a perfectly-matched layer, which would need extra fields for
+//   every cell in the layer.
+
+  enum
+boundary_type
+ {  e_boundary_insulated
+  , e_boundary_fixed
+  , e_boundary_periodic
+  , e_boundary_absorbing
+ };
+
+  inline
+  std::ptrdiff_t
+get_wrap_index( std::ptrdiff_t index, std::ptrdiff_t const count)
+  //
+  // Wraps an index that may be past either edge back into [0, count).
+{
+    d_assert( count > 0);
+    index %= count;
+    return (index < 0) ? (index + count) : index;
+}
+
+  inline
+  std::ptrdiff_t
+get_boundary_index( boundary_type const boundary, std::ptrdiff_t const index, std::ptrdiff_t const count)
+  //
+  // Periodic edges wrap. The rest mirror, like insulated edges, and fix up the edge cells later.
+{
+    return (boundary == e_boundary_periodic) ?
+        get_wrap_index( index, count) :
+        get_mirror_index( index, count);
+}
+
+// _______________________________________________________________________________________________
+// get_absorbing_width( count)
+// get_absorbing_damping( damping, distance, width)
+//
+//   The absorbing layer is up to 16 cells deep, but never more than a quarter of the sheet.
+//   Inside it the damping climbs from the sheet damping to 1 at the edge, with the square of the
+//   depth into the layer. The slow start keeps the layer itself from reflecting much.
+
+enum { e_absorbing_max_width = 16 };
+
+  inline
+  std::ptrdiff_t
+get_absorbing_width( std::ptrdiff_t const count)
+{
+    std::ptrdiff_t const quarter = count / 4;
+    return (quarter < e_absorbing_max_width) ? quarter : std::ptrdiff_t( e_absorbing_max_width);
+}
+
+  template< typename RATE_TYPE >
+  inline
+  RATE_TYPE
+get_absorbing_damping
+ (  RATE_TYPE       const  damping
+  , std::ptrdiff_t  const  distance  // cells in from the nearest edge, zero for the edge cell
+  , std::ptrdiff_t  const  width     // from get_absorbing_width(..)
+ )
+{
+    if ( distance >= width ) return damping;
+    RATE_TYPE const depth = static_cast< RATE_TYPE >( width - distance) / static_cast< RATE_TYPE >( width);
+    return damping + ((static_cast< RATE_TYPE >( 1) - damping) * (depth * depth));
+}
+
+// _______________________________________________________________________________________________
+// wrap_forward_diff_row_ends
+//  (  stencil
+//   , rate, rate_side
+//   , p_rows, count
+//   , trg_iter
+//  )
+//
+//   Moves the end cells of a row the kernel just solved from mirrored to wrapped neighbors.
+//   The 9-point stencil also sees the neighbors' vertical diffs, so it needs the side rows.
+//   The 4th-order stencil reaches 2 cells in, and needs at least 4 cells for the mirrored and
+//   wrapped neighbors to line up this way. Shorter rows keep mirrored ends.
+//
+//   This does not clamp. If the kernel clamped, the caller should clamp the end cells again.
+
+  template
+   <  typename RATE_TYPE        // double, float
+    , typename SRC_ITER_TYPE    // std::vector< float >::const_iterator
+    , typename TRG_ITER_TYPE    // std::vector< float >::iterator
+   >
+  void
+wrap_forward_diff_row_ends
+ (  stencil_type    const    stencil
+  , RATE_TYPE       const    rate
+  , RATE_TYPE       const    rate_side
+  , SRC_ITER_TYPE   const *  p_rows    // 5 rows [y-2 .. y+2], wrapped at the top and bottom
+  , std::ptrdiff_t  const    count
+  , TRG_ITER_TYPE   const &  trg_iter  // the row the kernel solved from p_rows
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    // A single cell is its own neighbor either way.
+    if ( count < 2 ) return;
+
+    SRC_ITER_TYPE  const &  src      = p_rows[ 2 ];
+    std::ptrdiff_t const    last     = count - 1;
+    item_type      const    c_first  = *src;
+    item_type      const    c_last   = *(src + last);
+
+    if ( stencil == e_stencil_5_point ) {
+        *trg_iter          += rate * (c_last - c_first);
+        *(trg_iter + last) += rate * (c_first - c_last);
+    } else
+    if ( stencil == e_stencil_9_point ) {
+        RATE_TYPE const  rate_corner  = (rate + rate_side) / 12;
+        item_type const  dy_first     = ((*p_rows[ 1 ]) + (*p_rows[ 3 ])) - (c_first + c_first);
+        item_type const  dy_last      = (*(p_rows[ 1 ] + last) + *(p_rows[ 3 ] + last)) - (c_last + c_last);
+        *trg_iter          += (rate * (c_last - c_first)) + (rate_corner * (dy_last - dy_first));
+        *(trg_iter + last) += (rate * (c_first - c_last)) + (rate_corner * (dy_first - dy_last));
+    } else
+    if ( count >= 4 ) {
+        d_assert( stencil == e_stencil_4th_order);
+        RATE_TYPE const  rate_12   = rate / 12;
+        item_type const  sixteen   = 16;
+        item_type const  c_second  = *(src + 1);
+        item_type const  c_before  = *(src + (last - 1));
+        *trg_iter                 += rate_12 * (((c_last - c_first) * sixteen) - (c_before - c_second));
+        *(trg_iter + 1)           -= rate_12 * (c_last - c_first);
+        *(trg_iter + (last - 1))  -= rate_12 * (c_first - c_last);
+        *(trg_iter + last)        += rate_12 * (((c_first - c_last) * sixteen) - (c_second - c_before));
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Varying conductivity
+//
+//   The kernels above use the same rates everywhere on the sheet. These also read a coefficient
+//   sheet, the same size as the src sheet, that holds the conductivity of each cell. The
+//   conductivity is a fraction [0, 1] of the rates, so the stability limits and sub-steps we
+//   work out from the rates still hold.
+//
+//   Heat flows across the faces between cells, so what matters is the conductivity of each
+//   face. We use the harmonic mean of the two cells, which is what two half-cells in series
+//   give you. Heat leaving a good conductor for a poor one is held back by the poor one, and a
+//   cell with no conductivity insulates its neighbors completely. Both cells see the same
+//   value for the face, so heat is still conserved.
+//
+//   Only the 5-point stencil has a varying version. Past the insulated edges the neighbor is
+//   the cell itself, so no heat crosses the edges. The caller passes in the src row (and its
+//   coefficients) as the side row at the top and bottom edges, and the same works for a sheet
+//   only one row high.
+//
+//   For a cell with conductivity k and neighbors n (with conductivity kn) the step is
+//     side = src + rate*(sum over x neighbors: face(k, kn)*(n - src))
+//                + rate_side*(sum over y neighbors: face(k, kn)*(n - src))
+//   which is the same as the 5-point kernels when every cell has a conductivity of 1.
+
+  template< typename ITEM_TYPE >
+  inline
+  ITEM_TYPE
+get_face_conductivity( ITEM_TYPE const  coef_a, ITEM_TYPE const  coef_b)
+  //
+  // Harmonic mean, 2ab / (a + b). Zero if both cells are zero, instead of dividing by zero.
+  // The vector kernels do the same operations in the same order, with max(..) for the test.
+{
+    ITEM_TYPE const  sum   = coef_a + coef_b;
+    ITEM_TYPE const  tiny  = std::numeric_limits< ITEM_TYPE >::min( );
+    return ((coef_a * coef_b) * static_cast< ITEM_TYPE >( 2)) / ((sum > tiny) ? sum : tiny);
+}
+
+  template< typename ITEM_TYPE, typename RATE_TYPE >
+  inline
+  ITEM_TYPE
+calc_forward_diff_varying_cell_
+ (  RATE_TYPE const  rate
+  , RATE_TYPE const  rate_side
+  , ITEM_TYPE const  src  , ITEM_TYPE const  coef
+  , ITEM_TYPE const  x_lo , ITEM_TYPE const  coef_x_lo
+  , ITEM_TYPE const  x_hi , ITEM_TYPE const  coef_x_hi
+  , ITEM_TYPE const  y_lo , ITEM_TYPE const  coef_y_lo
+  , ITEM_TYPE const  y_hi , ITEM_TYPE const  coef_y_hi
+ )
+  //
+  // One cell of the varying kernel. Like the wide-stencil cell functions, the vector kernel
+  // uses this for the end cells and repeats its operations for the middle cells.
+{
+    ITEM_TYPE const  flux_x  =
+        (get_face_conductivity( coef, coef_x_lo) * (x_lo - src)) +
+        (get_face_conductivity( coef, coef_x_hi) * (x_hi - src));
+    ITEM_TYPE const  flux_y  =
+        (get_face_conductivity( coef, coef_y_lo) * (y_lo - src)) +
+        (get_face_conductivity( coef, coef_y_hi) * (y_hi - src));
+    return src + ((rate * flux_x) + (rate_side * flux_y));
+}
+
+// _______________________________________________________________________________________________
+// calc_forward_diff_2d_varying_
+//  (  assign3_functor
+//   , rate, rate_side
+//   , src_iter, count
+//   , src_iter_side_a, src_iter_side_b
+//   , coef_iter, coef_iter_side_a, coef_iter_side_b
+//   , trg_iter
+//  )
+
+  template
+   <  typename ASSIGN3_FUNCTOR_TYPE
+    , typename RATE_TYPE        // double, float
+    , typename SRC_ITER_TYPE    // std::vector< float >::const_iterator
+    , typename COEF_ITER_TYPE   // std::vector< float >::const_iterator
+    , typename TRG_ITER_TYPE    // std::vector< float >::iterator
+   >
+  void
+calc_forward_diff_2d_varying_
+ (  ASSIGN3_FUNCTOR_TYPE     assign3_functor
+  , RATE_TYPE      const     rate
+  , RATE_TYPE      const     rate_side
+  , SRC_ITER_TYPE  const &   src_iter
+  , std::ptrdiff_t const     count
+  , SRC_ITER_TYPE  const &   src_iter_side_a
+  , SRC_ITER_TYPE  const &   src_iter_side_b
+  , COEF_ITER_TYPE const &   coef_iter
+  , COEF_ITER_TYPE const &   coef_iter_side_a
+  , COEF_ITER_TYPE const &   coef_iter_side_b
+  , TRG_ITER_TYPE            trg_iter         // result, not one of the src rows
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    for ( std::ptrdiff_t index = 0 ; index < count ; ++ index, ++ trg_iter ) {
+        std::ptrdiff_t const  lo       = (index == 0) ? index : (index - 1);
+        std::ptrdiff_t const  hi       = ((index + 1) == count) ? index : (index + 1);
+        item_type      const  src_mid  = *(src_iter + index);
+        assign3_functor( *trg_iter, src_mid,
+            calc_forward_diff_varying_cell_< item_type, RATE_TYPE >
+             (  rate, rate_side
+              , src_mid                    , item_type( *(coef_iter + index))
+              , *(src_iter + lo)           , item_type( *(coef_iter + lo))
+              , *(src_iter + hi)           , item_type( *(coef_iter + hi))
+              , *(src_iter_side_a + index) , item_type( *(coef_iter_side_a + index))
+              , *(src_iter_side_b + index) , item_type( *(coef_iter_side_b + index))
+             ));
+    }
+}
+
+  template
+   <  typename ASSIGN3_FUNCTOR_TYPE
+    , typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename COEF_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  void
+calc_forward_diff_2d_varying_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE  const &  assign3_functor
+  , RATE_TYPE             const    rate
+  , RATE_TYPE             const    rate_side
+  , SRC_ITER_TYPE         const &  src_iter
+  , std::ptrdiff_t        const    count
+  , SRC_ITER_TYPE         const &  src_iter_side_a
+  , SRC_ITER_TYPE         const &  src_iter_side_b
+  , COEF_ITER_TYPE        const &  coef_iter
+  , COEF_ITER_TYPE        const &  coef_iter_side_a
+  , COEF_ITER_TYPE        const &  coef_iter_side_b
+  , TRG_ITER_TYPE         const &  trg_iter
+  , RATE_TYPE             const    clamp_limit
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_2d_varying_
+         (  assign3_functor
+          , rate, rate_side
+          , src_iter, count, src_iter_side_a, src_iter_side_b
+          , coef_iter, coef_iter_side_a, coef_iter_side_b
+          , trg_iter
+         );
+    } else {
+        calc_forward_diff_2d_varying_
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE, item_type >( assign3_functor, clamp_limit)
+          , rate, rate_side
+          , src_iter, count, src_iter_side_a, src_iter_side_b
+          , coef_iter, coef_iter_side_a, coef_iter_side_b
+          , trg_iter
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// calc_next_generation_forward_difference_2d_varying
+//  (  damping, rate, rate_side
+//   , src_iter, src_iter_limit
+//   , src_iter_side_a, src_iter_side_b
+//   , coef_iter, coef_iter_side_a, coef_iter_side_b
+//   , trg_iter
+//   , clamp_limit
+//  )
+
+  template
+   <  typename RATE_TYPE        // double, float
+    , typename SRC_ITER_TYPE    // std::vector< float >::const_iterator
+    , typename COEF_ITER_TYPE   // std::vector< float >::const_iterator
+    , typename TRG_ITER_TYPE    // std::vector< float >::iterator
+   >
+  void
+calc_next_generation_forward_difference_2d_varying
+ (  RATE_TYPE      const    damping
+  , RATE_TYPE      const    rate
+  , RATE_TYPE      const    rate_side
+  , SRC_ITER_TYPE  const &  src_iter          // previous state, not changed
+  , SRC_ITER_TYPE  const &  src_iter_limit    // one past the end
+  , SRC_ITER_TYPE  const &  src_iter_side_a   // row above, or the src row at the top edge
+  , SRC_ITER_TYPE  const &  src_iter_side_b   // row below, or the src row at the bottom edge
+  , COEF_ITER_TYPE const &  coef_iter         // conductivity of the src row
+  , COEF_ITER_TYPE const &  coef_iter_side_a  // conductivity of the side a row
+  , COEF_ITER_TYPE const &  coef_iter_side_b  // conductivity of the side b row
+  , TRG_ITER_TYPE  const &  trg_iter          // result, same size as src, not one of the rows
+  , RATE_TYPE      const    clamp_limit       // zero means no clamp
+ )
+{
+    d_assert( get_no_init_damping_set_value< RATE_TYPE >( ) != damping);
+    d_assert( get_no_init_damping_sum_value< RATE_TYPE >( ) != damping);
+
+    // Use the vector kernel if the rows are contiguous floats (see finite_diff_simd.h).
+    if ( simd::try_calc_forward_diff_2d_varying
+          (  damping, rate, rate_side
+           , src_iter, src_iter_limit
+           , src_iter_side_a, src_iter_side_b
+           , coef_iter, coef_iter_side_a, coef_iter_side_b
+           , trg_iter
+           , clamp_limit
+          ) )
+    {
+        return;
+    }
+
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+    std::ptrdiff_t const count = src_iter_limit - src_iter;
+
+    if ( damping == 0 ) {
+        calc_forward_diff_2d_varying_maybe_clamp_
+         (  assign3_src_minus_trg_type< item_type >( )
+          , rate, rate_side
+          , src_iter, count, src_iter_side_a, src_iter_side_b
+          , coef_iter, coef_iter_side_a, coef_iter_side_b
+          , trg_iter
+          , clamp_limit
+         );
+    } else
+    if ( damping == 1 ) {
+        calc_forward_diff_2d_varying_maybe_clamp_
+         (  assign3_set_type< item_type >( )
+          , rate, rate_side
+          , src_iter, count, src_iter_side_a, src_iter_side_b
+          , coef_iter, coef_iter_side_a, coef_iter_side_b
+          , trg_iter
+          , clamp_limit
+         );
+    } else {
+        calc_forward_diff_2d_varying_maybe_clamp_
+         (  assign3_damping_type< item_type, RATE_TYPE >( damping)
+          , rate, rate_side
+          , src_iter, count, src_iter_side_a, src_iter_side_b
+          , coef_iter, coef_iter_side_a, coef_iter_side_b
+          , trg_iter
+          , clamp_limit
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// wrap_forward_diff_varying_row_ends( rate, src_iter, coef_iter, count, trg_iter)
+//
+//   Same as wrap_forward_diff_row_ends(..) for the 5-point stencil, with the conductivity of
+//   the face between the first and last cells. This does not clamp either.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename COEF_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  void
+wrap_forward_diff_varying_row_ends
+ (  RATE_TYPE       const    rate
+  , SRC_ITER_TYPE   const &  src_iter
+  , COEF_ITER_TYPE  const &  coef_iter
+  , std::ptrdiff_t  const    count
+  , TRG_ITER_TYPE   const &  trg_iter  // the row the kernel solved from src_iter
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    // A single cell is its own neighbor either way.
+    if ( count < 2 ) return;
+
+    std::ptrdiff_t const  last     = count - 1;
+    item_type      const  c_first  = *src_iter;
+    item_type      const  c_last   = *(src_iter + last);
+    item_type      const  face     =
+        get_face_conductivity( item_type( *coef_iter), item_type( *(coef_iter + last)));
+    *trg_iter          += rate * (face * (c_last - c_first));
+    *(trg_iter + last) += rate * (face * (c_first - c_last));
+}
+
+// _______________________________________________________________________________________________
+// calc_next_generation_implicit_difference_1d_varying
+//  (  base, damping, rate
+//   , src_iter, src_iter_limit
+//   , coef_iter
+//   , trg_iter
+//   , scaleX_iter, inX_iter
+//  )
+//
+//   Backward diff (base 1) and central diff (base 2) with varying conductivity. Each face has
+//   its own rate, so the matrix is different for every row and we solve it as we build it
+//   (the Thomas algorithm), instead of building the diagonal and calling the tridiagonal
+//   solver. For cell i, with the faces fw (before) and fe (after), zero past the ends:
+//     sub-diagonal    - rate*fw
+//     diagonal        base + rate*(fw + fe)
+//     super-diagonal  - rate*fe
+//     right side      src                                  (backward diff)
+//                     2*src + rate*(fw*(lo - src) + fe*(hi - src))   (central diff)
+//   With every conductivity 1 this is the same system calc_matrix_diagonal(..) builds.
+//
+//   scaleX and inX are temp buffers, as big as src. src can be the same as trg, with the same
+//   damping caveats as calc_next_generation_backward_difference_1d(..). The column kernels in
+//   finite_diff_simd_kernels.h repeat these operations in the same order.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename COEF_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename TEMP_ITER_TYPE
+   >
+  void
+calc_next_generation_implicit_difference_1d_varying
+ (  RATE_TYPE      const    base            // 1 (for backward diff) or 2 (for central diff)
+  , RATE_TYPE      const    damping         // usually between 0..1, or one of the special values
+  , RATE_TYPE      const    rate            // 0 <= rate
+  , SRC_ITER_TYPE  const &  src_iter        // previous state
+  , SRC_ITER_TYPE  const &  src_iter_limit  // one past the end
+  , COEF_ITER_TYPE const &  coef_iter       // conductivity, as big as src
+  , TRG_ITER_TYPE  const &  trg_iter        // result, as big as src
+  , TEMP_ITER_TYPE const &  scaleX_iter     // temp, as big as src
+  , TEMP_ITER_TYPE const &  inX_iter        // temp, as big as src
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    d_assert( src_iter <= src_iter_limit);
+    std::ptrdiff_t const count = src_iter_limit - src_iter;
+    if ( count <= 0 ) return;
+
+    item_type const  item_base  = base;
+    item_type const  item_rate  = rate;
+    item_type const  zero       = 0;
+
+    // Forward iteration: build each row of the matrix and eliminate its sub-diagonal.
+    //   scaleX[ i ] <- super / (diag - (sub * scaleX[ i-1 ]))
+    //   inX[ i ]    <- (in - (sub * inX[ i-1 ])) / (diag - (sub * scaleX[ i-1 ]))
+    std::ptrdiff_t const last = count - 1;
+    for ( std::ptrdiff_t index = 0 ; index < count ; ++ index ) {
+        std::ptrdiff_t const  lo    = (index == 0) ? index : (index - 1);
+        std::ptrdiff_t const  hi    = (index == last) ? index : (index + 1);
+        item_type      const  src   = *(src_iter + index);
+        item_type      const  coef  = item_type( *(coef_iter + index));
+        item_type      const  fw    = (index == 0   ) ? zero : get_face_conductivity( coef, item_type( *(coef_iter + lo)));
+        item_type      const  fe    = (index == last) ? zero : get_face_conductivity( coef, item_type( *(coef_iter + hi)));
+
+        item_type const  sub    = - (item_rate * fw);
+        item_type const  super  = - (item_rate * fe);
+        item_type        diag   = item_base + (item_rate * (fw + fe));
+        item_type        in     = (base == 1) ? src :
+            ((item_base * src) + (item_rate * ((fw * (*(src_iter + lo) - src)) + (fe * (*(src_iter + hi) - src)))));
+        if ( index != 0 ) {
+            diag = diag - (sub * *(scaleX_iter + (index - 1)));
+            in   = in   - (sub * *(inX_iter    + (index - 1)));
+        }
+        d_assert( diag != 0);
+        *(scaleX_iter + index) = super / diag;
+        *(inX_iter    + index) = in    / diag;
+    }
+
+    // Sweep backwards, assigning out to trg. All of src has been read by now, except for the
+    // wave damping, which only reads the cell it is assigning.
+    //   out[ i ] <- inX[ i ] - (scaleX[ i ] * out[ i+1 ])
+    bool const  is_set  = (get_no_init_damping_set_value< RATE_TYPE >( ) == damping);
+    bool const  is_sum  = (get_no_init_damping_sum_value< RATE_TYPE >( ) == damping);
+    for ( std::ptrdiff_t index = count ; index != 0 ; ) {
+        -- index;
+        item_type out = *(inX_iter + index);
+        if ( index != last ) {
+            out = out - (*(scaleX_iter + index) * *(inX_iter + (index + 1)));
+        }
+        *(inX_iter + index) = out;
+
+        item_type & trg = *(trg_iter + index);
+        if ( is_set ) {
+            trg = out;
+        } else {
+            if ( ! is_sum ) {
+                init_wave_damping( damping, 1, src_iter + index, trg_iter + index);
+            }
+            trg += out;
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// calc_next_generation_forward_difference_1d
+//  (  rate
+//   , src_iter, src_iter_limit
+//   , trg_iter
+//  )
+
+  template
+   <  typename RATE_TYPE      // double, float
+    , typename SRC_ITER_TYPE  // std::vector< float >::const_iterator
+    , typename TRG_ITER_TYPE  // std::vector< float >::iterator
+   >
+  void
+calc_next_generation_forward_difference_1d
+ (  RATE_TYPE     const    rate            // 0 < rate <= 0.5
+  , SRC_ITER_TYPE const &  src_iter        // previous state
+  , SRC_ITER_TYPE const &  src_iter_limit  // one past the end
+  , TRG_ITER_TYPE const &  trg_iter        // result, as big as src
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    // For each value in src, calculate a value and store it in trg (where r is the rate):
+    //   trg[i] <- (1 - 2r)src[i] + r(src[i-1] + src[i+1])
+    // Treat the rate values off the ends as zero, so as not to spill heat off the edges.
+    //   trg[0] <- (1 - r)src[0] + r(src[1])
+    //   trg[count-1] <- (1 - r)src[count-1] + r(src[count-2])
+    RATE_TYPE const base = 1;
+    RATE_TYPE const damping = 1; // same as assign3_set_type
+    RATE_TYPE const no_clamp = 0;
+    if ( simd::try_calc_forward_diff_thin_strip( damping, base, rate, src_iter, src_iter_limit, trg_iter, no_clamp) ) {
+        return;
+    }
+    calc_forward_diff_thin_strip_
+     (  assign3_set_type< item_type >( )
+      , base
+      , rate
+      , src_iter, src_iter_limit
+      , trg_iter
+     );
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// calc_matrix_diagonal( base, rate, src_iter, src_iter_limit, diag_iter)
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename DIAG_ITER_TYPE
+   >
+  size_t /* returns count */
+calc_matrix_diagonal
+ (  RATE_TYPE const  base           // 1 (for backward diff) or 2 (for central diff)
+  , RATE_TYPE const  rate           // 0 < rate
+  , SRC_ITER_TYPE    src_iter       // previous state
+  , SRC_ITER_TYPE    src_iter_limit // one past the end
+  , DIAG_ITER_TYPE   diag_iter      // return, as big as (src_iter_limit - src_iter)
+ )
+{
+    // carry_middle (1 + 2r) is all the middle values of the diagonal.
+    // carry_edge (1 + r) is used at the two ends, which are floating and insulated and conserves energy.
+    RATE_TYPE const carry_edge   = base + rate;
+    RATE_TYPE const carry_middle = carry_edge + rate;
+
+    // Fill in the diagonal, and count at the same time.
+    // Set the first and last values in the diagonal to the edge values.
+    // If we had the count we'd do this instead:
+    //   if ( count > 1 ) {
+    //     (*diag_iter) = carry_edge;
+    //     if ( count > 2 ) {
+    //       std::fill_n( diag_iter + 1, count - 2, carry_middle);
+    //       (*(diag_iter + (count - 1))) = carry_edge;
+    //   } }
+    //
+    // If rate was a vector of count-2 values (one value for each boundaries between cells),
+    // we'd still use (- rate) for both the super- and sub-diagonals, and the diagonal values
+    // would be:
+    //   diag[ 0 ] = 1 + r[ 0 ]
+    //   diag[ i ] = 1 + r[ i-1 ] + r[ i ]
+    //   diag[ count-1 ] = 1 + r[ count-2 ]
+    //
+    // Speedup: The caller could pre-calc the diag, along with the count.
+    // But we'd still have to copy the diag to a scratch buffer, so the savings is slight.
+    // And remember rate should really be a vector and not a single value.
+    // Of course if rate is a vector, we could pre-calculate the carry edges for every cell border
+    // in the entire sheet. (Rates only apply to cell borders, not to the cells themselves.)
+    size_t count = 0;
+    if ( src_iter < src_iter_limit ) {
+        (*diag_iter) = carry_edge;
+        ++ count;
+        ++ src_iter;
+        ++ diag_iter;
+
+        if ( src_iter < src_iter_limit ) {
             SRC_ITER_TYPE const src_iter_max = src_iter_limit - 1;
             while ( src_iter != src_iter_max ) {
                 (*diag_iter) = carry_middle;
@@ -760,6 +1832,13 @@ solve_matrix_destructive
 {
     // Solve this as a linear equation.
     if ( rate >= 0 ) {
+        // Use the vector build of the solver if the buffers are floats (see finite_diff_simd.h).
+        if ( linear_algebra::simd::try_solve_tridiagonal_destructive(
+                assign_functor, count, - rate, diag_iter, - rate, src_iter, trg_iter) )
+        {
+            return;
+        }
+
         // Use accurate solver which assumes the rate is reasonable.
         linear_algebra::
           solve_tridiagonal_destructive(
@@ -857,6 +1936,11 @@ calc_next_generation_backward_difference_1d
     // trg_iter and the two buffers must all be distinct.
 
     d_assert( src_iter <= src_iter_limit);
+    if ( simd::try_calc_backward_difference_1d
+          ( damping, rate, src_iter, src_iter_limit, trg_iter, srcX_iter, diagX_iter) )
+    {
+        return;
+    }
     if ( src_iter < src_iter_limit ) {
 
         // Copy src to srcX. We will pass srcX to the destructive tri-diag solver which will then write
@@ -921,6 +2005,11 @@ calc_next_generation_central_difference_1d
     // trg_iter and the two buffers must all be distinct.
 
     d_assert( src_iter <= src_iter_limit);
+    if ( simd::try_calc_central_difference_1d
+          ( damping, rate, src_iter, src_iter_limit, trg_iter, srcX_iter, diagX_iter) )
+    {
+        return;
+    }
     if ( src_iter < src_iter_limit ) {
 
         // For each value in src, calculate a value and store it in srcX (where r is the rate):
@@ -962,6 +2051,260 @@ calc_next_generation_central_difference_1d
     }
 }
 
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Backward and central difference with a factored matrix
+//
+//   The two functions above build the matrix and eliminate its sub-diagonal for every row they
+//   solve. But the matrix only depends on the base, the rate, and the row length, which are the
+//   same for every row in a pass, and usually the same from one generation to the next.
+//
+//   implicit_matrix_type holds the factored matrix, so each row only pays for the right-hand
+//   side and the two substitution sweeps. That saves one divide per cell. The results are the
+//   same as calc_next_generation_backward/central_difference_1d(..).
+//
+//   This is only for (rate >= 0). Other rates use the careful solver which isn't factored.
+
+  template< typename RATE_TYPE >
+  class
+implicit_matrix_type
+{
+  public:
+    implicit_matrix_type( )
+      : base_( 0), rate_( 0), count_( 0) { }
+
+    bool
+    is_factored( RATE_TYPE base, RATE_TYPE rate, size_t count) const
+      { return (count_ == count) && (base_ == base) && (rate_ == rate); }
+
+    void
+    factor( RATE_TYPE base, RATE_TYPE rate, size_t count)
+      //
+      // base is 1 (for backward diff) or 2 (for central diff).
+      {
+        d_assert( count >= 2);
+        d_assert( rate >= 0);
+        base_  = base;
+        rate_  = rate;
+        count_ = count;
+
+        // Same diagonal as calc_matrix_diagonal(..).
+        RATE_TYPE const carry_edge   = base + rate;
+        RATE_TYPE const carry_middle = carry_edge + rate;
+        diag_.assign( count, carry_middle);
+        diag_.front( ) = carry_edge;
+        diag_.back( )  = carry_edge;
+
+        scale_.resize( count - 1);
+        linear_algebra::factor_tridiagonal( count, - rate, diag_.begin( ), - rate, scale_.begin( ));
+      }
+
+    void
+    clear( )
+      { base_ = rate_ = 0;
+        count_ = 0;
+        std::vector< RATE_TYPE >( ).swap( diag_);
+        std::vector< RATE_TYPE >( ).swap( scale_);
+      }
+
+    RATE_TYPE  get_base( )   const { return base_ ; }
+    RATE_TYPE  get_rate( )   const { return rate_ ; }
+    size_t     get_count( )  const { return count_; }
+
+    typename std::vector< RATE_TYPE >::const_iterator
+               get_diag( )   const { return diag_.begin( ); }
+    typename std::vector< RATE_TYPE >::const_iterator
+               get_scale( )  const { return scale_.begin( ); }
+
+  private:
+    RATE_TYPE                 base_   ;
+    RATE_TYPE                 rate_   ;
+    size_t                    count_  ;  /* zero when nothing is factored */
+    std::vector< RATE_TYPE >  diag_   ;  /* factored diagonal */
+    std::vector< RATE_TYPE >  scale_  ;  /* (count - 1) scale factors */
+};
+
+// _______________________________________________________________________________________________
+// calc_implicit_difference_rhs( base, rate, src_iter, src_iter_limit, srcX_iter)
+//
+//   The right-hand side of the backward-diff (base 1) or central-diff (base 2) matrix equation.
+//   For backward diff this is a copy of src. For central diff it's the forward-diff step, as
+//   described in calc_next_generation_central_difference_1d(..).
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TEMP_ITER_TYPE
+   >
+  void
+calc_implicit_difference_rhs
+ (  RATE_TYPE      const    base            // 1 or 2
+  , RATE_TYPE      const    rate
+  , SRC_ITER_TYPE  const &  src_iter
+  , SRC_ITER_TYPE  const &  src_iter_limit
+  , TEMP_ITER_TYPE const &  srcX_iter       // result, as big as src
+ )
+{
+    typedef typename std::iterator_traits< TEMP_ITER_TYPE >::value_type item_type;
+
+    if ( base == 1 ) {
+        std::copy( src_iter, src_iter_limit, srcX_iter);
+    } else
+    if ( ! simd::try_calc_forward_diff_thin_strip
+            (  static_cast< RATE_TYPE >( 1), base, rate, src_iter, src_iter_limit, srcX_iter
+             , static_cast< RATE_TYPE >( 0) /* no clamp */
+            ) )
+    {
+        calc_forward_diff_thin_strip_
+         (  assign3_set_type< item_type >( )
+          , base
+          , rate
+          , src_iter, src_iter_limit
+          , srcX_iter /* temp trg */
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// calc_next_generation_implicit_difference_1d_factored
+//  (  matrix
+//   , damping
+//   , src_iter, src_iter_limit
+//   , trg_iter
+//   , srcX_iter
+//  )
+//
+//   Same as calc_next_generation_backward_difference_1d(..) when (matrix.get_base( ) == 1), and
+//   calc_next_generation_central_difference_1d(..) when (matrix.get_base( ) == 2).
+//   Only needs one temp buffer, since the diagonal is in the matrix.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename TEMP_ITER_TYPE
+   >
+  void
+calc_next_generation_implicit_difference_1d_factored
+ (  implicit_matrix_type< RATE_TYPE >
+                   const &  matrix
+  , RATE_TYPE      const    damping         // usually between 0..1
+  , SRC_ITER_TYPE  const &  src_iter        // previous state, values not changed, can be same as trg
+  , SRC_ITER_TYPE  const &  src_iter_limit  // one past the end
+  , TRG_ITER_TYPE  const &  trg_iter        // result, as big as src
+  , TEMP_ITER_TYPE const &  srcX_iter       // temp, as big as src
+ )
+{
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type item_type;
+
+    RATE_TYPE const  base   = matrix.get_base( );
+    RATE_TYPE const  rate   = matrix.get_rate( );
+    size_t    const  count  = matrix.get_count( );
+    d_assert( static_cast< size_t >( src_iter_limit - src_iter) == count);
+
+    // The right-hand side, in srcX.
+    calc_implicit_difference_rhs( base, rate, src_iter, src_iter_limit, srcX_iter);
+
+    // Same as init_damping_and_solve_matrix_destructive(..).
+    if ( get_no_init_damping_set_value< RATE_TYPE >( ) == damping ) {
+        linear_algebra::
+          solve_tridiagonal_factored
+           (  util::assign_set_type< item_type >( )
+            , count, matrix.get_scale( ), matrix.get_diag( ), - rate, srcX_iter, trg_iter
+           );
+    } else {
+        if ( get_no_init_damping_sum_value< RATE_TYPE >( ) != damping ) {
+            init_wave_damping( damping, count, src_iter, trg_iter);
+        }
+        linear_algebra::
+          solve_tridiagonal_factored
+           (  util::assign_sum_type< item_type >( )
+            , count, matrix.get_scale( ), matrix.get_diag( ), - rate, srcX_iter, trg_iter
+           );
+    }
+}
+
+// _______________________________________________________________________________________________
+// calc_forward_diff_2d_fixed_cell_< INT_TYPE >( rate, rate_side, carry, lo, src, hi, side_a, side_b)
+// calc_next_generation_forward_difference_2d_fixed
+//  (  rate, rate_side
+//   , p_src, count
+//   , p_side_a, p_side_b
+//   , p_trg
+//  )
+//
+//   Forward-diff heat (damping is 1) for a row of uniform_scalar< INT_TYPE > inner values.
+//   The rates are inner values too. Each cell becomes:
+//     src + round( rate * (lo + hi - 2 src) + rate_side * (side_a + side_b - 2 src))
+//
+//   The sum is exact in int_wide_type and rounds once, so the vector kernel gets exactly the
+//   same answer. The change and the result saturate, so no clamping is needed.
+//
+//   The edge cells use themselves as the missing neighbor. For the top and bottom rows pass the
+//   row itself as the missing side. That way no heat leaks off the edges.
+//
+//   The sum cannot overflow if (2 * (rate + rate_side)) is less than one, which is also the
+//   forward-diff stability limit. carry is (2 * (rate + rate_side)) as a wide inner value.
+
+  template< typename INT_TYPE >
+  inline
+  INT_TYPE
+calc_forward_diff_2d_fixed_cell_
+ (  typename uniform_scalar< INT_TYPE >::int_wide_type const  rate
+  , typename uniform_scalar< INT_TYPE >::int_wide_type const  rate_side
+  , typename uniform_scalar< INT_TYPE >::int_wide_type const  carry
+  , INT_TYPE const  lo
+  , INT_TYPE const  src
+  , INT_TYPE const  hi
+  , INT_TYPE const  side_a
+  , INT_TYPE const  side_b
+ )
+{
+    typedef uniform_scalar< INT_TYPE >           scalar_type ;
+    typedef typename scalar_type::int_wide_type  wide_type   ;
+
+    wide_type const sum =
+          (rate      * (wide_type( lo    ) + hi    ))
+        + (rate_side * (wide_type( side_a) + side_b))
+        - (carry     * src)
+        + (scalar_type::get_int_wide_one( ) >> 1);
+    INT_TYPE const change = scalar_type::saturate( sum >> scalar_type::fraction_bit_count);
+    return scalar_type::saturate( wide_type( src) + change);
+}
+
+  template< typename INT_TYPE >
+  void
+calc_next_generation_forward_difference_2d_fixed
+ (  INT_TYPE    const    rate
+  , INT_TYPE    const    rate_side
+  , INT_TYPE    const *  p_src
+  , std::size_t const    count
+  , INT_TYPE    const *  p_side_a
+  , INT_TYPE    const *  p_side_b
+  , INT_TYPE          *  p_trg
+ )
+{
+    typedef typename uniform_scalar< INT_TYPE >::int_wide_type  wide_type;
+
+    d_assert( rate >= 0);
+    d_assert( rate_side >= 0);
+    d_assert( (p_trg + count <= p_src) || (p_src + count <= p_trg));
+
+    if ( count == 0 ) return;
+    if ( simd::try_calc_forward_diff_2d_fixed( rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg) ) {
+        return;
+    }
+
+    wide_type const carry = 2 * (wide_type( rate) + rate_side);
+    for ( std::size_t i = 0 ; i < count ; i += 1 ) {
+        INT_TYPE const lo = (i == 0)           ? p_src[ i] : p_src[ i - 1];
+        INT_TYPE const hi = ((i + 1) == count) ? p_src[ i] : p_src[ i + 1];
+        p_trg[ i] =
+          calc_forward_diff_2d_fixed_cell_< INT_TYPE >
+           ( rate, rate_side, carry, lo, p_src[ i], hi, p_side_a[ i], p_side_b[ i]);
+    }
+}
+
 } /* end namespace finite_difference */
 
 // _______________________________________________________________________________________________
@@ -0,0 +1,339 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// finite_diff_simd.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Builds finite_diff_simd_kernels.h once for each instruction set and picks one at startup.
+//
+// This file is compiled without any -msse/-mavx flags, so the rest of the program runs on any
+// x86. gcc and clang are told which instructions each block may use with target pragmas.
+// MSVC lets you use any intrinsic anywhere, so it doesn't need them.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <algorithm>
+# include "finite_diff.h"
+# include "finite_diff_simd.h"
+# include "cpu_features.h"
+
+# if CPU_FEATURES_X86
+#   include <immintrin.h>
+# endif
+
+// _______________________________________________________________________________________________
+// Target regions
+//
+//   AVX-512 (in gcc) and AVX2 (in most compilers, when FMA is also on) let the compiler fuse
+//   (a * b) + c into one multiply-add. That rounds once instead of twice, and then we would not
+//   match the scalar code. So we turn contraction off in every region.
+
+# if defined( __clang__ )
+#   pragma STDC FP_CONTRACT OFF
+#   define FINITE_DIFF_SIMD_TARGET_SSE2_PUSH \
+      _Pragma( "clang attribute push (__attribute__((target(\"sse2\"))), apply_to = function)")
+#   define FINITE_DIFF_SIMD_TARGET_AVX2_PUSH \
+      _Pragma( "clang attribute push (__attribute__((target(\"avx2\"))), apply_to = function)")
+#   define FINITE_DIFF_SIMD_TARGET_AVX512_PUSH \
+      _Pragma( "clang attribute push (__attribute__((target(\"avx512f\"))), apply_to = function)")
+#   define FINITE_DIFF_SIMD_TARGET_POP \
+      _Pragma( "clang attribute pop")
+# elif defined( __GNUC__ )
+#   define FINITE_DIFF_SIMD_TARGET_SSE2_PUSH \
+      _Pragma( "GCC push_options") _Pragma( "GCC target (\"sse2\")") \
+      _Pragma( "GCC optimize (\"fp-contract=off\")")
+#   define FINITE_DIFF_SIMD_TARGET_AVX2_PUSH \
+      _Pragma( "GCC push_options") _Pragma( "GCC target (\"avx2\")") \
+      _Pragma( "GCC optimize (\"fp-contract=off\")")
+#   define FINITE_DIFF_SIMD_TARGET_AVX512_PUSH \
+      _Pragma( "GCC push_options") _Pragma( "GCC target (\"avx512f\")") \
+      _Pragma( "GCC optimize (\"fp-contract=off\")")
+#   define FINITE_DIFF_SIMD_TARGET_POP \
+      _Pragma( "GCC pop_options")
+# else
+#   define FINITE_DIFF_SIMD_TARGET_SSE2_PUSH
+#   define FINITE_DIFF_SIMD_TARGET_AVX2_PUSH
+#   define FINITE_DIFF_SIMD_TARGET_AVX512_PUSH
+#   define FINITE_DIFF_SIMD_TARGET_POP
+# endif
+
+// _______________________________________________________________________________________________
+//
+namespace finite_difference {
+namespace simd {
+// _______________________________________________________________________________________________
+
+# if CPU_FEATURES_X86
+
+// _______________________________________________________________________________________________
+// SSE2, 4 floats
+
+FINITE_DIFF_SIMD_TARGET_SSE2_PUSH
+namespace isa_sse2 {
+
+  struct
+ops_type
+{
+    typedef __m128 reg_type;
+    static size_t const width = 4;
+
+    static reg_type load( float const * p)          { return _mm_loadu_ps( p); }
+    static void     store( float * p, reg_type a)   { _mm_storeu_ps( p, a); }
+    static reg_type set1( float a)                  { return _mm_set1_ps( a); }
+    static reg_type add( reg_type a, reg_type b)    { return _mm_add_ps( a, b); }
+    static reg_type sub( reg_type a, reg_type b)    { return _mm_sub_ps( a, b); }
+    static reg_type mul( reg_type a, reg_type b)    { return _mm_mul_ps( a, b); }
+    static reg_type div( reg_type a, reg_type b)    { return _mm_div_ps( a, b); }
+    static reg_type min( reg_type a, reg_type b)    { return _mm_min_ps( a, b); }
+    static reg_type max( reg_type a, reg_type b)    { return _mm_max_ps( a, b); }
+    static reg_type neg( reg_type a)                { return _mm_xor_ps( a, _mm_set1_ps( -0.0f)); }
+};
+
+// 8 int16s, for the fixed-point kernel. madd(..) multiplies pairs of int16s and adds each pair
+// into one int32.
+  struct
+i16_ops_type
+{
+    typedef __m128i reg_type;
+    static size_t const width = 8;
+
+    static reg_type load( boost::int16_t const * p)         { return _mm_loadu_si128( reinterpret_cast< __m128i const * >( p)); }
+    static void     store( boost::int16_t * p, reg_type a)  { _mm_storeu_si128( reinterpret_cast< __m128i * >( p), a); }
+    static reg_type zero( )                                 { return _mm_setzero_si128( ); }
+    static reg_type set1_16( boost::int16_t a)              { return _mm_set1_epi16( a); }
+    static reg_type set1_32( boost::int32_t a)              { return _mm_set1_epi32( a); }
+    static reg_type unpack_lo( reg_type a, reg_type b)      { return _mm_unpacklo_epi16( a, b); }
+    static reg_type unpack_hi( reg_type a, reg_type b)      { return _mm_unpackhi_epi16( a, b); }
+    static reg_type madd( reg_type a, reg_type b)           { return _mm_madd_epi16( a, b); }
+    static reg_type add_32( reg_type a, reg_type b)         { return _mm_add_epi32( a, b); }
+    static reg_type shift_right_15( reg_type a)            { return _mm_srai_epi32( a, 15); }
+    static reg_type pack_saturate( reg_type a, reg_type b)  { return _mm_packs_epi32( a, b); }
+    static reg_type add_saturate_16( reg_type a, reg_type b){ return _mm_adds_epi16( a, b); }
+};
+
+# include "finite_diff_simd_kernels.h"
+
+} /* end namespace isa_sse2 */
+FINITE_DIFF_SIMD_TARGET_POP
+
+// _______________________________________________________________________________________________
+// AVX2, 8 floats
+
+FINITE_DIFF_SIMD_TARGET_AVX2_PUSH
+namespace isa_avx2 {
+
+  struct
+ops_type
+{
+    typedef __m256 reg_type;
+    static size_t const width = 8;
+
+    static reg_type load( float const * p)          { return _mm256_loadu_ps( p); }
+    static void     store( float * p, reg_type a)   { _mm256_storeu_ps( p, a); }
+    static reg_type set1( float a)                  { return _mm256_set1_ps( a); }
+    static reg_type add( reg_type a, reg_type b)    { return _mm256_add_ps( a, b); }
+    static reg_type sub( reg_type a, reg_type b)    { return _mm256_sub_ps( a, b); }
+    static reg_type mul( reg_type a, reg_type b)    { return _mm256_mul_ps( a, b); }
+    static reg_type div( reg_type a, reg_type b)    { return _mm256_div_ps( a, b); }
+    static reg_type min( reg_type a, reg_type b)    { return _mm256_min_ps( a, b); }
+    static reg_type max( reg_type a, reg_type b)    { return _mm256_max_ps( a, b); }
+    static reg_type neg( reg_type a)                { return _mm256_xor_ps( a, _mm256_set1_ps( -0.0f)); }
+};
+
+// 16 int16s. The unpacks and the pack both work within each 128-bit half, so the lanes come
+// back out in order.
+  struct
+i16_ops_type
+{
+    typedef __m256i reg_type;
+    static size_t const width = 16;
+
+    static reg_type load( boost::int16_t const * p)         { return _mm256_loadu_si256( reinterpret_cast< __m256i const * >( p)); }
+    static void     store( boost::int16_t * p, reg_type a)  { _mm256_storeu_si256( reinterpret_cast< __m256i * >( p), a); }
+    static reg_type zero( )                                 { return _mm256_setzero_si256( ); }
+    static reg_type set1_16( boost::int16_t a)              { return _mm256_set1_epi16( a); }
+    static reg_type set1_32( boost::int32_t a)              { return _mm256_set1_epi32( a); }
+    static reg_type unpack_lo( reg_type a, reg_type b)      { return _mm256_unpacklo_epi16( a, b); }
+    static reg_type unpack_hi( reg_type a, reg_type b)      { return _mm256_unpackhi_epi16( a, b); }
+    static reg_type madd( reg_type a, reg_type b)           { return _mm256_madd_epi16( a, b); }
+    static reg_type add_32( reg_type a, reg_type b)         { return _mm256_add_epi32( a, b); }
+    static reg_type shift_right_15( reg_type a)            { return _mm256_srai_epi32( a, 15); }
+    static reg_type pack_saturate( reg_type a, reg_type b)  { return _mm256_packs_epi32( a, b); }
+    static reg_type add_saturate_16( reg_type a, reg_type b){ return _mm256_adds_epi16( a, b); }
+};
+
+# include "finite_diff_simd_kernels.h"
+
+} /* end namespace isa_avx2 */
+FINITE_DIFF_SIMD_TARGET_POP
+
+// _______________________________________________________________________________________________
+// AVX-512, 16 floats
+
+FINITE_DIFF_SIMD_TARGET_AVX512_PUSH
+namespace isa_avx512 {
+
+  struct
+ops_type
+{
+    typedef __m512 reg_type;
+    static size_t const width = 16;
+
+    static reg_type load( float const * p)          { return _mm512_loadu_ps( p); }
+    static void     store( float * p, reg_type a)   { _mm512_storeu_ps( p, a); }
+    static reg_type set1( float a)                  { return _mm512_set1_ps( a); }
+    static reg_type add( reg_type a, reg_type b)    { return _mm512_add_ps( a, b); }
+    static reg_type sub( reg_type a, reg_type b)    { return _mm512_sub_ps( a, b); }
+    static reg_type mul( reg_type a, reg_type b)    { return _mm512_mul_ps( a, b); }
+    static reg_type div( reg_type a, reg_type b)    { return _mm512_div_ps( a, b); }
+
+    // The plain _mm512_min_ps(..) and _mm512_max_ps(..) pass _mm512_undefined_ps( ) as the
+    // masked-off source, and GCC warns that it may be used uninitialized. The masked forms with
+    // every lane on compile to the same instruction.
+    static reg_type min( reg_type a, reg_type b)    { return _mm512_mask_min_ps( a, 0xffff, a, b); }
+    static reg_type max( reg_type a, reg_type b)    { return _mm512_mask_max_ps( a, 0xffff, a, b); }
+
+    // _mm512_xor_ps(..) needs AVX-512DQ, so flip the sign bit with an integer xor.
+    static reg_type neg( reg_type a)
+      { return _mm512_castsi512_ps(
+            _mm512_xor_si512( _mm512_castps_si512( a), _mm512_set1_epi32( 0x80000000))); }
+};
+
+// The 512-bit int16 instructions need AVX-512BW, and we only ask for AVX-512F. So the
+// fixed-point kernel uses the 256-bit AVX2 instructions, which AVX-512F includes.
+  struct
+i16_ops_type
+  : public isa_avx2::i16_ops_type
+{ };
+
+# include "finite_diff_simd_kernels.h"
+
+} /* end namespace isa_avx512 */
+FINITE_DIFF_SIMD_TARGET_POP
+
+# endif /* CPU_FEATURES_X86 */
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// The kernel tables
+
+namespace /* anonymous */ {
+
+  struct
+kernel_tables_type
+{
+    explicit
+    kernel_tables_type( cpu_features::simd_level_type level)
+    {
+        std::fill_n( reinterpret_cast< char * >( & fd), sizeof( fd), 0);
+        std::fill_n( reinterpret_cast< char * >( & la), sizeof( la), 0);
+
+        fd.level = la.level = level;
+#       if CPU_FEATURES_X86
+        switch ( fd.level ) {
+          case cpu_features::e_scalar : break;
+          case cpu_features::e_sse2   : isa_sse2  ::fill_kernels( fd, la); break;
+          case cpu_features::e_avx2   : isa_avx2  ::fill_kernels( fd, la); break;
+          case cpu_features::e_avx512 : isa_avx512::fill_kernels( fd, la); break;
+        }
+#       else
+        fd.level = la.level = cpu_features::e_scalar;
+#       endif
+    }
+
+    finite_difference::simd::kernels_type  fd ;
+    linear_algebra::simd::kernels_type     la ;
+};
+
+  kernel_tables_type const &
+get_kernel_tables_at_level( cpu_features::simd_level_type level)
+  //
+  // The tables for every level are filled in, even the ones this CPU cannot run. Filling them
+  // in only takes the addresses of the kernels.
+{
+    static kernel_tables_type const tables[ 4 ] =
+     {  kernel_tables_type( cpu_features::e_scalar)
+      , kernel_tables_type( cpu_features::e_sse2  )
+      , kernel_tables_type( cpu_features::e_avx2  )
+      , kernel_tables_type( cpu_features::e_avx512)
+     };
+    return tables[ level ];
+}
+
+// The tables the solvers use. Zero until the first time we ask (this is zero-initialized, so
+// it's zero before any static ctor runs).
+kernel_tables_type const * g_p_current_tables = 0;
+
+  kernel_tables_type const &
+get_kernel_tables( )
+{
+    // Filled in the first time we ask, which is before the first solve.
+    if ( ! g_p_current_tables ) {
+        g_p_current_tables = & get_kernel_tables_at_level( cpu_features::get_simd_level( ));
+    }
+    return *g_p_current_tables;
+}
+
+// Make sure the tables are filled in before any solver threads start.
+kernel_tables_type const & g_kernel_tables = get_kernel_tables( );
+
+} /* end anonymous namespace */
+
+  kernels_type const &
+get_kernels( )
+{
+    return get_kernel_tables( ).fd;
+}
+
+  bool
+set_kernel_level( cpu_features::simd_level_type level)
+{
+    if ( level > cpu_features::get_simd_level( ) ) return false;
+    g_p_current_tables = & get_kernel_tables_at_level( level);
+    return true;
+}
+
+// _______________________________________________________________________________________________
+//
+} /* end namespace simd */
+} /* end namespace finite_difference */
+// _______________________________________________________________________________________________
+
+// _______________________________________________________________________________________________
+//
+namespace linear_algebra {
+namespace simd {
+// _______________________________________________________________________________________________
+
+  kernels_type const &
+get_kernels( )
+{
+    return finite_difference::simd::get_kernel_tables( ).la;
+}
+
+// _______________________________________________________________________________________________
+//
+} /* end namespace simd */
+} /* end namespace linear_algebra */
+// _______________________________________________________________________________________________
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// finite_diff_simd.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
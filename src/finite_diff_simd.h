@@ -0,0 +1,941 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// finite_diff_simd.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef FINITE_DIFF_SIMD_H
+# define FINITE_DIFF_SIMD_H
+// _______________________________________________________________________________________________
+// Notes
+//
+//   Vectorized versions of the row kernels in finite_diff.h and tri_diag.h.
+//
+//   The scalar forward-diff kernels walk a 3-wide window over the src row and carry src_0/src_1
+//   from one cell to the next. That loop-carried dependency keeps the compiler from vectorizing
+//   them. The vector kernels do the same arithmetic but load the window as 3 overlapping
+//   (unaligned) vectors:
+//     src[ i-1 .. ], src[ i .. ], src[ i+1 .. ]
+//   The first and last cells of each row (the insulated edges) are still calculated one at a
+//   time, as is the tail of the row that doesn't fill a whole vector.
+//
+//   The vector code performs the same float operations in the same order as the scalar code
+//   (no fused multiply-add, no re-association), so on SSE hardware the results are bit-for-bit
+//   the same. On a 32-bit x87 build the scalar code may keep extra precision in registers, so
+//   there the two paths can differ in the last bit or so.
+//
+//   The kernels are compiled several times, once for each instruction set (SSE2, AVX2, AVX-512),
+//   in finite_diff_simd.cpp. At startup we ask the CPU what it supports (cpu_features.h) and
+//   fill in kernels_type with the best version. So one binary runs everywhere and still uses
+//   the wide vectors where they exist.
+//
+//   The vector kernels are only used when:
+//     The rate type is float.
+//     The src, side, and trg rows are all contiguous floats (std::vector< float > iterators,
+//       or stride_iter<..,0> wrappers around them with a stride of 1).
+//     For forward diff, the trg row does not overlap the src or side rows. The scalar kernels
+//       allow (src_iter == trg_iter) because they keep the window in registers. The vector
+//       loads would see values that had already been overwritten.
+//     The row has at least 2 cells.
+//   Otherwise the try_..(..) functions return false and the caller uses the scalar templates.
+//
+//   The column kernels for backward and central diff are a little different. The Thomas solve
+//   of one column is a chain of dependent divides, so there is nothing to put in vector lanes.
+//   Instead they solve a vector of adjacent columns together, one column in each lane.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <vector>
+# include <cstddef>
+# include <boost/cstdint.hpp>
+# include <boost/type_traits/is_same.hpp>
+# include "cpu_features.h"
+
+// Forward declaration, from stride_iter.h. We do not #include stride_iter.h here because
+// finite_diff.h doesn't need it. The stride_iter overloads below are templates so they are not
+// compiled until they are used, and by then stride_iter.h has been included.
+template< typename LEAF_ITER_T, size_t DEPTH > class stride_iter;
+
+namespace finite_difference {
+namespace simd {
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Kernel table
+
+  struct
+kernels_type
+{
+    typedef void (* forward_diff_2d_middle_type)
+     (  float damping, float rate, float rate_side
+      , float const * p_src, size_t count
+      , float const * p_side_a, float const * p_side_b
+      , float * p_trg
+      , float clamp_limit
+     );
+    typedef void (* forward_diff_2d_edge_type)
+     (  float damping, float rate, float rate_side
+      , float const * p_src, size_t count
+      , float const * p_side
+      , float * p_trg
+      , float clamp_limit
+     );
+    typedef void (* forward_diff_2d_wide_type)
+     (  float damping, float rate, float rate_side
+      , float const * const * p_rows, size_t count
+      , float * p_trg
+      , float clamp_limit
+     );
+    typedef void (* forward_diff_2d_varying_type)
+     (  float damping, float rate, float rate_side
+      , float const * p_src, size_t count
+      , float const * p_side_a, float const * p_side_b
+      , float const * p_coef, float const * p_coef_a, float const * p_coef_b
+      , float * p_trg
+      , float clamp_limit
+     );
+    typedef void (* forward_diff_thin_strip_type)
+     (  float damping, float base, float rate
+      , float const * p_src, size_t count
+      , float * p_trg
+      , float clamp_limit
+     );
+    typedef void (* implicit_diff_1d_type)
+     (  float damping, float rate
+      , float const * p_src, size_t count
+      , float * p_trg, float * p_srcX, float * p_diagX
+     );
+    typedef void (* implicit_diff_columns_type)
+     (  float damping, float rate
+      , float const * p_src, float * p_trg, std::ptrdiff_t row_stride
+      , size_t column_count, size_t row_count
+      , float * p_scratch
+     );
+    typedef void (* implicit_diff_columns_varying_type)
+     (  float damping, float rate
+      , float const * p_src, float const * p_coef, float * p_trg, std::ptrdiff_t row_stride
+      , size_t column_count, size_t row_count
+      , float * p_scratch
+     );
+    typedef void (* leapfrog_velocity_type)
+     (  float damping, size_t count
+      , float const * p_src, float * p_velocity, float * p_trg
+      , float clamp_limit
+     );
+    typedef void (* forward_diff_2d_fixed16_type)
+     (  boost::int16_t rate, boost::int16_t rate_side
+      , boost::int16_t const * p_src, size_t count
+      , boost::int16_t const * p_side_a, boost::int16_t const * p_side_b
+      , boost::int16_t * p_trg
+     );
+
+    cpu_features::simd_level_type  level                   ;
+    forward_diff_2d_middle_type    forward_diff_2d_middle  ;
+    forward_diff_2d_edge_type      forward_diff_2d_edge    ;
+    forward_diff_thin_strip_type   forward_diff_thin_strip ;
+    forward_diff_2d_wide_type      forward_diff_2d_9_point ;
+    forward_diff_2d_wide_type      forward_diff_2d_4th_order ;
+    forward_diff_2d_varying_type   forward_diff_2d_varying ;
+    leapfrog_velocity_type         leapfrog_velocity       ;
+    implicit_diff_1d_type          backward_diff_1d        ;
+    implicit_diff_1d_type          central_diff_1d         ;
+    implicit_diff_columns_type     backward_diff_columns   ;
+    implicit_diff_columns_type     central_diff_columns    ;
+    implicit_diff_columns_varying_type
+                                   backward_diff_columns_varying ;
+    implicit_diff_columns_varying_type
+                                   central_diff_columns_varying  ;
+    forward_diff_2d_fixed16_type   forward_diff_2d_fixed16 ;
+};
+
+// The kernels picked for this CPU at startup. The pointers are all zero when there are no
+// vector kernels for this CPU.
+kernels_type const &  get_kernels( )  ;
+
+// Switches the solvers (and linear_algebra::simd::get_kernels( )) to the kernels for another
+// level. e_scalar means no kernels, so the plain C++ code runs. The tests use this to compare
+// each level with the scalar code. Returns false, and changes nothing, if this CPU cannot run
+// that level. Only call it when nothing is solving.
+bool  set_kernel_level( cpu_features::simd_level_type)  ;
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// get_contiguous_float_ptr(..)
+//
+//   Returns a pointer to the float an iterator points to, but only when we know the iterator
+//   walks over contiguous floats. Otherwise returns zero.
+
+  template< typename ITER_TYPE >
+  float *
+get_contiguous_float_ptr( ITER_TYPE const & /* iter */)
+{
+    return 0;
+}
+
+  inline
+  float *
+get_contiguous_float_ptr( std::vector< float >::iterator const & iter)
+{
+    return & (*iter);
+}
+
+  inline
+  float *
+get_contiguous_float_ptr( std::vector< float >::const_iterator const & iter)
+{
+    // The kernels never write thru a src pointer.
+    return const_cast< float * >( & (*iter));
+}
+
+  template< typename LEAF_ITER_TYPE >
+  float *
+get_contiguous_float_ptr( stride_iter< LEAF_ITER_TYPE, 0 > const & iter)
+{
+    return (iter.get_stride( ) == 1) ? get_contiguous_float_ptr( iter.get_leaf_iter( )) : 0;
+}
+
+// _______________________________________________________________________________________________
+// get_strided_float_ptr(..)
+//
+//   Like get_contiguous_float_ptr(..) except it also accepts a stride_iter with any stride.
+
+  template< typename ITER_TYPE >
+  float *
+get_strided_float_ptr( ITER_TYPE const & iter, std::ptrdiff_t & stride)
+{
+    stride = 1;
+    return get_contiguous_float_ptr( iter);
+}
+
+  template< typename LEAF_ITER_TYPE >
+  float *
+get_strided_float_ptr( stride_iter< LEAF_ITER_TYPE, 0 > const & iter, std::ptrdiff_t & stride)
+{
+    stride = iter.get_stride( );
+    return get_contiguous_float_ptr( iter.get_leaf_iter( ));
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename ITER_TYPE >
+  size_t
+get_contiguous_count( float const * p_lo, ITER_TYPE const & iter_limit)
+  //
+  // The limit is one past the end, so we cannot dereference it.
+{
+    return (get_contiguous_float_ptr( iter_limit - 1) + 1) - p_lo;
+}
+
+  inline
+  bool
+is_overlap( float const * p_a, float const * p_b, size_t count)
+{
+    return (p_a < (p_b + count)) && (p_b < (p_a + count));
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// try_calc_forward_diff_2d_middle(..)
+// try_calc_forward_diff_2d_edge(..)
+// try_calc_forward_diff_thin_strip(..)
+//
+//   Returns true if the row was solved with the vector kernel.
+//   Returns false, without touching trg, if the caller should use the scalar kernel.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_forward_diff_2d_middle
+ (  RATE_TYPE     const    damping
+  , RATE_TYPE     const    rate
+  , RATE_TYPE     const    rate_side
+  , SRC_ITER_TYPE const &  src_iter
+  , SRC_ITER_TYPE const &  src_iter_limit
+  , SRC_ITER_TYPE const &  src_iter_side_a
+  , SRC_ITER_TYPE const &  src_iter_side_b
+  , TRG_ITER_TYPE const &  trg_iter
+  , RATE_TYPE     const    clamp_limit
+ )
+{
+    // With double rates the scalar code calculates in double, and we would not match it.
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return false;
+    if ( ! get_kernels( ).forward_diff_2d_middle ) return false;
+    if ( ! (src_iter < src_iter_limit) ) return false;
+
+    float const * const  p_src    = get_contiguous_float_ptr( src_iter       );
+    float const * const  p_side_a = get_contiguous_float_ptr( src_iter_side_a);
+    float const * const  p_side_b = get_contiguous_float_ptr( src_iter_side_b);
+    float       * const  p_trg    = get_contiguous_float_ptr( trg_iter       );
+    if ( (! p_src) || (! p_side_a) || (! p_side_b) || (! p_trg) ) return false;
+
+    size_t const count = get_contiguous_count( p_src, src_iter_limit);
+    if ( count < 2 ) return false;
+    if ( is_overlap( p_trg, p_src   , count) ) return false;
+    if ( is_overlap( p_trg, p_side_a, count) ) return false;
+    if ( is_overlap( p_trg, p_side_b, count) ) return false;
+
+    get_kernels( ).forward_diff_2d_middle
+     (  static_cast< float >( damping)
+      , static_cast< float >( rate)
+      , static_cast< float >( rate_side)
+      , p_src, count, p_side_a, p_side_b, p_trg
+      , static_cast< float >( clamp_limit)
+     );
+    return true;
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_forward_diff_2d_edge
+ (  RATE_TYPE     const    damping
+  , RATE_TYPE     const    rate
+  , RATE_TYPE     const    rate_side
+  , SRC_ITER_TYPE const &  src_iter
+  , SRC_ITER_TYPE const &  src_iter_limit
+  , SRC_ITER_TYPE const &  src_iter_side
+  , TRG_ITER_TYPE const &  trg_iter
+  , RATE_TYPE     const    clamp_limit
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return false;
+    if ( ! get_kernels( ).forward_diff_2d_edge ) return false;
+    if ( ! (src_iter < src_iter_limit) ) return false;
+
+    float const * const  p_src    = get_contiguous_float_ptr( src_iter     );
+    float const * const  p_side   = get_contiguous_float_ptr( src_iter_side);
+    float       * const  p_trg    = get_contiguous_float_ptr( trg_iter     );
+    if ( (! p_src) || (! p_side) || (! p_trg) ) return false;
+
+    size_t const count = get_contiguous_count( p_src, src_iter_limit);
+    if ( count < 2 ) return false;
+    if ( is_overlap( p_trg, p_src , count) ) return false;
+    if ( is_overlap( p_trg, p_side, count) ) return false;
+
+    get_kernels( ).forward_diff_2d_edge
+     (  static_cast< float >( damping)
+      , static_cast< float >( rate)
+      , static_cast< float >( rate_side)
+      , p_src, count, p_side, p_trg
+      , static_cast< float >( clamp_limit)
+     );
+    return true;
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_forward_diff_thin_strip
+ (  RATE_TYPE     const    damping   // 1 for calc_next_generation_forward_difference_1d(..)
+  , RATE_TYPE     const    base
+  , RATE_TYPE     const    rate
+  , SRC_ITER_TYPE const &  src_iter
+  , SRC_ITER_TYPE const &  src_iter_limit
+  , TRG_ITER_TYPE const &  trg_iter
+  , RATE_TYPE     const    clamp_limit
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return false;
+    if ( ! get_kernels( ).forward_diff_thin_strip ) return false;
+    if ( ! (src_iter < src_iter_limit) ) return false;
+
+    float const * const  p_src    = get_contiguous_float_ptr( src_iter);
+    float       * const  p_trg    = get_contiguous_float_ptr( trg_iter);
+    if ( (! p_src) || (! p_trg) ) return false;
+
+    size_t const count = get_contiguous_count( p_src, src_iter_limit);
+    if ( count < 2 ) return false;
+    if ( is_overlap( p_trg, p_src, count) ) return false;
+
+    get_kernels( ).forward_diff_thin_strip
+     (  static_cast< float >( damping)
+      , static_cast< float >( base)
+      , static_cast< float >( rate)
+      , p_src, count, p_trg
+      , static_cast< float >( clamp_limit)
+     );
+    return true;
+}
+
+// _______________________________________________________________________________________________
+// try_calc_forward_diff_2d_9_point(..)
+// try_calc_forward_diff_2d_4th_order(..)
+//
+//   Same params as calc_next_generation_forward_difference_2d_wide(..) in finite_diff.h, without
+//   the stencil. All 5 rows must be contiguous floats. They can repeat (the mirrored rows at the
+//   top and bottom edges) but must not overlap the trg row.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_forward_diff_2d_wide_
+ (  kernels_type::forward_diff_2d_wide_type const  kernel
+  , RATE_TYPE     const    damping
+  , RATE_TYPE     const    rate
+  , RATE_TYPE     const    rate_side
+  , SRC_ITER_TYPE const *  p_rows
+  , SRC_ITER_TYPE const &  src_iter_limit
+  , TRG_ITER_TYPE const &  trg_iter
+  , RATE_TYPE     const    clamp_limit
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return false;
+    if ( ! kernel ) return false;
+    if ( ! (p_rows[ 2 ] < src_iter_limit) ) return false;
+
+    float       * const  p_trg  = get_contiguous_float_ptr( trg_iter);
+    if ( ! p_trg ) return false;
+
+    float const * p_row_floats[ 5 ] = { 0, 0, 0, 0, 0 };
+    for ( int index = 0 ; index < 5 ; ++ index ) {
+        p_row_floats[ index ] = get_contiguous_float_ptr( p_rows[ index ]);
+        if ( ! p_row_floats[ index ] ) return false;
+    }
+
+    size_t const count = get_contiguous_count( p_row_floats[ 2 ], src_iter_limit);
+    if ( count < 2 ) return false;
+    for ( int index = 0 ; index < 5 ; ++ index ) {
+        if ( is_overlap( p_trg, p_row_floats[ index ], count) ) return false;
+    }
+
+    kernel
+     (  static_cast< float >( damping)
+      , static_cast< float >( rate)
+      , static_cast< float >( rate_side)
+      , p_row_floats, count, p_trg
+      , static_cast< float >( clamp_limit)
+     );
+    return true;
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_forward_diff_2d_9_point
+ (  RATE_TYPE     const    damping
+  , RATE_TYPE     const    rate
+  , RATE_TYPE     const    rate_side
+  , SRC_ITER_TYPE const *  p_rows
+  , SRC_ITER_TYPE const &  src_iter_limit
+  , TRG_ITER_TYPE const &  trg_iter
+  , RATE_TYPE     const    clamp_limit
+ )
+{
+    return try_calc_forward_diff_2d_wide_
+     (  get_kernels( ).forward_diff_2d_9_point
+      , damping, rate, rate_side, p_rows, src_iter_limit, trg_iter, clamp_limit
+     );
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_forward_diff_2d_4th_order
+ (  RATE_TYPE     const    damping
+  , RATE_TYPE     const    rate
+  , RATE_TYPE     const    rate_side
+  , SRC_ITER_TYPE const *  p_rows
+  , SRC_ITER_TYPE const &  src_iter_limit
+  , TRG_ITER_TYPE const &  trg_iter
+  , RATE_TYPE     const    clamp_limit
+ )
+{
+    return try_calc_forward_diff_2d_wide_
+     (  get_kernels( ).forward_diff_2d_4th_order
+      , damping, rate, rate_side, p_rows, src_iter_limit, trg_iter, clamp_limit
+     );
+}
+
+// _______________________________________________________________________________________________
+// try_calc_forward_diff_2d_varying(..)
+//
+//   Same params as calc_next_generation_forward_difference_2d_varying(..) in finite_diff.h.
+//   The src, side, and coefficient rows must all be contiguous floats. The side rows can be the
+//   src row (at the top and bottom edges), but none of the rows can overlap the trg row.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename COEF_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_forward_diff_2d_varying
+ (  RATE_TYPE      const    damping
+  , RATE_TYPE      const    rate
+  , RATE_TYPE      const    rate_side
+  , SRC_ITER_TYPE  const &  src_iter
+  , SRC_ITER_TYPE  const &  src_iter_limit
+  , SRC_ITER_TYPE  const &  src_iter_side_a
+  , SRC_ITER_TYPE  const &  src_iter_side_b
+  , COEF_ITER_TYPE const &  coef_iter
+  , COEF_ITER_TYPE const &  coef_iter_side_a
+  , COEF_ITER_TYPE const &  coef_iter_side_b
+  , TRG_ITER_TYPE  const &  trg_iter
+  , RATE_TYPE      const    clamp_limit
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return false;
+    if ( ! get_kernels( ).forward_diff_2d_varying ) return false;
+    if ( ! (src_iter < src_iter_limit) ) return false;
+
+    float const * const  p_src     = get_contiguous_float_ptr( src_iter        );
+    float const * const  p_side_a  = get_contiguous_float_ptr( src_iter_side_a );
+    float const * const  p_side_b  = get_contiguous_float_ptr( src_iter_side_b );
+    float const * const  p_coef    = get_contiguous_float_ptr( coef_iter       );
+    float const * const  p_coef_a  = get_contiguous_float_ptr( coef_iter_side_a);
+    float const * const  p_coef_b  = get_contiguous_float_ptr( coef_iter_side_b);
+    float       * const  p_trg     = get_contiguous_float_ptr( trg_iter        );
+    if ( (! p_src) || (! p_side_a) || (! p_side_b) || (! p_trg) ) return false;
+    if ( (! p_coef) || (! p_coef_a) || (! p_coef_b) ) return false;
+
+    size_t const count = get_contiguous_count( p_src, src_iter_limit);
+    if ( count < 2 ) return false;
+    if ( is_overlap( p_trg, p_src   , count) ) return false;
+    if ( is_overlap( p_trg, p_side_a, count) ) return false;
+    if ( is_overlap( p_trg, p_side_b, count) ) return false;
+    if ( is_overlap( p_trg, p_coef  , count) ) return false;
+    if ( is_overlap( p_trg, p_coef_a, count) ) return false;
+    if ( is_overlap( p_trg, p_coef_b, count) ) return false;
+
+    get_kernels( ).forward_diff_2d_varying
+     (  static_cast< float >( damping)
+      , static_cast< float >( rate)
+      , static_cast< float >( rate_side)
+      , p_src, count, p_side_a, p_side_b
+      , p_coef, p_coef_a, p_coef_b
+      , p_trg
+      , static_cast< float >( clamp_limit)
+     );
+    return true;
+}
+
+// _______________________________________________________________________________________________
+// try_calc_leapfrog_velocity(..)
+//
+//   Same params as calc_leapfrog_velocity(..) in finite_diff.h. The src, velocity, and trg rows
+//   must be contiguous floats, and the velocity row cannot overlap the other two.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  bool
+try_calc_leapfrog_velocity
+ (  RATE_TYPE      const    damping
+  , std::ptrdiff_t const    count
+  , SRC_ITER_TYPE  const &  src_iter
+  , TRG_ITER_TYPE  const &  velocity_iter
+  , TRG_ITER_TYPE  const &  trg_iter
+  , RATE_TYPE      const    clamp_limit
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return false;
+    if ( ! get_kernels( ).leapfrog_velocity ) return false;
+    if ( count <= 0 ) return false;
+
+    float const * const  p_src       = get_contiguous_float_ptr( src_iter     );
+    float       * const  p_velocity  = get_contiguous_float_ptr( velocity_iter);
+    float       * const  p_trg       = get_contiguous_float_ptr( trg_iter     );
+    if ( (! p_src) || (! p_velocity) || (! p_trg) ) return false;
+
+    // The rows are contiguous at the lo end. Make sure they are all the way to the end.
+    if ( (get_contiguous_float_ptr( src_iter      + (count - 1)) != (p_src      + (count - 1))) ||
+         (get_contiguous_float_ptr( velocity_iter + (count - 1)) != (p_velocity + (count - 1))) ||
+         (get_contiguous_float_ptr( trg_iter      + (count - 1)) != (p_trg      + (count - 1))) ) {
+        return false;
+    }
+    if ( is_overlap( p_velocity, p_src, count) ) return false;
+    if ( is_overlap( p_velocity, p_trg, count) ) return false;
+
+    get_kernels( ).leapfrog_velocity
+     (  static_cast< float >( damping)
+      , static_cast< size_t >( count)
+      , p_src, p_velocity, p_trg
+      , static_cast< float >( clamp_limit)
+     );
+    return true;
+}
+
+// _______________________________________________________________________________________________
+// try_calc_backward_difference_1d(..)
+// try_calc_central_difference_1d(..)
+//
+//   The implicit solvers. As with the scalar versions, src can be the same as trg but the
+//   temp buffers must be distinct. The careful solver (rate < 0) is never vectorized.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename TEMP_ITER_TYPE
+   >
+  bool
+try_calc_implicit_difference_1d_
+ (  kernels_type::implicit_diff_1d_type  p_kernel
+  , RATE_TYPE      const    damping
+  , RATE_TYPE      const    rate
+  , SRC_ITER_TYPE  const &  src_iter
+  , SRC_ITER_TYPE  const &  src_iter_limit
+  , TRG_ITER_TYPE  const &  trg_iter
+  , TEMP_ITER_TYPE const &  srcX_iter
+  , TEMP_ITER_TYPE const &  diagX_iter
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return false;
+    if ( ! p_kernel ) return false;
+    if ( rate < 0 ) return false;
+    if ( ! (src_iter < src_iter_limit) ) return false;
+
+    float const * const  p_src    = get_contiguous_float_ptr( src_iter  );
+    float       * const  p_trg    = get_contiguous_float_ptr( trg_iter  );
+    float       * const  p_srcX   = get_contiguous_float_ptr( srcX_iter );
+    float       * const  p_diagX  = get_contiguous_float_ptr( diagX_iter);
+    if ( (! p_src) || (! p_trg) || (! p_srcX) || (! p_diagX) ) return false;
+
+    size_t const count = get_contiguous_count( p_src, src_iter_limit);
+    if ( count < 2 ) return false;
+
+    p_kernel
+     (  static_cast< float >( damping)
+      , static_cast< float >( rate)
+      , p_src, count, p_trg, p_srcX, p_diagX
+     );
+    return true;
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename TEMP_ITER_TYPE
+   >
+  bool
+try_calc_backward_difference_1d
+ (  RATE_TYPE      const    damping
+  , RATE_TYPE      const    rate
+  , SRC_ITER_TYPE  const &  src_iter
+  , SRC_ITER_TYPE  const &  src_iter_limit
+  , TRG_ITER_TYPE  const &  trg_iter
+  , TEMP_ITER_TYPE const &  srcX_iter
+  , TEMP_ITER_TYPE const &  diagX_iter
+ )
+{
+    return
+        try_calc_implicit_difference_1d_
+         (  get_kernels( ).backward_diff_1d
+          , damping, rate, src_iter, src_iter_limit, trg_iter, srcX_iter, diagX_iter
+         );
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename TEMP_ITER_TYPE
+   >
+  bool
+try_calc_central_difference_1d
+ (  RATE_TYPE      const    damping
+  , RATE_TYPE      const    rate
+  , SRC_ITER_TYPE  const &  src_iter
+  , SRC_ITER_TYPE  const &  src_iter_limit
+  , TRG_ITER_TYPE  const &  trg_iter
+  , TEMP_ITER_TYPE const &  srcX_iter
+  , TEMP_ITER_TYPE const &  diagX_iter
+ )
+{
+    return
+        try_calc_implicit_difference_1d_
+         (  get_kernels( ).central_diff_1d
+          , damping, rate, src_iter, src_iter_limit, trg_iter, srcX_iter, diagX_iter
+         );
+}
+
+// _______________________________________________________________________________________________
+// get_implicit_difference_columns_kernel(..)
+// get_implicit_difference_columns_scratch_count(..)
+//
+//   The column kernels solve a run of adjacent columns of a sheet at once, each column in its
+//   own vector lane, reading and writing the sheet directly. They match
+//   calc_next_generation_backward_difference_1d(..) (base 1) and
+//   calc_next_generation_central_difference_1d(..) (base 2) solving one column at a time.
+//
+//   The kernel is called with pointers to the top of the first column in the src and trg
+//   sheets, the row stride (sheet width), and scratch space for each run of columns.
+//   src and trg can be the same sheet but must not otherwise overlap.
+//
+//   Returns zero if we cannot use a kernel for this solve.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  kernels_type::implicit_diff_columns_type
+get_implicit_difference_columns_kernel
+ (  RATE_TYPE     const    base      // 1 for backward diff, 2 for central diff
+  , RATE_TYPE     const    rate
+  , SRC_ITER_TYPE const &  src_iter  // first cell in the src sheet
+  , TRG_ITER_TYPE const &  trg_iter  // first cell in the trg sheet
+  , size_t        const    x_count
+  , size_t        const    y_count
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return 0;
+    if ( rate < 0 ) return 0;
+    if ( y_count < 2 ) return 0;
+
+    kernels_type::implicit_diff_columns_type const p_kernel =
+        (base == 1) ? get_kernels( ).backward_diff_columns :
+        (base == 2) ? get_kernels( ).central_diff_columns  : 0;
+    if ( ! p_kernel ) return 0;
+
+    float const * const  p_src  = get_contiguous_float_ptr( src_iter);
+    float const * const  p_trg  = get_contiguous_float_ptr( trg_iter);
+    if ( (! p_src) || (! p_trg) ) return 0;
+    if ( (p_src != p_trg) && is_overlap( p_src, p_trg, x_count * y_count) ) return 0;
+
+    return p_kernel;
+}
+
+  inline
+  size_t
+get_implicit_difference_columns_scratch_count( size_t column_count, size_t row_count)
+{
+    return (column_count + 2) * row_count;
+}
+
+// _______________________________________________________________________________________________
+// get_implicit_difference_columns_varying_kernel(..)
+// get_implicit_difference_columns_varying_scratch_count(..)
+//
+//   The same for calc_next_generation_implicit_difference_1d_varying(..). The kernel also gets
+//   a pointer to the top of the first column in the coefficient sheet, which has the same row
+//   stride as the src sheet. Every column has its own matrix, so each lane keeps its own scale
+//   factors and the scratch space is twice the size of the strip.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  kernels_type::implicit_diff_columns_varying_type
+get_implicit_difference_columns_varying_kernel
+ (  RATE_TYPE     const    base      // 1 for backward diff, 2 for central diff
+  , RATE_TYPE     const    rate
+  , SRC_ITER_TYPE const &  src_iter  // first cell in the src sheet
+  , float const *   const  p_coef    // first cell in the coefficient sheet
+  , TRG_ITER_TYPE const &  trg_iter  // first cell in the trg sheet
+  , size_t        const    x_count
+  , size_t        const    y_count
+ )
+{
+    if ( ! boost::is_same< RATE_TYPE, float >::value ) return 0;
+    if ( rate < 0 ) return 0;
+    if ( y_count < 2 ) return 0;
+
+    kernels_type::implicit_diff_columns_varying_type const p_kernel =
+        (base == 1) ? get_kernels( ).backward_diff_columns_varying :
+        (base == 2) ? get_kernels( ).central_diff_columns_varying  : 0;
+    if ( ! p_kernel ) return 0;
+
+    float const * const  p_src  = get_contiguous_float_ptr( src_iter);
+    float const * const  p_trg  = get_contiguous_float_ptr( trg_iter);
+    if ( (! p_src) || (! p_trg) || (! p_coef) ) return 0;
+    if ( (p_src != p_trg) && is_overlap( p_src, p_trg, x_count * y_count) ) return 0;
+    if ( is_overlap( p_coef, p_trg, x_count * y_count) ) return 0;
+
+    return p_kernel;
+}
+
+  inline
+  size_t
+get_implicit_difference_columns_varying_scratch_count( size_t column_count, size_t row_count)
+{
+    return 2 * column_count * row_count;
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// try_calc_forward_diff_2d_fixed(..)
+//
+//   Same params as calc_next_generation_forward_difference_2d_fixed(..) in finite_diff.h.
+//   Only 16-bit fixed point has a vector kernel. The 32-bit kernel would need 64-bit multiplies,
+//   which SSE2 and AVX2 do not have.
+
+  template< typename INT_TYPE >
+  inline
+  bool
+try_calc_forward_diff_2d_fixed
+ (  INT_TYPE    const    // rate
+  , INT_TYPE    const    // rate_side
+  , INT_TYPE    const *  // p_src
+  , size_t      const    // count
+  , INT_TYPE    const *  // p_side_a
+  , INT_TYPE    const *  // p_side_b
+  , INT_TYPE          *  // p_trg
+ )
+{
+    return false;
+}
+
+  inline
+  bool
+try_calc_forward_diff_2d_fixed
+ (  boost::int16_t const    rate
+  , boost::int16_t const    rate_side
+  , boost::int16_t const *  p_src
+  , size_t         const    count
+  , boost::int16_t const *  p_side_a
+  , boost::int16_t const *  p_side_b
+  , boost::int16_t       *  p_trg
+ )
+{
+    if ( ! get_kernels( ).forward_diff_2d_fixed16 ) return false;
+    if ( count < 2 ) return false;
+
+    get_kernels( ).forward_diff_2d_fixed16( rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg);
+    return true;
+}
+
+} /* end namespace simd */
+} /* end namespace finite_difference */
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+
+namespace util {
+  template< typename ITEM_TYPE > struct assign_set_type;
+  template< typename ITEM_TYPE > struct assign_sum_type;
+} /* end namespace util */
+
+namespace linear_algebra {
+namespace simd {
+
+// _______________________________________________________________________________________________
+// Kernel table
+
+  struct
+kernels_type
+{
+    // out can have any stride. diag and in must be contiguous.
+    typedef void (* solve_tridiagonal_type)
+     (  size_t count
+      , float sub_diag_value, float * p_diag, float super_diag_value
+      , float * p_in
+      , float * p_out, std::ptrdiff_t out_stride
+     );
+
+    cpu_features::simd_level_type  level                  ;
+    solve_tridiagonal_type         solve_tridiagonal_set  ;  // out = x
+    solve_tridiagonal_type         solve_tridiagonal_sum  ;  // out += x
+};
+
+kernels_type const &  get_kernels( )  ;
+
+// _______________________________________________________________________________________________
+// try_solve_tridiagonal_destructive(..)
+//
+//   Same params as solve_tridiagonal_destructive(..) in tri_diag.h.
+//   Only util::assign_set_type< float > and util::assign_sum_type< float > are vectorized.
+
+  template< typename ASSIGN_FUNCTOR_TYPE >
+  kernels_type::solve_tridiagonal_type
+get_solve_tridiagonal_kernel( ASSIGN_FUNCTOR_TYPE const & /* assign_functor */)
+{
+    return 0;
+}
+
+  inline
+  kernels_type::solve_tridiagonal_type
+get_solve_tridiagonal_kernel( util::assign_set_type< float > const & /* assign_functor */)
+{
+    return get_kernels( ).solve_tridiagonal_set;
+}
+
+  inline
+  kernels_type::solve_tridiagonal_type
+get_solve_tridiagonal_kernel( util::assign_sum_type< float > const & /* assign_functor */)
+{
+    return get_kernels( ).solve_tridiagonal_sum;
+}
+
+  template
+   <  typename ASSIGN_FUNCTOR_TYPE
+    , typename ITEM_TYPE
+    , typename DIAG_ITER_TYPE
+    , typename IN_VECT_ITER_TYPE
+    , typename OUT_VECT_ITER_TYPE
+   >
+  bool
+try_solve_tridiagonal_destructive
+ (  ASSIGN_FUNCTOR_TYPE  const &  assign_functor
+  , std::size_t          const    count
+  , ITEM_TYPE            const    sub_diag_value
+  , DIAG_ITER_TYPE       const &  diag_vect
+  , ITEM_TYPE            const    super_diag_value
+  , IN_VECT_ITER_TYPE    const &  in_vect
+  , OUT_VECT_ITER_TYPE   const &  out_vect
+ )
+{
+    if ( ! boost::is_same< ITEM_TYPE, float >::value ) return false;
+    kernels_type::solve_tridiagonal_type const p_kernel = get_solve_tridiagonal_kernel( assign_functor);
+    if ( ! p_kernel ) return false;
+    if ( count < 1 ) return false;
+
+    std::ptrdiff_t out_stride = 0;
+    float * const  p_diag = finite_difference::simd::get_contiguous_float_ptr( diag_vect);
+    float * const  p_in   = finite_difference::simd::get_contiguous_float_ptr( in_vect  );
+    float * const  p_out  = finite_difference::simd::get_strided_float_ptr( out_vect, out_stride);
+    if ( (! p_diag) || (! p_in) || (! p_out) ) return false;
+
+    p_kernel
+     (  count
+      , static_cast< float >( sub_diag_value), p_diag, static_cast< float >( super_diag_value)
+      , p_in
+      , p_out, out_stride
+     );
+    return true;
+}
+
+} /* end namespace simd */
+} /* end namespace linear_algebra */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef FINITE_DIFF_SIMD_H
+//
+// finite_diff_simd.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,1679 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// finite_diff_simd_kernels.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// There is deliberately no #pragma once or include guard here.
+//
+// finite_diff_simd.cpp includes this file once for each instruction set, each time inside its
+// own namespace and (for gcc and clang) inside a target-attribute region. Before including it
+// the namespace must define ops_type and i16_ops_type (see isa_sse2::ops_type in
+// finite_diff_simd.cpp). Everything here is compiled for those and that instruction set.
+//
+// The kernels repeat the arithmetic of the scalar templates in finite_diff.h and tri_diag.h
+// with the same operations in the same order, so they give the same answers bit-for-bit.
+// They never use fused multiply-add for that reason.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+typedef ops_type::reg_type reg_type;
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Vector assign3 functors
+//
+//   These match the assign3_..._type functors in finite_diff.h. Each has a scalar operator()
+//   (for the edges and the tail of the row) and a vector operator().
+
+  struct
+assign3_set_type
+{
+    void operator ()( float & trg, float /* src */, float side) const
+      { trg = side; }
+
+    void operator ()( float * p_trg, reg_type /* src */, reg_type side) const
+      { ops_type::store( p_trg, side); }
+};
+
+  struct
+assign3_src_minus_trg_type
+{
+    void operator ()( float & trg, float src, float side) const
+      { trg = side + src - trg; }
+
+    void operator ()( float * p_trg, reg_type src, reg_type side) const
+      { ops_type::store( p_trg,
+            ops_type::sub( ops_type::add( side, src), ops_type::load( p_trg)));
+      }
+};
+
+  struct
+assign3_damping_type
+{
+    void operator ()( float & trg, float src, float side) const
+      { trg = side + (one_minus_damp_ * (src - trg)); }
+
+    void operator ()( float * p_trg, reg_type src, reg_type side) const
+      { ops_type::store( p_trg,
+            ops_type::add( side,
+                ops_type::mul( one_minus_damp_reg_,
+                    ops_type::sub( src, ops_type::load( p_trg)))));
+      }
+
+    assign3_damping_type( float damp)
+      : one_minus_damp_     ( 1.0f - damp)
+      , one_minus_damp_reg_ ( ops_type::set1( one_minus_damp_))
+      { }
+      float    const  one_minus_damp_     ;
+      reg_type const  one_minus_damp_reg_ ;
+};
+
+// min(..) returns its 2nd arg when either is NaN, and so does max(..). The scalar tests match
+// assign3_clamp_type<..> in finite_diff.h.
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  struct
+assign3_clamp_type
+{
+    void operator ()( float & trg, float src, float side) const
+      { assign3_( trg, src, side);
+        trg = (trg < hi_) ? trg : hi_;
+        trg = (trg > lo_) ? trg : lo_;
+      }
+
+    void operator ()( float * p_trg, reg_type src, reg_type side) const
+      { assign3_( p_trg, src, side);
+        ops_type::store( p_trg,
+            ops_type::max( ops_type::min( ops_type::load( p_trg), hi_reg_), lo_reg_));
+      }
+
+    assign3_clamp_type( ASSIGN3_FUNCTOR_TYPE const & assign3, float limit)
+      : assign3_ ( assign3)
+      , lo_      ( - limit)
+      , hi_      ( limit)
+      , lo_reg_  ( ops_type::set1( lo_))
+      , hi_reg_  ( ops_type::set1( hi_))
+      { }
+      ASSIGN3_FUNCTOR_TYPE const  assign3_ ;
+      float                const  lo_      ;
+      float                const  hi_      ;
+      reg_type             const  lo_reg_  ;
+      reg_type             const  hi_reg_  ;
+};
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// calc_forward_diff_row_
+//
+//   Does the work of these, depending on SIDE_COUNT:
+//     calc_forward_diff_2d_middle_(..)  - SIDE_COUNT == 2
+//     calc_forward_diff_2d_edge_(..)    - SIDE_COUNT == 1, p_side_b is ignored
+//     calc_forward_diff_thin_strip_(..) - SIDE_COUNT == 0, p_side_a and p_side_b are ignored
+//   The 2d kernels always use (base == 1).
+
+  template< int SIDE_COUNT >
+  float
+get_side_contrib_( float rate_side, float const * p_side_a, float const * p_side_b, size_t index)
+{
+    return (SIDE_COUNT == 2) ? ((p_side_a[ index ] + p_side_b[ index ]) * rate_side) :
+           (SIDE_COUNT == 1) ? (p_side_a[ index ] * rate_side) : 0;
+}
+
+  template< int SIDE_COUNT, typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_row_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    base
+  , float                const    rate
+  , float                const    rate_side
+  , float const *                 p_src
+  , size_t               const    count
+  , float const *                 p_side_a
+  , float const *                 p_side_b
+  , float *                       p_trg
+ )
+{
+    d_assert( count >= 2);
+
+    // Same expressions as the scalar code, so we get the same rounding.
+    float const carry_edge    = (SIDE_COUNT == 2) ? (base - (rate + rate_side + rate_side)) :
+                                (SIDE_COUNT == 1) ? (base - (rate + rate_side)) :
+                                                    (base - rate);
+    float const carry_middle  = carry_edge - rate;
+
+    // Calculate the lo end. This does not leak heat off the lo edge.
+    if ( SIDE_COUNT == 0 ) {
+        assign3_functor( p_trg[ 0 ], p_src[ 0 ],
+            (carry_edge * p_src[ 0 ]) + (rate * p_src[ 1 ]));
+    } else {
+        assign3_functor( p_trg[ 0 ], p_src[ 0 ],
+            (carry_edge * p_src[ 0 ]) + (rate * p_src[ 1 ]) +
+            get_side_contrib_< SIDE_COUNT >( rate_side, p_side_a, p_side_b, 0));
+    }
+
+    // Calculate the middle, a vector at a time.
+    size_t const  last   = count - 1;
+    size_t        index  = 1;
+    if ( last > ops_type::width ) {
+        reg_type const  rate_reg          = ops_type::set1( rate        );
+        reg_type const  rate_side_reg     = ops_type::set1( rate_side   );
+        reg_type const  carry_middle_reg  = ops_type::set1( carry_middle);
+
+        size_t const index_limit = last - ops_type::width;
+        for ( ; index <= index_limit ; index += ops_type::width ) {
+            reg_type const src_0 = ops_type::load( p_src + index - 1);
+            reg_type const src_1 = ops_type::load( p_src + index    );
+            reg_type const src_2 = ops_type::load( p_src + index + 1);
+
+            // (carry_middle * src_1) + (rate * (src_0 + src_2)) + side_contrib
+            reg_type side =
+                ops_type::add(
+                    ops_type::mul( carry_middle_reg, src_1),
+                    ops_type::mul( rate_reg, ops_type::add( src_0, src_2)));
+            if ( SIDE_COUNT == 2 ) {
+                side = ops_type::add( side,
+                    ops_type::mul(
+                        ops_type::add( ops_type::load( p_side_a + index), ops_type::load( p_side_b + index)),
+                        rate_side_reg));
+            } else
+            if ( SIDE_COUNT == 1 ) {
+                side = ops_type::add( side,
+                    ops_type::mul( ops_type::load( p_side_a + index), rate_side_reg));
+            }
+
+            assign3_functor( p_trg + index, src_1, side);
+        }
+    }
+
+    // Finish the middle cells that do not fill a vector.
+    for ( ; index < last ; ++ index ) {
+        float const middle =
+            (carry_middle * p_src[ index ]) + (rate * (p_src[ index - 1 ] + p_src[ index + 1 ]));
+        if ( SIDE_COUNT == 0 ) {
+            assign3_functor( p_trg[ index ], p_src[ index ], middle);
+        } else {
+            assign3_functor( p_trg[ index ], p_src[ index ],
+                middle + get_side_contrib_< SIDE_COUNT >( rate_side, p_side_a, p_side_b, index));
+        }
+    }
+
+    // Calculate the hi end (the last trg). This does not leak heat off the hi edge.
+    if ( SIDE_COUNT == 0 ) {
+        assign3_functor( p_trg[ last ], p_src[ last ],
+            (carry_edge * p_src[ last ]) + (rate * p_src[ last - 1 ]));
+    } else {
+        assign3_functor( p_trg[ last ], p_src[ last ],
+            (carry_edge * p_src[ last ]) + (rate * p_src[ last - 1 ]) +
+            get_side_contrib_< SIDE_COUNT >( rate_side, p_side_a, p_side_b, last));
+    }
+}
+
+// _______________________________________________________________________________________________
+// calc_forward_diff_row_maybe_clamp_
+// calc_forward_diff_row_damping_
+//
+//   Picks the assign3 functor the same way calc_next_generation_forward_difference_2d_..(..)
+//   does in finite_diff.h. A zero clamp_limit means no clamp.
+
+  template< int SIDE_COUNT, typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_row_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    clamp_limit
+  , float                const    base
+  , float                const    rate
+  , float                const    rate_side
+  , float const *                 p_src
+  , size_t               const    count
+  , float const *                 p_side_a
+  , float const *                 p_side_b
+  , float *                       p_trg
+ )
+{
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_row_< SIDE_COUNT >
+         (  assign3_functor
+          , base, rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg
+         );
+    } else {
+        calc_forward_diff_row_< SIDE_COUNT >
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE >( assign3_functor, clamp_limit)
+          , base, rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg
+         );
+    }
+}
+
+  template< int SIDE_COUNT >
+  void
+calc_forward_diff_row_damping_
+ (  float          const  damping
+  , float          const  clamp_limit
+  , float          const  base
+  , float          const  rate
+  , float          const  rate_side
+  , float const *         p_src
+  , size_t         const  count
+  , float const *         p_side_a
+  , float const *         p_side_b
+  , float *               p_trg
+ )
+{
+    if ( damping == 0 ) {
+        calc_forward_diff_row_maybe_clamp_< SIDE_COUNT >
+         (  assign3_src_minus_trg_type( ), clamp_limit
+          , base, rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg
+         );
+    } else
+    if ( damping == 1 ) {
+        calc_forward_diff_row_maybe_clamp_< SIDE_COUNT >
+         (  assign3_set_type( ), clamp_limit
+          , base, rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg
+         );
+    } else {
+        calc_forward_diff_row_maybe_clamp_< SIDE_COUNT >
+         (  assign3_damping_type( damping), clamp_limit
+          , base, rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// Kernel table entries, forward diff
+
+  void
+forward_diff_2d_middle
+ (  float damping, float rate, float rate_side
+  , float const * p_src, size_t count
+  , float const * p_side_a, float const * p_side_b
+  , float * p_trg
+  , float clamp_limit
+ )
+{
+    calc_forward_diff_row_damping_< 2 >( damping, clamp_limit, 1, rate, rate_side, p_src, count, p_side_a, p_side_b, p_trg);
+}
+
+  void
+forward_diff_2d_edge
+ (  float damping, float rate, float rate_side
+  , float const * p_src, size_t count
+  , float const * p_side
+  , float * p_trg
+  , float clamp_limit
+ )
+{
+    calc_forward_diff_row_damping_< 1 >( damping, clamp_limit, 1, rate, rate_side, p_src, count, p_side, 0, p_trg);
+}
+
+  void
+forward_diff_thin_strip
+ (  float damping, float base, float rate
+  , float const * p_src, size_t count
+  , float * p_trg
+  , float clamp_limit
+ )
+{
+    calc_forward_diff_row_damping_< 0 >( damping, clamp_limit, base, rate, 0, p_src, count, 0, 0, p_trg);
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Leapfrog wave
+//
+//   Same as calc_leapfrog_velocity(..) in finite_diff.h. Each cell is on its own, so there is
+//   no window to carry. The tail that doesn't fill a vector is done one cell at a time.
+
+  template< bool IS_CLAMPED >
+  void
+calc_leapfrog_velocity_
+ (  float          const  damping
+  , size_t         const  count
+  , float const *         p_src
+  , float *               p_velocity
+  , float *               p_trg
+  , float          const  clamp_limit
+ )
+{
+    float    const  one_minus_damp      = 1.0f - damping;
+    float    const  hi                  = clamp_limit;
+    float    const  lo                  = - clamp_limit;
+    reg_type const  one_minus_damp_reg  = ops_type::set1( one_minus_damp);
+    reg_type const  hi_reg              = ops_type::set1( hi);
+    reg_type const  lo_reg              = ops_type::set1( lo);
+
+    size_t index = 0;
+    for ( ; (index + ops_type::width) <= count ; index += ops_type::width ) {
+        reg_type const  src       = ops_type::load( p_src + index);
+        reg_type const  velocity  =
+            ops_type::add(
+                ops_type::mul( one_minus_damp_reg, ops_type::load( p_velocity + index)),
+                ops_type::sub( ops_type::load( p_trg + index), src));
+        if ( IS_CLAMPED ) {
+            reg_type const trg =
+                ops_type::max( ops_type::min( ops_type::add( src, velocity), hi_reg), lo_reg);
+            ops_type::store( p_velocity + index, ops_type::sub( trg, src));
+            ops_type::store( p_trg      + index, trg);
+        } else {
+            ops_type::store( p_velocity + index, velocity);
+            ops_type::store( p_trg      + index, ops_type::add( src, velocity));
+        }
+    }
+
+    for ( ; index < count ; ++ index ) {
+        float const  src       = p_src[ index ];
+        float const  velocity  = (one_minus_damp * p_velocity[ index ]) + (p_trg[ index ] - src);
+        if ( IS_CLAMPED ) {
+            float trg = src + velocity;
+            trg = (trg < hi) ? trg : hi;
+            trg = (trg > lo) ? trg : lo;
+            p_velocity[ index ] = trg - src;
+            p_trg[ index ]      = trg;
+        } else {
+            p_velocity[ index ] = velocity;
+            p_trg[ index ]      = src + velocity;
+        }
+    }
+}
+
+  void
+leapfrog_velocity
+ (  float damping, size_t count
+  , float const * p_src, float * p_velocity, float * p_trg
+  , float clamp_limit
+ )
+{
+    if ( clamp_limit == 0 ) {
+        calc_leapfrog_velocity_< false >( damping, count, p_src, p_velocity, p_trg, clamp_limit);
+    } else {
+        calc_leapfrog_velocity_< true  >( damping, count, p_src, p_velocity, p_trg, clamp_limit);
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Wide forward-diff stencils
+//
+//   Same as calc_forward_diff_2d_wide_(..) in finite_diff.h. The cells near the lo and hi ends
+//   mirror past the edge, so we do those with the scalar cell functions from finite_diff.h.
+//   The middle cells are a vector at a time, with the same operations in the same order.
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+assign_9_point_cell_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    rate
+  , float                const    rate_side
+  , float                const    rate_corner
+  , float const *                 p_a
+  , float const *                 p_c
+  , float const *                 p_b
+  , size_t               const    index
+  , size_t               const    lo     // index - 1, or mirrored past the lo edge
+  , size_t               const    hi     // index + 1, or mirrored past the hi edge
+  , float *                       p_trg
+ )
+{
+    assign3_functor( p_trg[ index ], p_c[ index ],
+        calc_forward_diff_9_point_cell_< float, float >
+         (  rate, rate_side, rate_corner
+          , p_a[ lo ], p_a[ index ], p_a[ hi ]
+          , p_c[ lo ], p_c[ index ], p_c[ hi ]
+          , p_b[ lo ], p_b[ index ], p_b[ hi ]
+         ));
+}
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+assign_4th_order_cell_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    rate_12
+  , float                const    rate_side_12
+  , float const * const *         p_rows
+  , size_t               const    count
+  , size_t               const    index
+  , float *                       p_trg
+ )
+{
+    // The x neighbors are mirrored past the edges.
+    std::ptrdiff_t const  signed_count  = static_cast< std::ptrdiff_t >( count);
+    std::ptrdiff_t const  signed_index  = static_cast< std::ptrdiff_t >( index);
+    float const * const   p_c           = p_rows[ 2 ];
+    assign3_functor( p_trg[ index ], p_c[ index ],
+        calc_forward_diff_4th_order_cell_< float, float >
+         (  rate_12, rate_side_12
+          , p_c[ get_mirror_index( signed_index - 2, signed_count) ]
+          , p_c[ get_mirror_index( signed_index - 1, signed_count) ]
+          , p_c[ index ]
+          , p_c[ get_mirror_index( signed_index + 1, signed_count) ]
+          , p_c[ get_mirror_index( signed_index + 2, signed_count) ]
+          , p_rows[ 0 ][ index ], p_rows[ 1 ][ index ]
+          , p_rows[ 3 ][ index ], p_rows[ 4 ][ index ]
+         ));
+}
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_9_point_row_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    rate
+  , float                const    rate_side
+  , float const * const *         p_rows
+  , size_t               const    count
+  , float *                       p_trg
+ )
+{
+    d_assert( count >= 2);
+    float const *  const  p_a          = p_rows[ 1 ];
+    float const *  const  p_c          = p_rows[ 2 ];
+    float const *  const  p_b          = p_rows[ 3 ];
+    float          const  rate_corner  = (rate + rate_side) / 12;
+    size_t         const  last         = count - 1;
+
+    // The lo end.
+    assign_9_point_cell_( assign3_functor, rate, rate_side, rate_corner, p_a, p_c, p_b, 0, 0, 1, p_trg);
+
+    // The middle, a vector at a time.
+    size_t index = 1;
+    if ( last > ops_type::width ) {
+        reg_type const  rate_reg         = ops_type::set1( rate       );
+        reg_type const  rate_side_reg    = ops_type::set1( rate_side  );
+        reg_type const  rate_corner_reg  = ops_type::set1( rate_corner);
+
+        size_t const index_limit = last - ops_type::width;
+        for ( ; index <= index_limit ; index += ops_type::width ) {
+            reg_type const  c_lo    = ops_type::load( p_c + index - 1);
+            reg_type const  c_mid   = ops_type::load( p_c + index    );
+            reg_type const  c_hi    = ops_type::load( p_c + index + 1);
+
+            // (a + b) - (c + c) at index-1, index, and index+1
+            reg_type const  dy_lo   =
+                ops_type::sub(
+                    ops_type::add( ops_type::load( p_a + index - 1), ops_type::load( p_b + index - 1)),
+                    ops_type::add( c_lo, c_lo));
+            reg_type const  dy_mid  =
+                ops_type::sub(
+                    ops_type::add( ops_type::load( p_a + index), ops_type::load( p_b + index)),
+                    ops_type::add( c_mid, c_mid));
+            reg_type const  dy_hi   =
+                ops_type::sub(
+                    ops_type::add( ops_type::load( p_a + index + 1), ops_type::load( p_b + index + 1)),
+                    ops_type::add( c_hi, c_hi));
+            reg_type const  dx      = ops_type::sub( ops_type::add( c_lo, c_hi), ops_type::add( c_mid, c_mid));
+            reg_type const  dxy     = ops_type::sub( ops_type::add( dy_lo, dy_hi), ops_type::add( dy_mid, dy_mid));
+
+            // c_mid + (((rate * dx) + (rate_side * dy_mid)) + (rate_corner * dxy))
+            reg_type const  side    =
+                ops_type::add( c_mid,
+                    ops_type::add(
+                        ops_type::add( ops_type::mul( rate_reg, dx), ops_type::mul( rate_side_reg, dy_mid)),
+                        ops_type::mul( rate_corner_reg, dxy)));
+
+            assign3_functor( p_trg + index, c_mid, side);
+        }
+    }
+
+    // The middle cells that do not fill a vector.
+    for ( ; index < last ; ++ index ) {
+        assign_9_point_cell_( assign3_functor, rate, rate_side, rate_corner, p_a, p_c, p_b, index, index - 1, index + 1, p_trg);
+    }
+
+    // The hi end.
+    assign_9_point_cell_( assign3_functor, rate, rate_side, rate_corner, p_a, p_c, p_b, last, last - 1, last, p_trg);
+}
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_4th_order_row_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    rate
+  , float                const    rate_side
+  , float const * const *         p_rows
+  , size_t               const    count
+  , float *                       p_trg
+ )
+{
+    d_assert( count >= 2);
+    float const *  const  p_y_lo_2      = p_rows[ 0 ];
+    float const *  const  p_y_lo_1      = p_rows[ 1 ];
+    float const *  const  p_c           = p_rows[ 2 ];
+    float const *  const  p_y_hi_1      = p_rows[ 3 ];
+    float const *  const  p_y_hi_2      = p_rows[ 4 ];
+    float          const  rate_12       = rate      / 12;
+    float          const  rate_side_12  = rate_side / 12;
+
+    // The lo end, where x-2 or x-1 is past the edge.
+    size_t index = 0;
+    for ( ; (index < 2) && (index < count) ; ++ index ) {
+        assign_4th_order_cell_( assign3_functor, rate_12, rate_side_12, p_rows, count, index, p_trg);
+    }
+
+    // The middle, a vector at a time. The vector at index reads from (index - 2) to
+    // (index + width + 1), which must not go past the last cell.
+    if ( count >= (ops_type::width + 4) ) {
+        reg_type const  rate_12_reg       = ops_type::set1( rate_12     );
+        reg_type const  rate_side_12_reg  = ops_type::set1( rate_side_12);
+        reg_type const  sixteen_reg       = ops_type::set1( 16.0f       );
+        reg_type const  thirty_reg        = ops_type::set1( 30.0f       );
+
+        size_t const index_limit = count - 2 - ops_type::width;
+        for ( ; index <= index_limit ; index += ops_type::width ) {
+            reg_type const  src  = ops_type::load( p_c + index);
+
+            // (((x_lo_1 + x_hi_1) * 16) - (x_lo_2 + x_hi_2)) - (src * 30)
+            reg_type const  dx   =
+                ops_type::sub(
+                    ops_type::sub(
+                        ops_type::mul( ops_type::add( ops_type::load( p_c + index - 1), ops_type::load( p_c + index + 1)), sixteen_reg),
+                        ops_type::add( ops_type::load( p_c + index - 2), ops_type::load( p_c + index + 2))),
+                    ops_type::mul( src, thirty_reg));
+            reg_type const  dy   =
+                ops_type::sub(
+                    ops_type::sub(
+                        ops_type::mul( ops_type::add( ops_type::load( p_y_lo_1 + index), ops_type::load( p_y_hi_1 + index)), sixteen_reg),
+                        ops_type::add( ops_type::load( p_y_lo_2 + index), ops_type::load( p_y_hi_2 + index))),
+                    ops_type::mul( src, thirty_reg));
+
+            // src + ((rate_12 * dx) + (rate_side_12 * dy))
+            reg_type const  side =
+                ops_type::add( src,
+                    ops_type::add( ops_type::mul( rate_12_reg, dx), ops_type::mul( rate_side_12_reg, dy)));
+
+            assign3_functor( p_trg + index, src, side);
+        }
+    }
+
+    // The rest of the middle and the hi end.
+    for ( ; index < count ; ++ index ) {
+        assign_4th_order_cell_( assign3_functor, rate_12, rate_side_12, p_rows, count, index, p_trg);
+    }
+}
+
+// _______________________________________________________________________________________________
+// calc_forward_diff_wide_row_damping_
+//
+//   Picks the assign3 functor and the clamp, like calc_forward_diff_row_damping_(..).
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_wide_row_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , bool                 const    is_4th_order
+  , float                const    rate
+  , float                const    rate_side
+  , float const * const *         p_rows
+  , size_t               const    count
+  , float *                       p_trg
+ )
+{
+    if ( is_4th_order ) {
+        calc_forward_diff_4th_order_row_( assign3_functor, rate, rate_side, p_rows, count, p_trg);
+    } else {
+        calc_forward_diff_9_point_row_( assign3_functor, rate, rate_side, p_rows, count, p_trg);
+    }
+}
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_wide_row_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    clamp_limit
+  , bool                 const    is_4th_order
+  , float                const    rate
+  , float                const    rate_side
+  , float const * const *         p_rows
+  , size_t               const    count
+  , float *                       p_trg
+ )
+{
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_wide_row_
+         (  assign3_functor
+          , is_4th_order, rate, rate_side, p_rows, count, p_trg
+         );
+    } else {
+        calc_forward_diff_wide_row_
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE >( assign3_functor, clamp_limit)
+          , is_4th_order, rate, rate_side, p_rows, count, p_trg
+         );
+    }
+}
+
+  void
+calc_forward_diff_wide_row_damping_
+ (  float                  const  damping
+  , float                  const  clamp_limit
+  , bool                   const  is_4th_order
+  , float                  const  rate
+  , float                  const  rate_side
+  , float const * const *         p_rows
+  , size_t                 const  count
+  , float *                       p_trg
+ )
+{
+    if ( damping == 0 ) {
+        calc_forward_diff_wide_row_maybe_clamp_
+         (  assign3_src_minus_trg_type( ), clamp_limit
+          , is_4th_order, rate, rate_side, p_rows, count, p_trg
+         );
+    } else
+    if ( damping == 1 ) {
+        calc_forward_diff_wide_row_maybe_clamp_
+         (  assign3_set_type( ), clamp_limit
+          , is_4th_order, rate, rate_side, p_rows, count, p_trg
+         );
+    } else {
+        calc_forward_diff_wide_row_maybe_clamp_
+         (  assign3_damping_type( damping), clamp_limit
+          , is_4th_order, rate, rate_side, p_rows, count, p_trg
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// Kernel table entries, wide forward diff
+
+  void
+forward_diff_2d_9_point
+ (  float damping, float rate, float rate_side
+  , float const * const * p_rows, size_t count
+  , float * p_trg
+  , float clamp_limit
+ )
+{
+    calc_forward_diff_wide_row_damping_( damping, clamp_limit, false, rate, rate_side, p_rows, count, p_trg);
+}
+
+  void
+forward_diff_2d_4th_order
+ (  float damping, float rate, float rate_side
+  , float const * const * p_rows, size_t count
+  , float * p_trg
+  , float clamp_limit
+ )
+{
+    calc_forward_diff_wide_row_damping_( damping, clamp_limit, true, rate, rate_side, p_rows, count, p_trg);
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Varying conductivity
+//
+//   Same as calc_forward_diff_2d_varying_(..) in finite_diff.h. The end cells use the scalar
+//   cell function, and the middle cells repeat its operations a vector at a time.
+
+  template< typename OPS >
+  typename OPS::reg_type
+get_face_conductivity_( typename OPS::reg_type coef_a, typename OPS::reg_type coef_b)
+  //
+  // Same as get_face_conductivity(..) in finite_diff.h. max(..) returns its 2nd arg unless the
+  // 1st is bigger, like the scalar test.
+{
+    return
+        OPS::div(
+            OPS::mul( OPS::mul( coef_a, coef_b), OPS::set1( 2.0f)),
+            OPS::max( OPS::add( coef_a, coef_b), OPS::set1( std::numeric_limits< float >::min( ))));
+}
+
+  struct
+varying_rows_type
+{
+    float const *  p_src     ;
+    float const *  p_side_a  ;
+    float const *  p_side_b  ;
+    float const *  p_coef    ;
+    float const *  p_coef_a  ;
+    float const *  p_coef_b  ;
+};
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+assign_varying_cell_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    rate
+  , float                const    rate_side
+  , varying_rows_type    const &  rows
+  , size_t               const    index
+  , size_t               const    lo     // index - 1, or index at the lo edge
+  , size_t               const    hi     // index + 1, or index at the hi edge
+  , float *                       p_trg
+ )
+{
+    assign3_functor( p_trg[ index ], rows.p_src[ index ],
+        calc_forward_diff_varying_cell_< float, float >
+         (  rate, rate_side
+          , rows.p_src   [ index ], rows.p_coef  [ index ]
+          , rows.p_src   [ lo    ], rows.p_coef  [ lo    ]
+          , rows.p_src   [ hi    ], rows.p_coef  [ hi    ]
+          , rows.p_side_a[ index ], rows.p_coef_a[ index ]
+          , rows.p_side_b[ index ], rows.p_coef_b[ index ]
+         ));
+}
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_varying_row_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    rate
+  , float                const    rate_side
+  , varying_rows_type    const &  rows
+  , size_t               const    count
+  , float *                       p_trg
+ )
+{
+    d_assert( count >= 2);
+    size_t const last = count - 1;
+
+    // The lo end.
+    assign_varying_cell_( assign3_functor, rate, rate_side, rows, 0, 0, 1, p_trg);
+
+    // The middle, a vector at a time.
+    size_t index = 1;
+    if ( last > ops_type::width ) {
+        reg_type const  rate_reg       = ops_type::set1( rate     );
+        reg_type const  rate_side_reg  = ops_type::set1( rate_side);
+
+        size_t const index_limit = last - ops_type::width;
+        for ( ; index <= index_limit ; index += ops_type::width ) {
+            reg_type const  src     = ops_type::load( rows.p_src  + index);
+            reg_type const  coef    = ops_type::load( rows.p_coef + index);
+
+            reg_type const  flux_x  =
+                ops_type::add(
+                    ops_type::mul(
+                        get_face_conductivity_< ops_type >( coef, ops_type::load( rows.p_coef + index - 1)),
+                        ops_type::sub( ops_type::load( rows.p_src + index - 1), src)),
+                    ops_type::mul(
+                        get_face_conductivity_< ops_type >( coef, ops_type::load( rows.p_coef + index + 1)),
+                        ops_type::sub( ops_type::load( rows.p_src + index + 1), src)));
+            reg_type const  flux_y  =
+                ops_type::add(
+                    ops_type::mul(
+                        get_face_conductivity_< ops_type >( coef, ops_type::load( rows.p_coef_a + index)),
+                        ops_type::sub( ops_type::load( rows.p_side_a + index), src)),
+                    ops_type::mul(
+                        get_face_conductivity_< ops_type >( coef, ops_type::load( rows.p_coef_b + index)),
+                        ops_type::sub( ops_type::load( rows.p_side_b + index), src)));
+
+            // src + ((rate * flux_x) + (rate_side * flux_y))
+            assign3_functor( p_trg + index, src,
+                ops_type::add( src,
+                    ops_type::add(
+                        ops_type::mul( rate_reg, flux_x),
+                        ops_type::mul( rate_side_reg, flux_y))));
+        }
+    }
+
+    // The rest of the middle, and the hi end.
+    for ( ; index < last ; ++ index ) {
+        assign_varying_cell_( assign3_functor, rate, rate_side, rows, index, index - 1, index + 1, p_trg);
+    }
+    assign_varying_cell_( assign3_functor, rate, rate_side, rows, last, last - 1, last, p_trg);
+}
+
+  template< typename ASSIGN3_FUNCTOR_TYPE >
+  void
+calc_forward_diff_varying_row_maybe_clamp_
+ (  ASSIGN3_FUNCTOR_TYPE const &  assign3_functor
+  , float                const    clamp_limit
+  , float                const    rate
+  , float                const    rate_side
+  , varying_rows_type    const &  rows
+  , size_t               const    count
+  , float *                       p_trg
+ )
+{
+    if ( clamp_limit == 0 ) {
+        calc_forward_diff_varying_row_( assign3_functor, rate, rate_side, rows, count, p_trg);
+    } else {
+        calc_forward_diff_varying_row_
+         (  assign3_clamp_type< ASSIGN3_FUNCTOR_TYPE >( assign3_functor, clamp_limit)
+          , rate, rate_side, rows, count, p_trg
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// Kernel table entry, varying forward diff
+
+  void
+forward_diff_2d_varying
+ (  float damping, float rate, float rate_side
+  , float const * p_src, size_t count
+  , float const * p_side_a, float const * p_side_b
+  , float const * p_coef, float const * p_coef_a, float const * p_coef_b
+  , float * p_trg
+  , float clamp_limit
+ )
+{
+    varying_rows_type const rows = { p_src, p_side_a, p_side_b, p_coef, p_coef_a, p_coef_b };
+    if ( damping == 0 ) {
+        calc_forward_diff_varying_row_maybe_clamp_
+         ( assign3_src_minus_trg_type( ), clamp_limit, rate, rate_side, rows, count, p_trg);
+    } else
+    if ( damping == 1 ) {
+        calc_forward_diff_varying_row_maybe_clamp_
+         ( assign3_set_type( ), clamp_limit, rate, rate_side, rows, count, p_trg);
+    } else {
+        calc_forward_diff_varying_row_maybe_clamp_
+         ( assign3_damping_type( damping), clamp_limit, rate, rate_side, rows, count, p_trg);
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Tridiagonal solve
+//
+//   Same as linear_algebra::solve_tridiagonal_destructive(..) with float pointers. The out
+//   vector can have a stride, so the column passes can write straight into the sheet.
+//   This is a serial recurrence, so there is nothing to put in vector lanes. We still compile
+//   it once per instruction set, which gets us the VEX encodings. (The column kernels further
+//   down get around this by solving many columns at once.)
+
+  template< bool IS_SUM >
+  void
+solve_tridiagonal_
+ (  size_t          const  count
+  , float           const  sub_diag_value
+  , float *                p_diag
+  , float           const  super_diag_value
+  , float *                p_in
+  , float *                p_out
+  , std::ptrdiff_t  const  out_stride
+ )
+{
+    d_assert( 0 < count);
+    size_t const count_minus = count - 1;
+
+    // Forward iteration
+    for ( size_t index = 0 ; index < count_minus ; ++ index ) {
+        d_assert( 0 != p_diag[ index ]);
+        float const scale = sub_diag_value / p_diag[ index ];
+        p_diag[ index + 1 ] -= scale * super_diag_value;
+        float const delta = scale * p_in[ index ];
+        p_in[ index + 1 ] -= delta;
+    }
+    d_assert( 0 != p_diag[ count_minus ]);
+
+    // Sweep backwards assigning out.
+    size_t index = count_minus;
+    float * p_out_cell = p_out + (static_cast< std::ptrdiff_t >( index) * out_stride);
+    float out_value = p_in[ index ] / p_diag[ index ];
+    while ( index != 0 ) {
+        if ( IS_SUM ) { *p_out_cell += out_value; } else { *p_out_cell = out_value; }
+        -- index;
+        p_out_cell -= out_stride;
+        out_value = (p_in[ index ] - (super_diag_value * out_value)) / p_diag[ index ];
+    }
+    if ( IS_SUM ) { *p_out_cell += out_value; } else { *p_out_cell = out_value; }
+}
+
+  void
+solve_tridiagonal_set
+ (  size_t count
+  , float sub_diag_value, float * p_diag, float super_diag_value
+  , float * p_in
+  , float * p_out, std::ptrdiff_t out_stride
+ )
+{
+    solve_tridiagonal_< false >( count, sub_diag_value, p_diag, super_diag_value, p_in, p_out, out_stride);
+}
+
+  void
+solve_tridiagonal_sum
+ (  size_t count
+  , float sub_diag_value, float * p_diag, float super_diag_value
+  , float * p_in
+  , float * p_out, std::ptrdiff_t out_stride
+ )
+{
+    solve_tridiagonal_< true >( count, sub_diag_value, p_diag, super_diag_value, p_in, p_out, out_stride);
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Backward and central diff
+//
+//   Same as calc_next_generation_backward_difference_1d(..) (base == 1) and
+//   calc_next_generation_central_difference_1d(..) (base == 2), for (rate >= 0).
+
+  void
+init_wave_damping_( float damping, size_t count, float const * p_src, float * p_trg)
+{
+    size_t index = 0;
+    if ( damping == 0 ) {
+        for ( ; index + ops_type::width <= count ; index += ops_type::width ) {
+            ops_type::store( p_trg + index, ops_type::neg( ops_type::load( p_trg + index)));
+        }
+        for ( ; index < count ; ++ index ) {
+            p_trg[ index ] = - p_trg[ index ];
+        }
+    } else
+    if ( damping == 1 ) {
+        for ( ; index + ops_type::width <= count ; index += ops_type::width ) {
+            ops_type::store( p_trg + index, ops_type::neg( ops_type::load( p_src + index)));
+        }
+        for ( ; index < count ; ++ index ) {
+            p_trg[ index ] = - p_src[ index ];
+        }
+    } else {
+        reg_type const damping_reg = ops_type::set1( damping);
+        for ( ; index + ops_type::width <= count ; index += ops_type::width ) {
+            reg_type const trg = ops_type::load( p_trg + index);
+            ops_type::store( p_trg + index,
+                ops_type::sub(
+                    ops_type::mul( damping_reg, ops_type::sub( trg, ops_type::load( p_src + index))),
+                    trg));
+        }
+        for ( ; index < count ; ++ index ) {
+            p_trg[ index ] = (damping * (p_trg[ index ] - p_src[ index ])) - p_trg[ index ];
+        }
+    }
+}
+
+  void
+calc_matrix_diagonal_( float base, float rate, size_t count, float * p_diag)
+{
+    d_assert( count >= 2);
+    float const carry_edge   = base + rate;
+    float const carry_middle = carry_edge + rate;
+
+    size_t const  last   = count - 1;
+    size_t        index  = 1;
+    reg_type const carry_middle_reg = ops_type::set1( carry_middle);
+    for ( ; index + ops_type::width <= last ; index += ops_type::width ) {
+        ops_type::store( p_diag + index, carry_middle_reg);
+    }
+    for ( ; index < last ; ++ index ) {
+        p_diag[ index ] = carry_middle;
+    }
+    p_diag[ 0    ] = carry_edge;
+    p_diag[ last ] = carry_edge;
+}
+
+  void
+implicit_diff_1d_
+ (  float          const  base
+  , float          const  damping
+  , float          const  rate
+  , float const *         p_src
+  , size_t         const  count
+  , float *               p_trg
+  , float *               p_srcX
+  , float *               p_diagX
+ )
+{
+    d_assert( count >= 2);
+    d_assert( rate >= 0);
+
+    // Right hand side. Backward diff uses src. Central diff uses a forward-diff solve.
+    if ( base == 1 ) {
+        std::copy( p_src, p_src + count, p_srcX);
+    } else {
+        calc_forward_diff_row_< 0 >( assign3_set_type( ), base, rate, 0, p_src, count, 0, 0, p_srcX);
+    }
+
+    calc_matrix_diagonal_( base, rate, count, p_diagX);
+
+    // Same as init_damping_and_solve_matrix_destructive(..).
+    if ( finite_difference::get_no_init_damping_set_value< float >( ) == damping ) {
+        solve_tridiagonal_set( count, - rate, p_diagX, - rate, p_srcX, p_trg, 1);
+    } else {
+        if ( finite_difference::get_no_init_damping_sum_value< float >( ) != damping ) {
+            init_wave_damping_( damping, count, p_src, p_trg);
+        }
+        solve_tridiagonal_sum( count, - rate, p_diagX, - rate, p_srcX, p_trg, 1);
+    }
+}
+
+  void
+backward_diff_1d
+ (  float damping, float rate
+  , float const * p_src, size_t count
+  , float * p_trg, float * p_srcX, float * p_diagX
+ )
+{
+    implicit_diff_1d_( 1, damping, rate, p_src, count, p_trg, p_srcX, p_diagX);
+}
+
+  void
+central_diff_1d
+ (  float damping, float rate
+  , float const * p_src, size_t count
+  , float * p_trg, float * p_srcX, float * p_diagX
+ )
+{
+    implicit_diff_1d_( 2, damping, rate, p_src, count, p_trg, p_srcX, p_diagX);
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Backward and central diff on columns, one column in each vector lane
+//
+//   Each column of the sheet is its own tridiagonal system, and the Thomas solve of one system
+//   is a chain of dependent divides. So instead of solving the columns one after another, we
+//   solve a run of adjacent columns together with one column in each lane. Adjacent columns
+//   are adjacent in memory, so the lanes for one row are a single (unaligned) load.
+//
+//   All the columns have the same matrix, so the eliminated diagonal and the scale factors are
+//   calculated once, with the same arithmetic as solve_tridiagonal_destructive(..), and shared
+//   by all the lanes. Each lane then does exactly what the scalar solver does to its in_vect and
+//   out_vect, so the results match calc_next_generation_backward/central_difference_1d(..).
+//
+//   The columns left over after the last whole vector use scalar_ops_type, which does the same
+//   thing one column at a time.
+
+  struct
+scalar_ops_type
+{
+    typedef float reg_type;
+    static size_t const width = 1;
+
+    static reg_type load( float const * p)          { return *p; }
+    static void     store( float * p, reg_type a)   { *p = a; }
+    static reg_type set1( float a)                  { return a; }
+    static reg_type add( reg_type a, reg_type b)    { return a + b; }
+    static reg_type sub( reg_type a, reg_type b)    { return a - b; }
+    static reg_type mul( reg_type a, reg_type b)    { return a * b; }
+    static reg_type div( reg_type a, reg_type b)    { return a / b; }
+    static reg_type max( reg_type a, reg_type b)    { return (a > b) ? a : b; }
+    static reg_type neg( reg_type a)                { return - a; }
+};
+
+// _______________________________________________________________________________________________
+// Lane assign functors
+//
+//   Same as the assign functors picked by init_damping_and_solve_matrix_destructive(..).
+//   The wave functor does init_wave_damping(..) and then the sum.
+
+  struct
+assign_lanes_set_type
+{
+    template< typename OPS >
+    void apply( float * p_trg, float const * /* p_src */, typename OPS::reg_type out) const
+      { OPS::store( p_trg, out); }
+};
+
+  struct
+assign_lanes_sum_type
+{
+    template< typename OPS >
+    void apply( float * p_trg, float const * /* p_src */, typename OPS::reg_type out) const
+      { OPS::store( p_trg, OPS::add( OPS::load( p_trg), out)); }
+};
+
+  struct
+assign_lanes_wave_type
+{
+    template< typename OPS >
+    void apply( float * p_trg, float const * p_src, typename OPS::reg_type out) const
+      { typename OPS::reg_type const trg = OPS::load( p_trg);
+        typename OPS::reg_type init;
+        if ( damping_ == 0 ) {
+            init = OPS::neg( trg);
+        } else
+        if ( damping_ == 1 ) {
+            init = OPS::neg( OPS::load( p_src));
+        } else {
+            init = OPS::sub( OPS::mul( OPS::set1( damping_), OPS::sub( trg, OPS::load( p_src))), trg);
+        }
+        OPS::store( p_trg, OPS::add( init, out));
+      }
+
+    assign_lanes_wave_type( float damping)
+      : damping_( damping) { }
+      float const damping_;
+};
+
+// _______________________________________________________________________________________________
+// Forward iteration, one row of lanes
+//
+//   Calculates the right-hand side for columns [column_lo, column_hi) of this row, and then
+//   eliminates the sub-diagonal with the row above.
+//     Backward diff: in = src
+//     Central diff:  in = forward-diff thin strip of src down the column (base 2)
+
+  template< typename OPS, bool IS_CENTRAL >
+  void
+solve_columns_forward_row_
+ (  size_t          const  column_lo
+  , size_t          const  column_hi
+  , size_t          const  row
+  , size_t          const  last
+  , float           const  rate
+  , float           const  carry_edge
+  , float           const  carry_middle
+  , float           const  scale         // from the row above, not used in row 0
+  , float const *          p_src_row
+  , std::ptrdiff_t  const  row_stride
+  , float *                p_in_row
+  , size_t          const  in_stride     // the column count
+ )
+{
+    typedef typename OPS::reg_type lane_type;
+    lane_type const  rate_reg          = OPS::set1( rate        );
+    lane_type const  carry_edge_reg    = OPS::set1( carry_edge  );
+    lane_type const  carry_middle_reg  = OPS::set1( carry_middle);
+    lane_type const  scale_reg         = OPS::set1( scale       );
+
+    for ( size_t column = column_lo ; column < column_hi ; column += OPS::width ) {
+        float const * const p_src = p_src_row + column;
+        lane_type in;
+        if ( ! IS_CENTRAL ) {
+            in = OPS::load( p_src);
+        } else
+        if ( row == 0 ) {
+            in = OPS::add(
+                    OPS::mul( carry_edge_reg, OPS::load( p_src)),
+                    OPS::mul( rate_reg, OPS::load( p_src + row_stride)));
+        } else
+        if ( row == last ) {
+            in = OPS::add(
+                    OPS::mul( carry_edge_reg, OPS::load( p_src)),
+                    OPS::mul( rate_reg, OPS::load( p_src - row_stride)));
+        } else {
+            in = OPS::add(
+                    OPS::mul( carry_middle_reg, OPS::load( p_src)),
+                    OPS::mul( rate_reg,
+                        OPS::add( OPS::load( p_src - row_stride), OPS::load( p_src + row_stride))));
+        }
+
+        // Use in_vect for temporary storage.
+        if ( row != 0 ) {
+            in = OPS::sub( in, OPS::mul( scale_reg, OPS::load( p_in_row + column - in_stride)));
+        }
+        OPS::store( p_in_row + column, in);
+    }
+}
+
+// _______________________________________________________________________________________________
+// Backward sweep, one row of lanes
+//
+//   Calculates out for columns [column_lo, column_hi) of this row from out in the row below.
+//   Out is kept in the in rows (which we're done with) so the row above can use it.
+
+  template< typename OPS, typename ASSIGN_FUNCTOR_TYPE >
+  void
+solve_columns_backward_row_
+ (  ASSIGN_FUNCTOR_TYPE const &  assign_functor
+  , size_t              const    column_lo
+  , size_t              const    column_hi
+  , bool                const    is_last
+  , float               const    super_diag_value
+  , float               const    diag
+  , float *                      p_in_row
+  , size_t              const    in_stride     // the column count
+  , float const *                p_src_row
+  , float *                      p_trg_row
+ )
+{
+    typedef typename OPS::reg_type lane_type;
+    lane_type const  super_reg  = OPS::set1( super_diag_value);
+    lane_type const  diag_reg   = OPS::set1( diag            );
+
+    for ( size_t column = column_lo ; column < column_hi ; column += OPS::width ) {
+        lane_type const in = OPS::load( p_in_row + column);
+        lane_type const out = is_last ?
+            OPS::div( in, diag_reg) :
+            OPS::div( OPS::sub( in, OPS::mul( super_reg, OPS::load( p_in_row + column + in_stride))), diag_reg);
+        OPS::store( p_in_row + column, out);
+        assign_functor.template apply< OPS >( p_trg_row + column, p_src_row + column, out);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  template< bool IS_CENTRAL, typename ASSIGN_FUNCTOR_TYPE >
+  void
+implicit_diff_columns_
+ (  ASSIGN_FUNCTOR_TYPE const &  assign_functor
+  , float               const    rate
+  , float const *                p_src
+  , float *                      p_trg
+  , std::ptrdiff_t      const    row_stride
+  , size_t              const    column_count
+  , size_t              const    row_count
+  , float *                      p_scratch
+ )
+{
+    d_assert( row_count >= 2);
+    d_assert( column_count >= 1);
+    d_assert( rate >= 0);
+
+    // Carve up the scratch space.
+    float * const  p_in     = p_scratch;                                 // row_count rows of column_count
+    float * const  p_diag   = p_scratch + (row_count * column_count);    // row_count
+    float * const  p_scale  = p_diag + row_count;                        // row_count - 1
+
+    float  const  base              = IS_CENTRAL ? 2.0f : 1.0f;
+    float  const  sub_diag_value    = - rate;
+    float  const  super_diag_value  = - rate;
+    size_t const  last              = row_count - 1;
+    size_t const  vector_hi         = column_count - (column_count % ops_type::width);
+
+    // The matrix, the same for every column. Same as the forward iteration over diag_vect in
+    // solve_tridiagonal_destructive(..).
+    calc_matrix_diagonal_( base, rate, row_count, p_diag);
+    for ( size_t row = 0 ; row < last ; ++ row ) {
+        d_assert( 0 != p_diag[ row ]);
+        p_scale[ row ] = sub_diag_value / p_diag[ row ];
+        p_diag[ row + 1 ] -= p_scale[ row ] * super_diag_value;
+    }
+    d_assert( 0 != p_diag[ last ]);
+
+    // Forward iteration over in_vect, top row to bottom.
+    // Same expressions as calc_forward_diff_row_< 0 >(..) for the central-diff right-hand side.
+    float const carry_edge   = base - rate;
+    float const carry_middle = carry_edge - rate;
+    for ( size_t row = 0 ; row <= last ; ++ row ) {
+        float const    scale      = (row != 0) ? p_scale[ row - 1 ] : 0;
+        float const *  p_src_row  = p_src + (static_cast< std::ptrdiff_t >( row) * row_stride);
+        float *        p_in_row   = p_in + (row * column_count);
+        solve_columns_forward_row_< ops_type, IS_CENTRAL >
+         (  0, vector_hi, row, last, rate, carry_edge, carry_middle, scale
+          , p_src_row, row_stride, p_in_row, column_count
+         );
+        solve_columns_forward_row_< scalar_ops_type, IS_CENTRAL >
+         (  vector_hi, column_count, row, last, rate, carry_edge, carry_middle, scale
+          , p_src_row, row_stride, p_in_row, column_count
+         );
+    }
+
+    // Sweep backwards, bottom row to top, assigning out to trg.
+    // All of src has been read by now, so src and trg can be the same sheet.
+    for ( size_t row = row_count ; row != 0 ; ) {
+        -- row;
+        std::ptrdiff_t const  offset     = static_cast< std::ptrdiff_t >( row) * row_stride;
+        float *               p_in_row   = p_in + (row * column_count);
+        solve_columns_backward_row_< ops_type >
+         (  assign_functor, 0, vector_hi, row == last, super_diag_value, p_diag[ row ]
+          , p_in_row, column_count, p_src + offset, p_trg + offset
+         );
+        solve_columns_backward_row_< scalar_ops_type >
+         (  assign_functor, vector_hi, column_count, row == last, super_diag_value, p_diag[ row ]
+          , p_in_row, column_count, p_src + offset, p_trg + offset
+         );
+    }
+}
+
+  template< bool IS_CENTRAL >
+  void
+implicit_diff_columns_damping_
+ (  float          const  damping
+  , float          const  rate
+  , float const *         p_src
+  , float *               p_trg
+  , std::ptrdiff_t const  row_stride
+  , size_t         const  column_count
+  , size_t         const  row_count
+  , float *               p_scratch
+ )
+{
+    // Same choice as init_damping_and_solve_matrix_destructive(..).
+    if ( finite_difference::get_no_init_damping_set_value< float >( ) == damping ) {
+        implicit_diff_columns_< IS_CENTRAL >
+         (  assign_lanes_set_type( )
+          , rate, p_src, p_trg, row_stride, column_count, row_count, p_scratch
+         );
+    } else
+    if ( finite_difference::get_no_init_damping_sum_value< float >( ) == damping ) {
+        implicit_diff_columns_< IS_CENTRAL >
+         (  assign_lanes_sum_type( )
+          , rate, p_src, p_trg, row_stride, column_count, row_count, p_scratch
+         );
+    } else {
+        implicit_diff_columns_< IS_CENTRAL >
+         (  assign_lanes_wave_type( damping)
+          , rate, p_src, p_trg, row_stride, column_count, row_count, p_scratch
+         );
+    }
+}
+
+  void
+backward_diff_columns
+ (  float damping, float rate
+  , float const * p_src, float * p_trg, std::ptrdiff_t row_stride
+  , size_t column_count, size_t row_count
+  , float * p_scratch
+ )
+{
+    implicit_diff_columns_damping_< false >( damping, rate, p_src, p_trg, row_stride, column_count, row_count, p_scratch);
+}
+
+  void
+central_diff_columns
+ (  float damping, float rate
+  , float const * p_src, float * p_trg, std::ptrdiff_t row_stride
+  , size_t column_count, size_t row_count
+  , float * p_scratch
+ )
+{
+    implicit_diff_columns_damping_< true >( damping, rate, p_src, p_trg, row_stride, column_count, row_count, p_scratch);
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Backward and central diff on columns with varying conductivity
+//
+//   Same as calc_next_generation_implicit_difference_1d_varying(..) down each column. Every
+//   column has its own matrix, so unlike the kernels above each lane builds and eliminates its
+//   own rows. The scale factors go in the first half of the scratch space and the right-hand
+//   side in the second half, both a row of lanes at a time.
+
+  template< typename OPS, bool IS_CENTRAL >
+  void
+solve_columns_varying_forward_row_
+ (  size_t          const  column_lo
+  , size_t          const  column_hi
+  , size_t          const  row
+  , size_t          const  last
+  , float           const  rate
+  , float const *          p_src_row
+  , float const *          p_coef_row
+  , std::ptrdiff_t  const  row_stride
+  , float *                p_scale_row
+  , float *                p_in_row
+  , size_t          const  in_stride     // the column count
+ )
+{
+    typedef typename OPS::reg_type lane_type;
+    lane_type const  base_reg  = OPS::set1( IS_CENTRAL ? 2.0f : 1.0f);
+    lane_type const  rate_reg  = OPS::set1( rate);
+    lane_type const  zero_reg  = OPS::set1( 0.0f);
+
+    for ( size_t column = column_lo ; column < column_hi ; column += OPS::width ) {
+        float const * const  p_src   = p_src_row  + column;
+        float const * const  p_coef  = p_coef_row + column;
+        lane_type const  src   = OPS::load( p_src );
+        lane_type const  coef  = OPS::load( p_coef);
+        lane_type const  fw    = (row == 0   ) ? zero_reg :
+                                 get_face_conductivity_< OPS >( coef, OPS::load( p_coef - row_stride));
+        lane_type const  fe    = (row == last) ? zero_reg :
+                                 get_face_conductivity_< OPS >( coef, OPS::load( p_coef + row_stride));
+
+        lane_type const  sub    = OPS::neg( OPS::mul( rate_reg, fw));
+        lane_type const  super  = OPS::neg( OPS::mul( rate_reg, fe));
+        lane_type        diag   = OPS::add( base_reg, OPS::mul( rate_reg, OPS::add( fw, fe)));
+        lane_type        in     = src;
+        if ( IS_CENTRAL ) {
+            lane_type const  lo  = (row == 0   ) ? src : OPS::load( p_src - row_stride);
+            lane_type const  hi  = (row == last) ? src : OPS::load( p_src + row_stride);
+            in = OPS::add(
+                    OPS::mul( base_reg, src),
+                    OPS::mul( rate_reg,
+                        OPS::add(
+                            OPS::mul( fw, OPS::sub( lo, src)),
+                            OPS::mul( fe, OPS::sub( hi, src)))));
+        }
+        if ( row != 0 ) {
+            diag = OPS::sub( diag, OPS::mul( sub, OPS::load( p_scale_row + column - in_stride)));
+            in   = OPS::sub( in  , OPS::mul( sub, OPS::load( p_in_row    + column - in_stride)));
+        }
+        OPS::store( p_scale_row + column, OPS::div( super, diag));
+        OPS::store( p_in_row    + column, OPS::div( in   , diag));
+    }
+}
+
+  template< typename OPS, typename ASSIGN_FUNCTOR_TYPE >
+  void
+solve_columns_varying_backward_row_
+ (  ASSIGN_FUNCTOR_TYPE const &  assign_functor
+  , size_t              const    column_lo
+  , size_t              const    column_hi
+  , bool                const    is_last
+  , float const *                p_scale_row
+  , float *                      p_in_row
+  , size_t              const    in_stride     // the column count
+  , float const *                p_src_row
+  , float *                      p_trg_row
+ )
+{
+    typedef typename OPS::reg_type lane_type;
+
+    for ( size_t column = column_lo ; column < column_hi ; column += OPS::width ) {
+        lane_type const in = OPS::load( p_in_row + column);
+        lane_type const out = is_last ? in :
+            OPS::sub( in, OPS::mul( OPS::load( p_scale_row + column), OPS::load( p_in_row + column + in_stride)));
+        OPS::store( p_in_row + column, out);
+        assign_functor.template apply< OPS >( p_trg_row + column, p_src_row + column, out);
+    }
+}
+
+  template< bool IS_CENTRAL, typename ASSIGN_FUNCTOR_TYPE >
+  void
+implicit_diff_columns_varying_
+ (  ASSIGN_FUNCTOR_TYPE const &  assign_functor
+  , float               const    rate
+  , float const *                p_src
+  , float const *                p_coef
+  , float *                      p_trg
+  , std::ptrdiff_t      const    row_stride
+  , size_t              const    column_count
+  , size_t              const    row_count
+  , float *                      p_scratch
+ )
+{
+    d_assert( row_count >= 2);
+    d_assert( column_count >= 1);
+    d_assert( rate >= 0);
+
+    float * const  p_scale  = p_scratch;                                // row_count rows of column_count
+    float * const  p_in     = p_scratch + (row_count * column_count);   // row_count rows of column_count
+
+    size_t const  last       = row_count - 1;
+    size_t const  vector_hi  = column_count - (column_count % ops_type::width);
+
+    // Forward iteration, top row to bottom.
+    for ( size_t row = 0 ; row <= last ; ++ row ) {
+        std::ptrdiff_t const  offset       = static_cast< std::ptrdiff_t >( row) * row_stride;
+        float *               p_scale_row  = p_scale + (row * column_count);
+        float *               p_in_row     = p_in    + (row * column_count);
+        solve_columns_varying_forward_row_< ops_type, IS_CENTRAL >
+         (  0, vector_hi, row, last, rate
+          , p_src + offset, p_coef + offset, row_stride, p_scale_row, p_in_row, column_count
+         );
+        solve_columns_varying_forward_row_< scalar_ops_type, IS_CENTRAL >
+         (  vector_hi, column_count, row, last, rate
+          , p_src + offset, p_coef + offset, row_stride, p_scale_row, p_in_row, column_count
+         );
+    }
+
+    // Sweep backwards, bottom row to top, assigning out to trg.
+    // All of src has been read by now, so src and trg can be the same sheet.
+    for ( size_t row = row_count ; row != 0 ; ) {
+        -- row;
+        std::ptrdiff_t const  offset       = static_cast< std::ptrdiff_t >( row) * row_stride;
+        float *               p_scale_row  = p_scale + (row * column_count);
+        float *               p_in_row     = p_in    + (row * column_count);
+        solve_columns_varying_backward_row_< ops_type >
+         (  assign_functor, 0, vector_hi, row == last
+          , p_scale_row, p_in_row, column_count, p_src + offset, p_trg + offset
+         );
+        solve_columns_varying_backward_row_< scalar_ops_type >
+         (  assign_functor, vector_hi, column_count, row == last
+          , p_scale_row, p_in_row, column_count, p_src + offset, p_trg + offset
+         );
+    }
+}
+
+  template< bool IS_CENTRAL >
+  void
+implicit_diff_columns_varying_damping_
+ (  float          const  damping
+  , float          const  rate
+  , float const *         p_src
+  , float const *         p_coef
+  , float *               p_trg
+  , std::ptrdiff_t const  row_stride
+  , size_t         const  column_count
+  , size_t         const  row_count
+  , float *               p_scratch
+ )
+{
+    if ( finite_difference::get_no_init_damping_set_value< float >( ) == damping ) {
+        implicit_diff_columns_varying_< IS_CENTRAL >
+         (  assign_lanes_set_type( )
+          , rate, p_src, p_coef, p_trg, row_stride, column_count, row_count, p_scratch
+         );
+    } else
+    if ( finite_difference::get_no_init_damping_sum_value< float >( ) == damping ) {
+        implicit_diff_columns_varying_< IS_CENTRAL >
+         (  assign_lanes_sum_type( )
+          , rate, p_src, p_coef, p_trg, row_stride, column_count, row_count, p_scratch
+         );
+    } else {
+        implicit_diff_columns_varying_< IS_CENTRAL >
+         (  assign_lanes_wave_type( damping)
+          , rate, p_src, p_coef, p_trg, row_stride, column_count, row_count, p_scratch
+         );
+    }
+}
+
+  void
+backward_diff_columns_varying
+ (  float damping, float rate
+  , float const * p_src, float const * p_coef, float * p_trg, std::ptrdiff_t row_stride
+  , size_t column_count, size_t row_count
+  , float * p_scratch
+ )
+{
+    implicit_diff_columns_varying_damping_< false >
+     ( damping, rate, p_src, p_coef, p_trg, row_stride, column_count, row_count, p_scratch);
+}
+
+  void
+central_diff_columns_varying
+ (  float damping, float rate
+  , float const * p_src, float const * p_coef, float * p_trg, std::ptrdiff_t row_stride
+  , size_t column_count, size_t row_count
+  , float * p_scratch
+ )
+{
+    implicit_diff_columns_varying_damping_< true >
+     ( damping, rate, p_src, p_coef, p_trg, row_stride, column_count, row_count, p_scratch);
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// forward_diff_2d_fixed16(..)
+//
+//   Vector calc_next_generation_forward_difference_2d_fixed(..) for 16-bit fixed point.
+//   madd(..) gives us the exact 32-bit sums the scalar code calculates, and the pack and the
+//   16-bit add saturate the same way uniform_scalar::saturate(..) does. The edge cells and the
+//   tail use the scalar cell function.
+
+  void
+forward_diff_2d_fixed16
+ (  boost::int16_t rate, boost::int16_t rate_side
+  , boost::int16_t const * p_src, size_t count
+  , boost::int16_t const * p_side_a, boost::int16_t const * p_side_b
+  , boost::int16_t * p_trg
+ )
+{
+    typedef i16_ops_type           iops      ;
+    typedef iops::reg_type         ireg_type ;
+    typedef boost::int32_t         wide_type ;
+    typedef uniform_scalar_16_type scalar_type ;
+
+    d_assert( count >= 2);
+    d_static_assert( scalar_type::fraction_bit_count == 15);
+
+    wide_type const carry = 2 * (wide_type( rate) + rate_side);
+    d_assert( carry < scalar_type::get_int_wide_one( ));
+
+    ireg_type const rate_reg       = iops::set1_16( rate);
+    ireg_type const rate_side_reg  = iops::set1_16( rate_side);
+    ireg_type const neg_carry_reg  = iops::set1_16( static_cast< boost::int16_t >( - carry));
+    ireg_type const half_reg       = iops::set1_32( scalar_type::get_int_wide_one( ) >> 1);
+    ireg_type const zero_reg       = iops::zero( );
+
+    // The lo edge.
+    p_trg[ 0 ] =
+      calc_forward_diff_2d_fixed_cell_< boost::int16_t >
+       ( rate, rate_side, carry, p_src[ 0 ], p_src[ 0 ], p_src[ 1 ], p_side_a[ 0 ], p_side_b[ 0 ]);
+
+    // The middle, while there is a full register of cells that all have a hi neighbor.
+    size_t index = 1;
+    for ( ; (index + iops::width) < count ; index += iops::width ) {
+        ireg_type const lo     = iops::load( p_src + index - 1);
+        ireg_type const mid    = iops::load( p_src + index);
+        ireg_type const hi     = iops::load( p_src + index + 1);
+        ireg_type const side_a = iops::load( p_side_a + index);
+        ireg_type const side_b = iops::load( p_side_b + index);
+
+        ireg_type const sum_lo =
+          iops::add_32(
+            iops::add_32(
+              iops::madd( iops::unpack_lo( lo, hi), rate_reg),
+              iops::madd( iops::unpack_lo( side_a, side_b), rate_side_reg)),
+            iops::add_32(
+              iops::madd( iops::unpack_lo( mid, zero_reg), neg_carry_reg),
+              half_reg));
+        ireg_type const sum_hi =
+          iops::add_32(
+            iops::add_32(
+              iops::madd( iops::unpack_hi( lo, hi), rate_reg),
+              iops::madd( iops::unpack_hi( side_a, side_b), rate_side_reg)),
+            iops::add_32(
+              iops::madd( iops::unpack_hi( mid, zero_reg), neg_carry_reg),
+              half_reg));
+
+        ireg_type const change =
+          iops::pack_saturate( iops::shift_right_15( sum_lo), iops::shift_right_15( sum_hi));
+        iops::store( p_trg + index, iops::add_saturate_16( mid, change));
+    }
+
+    // The tail and the hi edge.
+    for ( ; index < count ; index += 1 ) {
+        boost::int16_t const hi = ((index + 1) == count) ? p_src[ index ] : p_src[ index + 1 ];
+        p_trg[ index ] =
+          calc_forward_diff_2d_fixed_cell_< boost::int16_t >
+           ( rate, rate_side, carry, p_src[ index - 1 ], p_src[ index ], hi, p_side_a[ index ], p_side_b[ index ]);
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+
+  void
+fill_kernels
+ (  finite_difference::simd::kernels_type &  fd_kernels
+  , linear_algebra::simd::kernels_type    &  la_kernels
+ )
+{
+    fd_kernels.forward_diff_2d_middle  = & forward_diff_2d_middle  ;
+    fd_kernels.forward_diff_2d_edge    = & forward_diff_2d_edge    ;
+    fd_kernels.forward_diff_thin_strip = & forward_diff_thin_strip ;
+    fd_kernels.forward_diff_2d_9_point = & forward_diff_2d_9_point ;
+    fd_kernels.forward_diff_2d_4th_order
+                                       = & forward_diff_2d_4th_order;
+    fd_kernels.backward_diff_1d        = & backward_diff_1d        ;
+    fd_kernels.central_diff_1d         = & central_diff_1d         ;
+    fd_kernels.backward_diff_columns   = & backward_diff_columns   ;
+    fd_kernels.central_diff_columns    = & central_diff_columns    ;
+    fd_kernels.forward_diff_2d_varying = & forward_diff_2d_varying ;
+    fd_kernels.leapfrog_velocity       = & leapfrog_velocity       ;
+    fd_kernels.backward_diff_columns_varying
+                                       = & backward_diff_columns_varying;
+    fd_kernels.central_diff_columns_varying
+                                       = & central_diff_columns_varying;
+    fd_kernels.forward_diff_2d_fixed16 = & forward_diff_2d_fixed16 ;
+
+    la_kernels.solve_tridiagonal_set   = & solve_tridiagonal_set   ;
+    la_kernels.solve_tridiagonal_sum   = & solve_tridiagonal_sum   ;
+}
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+//
+// finite_diff_simd_kernels.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
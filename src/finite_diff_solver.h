@@ -28,6 +28,7 @@
 # include "pair_iter.h"
 # include "stride_iter.h"
 # include "finite_diff.h"
+# include "sheet_stats.h"
 
 // The following is a precaution. If we #include <WinDef.h> somewhere before here, then the macros
 // min and max will also be defined (unless we #define NOMINMAX ahead of time). This breaks
@@ -45,7 +46,9 @@
 
 # include <iterator>
 # include <algorithm>
-# include <QtCore/QtConcurrentMap>
+# include <vector>
+# include "row_pool.h"
+# include "half_float.h"
 
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
@@ -441,6 +444,238 @@ solving_functor_fixed_two_buffer_type
       }
 };
 
+// _______________________________________________________________________________________________
+// Quiet tiles for the 2d forward-diff solves
+//
+//   After a raindrop or a bell curve most of the sheet sits still for many generations, but we
+//   solve every cell anyway. So we cut the sheet into tiles and keep track of which ones are still
+//   changing. A tile that changed less than the tolerance in the last pass is quiet, and the next
+//   pass skips it unless one of its 8 neighbours is still active. Disturbances move at most one
+//   cell per pass, so a neighbour always wakes a quiet tile before anything reaches it.
+//
+//   A skipped tile is copied from src to trg. But we remember which generation each sheet holds,
+//   and if trg holds a generation from after the tile went quiet then trg already has the values
+//   and we don't copy them. That is the usual case, when the passes go around two or three sheets.
+//   Each pass's src must be the last pass's trg. Call forget_sheets( ) if a sheet is written
+//   between the passes, and wake_all(..) if src is not what the last pass left.
+//
+//   The solving functor (solving_functor_forward_diff_2d_type below) does the work. It reads which
+//   tiles to solve, and records which tiles changed, a row at a time so parallel rows do not share
+//   anything. finish_pass( ) folds the rows together and picks the tiles for the next pass.
+//
+//   The functor also keeps the stats of each row of each tile, when it is asked for the stats. A
+//   skipped tile has the same values it had at the end of the last pass, so if we have its stats
+//   they are still good, and we don't have to read the tile to gather the stats for the sheet.
+//
+//   start_pass(..) and finish_pass( ) are not thread safe. Call them before and after mapping.
+
+  class
+tile_activity_type
+{
+  public:
+    enum { e_tile_x_count = 32, e_tile_y_count = 8 };
+
+    tile_activity_type( )
+      : x_count_( 0), y_count_( 0), tile_x_count_( 0), tile_y_count_( 0)
+      , tolerance_( 0), generation_( 0), p_trg_( 0), is_trg_generation_known_( false), trg_generation_( 0)
+      { forget_sheets( ); }
+
+  // Sizing
+  public:
+    bool
+    is_sized( std::size_t x_count, std::size_t y_count) const
+      { return (x_count == x_count_) && (y_count == y_count_); }
+
+    // Sizes the tiles if necessary, and marks them all to be solved in the next pass.
+    void
+    wake_all( std::size_t x_count, std::size_t y_count)
+      { if ( ! is_sized( x_count, y_count) ) {
+            x_count_      = x_count;
+            y_count_      = y_count;
+            tile_x_count_ = (x_count + (e_tile_x_count - 1)) / e_tile_x_count;
+            tile_y_count_ = (y_count + (e_tile_y_count - 1)) / e_tile_y_count;
+            is_solved_    .assign( tile_x_count_ * tile_y_count_, true);
+            quiet_since_  .assign( tile_x_count_ * tile_y_count_, 0);
+            row_changed_  .assign( tile_x_count_ * y_count_, 0);
+            row_stats_    .assign( tile_x_count_ * y_count_, sheet_stats_type( ));
+        } else {
+            std::fill( is_solved_.begin( ), is_solved_.end( ), true);
+        }
+        forget_sheets( );
+      }
+
+    // Forgets everything, and frees the memory.
+    void
+    clear( )
+      { x_count_ = y_count_ = tile_x_count_ = tile_y_count_ = 0;
+        std::vector< bool >( ).swap( is_solved_);
+        std::vector< std::size_t >( ).swap( quiet_since_);
+        std::vector< unsigned char >( ).swap( row_changed_);
+        std::vector< sheet_stats_type >( ).swap( row_stats_);
+        forget_sheets( );
+      }
+
+    // Forgets which generation each sheet holds. The next pass copies every skipped tile.
+    void
+    forget_sheets( )
+      { for ( std::size_t slot = 0 ; slot < e_sheet_slot_count ; ++ slot ) {
+            p_sheets_[ slot ] = 0;
+            sheet_generations_[ slot ] = 0;
+        }
+      }
+
+  // Before and after each pass
+  public:
+    void
+    start_pass( void const * p_src, void const * p_trg, float tolerance)
+      { d_assert( p_src && p_trg && (p_src != p_trg));
+        tolerance_  = tolerance;
+        generation_ += 1;
+        p_trg_      = p_trg;
+
+        // src holds what the last pass left.
+        set_sheet_generation_( p_src, generation_ - 1);
+        std::size_t const slot = find_sheet_( p_trg);
+        is_trg_generation_known_ = (slot < e_sheet_slot_count);
+        trg_generation_          = is_trg_generation_known_ ? sheet_generations_[ slot ] : 0;
+      }
+
+    // Returns how many tiles will be solved in the next pass.
+    std::size_t
+    finish_pass( )
+      { set_sheet_generation_( p_trg_, generation_);
+
+        std::vector< bool > is_active( is_solved_.size( ), false);
+        for ( std::size_t tile_y = 0 ; tile_y < tile_y_count_ ; ++ tile_y ) {
+            std::size_t const  y_lo    = tile_y * e_tile_y_count;
+            std::size_t const  y_post  = std::min< std::size_t >( y_lo + e_tile_y_count, y_count_);
+            for ( std::size_t tile_x = 0 ; tile_x < tile_x_count_ ; ++ tile_x ) {
+                std::size_t const tile = get_tile_index_( tile_x, tile_y);
+                if ( is_solved_[ tile ] ) {
+                    quiet_since_[ tile ] = generation_;
+                    for ( std::size_t y = y_lo ; (y < y_post) && (! is_active[ tile ]) ; ++ y ) {
+                        is_active[ tile ] = (0 != row_changed_[ (y * tile_x_count_) + tile_x ]);
+                    }
+                }
+            }
+        }
+
+        // Solve the active tiles and their neighbours.
+        std::size_t solved_count = 0;
+        for ( std::size_t tile_y = 0 ; tile_y < tile_y_count_ ; ++ tile_y ) {
+            for ( std::size_t tile_x = 0 ; tile_x < tile_x_count_ ; ++ tile_x ) {
+                bool is_solved = false;
+                for ( std::size_t ny = (tile_y ? tile_y - 1 : 0)
+                      ; (! is_solved) && (ny <= tile_y + 1) && (ny < tile_y_count_) ; ++ ny ) {
+                    for ( std::size_t nx = (tile_x ? tile_x - 1 : 0)
+                          ; (! is_solved) && (nx <= tile_x + 1) && (nx < tile_x_count_) ; ++ nx ) {
+                        is_solved = is_active[ get_tile_index_( nx, ny) ];
+                    }
+                }
+                is_solved_[ get_tile_index_( tile_x, tile_y) ] = is_solved;
+                if ( is_solved ) { ++ solved_count; }
+            }
+        }
+        return solved_count;
+      }
+
+  // Used by the solving functor while mapping the rows
+  public:
+    std::size_t
+    get_tile_x_count( )                        const { return tile_x_count_; }
+    float
+    get_tolerance( )                           const { return tolerance_; }
+
+    bool
+    is_solved( std::size_t tile_x, std::size_t y) const
+      { return is_solved_[ get_tile_index_( tile_x, y / e_tile_y_count) ]; }
+
+    // Skipped tiles are copied from src to trg, unless trg already has the values.
+    bool
+    is_copy_needed( std::size_t tile_x, std::size_t y) const
+      { std::size_t const tile = get_tile_index_( tile_x, y / e_tile_y_count);
+        return (! is_solved_[ tile ]) && ! (is_trg_generation_known_ && (trg_generation_ >= quiet_since_[ tile ]));
+      }
+
+    // Did the part of the tile in row y change by at least the tolerance?
+    void
+    set_row_changed( std::size_t tile_x, std::size_t y, bool is_changed)
+      { d_assert( (tile_x < tile_x_count_) && (y < y_count_));
+        row_changed_[ (y * tile_x_count_) + tile_x ] = is_changed ? 1 : 0;
+      }
+
+    // The stats for the part of the tile in row y, or empty if we don't have them.
+    sheet_stats_type &
+    ref_row_stats( std::size_t tile_x, std::size_t y)
+      { d_assert( (tile_x < tile_x_count_) && (y < y_count_));
+        return row_stats_[ (y * tile_x_count_) + tile_x ];
+      }
+
+    void
+    add_row_stats( std::size_t y, sheet_stats_type & stats) const
+      { for ( std::size_t tile_x = 0 ; tile_x < tile_x_count_ ; ++ tile_x ) {
+            stats.add( row_stats_[ (y * tile_x_count_) + tile_x ]);
+        }
+      }
+
+  private:
+    std::size_t
+    get_tile_index_( std::size_t tile_x, std::size_t tile_y) const
+      { d_assert( (tile_x < tile_x_count_) && (tile_y < tile_y_count_));
+        return (tile_y * tile_x_count_) + tile_x;
+      }
+
+    // The sheets are src, trg and extra, and maybe the ones the solver keeps, so a few slots are
+    // enough. A new sheet takes the slot with the oldest generation.
+    std::size_t
+    find_sheet_( void const * p_sheet) const
+      { for ( std::size_t slot = 0 ; slot < e_sheet_slot_count ; ++ slot ) {
+            if ( p_sheets_[ slot ] == p_sheet ) return slot;
+        }
+        return e_sheet_slot_count;
+      }
+
+    void
+    set_sheet_generation_( void const * p_sheet, std::size_t generation)
+      { std::size_t slot = find_sheet_( p_sheet);
+        if ( slot == e_sheet_slot_count ) {
+            // An empty slot, or else the sheet with the oldest generation.
+            slot = find_sheet_( 0);
+            if ( slot == e_sheet_slot_count ) {
+                slot = 0;
+                for ( std::size_t index = 1 ; index < e_sheet_slot_count ; ++ index ) {
+                    if ( sheet_generations_[ index ] < sheet_generations_[ slot ] ) slot = index;
+                }
+            }
+            p_sheets_[ slot ] = p_sheet;
+        }
+        sheet_generations_[ slot ] = generation;
+      }
+
+  private:
+    enum { e_sheet_slot_count = 4 };
+
+    std::size_t          x_count_                 ;
+    std::size_t          y_count_                 ;
+    std::size_t          tile_x_count_            ;
+    std::size_t          tile_y_count_            ;
+    std::vector< bool >  is_solved_               ; // solve this tile in the next pass
+    std::vector< std::size_t >
+                         quiet_since_             ; // the last generation the tile was solved
+    std::vector< unsigned char >
+                         row_changed_             ; // one per tile per row (not bool, written in parallel)
+    std::vector< sheet_stats_type >
+                         row_stats_               ; // one per tile per row
+
+    float                tolerance_               ;
+    std::size_t          generation_              ; // counts the passes
+    void const *         p_trg_                   ;
+    bool                 is_trg_generation_known_ ;
+    std::size_t          trg_generation_          ;
+    void const *         p_sheets_[ e_sheet_slot_count ]          ;
+    std::size_t          sheet_generations_[ e_sheet_slot_count ] ;
+};
+
 // _______________________________________________________________________________________________
 // Special solving functor, like above except only usable for 2d forward diff
 //
@@ -448,11 +683,31 @@ solving_functor_fixed_two_buffer_type
 //   used with a src sheet that has changed.
 //
 //   You can use this serial or parallel since forward-diff does not use any temp buffers.
+//
+//   stencil picks the 5-point kernels or one of the wide ones (see stencil_type in finite_diff.h).
+//   The wide stencils reach 1 or 2 rows up and down, mirrored or wrapped past the top and bottom.
+//
+//   boundary says what happens at the edges (see boundary_type in finite_diff.h). The kernels
+//   solve each row with insulated ends, and we fix the ends up for the other boundaries before
+//   moving on to the next row, so the edges never need a pass of their own.
+//
+//   If there is a coefficient sheet (p_coef_range is not zero) each cell has its own
+//   conductivity, and we use the varying kernel (see "Varying conductivity" in finite_diff.h).
+//   That only comes with the 5-point stencil.
+//
+//   If there are tiles (p_tiles is not zero) we only solve the tiles they ask for, and record
+//   how much each tile changed (see tile_activity_type above). That only comes with the 5-point
+//   stencil and insulated edges.
+//
+//   If there is a velocity sheet (p_velocity_range is not zero) we solve the leapfrog wave (see
+//   "Leapfrog wave" in finite_diff.h), which moves the velocity along with the values. Otherwise
+//   trg holds the older generation for the wave. The leapfrog wave does not skip tiles.
 
   template
    <  typename RATE_TYPE
     , typename SRC_ITER_TYPE
     , typename TRG_ITER_TYPE
+    , typename COEF_ITER_TYPE = SRC_ITER_TYPE
    >
   struct
 solving_functor_forward_diff_2d_type
@@ -472,24 +727,72 @@ solving_functor_forward_diff_2d_type
   public:
     INHERIT_FUNCTOR_TYPENAMES( super_type);
 
+  // Coefficient sheet typedefs
+  public:
+    typedef stride_range< COEF_ITER_TYPE, 1 >  coef_range_1_type  ;
+    typedef stride_iter<  COEF_ITER_TYPE, 1 >  coef_iter_1_type   ;
+    typedef stride_iter<  COEF_ITER_TYPE, 0 >  coef_iter_0_type   ;
+
   // Constructor
   public:
     solving_functor_forward_diff_2d_type
      (  bool                const &  is_early
+      , finite_difference::stencil_type
+                            const    stencil
+      , finite_difference::boundary_type
+                            const    boundary
       , rate_type           const &  damping
       , rate_type           const &  rate
       , rate_type           const &  rate_side
       , src_iter_1_type     const &  src_iter_1_lo // needed so we know if we're at the lo edge
       , src_iter_1_type     const &  src_iter_1_hi // needed so we know if we're at the hi edge
+      , coef_range_1_type const * const
+                                     p_coef_range  // zero means the same conductivity everywhere
+      , tile_activity_type * const   p_tiles       // zero means solve every cell
+      , trg_range_1_type const * const
+                                     p_velocity_range // zero means trg holds the older generation
+      , rate_type           const &  clamp_limit   // zero means no clamp
+      , sheet_stats_type *  const    p_row_stats   // zero means no stats, else one per range_1 item
      )
       : super_type( is_early, damping, rate)
-      , rate_side_     ( rate_side     )
-      , src_iter_1_lo_ ( src_iter_1_lo )
-      , src_iter_1_hi_ ( src_iter_1_hi )
-      { }
-      rate_type       const  rate_side_     ;
-      src_iter_1_type const  src_iter_1_lo_ ;
-      src_iter_1_type const  src_iter_1_hi_ ;
+      , stencil_        ( stencil       )
+      , boundary_       ( boundary      )
+      , rate_side_      ( rate_side     )
+      , src_iter_1_lo_  ( src_iter_1_lo )
+      , src_iter_1_hi_  ( src_iter_1_hi )
+      , is_varying_     ( 0 != p_coef_range)
+      , coef_iter_1_lo_ ( p_coef_range ? p_coef_range->get_iter_lo( ) : coef_iter_1_type( ))
+      , p_tiles_        ( p_tiles       )
+      , is_leapfrog_    ( 0 != p_velocity_range)
+      , velocity_iter_1_lo_
+                        ( p_velocity_range ? p_velocity_range->get_iter_lo( ) : trg_iter_1_type( ))
+      , clamp_limit_    ( clamp_limit   )
+      , p_row_stats_    ( p_row_stats   )
+      { d_assert( implies( is_varying_, (stencil_ == finite_difference::e_stencil_5_point)));
+        d_assert( (! is_varying_) ||
+            (p_coef_range->get_count( ) == static_cast< size_type >( (src_iter_1_hi_ - src_iter_1_lo_) + 1)));
+        d_assert( implies( (0 != p_tiles_),
+            (stencil_ == finite_difference::e_stencil_5_point) &&
+            (boundary_ == finite_difference::e_boundary_insulated) ));
+        d_assert( implies( is_leapfrog_, (0 == p_tiles_)));
+        d_assert( (! is_leapfrog_) ||
+            (p_velocity_range->get_count( ) == static_cast< size_type >( (src_iter_1_hi_ - src_iter_1_lo_) + 1)));
+      }
+      finite_difference::stencil_type
+                         const  stencil_        ;
+      finite_difference::boundary_type
+                         const  boundary_       ;
+      rate_type          const  rate_side_      ;
+      src_iter_1_type    const  src_iter_1_lo_  ;
+      src_iter_1_type    const  src_iter_1_hi_  ;
+      bool               const  is_varying_     ;
+      coef_iter_1_type   const  coef_iter_1_lo_ ;
+      tile_activity_type * const
+                                p_tiles_        ;
+      bool               const  is_leapfrog_    ;
+      trg_iter_1_type    const  velocity_iter_1_lo_ ;
+      rate_type          const  clamp_limit_    ;
+      sheet_stats_type * const  p_row_stats_    ;
 
   // Functor, pair param, pair of src/trg iters
   // This is the operator() called by the mapping functor, serial and parallel.
@@ -501,57 +804,612 @@ solving_functor_forward_diff_2d_type
         src_range_0_type const &  src_range_0  = src_iter_1.get_range( );
         trg_iter_1_type  const &  trg_iter_1   = src_trg.get<1>( );
         trg_range_0_type const &  trg_range_0  = trg_iter_1.get_range( );
-        bool             const    is_lo_edge   = (src_iter_1 == src_iter_1_lo_);
-        bool             const    is_hi_edge   = (src_iter_1 == src_iter_1_hi_);
 
         d_assert( src_range_0.get_count( ) == trg_range_0.get_count( ));
         if ( super_type::is_early_exit( ) ) {
             /* do nothing */
         } else
-        if ( (! is_lo_edge) && (! is_hi_edge) ) {
+        if ( is_fixed_row_( src_iter_1) ) {
+            std::copy( src_range_0.get_iter_lo( ), src_range_0.get_iter_post( ), trg_range_0.get_iter_lo( ));
+            if ( is_leapfrog_ ) {
+                trg_iter_0_type const velocity_iter = get_velocity_row_iter_lo_( src_iter_1);
+                std::fill( velocity_iter, velocity_iter + src_range_0.get_count( ), val_type( 0));
+            }
+        } else
+        if ( is_leapfrog_ ) {
+            calc_leapfrog_row_( src_iter_1, trg_range_0.get_iter_lo( ));
+        } else
+        if ( boundary_ == finite_difference::e_boundary_absorbing ) {
+            calc_absorbing_row_( src_iter_1, trg_range_0.get_iter_lo( ));
+        } else
+        if ( p_tiles_ ) {
+            calc_row_tiles_( src_iter_1, trg_range_0.get_iter_lo( ));
+        } else {
+            calc_row_( super_type::get_damping( ), src_iter_1, 0, src_range_0.get_count( ), trg_range_0.get_iter_lo( ));
+            if ( boundary_ == finite_difference::e_boundary_periodic ) {
+                wrap_row_ends_( src_iter_1, trg_range_0.get_iter_lo( ));
+            } else
+            if ( boundary_ == finite_difference::e_boundary_fixed ) {
+                fix_row_ends_( src_range_0, trg_range_0.get_iter_lo( ));
+            }
+        }
+
+        // Gather the stats for the row we just wrote, while it is still in the cache.
+        // Each row has its own stats so parallel rows do not share anything.
+        if ( p_row_stats_ && (! super_type::is_early_exit( )) ) {
+            sheet_stats_type & row_stats = p_row_stats_[ src_iter_1 - src_iter_1_lo_ ];
+            row_stats.clear( );
+            if ( p_tiles_ ) {
+                p_tiles_->add_row_stats( src_iter_1 - src_iter_1_lo_, row_stats);
+            } else {
+                row_stats.add_values( trg_range_0.get_iter_lo( ), trg_range_0.get_iter_post( ));
+            }
+        }
+      }
+
+  // Solves cells [x_lo, x_post) of one row with the kernels, with insulated ends at x_lo and
+  // x_post. trg_iter is the start of the row.
+  // The rows above and below are mirrored (or wrapped if periodic) past the top and bottom.
+  protected:
+      void
+    calc_row_
+     (  rate_type        const    damping
+      , src_iter_1_type  const &  src_iter_1
+      , std::ptrdiff_t   const    x_lo
+      , std::ptrdiff_t   const    x_post
+      , trg_iter_0_type  const &  row_trg_iter
+     ) const
+      {
+        d_assert( (0 <= x_lo) && (x_lo < x_post) &&
+            (x_post <= static_cast< std::ptrdiff_t >( src_iter_1.get_range( ).get_count( ))));
+        src_iter_0_type  const    src_lo       = src_iter_1.get_range( ).get_iter_lo( ) + x_lo;
+        src_iter_0_type  const    src_post     = src_iter_1.get_range( ).get_iter_lo( ) + x_post;
+        trg_iter_0_type  const    trg_iter     = row_trg_iter + x_lo;
+        bool             const    is_lo_edge   = (src_iter_1 == src_iter_1_lo_);
+        bool             const    is_hi_edge   = (src_iter_1 == src_iter_1_hi_);
+        bool             const    is_periodic  = (boundary_ == finite_difference::e_boundary_periodic);
+
+        if ( is_varying_ ) {
+            // The mirrored row past the top or bottom edge is the row itself.
+            finite_difference::
+            calc_next_generation_forward_difference_2d_varying
+             (  damping
+              , super_type::get_rate( )
+              , rate_side_
+              , src_lo, src_post
+              , get_row_iter_lo_( src_iter_1, -1) + x_lo
+              , get_row_iter_lo_( src_iter_1, +1) + x_lo
+              , get_coef_row_iter_lo_( src_iter_1,  0) + x_lo
+              , get_coef_row_iter_lo_( src_iter_1, -1) + x_lo
+              , get_coef_row_iter_lo_( src_iter_1, +1) + x_lo
+              , trg_iter
+              , clamp_limit_
+             );
+        } else
+        if ( stencil_ != finite_difference::e_stencil_5_point ) {
+            src_iter_0_type const rows[ 5 ] =
+             {  get_row_iter_lo_( src_iter_1, -2) + x_lo
+              , get_row_iter_lo_( src_iter_1, -1) + x_lo
+              , src_lo
+              , get_row_iter_lo_( src_iter_1, +1) + x_lo
+              , get_row_iter_lo_( src_iter_1, +2) + x_lo
+             };
+            finite_difference::
+            calc_next_generation_forward_difference_2d_wide
+             (  stencil_
+              , damping
+              , super_type::get_rate( )
+              , rate_side_
+              , rows, src_post
+              , trg_iter
+              , clamp_limit_
+             );
+        } else
+        if ( is_periodic ? (! (is_lo_edge && is_hi_edge)) : ((! is_lo_edge) && (! is_hi_edge)) ) {
             finite_difference::
             calc_next_generation_forward_difference_2d_middle
-             (  super_type::get_damping( )
+             (  damping
               , super_type::get_rate( )
               , rate_side_
-              , src_range_0.get_iter_lo( ), src_range_0.get_iter_post( )
-              , (src_iter_1 - 1).get_range( ).get_iter_lo( )
-              , (src_iter_1 + 1).get_range( ).get_iter_lo( )
-              , trg_range_0.get_iter_lo( )
+              , src_lo, src_post
+              , get_row_iter_lo_( src_iter_1, -1) + x_lo
+              , get_row_iter_lo_( src_iter_1, +1) + x_lo
+              , trg_iter
+              , clamp_limit_
              );
         } else
         if ( ! is_lo_edge ) {
             finite_difference::
             calc_next_generation_forward_difference_2d_edge
-             (  super_type::get_damping( )
+             (  damping
               , super_type::get_rate( )
               , rate_side_
-              , src_range_0.get_iter_lo( ), src_range_0.get_iter_post( )
-              , (src_iter_1 - 1).get_range( ).get_iter_lo( )
-              , trg_range_0.get_iter_lo( )
+              , src_lo, src_post
+              , (src_iter_1 - 1).get_range( ).get_iter_lo( ) + x_lo
+              , trg_iter
+              , clamp_limit_
              );
         } else
         if ( ! is_hi_edge ) {
             finite_difference::
             calc_next_generation_forward_difference_2d_edge
-             (  super_type::get_damping( )
+             (  damping
               , super_type::get_rate( )
               , rate_side_
-              , src_range_0.get_iter_lo( ), src_range_0.get_iter_post( )
-              , (src_iter_1 + 1).get_range( ).get_iter_lo( )
-              , trg_range_0.get_iter_lo( )
+              , src_lo, src_post
+              , (src_iter_1 + 1).get_range( ).get_iter_lo( ) + x_lo
+              , trg_iter
+              , clamp_limit_
              );
         } else
         /* both lo and hi edge (range_1 must be only one wide) */ {
             finite_difference::
             calc_next_generation_forward_difference_2d_thin_strip
-             (  super_type::get_damping( )
+             (  damping
               , super_type::get_rate( )
-              , src_range_0.get_iter_lo( ), src_range_0.get_iter_post( )
-              , trg_range_0.get_iter_lo( )
+              , src_lo, src_post
+              , trg_iter
+              , clamp_limit_
              );
         }
       }
+
+  // Solves the tiles in the row that p_tiles_ asks for, a run of side-by-side tiles at a time.
+  // Each run is solved one cell wider on both sides so the cells at its ends see their real
+  // neighbours. The extra cells get the wrong values (the kernel thinks they are at the end of the
+  // row) but they belong to skipped tiles, so we put their src values back.
+  // Then we copy the skipped tiles, and record which solved tiles changed. If we are gathering
+  // stats we keep them for each tile, and only read the skipped tiles we don't have them for.
+  protected:
+      void
+    calc_row_tiles_( src_iter_1_type const & src_iter_1, trg_iter_0_type const & trg_iter) const
+      {
+        src_iter_0_type const  src_iter      = src_iter_1.get_range( ).get_iter_lo( );
+        std::ptrdiff_t  const  x_count       = src_iter_1.get_range( ).get_count( );
+        std::size_t     const  y_index       = src_iter_1 - src_iter_1_lo_;
+        std::size_t     const  tile_x_count  = p_tiles_->get_tile_x_count( );
+        std::ptrdiff_t  const  tile_width    = tile_activity_type::e_tile_x_count;
+        val_type        const  tolerance     = p_tiles_->get_tolerance( );
+
+        for ( std::size_t tile_x = 0 ; tile_x < tile_x_count ; ) {
+            if ( ! p_tiles_->is_solved( tile_x, y_index) ) {
+                ++ tile_x;
+            } else {
+                std::size_t tile_post = tile_x + 1;
+                while ( (tile_post < tile_x_count) && p_tiles_->is_solved( tile_post, y_index) ) {
+                    ++ tile_post;
+                }
+                std::ptrdiff_t const  x_lo    = tile_x * tile_width;
+                std::ptrdiff_t const  x_post  = std::min< std::ptrdiff_t >( tile_post * tile_width, x_count);
+                calc_row_
+                 (  super_type::get_damping( ), src_iter_1
+                  , (x_lo > 0) ? (x_lo - 1) : x_lo
+                  , (x_post < x_count) ? (x_post + 1) : x_post
+                  , trg_iter
+                 );
+                if ( x_lo > 0 ) {
+                    *(trg_iter + (x_lo - 1)) = *(src_iter + (x_lo - 1));
+                }
+                if ( x_post < x_count ) {
+                    *(trg_iter + x_post) = *(src_iter + x_post);
+                }
+                tile_x = tile_post;
+            }
+        }
+
+        for ( std::size_t tile_x = 0 ; tile_x < tile_x_count ; ++ tile_x ) {
+            std::ptrdiff_t   const    x_lo    = tile_x * tile_width;
+            std::ptrdiff_t   const    x_post  = std::min< std::ptrdiff_t >( x_lo + tile_width, x_count);
+            sheet_stats_type       &  stats   = p_tiles_->ref_row_stats( tile_x, y_index);
+            if ( p_tiles_->is_solved( tile_x, y_index) ) {
+                // We only need to know if the change is as big as the tolerance.
+                bool is_changed = false;
+                for ( std::ptrdiff_t x = x_lo ; (x < x_post) && (! is_changed) ; ++ x ) {
+                    val_type const diff = *(trg_iter + x) - *(src_iter + x);
+                    is_changed = (diff >= tolerance) || (diff <= -tolerance);
+                }
+                p_tiles_->set_row_changed( tile_x, y_index, is_changed);
+                stats.clear( );
+            } else
+            if ( p_tiles_->is_copy_needed( tile_x, y_index) ) {
+                std::copy( src_iter + x_lo, src_iter + x_post, trg_iter + x_lo);
+            }
+            if ( p_row_stats_ && stats.is_empty( ) ) {
+                stats.add_values( trg_iter + x_lo, trg_iter + x_post);
+            }
+        }
+      }
+
+  // Fixed boundary: the top and bottom rows are copied whole, and the other rows keep their end
+  // cells. Like the rows, the columns are only fixed if there are more than 2 of them, so there
+  // is something left to solve.
+  protected:
+      bool
+    is_fixed_row_( src_iter_1_type const & src_iter_1) const
+      {
+        return
+            (boundary_ == finite_difference::e_boundary_fixed) &&
+            ((src_iter_1_hi_ - src_iter_1_lo_) > 1) &&
+            ((src_iter_1 == src_iter_1_lo_) || (src_iter_1 == src_iter_1_hi_));
+      }
+
+      void
+    fix_row_ends_( src_range_0_type const & src_range_0, trg_iter_0_type const & trg_iter) const
+      {
+        std::ptrdiff_t const count = src_range_0.get_count( );
+        if ( count > 2 ) {
+            *trg_iter                 = *src_range_0.get_iter_lo( );
+            *(trg_iter + (count - 1)) = *(src_range_0.get_iter_lo( ) + (count - 1));
+        }
+      }
+
+  // Periodic boundary: the kernel mirrored the end cells, now wrap them.
+  protected:
+      void
+    wrap_row_ends_( src_iter_1_type const & src_iter_1, trg_iter_0_type const & trg_iter) const
+      {
+        std::ptrdiff_t  const  count    = src_iter_1.get_range( ).get_count( );
+        if ( is_varying_ ) {
+            finite_difference::
+            wrap_forward_diff_varying_row_ends
+             (  super_type::get_rate( )
+              , src_iter_1.get_range( ).get_iter_lo( )
+              , get_coef_row_iter_lo_( src_iter_1, 0)
+              , count
+              , trg_iter
+             );
+        } else {
+            src_iter_0_type const  rows[ 5 ] =
+             {  get_row_iter_lo_( src_iter_1, -2)
+              , get_row_iter_lo_( src_iter_1, -1)
+              , src_iter_1.get_range( ).get_iter_lo( )
+              , get_row_iter_lo_( src_iter_1, +1)
+              , get_row_iter_lo_( src_iter_1, +2)
+             };
+            finite_difference::
+            wrap_forward_diff_row_ends
+             (  stencil_
+              , super_type::get_rate( )
+              , rate_side_
+              , rows, count
+              , trg_iter
+             );
+        }
+
+        // Only the 2 cells at each end change.
+        if ( clamp_limit_ != 0 ) {
+            std::ptrdiff_t const end_count = std::min< std::ptrdiff_t >( 2, count);
+            for ( std::ptrdiff_t index = 0 ; index < end_count ; ++ index ) {
+                clamp_( *(trg_iter + index));
+                clamp_( *(trg_iter + ((count - 1) - index)));
+            }
+        }
+      }
+
+  // Absorbing boundary.
+  //   The middle of the row gets the damping for the row's distance from the top or bottom edge.
+  //   The cells nearer the left or right edge need more. The kernel writes over the history
+  //   (the older generation in trg), so we save it for those cells first, and then move them from
+  //   the row damping to their own. The assign3 functors work out to
+  //     trg = side + ((1 - damping) * (src - history))
+  //   so this is
+  //     trg += (row_damping - cell_damping) * (src - history)
+  protected:
+      void
+    calc_absorbing_row_( src_iter_1_type const & src_iter_1, trg_iter_0_type const & trg_iter) const
+      {
+        src_iter_0_type const  src_iter     = src_iter_1.get_range( ).get_iter_lo( );
+        std::ptrdiff_t  const  x_count      = src_iter_1.get_range( ).get_count( );
+        std::ptrdiff_t  const  x_width      = finite_difference::get_absorbing_width( x_count);
+        rate_type       const  row_damping  = get_absorbing_row_damping_( src_iter_1);
+
+        // The cells within x_width of either end. x_width is at most a quarter of x_count, so
+        // the two ends do not overlap.
+        val_type history[ 2 * finite_difference::e_absorbing_max_width ];
+        for ( std::ptrdiff_t slot = 0 ; slot < (2 * x_width) ; ++ slot ) {
+            history[ slot ] = *(trg_iter + get_absorbing_index_( slot, x_count, x_width));
+        }
+
+        calc_row_( row_damping, src_iter_1, 0, x_count, trg_iter);
+
+        for ( std::ptrdiff_t slot = 0 ; slot < (2 * x_width) ; ++ slot ) {
+            std::ptrdiff_t const  index         = get_absorbing_index_( slot, x_count, x_width);
+            rate_type      const  cell_damping  =
+                finite_difference::get_absorbing_damping
+                 (  super_type::get_damping( )
+                  , std::min( index, (x_count - 1) - index)
+                  , x_width
+                 );
+            if ( cell_damping > row_damping ) {
+                val_type & trg = *(trg_iter + index);
+                trg += (row_damping - cell_damping) * (*(src_iter + index) - history[ slot ]);
+                clamp_( trg);
+            }
+        }
+      }
+
+      static
+      std::ptrdiff_t
+    get_absorbing_index_( std::ptrdiff_t slot, std::ptrdiff_t x_count, std::ptrdiff_t x_width)
+      {
+        return (slot < x_width) ? slot : ((x_count - x_width) + (slot - x_width));
+      }
+
+      rate_type
+    get_absorbing_row_damping_( src_iter_1_type const & src_iter_1) const
+      {
+        std::ptrdiff_t const  y_count  = (src_iter_1_hi_ - src_iter_1_lo_) + 1;
+        std::ptrdiff_t const  y_index  = src_iter_1 - src_iter_1_lo_;
+        return
+            finite_difference::get_absorbing_damping
+             (  super_type::get_damping( )
+              , std::min( y_index, (y_count - 1) - y_index)
+              , finite_difference::get_absorbing_width( y_count)
+             );
+      }
+
+  // Leapfrog wave.
+  //   The heat step (damping 1) puts side in trg, and then calc_leapfrog_velocity(..) finishes
+  //   the wave step and moves the velocity along. The absorbing layer gives the cells near the
+  //   ends their own damping, like calc_absorbing_row_(..) above. Fixed end cells keep their
+  //   values and have no velocity.
+  protected:
+      void
+    calc_leapfrog_row_( src_iter_1_type const & src_iter_1, trg_iter_0_type const & trg_iter) const
+      {
+        src_iter_0_type const  src_iter       = src_iter_1.get_range( ).get_iter_lo( );
+        std::ptrdiff_t  const  x_count        = src_iter_1.get_range( ).get_count( );
+        trg_iter_0_type const  velocity_iter  = get_velocity_row_iter_lo_( src_iter_1);
+
+        calc_row_( rate_type( 1), src_iter_1, 0, x_count, trg_iter);
+        if ( boundary_ == finite_difference::e_boundary_periodic ) {
+            wrap_row_ends_( src_iter_1, trg_iter);
+        }
+
+        if ( boundary_ == finite_difference::e_boundary_absorbing ) {
+            std::ptrdiff_t const  x_width      = finite_difference::get_absorbing_width( x_count);
+            rate_type      const  row_damping  = get_absorbing_row_damping_( src_iter_1);
+            finite_difference::calc_leapfrog_velocity
+             (  row_damping, x_count - (2 * x_width)
+              , src_iter + x_width, velocity_iter + x_width, trg_iter + x_width
+              , clamp_limit_
+             );
+            for ( std::ptrdiff_t slot = 0 ; slot < (2 * x_width) ; ++ slot ) {
+                std::ptrdiff_t const  index         = get_absorbing_index_( slot, x_count, x_width);
+                rate_type      const  cell_damping  =
+                    finite_difference::get_absorbing_damping
+                     (  super_type::get_damping( )
+                      , std::min( index, (x_count - 1) - index)
+                      , x_width
+                     );
+                finite_difference::calc_leapfrog_velocity
+                 (  std::max( row_damping, cell_damping), 1
+                  , src_iter + index, velocity_iter + index, trg_iter + index
+                  , clamp_limit_
+                 );
+            }
+        } else {
+            finite_difference::calc_leapfrog_velocity
+             (  super_type::get_damping( ), x_count
+              , src_iter, velocity_iter, trg_iter
+              , clamp_limit_
+             );
+        }
+
+        if ( (boundary_ == finite_difference::e_boundary_fixed) && (x_count > 2) ) {
+            fix_row_ends_( src_iter_1.get_range( ), trg_iter);
+            *velocity_iter                   = 0;
+            *(velocity_iter + (x_count - 1)) = 0;
+        }
+      }
+
+  // The start of the velocity row that goes with src_iter_1.
+  protected:
+      trg_iter_0_type
+    get_velocity_row_iter_lo_( src_iter_1_type const & src_iter_1) const
+      {
+        return (velocity_iter_1_lo_ + (src_iter_1 - src_iter_1_lo_)).get_range( ).get_iter_lo( );
+      }
+
+  // Same tests, in the same order, as finite_difference::assign3_clamp_type.
+  protected:
+      void
+    clamp_( val_type & value) const
+      {
+        if ( clamp_limit_ != 0 ) {
+            value = (value <   clamp_limit_ ) ? value :   clamp_limit_ ;
+            value = (value > (-clamp_limit_)) ? value : (-clamp_limit_);
+        }
+      }
+
+  // The start of the row that is offset rows away from src_iter_1, wrapped past the top and
+  // bottom edges if the boundary is periodic, and mirrored otherwise.
+  protected:
+      src_iter_0_type
+    get_row_iter_lo_( src_iter_1_type const & src_iter_1, std::ptrdiff_t offset) const
+      {
+        std::ptrdiff_t const  count  = (src_iter_1_hi_ - src_iter_1_lo_) + 1;
+        std::ptrdiff_t const  index  = src_iter_1 - src_iter_1_lo_;
+        return (src_iter_1_lo_ + finite_difference::get_boundary_index( boundary_, index + offset, count))
+                .get_range( ).get_iter_lo( );
+      }
+
+  // The same for the coefficient sheet.
+  protected:
+      coef_iter_0_type
+    get_coef_row_iter_lo_( src_iter_1_type const & src_iter_1, std::ptrdiff_t offset) const
+      {
+        std::ptrdiff_t const  count  = (src_iter_1_hi_ - src_iter_1_lo_) + 1;
+        std::ptrdiff_t const  index  = src_iter_1 - src_iter_1_lo_;
+        return (coef_iter_1_lo_ + finite_difference::get_boundary_index( boundary_, index + offset, count))
+                .get_range( ).get_iter_lo( );
+      }
+};
+
+// _______________________________________________________________________________________________
+// Solving functor for backward and central diff with a factored matrix
+//
+//   Like solving_functor_two_buffer_type<..> except the matrix is already factored, so it only
+//   needs one buffer. When used with the serial map(..) it uses the fixed buffer. When used with
+//   the parallel map(..) it uses the first buffer in the quad.
+//
+//   The matrix is owned by an implicit_matrix_cache_type<..> (below), and must not change while
+//   this functor is mapped.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename BUF_ITER_TYPE
+   >
+  struct
+solving_functor_factored_type
+  : public solving_functor_base_type
+            <  RATE_TYPE
+             , SRC_ITER_TYPE
+             , TRG_ITER_TYPE
+            >
+  , public solving_functor_typenames_buf_type
+            <  BUF_ITER_TYPE
+            >
+{
+  // Inherited typedefs
+  private:
+    typedef solving_functor_base_type
+             <  RATE_TYPE
+              , SRC_ITER_TYPE
+              , TRG_ITER_TYPE
+             >                 super_type;
+    typedef solving_functor_typenames_buf_type
+             <  BUF_ITER_TYPE
+             >                 super2_type;
+  public:
+    INHERIT_FUNCTOR_TYPENAMES( super_type);
+    INHERIT_BUFFER_TYPENAMES( super2_type);
+
+  // Typedefs
+  public:
+    typedef pair_iter
+             <  src_trg_iter_1_type
+              , buf_buf_iter_0_type
+             >              quad_iter_type       ;
+    typedef typename quad_iter_type::counter_type
+                            quad_count_type      ;
+
+    typedef finite_difference::implicit_matrix_type< rate_type >
+                            matrix_type          ;
+
+  // Constructor
+  public:
+    solving_functor_factored_type
+     (  bool                const &  is_early
+      , rate_type           const &  damping
+      , matrix_type         const &  matrix
+      , buf_iter_type       const &  buf_iter
+     )
+      : super_type( is_early, damping, matrix.get_rate( ))
+      , matrix_   ( matrix   )
+      , buf_iter_ ( buf_iter )
+      { }
+      matrix_type   const &  matrix_   ;
+      buf_iter_type const    buf_iter_ ;
+
+  // Functor, a single pair param, used in serial map(..) functions
+  public:
+      void
+    operator ()( src_trg_count_1_type src_trg) const
+      {
+        operator ()( src_trg.get<0>( ).get_range( ), src_trg.get<1>( ).get_range( ), buf_iter_);
+      }
+
+  // Functor, single quad param, used in parallel map(..) functions
+  public:
+      void
+    operator ()( quad_count_type src_trg_bb) const
+      {
+        src_trg_iter_1_type const &  src_trg   = src_trg_bb.get<0>( );
+        buf_iter_0_type             buf_iter  = (*(src_trg_bb.get<1>( ))).get<0>( );
+
+        operator ()
+         (  (*src_trg).get<0>( ).get_range( )
+          , (*src_trg).get<1>( ).get_range( )
+          , buf_iter.get_leaf_iter( )
+         );
+      }
+
+  // Functor, 3 params
+  public:
+      void
+    operator ()
+     (  src_range_0_type const &  src_range
+      , trg_range_0_type const &  trg_range
+      , buf_iter_type    const &  buf_iter
+     ) const
+      {
+        d_assert( src_range.get_count( ) == trg_range.get_count( ));
+        d_assert( src_range.get_count( ) == matrix_.get_count( ));
+        if ( super_type::not_early_exit( ) ) {
+            finite_difference::
+            calc_next_generation_implicit_difference_1d_factored
+             (  matrix_
+              , super_type::get_damping( )
+              , src_range.get_iter_lo( ), src_range.get_iter_post( )
+              , trg_range.get_iter_lo( )
+              , buf_iter
+             );
+        }
+      }
+};
+
+// _______________________________________________________________________________________________
+// Cache of factored matrices
+//
+//   The backward- and central-diff functors solve every row in a pass with the same matrix, and
+//   the matrix stays the same from one generation to the next unless the rate or sheet size
+//   changes. So we keep the factored matrices here and only factor again when asked for one we
+//   don't have.
+//
+//   A 2d solve uses two matrices each generation (one for the rows and one for the columns), so
+//   we keep two and replace the oldest.
+//
+//   get_matrix(..) is not thread safe. Call it before you start mapping rows to threads.
+
+  template< typename RATE_TYPE >
+  class
+implicit_matrix_cache_type
+{
+  public:
+    typedef finite_difference::implicit_matrix_type< RATE_TYPE > matrix_type;
+
+    implicit_matrix_cache_type( )
+      : next_( 0) { }
+
+    matrix_type const &
+    get_matrix( RATE_TYPE base, RATE_TYPE rate, std::size_t count)
+      {
+        for ( std::size_t index = 0 ; index < slot_count ; ++ index ) {
+            if ( matrices_[ index ].is_factored( base, rate, count) ) {
+                return matrices_[ index ];
+            }
+        }
+        matrix_type & matrix = matrices_[ next_ ];
+        next_ = (next_ + 1) % slot_count;
+        matrix.factor( base, rate, count);
+        return matrix;
+      }
+
+    void
+    clear( )
+      { for ( std::size_t index = 0 ; index < slot_count ; ++ index ) {
+            matrices_[ index ].clear( );
+        }
+        next_ = 0;
+      }
+
+  private:
+    static std::size_t const  slot_count = 2;
+    matrix_type               matrices_[ slot_count ];
+    std::size_t               next_ ;
 };
 
 // _______________________________________________________________________________________________
@@ -569,6 +1427,7 @@ map_serial
   //   solving_functor_no_buffer_type<..>
   //   solving_functor_fixed_two_buffer_type<..>
   //   solving_functor_forward_diff_2d_type<..>
+  //   solving_functor_factored_type<..>
 {
     // The src and trg must be the same width.
     d_assert( src_range.get_count( ) == trg_range.get_count( ));
@@ -613,7 +1472,10 @@ map_parallel
     src_trg_pair_iter_type const  iter_post( src_range.get_iter_post( ));
 
     // Iterate thru the src/trg pairs, solving for each.
-    QtConcurrent::blockingMap( iter_lo, iter_post, solving_functor);
+    row_pool::blocking_map_rows
+     (  iter_lo, iter_post, solving_functor
+      , src_range.get_next_range( ).get_count( ) * sizeof( typename SOLVING_FUNCTOR_TYPE::val_type)
+     );
 }
 
   template< typename SOLVING_FUNCTOR_TYPE >
@@ -628,8 +1490,9 @@ map_parallel
   // Use this with any solving functor that has an operator() that accepts a src/trg + buf/buf
   // quad (or pair-of-pairs).
   //
-  // Only one of the solving-functor templates accepts quads:
+  // The solving-functor templates that accept quads:
   //   solving_functor_two_buffer_type<..>
+  //   solving_functor_factored_type<..>
   // So instead of SOLVING_FUNCTOR_TYPE we could have these template params:
   //   RATE_TYPE
   //   SRC_ITER_TYPE
@@ -660,7 +1523,10 @@ map_parallel
          );
 
     // Iterate thru the quads, solving for each.
-    QtConcurrent::blockingMap( iter_lo, iter_post, solving_functor);
+    row_pool::blocking_map_rows
+     (  iter_lo, iter_post, solving_functor
+      , src_range.get_next_range( ).get_count( ) * sizeof( typename SOLVING_FUNCTOR_TYPE::val_type)
+     );
 }
 
 // _______________________________________________________________________________________________
@@ -884,6 +1750,456 @@ calc_next_1d_central_diff_parallel
      );
 }
 
+// _______________________________________________________________________________________________
+// Backward or central diff with a factored matrix, serial and parallel
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename BUF_ITER_TYPE
+   >
+  void
+calc_next_1d_implicit_factored_serial
+  (  bool                             const &  is_early_exit
+   , finite_difference::implicit_matrix_type< RATE_TYPE >
+                                      const &  matrix
+   , RATE_TYPE                        const &  damping
+   , stride_range< SRC_ITER_TYPE, 1 > const &  src_range
+   , stride_range< TRG_ITER_TYPE, 1 > const &  trg_range
+   , BUF_ITER_TYPE                    const &  buf_iter
+  )
+{
+    // Solve (1d) and put the results in trg.
+    map_serial
+     (  solving_functor_factored_type
+         <  RATE_TYPE
+          , SRC_ITER_TYPE
+          , TRG_ITER_TYPE
+          , BUF_ITER_TYPE
+         >
+         (  is_early_exit
+          , damping
+          , matrix
+          , buf_iter
+         )
+      , src_range
+      , trg_range
+     );
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename BUF_ITER_TYPE
+   >
+  void
+calc_next_1d_implicit_factored_parallel
+  (  bool                             const &  is_early_exit
+   , finite_difference::implicit_matrix_type< RATE_TYPE >
+                                      const &  matrix
+   , RATE_TYPE                        const &  damping
+   , stride_range< SRC_ITER_TYPE, 1 > const &  src_range
+   , stride_range< TRG_ITER_TYPE, 1 > const &  trg_range
+   , stride_range< BUF_ITER_TYPE, 0 > const &  buf_range
+  )
+{
+    // Solve (1d) and put the results in trg.
+    // The functor only uses the first buffer in each quad, so pass the same range twice.
+    map_parallel
+     (  solving_functor_factored_type
+         <  RATE_TYPE
+          , SRC_ITER_TYPE
+          , TRG_ITER_TYPE
+          , BUF_ITER_TYPE
+         >
+         (  is_early_exit
+          , damping
+          , matrix
+          , buf_range.get_iter_lo( ).get_leaf_iter( )
+         )
+      , src_range
+      , trg_range
+      , buf_range
+      , buf_range
+     );
+}
+
+// _______________________________________________________________________________________________
+// Backward or central diff, each row split across threads
+//
+//   The parallel map(..) functions give each thread whole rows. That's no good when a short,
+//   wide sheet has fewer rows than we have threads, because each row is a single sequential
+//   solve. So instead we cut each row into partitions and solve them at the same time, using
+//   the partitioned solver in tri_diag.h. Only the few values at the partition edges are
+//   solved serially.
+//
+//   The results are close to, but not bit-for-bit the same as, the serial solve.
+//
+//   The functor below does one of the two parallel steps for one partition of one row.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename BUF_ITER_TYPE
+   >
+  struct
+solving_functor_partition_type
+{
+  // Typedefs
+  public:
+    typedef RATE_TYPE                               rate_type     ;
+    typedef stride_iter< SRC_ITER_TYPE, 0 >         src_iter_type ;
+    typedef stride_iter< TRG_ITER_TYPE, 0 >         trg_iter_type ;
+    typedef BUF_ITER_TYPE                           buf_iter_type ;
+    typedef std::pair< std::size_t, std::size_t >   partition_type;
+    typedef typename std::iterator_traits< buf_iter_type >::value_type
+                                                    item_type     ;
+
+  // Constructor
+  public:
+    solving_functor_partition_type
+     (  bool                             const &  is_early
+      , bool                             const    is_finish   // false to reduce, true to finish
+      , rate_type                        const    base
+      , rate_type                        const    damping
+      , rate_type                        const    rate
+      , std::size_t                      const    count       // length of the whole row
+      , std::size_t                      const    partition_length
+      , src_iter_type                    const &  src_iter    // start of the row
+      , trg_iter_type                    const &  trg_iter
+      , buf_iter_type                    const &  buf_iter_a  // 2 * count items
+      , buf_iter_type                    const &  buf_iter_b  // 2 * count items
+      , std::vector< item_type >         const &  edge_values // 2 solved values for each partition
+     )
+      : is_early_exit_    ( is_early         )
+      , is_finish_        ( is_finish        )
+      , base_             ( base             )
+      , damping_          ( damping          )
+      , rate_             ( rate             )
+      , count_            ( count            )
+      , partition_length_ ( partition_length )
+      , src_iter_         ( src_iter         )
+      , trg_iter_         ( trg_iter         )
+      , diag_iter_        ( buf_iter_a       )
+      , sub_iter_         ( buf_iter_a + count)
+      , super_iter_       ( buf_iter_b       )
+      , rhs_iter_         ( buf_iter_b + count)
+      , edge_values_      ( edge_values      )
+      { }
+      bool                      const &  is_early_exit_    ; /* this is a REF to a bool somewhere else */
+      bool                      const    is_finish_        ;
+      rate_type                 const    base_             ;
+      rate_type                 const    damping_          ;
+      rate_type                 const    rate_             ;
+      std::size_t               const    count_            ;
+      std::size_t               const    partition_length_ ;
+      src_iter_type             const    src_iter_         ;
+      trg_iter_type             const    trg_iter_         ;
+      buf_iter_type             const    diag_iter_        ;
+      buf_iter_type             const    sub_iter_         ;
+      buf_iter_type             const    super_iter_       ;
+      buf_iter_type             const    rhs_iter_         ; /* filled in before we start */
+      std::vector< item_type >  const &  edge_values_      ;
+
+  // Functor, solves rows [lo, hi_plus) of the row.
+  public:
+      void
+    operator ()( partition_type const & lo_hi_plus) const
+      {
+        if ( is_early_exit_ ) return;
+
+        std::size_t const  lo     = lo_hi_plus.first;
+        std::size_t const  count  = lo_hi_plus.second - lo;
+        if ( ! is_finish_ ) {
+            // Same diagonal as calc_matrix_diagonal(..).
+            rate_type const carry_edge = base_ + rate_;
+            std::fill_n( diag_iter_ + lo, count, carry_edge + rate_);
+            if ( 0 == lo ) { diag_iter_[ 0 ] = carry_edge; }
+            if ( count_ == lo_hi_plus.second ) { diag_iter_[ count_ - 1 ] = carry_edge; }
+
+            linear_algebra::
+              reduce_tridiagonal_partition
+               (  count
+                , - rate_, diag_iter_ + lo, - rate_
+                , rhs_iter_ + lo
+                , sub_iter_ + lo, super_iter_ + lo
+               );
+        } else {
+            // Same as init_damping_and_solve_matrix_destructive(..).
+            std::size_t const  edge_index  = 2 * (lo / partition_length_);
+            item_type   const  first_value = edge_values_[ edge_index     ];
+            item_type   const  last_value  = edge_values_[ edge_index + 1 ];
+            if ( finite_difference::get_no_init_damping_set_value< rate_type >( ) == damping_ ) {
+                linear_algebra::
+                  finish_tridiagonal_partition
+                   (  util::assign_set_type< item_type >( )
+                    , count, sub_iter_ + lo, super_iter_ + lo, rhs_iter_ + lo
+                    , first_value, last_value
+                    , trg_iter_ + lo
+                   );
+            } else {
+                if ( finite_difference::get_no_init_damping_sum_value< rate_type >( ) != damping_ ) {
+                    finite_difference::init_wave_damping( damping_, count, src_iter_ + lo, trg_iter_ + lo);
+                }
+                linear_algebra::
+                  finish_tridiagonal_partition
+                   (  util::assign_sum_type< item_type >( )
+                    , count, sub_iter_ + lo, super_iter_ + lo, rhs_iter_ + lo
+                    , first_value, last_value
+                    , trg_iter_ + lo
+                   );
+            }
+        }
+      }
+};
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename BUF_ITER_TYPE
+   >
+  void
+calc_next_1d_implicit_partitioned
+  (  bool                             const &  is_early_exit
+   , RATE_TYPE                        const &  base        // 1 for backward diff, 2 for central diff
+   , RATE_TYPE                        const &  damping
+   , RATE_TYPE                        const &  rate
+   , stride_range< SRC_ITER_TYPE, 1 > const &  src_range
+   , stride_range< TRG_ITER_TYPE, 1 > const &  trg_range
+   , BUF_ITER_TYPE                    const &  buf_iter_a  // (2 * row length) items
+   , BUF_ITER_TYPE                    const &  buf_iter_b  // (2 * row length) items
+   , std::size_t                      const    partition_count
+  )
+  //
+  // Same as the backward- or central-diff parallel solve, except the rows are solved one at a
+  // time with each row split into partition_count pieces.
+{
+    typedef solving_functor_partition_type
+             <  RATE_TYPE
+              , SRC_ITER_TYPE
+              , TRG_ITER_TYPE
+              , BUF_ITER_TYPE
+             >                                          functor_type   ;
+    typedef typename functor_type::item_type            item_type      ;
+    typedef typename functor_type::partition_type       partition_type ;
+    typedef stride_iter< SRC_ITER_TYPE, 1 >             src_iter_1_type;
+    typedef stride_iter< TRG_ITER_TYPE, 1 >             trg_iter_1_type;
+
+    d_assert( src_range.get_count( ) == trg_range.get_count( ));
+    std::size_t const  count             = src_range.get_next_range( ).get_count( );
+    std::size_t const  partition_length  = (count + partition_count - 1) / partition_count;
+
+    std::vector< partition_type > partitions;
+    for ( std::size_t lo = 0 ; lo < count ; lo += partition_length ) {
+        partitions.push_back( std::make_pair( lo, std::min( lo + partition_length, count)));
+        d_assert( (partitions.back( ).second - lo) >= 3);
+    }
+    std::size_t const edge_count = 2 * partitions.size( );
+
+    // The small system made from the first and last rows of each partition.
+    std::vector< item_type >  edge_sub    ( edge_count);
+    std::vector< item_type >  edge_super  ( edge_count);
+    std::vector< item_type >  edge_values ( edge_count);
+
+    // The functor keeps the diagonal in the first half of buf_iter_a (see its constructor).
+    BUF_ITER_TYPE const  sub_iter    = buf_iter_a + count;
+    BUF_ITER_TYPE const  super_iter  = buf_iter_b;
+    BUF_ITER_TYPE const  rhs_iter    = buf_iter_b + count;
+
+    src_iter_1_type        src_iter  = src_range.get_iter_lo( );
+    src_iter_1_type const  src_post  = src_range.get_iter_post( );
+    trg_iter_1_type        trg_iter  = trg_range.get_iter_lo( );
+    for ( ; (src_iter != src_post) && ! is_early_exit ; ++ src_iter, ++ trg_iter ) {
+        stride_range< SRC_ITER_TYPE, 0 > const & src_row = src_iter.get_range( );
+        stride_range< TRG_ITER_TYPE, 0 > const & trg_row = trg_iter.get_range( );
+        d_assert( src_row.get_count( ) == count);
+
+        finite_difference::calc_implicit_difference_rhs
+         ( base, rate, src_row.get_iter_lo( ), src_row.get_iter_post( ), rhs_iter);
+
+        row_pool::blocking_map
+         (  partitions.begin( ), partitions.end( )
+          , functor_type
+             (  is_early_exit, false /* reduce */, base, damping, rate, count, partition_length
+              , src_row.get_iter_lo( ), trg_row.get_iter_lo( ), buf_iter_a, buf_iter_b, edge_values
+             )
+         );
+        if ( is_early_exit ) break;
+
+        // Solve the first and last rows of all the partitions.
+        for ( std::size_t index = 0 ; index < partitions.size( ) ; ++ index ) {
+            std::size_t const first = partitions[ index ].first;
+            std::size_t const last  = partitions[ index ].second - 1;
+            edge_sub   [ (2 * index)     ] = sub_iter  [ first ];
+            edge_super [ (2 * index)     ] = super_iter[ first ];
+            edge_values[ (2 * index)     ] = rhs_iter  [ first ];
+            edge_sub   [ (2 * index) + 1 ] = sub_iter  [ last  ];
+            edge_super [ (2 * index) + 1 ] = super_iter[ last  ];
+            edge_values[ (2 * index) + 1 ] = rhs_iter  [ last  ];
+        }
+        linear_algebra::
+          solve_tridiagonal_unit_destructive
+           ( edge_count, edge_sub.begin( ), edge_super.begin( ), edge_values.begin( ));
+
+        row_pool::blocking_map
+         (  partitions.begin( ), partitions.end( )
+          , functor_type
+             (  is_early_exit, true /* finish */, base, damping, rate, count, partition_length
+              , src_row.get_iter_lo( ), trg_row.get_iter_lo( ), buf_iter_a, buf_iter_b, edge_values
+             )
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// Backward or central diff with varying conductivity, serial and parallel
+//
+//   Solves each row of src_range with calc_next_generation_implicit_difference_1d_varying(..).
+//   coef_range walks the coefficient sheet the same way src_range walks the src sheet (rows for
+//   the x pass, columns for the y pass). Each row has its own matrix, so there is nothing to
+//   factor ahead of time. A serial solve uses the same two buffers for every row. A parallel
+//   solve gives every row its own two buffers.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename COEF_ITER_TYPE
+    , typename BUF_ITER_TYPE
+   >
+  struct
+solving_functor_implicit_varying_type
+  : public solving_functor_base_type
+            <  RATE_TYPE
+             , SRC_ITER_TYPE
+             , TRG_ITER_TYPE
+            >
+{
+  // Inherited typedefs
+  private:
+    typedef solving_functor_base_type
+             <  RATE_TYPE
+              , SRC_ITER_TYPE
+              , TRG_ITER_TYPE
+             >                 super_type;
+  public:
+    INHERIT_FUNCTOR_TYPENAMES( super_type);
+    typedef stride_iter< COEF_ITER_TYPE, 1 >  coef_iter_1_type ;
+
+  // Constructor
+  public:
+    solving_functor_implicit_varying_type
+     (  bool                const &  is_early
+      , rate_type           const    base            // 1 for backward diff, 2 for central diff
+      , rate_type           const &  damping
+      , rate_type           const &  rate
+      , src_iter_1_type     const &  src_iter_1_lo   // first row, so we know which row we're on
+      , coef_iter_1_type    const &  coef_iter_1_lo  // first row of the coefficient sheet
+      , BUF_ITER_TYPE       const &  buf_iter_a
+      , BUF_ITER_TYPE       const &  buf_iter_b
+      , diff_type           const    buf_row_stride  // zero if every row uses the same buffers
+     )
+      : super_type( is_early, damping, rate)
+      , base_           ( base           )
+      , src_iter_1_lo_  ( src_iter_1_lo  )
+      , coef_iter_1_lo_ ( coef_iter_1_lo )
+      , buf_iter_a_     ( buf_iter_a     )
+      , buf_iter_b_     ( buf_iter_b     )
+      , buf_row_stride_ ( buf_row_stride )
+      { }
+      rate_type          const  base_           ;
+      src_iter_1_type    const  src_iter_1_lo_  ;
+      coef_iter_1_type   const  coef_iter_1_lo_ ;
+      BUF_ITER_TYPE      const  buf_iter_a_     ;
+      BUF_ITER_TYPE      const  buf_iter_b_     ;
+      diff_type          const  buf_row_stride_ ;
+
+  // Functor, pair param, pair of src/trg iters
+  // This is the operator() called by the mapping functor, serial and parallel.
+  public:
+      void
+    operator ()( src_trg_count_1_type src_trg) const
+      {
+        src_iter_1_type  const &  src_iter_1   = src_trg.get<0>( );
+        src_range_0_type const &  src_range_0  = src_iter_1.get_range( );
+        trg_range_0_type const &  trg_range_0  = src_trg.get<1>( ).get_range( );
+
+        d_assert( src_range_0.get_count( ) == trg_range_0.get_count( ));
+        if ( super_type::not_early_exit( ) ) {
+            diff_type const  index       = src_iter_1 - src_iter_1_lo_;
+            diff_type const  buf_offset  = index * buf_row_stride_;
+            finite_difference::
+            calc_next_generation_implicit_difference_1d_varying
+             (  base_
+              , super_type::get_damping( )
+              , super_type::get_rate( )
+              , src_range_0.get_iter_lo( ), src_range_0.get_iter_post( )
+              , (coef_iter_1_lo_ + index).get_range( ).get_iter_lo( )
+              , trg_range_0.get_iter_lo( )
+              , buf_iter_a_ + buf_offset
+              , buf_iter_b_ + buf_offset
+             );
+        }
+      }
+};
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+    , typename COEF_ITER_TYPE
+    , typename VAL_TYPE
+   >
+  void
+calc_next_1d_implicit_varying
+ (  bool                              const &  is_early_exit
+  , bool                              const    is_parallel
+  , RATE_TYPE                         const    base          // 1 for backward diff, 2 for central diff
+  , RATE_TYPE                         const    damping
+  , RATE_TYPE                         const    rate
+  , stride_range< SRC_ITER_TYPE, 1 >  const &  src_range     // can be the same as trg_range
+  , stride_range< COEF_ITER_TYPE, 1 > const &  coef_range
+  , stride_range< TRG_ITER_TYPE, 1 >  const &  trg_range
+  , std::vector< VAL_TYPE >                 &  buf_a
+  , std::vector< VAL_TYPE >                 &  buf_b
+ )
+{
+    d_assert( src_range.get_count( ) == coef_range.get_count( ));
+    std::size_t const  row_count  = src_range.get_count( );
+    if ( 0 == row_count ) return;
+
+    std::size_t const  cell_count  = src_range.get_iter_lo( ).get_range( ).get_count( );
+    std::size_t const  buf_count   = is_parallel ? (row_count * cell_count) : cell_count;
+    if ( buf_a.size( ) < buf_count ) { buf_a.resize( buf_count); }
+    if ( buf_b.size( ) < buf_count ) { buf_b.resize( buf_count); }
+
+    typedef solving_functor_implicit_varying_type
+             <  RATE_TYPE
+              , SRC_ITER_TYPE
+              , TRG_ITER_TYPE
+              , COEF_ITER_TYPE
+              , typename std::vector< VAL_TYPE >::iterator
+             >  solving_functor_type;
+    solving_functor_type const
+        solving_functor
+         (  is_early_exit
+          , base, damping, rate
+          , src_range.get_iter_lo( )
+          , coef_range.get_iter_lo( )
+          , buf_a.begin( ), buf_b.begin( )
+          , is_parallel ? static_cast< typename solving_functor_type::diff_type >( cell_count) : 0
+         );
+    if ( is_parallel ) {
+        map_parallel( solving_functor, src_range, trg_range);
+    } else {
+        map_serial( solving_functor, src_range, trg_range);
+    }
+}
+
 // _______________________________________________________________________________________________
 // Forward diff 2d, serial and parallel
 
@@ -891,15 +2207,25 @@ calc_next_1d_central_diff_parallel
    <  typename RATE_TYPE
     , typename SRC_ITER_TYPE
     , typename TRG_ITER_TYPE
+    , typename COEF_ITER_TYPE
    >
   void
 calc_next_2d_forward_diff_serial
   (  bool                             const &  is_early_exit
+   , finite_difference::stencil_type  const    stencil
+   , finite_difference::boundary_type const    boundary
    , RATE_TYPE                        const &  damping
    , RATE_TYPE                        const &  rate
    , RATE_TYPE                        const &  rate_side
    , stride_range< SRC_ITER_TYPE, 1 > const &  src_range
    , stride_range< TRG_ITER_TYPE, 1 > const &  trg_range
+   , stride_range< COEF_ITER_TYPE, 1 > const *
+                                               p_coef_range // zero means the same conductivity everywhere
+   , tile_activity_type *             const    p_tiles      // zero means solve every cell
+   , stride_range< TRG_ITER_TYPE, 1 > const *
+                                               p_velocity_range // zero means trg holds the older generation
+   , RATE_TYPE                        const &  clamp_limit  // zero means no clamp
+   , sheet_stats_type *               const    p_row_stats  // zero, or one per item in src_range
   )
 {
     // Solve and put the results in trg.
@@ -908,13 +2234,21 @@ calc_next_2d_forward_diff_serial
          <  RATE_TYPE
           , SRC_ITER_TYPE
           , TRG_ITER_TYPE
+          , COEF_ITER_TYPE
          >
          (  is_early_exit
+          , stencil
+          , boundary
           , damping
           , rate
           , rate_side
           , src_range.get_iter_lo( )
           , src_range.get_iter_hi( )
+          , p_coef_range
+          , p_tiles
+          , p_velocity_range
+          , clamp_limit
+          , p_row_stats
          )
       , src_range
       , trg_range
@@ -925,15 +2259,25 @@ calc_next_2d_forward_diff_serial
    <  typename RATE_TYPE
     , typename SRC_ITER_TYPE
     , typename TRG_ITER_TYPE
+    , typename COEF_ITER_TYPE
    >
   void
 calc_next_2d_forward_diff_parallel
   (  bool                             const &  is_early_exit
+   , finite_difference::stencil_type  const    stencil
+   , finite_difference::boundary_type const    boundary
    , RATE_TYPE                        const &  damping
    , RATE_TYPE                        const &  rate
    , RATE_TYPE                        const &  rate_side
    , stride_range< SRC_ITER_TYPE, 1 > const &  src_range
    , stride_range< TRG_ITER_TYPE, 1 > const &  trg_range
+   , stride_range< COEF_ITER_TYPE, 1 > const *
+                                               p_coef_range // zero means the same conductivity everywhere
+   , tile_activity_type *             const    p_tiles      // zero means solve every cell
+   , stride_range< TRG_ITER_TYPE, 1 > const *
+                                               p_velocity_range // zero means trg holds the older generation
+   , RATE_TYPE                        const &  clamp_limit  // zero means no clamp
+   , sheet_stats_type *               const    p_row_stats  // zero, or one per item in src_range
   )
 {
     // Solve and put the results in trg.
@@ -942,19 +2286,338 @@ calc_next_2d_forward_diff_parallel
          <  RATE_TYPE
           , SRC_ITER_TYPE
           , TRG_ITER_TYPE
+          , COEF_ITER_TYPE
          >
          (  is_early_exit
+          , stencil
+          , boundary
           , damping
           , rate
           , rate_side
           , src_range.get_iter_lo( )
           , src_range.get_iter_hi( )
+          , p_coef_range
+          , p_tiles
+          , p_velocity_range
+          , clamp_limit
+          , p_row_stats
          )
       , src_range
       , trg_range
      );
 }
 
+// _______________________________________________________________________________________________
+// Forward diff 2d, several generations at a time (temporal blocking)
+//
+//   When we want several generations, calc_next_2d_forward_diff_serial(..) streams the whole
+//   sheet thru memory once per generation. Once the sheet is bigger than the cache that means
+//   one trip to DRAM per generation.
+//
+//   Instead we cut the sheet into bands of rows and take each band all the way to the last
+//   generation before moving on to the next band. To calculate rows [lo, hi) at generation G we
+//   need rows [lo-1, hi+1) at generation G-1, and so on back to the src sheet. So each band
+//   starts out (G-1) rows wider on each side and shrinks by one row each generation, like a
+//   trapezoid. The rows in the slopes are calculated by both neighboring bands, with the same
+//   kernel and the same inputs, so the results are the same, bit for bit, as solving one
+//   generation at a time. Only the real top and bottom rows of the sheet are insulated edges.
+//
+//   This only works for heat (damping is 1). With any other damping each generation also needs
+//   the generation before it, which we don't keep in the scratch buffers.
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE    // std::vector< float >::const_iterator, start of the sheet
+    , typename TRG_ITER_TYPE    // std::vector< float >::iterator, start of the sheet
+   >
+  struct
+solving_functor_forward_diff_2d_blocked_type
+{
+    // -- Typedefs -----------------------------------------------------
+    typedef RATE_TYPE                                                    rate_type ;
+    typedef typename std::iterator_traits< TRG_ITER_TYPE >::value_type  val_type  ;
+    typedef std::vector< val_type >                                      buf_type  ;
+
+  // Constructor
+  public:
+    solving_functor_forward_diff_2d_blocked_type
+     (  bool          const &  is_early
+      , rate_type     const &  rate
+      , rate_type     const &  rate_side
+      , std::size_t   const    x_count
+      , std::size_t   const    y_count
+      , std::size_t   const    generation_count    // 2 or more
+      , std::size_t   const    band_row_count
+      , SRC_ITER_TYPE const &  src_iter
+      , TRG_ITER_TYPE const &  trg_iter            // gets the last generation
+      , TRG_ITER_TYPE const &  trg_iter_history    // gets the next-to-last generation
+      , row_pool::slot_stack_type &
+                               scratch_slots       // one for each thread
+      , std::vector< buf_type > &
+                               bufs                // two for each slot, can start empty
+     )
+      : is_early_exit_    ( is_early         )
+      , rate_             ( rate             )
+      , rate_side_        ( rate_side        )
+      , x_count_          ( x_count          )
+      , y_count_          ( y_count          )
+      , generation_count_ ( generation_count )
+      , band_row_count_   ( band_row_count   )
+      , src_iter_         ( src_iter         )
+      , trg_iter_         ( trg_iter         )
+      , trg_iter_history_ ( trg_iter_history )
+      , scratch_slots_    ( scratch_slots    )
+      , bufs_             ( bufs             )
+      { d_assert( generation_count_ >= 2);
+        d_assert( band_row_count_ > 0);
+        d_assert( bufs_.size( ) == (2 * scratch_slots_.get_slot_count( )));
+      }
+      bool          const &  is_early_exit_    ; /* this is a REF to a bool somewhere else */
+      rate_type     const    rate_             ;
+      rate_type     const    rate_side_        ;
+      std::size_t   const    x_count_          ;
+      std::size_t   const    y_count_          ;
+      std::size_t   const    generation_count_ ;
+      std::size_t   const    band_row_count_   ;
+      SRC_ITER_TYPE const    src_iter_         ;
+      TRG_ITER_TYPE const    trg_iter_         ;
+      TRG_ITER_TYPE const    trg_iter_history_ ;
+      row_pool::slot_stack_type &
+                             scratch_slots_    ;
+      std::vector< buf_type > &
+                             bufs_             ;
+
+  // Functor, solves bands [band_lo, band_post), one after another.
+  // This is the operator() called by row_pool::map_row_ranges(..), serial and parallel.
+  //
+  // The scratch buffers belong to a slot, and are allocated the first time the slot is used and
+  // reused for every band after that. They are big enough that the allocator gets fresh pages
+  // from the OS each time, so allocating them for each band costs more than blocking saves.
+  public:
+      void
+    operator ()( std::pair< std::size_t, std::size_t > const & band_lo_post) const
+      {
+        row_pool::scoped_slot_type const  slot( scratch_slots_);
+        buf_type & buf_a = bufs_[ (2 * slot.get( ))     ];
+        buf_type & buf_b = bufs_[ (2 * slot.get( )) + 1 ];
+        if ( buf_a.empty( ) ) {
+            std::size_t const buf_count = (band_row_count_ + (2 * (generation_count_ - 1))) * x_count_;
+            buf_a.resize( buf_count);
+            buf_b.resize( buf_count);
+        }
+
+        for ( std::size_t band = band_lo_post.first
+            ; (band < band_lo_post.second) && ! is_early_exit_
+            ; band += 1 )
+        {
+            solve_band( band * band_row_count_, buf_a, buf_b);
+        }
+      }
+
+  protected:
+      void
+    solve_band( std::size_t y_lo, buf_type & buf_a, buf_type & buf_b) const
+      //
+      // Solves the band of rows that start at y_lo.
+      {
+        std::size_t const  y_hi_plus  = std::min( y_lo + band_row_count_, y_count_);
+        std::size_t const  slope      = generation_count_ - 1;
+
+        // The scratch buffers hold the rows solved in the first generation, which is the widest.
+        std::size_t const  buf_y_lo       = get_row_lo( y_lo, slope);
+        std::size_t const  buf_y_hi_plus  = get_row_hi_plus( y_hi_plus, slope);
+        d_assert( ((buf_y_hi_plus - buf_y_lo) * x_count_) <= buf_a.size( ));
+        d_assert( buf_a.size( ) == buf_b.size( ));
+
+        // The first generation reads the src sheet.
+        solve_rows
+         (  src_iter_, 0
+          , buf_a.begin( ), buf_y_lo
+          , buf_y_lo, buf_y_hi_plus
+         );
+
+        // The middle generations go back and forth between the two buffers.
+        for ( std::size_t generation = 2 ; generation < generation_count_ ; ++ generation ) {
+            if ( is_early_exit_ ) return;
+            bool       const    is_b_to_a  = util::is_odd( generation);
+            buf_type   const &  buf_src    = is_b_to_a ? buf_b : buf_a;
+            buf_type         &  buf_trg    = is_b_to_a ? buf_a : buf_b;
+            std::size_t const   shrink     = generation_count_ - generation;
+            solve_rows
+             (  buf_src.begin( ), buf_y_lo
+              , buf_trg.begin( ), buf_y_lo
+              , get_row_lo( y_lo, shrink), get_row_hi_plus( y_hi_plus, shrink)
+             );
+        }
+        if ( is_early_exit_ ) return;
+
+        // The last generation writes the trg sheet. The next-to-last generation is kept as history.
+        buf_type const & buf_last = util::is_odd( generation_count_) ? buf_b : buf_a;
+        solve_rows
+         (  static_cast< buf_type const & >( buf_last).begin( ), buf_y_lo
+          , trg_iter_, 0
+          , y_lo, y_hi_plus
+         );
+        std::copy
+         (  buf_last.begin( ) + ((y_lo      - buf_y_lo) * x_count_)
+          , buf_last.begin( ) + ((y_hi_plus - buf_y_lo) * x_count_)
+          , trg_iter_history_ + (y_lo * x_count_)
+         );
+      }
+
+      std::size_t
+    get_row_lo( std::size_t y_lo, std::size_t shrink) const
+      { return (y_lo > shrink) ? (y_lo - shrink) : 0; }
+
+      std::size_t
+    get_row_hi_plus( std::size_t y_hi_plus, std::size_t shrink) const
+      { return std::min( y_hi_plus + shrink, y_count_); }
+
+      template< typename ROW_SRC_ITER_TYPE, typename ROW_TRG_ITER_TYPE >
+      void
+    solve_rows
+     (  ROW_SRC_ITER_TYPE const &  src_iter      // row src_y_lo
+      , std::size_t       const    src_y_lo
+      , ROW_TRG_ITER_TYPE const &  trg_iter      // row trg_y_lo
+      , std::size_t       const    trg_y_lo
+      , std::size_t       const    y_lo          // solve rows [y_lo, y_hi_plus)
+      , std::size_t       const    y_hi_plus
+     ) const
+      //
+      // Same as solving_functor_forward_diff_2d_type::operator()(..) for each row.
+      {
+        rate_type         const  full_damping  = 1;
+        rate_type         const  no_clamp      = 0;
+        std::ptrdiff_t    const  stride        = static_cast< std::ptrdiff_t >( x_count_);
+        std::size_t       const  y_last        = y_count_ - 1;
+        for ( std::size_t y = y_lo ; y < y_hi_plus ; ++ y ) {
+            ROW_SRC_ITER_TYPE const src_row       = src_iter + static_cast< std::ptrdiff_t >( (y - src_y_lo) * x_count_);
+            ROW_SRC_ITER_TYPE const src_row_limit = src_row + stride;
+            ROW_TRG_ITER_TYPE const trg_row       = trg_iter + static_cast< std::ptrdiff_t >( (y - trg_y_lo) * x_count_);
+
+            if ( (y != 0) && (y != y_last) ) {
+                finite_difference::
+                calc_next_generation_forward_difference_2d_middle
+                 (  full_damping, rate_, rate_side_
+                  , src_row, src_row_limit
+                  , src_row - stride
+                  , src_row + stride
+                  , trg_row
+                  , no_clamp
+                 );
+            } else
+            if ( y != 0 ) {
+                finite_difference::
+                calc_next_generation_forward_difference_2d_edge
+                 (  full_damping, rate_, rate_side_
+                  , src_row, src_row_limit
+                  , src_row - stride
+                  , trg_row
+                  , no_clamp
+                 );
+            } else
+            if ( y != y_last ) {
+                finite_difference::
+                calc_next_generation_forward_difference_2d_edge
+                 (  full_damping, rate_, rate_side_
+                  , src_row, src_row_limit
+                  , src_row + stride
+                  , trg_row
+                  , no_clamp
+                 );
+            } else
+            /* both lo and hi edge (only one row) */ {
+                finite_difference::
+                calc_next_generation_forward_difference_2d_thin_strip
+                 (  full_damping, rate_
+                  , src_row, src_row_limit
+                  , trg_row
+                  , no_clamp
+                 );
+            }
+        }
+      }
+};
+
+  inline
+  std::size_t
+get_forward_diff_2d_blocked_band_row_count
+ (  std::size_t  x_count
+  , std::size_t  y_count
+  , std::size_t  generation_count
+  , std::size_t  cache_byte_count  // how much we want each band's scratch buffers to use
+  , std::size_t  value_byte_count  = sizeof( float)
+ )
+  //
+  // Returns zero if temporal blocking is not worth it.
+{
+    if ( generation_count < 2 ) return 0;
+
+    // No point if the whole sheet already stays in the cache between generations.
+    std::size_t const row_byte_count = x_count * value_byte_count;
+    if ( (row_byte_count * y_count * 2) <= cache_byte_count ) return 0;
+
+    // Each band has two scratch buffers, each (2 * slope) rows taller than the band.
+    // If the band is shorter than the slopes we calculate too many rows twice.
+    std::size_t const slope           = generation_count - 1;
+    std::size_t const buf_row_count   = cache_byte_count / (row_byte_count * 2);
+    if ( buf_row_count <= (3 * slope) ) return 0;
+    std::size_t const band_row_count  = buf_row_count - (2 * slope);
+    return (band_row_count < y_count) ? band_row_count : 0;
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE
+    , typename TRG_ITER_TYPE
+   >
+  void
+calc_next_2d_forward_diff_blocked
+  (  bool           const &  is_early_exit
+   , bool           const    is_parallel
+   , RATE_TYPE      const &  rate
+   , RATE_TYPE      const &  rate_side
+   , std::size_t    const    x_count
+   , std::size_t    const    y_count
+   , std::size_t    const    generation_count
+   , std::size_t    const    band_row_count  // from get_forward_diff_2d_blocked_band_row_count(..)
+   , SRC_ITER_TYPE  const &  src_iter        // src sheet, not changed
+   , TRG_ITER_TYPE  const &  trg_iter        // last generation, must not be the src sheet
+   , TRG_ITER_TYPE  const &  trg_iter_history// next-to-last generation, must not be src or trg
+  )
+{
+    d_assert( band_row_count > 0);
+
+    typedef solving_functor_forward_diff_2d_blocked_type
+             <  RATE_TYPE
+              , SRC_ITER_TYPE
+              , TRG_ITER_TYPE
+             >  functor_type;
+    typedef typename functor_type::val_type  val_type;
+    typedef typename functor_type::buf_type  buf_type;
+
+    // The bands are mapped like rows, so a thread takes a few at a time. Each thread has its
+    // own pair of scratch buffers.
+    std::size_t const  band_count      = (y_count + band_row_count - 1) / band_row_count;
+    std::size_t const  band_byte_count = band_row_count * x_count * sizeof( val_type);
+    row_pool::slot_stack_type  scratch_slots( is_parallel ? row_pool::get_thread_count( ) : 1);
+    std::vector< buf_type >    bufs( 2 * scratch_slots.get_slot_count( ));
+
+    functor_type const
+        solving_functor
+         (  is_early_exit
+          , rate, rate_side
+          , x_count, y_count
+          , generation_count, band_row_count
+          , src_iter, trg_iter, trg_iter_history
+          , scratch_slots, bufs
+         );
+
+    // The bands only read the src sheet, and each writes its own rows in trg, so they can be
+    // solved in parallel.
+    row_pool::map_row_ranges( solving_functor, band_count, band_byte_count, is_parallel);
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 // Unified functor
@@ -1058,19 +2721,43 @@ calc_next_1d_serial_functor_super_type
     INHERIT_FUNCTOR_TYPENAMES( super_type);
     INHERIT_BUFFER_TYPENAMES( super2_type);
 
+    typedef implicit_matrix_cache_type< rate_type >   matrix_cache_type ;
+    typedef typename matrix_cache_type::matrix_type   matrix_type       ;
+
   // Constructor, members
   public:
     calc_next_1d_serial_functor_super_type
      (  bool          const & is_early
       , buf_iter_type const & buf_iter_a
       , buf_iter_type const & buf_iter_b
+      , matrix_cache_type   & matrix_cache
      )
       : calc_next_1d_functor_super_type< rate_type, src_iter_type, trg_iter_type >( is_early)
       , buf_iter_a_( buf_iter_a)
       , buf_iter_b_( buf_iter_b)
+      , matrix_cache_( matrix_cache)
       { }
       buf_iter_type const & buf_iter_a_ ;
       buf_iter_type const & buf_iter_b_ ;
+      matrix_cache_type   & matrix_cache_ ;
+
+  // Factored matrix
+  public:
+      matrix_type const *
+    get_factored_matrix
+     (  rate_type        const &  base
+      , rate_type        const &  rate
+      , src_range_1_type const &  src_range
+     ) const
+      //
+      // Returns zero if the rows can't be solved with a factored matrix. Negative rates are solved
+      // with the careful (unfactored) solver, and single-cell rows aren't worth it.
+      //
+      // Factors the matrix if it's not in the cache, so call this before mapping the rows.
+      { size_type const count = src_range.get_next_range( ).get_count( );
+        if ( (rate < 0) || (count < 2) ) return 0;
+        return & matrix_cache_.get_matrix( base, rate, count);
+      }
 
   // Buffer size method
   public:
@@ -1110,15 +2797,19 @@ calc_next_1d_parallel_functor_super_type
     INHERIT_FUNCTOR_TYPENAMES( super_type);
     INHERIT_BUFFER_TYPENAMES( super_type);
 
+    typedef typename super_type::matrix_cache_type    matrix_cache_type ;
+    typedef typename super_type::matrix_type          matrix_type       ;
+
   // Constructor
   public:
     calc_next_1d_parallel_functor_super_type
      (  bool          const & is_early
       , buf_iter_type const & buf_iter_a
       , buf_iter_type const & buf_iter_b
+      , matrix_cache_type   & matrix_cache
      )
       : calc_next_1d_serial_functor_super_type< rate_type, src_iter_type, trg_iter_type, buf_iter_type >
-         ( is_early, buf_iter_a, buf_iter_b)
+         ( is_early, buf_iter_a, buf_iter_b, matrix_cache)
       { }
 
   // Buffer size method
@@ -1126,7 +2817,33 @@ calc_next_1d_parallel_functor_super_type
       virtual /* overridden virtual */
       size_type
     get_min_buf_count( size_type x_size, size_type y_size) const
-      { return x_size * y_size; }
+      //
+      // A row split into partitions needs twice its length in each buffer. That's more than
+      // (x_size * y_size) if there is only one row.
+      { return std::max( x_size * y_size, 2 * std::max( x_size, y_size)); }
+
+  // Partitioned rows
+  public:
+      static
+      size_type
+    get_partition_count
+     (  rate_type        const &  rate
+      , src_range_1_type const &  src_range
+     )
+      //
+      // How many pieces to split each row into, or 1 to solve each row on one thread.
+      //
+      // We only split rows when there are fewer rows than threads, and then only if each piece
+      // is long enough to be worth the extra arithmetic and the two hand-offs. The partitioned
+      // solve does about twice the work, so it doesn't pay with fewer than 3 threads.
+      // Negative rates are left to the careful solver.
+      { size_type const  min_partition_length  = 4096;
+        size_type const  thread_count          = row_pool::get_thread_count( );
+        size_type const  row_count             = src_range.get_count( );
+        size_type const  row_length            = src_range.get_next_range( ).get_count( );
+        if ( (rate < 0) || (thread_count < 3) || (row_count >= thread_count) ) return 1;
+        return std::max< size_type >( 1, std::min( thread_count, row_length / min_partition_length));
+      }
 
   // Buffer setup
   public:
@@ -1259,15 +2976,19 @@ calc_next_1d_backward_diff_serial_functor_type
     INHERIT_FUNCTOR_TYPENAMES( super_type);
     INHERIT_BUFFER_TYPENAMES(  super_type);
 
+    typedef typename super_type::matrix_cache_type    matrix_cache_type ;
+    typedef typename super_type::matrix_type          matrix_type       ;
+
   // Constructor
   public:
     calc_next_1d_backward_diff_serial_functor_type
      (  bool          const & is_early
       , buf_iter_type const & buf_iter_a
       , buf_iter_type const & buf_iter_b
+      , matrix_cache_type   & matrix_cache
      )
       : calc_next_1d_serial_functor_super_type< rate_type, src_iter_type, trg_iter_type, buf_iter_type >
-         ( is_early, buf_iter_a, buf_iter_b)
+         ( is_early, buf_iter_a, buf_iter_b, matrix_cache)
       { }
 
   // Functor operator, overridden virtual
@@ -1280,15 +3001,28 @@ calc_next_1d_backward_diff_serial_functor_type
       , src_range_1_type const &  src_range
       , trg_range_1_type const &  trg_range
      ) const
-      { calc_next_1d_backward_diff_serial
-         (  super_type::is_early_exit_
-          , damping
-          , rate
-          , src_range
-          , trg_range
-          , super_type::buf_iter_a_
-          , super_type::buf_iter_b_
-         );
+      { matrix_type const * const p_matrix =
+            super_type::get_factored_matrix( 1, rate, src_range);
+        if ( p_matrix ) {
+            calc_next_1d_implicit_factored_serial
+             (  super_type::is_early_exit_
+              , *p_matrix
+              , damping
+              , src_range
+              , trg_range
+              , super_type::buf_iter_a_
+             );
+        } else {
+            calc_next_1d_backward_diff_serial
+             (  super_type::is_early_exit_
+              , damping
+              , rate
+              , src_range
+              , trg_range
+              , super_type::buf_iter_a_
+              , super_type::buf_iter_b_
+             );
+        }
       }
 };
 
@@ -1319,15 +3053,19 @@ calc_next_1d_backward_diff_parallel_functor_type
     INHERIT_FUNCTOR_TYPENAMES( super_type);
     INHERIT_BUFFER_TYPENAMES(  super_type);
 
+    typedef typename super_type::matrix_cache_type    matrix_cache_type ;
+    typedef typename super_type::matrix_type          matrix_type       ;
+
   // Constructor
   public:
     calc_next_1d_backward_diff_parallel_functor_type
      (  bool          const & is_early
       , buf_iter_type const & buf_iter_a
       , buf_iter_type const & buf_iter_b
+      , matrix_cache_type   & matrix_cache
      )
       : calc_next_1d_parallel_functor_super_type< rate_type, src_iter_type, trg_iter_type, buf_iter_type >
-         ( is_early, buf_iter_a, buf_iter_b)
+         ( is_early, buf_iter_a, buf_iter_b, matrix_cache)
       { }
 
   // Functor operator, overridden virtual
@@ -1340,15 +3078,44 @@ calc_next_1d_backward_diff_parallel_functor_type
       , src_range_1_type const &  src_range
       , trg_range_1_type const &  trg_range
      ) const
-      { calc_next_1d_backward_diff_parallel
-         (  super_type::is_early_exit_
-          , damping
-          , rate
-          , src_range
-          , trg_range
-          , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_a_)
-          , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_b_)
-         );
+      { size_type const partition_count = super_type::get_partition_count( rate, src_range);
+        if ( partition_count > 1 ) {
+            calc_next_1d_implicit_partitioned
+             (  super_type::is_early_exit_
+              , static_cast< rate_type >( 1)
+              , damping
+              , rate
+              , src_range
+              , trg_range
+              , super_type::buf_iter_a_
+              , super_type::buf_iter_b_
+              , partition_count
+             );
+            return;
+        }
+
+        matrix_type const * const p_matrix =
+            super_type::get_factored_matrix( 1, rate, src_range);
+        if ( p_matrix ) {
+            calc_next_1d_implicit_factored_parallel
+             (  super_type::is_early_exit_
+              , *p_matrix
+              , damping
+              , src_range
+              , trg_range
+              , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_a_)
+             );
+        } else {
+            calc_next_1d_backward_diff_parallel
+             (  super_type::is_early_exit_
+              , damping
+              , rate
+              , src_range
+              , trg_range
+              , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_a_)
+              , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_b_)
+             );
+        }
       }
 };
 
@@ -1382,15 +3149,19 @@ calc_next_1d_central_diff_serial_functor_type
     INHERIT_FUNCTOR_TYPENAMES( super_type);
     INHERIT_BUFFER_TYPENAMES(  super_type);
 
+    typedef typename super_type::matrix_cache_type    matrix_cache_type ;
+    typedef typename super_type::matrix_type          matrix_type       ;
+
   // Constructor
   public:
     calc_next_1d_central_diff_serial_functor_type
      (  bool          const & is_early
       , buf_iter_type const & buf_iter_a
       , buf_iter_type const & buf_iter_b
+      , matrix_cache_type   & matrix_cache
      )
       : calc_next_1d_serial_functor_super_type< rate_type, src_iter_type, trg_iter_type, buf_iter_type >
-         ( is_early, buf_iter_a, buf_iter_b)
+         ( is_early, buf_iter_a, buf_iter_b, matrix_cache)
       { }
 
   // Functor operator, overridden virtual
@@ -1403,15 +3174,28 @@ calc_next_1d_central_diff_serial_functor_type
       , src_range_1_type const &  src_range
       , trg_range_1_type const &  trg_range
      ) const
-      { calc_next_1d_central_diff_serial
-         (  super_type::is_early_exit_
-          , damping
-          , rate
-          , src_range
-          , trg_range
-          , super_type::buf_iter_a_
-          , super_type::buf_iter_b_
-         );
+      { matrix_type const * const p_matrix =
+            super_type::get_factored_matrix( 2, rate, src_range);
+        if ( p_matrix ) {
+            calc_next_1d_implicit_factored_serial
+             (  super_type::is_early_exit_
+              , *p_matrix
+              , damping
+              , src_range
+              , trg_range
+              , super_type::buf_iter_a_
+             );
+        } else {
+            calc_next_1d_central_diff_serial
+             (  super_type::is_early_exit_
+              , damping
+              , rate
+              , src_range
+              , trg_range
+              , super_type::buf_iter_a_
+              , super_type::buf_iter_b_
+             );
+        }
       }
 };
 
@@ -1442,15 +3226,19 @@ calc_next_1d_central_diff_parallel_functor_type
     INHERIT_FUNCTOR_TYPENAMES( super_type);
     INHERIT_BUFFER_TYPENAMES(  super_type);
 
+    typedef typename super_type::matrix_cache_type    matrix_cache_type ;
+    typedef typename super_type::matrix_type          matrix_type       ;
+
   // Constructor
   public:
     calc_next_1d_central_diff_parallel_functor_type
      (  bool          const & is_early
       , buf_iter_type const & buf_iter_a
       , buf_iter_type const & buf_iter_b
+      , matrix_cache_type   & matrix_cache
      )
       : calc_next_1d_parallel_functor_super_type< rate_type, src_iter_type, trg_iter_type, buf_iter_type >
-         ( is_early, buf_iter_a, buf_iter_b)
+         ( is_early, buf_iter_a, buf_iter_b, matrix_cache)
       { }
 
   // Functor operator, overridden virtual
@@ -1463,18 +3251,590 @@ calc_next_1d_central_diff_parallel_functor_type
       , src_range_1_type const &  src_range
       , trg_range_1_type const &  trg_range
      ) const
-      { calc_next_1d_central_diff_parallel
-         (  super_type::is_early_exit_
-          , damping
-          , rate
-          , src_range
-          , trg_range
-          , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_a_)
-          , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_b_)
+      { size_type const partition_count = super_type::get_partition_count( rate, src_range);
+        if ( partition_count > 1 ) {
+            calc_next_1d_implicit_partitioned
+             (  super_type::is_early_exit_
+              , static_cast< rate_type >( 2)
+              , damping
+              , rate
+              , src_range
+              , trg_range
+              , super_type::buf_iter_a_
+              , super_type::buf_iter_b_
+              , partition_count
+             );
+            return;
+        }
+
+        matrix_type const * const p_matrix =
+            super_type::get_factored_matrix( 2, rate, src_range);
+        if ( p_matrix ) {
+            calc_next_1d_implicit_factored_parallel
+             (  super_type::is_early_exit_
+              , *p_matrix
+              , damping
+              , src_range
+              , trg_range
+              , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_a_)
+             );
+        } else {
+            calc_next_1d_central_diff_parallel
+             (  super_type::is_early_exit_
+              , damping
+              , rate
+              , src_range
+              , trg_range
+              , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_a_)
+              , super_type::get_parallel_buf_range( src_range, super_type::buf_iter_b_)
+             );
+        }
+      }
+};
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Column solves thru a transposed strip
+//
+//   Walking a column of the sheet touches one float in every row, so on a wide sheet every
+//   cell is a cache miss and the y pass is several times slower than the x pass.
+//
+//   Instead we copy a strip of adjacent columns into a scratch buffer, transposed so each
+//   column becomes a contiguous row. Copying the strip reads each row of the sheet a cache line
+//   at a time. Then we run the usual 1d functor on the scratch rows, which is also where the
+//   vector kernels can be used, and copy the results back into the trg columns.
+//
+//   The functor sees the same values in the same order, so the results are exactly what
+//   calc_1d_functor( damping, rate, src.get_range_xy( ), trg.get_range_xy( )) gives.
+
+  inline
+  std::size_t
+get_column_strip_count
+ (  std::size_t  x_count
+  , std::size_t  y_count
+  , std::size_t  cache_byte_count  // how much we want the two scratch strips to use
+  , std::size_t  value_byte_count  = sizeof( float)
+ )
+  //
+  // Returns how many columns to solve at a time, or zero if the sheet is small enough that
+  // walking the columns directly stays in the cache.
+{
+    std::size_t const column_byte_count = y_count * value_byte_count;
+    if ( (x_count * column_byte_count) <= cache_byte_count ) return 0;
+
+    // A multiple of 16 columns so each row of the strip is whole 64-byte cache lines.
+    std::size_t const strip_count = (cache_byte_count / (column_byte_count * 2)) & ~ std::size_t( 15);
+    return std::min( std::max( strip_count, std::size_t( 16)), x_count);
+}
+
+  template
+   <  typename SHEET_ITER_TYPE    // std::vector< float >::const_iterator
+    , typename STRIP_ITER_TYPE    // std::vector< float >::iterator
+   >
+  void
+copy_columns_to_strip
+ (  SHEET_ITER_TYPE const &  sheet_iter   // the first column of the strip, in the top row
+  , std::size_t     const    x_count      // sheet row length (stride between rows)
+  , std::size_t     const    y_count
+  , std::size_t     const    column_count // columns in the strip
+  , STRIP_ITER_TYPE const &  strip_iter   // column_count rows of y_count
+ )
+{
+    for ( std::size_t y = 0 ; y < y_count ; ++ y ) {
+        SHEET_ITER_TYPE const sheet_row = sheet_iter + static_cast< std::ptrdiff_t >( y * x_count);
+        for ( std::size_t x = 0 ; x < column_count ; ++ x ) {
+            strip_iter[ (x * y_count) + y ] = sheet_row[ x ];
+        }
+    }
+}
+
+  template
+   <  typename STRIP_ITER_TYPE    // std::vector< float >::const_iterator
+    , typename SHEET_ITER_TYPE    // std::vector< float >::iterator
+   >
+  void
+copy_strip_to_columns
+ (  STRIP_ITER_TYPE const &  strip_iter   // column_count rows of y_count
+  , std::size_t     const    x_count      // sheet row length (stride between rows)
+  , std::size_t     const    y_count
+  , std::size_t     const    column_count // columns in the strip
+  , SHEET_ITER_TYPE const &  sheet_iter   // the first column of the strip, in the top row
+ )
+{
+    for ( std::size_t y = 0 ; y < y_count ; ++ y ) {
+        SHEET_ITER_TYPE const sheet_row = sheet_iter + static_cast< std::ptrdiff_t >( y * x_count);
+        for ( std::size_t x = 0 ; x < column_count ; ++ x ) {
+            sheet_row[ x ] = strip_iter[ (x * y_count) + y ];
+        }
+    }
+}
+
+  template
+   <  typename RATE_TYPE
+    , typename VAL_TYPE
+   >
+  void
+calc_next_1d_columns_by_strip
+ (  calc_next_1d_functor_super_type
+     <  RATE_TYPE
+      , typename std::vector< VAL_TYPE >::const_iterator
+      , typename std::vector< VAL_TYPE >::iterator
+     >                              const &  calc_1d_functor
+  , RATE_TYPE                       const    damping
+  , RATE_TYPE                       const    rate
+  , std::size_t                     const    x_count
+  , std::size_t                     const    y_count
+  , std::size_t                     const    strip_count   // from get_column_strip_count(..)
+  , typename std::vector< VAL_TYPE >::const_iterator
+                                    const &  src_iter      // src sheet, can be the same as trg
+  , typename std::vector< VAL_TYPE >::iterator
+                                    const &  trg_iter      // trg sheet
+  , std::vector< VAL_TYPE >               &  strip_src     // scratch
+  , std::vector< VAL_TYPE >               &  strip_trg     // scratch
+ )
+{
+    typedef typename std::vector< VAL_TYPE >::const_iterator  src_iter_type;
+    typedef typename std::vector< VAL_TYPE >::iterator        trg_iter_type;
+
+    d_assert( strip_count > 0);
+    if ( strip_src.size( ) < (strip_count * y_count) ) { strip_src.resize( strip_count * y_count); }
+    if ( strip_trg.size( ) < (strip_count * y_count) ) { strip_trg.resize( strip_count * y_count); }
+
+    // Unless the solve just sets trg, it also reads the trg values (for example to sum into them).
+    bool const is_trg_read = (finite_difference::get_no_init_damping_set_value< RATE_TYPE >( ) != damping);
+
+    for ( std::size_t x_lo = 0 ; x_lo < x_count ; x_lo += strip_count ) {
+        if ( calc_1d_functor.is_early_exit( ) ) return;
+        std::size_t    const  column_count  = std::min( strip_count, x_count - x_lo);
+        std::ptrdiff_t const  x_offset      = static_cast< std::ptrdiff_t >( x_lo);
+
+        copy_columns_to_strip( src_iter + x_offset, x_count, y_count, column_count, strip_src.begin( ));
+        if ( is_trg_read ) {
+            copy_columns_to_strip( trg_iter + x_offset, x_count, y_count, column_count, strip_trg.begin( ));
+        }
+
+        // column_count rows of y_count cells.
+        std::ptrdiff_t const  row_stride    = static_cast< std::ptrdiff_t >( y_count);
+        std::ptrdiff_t const  cell_stride   = 1;
+        stride_range< src_iter_type, 1 > const
+            src_range
+             (  column_count, row_stride
+              , y_count, cell_stride
+              , static_cast< std::vector< VAL_TYPE > const & >( strip_src).begin( )
+             );
+        stride_range< trg_iter_type, 1 > const
+            trg_range
+             (  column_count, row_stride
+              , y_count, cell_stride
+              , strip_trg.begin( )
+             );
+        calc_1d_functor( damping, rate, src_range, trg_range);
+
+        copy_strip_to_columns
+         (  static_cast< std::vector< VAL_TYPE > const & >( strip_trg).begin( )
+          , x_count, y_count, column_count
+          , trg_iter + x_offset
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Backward and central diff on columns, in vector lanes
+//
+//   The column kernels (see finite_diff_simd.h) solve a strip of adjacent columns together,
+//   one column in each vector lane, reading and writing the sheets directly. Here we cut the
+//   sheet into strips narrow enough that a strip's scratch space stays in the cache, and map
+//   the strips like rows. Each thread has its own scratch space.
+
+  struct
+solving_functor_implicit_columns_type
+{
+    typedef finite_difference::simd::kernels_type::implicit_diff_columns_type  kernel_type;
+    typedef finite_difference::simd::kernels_type::implicit_diff_columns_varying_type
+                                                                               varying_kernel_type;
+
+  // Constructor
+  public:
+    solving_functor_implicit_columns_type
+     (  bool          const &  is_early
+      , kernel_type   const    p_kernel             // zero if p_varying_kernel is not
+      , varying_kernel_type
+                      const    p_varying_kernel     // zero if p_kernel is not
+      , float         const    damping
+      , float         const    rate
+      , float const *  const   p_src
+      , float const *  const   p_coef               // coefficient sheet, only with p_varying_kernel
+      , float *        const   p_trg
+      , std::size_t   const    x_count
+      , std::size_t   const    y_count
+      , std::size_t   const    strip_count          // columns in each strip
+      , row_pool::slot_stack_type &
+                               scratch_slots        // one for each thread
+      , float *        const   p_scratch            // scratch space for every slot
+     )
+      : is_early_exit_      ( is_early           )
+      , p_kernel_           ( p_kernel           )
+      , p_varying_kernel_   ( p_varying_kernel   )
+      , damping_            ( damping            )
+      , rate_               ( rate               )
+      , p_src_              ( p_src              )
+      , p_coef_             ( p_coef             )
+      , p_trg_              ( p_trg              )
+      , x_count_            ( x_count            )
+      , y_count_            ( y_count            )
+      , strip_count_        ( strip_count        )
+      , scratch_slots_      ( scratch_slots      )
+      , p_scratch_          ( p_scratch          )
+      { d_assert( (0 != p_kernel_) != (0 != p_varying_kernel_));
+        d_assert( implies( p_varying_kernel_, p_coef_));
+        d_assert( strip_count_ > 0);
+      }
+      bool          const &  is_early_exit_      ; /* this is a REF to a bool somewhere else */
+      kernel_type   const    p_kernel_           ;
+      varying_kernel_type
+                    const    p_varying_kernel_   ;
+      float         const    damping_            ;
+      float         const    rate_               ;
+      float const *  const   p_src_              ;
+      float const *  const   p_coef_             ;
+      float *        const   p_trg_              ;
+      std::size_t   const    x_count_            ;
+      std::size_t   const    y_count_            ;
+      std::size_t   const    strip_count_        ;
+      row_pool::slot_stack_type &
+                             scratch_slots_      ;
+      float *        const   p_scratch_          ;
+
+  // Functor, solves strips [strip_lo, strip_post), one after another.
+  // This is the operator() called by row_pool::map_row_ranges(..), serial and parallel.
+  public:
+      void
+    operator ()( std::pair< std::size_t, std::size_t > const & strip_lo_post) const
+      {
+        row_pool::scoped_slot_type const  slot( scratch_slots_);
+        std::size_t const  slot_scratch_count  = get_scratch_count( p_varying_kernel_, strip_count_, y_count_);
+        float *     const  p_slot_scratch      = p_scratch_ + (slot.get( ) * slot_scratch_count);
+
+        for ( std::size_t x_lo = strip_lo_post.first * strip_count_
+            ; (x_lo < std::min( strip_lo_post.second * strip_count_, x_count_)) && ! is_early_exit_
+            ; x_lo += strip_count_ )
+        {
+            std::size_t const column_count = std::min( strip_count_, x_count_ - x_lo);
+            if ( p_varying_kernel_ ) {
+                p_varying_kernel_
+                 (  damping_, rate_
+                  , p_src_ + x_lo, p_coef_ + x_lo, p_trg_ + x_lo, static_cast< std::ptrdiff_t >( x_count_)
+                  , column_count, y_count_
+                  , p_slot_scratch
+                 );
+            } else {
+                p_kernel_
+                 (  damping_, rate_
+                  , p_src_ + x_lo, p_trg_ + x_lo, static_cast< std::ptrdiff_t >( x_count_)
+                  , column_count, y_count_
+                  , p_slot_scratch
+                 );
+            }
+        }
+      }
+
+  // Scratch space for one strip.
+  public:
+      static
+      std::size_t
+    get_scratch_count( bool is_varying, std::size_t strip_count, std::size_t y_count)
+      {
+        return is_varying ?
+            finite_difference::simd::get_implicit_difference_columns_varying_scratch_count( strip_count, y_count) :
+            finite_difference::simd::get_implicit_difference_columns_scratch_count( strip_count, y_count);
+      }
+};
+
+  template
+   <  typename RATE_TYPE
+    , typename SRC_ITER_TYPE    // std::vector< float >::const_iterator, start of the sheet
+    , typename TRG_ITER_TYPE    // std::vector< float >::iterator, start of the sheet
+    , typename VAL_TYPE
+   >
+  bool
+try_calc_next_1d_columns_in_lanes
+ (  bool                      const &  is_early_exit
+  , bool                      const    is_parallel
+  , RATE_TYPE                 const    base          // 1 for backward diff, 2 for central diff
+  , RATE_TYPE                 const    damping
+  , RATE_TYPE                 const    rate
+  , std::size_t               const    x_count
+  , std::size_t               const    y_count
+  , std::size_t               const    strip_count   // from get_column_strip_count(..), can be zero
+  , SRC_ITER_TYPE             const &  src_iter      // src sheet, can be the same as trg
+  , float const *             const    p_coef        // coefficient sheet, zero if not varying
+  , TRG_ITER_TYPE             const &  trg_iter      // trg sheet
+  , std::vector< VAL_TYPE >         &  scratch
+ )
+  //
+  // Same as calc_1d_functor( damping, rate, src.get_range_xy( ), trg.get_range_xy( )) with the
+  // backward-diff or central-diff functor. With a coefficient sheet it is the same as
+  // calc_next_1d_implicit_varying(..) on the columns.
+  //
+  // Returns false, without doing anything, if there are no column kernels for this solve.
+{
+    finite_difference::simd::kernels_type::implicit_diff_columns_type const p_kernel =
+        p_coef ? 0 :
+        finite_difference::simd::get_implicit_difference_columns_kernel
+         ( base, rate, src_iter, trg_iter, x_count, y_count);
+    finite_difference::simd::kernels_type::implicit_diff_columns_varying_type const p_varying_kernel =
+        (! p_coef) ? 0 :
+        finite_difference::simd::get_implicit_difference_columns_varying_kernel
+         ( base, rate, src_iter, p_coef, trg_iter, x_count, y_count);
+    if ( (! p_kernel) && (! p_varying_kernel) ) return false;
+    if ( ! boost::is_same< VAL_TYPE, float >::value ) return false;
+
+    // A small sheet is solved as one strip, unless we split it for the threads. Strip edges are
+    // on multiples of 16 columns so the vectors in each row are whole cache lines.
+    std::size_t const  column_count  = (strip_count != 0) ? strip_count :
+        (is_parallel && (row_pool::get_thread_count( ) > 1)) ? std::min< std::size_t >( 16, x_count) : x_count;
+    std::size_t const  strip_total   = (x_count + column_count - 1) / column_count;
+
+    row_pool::slot_stack_type  scratch_slots( is_parallel ? row_pool::get_thread_count( ) : 1);
+    std::size_t const  scratch_count  = scratch_slots.get_slot_count( ) *
+        solving_functor_implicit_columns_type::get_scratch_count( 0 != p_coef, column_count, y_count);
+    if ( scratch.size( ) < scratch_count ) { scratch.resize( scratch_count); }
+
+    solving_functor_implicit_columns_type const
+        solving_functor
+         (  is_early_exit
+          , p_kernel, p_varying_kernel
+          , static_cast< float >( damping), static_cast< float >( rate)
+          , finite_difference::simd::get_contiguous_float_ptr( src_iter)
+          , p_coef
+          , finite_difference::simd::get_contiguous_float_ptr( trg_iter)
+          , x_count, y_count
+          , column_count
+          , scratch_slots
+          , finite_difference::simd::get_contiguous_float_ptr( scratch.begin( ))
          );
+
+    // Each strip reads and writes only its own columns, so the strips can be solved in parallel.
+    row_pool::map_row_ranges
+     ( solving_functor, strip_total, column_count * y_count * sizeof( float), is_parallel);
+    return true;
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Forward diff on a fixed-point sheet
+//
+//   Simultaneous 2D forward-diff heat on sheets of uniform_scalar< INT_TYPE > inner values (see
+//   calc_next_generation_forward_difference_2d_fixed(..) in finite_diff.h). Each row reads three
+//   src rows and writes one trg row, so the rows can be solved in parallel.
+
+  template< typename INT_TYPE >
+  struct
+solving_functor_forward_diff_2d_fixed_type
+{
+  // Constructor
+  public:
+    solving_functor_forward_diff_2d_fixed_type
+     (  bool            const &  is_early
+      , INT_TYPE        const    rate
+      , INT_TYPE        const    rate_side
+      , std::size_t     const    x_count
+      , std::size_t     const    y_count
+      , INT_TYPE const * const   p_src
+      , INT_TYPE *       const   p_trg
+     )
+      : is_early_exit_  ( is_early  )
+      , rate_           ( rate      )
+      , rate_side_      ( rate_side )
+      , x_count_        ( x_count   )
+      , y_count_        ( y_count   )
+      , p_src_          ( p_src     )
+      , p_trg_          ( p_trg     )
+      { }
+      bool            const &  is_early_exit_ ; /* this is a REF to a bool somewhere else */
+      INT_TYPE        const    rate_          ;
+      INT_TYPE        const    rate_side_     ;
+      std::size_t     const    x_count_       ;
+      std::size_t     const    y_count_       ;
+      INT_TYPE const * const   p_src_         ;
+      INT_TYPE *       const   p_trg_         ;
+
+  // Functor, solves rows [y_lo, y_hi_plus).
+  public:
+      void
+    operator ()( std::pair< std::size_t, std::size_t > const & y_lo_hi_plus) const
+      {
+        for ( std::size_t y = y_lo_hi_plus.first
+            ; (y < y_lo_hi_plus.second) && ! is_early_exit_
+            ; y += 1 )
+        {
+            // The top and bottom rows use themselves as the missing side.
+            INT_TYPE const * const  p_row     = p_src_ + (y * x_count_);
+            INT_TYPE const * const  p_side_a  = (y == 0)              ? p_row : (p_row - x_count_);
+            INT_TYPE const * const  p_side_b  = ((y + 1) == y_count_) ? p_row : (p_row + x_count_);
+            finite_difference::
+              calc_next_generation_forward_difference_2d_fixed
+               ( rate_, rate_side_, p_row, x_count_, p_side_a, p_side_b, p_trg_ + (y * x_count_));
+        }
+      }
+};
+
+  template< typename INT_TYPE >
+  void
+calc_next_2d_forward_diff_fixed
+ (  bool             const &  is_early_exit
+  , bool             const    is_parallel
+  , INT_TYPE         const    rate        // x rate, as a uniform_scalar< INT_TYPE > inner value
+  , INT_TYPE         const    rate_side   // y rate
+  , std::size_t      const    x_count
+  , std::size_t      const    y_count
+  , INT_TYPE const *  const   p_src       // start of the src sheet
+  , INT_TYPE *        const   p_trg       // start of the trg sheet, cannot overlap src
+ )
+{
+    if ( (x_count == 0) || (y_count == 0) ) return;
+
+    solving_functor_forward_diff_2d_fixed_type< INT_TYPE > const
+        solving_functor( is_early_exit, rate, rate_side, x_count, y_count, p_src, p_trg);
+
+    row_pool::map_row_ranges( solving_functor, y_count, x_count * sizeof( INT_TYPE), is_parallel);
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Forward diff on a half-float sheet
+//
+//   Simultaneous 2D forward-diff heat on sheets of half_float_type. There is no half arithmetic,
+//   so each row range converts its src rows to float as it goes (keeping the last three in a
+//   ring), solves each row with the float kernels (and so the vector kernels), and converts the
+//   result back to half. Each src row is converted once per range, not three times.
+
+  struct
+solving_functor_forward_diff_2d_half_type
+{
+  // Typedefs
+  public:
+    typedef std::vector< float >                float_buf_type        ;
+    typedef float_buf_type::iterator            float_buf_varia_iter  ;
+    typedef float_buf_type::const_iterator      float_buf_const_iter  ;
+
+  // Constructor
+  public:
+    solving_functor_forward_diff_2d_half_type
+     (  bool                    const &  is_early
+      , float                   const    rate
+      , float                   const    rate_side
+      , std::size_t             const    x_count
+      , std::size_t             const    y_count
+      , half_float_type const * const    p_src
+      , half_float_type *       const    p_trg
+     )
+      : is_early_exit_  ( is_early  )
+      , rate_           ( rate      )
+      , rate_side_      ( rate_side )
+      , x_count_        ( x_count   )
+      , y_count_        ( y_count   )
+      , p_src_          ( p_src     )
+      , p_trg_          ( p_trg     )
+      { }
+      bool                    const &  is_early_exit_ ; /* this is a REF to a bool somewhere else */
+      float                   const    rate_          ;
+      float                   const    rate_side_     ;
+      std::size_t             const    x_count_       ;
+      std::size_t             const    y_count_       ;
+      half_float_type const * const    p_src_         ;
+      half_float_type *       const    p_trg_         ;
+
+  // Functor, solves rows [y_lo, y_hi_plus).
+  public:
+      void
+    operator ()( std::pair< std::size_t, std::size_t > const & y_lo_hi_plus) const
+      {
+        std::size_t const  y_lo       = y_lo_hi_plus.first;
+        std::size_t const  y_hi_plus  = y_lo_hi_plus.second;
+        if ( y_lo >= y_hi_plus ) return;
+
+        // Three float src rows (row y goes in slot y % 3) and the float trg row.
+        float_buf_type              rows( 4 * x_count_);
+        float_buf_varia_iter const  trg_row       = rows.begin( ) + static_cast< std::ptrdiff_t >( 3 * x_count_);
+        float                const  full_damping  = 1;
+        float                const  no_clamp      = 0;
+        std::size_t          const  y_last        = y_count_ - 1;
+
+        std::size_t y_next_load = (y_lo > 0) ? (y_lo - 1) : y_lo;
+        for ( std::size_t y = y_lo ; (y < y_hi_plus) && ! is_early_exit_ ; ++ y ) {
+            // Convert the rows up to the one below y.
+            for ( ; y_next_load <= std::min( y + 1, y_last) ; ++ y_next_load ) {
+                half_float_type::convert_row_to_float
+                 ( p_src_ + (y_next_load * x_count_), x_count_, & (* get_row( rows, y_next_load)));
+            }
+
+            float_buf_const_iter const  src_row        = get_row( rows, y);
+            float_buf_const_iter const  src_row_limit  = src_row + static_cast< std::ptrdiff_t >( x_count_);
+            if ( (y != 0) && (y != y_last) ) {
+                finite_difference::
+                calc_next_generation_forward_difference_2d_middle
+                 (  full_damping, rate_, rate_side_
+                  , src_row, src_row_limit
+                  , float_buf_const_iter( get_row( rows, y - 1))
+                  , float_buf_const_iter( get_row( rows, y + 1))
+                  , trg_row
+                  , no_clamp
+                 );
+            } else
+            if ( 0 != y_last ) {
+                finite_difference::
+                calc_next_generation_forward_difference_2d_edge
+                 (  full_damping, rate_, rate_side_
+                  , src_row, src_row_limit
+                  , float_buf_const_iter( get_row( rows, (y != 0) ? (y - 1) : (y + 1)))
+                  , trg_row
+                  , no_clamp
+                 );
+            } else
+            /* both lo and hi edge (only one row) */ {
+                finite_difference::
+                calc_next_generation_forward_difference_2d_thin_strip
+                 (  full_damping, rate_
+                  , src_row, src_row_limit
+                  , trg_row
+                  , no_clamp
+                 );
+            }
+
+            half_float_type::convert_row_from_float
+             ( & (* trg_row), x_count_, p_trg_ + (y * x_count_));
+        }
       }
+
+  protected:
+      float_buf_varia_iter
+    get_row( float_buf_type & rows, std::size_t y) const
+      { return rows.begin( ) + static_cast< std::ptrdiff_t >( (y % 3) * x_count_); }
 };
 
+  inline
+  void
+calc_next_2d_forward_diff_half
+ (  bool                    const &  is_early_exit
+  , bool                    const    is_parallel
+  , float                   const    rate        // x rate
+  , float                   const    rate_side   // y rate
+  , std::size_t             const    x_count
+  , std::size_t             const    y_count
+  , half_float_type const * const    p_src       // start of the src sheet
+  , half_float_type *       const    p_trg       // start of the trg sheet, cannot overlap src
+ )
+{
+    if ( (x_count == 0) || (y_count == 0) ) return;
+
+    solving_functor_forward_diff_2d_half_type const
+        solving_functor( is_early_exit, rate, rate_side, x_count, y_count, p_src, p_trg);
+
+    row_pool::map_row_ranges( solving_functor, y_count, x_count * sizeof( half_float_type), is_parallel);
+}
+
 // _______________________________________________________________________________________________
 
 # undef INHERIT_FUNCTOR_TYPENAMES
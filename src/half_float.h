@@ -0,0 +1,210 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// half_float.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef HALF_FLOAT_H
+# define HALF_FLOAT_H
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// half_float_type
+//
+//   A 16-bit IEEE half-precision float: 1 sign bit, 5 exponent bits, 10 fraction bits. It only
+//   stores values. There is no half arithmetic here, so you convert to float, do the math, and
+//   convert back (see calc_next_2d_forward_diff_half(..) in finite_diff_solver.h).
+//
+//   A half sheet is half the size of a float sheet, so a solver that is waiting on memory moves
+//   half the bytes. The price is 11 bits of precision, about 3 decimal digits.
+//
+//   The conversions round to nearest even, and keep infinities, NaNs and denormals, like the
+//   F16C instructions.
+//
+//   Improve: Convert whole rows with F16C (_mm256_cvtph_ps and _mm256_cvtps_ph) when the CPU
+//   has it. cpu_features.h does not look for it yet.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <cstring>
+# include <cstddef>
+# include <boost/cstdint.hpp>
+# include "debug.h"
+
+// _______________________________________________________________________________________________
+
+  class
+half_float_type
+{
+  // -------------------------------------------------------------------------------------------
+  // Typedefs
+  public:
+    typedef half_float_type  this_type ;
+    typedef boost::uint16_t  bits_type ;
+
+  // -------------------------------------------------------------------------------------------
+  // Ctors
+  public:
+    /* ctor */          half_float_type( )                  : bits_( 0) { }
+    explicit            half_float_type( double real)       : bits_( convert_from_float( static_cast< float >( real))) { }
+
+    static this_type    from_bits( bits_type bits)          { this_type v; v.bits_ = bits; return v; }
+
+  // -------------------------------------------------------------------------------------------
+  // Getters
+  public:
+    bits_type           get_bits( )                   const { return bits_; }
+    float               get_float( )                  const { return convert_to_float( bits_); }
+
+  // -------------------------------------------------------------------------------------------
+  // Conversions
+  public:
+    static bits_type    convert_from_float( float)          ;
+    static float        convert_to_float( bits_type)        ;
+
+    // Whole rows, for the solver.
+    static void         convert_row_from_float
+                         (  float const *  p_src
+                          , std::size_t    count
+                          , this_type   *  p_trg
+                         )                                  { for ( std::size_t i = 0 ; i < count ; ++ i ) {
+                                                                  p_trg[ i ].bits_ = convert_from_float( p_src[ i ]);
+                                                              } }
+    static void         convert_row_to_float
+                         (  this_type const *  p_src
+                          , std::size_t        count
+                          , float           *  p_trg
+                         )                                  { for ( std::size_t i = 0 ; i < count ; ++ i ) {
+                                                                  p_trg[ i ] = convert_to_float( p_src[ i ].bits_);
+                                                              } }
+
+  // -------------------------------------------------------------------------------------------
+  // Compare, as floats (so +0 == -0, and NaN is not equal to anything)
+  public:
+    bool                operator ==( this_type b)     const { return get_float( ) == b.get_float( ); }
+    bool                operator !=( this_type b)     const { return get_float( ) != b.get_float( ); }
+    bool                operator < ( this_type b)     const { return get_float( ) <  b.get_float( ); }
+    bool                operator > ( this_type b)     const { return get_float( ) >  b.get_float( ); }
+    bool                operator <=( this_type b)     const { return get_float( ) <= b.get_float( ); }
+    bool                operator >=( this_type b)     const { return get_float( ) >= b.get_float( ); }
+
+  // -------------------------------------------------------------------------------------------
+  // Member var
+  private:
+    bits_type  bits_ ;
+
+}; /* end class half_float_type */
+
+// The sheets are stored as the bare bits.
+d_static_assert( sizeof( half_float_type) == sizeof( boost::uint16_t));
+
+// _______________________________________________________________________________________________
+
+  inline
+  half_float_type::bits_type
+  half_float_type::
+convert_from_float( float f)
+{
+    d_static_assert( sizeof( float) == sizeof( boost::uint32_t));
+    boost::uint32_t f_bits = 0;
+    std::memcpy( & f_bits, & f, sizeof( f_bits));
+
+    boost::uint32_t const  sign  = (f_bits >> 16) & 0x8000u;
+    boost::uint32_t const  abs   = f_bits & 0x7fffffffu;
+
+    // Infinity and NaN. Keep NaN quiet and non-zero.
+    if ( abs >= 0x7f800000u ) {
+        return static_cast< bits_type >( sign | 0x7c00u | ((abs > 0x7f800000u) ? 0x0200u : 0u));
+    }
+
+    // Too big, rounds to infinity. 0x477ff000 is 65520, half way between the biggest half
+    // (65504) and the next step up.
+    if ( abs >= 0x477ff000u ) {
+        return static_cast< bits_type >( sign | 0x7c00u);
+    }
+
+    // Normal half. Rebias the exponent (127 to 15) and drop 13 fraction bits, rounding to even.
+    // A round up can carry into the exponent, which is what we want.
+    if ( abs >= 0x38800000u ) {
+        boost::uint32_t        bits       = (abs - 0x38000000u) >> 13;
+        boost::uint32_t const  remainder  = abs & 0x1fffu;
+        if ( (remainder > 0x1000u) || ((remainder == 0x1000u) && (bits & 1u)) ) { bits += 1; }
+        return static_cast< bits_type >( sign | bits);
+    }
+
+    // Denormal half (or zero), in units of 2^-24. Anything under 2^-25 rounds to zero.
+    boost::uint32_t const  exponent  = abs >> 23;
+    if ( exponent < 102 ) {
+        return static_cast< bits_type >( sign);
+    }
+    boost::uint32_t const  mantissa   = (abs & 0x007fffffu) | 0x00800000u;
+    boost::uint32_t const  shift      = 126 - exponent; /* 14 to 24 */
+    boost::uint32_t        bits       = mantissa >> shift;
+    boost::uint32_t const  remainder  = mantissa & ((boost::uint32_t( 1) << shift) - 1);
+    boost::uint32_t const  half_way   = boost::uint32_t( 1) << (shift - 1);
+    if ( (remainder > half_way) || ((remainder == half_way) && (bits & 1u)) ) { bits += 1; }
+    return static_cast< bits_type >( sign | bits);
+}
+
+  inline
+  float
+  half_float_type::
+convert_to_float( bits_type h)
+  //
+  // Every half is exactly a float, so this does not round.
+{
+    boost::uint32_t const  sign      = boost::uint32_t( h & 0x8000u) << 16;
+    boost::uint32_t const  exponent  = (h >> 10) & 0x1fu;
+    boost::uint32_t        mantissa  = h & 0x03ffu;
+
+    boost::uint32_t f_bits = sign;
+    if ( 0x1fu == exponent ) {
+        f_bits |= 0x7f800000u | (mantissa << 13);
+    } else
+    if ( 0 != exponent ) {
+        f_bits |= ((exponent + 112) << 23) | (mantissa << 13);
+    } else
+    if ( 0 != mantissa ) {
+        // Denormal half. Normalize it, since it's a normal float.
+        boost::uint32_t float_exponent = 113;
+        while ( 0 == (mantissa & 0x0400u) ) {
+            mantissa <<= 1;
+            float_exponent -= 1;
+        }
+        f_bits |= (float_exponent << 23) | ((mantissa & 0x03ffu) << 13);
+    }
+
+    float f = 0;
+    std::memcpy( & f, & f_bits, sizeof( f));
+    return f;
+}
+
+// _______________________________________________________________________________________________
+
+// Overload of to_real(..) (see value_sheet.h).
+  inline
+  float
+to_real( half_float_type const & v)
+{
+    return v.get_float( );
+}
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef HALF_FLOAT_H
+//
+// half_float.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
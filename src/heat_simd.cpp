@@ -258,6 +258,7 @@
 # include "animate_ui.h"
 # include "solve_control.h"
 # include "shader.h"
+# include "finite_diff_simd.h"
 
 # include <QtGui/QFileDialog>
 # include <QtGui/QImageWriter>
@@ -668,6 +669,10 @@ init_solve_stats( )
 
     p_delay_solve_stats_->set_ui_from_delay( );
 
+    // Show which vector kernels the solvers picked for this CPU. This never changes.
+    ui.p_value_simd_kernels_->setText( QString::fromUtf8(
+        cpu_features::get_simd_level_name( finite_difference::simd::get_kernels( ).level)));
+
     // Button to clear the stats.
     d_verify( connect(
         ui.p_button_clear_solve_stats_, SIGNAL( clicked( )),
@@ -750,6 +755,9 @@ update_display_generation( sheet_control_type * p_sctrl)
 
     // The following is surprisingly slow. It seems to take about as long as solving a 200x200 sheet.
     ui.p_value_generation_->setNum( gen);
+
+    // The generations solved but never drawn, which adds up when the worker is free running.
+    ui.p_value_skipped_->setNum( p_sctrl->get_skipped_generation_count( ));
 }
 
   bool
@@ -1217,6 +1225,13 @@ init_solve_pass_count( )
     // Get the default value from the solve control and set it in the UI.
     int const pass_count = static_cast< int >( p_hsolv->get_pass_count( ));
     ui.p_spinb_pass_count_->setValue( pass_count);
+
+    // Spin box to set how long the worker free runs while auto-solving. Zero means never.
+    ui.p_spinb_free_run_msecs_->setValue( p_hsolv->get_free_run_msecs( ));
+    d_verify( connect(
+        ui.p_spinb_free_run_msecs_, SIGNAL( valueChanged( int)),
+        p_hsolv, SLOT( set_free_run_msecs( int))
+    ));
 }
 
   void
@@ -1342,13 +1357,25 @@ calc_rate_status( rate_type rate, rate_type other_rate)
     // A negative rate is always illegal.
     if ( rate < 0 ) return e_alert;
 
-    // Backward-diff works with any positive rate.
+    // Backward-diff works with any positive rate, and so do a few other technique/methods.
     heat_solver_type * const p_hsolv = get_heat_solver( );
 
-    if ( p_hsolv->is_method__backward_diff( ) ) return e_normal;
+    if ( heat_solver::is_stable_at_any_rate( p_hsolv->get_technique( ), p_hsolv->get_method( )) ) return e_normal;
 
     // Forward and central diff need small positive rates.
-    if ( p_hsolv->is_method__forward_diff( ) && ! p_hsolv->is_technique__ortho_interleave( ) ) {
+    heat_solver::method_type const solved_method =
+        heat_solver::get_solved_method( p_hsolv->get_technique( ), p_hsolv->get_method( ));
+    if ( (solved_method == heat_solver::e_forward_diff_9_point) ||
+         (solved_method == heat_solver::e_forward_diff_4th_order) )
+    {
+        // The wide forward-diff stencils have their own limits (see get_stable_rate_fraction(..)).
+        // Caution in the last third before the limit.
+        double const fraction =
+            heat_solver::get_stable_rate_fraction( p_hsolv->get_technique( ), solved_method, rate, other_rate);
+        if ( fraction <= (2 / 3.0) ) return e_normal;
+        if ( fraction <  1         ) return e_caution;
+    } else
+    if ( (solved_method == heat_solver::e_forward_diff) && ! p_hsolv->is_technique__ortho_interleave( ) ) {
         // Forward diff that is not interleave uses a 2d algorithm and looks at both x- and y- neighbors
         // when it calcs the next value. Thus the rates are constrained to smaller positive values.
         rate_type const adjust_rate = rate - (1 / static_cast< rate_type >( 10000));
@@ -1361,6 +1388,11 @@ calc_rate_status( rate_type rate, rate_type other_rate)
         if ( rate <= (1 / static_cast< rate_type >( 3)) ) return e_normal;
         if ( rate <  (1 / static_cast< rate_type >( 2)) ) return e_caution;
     }
+
+    // Past the stability limit the heat solver splits each pass into stable sub-steps, which is
+    // slow but safe. The wave solvers can't do that.
+    if ( (! p_hsolv->is_technique__wave_with_damping( )) &&
+         (! p_hsolv->is_technique__wave_leapfrog( )) ) return e_caution;
     return e_alert;
 }
 
@@ -1377,11 +1409,19 @@ init_solve_technique( )
     QAbstractButton * const p_radio_orth = ui.p_radio_technique_ortho_interleave_ ;
     QAbstractButton * const p_radio_simu = ui.p_radio_technique_simultaneous_     ;
     QAbstractButton * const p_radio_wave = ui.p_radio_technique_wave_             ;
+    QAbstractButton * const p_radio_mgrd = ui.p_radio_technique_multigrid_        ;
+    QAbstractButton * const p_radio_spec = ui.p_radio_technique_spectral_         ;
+    QAbstractButton * const p_radio_rkl2 = ui.p_radio_technique_super_step_       ;
+    QAbstractButton * const p_radio_leap = ui.p_radio_technique_wave_leapfrog_    ;
 
     // Set the init state of the radio buttons from the solve object.
     p_radio_orth->setChecked( p_hsolv->is_technique__ortho_interleave(  ));
     p_radio_simu->setChecked( p_hsolv->is_technique__simultaneous_2d(   ));
     p_radio_wave->setChecked( p_hsolv->is_technique__wave_with_damping( ));
+    p_radio_mgrd->setChecked( p_hsolv->is_technique__implicit_multigrid( ));
+    p_radio_spec->setChecked( p_hsolv->is_technique__spectral_jump( ));
+    p_radio_rkl2->setChecked( p_hsolv->is_technique__super_time_step( ));
+    p_radio_leap->setChecked( p_hsolv->is_technique__wave_leapfrog( ));
 
     // Tell the radio buttons to update the solve object.
     d_verify( connect(
@@ -1393,6 +1433,18 @@ init_solve_technique( )
     d_verify( connect(
         p_radio_wave, SIGNAL( toggled( bool)),
         p_hsolv, SLOT( set_technique__wave_with_damping( bool))));
+    d_verify( connect(
+        p_radio_mgrd, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_technique__implicit_multigrid( bool))));
+    d_verify( connect(
+        p_radio_spec, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_technique__spectral_jump( bool))));
+    d_verify( connect(
+        p_radio_rkl2, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_technique__super_time_step( bool))));
+    d_verify( connect(
+        p_radio_leap, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_technique__wave_leapfrog( bool))));
 
     // The alert/caution color on the rates depends on the technique.
     d_verify( connect(
@@ -1450,30 +1502,55 @@ init_solve_method( )
     heat_solver_type   * const p_hsolv = get_heat_solver( );
 
     QAbstractButton * const p_radio_forw = ui.p_radio_method_forward_diff_ ;
+    QAbstractButton * const p_radio_fw9p = ui.p_radio_method_forward_diff_9_point_  ;
+    QAbstractButton * const p_radio_fw4o = ui.p_radio_method_forward_diff_4th_order_;
     QAbstractButton * const p_radio_back = ui.p_radio_method_backward_diff_;
     QAbstractButton * const p_radio_cent = ui.p_radio_method_central_diff_ ;
 
     QAbstractButton * const p_check_para = ui.p_check_method_parallel_     ;
-
-    QAbstractButton * const p_check_fix  = ui.p_check_fix_edges_           ;
+    QAbstractButton * const p_check_dbl  = ui.p_check_precision_double_    ;
+    QAbstractButton * const p_check_f16  = ui.p_check_precision_fixed16_   ;
+    QAbstractButton * const p_check_f32  = ui.p_check_precision_fixed32_   ;
+    QAbstractButton * const p_check_half = ui.p_check_precision_half_      ;
+    QAbstractButton * const p_check_skip = ui.p_check_skip_quiet_tiles_    ;
+
+    QAbstractButton * const p_radio_insu = ui.p_radio_edges_insulated_     ;
+    QAbstractButton * const p_radio_fix  = ui.p_radio_edges_fixed_         ;
+    QAbstractButton * const p_radio_wrap = ui.p_radio_edges_periodic_      ;
+    QAbstractButton * const p_radio_absb = ui.p_radio_edges_absorbing_     ;
     QAbstractButton * const p_check_sink = ui.p_check_sink_center_         ;
     QAbstractButton * const p_check_vort = ui.p_check_vortex_              ;
+    QAbstractButton * const p_check_wall = ui.p_check_insulating_wall_     ;
 
     // Set the init state of the UI from the state of the solve control object.
     p_radio_forw->setChecked( p_hsolv->is_method__forward_diff(  ));
+    p_radio_fw9p->setChecked( p_hsolv->is_method__forward_diff_9_point(   ));
+    p_radio_fw4o->setChecked( p_hsolv->is_method__forward_diff_4th_order( ));
     p_radio_back->setChecked( p_hsolv->is_method__backward_diff( ));
     p_radio_cent->setChecked( p_hsolv->is_method__central_diff(  ));
 
     p_check_para->setChecked( p_hsolv->is_method_parallel(      ));
+    set_precision_checkboxes( );
+    p_check_skip->setChecked( p_hsolv->is_skipping_quiet_tiles( ));
 
-    p_check_fix ->setChecked( p_sctrl->are_edges_fixed(         ));
+    p_radio_insu->setChecked( p_hsolv->is_boundary__insulated(  ));
+    p_radio_fix ->setChecked( p_hsolv->is_boundary__fixed(      ));
+    p_radio_wrap->setChecked( p_hsolv->is_boundary__periodic(   ));
+    p_radio_absb->setChecked( p_hsolv->is_boundary__absorbing(  ));
     p_check_sink->setChecked( p_sctrl->is_center_frozen(        ));
     p_check_vort->setChecked( p_sctrl->is_vortex_on(            ));
+    p_check_wall->setChecked( p_sctrl->is_insulating_wall_on(   ));
 
     // Radio buttons for solve method.
     d_verify( connect(
         p_radio_forw, SIGNAL( toggled( bool)),
         p_hsolv, SLOT( set_method__forward_diff( bool))));
+    d_verify( connect(
+        p_radio_fw9p, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_method__forward_diff_9_point( bool))));
+    d_verify( connect(
+        p_radio_fw4o, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_method__forward_diff_4th_order( bool))));
     d_verify( connect(
         p_radio_back, SIGNAL( toggled( bool)),
         p_hsolv, SLOT( set_method__backward_diff( bool))));
@@ -1491,10 +1568,57 @@ init_solve_method( )
         p_check_para, SIGNAL( toggled( bool)),
         p_hsolv, SLOT( set__is_method_parallel( bool))));
 
-    // Checkbox for fixed edges.
+    // Spin box for the number of threads the parallel solve uses. Zero means one for each core.
+    ui.p_spinb_thread_count_->setValue( p_hsolv->get_thread_count( ));
+    d_verify( connect(
+        ui.p_spinb_thread_count_, SIGNAL( valueChanged( int)),
+        p_hsolv, SLOT( set_thread_count( int))));
+    ui.p_spinb_thread_count_->setEnabled( p_hsolv->is_method_parallel( ));
+    d_verify( connect(
+        p_check_para, SIGNAL( toggled( bool)),
+        ui.p_spinb_thread_count_, SLOT( setEnabled( bool))));
+
+    // Checkbox for double-precision solve.
+    d_verify( connect(
+        p_check_dbl, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set__is_precision_double( bool))));
+
+    // Checkboxes for fixed-point solve. These go back to float for the solves they cannot do.
+    d_verify( connect(
+        p_check_f16, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set__is_precision_fixed16( bool))));
     d_verify( connect(
-        p_check_fix, SIGNAL( toggled( bool)),
-        p_sctrl, SLOT( set__are_edges_fixed( bool))));
+        p_check_f32, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set__is_precision_fixed32( bool))));
+
+    // Checkbox for half-float solve. This also goes back to float for the solves it cannot do.
+    d_verify( connect(
+        p_check_half, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set__is_precision_half( bool))));
+
+    // Only one of the precision checkboxes can be checked.
+    d_verify( connect(
+        p_hsolv, SIGNAL( precision_is_changed( )),
+        this, SLOT( set_precision_checkboxes( ))));
+
+    // Checkbox for skipping the quiet parts of the sheet.
+    d_verify( connect(
+        p_check_skip, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set__is_skipping_quiet_tiles( bool))));
+
+    // Radio buttons for the edges (solve boundary).
+    d_verify( connect(
+        p_radio_insu, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_boundary__insulated( bool))));
+    d_verify( connect(
+        p_radio_fix, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_boundary__fixed( bool))));
+    d_verify( connect(
+        p_radio_wrap, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_boundary__periodic( bool))));
+    d_verify( connect(
+        p_radio_absb, SIGNAL( toggled( bool)),
+        p_hsolv, SLOT( set_boundary__absorbing( bool))));
 
     // Checkbox for sunken point in center of sheet.
     d_verify( connect(
@@ -1505,6 +1629,27 @@ init_solve_method( )
     d_verify( connect(
         p_check_vort, SIGNAL( toggled( bool)),
         p_sctrl, SLOT( set__is_vortex_on( bool))));
+
+    // Checkbox for the conductivity map.
+    d_verify( connect(
+        p_check_wall, SIGNAL( toggled( bool)),
+        p_sctrl, SLOT( set__is_insulating_wall_on( bool))));
+}
+
+  /* slot */
+  void
+  heat_wave_main_window_type::
+set_precision_checkboxes( )
+  //
+  // Signaled or called when:
+  //   UI is initialized.
+  //   Precision is changed.
+{
+    heat_solver_type * const p_hsolv = get_heat_solver( );
+    ui.p_check_precision_double_ ->setChecked( p_hsolv->is_precision__double(  ));
+    ui.p_check_precision_fixed16_->setChecked( p_hsolv->is_precision__fixed16( ));
+    ui.p_check_precision_fixed32_->setChecked( p_hsolv->is_precision__fixed32( ));
+    ui.p_check_precision_half_   ->setChecked( p_hsolv->is_precision__half(    ));
 }
 
 // _______________________________________________________________________________________________
@@ -82,6 +82,7 @@ heat_wave_main_window_type
 
     void                  set_xy_draw_size_limit( )                                       ;
     void                  set_damping_from_ui( double)                                    ;
+    void                  set_precision_checkboxes( )                                     ;
 
     void                  set_window_size_labels( )                                       ;
 
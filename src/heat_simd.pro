@@ -69,13 +69,18 @@ win32:RC_FILE = heat_simd.rc
 HEADERS =                          \
   all.h                            \
   bezier.h                         \
+  cpu_features.h                   \
   debug.h                          \
   finite_diff.h                    \
+  finite_diff_simd.h               \
+  finite_diff_simd_kernels.h       \
   finite_diff_solver.h             \
   gl_env_fractional_fixed_point.h  \
   moving_sum.h                     \
+  multigrid.h                      \
   pair_iter.h                      \
   pt3.h                            \
+  spectral.h                       \
   stride_iter.h                    \
   tri_diag.h                       \
   angle_holder.h                   \
@@ -89,6 +94,7 @@ HEADERS =                          \
   color_gradient_holder.h          \
   color_holder.h                   \
   date_time.h                      \
+  draw_buffer.h                    \
   draw_sheet_base.h                \
   draw_sheet_bristles.h            \
   draw_sheet_surface.h             \
@@ -103,6 +109,7 @@ HEADERS =                          \
   gl_env_type_primitives.h         \
   gl_shader.h                      \
   GLee.h                           \
+  half_float.h                     \
   heat_simd.h                      \
   heat_solver.h                    \
   heat_widget.h                    \
@@ -114,11 +121,15 @@ HEADERS =                          \
   out_of_date.h                    \
   out_of_date_ui.h                 \
   pack_holder.h                    \
+  row_pool.h                       \
   shader.h                         \
   shading_style.h                  \
   sheet.h                          \
+  sheet_stats.h                    \
   solve_control.h                  \
-  util.h
+  uniform_scalar.h                 \
+  util.h                           \
+  value_sheet.h
 
 SOURCES =                          \
   main.cpp                         \
@@ -132,12 +143,15 @@ SOURCES =                          \
   bristle_style.cpp                \
   color_gradient_holder.cpp        \
   color_holder.cpp                 \
+  cpu_features.cpp                 \
   date_time.cpp                    \
+  draw_buffer.cpp                  \
   draw_sheet_base.cpp              \
   draw_sheet_bristles.cpp          \
   draw_sheet_surface.cpp           \
   face_properties_style.cpp        \
   face_style.cpp                   \
+  finite_diff_simd.cpp             \
   full_screen.cpp                  \
   gl_draw_back_grid.cpp            \
   gl_draw_lights.cpp               \
@@ -158,6 +172,7 @@ SOURCES =                          \
   out_of_date.cpp                  \
   out_of_date_ui.cpp               \
   pack_holder.cpp                  \
+  row_pool.cpp                     \
   shader.cpp                       \
   shading_style.cpp                \
   sheet.cpp                        \
@@ -26,66 +26,12 @@
 //   Heat capacity for each cell
 //   Values for rate for each edge (including outer edges)
 //
-// Can the thread class use QThread::idealThreadCount( )?
+// The parallel solvers map their rows on control_type's row_pool::pool_type (row_pool.h). The
+// worker thread makes it the current pool while it solves.
 //
-// Improvement:
-//   Scale class (uniform_scalar). Can replace the floats or doubles in the simulation.
-//     This is an integer, maybe a 32-bit unsigned, that represents the interval [-1..+1].
-//     But it cannot represent outside that range so you have to use it carefully, more carefully
-//     than we do here. Floats and doubles are sloppier, but more forgiving when you're just
-//     experimenting.
-//
-//   float is great if you're going to swing wildly to very large and very small numbers.
-//   But float is not uniform. It is very dense around zero and very sparse at the outer edges.
-//   If we limit some float values to [0..1] we are throwing away 2 bits (exp sign and matissa sign).
-//   And accuracy at near 1 is a lot less than accuracy near zero.
-//
-//   So a scale class is sometimes preferable to float because it:
-//     Lets you use all the bits.
-//     Distributes the numbers uniformly across the entire range.
-//
-//   This is not a limited (ranged) integer. That's another class.
-//
-//      template
-//       <  typename INT_INNER_T   /* int */
-//        , typename REAL_LIMIT_T  /* float or double */
-//        , LIMIT_T  LO            /* -1.0f */
-//        , LIMIT_T  HI            /* +1.0f */
-//       >
-//      class
-//    uniform_scalar
-//      //
-//      // Convert to/from real (float, double, rational) values.
-//      // Provide operators + - *
-//      // Provide division with various rounding options
-//      // Provide +-* functions that tell you about overflow
-//      // Provide +-* functions that return corrections that you can pass to the next operation
-//      //
-//      // Inner type is an integer type.
-//      //   Could we make this a vector (x, y, z)? We could overload the template params to watch
-//      //   for boost::integer_traits< int_inner_type >::is_integral being true.
-//      //
-//      // Limit type is probably float, double, or rational.
-//      //   Although maybe limit_type could be another uniform type.
-//    {
-//      public:
-//        typedef INT_INNER_T           int_inner_type ;
-//        static int_inner_type const   int_inner_min  = boost::integer_traits< int_inner_type >::const_min;
-//        static int_inner_type const   int_inner_max  = boost::integer_traits< int_inner_type >::const_max;
-//      private:
-//        int_inner_type  int_inner_value_ ;
-//    };
-//
-//   Perhaps it's better to provide fixed intervals:
-//     0<=x<1   - easiest
-//     0<=x<=1  - representing exactly 1 complicates things
-//     0<=x<2   - easy
-//     0<=x<=2
-//     -1<x<1   - easy if you don't mind a signed zero
-//     -1<=x<1  - easy
-//     -1<=x<=1
-//   Perhaps also a 1/x bit for the 0..1 and -1..1 intervals? Like float this throws away a bit,
-//   although the 0<=x<1 interval is still uniform.
+// The uniform_scalar class (uniform_scalar.h) replaces the floats in the fixed-point solvers.
+// Those only do forward-diff heat so far. The other methods and wave need more care, since the
+// values cannot leave [-1, +1].
 // _______________________________________________________________________________________________
 
 # include "all.h"
@@ -106,11 +52,15 @@ input_params_type( )
   : technique_                 ( e_simultaneous_2d )
   , method_                    ( e_forward_diff    )
   , is_method_parallel_        ( true              )
+  , boundary_                  ( e_boundary_insulated)
+  , precision_                 ( e_single_precision)
   , damping_                   ( 0                 )
   , rate_x_                    ( 0.2               )
   , rate_y_                    ( 0.2               )
   , extra_pass_count_          ( 0                 )
   , are_extra_passes_disabled_ ( false             )
+  , is_skipping_quiet_tiles_   ( false             )
+  , is_src_from_last_solve_    ( false             )
   , reset_if_not_used_         ( false             )
   , copy_for_history_          ( false             )
   , size_for_history_          ( false             )
@@ -134,17 +84,129 @@ input_params_type
   : technique_                 ( technique          )
   , method_                    ( method             )
   , is_method_parallel_        ( is_method_parallel )
+  , boundary_                  ( e_boundary_insulated)
+  , precision_                 ( e_single_precision )
   , damping_                   ( damping            )
   , rate_x_                    ( rate_x             )
   , rate_y_                    ( rate_y             )
   , extra_pass_count_          ( extra_pass_count   )
   , are_extra_passes_disabled_ ( false              )
+  , is_skipping_quiet_tiles_   ( false              )
+  , is_src_from_last_solve_    ( false              )
   , reset_if_not_used_         ( reset_if_not_used  )
   , copy_for_history_          ( copy_for_history   )
   , size_for_history_          ( size_for_history   )
 { }
 
 // _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// is_stable_at_any_rate(..)
+
+  bool
+is_stable_at_any_rate( technique_type technique, method_type method)
+  //
+  // Backward diff is stable with any rate.
+  // Central diff is too (Crank-Nicolson) when the 2D system is solved whole, by multigrid or
+  // spectral. Split into 1D passes it overshoots and rings at big rates.
+  // RKL2 super-steps pick a stage count that makes any rate stable.
+  // The leapfrog wave solves every method as forward diff (see get_solved_method(..)).
+{
+    method = get_solved_method( technique, method);
+    if ( method == e_backward_diff ) return true;
+    if ( (method == e_central_diff) &&
+         ((technique == e_implicit_multigrid) || (technique == e_spectral_jump)) )
+    {
+        return true;
+    }
+    if ( (method == e_forward_diff) && (technique == e_super_time_step) ) return true;
+    return false;
+}
+
+// _______________________________________________________________________________________________
+// get_solved_method(..)
+
+  method_type
+get_solved_method( technique_type technique, method_type method)
+  //
+  // Interleave solves 1D passes, and multigrid, spectral and RKL2 have the 5-point Laplacian
+  // built in, so they only know plain forward diff.
+  // The leapfrog wave is explicit, so it solves backward and central diff as plain forward diff.
+{
+    if ( ((method == e_forward_diff_9_point) || (method == e_forward_diff_4th_order)) &&
+         (technique != e_simultaneous_2d) && (technique != e_wave_with_damping) &&
+         (technique != e_wave_leapfrog) )
+    {
+        return e_forward_diff;
+    }
+    if ( ((method == e_backward_diff) || (method == e_central_diff)) && (technique == e_wave_leapfrog) ) {
+        return e_forward_diff;
+    }
+    return method;
+}
+
+// _______________________________________________________________________________________________
+// get_stable_rate_fraction(..)
+
+  double
+get_stable_rate_fraction( technique_type technique, method_type method, double rate_x, double rate_y)
+  //
+  // Stability limits:
+  //   see is_stable_at_any_rate(..)           -- stable with any rate (returns zero)
+  //   forward or central diff, interleave     -- each rate < 1/2 (each 1D pass on its own)
+  //   forward or central diff, otherwise      -- (rate_x + rate_y) < 1/2
+  //   9-point forward diff                    -- each rate < 1/2, and (rate_x + rate_y) < 3/4
+  //   4th-order forward diff                  -- (rate_x + rate_y) < 3/8
+  //
+  // The forward-diff limits keep the gain of the worst cosine mode above -1. For the 9-point
+  // stencil the worst modes are the checkerboard (gain 1 - (8/3)(rate_x + rate_y)) and the
+  // stripes along each axis (gain 1 - 4 rate). For the 4th-order stencil it's the checkerboard,
+  // with gain 1 - (16/3)(rate_x + rate_y).
+  //
+  // Central diff solved with 1D passes is stable in theory at any rate, but overshoots and rings
+  // above 1/2.
+{
+    method = get_solved_method( technique, method);
+    if ( is_stable_at_any_rate( technique, method) ) return 0;
+
+    if ( technique == e_ortho_interleave ) {
+        return std::max( rate_x, rate_y) / 0.5;
+    }
+    if ( method == e_forward_diff_9_point ) {
+        return std::max( std::max( rate_x, rate_y) / 0.5, (rate_x + rate_y) / 0.75);
+    }
+    if ( method == e_forward_diff_4th_order ) {
+        return (rate_x + rate_y) / 0.375;
+    }
+    return (rate_x + rate_y) / 0.5;
+}
+
+// _______________________________________________________________________________________________
+// get_solved_boundary(..)
+
+  boundary_type
+get_solved_boundary( technique_type technique, method_type method, boundary_type boundary)
+  //
+  // The boundaries are built into the 2d forward-diff functor (see finite_diff_solver.h). The
+  // 1D passes (interleave, and backward and central diff everywhere else), the multigrid
+  // smoothers and the cosine transform all have insulated edges built in.
+{
+    method = get_solved_method( technique, method);
+    bool const is_forward_diff =
+        (method == e_forward_diff) ||
+        (method == e_forward_diff_9_point) ||
+        (method == e_forward_diff_4th_order);
+    if ( ! is_forward_diff ) return e_boundary_insulated;
+
+    if ( boundary == e_boundary_absorbing ) {
+        return ((technique == e_wave_with_damping) || (technique == e_wave_leapfrog)) ?
+            e_boundary_absorbing : e_boundary_insulated;
+    }
+    if ( (technique == e_ortho_interleave) || (technique == e_spectral_jump) ) {
+        return e_boundary_insulated;
+    }
+    return boundary;
+}
+
 // _______________________________________________________________________________________________
 // settable_input_params_type
 
@@ -171,12 +233,44 @@ set_technique( technique_type tech)
         copy_for_history_  = true;
         size_for_history_  = true;
         reset_if_not_used_ = false;
+    } else
+    if ( e_implicit_multigrid == tech ) {
+        technique_         = e_implicit_multigrid;
+        copy_for_history_  = true;
+        size_for_history_  = false;
+        reset_if_not_used_ = false;
+    } else
+    if ( e_spectral_jump == tech ) {
+        technique_         = e_spectral_jump;
+        copy_for_history_  = true;
+        size_for_history_  = false;
+        reset_if_not_used_ = false;
+    } else
+    if ( e_super_time_step == tech ) {
+        technique_         = e_super_time_step;
+        copy_for_history_  = true;
+        size_for_history_  = false;
+        reset_if_not_used_ = false;
+    } else
+    if ( e_wave_leapfrog == tech ) {
+        // The velocity sheet holds the history.
+        technique_         = e_wave_leapfrog;
+        copy_for_history_  = false;
+        size_for_history_  = false;
+        reset_if_not_used_ = false;
     } else {
         d_assert( false);
     }
     return true;
 }
 
+  bool
+  settable_input_params_type::
+set_solved_technique( technique_type tech)
+{
+    return util::maybe_assign( technique_, tech);
+}
+
   bool
   settable_input_params_type::
 set_method( method_type new_method)
@@ -192,6 +286,24 @@ set__is_method_parallel( bool new_value /* = true */)
     return util::maybe_assign( is_method_parallel_, new_value);
 }
 
+  bool
+  settable_input_params_type::
+set_boundary( boundary_type new_boundary)
+{
+    return util::maybe_assign( boundary_, new_boundary);
+}
+
+  bool
+  settable_input_params_type::
+set_precision( precision_type new_precision)
+{
+    d_assert(
+        (e_single_precision  == new_precision) || (e_double_precision  == new_precision) ||
+        (e_fixed16_precision == new_precision) || (e_fixed32_precision == new_precision) ||
+        (e_half_precision    == new_precision));
+    return util::maybe_assign( precision_, new_precision);
+}
+
   bool
   settable_input_params_type::
 set_damping( rate_type new_damping)
@@ -228,13 +340,30 @@ set__are_extra_passes_disabled( bool new_value)
     return util::maybe_assign( are_extra_passes_disabled_, new_value);
 }
 
+  bool
+  settable_input_params_type::
+set__is_skipping_quiet_tiles( bool new_value)
+{
+    d_assert( (true == new_value) || (false == new_value));
+    return util::maybe_assign( is_skipping_quiet_tiles_, new_value);
+}
+
+  bool
+  settable_input_params_type::
+set__is_src_from_last_solve( bool new_value)
+{
+    d_assert( (true == new_value) || (false == new_value));
+    return util::maybe_assign( is_src_from_last_solve_, new_value);
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
-// solver_type
+// basic_solver_type< SHEET_TYPE >
 
   /* constructor */
-  solver_type::
-solver_type( )
+  template< typename SHEET_TYPE >
+  basic_solver_type< SHEET_TYPE >::
+basic_solver_type( )
 
   // Early exit is used when we shut down the program, to finish/abort an off-thread solve quickly.
   : output_params_                  ( )
@@ -245,21 +374,35 @@ solver_type( )
   , buf_iter_a_                     ( )
   , buf_iter_b_                     ( )
 
+  // The conductivity map and the leapfrog velocity, only set during calc_next(..).
+  , p_conductivity_sheet_           ( 0)
+  , p_velocity_sheet_               ( 0)
+
+  // Quiet tiles, sized by the first solve that skips them.
+  , tile_activity_                  ( )
+
+  // Factored matrices used by backward and central diff, shared by the functors below.
+  , implicit_matrices_              ( )
+
+  // Cosine transform used by the spectral-jump technique. It can exit early too.
+  , spectral_                       ( output_params_.ref_early_exit( ))
+
   // Solving functors. We don't have a functor for 2d forward-diff solves -- we just call a function.
   , forward_diff_serial_functor_    ( output_params_.ref_early_exit( ))
   , forward_diff_parallel_functor_  ( output_params_.ref_early_exit( ))
-  , backward_diff_serial_functor_   ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_)
-  , backward_diff_parallel_functor_ ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_)
-  , central_diff_serial_functor_    ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_)
-  , central_diff_parallel_functor_  ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_)
+  , backward_diff_serial_functor_   ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_, implicit_matrices_)
+  , backward_diff_parallel_functor_ ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_, implicit_matrices_)
+  , central_diff_serial_functor_    ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_, implicit_matrices_)
+  , central_diff_parallel_functor_  ( output_params_.ref_early_exit( ), buf_iter_a_, buf_iter_b_, implicit_matrices_)
 {
 }
 
 // _______________________________________________________________________________________________
 
   /* main method */
+  template< typename SHEET_TYPE >
   void
-  solver_type::
+  basic_solver_type< SHEET_TYPE >::
 calc_next
  (  input_params_type const &  input_params
   , sheet_params_type const &  sheet_params
@@ -269,13 +412,66 @@ calc_next
   //   stride_range< trg_iter_type, 1 >  trg_range
   // See swap_xy( range_xy) -> range_yx
 {
+    // With a conductivity map there is one rate for each face, which the cosine transform and
+    // the multigrid solver do not know about. Those techniques solve like simultaneous 2d.
+    // The map also only comes with the 5-point stencil, so every technique solves the wide
+    // stencils as plain forward diff, like ortho interleave does.
+    bool           const is_varying       = (0 != sheet_params.get_conductivity_sheet( ));
+    technique_type const solved_technique =
+        (is_varying &&
+         (input_params.is_technique__spectral_jump( ) || input_params.is_technique__implicit_multigrid( ))) ?
+            e_simultaneous_2d : input_params.get_technique( );
+
+    // The techniques without the wide forward-diff stencils solve them as plain forward diff.
+    // The techniques without a boundary built in solve with insulated edges.
+    // The leapfrog wave only solves forward diff, with the map or without.
+    method_type   const solved_method   =
+        get_solved_method
+         (  is_varying ? e_ortho_interleave : solved_technique
+          , get_solved_method( solved_technique, input_params.get_method( ))
+         );
+    boundary_type const solved_boundary =
+        get_solved_boundary( solved_technique, solved_method, input_params.get_boundary( ));
+    if ( (solved_technique != input_params.get_technique( )) ||
+         (solved_method != input_params.get_method( )) ||
+         (solved_boundary != input_params.get_boundary( )) )
+    {
+        settable_input_params_type solved_params;
+        static_cast< input_params_type & >( solved_params) = input_params;
+        solved_params.set_solved_technique( solved_technique);
+        solved_params.set_method( solved_method);
+        solved_params.set_boundary( solved_boundary);
+        calc_next( solved_params, sheet_params);
+        return;
+    }
+    p_conductivity_sheet_ = sheet_params.get_conductivity_sheet( );
+    p_velocity_sheet_     = input_params.is_technique__wave_leapfrog( ) ? sheet_params.get_velocity_sheet( ) : 0;
+    d_assert( implies( input_params.is_technique__wave_leapfrog( ), (0 != p_velocity_sheet_)));
+
     // Initialize the output params. We will set them as we go along.
     output_params_.reset( );
 
+    // Free the memory held for techniques we are not using now.
+    clear_technique_memory( input_params.get_technique( ));
+
     sheet_type const &  src_sheet    = sheet_params.ref_src_sheet( );
     sheet_type       &  trg_sheet    = sheet_params.ref_trg_sheet( );
     sheet_type       &  extra_sheet  = sheet_params.ref_extra_sheet( );
 
+    // The quiet tiles from the last solve are only good if this solve starts where it left off.
+    // Otherwise every tile is solved in the first pass.
+    tile_activity_type * p_tiles = 0;
+    if ( ! is_tile_skipping_possible( input_params, sheet_params) ) {
+        tile_activity_.clear( );
+    } else {
+        if ( (! input_params.is_src_from_last_solve( )) ||
+             (! tile_activity_.is_sized( src_sheet.get_x_count( ), src_sheet.get_y_count( ))) )
+        {
+            tile_activity_.wake_all( src_sheet.get_x_count( ), src_sheet.get_y_count( ));
+        }
+        p_tiles = & tile_activity_;
+    }
+
     // Interpret input_params and sheet_params as intuitive choices.
     bool const  is_multi_pass               = input_params.has_extra_passes( ) && ! input_params.are_extra_passes_disabled( );
     bool const  is_one_pass                 = ! is_multi_pass;
@@ -322,6 +518,7 @@ calc_next
     }
 
     // If we are solving the wave equation using the extra sheet we have to set up history.
+    // The leapfrog wave keeps its history in the velocity sheet, so it doesn't need this.
     //
     // We need the following assumtion because we are testing is_odd( extra_pass_count):
     //   d_assert( extra_pass_count >= 0)
@@ -351,6 +548,22 @@ calc_next
             //   extra -> trg  -- ok
             extra_sheet = src_sheet;
         }
+        if ( p_tiles ) {
+            p_tiles->forget_sheets( );
+        }
+    }
+
+    // Forward-diff heat solves can take the sheet thru all the passes a band at a time, which
+    // keeps the band in the cache. The results are the same as solving pass by pass.
+    // The spectral technique jumps straight to the last generation.
+    if ( is_multi_pass && is_extra_used ) {
+        if ( maybe_calc_next_spectral_jump( input_params, src_sheet, trg_sheet, extra_sheet) ) {
+            return;
+        }
+        // Blocking solves every cell, so we don't block when skipping quiet tiles.
+        if ( (0 == p_tiles) && maybe_calc_next_temporal_blocked( input_params, src_sheet, trg_sheet, extra_sheet) ) {
+            return;
+        }
     }
 
     // Solve repeatedly if extra solve passes are requested.
@@ -369,12 +582,15 @@ calc_next
         calc_next_pass
          (  input_params.get_technique( )
           , input_params.get_method( )
+          , input_params.get_boundary( )
           , input_params.is_method_parallel( )
           , input_params.get_damping( )
           , input_params.get_rate_x( )
           , input_params.get_rate_y( )
           , *p_src_sheet
           , trg_sheet_this_pass
+          , p_tiles
+          , 0
          );
         p_src_sheet = & trg_sheet_this_pass;
     }
@@ -414,39 +630,199 @@ calc_next
     }
 
     // Do the last-pass solve.
-    // For the last pass we always solve into the trg_sheet.
+    // For the last pass we always solve into the trg_sheet, and gather the stats for it.
     if ( is_early_exit( ) ) return;
     output_params_.inc_solve_count( );
     calc_next_pass
      (  input_params.get_technique( )
       , input_params.get_method( )
+      , input_params.get_boundary( )
       , input_params.is_method_parallel( )
       , input_params.get_damping( )
       , input_params.get_rate_x( )
       , input_params.get_rate_y( )
       , *p_src_sheet
       , trg_sheet
+      , p_tiles
+      , & output_params_.ref_sheet_stats( )
+     );
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  bool
+  basic_solver_type< SHEET_TYPE >::
+is_tile_skipping_possible
+ (  input_params_type const &  input_params
+  , sheet_params_type const &  sheet_params
+ ) const
+  // Quiet tiles are skipped by the 5-point forward-diff solves (heat and wave) with insulated
+  // edges, when the passes do not have to be split into sub-steps.
+{
+    return
+        input_params.is_skipping_quiet_tiles( ) &&
+        (input_params.is_technique__simultaneous_2d( ) || input_params.is_technique__wave_with_damping( )) &&
+        input_params.is_method__forward_diff( ) &&
+        input_params.is_boundary__insulated( ) &&
+        (! sheet_params.are_src_trg_sheets_same( )) &&
+        (1 == get_stable_sub_step_count
+               (  input_params.get_technique( ), input_params.get_method( )
+                , input_params.get_rate_x( ), input_params.get_rate_y( )
+               ));
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  bool
+  basic_solver_type< SHEET_TYPE >::
+maybe_calc_next_temporal_blocked
+ (  input_params_type const &  input_params
+  , sheet_type        const &  src_sheet
+  , sheet_type              &  trg_sheet
+  , sheet_type              &  extra_sheet
+ )
+  // Does all the passes (extra_pass_count + 1) of a multi-pass solve, and leaves the sheets
+  // the way the pass-by-pass loop in calc_next(..) does:
+  //   trg_sheet holds the last generation.
+  //   extra_sheet holds the next-to-last generation (history).
+  //
+  // Returns false, without doing anything, if the solve cannot be blocked or if it's not worth it.
+  // Only forward-diff heat solves (simultaneous 2d) with insulated edges and no conductivity
+  // map can be blocked, and only if we don't have to split or clamp the passes.
+{
+    if ( p_conductivity_sheet_ ) return false;
+    if ( ! input_params.is_technique__simultaneous_2d( ) ) return false;
+    if ( input_params.get_method( ) != e_forward_diff ) return false;
+    if ( ! input_params.is_boundary__insulated( ) ) return false;
+
+    rate_type const full_damping = 1;
+    if ( (get_stable_sub_step_count
+           (  e_simultaneous_2d, e_forward_diff
+            , input_params.get_rate_x( ), input_params.get_rate_y( )
+           ) > 1) ||
+         is_out_of_bounds_fix_needed
+          (  e_simultaneous_2d, e_forward_diff
+           , full_damping, input_params.get_rate_x( ), input_params.get_rate_y( )
+          ) )
+    {
+        return false;
+    }
+
+    // Roughly the size of an L2 cache. Each band's two scratch buffers should fit in here.
+    size_type const  cache_byte_count  = 1024 * 1024;
+    size_type const  x_count           = src_sheet.get_x_count( );
+    size_type const  y_count           = src_sheet.get_y_count( );
+    size_type const  generation_count  = input_params.get_extra_pass_count( ) + 1;
+    size_type const  band_row_count    =
+        get_forward_diff_2d_blocked_band_row_count
+         ( x_count, y_count, generation_count, cache_byte_count, sizeof( value_type));
+    if ( 0 == band_row_count ) return false;
+
+    d_assert( (& src_sheet) != (& trg_sheet));
+    d_assert( (& src_sheet) != (& extra_sheet));
+    d_assert( (& trg_sheet) != (& extra_sheet));
+    d_assert( (x_count == trg_sheet.get_x_count( )) && (y_count == trg_sheet.get_y_count( )));
+    d_assert( (x_count == extra_sheet.get_x_count( )) && (y_count == extra_sheet.get_y_count( )));
+
+    clear_buffers( ); // forward-diff doesn't need buffers -- free their alloc'd memory
+    calc_next_2d_forward_diff_blocked
+     (  output_params_.ref_early_exit( )
+      , input_params.is_method_parallel( )
+      , rate_type( input_params.get_rate_x( )), rate_type( input_params.get_rate_y( ))
+      , x_count, y_count
+      , generation_count, band_row_count
+      , src_sheet.begin( ), trg_sheet.begin( ), extra_sheet.begin( )
+     );
+    if ( is_early_exit( ) ) return true;
+
+    // The bands do not keep the last generation around long enough to gather stats as they go,
+    // and nothing here clamps, so the stats are left empty.
+
+    for ( size_type count = 0 ; count < generation_count ; ++ count ) {
+        output_params_.inc_solve_count( );
+    }
+    output_params_.set__is_last_solve_saved_in_extra( );
+    return true;
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  bool
+  basic_solver_type< SHEET_TYPE >::
+maybe_calc_next_spectral_jump
+ (  input_params_type const &  input_params
+  , sheet_type        const &  src_sheet
+  , sheet_type              &  trg_sheet
+  , sheet_type              &  extra_sheet
+ )
+  // Does all the passes (extra_pass_count + 1) of a multi-pass spectral solve at once, and
+  // leaves the sheets the way the pass-by-pass loop in calc_next(..) does.
+  //
+  // Returns false, without doing anything, if this is not the spectral technique.
+{
+    if ( ! input_params.is_technique__spectral_jump( ) ) return false;
+
+    size_type const  generation_count  = input_params.get_extra_pass_count( ) + 1;
+    calc_next_spectral_jump
+     (  input_params.get_method( ), input_params.is_method_parallel( )
+      , input_params.get_rate_x( ), input_params.get_rate_y( )
+      , generation_count
+      , src_sheet, trg_sheet, & extra_sheet
+     );
+    if ( is_early_exit( ) ) return true;
+
+    // calc_next_spectral_jump(..) splits the generations into stable sub-steps if necessary.
+    size_type const  sub_step_count  =
+        get_stable_sub_step_count
+         ( e_spectral_jump, input_params.get_method( ), input_params.get_rate_x( ), input_params.get_rate_y( ));
+    rate_type const  count           = rate_type( sub_step_count);
+    rate_type const  clamp_limit     =
+        get_clamp_limit
+         (  e_spectral_jump, input_params.get_method( )
+          , input_params.get_damping( ), input_params.get_rate_x( ) / count, input_params.get_rate_y( ) / count
+         );
+    output_params_.note_sub_steps( sub_step_count, 0);
+    clamp_and_measure_sheet
+     (  input_params.is_method_parallel( ), clamp_limit
+      , & output_params_.ref_sheet_stats( ), trg_sheet
      );
+    for ( size_type count = 0 ; count < generation_count ; ++ count ) {
+        output_params_.inc_solve_count( );
+    }
+    output_params_.set__is_last_solve_saved_in_extra( );
+    return true;
 }
 
 // _______________________________________________________________________________________________
 
+  template< typename SHEET_TYPE >
   void
-  solver_type::
+  basic_solver_type< SHEET_TYPE >::
 calc_next_pass
  (  technique_type      technique
   , method_type         method
+  , boundary_type       boundary
   , bool                is_parallel_method
   , rate_type           damping
   , rate_type           rate_x
   , rate_type           rate_y
   , sheet_type const &  src_sheet
   , sheet_type       &  trg_sheet
+  , tile_activity_type *
+                        p_tiles
+  , sheet_stats_type *  p_stats
  )
   // Instead of dealing with sheet_type this could start with these src/trg objects:
   //   stride_range< src_iter_type, 1 >  src_range
   //   stride_range< trg_iter_type, 1 >  trg_range
   // See swap_xy( range_xy) -> range_yx
+  //
+  // If p_tiles is not zero the pass skips the quiet tiles, and updates them.
+  // If p_stats is not zero it gets the stats for trg_sheet when the pass is finished, or is
+  // left empty if the pass doesn't measure as it goes (see calc_next_pass_once(..)).
 {
     d_assert( 0 != & src_sheet);
     d_assert( 0 != & trg_sheet);
@@ -456,6 +832,63 @@ calc_next_pass
     // The two sheets must be different (unless technique == e_ortho_interleave).
     d_assert( implies( (technique != e_ortho_interleave), ((& src_sheet) != (& trg_sheet)) ));
 
+    // Split the pass into sub-steps if the rates are past the stability limit.
+    // The spectral technique splits the pass itself, since sub-steps cost it nothing.
+    size_type const sub_step_count = get_stable_sub_step_count( technique, method, rate_x, rate_y);
+    d_assert( implies( (0 != p_tiles), (1 == sub_step_count)));
+    if ( (sub_step_count > 1) && (technique != e_spectral_jump) ) {
+        calc_next_pass_in_sub_steps
+         (  technique, method, boundary, is_parallel_method
+          , damping, rate_x, rate_y, sub_step_count
+          , src_sheet, trg_sheet
+          , p_stats
+         );
+    } else {
+        output_params_.note_sub_steps( sub_step_count, 0);
+        if ( sub_step_sheet_a_.not_reset( ) ) {
+            sub_step_sheet_a_.reset( );
+            sub_step_sheet_b_.reset( );
+        }
+        rate_type const count = rate_type( sub_step_count);
+        calc_next_pass_once
+         (  technique, method, boundary, is_parallel_method
+          , damping, rate_x, rate_y
+          , src_sheet, trg_sheet
+          , p_tiles
+          , get_clamp_limit( technique, method, damping, rate_x / count, rate_y / count)
+          , p_stats
+         );
+    }
+}
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+calc_next_pass_once
+ (  technique_type      technique
+  , method_type         method
+  , boundary_type       boundary
+  , bool                is_parallel_method
+  , rate_type           damping
+  , rate_type           rate_x
+  , rate_type           rate_y
+  , sheet_type const &  src_sheet
+  , sheet_type       &  trg_sheet
+  , tile_activity_type *
+                        p_tiles
+  , rate_type           clamp_limit
+  , sheet_stats_type *  p_stats
+ )
+  // One solve with the rates as given, without checking stability.
+  //
+  // Only the simultaneous 2d and wave solves skip quiet tiles (if p_tiles is not zero).
+  //
+  // If clamp_limit is not zero the results are clamped to [-clamp_limit, +clamp_limit]. The
+  // forward-diff kernels clamp as they go (see calc_next_wave_with_damping(..)). The other
+  // techniques clamp after the solve with clamp_and_measure_sheet(..). Stats (if p_stats)
+  // are gathered the same way, so an unclamped solve by one of the other techniques leaves
+  // them empty.
+{
     if ( not_early_exit( ) ) {
         if ( technique == e_ortho_interleave ) {
             // This works even if src_sheet and trg_sheet are the same.
@@ -467,30 +900,216 @@ calc_next_pass
         } else
         if ( technique == e_simultaneous_2d ) {
             calc_next_simultaneous_2d
+             (  method, boundary, is_parallel_method
+              , rate_x, rate_y
+              , src_sheet, trg_sheet
+              , p_tiles, clamp_limit, p_stats
+             );
+            return;
+        } else
+        if ( technique == e_implicit_multigrid ) {
+            calc_next_implicit_multigrid
+             (  method, boundary, is_parallel_method
+              , rate_x, rate_y
+              , src_sheet, trg_sheet
+             );
+        } else
+        if ( technique == e_spectral_jump ) {
+            calc_next_spectral_jump
              (  method, is_parallel_method
+              , rate_x, rate_y, 1
+              , src_sheet, trg_sheet, 0
+             );
+        } else
+        if ( technique == e_super_time_step ) {
+            calc_next_super_time_step
+             (  method, boundary, is_parallel_method
               , rate_x, rate_y
               , src_sheet, trg_sheet
              );
         } else
+        if ( technique == e_wave_leapfrog ) {
+            d_assert( 0 == p_tiles);
+            calc_next_wave_with_damping
+             (  method, boundary, is_parallel_method
+              , damping, rate_x, rate_y
+              , src_sheet, trg_sheet, p_velocity_sheet_
+              , 0, clamp_limit, p_stats
+             );
+            return;
+        } else
         /* technique == e_wave_with_damping */ {
             d_assert( technique == e_wave_with_damping);
             calc_next_wave_with_damping
-             (  method, is_parallel_method
+             (  method, boundary, is_parallel_method
               , damping, rate_x, rate_y
-              , src_sheet, trg_sheet
+              , src_sheet, trg_sheet, 0
+              , p_tiles, clamp_limit, p_stats
              );
+            return;
         }
     }
+    if ( not_early_exit( ) && (clamp_limit != 0) ) {
+        clamp_and_measure_sheet( is_parallel_method, clamp_limit, p_stats, trg_sheet);
+    }
+}
 
-    if ( not_early_exit( ) ) {
-        fix_out_of_bounds_if_necessary( technique, method, damping, rate_x, rate_y, trg_sheet);
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+calc_next_pass_in_sub_steps
+ (  technique_type      technique
+  , method_type         method
+  , boundary_type       boundary
+  , bool                is_parallel_method
+  , rate_type           damping
+  , rate_type           rate_x
+  , rate_type           rate_y
+  , size_type           sub_step_count
+  , sheet_type const &  src_sheet
+  , sheet_type       &  trg_sheet
+  , sheet_stats_type *  p_stats
+ )
+  // Solves sub_step_count steps, each with rate/sub_step_count. Together they cover the same
+  // time as one step with the full rates.
+  //
+  // The first two sub-steps give an error estimate (see calc_step_error_estimate(..)). If it's
+  // too big we start over with twice as many sub-steps, a couple of times at most.
+  //
+  // The first two sub-steps never write to trg_sheet, so we can start over even when solving
+  // in place.
+{
+    d_assert( sub_step_count > 1);
+    d_assert( technique != e_wave_with_damping);
+    d_assert( technique != e_wave_leapfrog);
+
+    size_type const  x_count  = src_sheet.get_x_count( );
+    size_type const  y_count  = src_sheet.get_y_count( );
+    if ( (sub_step_sheet_a_.get_x_count( ) != x_count) || (sub_step_sheet_a_.get_y_count( ) != y_count) ) {
+        d_verify( sub_step_sheet_a_.set_xy_counts( x_count, y_count, 0));
+        d_verify( sub_step_sheet_b_.set_xy_counts( x_count, y_count, 0));
+    }
+
+    rate_type   sub_rate_x      = 0;
+    rate_type   sub_rate_y      = 0;
+    value_type  error_estimate  = 0;
+    for ( size_type refine_count = 0 ; ; refine_count += 1 ) {
+        sub_rate_x = rate_x / rate_type( sub_step_count);
+        sub_rate_y = rate_y / rate_type( sub_step_count);
+
+        calc_next_pass_once
+         (  technique, method, boundary, is_parallel_method, damping, sub_rate_x, sub_rate_y
+          , src_sheet, sub_step_sheet_a_, 0, 0, 0
+         );
+        calc_next_pass_once
+         (  technique, method, boundary, is_parallel_method, damping, sub_rate_x, sub_rate_y
+          , sub_step_sheet_a_, sub_step_sheet_b_, 0, 0, 0
+         );
+        if ( is_early_exit( ) ) return;
+
+        error_estimate = calc_step_error_estimate( src_sheet, sub_step_sheet_a_, sub_step_sheet_b_);
+        if ( (error_estimate <= get_step_error_tolerance( )) ||
+             (refine_count >= size_type( e_max_error_refine_count)) ||
+             ((2 * sub_step_count) > size_type( e_max_sub_step_count)) )
+        {
+            break;
+        }
+        sub_step_count *= 2;
+    }
+    output_params_.note_sub_steps( sub_step_count, error_estimate);
+
+    // Only clamps if we ran into e_max_sub_step_count.
+    rate_type const clamp_limit = get_clamp_limit( technique, method, damping, sub_rate_x, sub_rate_y);
+
+    // The rest of the sub-steps go back and forth between the two sheets, and the last one
+    // goes into trg_sheet. Only the last one is clamped and measured.
+    sheet_type * p_src_sheet = & sub_step_sheet_b_;
+    for ( size_type step = 2 ; step < sub_step_count ; step += 1 ) {
+        if ( is_early_exit( ) ) return;
+        bool const is_last_step = ((step + 1) == sub_step_count);
+        sheet_type & trg_sheet_this_step =
+            is_last_step ? trg_sheet :
+            ((p_src_sheet == & sub_step_sheet_a_) ? sub_step_sheet_b_ : sub_step_sheet_a_);
+        calc_next_pass_once
+         (  technique, method, boundary, is_parallel_method, damping, sub_rate_x, sub_rate_y
+          , *p_src_sheet, trg_sheet_this_step
+          , 0
+          , is_last_step ? clamp_limit : rate_type( 0)
+          , is_last_step ? p_stats : 0
+         );
+        p_src_sheet = & trg_sheet_this_step;
+    }
+    if ( 2 == sub_step_count ) {
+        trg_sheet = sub_step_sheet_b_;
+        if ( clamp_limit != 0 ) {
+            clamp_and_measure_sheet( is_parallel_method, clamp_limit, p_stats, trg_sheet);
+        }
     }
 }
 
+  /* static */
+  template< typename SHEET_TYPE >
+  typename basic_solver_type< SHEET_TYPE >::value_type
+  basic_solver_type< SHEET_TYPE >::
+calc_step_error_estimate
+ (  sheet_type const &  sheet_0
+  , sheet_type const &  sheet_1
+  , sheet_type const &  sheet_2
+ )
+  // Three generations, one sub-step apart. For a heat step S (linear), the one-step error is
+  // about half the second difference in time:
+  //   (sheet_2 - 2*sheet_1 + sheet_0) / 2
+  // For forward and backward diff that is (S - 1)^2 applied to sheet_0, which is the
+  // (rate * Laplacian)^2 / 2 term the method drops. Central diff is more accurate, so this
+  // over-estimates its error.
+{
+    value_type max_error = 0;
+    typename sheet_type::const_iterator  iter_0  = sheet_0.begin( );
+    typename sheet_type::const_iterator  iter_1  = sheet_1.begin( );
+    typename sheet_type::const_iterator  iter_2  = sheet_2.begin( );
+    for ( ; iter_0 != sheet_0.end( ) ; ++ iter_0, ++ iter_1, ++ iter_2 ) {
+        value_type const error = std::fabs( (*iter_2 - (2 * (*iter_1)) + *iter_0) / 2);
+        if ( error > max_error ) max_error = error;
+    }
+    return max_error;
+}
+
+  /* static */
+  template< typename SHEET_TYPE >
+  typename basic_solver_type< SHEET_TYPE >::size_type
+  basic_solver_type< SHEET_TYPE >::
+get_stable_sub_step_count
+ (  technique_type  technique
+  , method_type     method
+  , rate_type       rate_x
+  , rate_type       rate_y
+ )
+  // How many sub-steps a pass needs so each sub-step is stable. One means no split.
+  // See get_stable_rate_fraction(..) for the stability limits.
+  //
+  // Central diff solved with 1D passes overshoots and rings past its limit, which clamping the
+  // sheet used to hide.
+  //
+  // We don't split wave solves (the history in the trg sheet would be wrong, and each leapfrog
+  // step moves the velocity along) or negative rates (no step is small enough).
+  // get_clamp_limit(..) still deals with those.
+{
+    if ( (technique == e_wave_with_damping) || (technique == e_wave_leapfrog) ) return 1;
+    if ( (rate_x < 0) || (rate_y < 0) ) return 1;
+
+    double const fraction = get_stable_rate_fraction( technique, method, rate_x, rate_y);
+    if ( fraction < 1 ) return 1;
+
+    // The smallest count where (fraction / count) < 1.
+    double const count = std::floor( fraction) + 1;
+    return (count >= double( e_max_sub_step_count)) ? size_type( e_max_sub_step_count) : size_type( count);
+}
+
 // _______________________________________________________________________________________________
 
-  solve_1d_functor_type const &
-  solver_type::
+  template< typename SHEET_TYPE >
+  typename basic_solver_type< SHEET_TYPE >::solve_1d_functor_type const &
+  basic_solver_type< SHEET_TYPE >::
 get_1d_functor( method_type method, bool is_parallel_method) const
 {
     if ( is_parallel_method ) {
@@ -498,20 +1117,25 @@ get_1d_functor( method_type method, bool is_parallel_method) const
           case e_central_diff  : return central_diff_parallel_functor_;
           case e_backward_diff : return backward_diff_parallel_functor_;
           case e_forward_diff  : return forward_diff_parallel_functor_;
+          case e_forward_diff_9_point   :
+          case e_forward_diff_4th_order : break; /* see get_solved_method(..) */
         }
     } else {
         switch ( method ) {
           case e_central_diff  : return central_diff_serial_functor_;
           case e_backward_diff : return backward_diff_serial_functor_;
           case e_forward_diff  : return forward_diff_serial_functor_;
+          case e_forward_diff_9_point   :
+          case e_forward_diff_4th_order : break; /* see get_solved_method(..) */
         }
     }
     d_assert( false);
     return forward_diff_serial_functor_;
 }
 
+  template< typename SHEET_TYPE >
   void
-  solver_type::
+  basic_solver_type< SHEET_TYPE >::
 ensure_buffer_size
  (  solve_1d_functor_type
                      const &  calc_1d_functor
@@ -540,8 +1164,9 @@ ensure_buffer_size
     }
 }
 
+  template< typename SHEET_TYPE >
   void
-  solver_type::
+  basic_solver_type< SHEET_TYPE >::
 clear_buffers( )
   //
   // Frees all the memory allocated for the buffers.
@@ -553,26 +1178,208 @@ clear_buffers( )
         util::apply_default_ctor( & buf_b_);
         util::apply_default_ctor( & buf_a_);
     }
+    if ( not_early_exit( ) && (column_strip_src_.size( ) > 0) ) {
+        util::apply_dtor( & column_strip_src_);
+        util::apply_dtor( & column_strip_trg_);
+        util::apply_default_ctor( & column_strip_trg_);
+        util::apply_default_ctor( & column_strip_src_);
+    }
+    if ( not_early_exit( ) && (varying_buf_a_.size( ) > 0) ) {
+        util::apply_dtor( & varying_buf_a_);
+        util::apply_dtor( & varying_buf_b_);
+        util::apply_default_ctor( & varying_buf_b_);
+        util::apply_default_ctor( & varying_buf_a_);
+    }
+    if ( not_early_exit( ) ) {
+        implicit_matrices_.clear( );
+    }
 }
 
-// _______________________________________________________________________________________________
-
+  template< typename SHEET_TYPE >
   void
-  solver_type::
-calc_next_ortho_interleave
- (  method_type         method
-  , bool                is_parallel_method
-  , rate_type           x_rate
-  , rate_type           y_rate
-  , sheet_type const &  src_sheet
-  , sheet_type       &  trg_sheet
+  basic_solver_type< SHEET_TYPE >::
+calc_1d_functor_on_columns
+ (  method_type               method
+  , bool                      is_parallel_method
+  , solve_1d_functor_type
+                     const &  calc_1d_functor
+  , rate_type                 damping
+  , rate_type                 rate
+  , sheet_type       const &  src_sheet
+  , sheet_type             &  trg_sheet
  )
   //
-  // Solve the 2D sheet as two perpendicular 1D solves.
+  // The y pass. Same as:
+  //   calc_1d_functor( damping, rate, src_sheet.get_range_xy( ), trg_sheet.get_range_xy( ))
+  // src_sheet and trg_sheet can be the same sheet.
+  //
+  // When the sheet is too big for the cache we solve a strip of columns at a time, copied into
+  // rows so the functor walks memory in order (see calc_next_1d_columns_by_strip(..)).
+  //
+  // Backward and central diff can do better. They solve a strip of columns together in vector
+  // lanes, right in the sheet, when there are kernels for this CPU (see finite_diff_simd.h).
+{
+    // Roughly the size of an L2 cache. The two strips should fit in here.
+    size_type const  cache_byte_count  = 1024 * 1024;
+    size_type const  x_count           = src_sheet.get_x_count( );
+    size_type const  y_count           = src_sheet.get_y_count( );
+    size_type const  strip_count       =
+        get_column_strip_count( x_count, y_count, cache_byte_count, sizeof( value_type));
+
+    if ( (method == e_backward_diff) || (method == e_central_diff) ) {
+        d_assert( (x_count == trg_sheet.get_x_count( )) && (y_count == trg_sheet.get_y_count( )));
+        rate_type const base = (method == e_central_diff) ? 2 : 1;
+        if ( try_calc_next_1d_columns_in_lanes
+              (  output_params_.ref_early_exit( ), is_parallel_method
+               , base, damping, rate
+               , x_count, y_count, strip_count
+               , src_sheet.begin( ), 0, trg_sheet.begin( )
+               , column_strip_src_
+              ) )
+        {
+            return;
+        }
+    }
+
+    if ( 0 == strip_count ) {
+        calc_1d_functor( damping, rate, src_sheet.get_range_xy( ), trg_sheet.get_range_xy( ));
+    } else {
+        d_assert( (x_count == trg_sheet.get_x_count( )) && (y_count == trg_sheet.get_y_count( )));
+        calc_next_1d_columns_by_strip
+         (  calc_1d_functor
+          , damping, rate
+          , x_count, y_count, strip_count
+          , src_sheet.begin( ), trg_sheet.begin( )
+          , column_strip_src_, column_strip_trg_
+         );
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+calc_1d_varying_on_rows
+ (  method_type               method
+  , bool                      is_parallel_method
+  , rate_type                 damping
+  , rate_type                 rate
+  , sheet_type       const &  src_sheet
+  , sheet_type             &  trg_sheet
+ )
+  //
+  // The x pass of a backward or central diff solve with the conductivity map. Same as
+  // calc_1d_functor( damping, rate, src_sheet.get_range_yx( ), trg_sheet.get_range_yx( )) but
+  // with a rate for each face.
+{
+    d_assert( p_conductivity_sheet_);
+    d_assert( (method == e_backward_diff) || (method == e_central_diff));
+    calc_next_1d_implicit_varying
+     (  output_params_.ref_early_exit( ), is_parallel_method
+      , rate_type( (method == e_central_diff) ? 2 : 1), damping, rate
+      , src_sheet.get_range_yx( ), p_conductivity_sheet_->get_range_yx( ), trg_sheet.get_range_yx( )
+      , varying_buf_a_, varying_buf_b_
+     );
+}
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+calc_1d_varying_on_columns
+ (  method_type               method
+  , bool                      is_parallel_method
+  , rate_type                 damping
+  , rate_type                 rate
+  , sheet_type       const &  src_sheet
+  , sheet_type             &  trg_sheet
+ )
+  //
+  // The y pass. The column kernels solve a strip of columns together in vector lanes when they
+  // can, like calc_1d_functor_on_columns(..). Otherwise we walk down the columns.
+{
+    d_assert( p_conductivity_sheet_);
+    d_assert( (method == e_backward_diff) || (method == e_central_diff));
+    size_type const  x_count  = src_sheet.get_x_count( );
+    size_type const  y_count  = src_sheet.get_y_count( );
+    rate_type const  base     = (method == e_central_diff) ? 2 : 1;
+
+    // Roughly the size of an L2 cache, as in calc_1d_functor_on_columns(..).
+    size_type const  cache_byte_count  = 1024 * 1024;
+    size_type const  strip_count       =
+        get_column_strip_count( x_count, y_count, cache_byte_count, sizeof( value_type));
+    if ( try_calc_next_1d_columns_in_lanes
+          (  output_params_.ref_early_exit( ), is_parallel_method
+           , base, damping, rate
+           , x_count, y_count, strip_count
+           , src_sheet.begin( )
+           , finite_difference::simd::get_contiguous_float_ptr( p_conductivity_sheet_->begin( ))
+           , trg_sheet.begin( )
+           , column_strip_src_
+          ) )
+    {
+        return;
+    }
+    calc_next_1d_implicit_varying
+     (  output_params_.ref_early_exit( ), is_parallel_method
+      , base, damping, rate
+      , src_sheet.get_range_xy( ), p_conductivity_sheet_->get_range_xy( ), trg_sheet.get_range_xy( )
+      , varying_buf_a_, varying_buf_b_
+     );
+}
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+calc_next_ortho_interleave
+ (  method_type         method
+  , bool                is_parallel_method
+  , rate_type           x_rate
+  , rate_type           y_rate
+  , sheet_type const &  src_sheet
+  , sheet_type       &  trg_sheet
+ )
+  //
+  // Solve the 2D sheet as two perpendicular 1D solves.
   //
   // This is used with forward, backward, and central diff, both serial and parellel.
   // We only use this to solve the heat equation, not the wave equation.
+  //
+  // With a conductivity map, forward diff solves each direction with the 2d kernel and one of
+  // the rates zero. That kernel reads the rows above and below, so it cannot solve in place,
+  // and the x pass goes to a sheet of its own. Backward and central diff solve in place like
+  // the 1d functors do.
 {
+    if ( p_conductivity_sheet_ ) {
+        rate_type const damping = finite_difference::get_no_init_damping_set_value< rate_type >( );
+        if ( method == e_forward_diff ) {
+            size_type const  x_count  = src_sheet.get_x_count( );
+            size_type const  y_count  = src_sheet.get_y_count( );
+            if ( (varying_pass_sheet_.get_x_count( ) != x_count) || (varying_pass_sheet_.get_y_count( ) != y_count) ) {
+                d_verify( varying_pass_sheet_.set_xy_counts( x_count, y_count, 0));
+            }
+            calc_next_simultaneous_2d
+             (  e_forward_diff, e_boundary_insulated, is_parallel_method
+              , x_rate, 0
+              , src_sheet, varying_pass_sheet_, 0, 0, 0
+             );
+            if ( not_early_exit( ) ) {
+                calc_next_simultaneous_2d
+                 (  e_forward_diff, e_boundary_insulated, is_parallel_method
+                  , 0, y_rate
+                  , varying_pass_sheet_, trg_sheet, 0, 0, 0
+                 );
+            }
+        } else {
+            calc_1d_varying_on_rows( method, is_parallel_method, damping, x_rate, src_sheet, trg_sheet);
+            if ( not_early_exit( ) ) {
+                // trg holds the results of the x pass.
+                calc_1d_varying_on_columns( method, is_parallel_method, damping, y_rate, trg_sheet, trg_sheet);
+            }
+        }
+        return;
+    }
+
     // Get the appropriate 1d functor.
     solve_1d_functor_type const & calc_1d_functor = get_1d_functor( method, is_parallel_method);
     ensure_buffer_size( calc_1d_functor, src_sheet.get_x_count( ), src_sheet.get_y_count( ));
@@ -586,11 +1393,17 @@ calc_next_ortho_interleave
         calc_1d_functor( damping, x_rate, src_sheet.get_range_yx( ), trg_sheet.get_range_yx( ));
         if ( not_early_exit( ) && y_rate ) {
             // The 2nd calc above must be trg->trg because trg holds the results of the first calculation.
-            calc_1d_functor( damping, y_rate, trg_sheet.get_range_xy( ), trg_sheet.get_range_xy( ));
+            calc_1d_functor_on_columns
+             (  method, is_parallel_method, calc_1d_functor
+              , damping, y_rate, trg_sheet, trg_sheet
+             );
         }
     } else
     if ( y_rate ) {
-        calc_1d_functor( damping, y_rate, src_sheet.get_range_xy( ), trg_sheet.get_range_xy( ));
+        calc_1d_functor_on_columns
+         (  method, is_parallel_method, calc_1d_functor
+          , damping, y_rate, src_sheet, trg_sheet
+         );
     } else
     if ( (& src_sheet) != (& trg_sheet) ) {
         // Both x- and y-rate are zero.
@@ -599,70 +1412,162 @@ calc_next_ortho_interleave
     }
 }
 
+  template< typename SHEET_TYPE >
   void
-  solver_type::
+  basic_solver_type< SHEET_TYPE >::
 calc_next_simultaneous_2d
  (  method_type         method
+  , boundary_type       boundary
   , bool                is_parallel_method
   , rate_type           x_rate
   , rate_type           y_rate
   , sheet_type const &  src_sheet
   , sheet_type       &  trg_sheet
+  , tile_activity_type *
+                        p_tiles
+  , rate_type           clamp_limit
+  , sheet_stats_type *  p_stats
  )
 {
     // This is the same as solving the wave with full damping.
     rate_type const full_damping = 1;
     calc_next_wave_with_damping
-     (  method, is_parallel_method
+     (  method, boundary, is_parallel_method
       , full_damping, x_rate, y_rate
-      , src_sheet, trg_sheet
+      , src_sheet, trg_sheet, 0
+      , p_tiles, clamp_limit, p_stats
      );
 }
 
+  template< typename SHEET_TYPE >
   void
-  solver_type::
+  basic_solver_type< SHEET_TYPE >::
 calc_next_wave_with_damping
  (  method_type         method
+  , boundary_type       boundary
   , bool                is_parallel_method
   , rate_type           damping
   , rate_type           x_rate
   , rate_type           y_rate
   , sheet_type const &  src_sheet
   , sheet_type       &  trg_sheet
+  , sheet_type       *  p_velocity_sheet
+  , tile_activity_type *
+                        p_tiles
+  , rate_type           clamp_limit
+  , sheet_stats_type *  p_stats
  )
+  //
+  // If p_velocity_sheet is zero trg_sheet holds the older generation coming in. Otherwise this
+  // solves the leapfrog wave, which moves the velocity along instead (see "Leapfrog wave" in
+  // finite_diff.h). Only forward diff solves the leapfrog wave.
+  //
+  // If p_tiles is not zero the 5-point forward-diff solve skips the quiet tiles (see
+  // tile_activity_type in finite_diff_solver.h), and records which tiles are still changing.
+  //
+  // If clamp_limit is not zero the results are clamped to [-clamp_limit, +clamp_limit].
+  // Forward diff clamps each value as it stores it, in the same (parallel) pass as the solve.
+  // The two-pass backward and central solves cannot clamp until the 2nd pass has summed into
+  // trg_sheet, so they clamp afterwards with clamp_and_measure_sheet(..).
+  //
+  // If p_stats is not zero it gets the stats for trg_sheet. Forward diff gathers them a row at
+  // a time, right after each row is solved, and we add the rows up at the end. Backward and
+  // central diff only gather them while clamping, and otherwise leave them empty.
 {
     // Damping cannot be one of the special values. Those are only used to make the
     // mixing algorithms work.
     d_assert( damping != finite_difference::get_no_init_damping_set_value< rate_type >( ));
     d_assert( damping != finite_difference::get_no_init_damping_sum_value< rate_type >( ));
 
-    // We solve forward-diff with 2-d functions instead the 1-d functors for all the others.
-    if ( method == e_forward_diff ) {
+    // We solve forward-diff (with any stencil) with 2-d functions instead the 1-d functors for
+    // all the others.
+    if ( (method == e_forward_diff) ||
+         (method == e_forward_diff_9_point) ||
+         (method == e_forward_diff_4th_order) )
+    {
         clear_buffers( ); // forward-diff doesn't need buffers -- free their alloc'd memory
-
+        finite_difference::stencil_type const stencil =
+            (method == e_forward_diff_9_point  ) ? finite_difference::e_stencil_9_point   :
+            (method == e_forward_diff_4th_order) ? finite_difference::e_stencil_4th_order :
+                                                   finite_difference::e_stencil_5_point   ;
+        finite_difference::boundary_type const fd_boundary =
+            (boundary == e_boundary_fixed    ) ? finite_difference::e_boundary_fixed     :
+            (boundary == e_boundary_periodic ) ? finite_difference::e_boundary_periodic  :
+            (boundary == e_boundary_absorbing) ? finite_difference::e_boundary_absorbing :
+                                                 finite_difference::e_boundary_insulated ;
+
+        // One stats object for each row in the yx range (range_1 is y).
+        size_type          const  row_count    = src_sheet.get_y_count( );
+        sheet_stats_type * const  p_row_stats  = p_stats ? get_row_stats( row_count) : 0;
+
+        // The conductivity map, if there is one, walks along with the src rows.
+        typedef conductivity_sheet_type::yx_const_range_type coef_range_type;
+        coef_range_type const  coef_range    =
+            p_conductivity_sheet_ ? p_conductivity_sheet_->get_range_yx( ) : coef_range_type( );
+        coef_range_type const * const
+                               p_coef_range  = p_conductivity_sheet_ ? (& coef_range) : 0;
+
+        // The velocity, if there is one, also walks along with the src rows.
+        typedef typename sheet_type::yx_varia_range_type velocity_range_type;
+        velocity_range_type const  velocity_range    =
+            p_velocity_sheet ? p_velocity_sheet->get_range_yx( ) : velocity_range_type( );
+        velocity_range_type const * const
+                                   p_velocity_range  = p_velocity_sheet ? (& velocity_range) : 0;
+
+        d_assert( implies( (0 != p_tiles),
+            (stencil == finite_difference::e_stencil_5_point) &&
+            (fd_boundary == finite_difference::e_boundary_insulated) &&
+            (0 == p_velocity_sheet) ));
+        if ( p_tiles ) {
+            p_tiles->start_pass( & src_sheet, & trg_sheet, float( get_quiet_tile_tolerance( )));
+        }
         if ( is_parallel_method ) {
             // We don't use a functor for 2d forward diff. Instead we have two functions:
             // one for serial and one for parallel.
             // We have to pass in all the state since we don't have a functor to wrap it up for us.
             calc_next_2d_forward_diff_parallel
              (  output_params_.ref_early_exit( )
+              , stencil
+              , fd_boundary
               , damping, x_rate, y_rate
               , src_sheet.get_range_yx( )
               , trg_sheet.get_range_yx( )
+              , p_coef_range
+              , p_tiles
+              , p_velocity_range
+              , clamp_limit
+              , p_row_stats
              );
         } else {
             // The serial (not parallel) 2d forward-diff function.
             calc_next_2d_forward_diff_serial
              (  output_params_.ref_early_exit( )
+              , stencil
+              , fd_boundary
               , damping, x_rate, y_rate
               , src_sheet.get_range_yx( )
               , trg_sheet.get_range_yx( )
+              , p_coef_range
+              , p_tiles
+              , p_velocity_range
+              , clamp_limit
+              , p_row_stats
              );
         }
+        if ( not_early_exit( ) && p_tiles ) {
+            p_tiles->finish_pass( );
+        }
+        if ( not_early_exit( ) && p_stats ) {
+            add_row_stats( row_count, *p_stats);
+        }
     } else
     /* central or backward diff */ {
+        d_assert( 0 == p_tiles);
+        d_assert( 0 == p_velocity_sheet);
         // We use the 1d functors. The damping params tell them how we're using them.
+        // They only know insulated edges (see get_solved_boundary(..)).
         d_assert( (method == e_backward_diff) || (method == e_central_diff));
+        d_assert( boundary == e_boundary_insulated);
 
         // Get the appropriate 1d functor.
         solve_1d_functor_type const & calc_1d_functor = get_1d_functor( method, is_parallel_method);
@@ -680,25 +1585,356 @@ calc_next_wave_with_damping
         // dimension first? Although it probably doesn't matter at all.
 
         // We could just copy if (damping==1) and (x_rate==0) and (y_rate==0).
-        calc_1d_functor( damping_1st_pass, x_rate, src_sheet.get_range_yx( ), trg_sheet.get_range_yx( ));
-        if ( not_early_exit( ) ) {
-            // 2nd-pass damping says use +=.
-            calc_1d_functor( damping_2nd_pass, y_rate, src_sheet.get_range_xy( ), trg_sheet.get_range_xy( ));
+        if ( p_conductivity_sheet_ ) {
+            calc_1d_varying_on_rows( method, is_parallel_method, damping_1st_pass, x_rate, src_sheet, trg_sheet);
+            if ( not_early_exit( ) ) {
+                calc_1d_varying_on_columns( method, is_parallel_method, damping_2nd_pass, y_rate, src_sheet, trg_sheet);
+            }
+        } else {
+            calc_1d_functor( damping_1st_pass, x_rate, src_sheet.get_range_yx( ), trg_sheet.get_range_yx( ));
+            if ( not_early_exit( ) ) {
+                // 2nd-pass damping says use +=.
+                calc_1d_functor_on_columns
+                 (  method, is_parallel_method, calc_1d_functor
+                  , damping_2nd_pass, y_rate, src_sheet, trg_sheet
+                 );
+            }
+        }
+        if ( not_early_exit( ) && (clamp_limit != 0) ) {
+            clamp_and_measure_sheet( is_parallel_method, clamp_limit, p_stats, trg_sheet);
+        }
+    }
+}
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+calc_next_implicit_multigrid
+ (  method_type         method
+  , boundary_type       boundary
+  , bool                is_parallel_method
+  , rate_type           x_rate
+  , rate_type           y_rate
+  , sheet_type const &  src_sheet
+  , sheet_type       &  trg_sheet
+ )
+  //
+  // Solves the whole 2D implicit system instead of splitting it into row and column solves.
+  // See multigrid.h.
+  //
+  // Backward diff solves (1 - rate*L) trg = src.
+  // Central diff (Crank-Nicolson) solves (1 - (rate/2)*L) trg = (1 + (rate/2)*L) src, and the
+  // right side is a forward-diff solve with half the rates.
+  // Forward diff is explicit, so there is no system to solve. It is the same as simultaneous 2d.
+{
+    d_assert( (& src_sheet) != (& trg_sheet));
+
+    if ( method == e_forward_diff ) {
+        calc_next_simultaneous_2d( method, boundary, is_parallel_method, x_rate, y_rate, src_sheet, trg_sheet, 0, 0, 0);
+        return;
+    }
+    d_assert( (method == e_backward_diff) || (method == e_central_diff));
+    clear_buffers( ); // multigrid doesn't use the 1d buffers
+
+    // The solve starts from the values in trg_sheet. The last generation is a good guess.
+    trg_sheet = src_sheet;
+
+    if ( method == e_backward_diff ) {
+        multigrid_.solve
+         (  output_params_.ref_early_exit( ), is_parallel_method
+          , x_rate, y_rate
+          , src_sheet, trg_sheet
+         );
+    } else {
+        rate_type const  half_x_rate  = x_rate / 2;
+        rate_type const  half_y_rate  = y_rate / 2;
+        d_verify( multigrid_rhs_.set_xy_counts( src_sheet.get_x_count( ), src_sheet.get_y_count( ), 0));
+        calc_next_simultaneous_2d
+         (  e_forward_diff, boundary, is_parallel_method
+          , half_x_rate, half_y_rate
+          , src_sheet, multigrid_rhs_, 0, 0, 0
+         );
+        if ( is_early_exit( ) ) return;
+        multigrid_.solve
+         (  output_params_.ref_early_exit( ), is_parallel_method
+          , half_x_rate, half_y_rate
+          , multigrid_rhs_, trg_sheet
+         );
+    }
+}
+
+  namespace /* anonymous */ {
+  template< typename RATE_TYPE >
+  struct
+spectral_gain_functor_type
+  //
+  // The gain of one cosine mode after generation_count generations.
+  // x_eigen and y_eigen come from spectral::cosine_transform_type< .. >::get_eigen(..).
+{
+    spectral_gain_functor_type
+     (  method_type  method
+      , RATE_TYPE    x_rate
+      , RATE_TYPE    y_rate
+      , double       generation_count
+     )
+      : method_           ( method           )
+      , x_rate_           ( x_rate           )
+      , y_rate_           ( y_rate           )
+      , generation_count_ ( generation_count )
+      { }
+      method_type  const  method_           ;
+      double       const  x_rate_           ;
+      double       const  y_rate_           ;
+      double       const  generation_count_ ;
+
+      RATE_TYPE
+    operator ()( RATE_TYPE x_eigen, RATE_TYPE y_eigen) const
+      {
+        double const  decay  = (x_rate_ * x_eigen) + (y_rate_ * y_eigen);
+        double        gain   = 1;
+        if ( method_ == e_forward_diff ) {
+            gain = 1 - decay;
+        } else
+        if ( method_ == e_backward_diff ) {
+            gain = 1 / (1 + decay);
+        } else
+        /* central diff (Crank-Nicolson) */ {
+            d_assert( method_ == e_central_diff);
+            gain = (1 - (decay / 2)) / (1 + (decay / 2));
         }
+        // pow(..) is fine with a negative gain because generation_count is a whole number.
+        return static_cast< RATE_TYPE >( std::pow( gain, generation_count_));
+      }
+};
+  } /* end namespace anonymous */
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+calc_next_spectral_jump
+ (  method_type         method
+  , bool                is_parallel_method
+  , rate_type           x_rate
+  , rate_type           y_rate
+  , size_type           generation_count
+  , sheet_type const &  src_sheet
+  , sheet_type       &  trg_sheet
+  , sheet_type       *  p_next_to_last_sheet
+ )
+  //
+  // Solves generation_count generations of 2D heat in one step, with a cosine transform
+  // (see spectral.h). The result is what the simultaneous 2D technique would get for forward
+  // diff, and what the multigrid technique would get for backward and central diff.
+  //
+  // If p_next_to_last_sheet is not null we also restore generation (generation_count - 1) there.
+  //
+  // If the rates are past the stability limit each generation is split into stable sub-steps,
+  // which only changes the gains.
+{
+    d_assert( (& src_sheet) != (& trg_sheet));
+    d_assert( generation_count > 0);
+    clear_buffers( ); // the transform doesn't use the 1d buffers
+
+    size_type const  sub_step_count  = get_stable_sub_step_count( e_spectral_jump, method, x_rate, y_rate);
+    rate_type const  sub_x_rate      = x_rate / rate_type( sub_step_count);
+    rate_type const  sub_y_rate      = y_rate / rate_type( sub_step_count);
+    double    const  steps_per_gen   = double( sub_step_count);
+
+    spectral_.transform( is_parallel_method, src_sheet);
+    spectral_.restore
+     (  spectral_gain_functor_type< rate_type >( method, sub_x_rate, sub_y_rate, steps_per_gen * generation_count)
+      , trg_sheet
+     );
+    if ( p_next_to_last_sheet ) {
+        spectral_.restore
+         (  spectral_gain_functor_type< rate_type >( method, sub_x_rate, sub_y_rate, steps_per_gen * (generation_count - 1))
+          , *p_next_to_last_sheet
+         );
+    }
+}
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+clear_technique_memory( technique_type in_use)
+{
+    if ( in_use != e_implicit_multigrid ) {
+        multigrid_.clear( );
+        multigrid_rhs_.reset( );
+    }
+    if ( in_use != e_spectral_jump ) {
+        spectral_.clear( );
+    }
+    if ( in_use != e_ortho_interleave ) {
+        varying_pass_sheet_.reset( );
+    }
+    if ( in_use != e_super_time_step ) {
+        for ( size_type index = 0 ; index < 3 ; index += 1 ) {
+            super_stage_sheets_[ index ].reset( );
+        }
+        super_stage_diff_0_.reset( );
     }
 }
 
 // _______________________________________________________________________________________________
 
+  /* static */
+  template< typename SHEET_TYPE >
+  typename basic_solver_type< SHEET_TYPE >::size_type
+  basic_solver_type< SHEET_TYPE >::
+get_super_stage_count
+ (  rate_type  rate_x
+  , rate_type  rate_y
+ )
+  // An s-stage RKL2 step is stable for (s*s + s - 2)/4 times the forward-diff limit, and the
+  // forward-diff limit is (rate_x + rate_y) < 1/2. So we want the smallest s (at least 2) with
+  //   (s*s + s - 2) >= 8 * (rate_x + rate_y)
+{
+    double const  need   = 8 * (double( rate_x) + double( rate_y));
+    double const  root   = std::ceil( (std::sqrt( 9 + (4 * need)) - 1) / 2);
+    size_type     count  = (root < 2) ? 2 : ((root > e_max_super_stage_count) ? size_type( e_max_super_stage_count) : size_type( root));
+    if ( (count < size_type( e_max_super_stage_count)) && (double( (count * count) + count - 2) < need) ) {
+        count += 1; /* in case ceil(..) rounded down */
+    }
+    return count;
+}
+
+  namespace /* anonymous */ {
+  inline
+  double
+get_rkl2_b( std::size_t j)
+  // RKL2 coefficients: b0 = b1 = b2 = 1/3, bj = (j*j + j - 2) / (2*j*(j + 1)).
+{
+    if ( j < 3 ) return 1.0 / 3;
+    double const d = double( j);
+    return ((d * d) + d - 2) / (2 * d * (d + 1));
+}
+  } /* end namespace anonymous */
+
+  template< typename SHEET_TYPE >
   void
-  solver_type::
-fix_out_of_bounds_if_necessary
+  basic_solver_type< SHEET_TYPE >::
+calc_next_super_time_step
+ (  method_type         method
+  , boundary_type       boundary
+  , bool                is_parallel_method
+  , rate_type           x_rate
+  , rate_type           y_rate
+  , sheet_type const &  src_sheet
+  , sheet_type       &  trg_sheet
+ )
+  //
+  // Runge-Kutta-Legendre (RKL2) super-time-stepping, built on the 2D forward-diff stencil.
+  // Meyer, Balsara and Aslam, "A stabilized Runge-Kutta-Legendre method for explicit
+  // super-time-stepping of parabolic and mixed equations", J. Comp. Phys. 257 (2014).
+  //
+  // One step with the full rates is s stages, where each stage is a forward-diff solve with
+  // a fraction of the rates plus a linear mix of earlier stages:
+  //   Y0 = src
+  //   Y1 = Y0 + m~1 D(Y0)
+  //   Yj = mj Y(j-1) + nj Y(j-2) + (1 - mj - nj) Y0 + m~j D(Y(j-1)) + g~j D(Y0)     j = 2..s
+  //   trg = Ys
+  // where D(Y) is the change one forward-diff step with the full rates makes to Y. The stable
+  // step grows as s*s, so big rates only cost about sqrt(8 * (rate_x + rate_y)) stencils.
+  //
+  // Only forward diff is explicit. Backward and central diff solve like simultaneous 2d.
+{
+    d_assert( (& src_sheet) != (& trg_sheet));
+    if ( method != e_forward_diff ) {
+        calc_next_simultaneous_2d( method, boundary, is_parallel_method, x_rate, y_rate, src_sheet, trg_sheet, 0, 0, 0);
+        return;
+    }
+
+    size_type const  x_count      = src_sheet.get_x_count( );
+    size_type const  y_count      = src_sheet.get_y_count( );
+    size_type const  stage_count  = get_super_stage_count( x_rate, y_rate);
+    for ( size_type index = 0 ; index < 3 ; index += 1 ) {
+        if ( (super_stage_sheets_[ index ].get_x_count( ) != x_count) ||
+             (super_stage_sheets_[ index ].get_y_count( ) != y_count) )
+        {
+            d_verify( super_stage_sheets_[ index ].set_xy_counts( x_count, y_count, 0));
+        }
+    }
+    if ( (super_stage_diff_0_.get_x_count( ) != x_count) || (super_stage_diff_0_.get_y_count( ) != y_count) ) {
+        d_verify( super_stage_diff_0_.set_xy_counts( x_count, y_count, 0));
+    }
+
+    // D(Y0), the forward-diff change with the full rates.
+    calc_next_simultaneous_2d( e_forward_diff, boundary, is_parallel_method, x_rate, y_rate, src_sheet, super_stage_diff_0_, 0, 0, 0);
+    if ( is_early_exit( ) ) return;
+    {   typename sheet_type::const_iterator  src_iter  = src_sheet.begin( );
+        for ( typename sheet_type::iterator iter = super_stage_diff_0_.begin( ) ; iter != super_stage_diff_0_.end( ) ; ++ iter, ++ src_iter ) {
+            *iter -= *src_iter;
+        }
+    }
+
+    double const  s_double  = double( stage_count);
+    double const  w1        = 4 / ((s_double * s_double) + s_double - 2);
+
+    sheet_type const *  p_prev_2  = & src_sheet;
+    sheet_type const *  p_prev_1  = & src_sheet;
+    for ( size_type j = 1 ; j <= stage_count ; j += 1 ) {
+        if ( is_early_exit( ) ) break;
+        sheet_type & stage_sheet = (j == stage_count) ? trg_sheet : super_stage_sheets_[ j % 3 ];
+
+        if ( j == 1 ) {
+            double const mu_tilde_1 = get_rkl2_b( 1) * w1;
+            calc_next_simultaneous_2d
+             (  e_forward_diff, boundary, is_parallel_method
+              , rate_type( mu_tilde_1 * x_rate), rate_type( mu_tilde_1 * y_rate)
+              , src_sheet, stage_sheet, 0, 0, 0
+             );
+        } else {
+            double const  b_j       = get_rkl2_b( j);
+            double const  b_j_1     = get_rkl2_b( j - 1);
+            double const  b_j_2     = get_rkl2_b( j - 2);
+            double const  mu        = ((2.0 * j) - 1) / j * (b_j / b_j_1);
+            double const  nu        = - (double( j) - 1) / j * (b_j / b_j_2);
+            double const  mu_tilde  = mu * w1;
+            double const  gam_tilde = - (1 - b_j_1) * mu_tilde;
+
+            // stage = Y(j-1) + m~j D(Y(j-1)), then mix in the rest.
+            calc_next_simultaneous_2d
+             (  e_forward_diff, boundary, is_parallel_method
+              , rate_type( mu_tilde * x_rate), rate_type( mu_tilde * y_rate)
+              , *p_prev_1, stage_sheet, 0, 0, 0
+             );
+            if ( is_early_exit( ) ) break;
+
+            value_type const  c_prev_1  = value_type( mu - 1);
+            value_type const  c_prev_2  = value_type( nu);
+            value_type const  c_src     = value_type( 1 - mu - nu);
+            value_type const  c_diff_0  = value_type( gam_tilde);
+            typename sheet_type::const_iterator  prev_1_iter  = p_prev_1->begin( );
+            typename sheet_type::const_iterator  prev_2_iter  = p_prev_2->begin( );
+            typename sheet_type::const_iterator  src_iter     = src_sheet.begin( );
+            typename sheet_type::const_iterator  diff_0_iter  = super_stage_diff_0_.begin( );
+            for ( typename sheet_type::iterator iter = stage_sheet.begin( )
+                ; iter != stage_sheet.end( )
+                ; ++ iter, ++ prev_1_iter, ++ prev_2_iter, ++ src_iter, ++ diff_0_iter )
+            {
+                *iter += (c_prev_1 * (*prev_1_iter)) + (c_prev_2 * (*prev_2_iter)) +
+                         (c_src * (*src_iter)) + (c_diff_0 * (*diff_0_iter));
+            }
+        }
+
+        p_prev_2 = p_prev_1;
+        p_prev_1 = & stage_sheet;
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  /* static */
+  template< typename SHEET_TYPE >
+  typename basic_solver_type< SHEET_TYPE >::rate_type
+  basic_solver_type< SHEET_TYPE >::
+get_clamp_limit
  (  technique_type  technique
   , method_type     method
   , rate_type       damping
   , rate_type       rate_x
   , rate_type       rate_y
-  , sheet_type &    trg_sheet
  )
   // This tries to keep the sheet from exploding when we're experimenting with unstable
   // solvers. Some of the solvers are unstable when you give them rates outside of a specific
@@ -706,16 +1942,38 @@ fix_out_of_bounds_if_necessary
   //
   // This is not perfect, particularly with the wave equation which can probably produce very
   // large sheet values even under somewhat normal conditions.
+  //
+  // Heat passes past the stability limit are split into stable sub-steps before we get here
+  // (see get_stable_sub_step_count(..)), and we're called with the sub-step rates. So in normal
+  // operation this only clamps wave solves and negative rates.
+  //
+  // Returns zero if the pass does not need clamping. Otherwise the pass should clamp its
+  // results to [-limit, +limit].
+{
+    return is_out_of_bounds_fix_needed( technique, method, damping, rate_x, rate_y) ?
+        get_out_of_bounds_limit( ) : rate_type( 0);
+}
+
+  /* static */
+  template< typename SHEET_TYPE >
+  bool
+  basic_solver_type< SHEET_TYPE >::
+is_out_of_bounds_fix_needed
+ (  technique_type  technique
+  , method_type     method
+  , rate_type       damping
+  , rate_type       rate_x
+  , rate_type       rate_y
+ )
 {
     bool needs_correction = false;
 
     // Look for the obvious cases where the values in the sheet might grow very large.
-    // There are probably some cases I missed. Maybe limits should be built into the solve
-    // functions themselves and always applied. That way they could be run in parallel.
+    // There are probably some cases I missed.
     if ( (rate_x < 0) || (rate_y < 0) ) {
         needs_correction = true;
     } else
-    if ( (technique == e_wave_with_damping) &&
+    if ( ((technique == e_wave_with_damping) || (technique == e_wave_leapfrog)) &&
          ( (damping < 0) /* illegal damping (accelerating) */ ||
            (damping > 1) /* illegal damping (negative momentum?) */ ||
            (damping < 0.3) /* kludge rule because we can get the sheet to blow up */
@@ -730,71 +1988,499 @@ fix_out_of_bounds_if_necessary
         // Later: 
         needs_correction = true;
     } else
-    if ( (method != e_backward_diff) &&
-         ( (rate_x >= 0.5) || (rate_y >= 0.5) ||
-           ( (technique != e_ortho_interleave) && ((rate_x + rate_y) >= 0.5)
-       ) ) )
-    {
+    if ( get_stable_rate_fraction( technique, method, rate_x, rate_y) >= 1 ) {
         // The central-diff solver doesn't blow up as readily as the forward-diff.
         // I've never seen it blow up with the ortho-interleave technique, but I have with
         // the simultaneous technique.
         needs_correction = true;
     }
 
-    // Clamp the values in the sheet to some large +/- value.
-    if ( needs_correction ) {
-        fix_severely_out_of_bounds_sheet( trg_sheet);
-    }
+    return needs_correction;
 }
 
+  namespace /* anonymous */ {
+  template< typename VALUE_TYPE >
+  struct
+clamp_and_measure_rows_functor_type
+  //
+  // Clamps a group of rows to [-limit, +limit] (unless limit is zero), and gathers the stats
+  // for each row (unless p_row_stats is zero). The clamp tests match assign3_clamp_type<..> in
+  // finite_diff.h, so a NaN becomes +limit.
+{
+    typedef std::pair< std::size_t, std::size_t >  row_group_type; /* [y_lo, y_hi_plus) */
+
+    clamp_and_measure_rows_functor_type
+     (  VALUE_TYPE *        p_values
+      , std::size_t const   x_count
+      , VALUE_TYPE  const   limit
+      , sheet_stats_type *  p_row_stats
+     )
+      : p_values_    ( p_values    )
+      , x_count_     ( x_count     )
+      , is_clamp_    ( limit != 0  )
+      , lo_          ( - limit     )
+      , hi_          ( limit       )
+      , p_row_stats_ ( p_row_stats )
+      { }
+      VALUE_TYPE *        const  p_values_    ;
+      std::size_t         const  x_count_     ;
+      bool                const  is_clamp_    ;
+      VALUE_TYPE          const  lo_          ;
+      VALUE_TYPE          const  hi_          ;
+      sheet_stats_type *  const  p_row_stats_ ;
+
+      void
+    operator ()( row_group_type const & y_lo_hi_plus) const
+      {
+        for ( std::size_t y = y_lo_hi_plus.first ; y < y_lo_hi_plus.second ; ++ y ) {
+            VALUE_TYPE * const  p_row        = p_values_ + (y * x_count_);
+            VALUE_TYPE * const  p_row_limit  = p_row + x_count_;
+            if ( is_clamp_ ) {
+                for ( VALUE_TYPE * p_value = p_row ; p_value != p_row_limit ; ++ p_value ) {
+                    VALUE_TYPE value = *p_value;
+                    value = (value < hi_) ? value : hi_;
+                    value = (value > lo_) ? value : lo_;
+                    *p_value = value;
+                }
+            }
+            if ( p_row_stats_ ) {
+                p_row_stats_[ y ].clear( );
+                p_row_stats_[ y ].add_values( p_row, p_row_limit);
+            }
+        }
+      }
+};
+  } /* end namespace anonymous */
+
+  template< typename SHEET_TYPE >
   void
-  solver_type::
-fix_severely_out_of_bounds_sheet( sheet_type & trg_sheet)
+  basic_solver_type< SHEET_TYPE >::
+clamp_and_measure_sheet
+ (  bool                is_parallel
+  , rate_type           clamp_limit
+  , sheet_stats_type *  p_stats
+  , sheet_type       &  trg_sheet
+ )
+  // Clamps the sheet to [-clamp_limit, +clamp_limit] and sets *p_stats (unless p_stats is
+  // zero), in one trip thru the sheet. This is for the solves that cannot clamp and measure as
+  // they go. The forward-diff kernels do both while they solve.
   //
-  // This is like a sheet-transforming functor, and should probably be integrated into
-  // the solvers so it can calculate off-thread (and maybe even in parallel).
-{
-    // We need a way to do this in a worker thread (and ideally parallel) without
-    // incrementing the generation count. So this either needs to be integrated into
-    // the solvers, or we need to have a general way to queue worker-thread instructions.
-
-    value_type const normal_min = -1;
-    value_type const normal_max = +1;
-    value_type const normal_mid =  0;
-
-    // We don't flatten the sheet unless it gets out of this range (except in the
-    // special case where the sheet is completely flat):
-    value_type const out_of_bounds_min = -100;
-    value_type const out_of_bounds_max = +100;
-
-    // After we're done none of the sheet values should be outside this range:
-    value_type const back_in_bounds_min = -50;
-    value_type const back_in_bounds_max = +50;
-
-    value_type min_value = 0;
-    value_type max_value = 0;
-    d_verify( trg_sheet.get_min_max_values( min_value, max_value));
-    d_assert( min_value <= max_value);
-
-    // If the sheet is flat ..
-    if ( min_value == max_value ) {
-        // If the flat value is outside the normal range ..
-        if ( (min_value < normal_min) || (max_value > normal_max) ) {
-            trg_sheet.fill_sheet( normal_mid);
+  // We never make the trip just for the stats. If clamp_limit is zero the stats are left
+  // empty, and normalize scans the sheet itself when it needs the min/max.
+{
+    d_assert( clamp_limit >= 0);
+    if ( p_stats ) p_stats->clear( );
+
+    size_type const  x_count  = trg_sheet.get_x_count( );
+    size_type const  y_count  = trg_sheet.get_y_count( );
+    if ( (0 == x_count) || (0 == y_count) ) return;
+    if ( 0 == clamp_limit ) return;
+
+    clamp_and_measure_rows_functor_type< value_type > const functor
+     (  & (* trg_sheet.begin( )), x_count, clamp_limit
+      , p_stats ? get_row_stats( y_count) : 0
+     );
+    row_pool::map_row_ranges( functor, y_count, x_count * sizeof( value_type), is_parallel);
+    if ( p_stats ) {
+        add_row_stats( y_count, *p_stats);
+    }
+}
+
+  template< typename SHEET_TYPE >
+  sheet_stats_type *
+  basic_solver_type< SHEET_TYPE >::
+get_row_stats( size_type row_count)
+  // One stats object per row, so rows solved on different threads never share one.
+{
+    d_assert( row_count > 0);
+    if ( row_stats_.size( ) < row_count ) {
+        row_stats_.resize( row_count);
+    }
+    return & row_stats_[ 0 ];
+}
+
+  template< typename SHEET_TYPE >
+  void
+  basic_solver_type< SHEET_TYPE >::
+add_row_stats
+ (  size_type           row_count
+  , sheet_stats_type &  stats
+ ) const
+  // Combines the row stats set by the last solve. This is one small step per row.
+{
+    d_assert( row_count <= row_stats_.size( ));
+    stats.clear( );
+    for ( size_type row = 0 ; row < row_count ; row += 1 ) {
+        stats.add( row_stats_[ row ]);
+    }
+}
+
+// _______________________________________________________________________________________________
+// Explicit instantiations
+//
+//   The solver methods are defined here and not in the header, so we instantiate the two
+//   solvers the worker thread uses.
+
+template class basic_solver_type< sheet_type        >;
+template class basic_solver_type< double_sheet_type >;
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// fixed_solver_type< INT_TYPE >
+
+namespace /* anonymous */ {
+
+  template< typename INT_TYPE >
+  INT_TYPE const *
+get_inner_ptr( value_sheet_type< uniform_scalar< INT_TYPE > > const & sheet)
+  // A uniform_scalar is just its inner int (see the static asserts in uniform_scalar.h), so the
+  // sheet is an array of ints.
+{
+    return reinterpret_cast< INT_TYPE const * >( & (* sheet.begin( )));
+}
+
+  template< typename INT_TYPE >
+  INT_TYPE *
+get_inner_ptr( value_sheet_type< uniform_scalar< INT_TYPE > > & sheet)
+{
+    return reinterpret_cast< INT_TYPE * >( & (* sheet.begin( )));
+}
+
+} /* end anonymous namespace */
+
+  /* static */
+  template< typename INT_TYPE >
+  bool
+  fixed_solver_type< INT_TYPE >::
+can_solve( input_params_type const & input_params)
+{
+    if ( ! input_params.is_technique__simultaneous_2d( ) ) return false;
+    if ( ! input_params.is_method__forward_diff( ) ) return false;
+    if ( ! input_params.is_boundary__insulated( ) ) return false;
+
+    // The rates must be inside the forward-diff stability limit, 2 * (rate_x + rate_y) < 1,
+    // after they are rounded to fixed point. The kernel sums cannot overflow inside that limit.
+    if ( (input_params.get_rate_x( ) < 0) || (input_params.get_rate_y( ) < 0) ) return false;
+    typedef typename value_type::int_wide_type wide_type;
+    wide_type const rate_x = value_type::convert_from_real( input_params.get_rate_x( ));
+    wide_type const rate_y = value_type::convert_from_real( input_params.get_rate_y( ));
+    return (2 * (rate_x + rate_y)) < value_type::get_int_wide_one( );
+}
+
+  template< typename INT_TYPE >
+  void
+  fixed_solver_type< INT_TYPE >::
+calc_next
+ (  input_params_type const &  input_params
+  , sheet_params_type const &  sheet_params
+ )
+  // Like basic_solver_type::calc_next(..), but simpler because we only solve simultaneous 2d,
+  // which cannot solve in place. A multi-pass solve always uses the extra sheet, and the passes
+  // alternate between extra and trg so extra ends up with the history.
+{
+    // Initialize the output params. We will set them as we go along.
+    output_params_.reset( );
+    d_assert( can_solve( input_params));
+    d_assert( ! sheet_params.are_src_trg_sheets_same( ));
+    d_assert( 0 == sheet_params.get_conductivity_sheet( ));
+
+    sheet_type const &  src_sheet    = sheet_params.ref_src_sheet( );
+    sheet_type       &  trg_sheet    = sheet_params.ref_trg_sheet( );
+    sheet_type       &  extra_sheet  = sheet_params.ref_extra_sheet( );
+
+    bool const  is_multi_pass  = input_params.has_extra_passes( ) && ! input_params.are_extra_passes_disabled( );
+    if ( is_multi_pass ) {
+        if ( sheet_params.maybe_size_extra_sheet( ) ) {
+            output_params_.set__was_extra_sized( );
         }
+        output_params_.set__was_extra_used( );
     } else
-    if ( min_value < out_of_bounds_min ) {
-        trg_sheet.normalize(
-            back_in_bounds_min,
-            std::max( normal_mid, std::min( back_in_bounds_max, max_value)));
+    if ( input_params.is_extra_sheet_to_be_reset_if_not_used( ) ) {
+        extra_sheet.reset( );
+    }
+
+    int_type const  rate_x       = value_type::convert_from_real( input_params.get_rate_x( ));
+    int_type const  rate_y       = value_type::convert_from_real( input_params.get_rate_y( ));
+    bool const      is_parallel  = input_params.is_method_parallel( );
+
+    d_static_assert( boost::is_unsigned< size_type >::value);
+    sheet_type const * p_src_sheet = & src_sheet;
+    for ( size_type countdown = is_multi_pass ? input_params.get_extra_pass_count( ) : 0 ; ; -- countdown ) {
+        if ( is_early_exit( ) ) return;
+        output_params_.inc_solve_count( );
+
+        sheet_type & trg_sheet_this_pass = util::is_odd( countdown) ? extra_sheet : trg_sheet;
+        calc_next_2d_forward_diff_fixed
+         (  output_params_.ref_early_exit( )
+          , is_parallel
+          , rate_x
+          , rate_y
+          , trg_sheet.get_x_count( )
+          , trg_sheet.get_y_count( )
+          , get_inner_ptr( *p_src_sheet)
+          , get_inner_ptr( trg_sheet_this_pass)
+         );
+        p_src_sheet = & trg_sheet_this_pass;
+
+        if ( 0 == countdown ) break;
+    }
+
+    if ( is_multi_pass ) {
+        output_params_.set__is_last_solve_saved_in_extra( );
+    } else {
+        output_params_.set__is_last_solve_saved_in_src( );
+    }
+}
+
+template class fixed_solver_type< boost::int16_t >;
+template class fixed_solver_type< boost::int32_t >;
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// half_solver_type
+
+namespace /* anonymous */ {
+
+  half_float_type const *
+get_inner_ptr( half_sheet_type const & sheet)
+{
+    return & (* sheet.begin( ));
+}
+
+  half_float_type *
+get_inner_ptr( half_sheet_type & sheet)
+{
+    return & (* sheet.begin( ));
+}
+
+} /* end anonymous namespace */
+
+  /* static */
+  bool
+  half_solver_type::
+can_solve( input_params_type const & input_params)
+{
+    if ( ! input_params.is_technique__simultaneous_2d( ) ) return false;
+    if ( ! input_params.is_method__forward_diff( ) ) return false;
+    if ( ! input_params.is_boundary__insulated( ) ) return false;
+
+    // The rates must be inside the forward-diff stability limit, (rate_x + rate_y) < 1/2.
+    if ( (input_params.get_rate_x( ) < 0) || (input_params.get_rate_y( ) < 0) ) return false;
+    return
+      get_stable_rate_fraction
+       (  input_params.get_technique( )
+        , input_params.get_method( )
+        , input_params.get_rate_x( )
+        , input_params.get_rate_y( )
+       ) < 1;
+}
+
+  void
+  half_solver_type::
+calc_next
+ (  input_params_type const &  input_params
+  , sheet_params_type const &  sheet_params
+ )
+  // Same as fixed_solver_type::calc_next(..), with the half-float kernel.
+{
+    // Initialize the output params. We will set them as we go along.
+    output_params_.reset( );
+    d_assert( can_solve( input_params));
+    d_assert( ! sheet_params.are_src_trg_sheets_same( ));
+    d_assert( 0 == sheet_params.get_conductivity_sheet( ));
+
+    sheet_type const &  src_sheet    = sheet_params.ref_src_sheet( );
+    sheet_type       &  trg_sheet    = sheet_params.ref_trg_sheet( );
+    sheet_type       &  extra_sheet  = sheet_params.ref_extra_sheet( );
+
+    bool const  is_multi_pass  = input_params.has_extra_passes( ) && ! input_params.are_extra_passes_disabled( );
+    if ( is_multi_pass ) {
+        if ( sheet_params.maybe_size_extra_sheet( ) ) {
+            output_params_.set__was_extra_sized( );
+        }
+        output_params_.set__was_extra_used( );
+    } else
+    if ( input_params.is_extra_sheet_to_be_reset_if_not_used( ) ) {
+        extra_sheet.reset( );
+    }
+
+    float const  rate_x       = static_cast< float >( input_params.get_rate_x( ));
+    float const  rate_y       = static_cast< float >( input_params.get_rate_y( ));
+    bool const   is_parallel  = input_params.is_method_parallel( );
+
+    d_static_assert( boost::is_unsigned< size_type >::value);
+    sheet_type const * p_src_sheet = & src_sheet;
+    for ( size_type countdown = is_multi_pass ? input_params.get_extra_pass_count( ) : 0 ; ; -- countdown ) {
+        if ( is_early_exit( ) ) return;
+        output_params_.inc_solve_count( );
+
+        sheet_type & trg_sheet_this_pass = util::is_odd( countdown) ? extra_sheet : trg_sheet;
+        calc_next_2d_forward_diff_half
+         (  output_params_.ref_early_exit( )
+          , is_parallel
+          , rate_x
+          , rate_y
+          , trg_sheet.get_x_count( )
+          , trg_sheet.get_y_count( )
+          , get_inner_ptr( *p_src_sheet)
+          , get_inner_ptr( trg_sheet_this_pass)
+         );
+        p_src_sheet = & trg_sheet_this_pass;
+
+        if ( 0 == countdown ) break;
+    }
+
+    if ( is_multi_pass ) {
+        output_params_.set__is_last_solve_saved_in_extra( );
+    } else {
+        output_params_.set__is_last_solve_saved_in_src( );
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// shadow_sheets_type< SHEET_TYPE >
+
+  template< typename SHEET_TYPE >
+  void
+  shadow_sheets_type< SHEET_TYPE >::
+attach
+ (  sheet_type const &  src_sheet
+  , sheet_type const &  trg_sheet
+  , sheet_type const &  extra_sheet
+  , sheet_type const *  p_velocity_sheet
+ )
+  //
+  // Matches a shadow to each of the float sheets.
+  //
+  // The sheet control swaps the float sheets around from one generation to the next, so we find
+  // the shadow for each sheet by looking for the one that still rounds to that sheet's values.
+  // We only reload a shadow from its float sheet (losing the extra precision) if none match,
+  // which happens when the sheet is changed outside the solver (by the user for example).
+{
+    bool const                is_in_place      = ((& src_sheet) == (& trg_sheet));
+    sheet_type const * const  p_sheets[ 3 ]    = { & src_sheet, & trg_sheet, & extra_sheet };
+    bool                      is_taken[ 3 ]    = { false, false, false };
+    for ( int sheet_index = 0 ; sheet_index < 3 ; ++ sheet_index ) {
+        shadow_indexes_[ sheet_index ] = -1;
+    }
+
+    // Look for the shadows that still match their sheets.
+    for ( int sheet_index = 0 ; sheet_index < 3 ; ++ sheet_index ) {
+        if ( is_in_place && (1 == sheet_index) ) continue;
+        for ( int index = 0 ; index < 3 ; ++ index ) {
+            if ( (! is_taken[ index ]) && shadows_[ index ].is_rounded_same( *p_sheets[ sheet_index ]) ) {
+                is_taken[ index ]               = true;
+                shadow_indexes_[ sheet_index ]  = index;
+                break;
+            }
+        }
+    }
+
+    // Reload the others from the float sheets.
+    for ( int sheet_index = 0 ; sheet_index < 3 ; ++ sheet_index ) {
+        if ( is_in_place && (1 == sheet_index) ) continue;
+        if ( shadow_indexes_[ sheet_index ] < 0 ) {
+            int index = 0;
+            while ( is_taken[ index ] ) { ++ index; }
+            d_assert( index < 3);
+            is_taken[ index ]               = true;
+            shadow_indexes_[ sheet_index ]  = index;
+            shadows_[ index ].copy_from( *p_sheets[ sheet_index ]);
+        }
+    }
+    if ( is_in_place ) { shadow_indexes_[ 1 ] = shadow_indexes_[ 0 ]; }
+
+    // Only the leapfrog solves change the velocity, so its shadow doesn't move around.
+    is_velocity_attached_ = (0 != p_velocity_sheet);
+    if ( is_velocity_attached_ ) {
+        if ( ! velocity_shadow_.is_rounded_same( *p_velocity_sheet) ) {
+            velocity_shadow_.copy_from( *p_velocity_sheet);
+        }
     } else
-    if ( max_value > out_of_bounds_max ) {
-        trg_sheet.normalize(
-            std::min( normal_mid, std::max( back_in_bounds_min, min_value)),
-            back_in_bounds_max);
+    if ( velocity_shadow_.not_reset( ) ) {
+        velocity_shadow_.reset( );
+    }
+}
+
+  template< typename SHEET_TYPE >
+  typename shadow_sheets_type< SHEET_TYPE >::sheet_params_type
+  shadow_sheets_type< SHEET_TYPE >::
+get_sheet_params( conductivity_sheet_type const * p_conductivity_sheet)
+  //
+  // The conductivity map is float in every precision, so it does not need a shadow.
+{
+    return
+      sheet_params_type
+       (  shadows_[ shadow_indexes_[ 0 ] ]
+        , shadows_[ shadow_indexes_[ 1 ] ]
+        , shadows_[ shadow_indexes_[ 2 ] ]
+        , p_conductivity_sheet
+        , is_velocity_attached_ ? (& velocity_shadow_) : 0
+       );
+}
+
+  template< typename SHEET_TYPE >
+  void
+  shadow_sheets_type< SHEET_TYPE >::
+copy_back
+ (  sheet_type       &  trg_sheet
+  , sheet_type       &  extra_sheet
+  , sheet_type       *  p_velocity_sheet
+ ) const
+  // The solvers only write to the trg and extra sheets (and the velocity), so only they are
+  // copied back.
+{
+    shadows_[ shadow_indexes_[ 1 ] ].copy_to( trg_sheet  );
+    shadows_[ shadow_indexes_[ 2 ] ].copy_to( extra_sheet);
+    if ( p_velocity_sheet ) {
+        d_assert( is_velocity_attached_);
+        velocity_shadow_.copy_to( *p_velocity_sheet);
+    }
+}
+
+  template< typename SHEET_TYPE >
+  void
+  shadow_sheets_type< SHEET_TYPE >::
+release( )
+{
+    for ( int index = 0 ; index < 3 ; ++ index ) {
+        shadows_[ index ].reset( );
+    }
+    velocity_shadow_.reset( );
+}
+
+template class shadow_sheets_type< double_sheet_type  >;
+template class shadow_sheets_type< fixed16_sheet_type >;
+template class shadow_sheets_type< fixed32_sheet_type >;
+template class shadow_sheets_type< half_sheet_type    >;
+
+namespace /* anonymous */ {
+
+  template< typename SOLVER_TYPE, typename SHADOW_SHEET_TYPE >
+  void
+calc_next_in_shadows
+ (  SOLVER_TYPE                            &  solver
+  , shadow_sheets_type< SHADOW_SHEET_TYPE > &  shadows
+  , input_params_type                const &  input_params
+  , sheet_type                       const &  src_sheet
+  , sheet_type                             &  trg_sheet
+  , sheet_type                             &  extra_sheet
+  , conductivity_sheet_type const *           p_conductivity_sheet
+  , sheet_type                             *  p_velocity_sheet
+ )
+{
+    shadows.attach( src_sheet, trg_sheet, extra_sheet, p_velocity_sheet);
+    solver.calc_next( input_params, shadows.get_sheet_params( p_conductivity_sheet));
+
+    // Pass the results back in the float sheets. Leave them alone if the solve was abandoned.
+    if ( ! solver.is_early_exit( ) ) {
+        shadows.copy_back( trg_sheet, extra_sheet, p_velocity_sheet);
     }
 }
 
+} /* end anonymous namespace */
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 // worker_thread_type
@@ -803,27 +2489,50 @@ fix_severely_out_of_bounds_sheet( sheet_type & trg_sheet)
 
   /* constructor */
   worker_thread_type::
-worker_thread_type( QObject *  p_parent)
+worker_thread_type( QObject *  p_parent, row_pool::pool_type *  p_row_pool)
   // This manages the worker thread that does all the solving work away from the UI thread.
   // The serial solvers do all their work in this thread.
   // The parallel solvers use this thread to launch many other worker threads, and then gather
   // up the results.
   // When this thread finishes a solve it posts a message to the UI thread and waits for the
   // UI thread to use the results and maybe request further actions.
+  // Unless it is free running. Then it keeps solving for a time slice first (see free_run(..)).
   //
-  // This thread should be generalized to not just handle solves, but also handle almost any
-  // of the sheet thransforms and scans.
+  // It also runs the sheet transforms (see run_transform( )), so they don't hold up the UI
+  // thread either. It should be generalized to handle the scans too.
   //
   // This class is not used outside this file. Its decl is exposed in the header file, but only
   // because Qt requires it.
   //
   : QThread                ( p_parent)
   , init_wait_             ( 0)
+  , p_row_pool_            ( p_row_pool)
   , solver_                ( )
   , input_params_          ( )
   , p_src_sheet_           ( 0)
   , p_trg_sheet_           ( 0)
   , p_extra_sheet_         ( 0)
+  , p_conductivity_sheet_  ( 0)
+  , p_velocity_sheet_      ( 0)
+  , p_draw_buffer_         ( 0)
+  , p_transform_job_       ( 0)
+  , double_solver_         ( )
+  , fixed16_solver_        ( )
+  , fixed32_solver_        ( )
+  , half_solver_           ( )
+  , double_shadows_        ( )
+  , fixed16_shadows_       ( )
+  , fixed32_shadows_       ( )
+  , half_shadows_          ( )
+  , last_precision_        ( e_single_precision)
+  , free_run_seconds_      ( 0)
+  , is_free_run_stop_requested_( 0)
+  , free_run_sheet_        ( )
+  , free_run_output_params_( )
+  , is_free_run_output_    ( false)
+  , skipped_generation_count_( 0)
+  , last_publish_tick_     ( date_time::get_invalid_tick_pt( ))
+  , is_last_generation_published_( false)
 {
     // The constructor runs in the master thread.
     d_assert( currentThread( ) != this);
@@ -876,6 +2585,10 @@ run( )
     d_assert( 0 == p_src_sheet_  );
     d_assert( 0 == p_trg_sheet_  );
     d_assert( 0 == p_extra_sheet_);
+
+    // A transform can be left over if we quit before it started.
+    delete p_transform_job_;
+    p_transform_job_ = 0;
 }
 
 // _______________________________________________________________________________________________
@@ -887,6 +2600,11 @@ start_run__from_master_thread
   , sheet_type        const &  src_sheet
   , sheet_type              &  trg_sheet
   , sheet_type              &  extra_sheet
+  , conductivity_sheet_type const *
+                               p_conductivity_sheet
+  , sheet_type              *  p_velocity_sheet
+  , draw_buffer_type        *  p_draw_buffer
+  , double                     free_run_seconds
  )
   // Start running the worker thread.
   // The worker thread will signal when it is done.
@@ -900,15 +2618,39 @@ start_run__from_master_thread
     d_assert( 0 == p_extra_sheet_);
 
     // Setup the params for the solver.
-    input_params_  = input_params  ;
+    static_cast< input_params_type & >( input_params_) = input_params;
     p_src_sheet_   = & src_sheet   ;
     p_trg_sheet_   = & trg_sheet   ;
     p_extra_sheet_ = & extra_sheet ;
+    p_conductivity_sheet_ = p_conductivity_sheet;
+    p_velocity_sheet_     = p_velocity_sheet;
+    p_draw_buffer_        = p_draw_buffer;
+
+    // We can only free run if we can publish along the way.
+    free_run_seconds_ = p_draw_buffer ? free_run_seconds : 0;
+    is_free_run_stop_requested_.fetchAndStoreOrdered( 0);
 
     // This signal should be picked up by the worker thread.
     emit start__master_to_worker( );
 }
 
+  void
+  worker_thread_type::
+start_transform__from_master_thread( transform_job_type const * p_job)
+  // Like start_run__from_master_thread(..), but runs the job instead of a solve.
+{
+    // This is called from the master thread.
+    d_assert( currentThread( ) != this);
+    d_assert( p_job);
+
+    // This is only called if we are not running.
+    d_assert( 0 == p_src_sheet_    );
+    d_assert( 0 == p_transform_job_);
+
+    p_transform_job_ = p_job;
+    emit start__master_to_worker( );
+}
+
 // _______________________________________________________________________________________________
 
   // slot
@@ -919,18 +2661,48 @@ run__in_worker_thread( )
     // This runs in the worker thread.
     d_assert( currentThread( ) == this);
 
+    if ( p_transform_job_ ) {
+        run_transform( );
+        return;
+    }
+
     // Start the timer.
     // We'd use boost::timer here if it offered any advantage.
     tick_point_type const start_tick = date_time::get_tick_now( );
 
-    // Set up the sheet params.
-    sheet_params_type sheet_params( *p_src_sheet_, *p_trg_sheet_, *p_extra_sheet_);
-
     // Run the solver. This might be slow.
-    // And if it's parallel it might use a bunch of other worker threads.
-    solver_.calc_next( input_params_, sheet_params);
+    // And if it's parallel it maps its rows on the pool threads.
+    // When free running it keeps solving for a while, and publishes some generations on the way.
+    is_free_run_output_ = false;
+    size_type published_count = 0;
+    { row_pool::scoped_current_pool_type const use_pool( p_row_pool_);
+      calc_next_in_precision( );
+      if ( free_run_seconds_ > 0 ) {
+          published_count = free_run( start_tick);
+      } else {
+          free_run_sheet_.reset( );
+      }
+    }
+
+    // Hand the new sheet to the drawing code now, instead of waiting for the master thread to
+    // get around to it. Unless we published less than a frame ago. Then the master thread
+    // decides if the drawing code can do without it.
+    skipped_generation_count_     = 0;
+    is_last_generation_published_ = false;
+    if ( ! get_output_params( ).is_early_exit( ) ) {
+        if ( p_draw_buffer_ ) {
+            is_last_generation_published_ = maybe_publish( *p_trg_sheet_);
+        }
+        // The master thread counts the last generation if it's not drawn.
+        size_type const solve_count = get_output_params( ).get_solve_count( );
+        d_assert( solve_count > published_count);
+        skipped_generation_count_ = solve_count - published_count - 1;
+    }
 
     // We're done with the simulation. Clear the state vars.
+    p_draw_buffer_        = 0;
+    p_velocity_sheet_     = 0;
+    p_conductivity_sheet_ = 0;
     p_extra_sheet_ = 0;
     p_trg_sheet_   = 0;
     p_src_sheet_   = 0;
@@ -956,6 +2728,282 @@ run__in_worker_thread( )
     emit finished__worker_to_master( duration_in_seconds);
 }
 
+// _______________________________________________________________________________________________
+
+  void
+  worker_thread_type::
+run_transform( )
+  //
+  // The master thread started a transform instead of a solve. It doesn't touch the sheets
+  // until we report back, and the pool threads are ours until then too.
+{
+    d_assert( currentThread( ) == this);
+    d_assert( p_transform_job_);
+    d_assert( 0 == p_src_sheet_);
+
+    { row_pool::scoped_current_pool_type const use_pool( p_row_pool_);
+      p_transform_job_->run( );
+    }
+    delete p_transform_job_;
+    p_transform_job_ = 0;
+
+    // This signal is picked up by the master thread.
+    emit transform_finished__worker_to_master( );
+}
+
+// _______________________________________________________________________________________________
+
+  output_params_type const &
+  worker_thread_type::
+get_output_params( ) const
+  //
+  // After a free run these add up all its solves, unless the last solve exited early.
+{
+    output_params_type const &  last_output_params  = get_last_solve_output_params( );
+    return
+      (is_free_run_output_ && ! last_output_params.is_early_exit( )) ?
+        free_run_output_params_ :
+        last_output_params ;
+}
+
+  output_params_type const &
+  worker_thread_type::
+get_last_solve_output_params( ) const
+{
+    return
+      (e_double_precision  == last_precision_) ? double_solver_ .get_output_params( ) :
+      (e_fixed16_precision == last_precision_) ? fixed16_solver_.get_output_params( ) :
+      (e_fixed32_precision == last_precision_) ? fixed32_solver_.get_output_params( ) :
+      (e_half_precision    == last_precision_) ? half_solver_   .get_output_params( ) :
+                                                 solver_        .get_output_params( ) ;
+}
+
+  void
+  worker_thread_type::
+calc_next_in_precision( )
+  //
+  // Solves in the precision the input params ask for. Double, fixed-point and half solves
+  // happen in shadows of the float sheets, and the results are copied back.
+  //
+  // The fixed-point and half solvers only do forward-diff heat inside the stability limit,
+  // without a conductivity map. For everything else we fall back on the float solver.
+{
+    // This runs in the worker thread.
+    d_assert( currentThread( ) == this);
+
+    precision_type precision = input_params_.get_precision( );
+    bool const is_16_or_32 =
+        (e_fixed16_precision == precision) || (e_fixed32_precision == precision) || (e_half_precision == precision);
+    if ( (is_16_or_32 && p_conductivity_sheet_) ||
+         ((e_fixed16_precision == precision) && ! fixed16_solver_type::can_solve( input_params_)) ||
+         ((e_fixed32_precision == precision) && ! fixed32_solver_type::can_solve( input_params_)) ||
+         ((e_half_precision    == precision) && ! half_solver_type   ::can_solve( input_params_)) )
+    {
+        precision = e_single_precision;
+    }
+    last_precision_ = precision;
+
+    // Free the shadows we are not using, if we just switched precision.
+    release_shadows_not_used( );
+
+    // The quiet tiles of the solvers we are not using go out of date.
+    if ( e_single_precision != precision ) { solver_       .forget_quiet_tiles( ); }
+    if ( e_double_precision != precision ) { double_solver_.forget_quiet_tiles( ); }
+
+    if ( e_double_precision == precision ) {
+        calc_next_in_shadows( double_solver_ , double_shadows_ , input_params_, *p_src_sheet_, *p_trg_sheet_, *p_extra_sheet_, p_conductivity_sheet_, p_velocity_sheet_);
+    } else
+    if ( e_fixed16_precision == precision ) {
+        calc_next_in_shadows( fixed16_solver_, fixed16_shadows_, input_params_, *p_src_sheet_, *p_trg_sheet_, *p_extra_sheet_, p_conductivity_sheet_, p_velocity_sheet_);
+    } else
+    if ( e_fixed32_precision == precision ) {
+        calc_next_in_shadows( fixed32_solver_, fixed32_shadows_, input_params_, *p_src_sheet_, *p_trg_sheet_, *p_extra_sheet_, p_conductivity_sheet_, p_velocity_sheet_);
+    } else
+    if ( e_half_precision == precision ) {
+        calc_next_in_shadows( half_solver_   , half_shadows_   , input_params_, *p_src_sheet_, *p_trg_sheet_, *p_extra_sheet_, p_conductivity_sheet_, p_velocity_sheet_);
+    } else {
+        sheet_params_type sheet_params( *p_src_sheet_, *p_trg_sheet_, *p_extra_sheet_, p_conductivity_sheet_, p_velocity_sheet_);
+        solver_.calc_next( input_params_, sheet_params);
+    }
+}
+
+  void
+  worker_thread_type::
+release_shadows_not_used( )
+{
+    if ( e_double_precision  != last_precision_ ) { double_shadows_ .release( ); }
+    if ( e_fixed16_precision != last_precision_ ) { fixed16_shadows_.release( ); }
+    if ( e_fixed32_precision != last_precision_ ) { fixed32_shadows_.release( ); }
+    if ( e_half_precision    != last_precision_ ) { half_shadows_   .release( ); }
+}
+
+  void
+  worker_thread_type::
+forget_quiet_tile_sheets( )
+{
+    solver_       .forget_quiet_tile_sheets( );
+    double_solver_.forget_quiet_tile_sheets( );
+}
+
+// _______________________________________________________________________________________________
+
+  bool
+  worker_thread_type::
+maybe_publish( sheet_type const & sheet)
+  //
+  // Publishing copies the whole sheet, and the drawing code can't use sheets any faster than the
+  // display shows them. So we only publish if it's been about a frame since we last did, or if
+  // we can't tell.
+{
+    d_assert( currentThread( ) == this);
+    d_assert( p_draw_buffer_);
+
+    // About the frame rate of the display.
+    double const  publish_seconds  = 1.0 / 60.0;
+
+    tick_point_type const  now_tick  = date_time::get_tick_now( );
+    if ( date_time::is_valid_tick_pt( now_tick) &&
+         date_time::is_valid_tick_pt( last_publish_tick_) &&
+         (now_tick >= last_publish_tick_) &&
+         (date_time::convert_ticks_to_seconds( now_tick - last_publish_tick_) < publish_seconds) )
+    {
+        return false;
+    }
+    p_draw_buffer_->publish( sheet);
+    last_publish_tick_ = now_tick;
+    return true;
+}
+
+// _______________________________________________________________________________________________
+
+  size_type
+  worker_thread_type::
+free_run( tick_point_type start_tick)
+  //
+  // Keeps solving until the free-run slice is used up, without going back to the master thread
+  // between solves. The first solve is already done when we get here. The master thread only
+  // hears about the last solve, but we publish a sheet for the drawing code about once a frame
+  // along the way. Returns how many sheets we published.
+  //
+  // Each solve after the first takes the last solve's trg as its src. The src sheet belongs to
+  // the master thread so we never write it. Instead we solve around trg, extra and the spare
+  // sheet, and rotate them like sheet_control_type::after_solve( ) rotates its sheets. At the
+  // end we swap the values so trg has the last generation and extra has the history, the way
+  // a multi-pass solve leaves them.
+  //
+  // The master thread does not get a chance to change the sheets between the solves, so it does
+  // not let us free run if it has to change them after every solve (fixed edges, frozen center).
+{
+    d_assert( currentThread( ) == this);
+    d_assert( p_draw_buffer_);
+    d_assert( ! is_free_run_output_);
+
+    sheet_type const * const  p_master_src    = p_src_sheet_;
+    sheet_type       * const  p_master_trg    = p_trg_sheet_;
+    sheet_type       * const  p_master_extra  = p_extra_sheet_;
+
+    // Zero src means the master thread's src, before we rotate the sheets the first time.
+    sheet_type *  p_src    = 0;
+    sheet_type *  p_trg    = p_master_trg;
+    sheet_type *  p_extra  = p_master_extra;
+
+    // The later solves all start where the last one left off.
+    bool const  is_src_from_last_solve  = input_params_.is_src_from_last_solve( );
+    input_params_.set__is_src_from_last_solve( true);
+
+    size_type  published_count  = 0;
+    for ( ; ; ) {
+        output_params_type const &  last_output_params  = get_last_solve_output_params( );
+        if ( last_output_params.is_early_exit( ) ) break;
+
+        // Add the last solve to the ones before it.
+        { size_type const  solve_count          = is_free_run_output_ ? free_run_output_params_.get_solve_count( )         : 0;
+          size_type const  sub_step_count       = is_free_run_output_ ? free_run_output_params_.get_sub_step_count( )      : 0;
+          double    const  step_error_estimate  = is_free_run_output_ ? free_run_output_params_.get_step_error_estimate( ) : 0;
+          free_run_output_params_ = last_output_params;
+          free_run_output_params_.add_solve_count( solve_count);
+          free_run_output_params_.note_sub_steps( sub_step_count, step_error_estimate);
+          is_free_run_output_ = true;
+        }
+
+        if ( 0 != is_free_run_stop_requested_.fetchAndAddOrdered( 0) ) break;
+        if ( ! is_free_run_slice_left( start_tick) ) break;
+
+        // Rotate the sheets. The last trg is the next src. The next trg is where the history
+        // is, if there is any, since the wave solve wants the history there.
+        if ( 0 == p_src ) {
+            // The spare sheet stands in for src from now on. It starts as a copy, so it's the
+            // right size and it has the history if the first solve left it in src.
+            free_run_sheet_ = *p_master_src;
+            forget_quiet_tile_sheets( );
+            p_src = & free_run_sheet_;
+        }
+        { sheet_type * const  p_last_src  = p_src;
+          p_src = p_trg;
+          if ( last_output_params.is_last_solve_saved_in_extra( ) ) {
+              p_trg   = p_extra;
+              p_extra = p_last_src;
+          } else {
+              p_trg   = p_last_src;
+          }
+        }
+
+        // Let the drawing code see the latest generation now and then.
+        if ( maybe_publish( *p_src) ) {
+            ++ published_count;
+            emit published__worker_to_master( );
+        }
+
+        p_src_sheet_   = p_src;
+        p_trg_sheet_   = p_trg;
+        p_extra_sheet_ = p_extra;
+        calc_next_in_precision( );
+    }
+    input_params_.set__is_src_from_last_solve( is_src_from_last_solve);
+
+    // Put the values where the master thread expects them. Unless the first solve used up the
+    // slice, in which case it's not a free run after all.
+    if ( 0 == p_src ) {
+        is_free_run_output_ = false;
+    } else
+    if ( ! get_last_solve_output_params( ).is_early_exit( ) ) {
+        // The last generation goes in trg.
+        sheet_type * p_history =
+            free_run_output_params_.is_last_solve_saved_in_extra( ) ? p_extra :
+            free_run_output_params_.is_last_solve_saved_in_src( )   ? p_src   : 0;
+        if ( p_trg != p_master_trg ) {
+            swap( *p_trg, *p_master_trg);
+            if ( p_history == p_master_trg ) { p_history = p_trg; }
+        }
+
+        // The history goes in extra.
+        if ( p_history ) {
+            if ( p_history != p_master_extra ) {
+                swap( *p_history, *p_master_extra);
+            }
+            free_run_output_params_.set__is_last_solve_saved_in_extra( );
+        }
+        forget_quiet_tile_sheets( );
+    }
+    p_src_sheet_   = p_master_src;
+    p_trg_sheet_   = p_master_trg;
+    p_extra_sheet_ = p_master_extra;
+
+    return published_count;
+}
+
+  bool
+  worker_thread_type::
+is_free_run_slice_left( tick_point_type start_tick)
+{
+    if ( date_time::is_invalid_tick_pt( start_tick) ) return false;
+
+    tick_point_type const now_tick = date_time::get_tick_now( );
+    if ( date_time::is_invalid_tick_pt( now_tick) || (now_tick < start_tick) ) return false;
+
+    return date_time::convert_ticks_to_seconds( now_tick - start_tick) < free_run_seconds_;
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 // Class control_type
@@ -974,6 +3022,8 @@ control_type( QObject * p_parent)
   , is_exiting_          ( false)
   , last_duration_       ( 0)
   , p_worker_            ( 0)
+  , free_run_msecs_      ( 0)
+  , row_pool_            ( 0)
 {
 }
 
@@ -1023,6 +3073,22 @@ get_output_params( ) const
     return 0;
 }
 
+  size_type
+  control_type::
+get_skipped_generation_count( ) const
+{
+    d_assert( not_busy( ));
+    return p_worker_ ? p_worker_->get_skipped_generation_count( ) : 0;
+}
+
+  bool
+  control_type::
+is_last_generation_published( ) const
+{
+    d_assert( not_busy( ));
+    return p_worker_ && p_worker_->is_last_generation_published( );
+}
+
 // _______________________________________________________________________________________________
 
   void
@@ -1051,6 +3117,15 @@ set_method( method_type new_method)
     }
 }
 
+  void
+  control_type::
+set_boundary( boundary_type new_boundary)
+{
+    if ( input_params_.set_boundary( new_boundary) ) {
+        emit boundary_is_changed( );
+    }
+}
+
   /* slot */
   void
   control_type::
@@ -1059,6 +3134,79 @@ set__is_method_parallel( bool new_is)
     input_params_.set__is_method_parallel( new_is);
 }
 
+  /* slot */
+  void
+  control_type::
+set_thread_count( int new_thread_count)
+{
+    // The pool picks this up at the start of its next map, so we can set it while a solve runs.
+    row_pool_.set_thread_count( new_thread_count);
+}
+
+  /* slot */
+  void
+  control_type::
+set__is_skipping_quiet_tiles( bool new_is)
+{
+    input_params_.set__is_skipping_quiet_tiles( new_is);
+}
+
+  void
+  control_type::
+set_precision( precision_type new_precision)
+{
+    if ( input_params_.set_precision( new_precision) ) {
+        emit precision_is_changed( );
+    }
+}
+
+  /* not a slot */
+  void
+  control_type::
+set__is_precision( precision_type precision, bool new_is)
+  //
+  // Each precision has its own checkbox. Unchecking a box only goes back to single precision
+  // if that box's precision is the current one. Checking another box unchecks it first.
+{
+    if ( new_is ) {
+        set_precision( precision);
+    } else
+    if ( get_precision( ) == precision ) {
+        set_precision( e_single_precision);
+    }
+}
+
+  /* slot */
+  void
+  control_type::
+set__is_precision_double( bool new_is)
+{
+    set__is_precision( e_double_precision, new_is);
+}
+
+  /* slot */
+  void
+  control_type::
+set__is_precision_fixed16( bool new_is)
+{
+    set__is_precision( e_fixed16_precision, new_is);
+}
+
+  /* slot */
+  void
+  control_type::
+set__is_precision_fixed32( bool new_is)
+{
+    set__is_precision( e_fixed32_precision, new_is);
+}
+
+  void
+  control_type::
+set__is_precision_half( bool new_is)
+{
+    set__is_precision( e_half_precision, new_is);
+}
+
   /* slot */
   void
   control_type::
@@ -1078,6 +3226,26 @@ set_pass_count( int new_pass_count)
     input_params_.set_extra_pass_count( new_extra_pass_count);
 }
 
+  /* slot */
+  void
+  control_type::
+set_free_run_msecs( int new_msecs)
+{
+    free_run_msecs_ = (new_msecs < 0) ? 0 : new_msecs;
+}
+
+  void
+  control_type::
+request_free_run_stop( )
+  //
+  // The worker finishes the solve it's on, and then reports back. It does not stop in the
+  // middle of a solve, so the sheets are good.
+{
+    if ( p_worker_ && is_busy( ) ) {
+        p_worker_->request_free_run_stop( );
+    }
+}
+
 // _______________________________________________________________________________________________
 
   void
@@ -1086,7 +3254,13 @@ calc_next
  (  sheet_type const &  src_sheet
   , sheet_type       &  trg_sheet
   , sheet_type       &  extra_sheet
+  , conductivity_sheet_type const *
+                        p_conductivity_sheet
+  , sheet_type       *  p_velocity_sheet
+  , draw_buffer_type *  p_draw_buffer
   , bool                are_extra_passes_disabled
+  , bool                is_src_from_last_solve
+  , bool                is_free_run_allowed
 )
 {
     // Runs in the master thread.
@@ -1103,78 +3277,134 @@ calc_next
     d_assert( not_busy( ));
     is_busy_ = true;
 
-    // If p_worker_ is zero then we still have to create the worker thread object.
-    if ( 0 == p_worker_ ) {
-        // Create the thread.
-        // We give the worker-thread object no parent (zero pointer) so that signals sent between
-        // the master and worker threads are queued instead of dispatched.
-        // The ctor for the worker thread runs in the master thread, during creation below.
-        // And that ctor starts the worker thread and waits for it to settle.
-        p_worker_ = new worker_thread_type( 0);
-
-        // Worker is now running.
-        d_assert( p_worker_ && p_worker_->isRunning( ));
-
-        // The parent serves these purposes:
-        //   It auto-deletes the object at the end of its life.
-        //   When you send a message to an object, Qt has to decide in which thread the message should run.
-        //     If the target object has a parent, we use that thread that owns the target object.
-        //     If the target object has no parent, we use p_trg->thread( ), which is initially the thread
-        //       where the target was created. But we set it below.
-        //
-        // Since we want messages to p_worker_ to process in that thread, we have to create p_worker_ with
-        // no parent (or set it to zero later) and then set the thread.
-        //
-        // Instead of setting the thread, we could try setting the worker-thread object to be its own parent.
-        // It'd look like this:
-        //   p_worker_->setParent( p_worker_);
-        // This compiles and runs, tho it's not clear what it means for auto-delete.
-        // And this doesn't work, even if you follow it with:
-        //   p_worker_->moveToThread( p_worker_);
-        // The messages to p_worker_ still get dispatched in the master thread.
-
-        // Right now worker_->thread( ) is this (master) thread. And the parent is not set.
-        d_assert( p_worker_->thread( ) == QThread::currentThread( ));
-        d_assert( p_worker_->parent( ) == 0);
-
-        // Change the thread. You MUST do this from the thread that currently owns the object (this master thread).
-        // This will let the signal/slot mechanism work across threads.
-        p_worker_->moveToThread( p_worker_);
-        // This does not set the parent, so auto-delete is disabled. The worker thread does not delete itself
-        // after we call p_worker_->quit( ).
-        d_assert( p_worker_->parent( ) == 0);
-        // Now messages sent to p_worker_ from the master thread are queued and processed in the worker thread.
-
-        // The worker thread is now awaiting instructions.
-        // We use the following 2 async connections, plus ->quit( ), to control it.
-
-        // This is a Qt::QueuedConnection. It is sent from the master and processed in the worker thread.
-        // The target (p_worker_ in this case) determines where the message is processed.
-          d_verify(
-        connect(
-            p_worker_, SIGNAL( start__master_to_worker( )),
-            p_worker_, SLOT( run__in_worker_thread( )))
-          );
-
-        // This is a Qt::QueuedConnection. It is sent from the worker to the master thread.
-          d_verify(
-        connect(
-            p_worker_, SIGNAL( finished__worker_to_master( double)),
-            this, SLOT( finished__from_worker_thread( double)))
-          );
-    }
+    start_worker( );
     d_assert( p_worker_->isRunning( ));
 
     // Tell the worker thread to start working.
     input_params_.set__are_extra_passes_disabled( are_extra_passes_disabled);
+    input_params_.set__is_src_from_last_solve( is_src_from_last_solve);
     p_worker_->start_run__from_master_thread
      (  input_params_
       , src_sheet
       , trg_sheet
       , extra_sheet
+      , p_conductivity_sheet
+      , p_velocity_sheet
+      , p_draw_buffer
+      , is_free_run_allowed ? (double( free_run_msecs_) / 1000.0) : 0.0
      );
 }
 
+// _______________________________________________________________________________________________
+
+  void
+  control_type::
+start_worker( )
+  //
+  // Creates the worker thread the first time we need it.
+{
+    // If p_worker_ is not zero we already created the worker thread object.
+    if ( p_worker_ ) return;
+
+    // Create the thread.
+    // We give the worker-thread object no parent (zero pointer) so that signals sent between
+    // the master and worker threads are queued instead of dispatched.
+    // The ctor for the worker thread runs in the master thread, during creation below.
+    // And that ctor starts the worker thread and waits for it to settle.
+    p_worker_ = new worker_thread_type( 0, & row_pool_);
+
+    // Worker is now running.
+    d_assert( p_worker_ && p_worker_->isRunning( ));
+
+    // The parent serves these purposes:
+    //   It auto-deletes the object at the end of its life.
+    //   When you send a message to an object, Qt has to decide in which thread the message should run.
+    //     If the target object has a parent, we use that thread that owns the target object.
+    //     If the target object has no parent, we use p_trg->thread( ), which is initially the thread
+    //       where the target was created. But we set it below.
+    //
+    // Since we want messages to p_worker_ to process in that thread, we have to create p_worker_ with
+    // no parent (or set it to zero later) and then set the thread.
+    //
+    // Instead of setting the thread, we could try setting the worker-thread object to be its own parent.
+    // It'd look like this:
+    //   p_worker_->setParent( p_worker_);
+    // This compiles and runs, tho it's not clear what it means for auto-delete.
+    // And this doesn't work, even if you follow it with:
+    //   p_worker_->moveToThread( p_worker_);
+    // The messages to p_worker_ still get dispatched in the master thread.
+
+    // Right now worker_->thread( ) is this (master) thread. And the parent is not set.
+    d_assert( p_worker_->thread( ) == QThread::currentThread( ));
+    d_assert( p_worker_->parent( ) == 0);
+
+    // Change the thread. You MUST do this from the thread that currently owns the object (this master thread).
+    // This will let the signal/slot mechanism work across threads.
+    p_worker_->moveToThread( p_worker_);
+    // This does not set the parent, so auto-delete is disabled. The worker thread does not delete itself
+    // after we call p_worker_->quit( ).
+    d_assert( p_worker_->parent( ) == 0);
+    // Now messages sent to p_worker_ from the master thread are queued and processed in the worker thread.
+
+    // The worker thread is now awaiting instructions.
+    // We use the following async connections, plus ->quit( ), to control it.
+
+    // This is a Qt::QueuedConnection. It is sent from the master and processed in the worker thread.
+    // The target (p_worker_ in this case) determines where the message is processed.
+      d_verify(
+    connect(
+        p_worker_, SIGNAL( start__master_to_worker( )),
+        p_worker_, SLOT( run__in_worker_thread( )))
+      );
+
+    // This is a Qt::QueuedConnection. It is sent from the worker to the master thread.
+      d_verify(
+    connect(
+        p_worker_, SIGNAL( finished__worker_to_master( double)),
+        this, SLOT( finished__from_worker_thread( double)))
+      );
+
+    // This is also a Qt::QueuedConnection, passed straight on to the outside world.
+      d_verify(
+    connect(
+        p_worker_, SIGNAL( published__worker_to_master( )),
+        this, SIGNAL( published( )))
+      );
+
+    // This is a Qt::QueuedConnection. It is sent from the worker to the master thread.
+      d_verify(
+    connect(
+        p_worker_, SIGNAL( transform_finished__worker_to_master( )),
+        this, SLOT( transform_finished__from_worker_thread( )))
+      );
+}
+
+// _______________________________________________________________________________________________
+
+  void
+  control_type::
+transform( transform_job_type const * p_job)
+{
+    // Runs in the master thread.
+    d_assert( QThread::currentThread( ) != p_worker_);
+    d_assert( p_job);
+
+    // We should not be processing this message after we have exited.
+    if ( is_going_down( ) ) {
+        d_assert( false);
+        delete p_job;
+        return;
+    }
+
+    // We will be busy until we process the "transform finished" message from the worker thread.
+    d_assert( not_busy( ));
+    is_busy_ = true;
+
+    start_worker( );
+    d_assert( p_worker_->isRunning( ));
+    p_worker_->start_transform__from_master_thread( p_job);
+}
+
 // _______________________________________________________________________________________________
 
   // private slot
@@ -1206,6 +3436,27 @@ finished__from_worker_thread( double duration_seconds)
     emit finished( );
 }
 
+  // private slot
+  void
+  control_type::
+transform_finished__from_worker_thread( )
+{
+    // Runs in the master thread. Sent from the worker thread.
+    d_assert( p_worker_ && (p_worker_ != QThread::currentThread( )));
+
+    // We are no longer busy and are ready for a solve or another transform.
+    d_assert( is_busy( ));
+    is_busy_ = false;
+
+    // We should not be processing this message after we have exited.
+    if ( is_going_down( ) ) {
+        d_assert( false);
+        return;
+    }
+
+    emit transform_finished( );
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 } /* end namespace heat_solver */
@@ -24,7 +24,15 @@
 
 # include "finite_diff_solver.h"
 # include "sheet.h"
+# include "value_sheet.h"
+# include "uniform_scalar.h"
+# include "half_float.h"
+# include "multigrid.h"
+# include "spectral.h"
+# include "sheet_stats.h"
 # include "date_time.h"
+# include "row_pool.h"
+# include "draw_buffer.h"
 
 // This uses QT for the following:
 //   QObject
@@ -34,9 +42,12 @@
 //   QSemaphore
 //     Provides threads and a simple synch at startup. Easily replaced by <boost/thread.hpp>
 //     if you want QT independence.
+//   QAtomicInt
+//     Lets the master thread ask the worker to cut a free run short.
 # include <QtCore/QObject>
 # include <QtCore/QThread>
 # include <QtCore/QSemaphore>
+# include <QtCore/QAtomicInt>
 
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
@@ -49,13 +60,18 @@ namespace heat_solver {
 // like a struct or class name.
 //   enum  technique_type           ;
 //   enum  method_type              ;
+//   enum  boundary_type            ;
 //   enum  last_solve_location_type ;
+//   enum  precision_type           ;
 
 class input_params_type        ;
-class sheet_params_type        ;
+template< typename SHEET_TYPE > class basic_sheet_params_type ;
 class output_params_type       ;
 
-class solver_type              ;
+template< typename SHEET_TYPE > class basic_solver_type       ;
+template< typename INT_TYPE   > class fixed_solver_type       ;
+class half_solver_type         ;
+template< typename SHEET_TYPE > class shadow_sheets_type      ;
 class control_type             ;
 class worker_thread_type       ;
 
@@ -80,6 +96,31 @@ typedef calc_next_1d_functor_super_type
           , trg_iter_type
          >                             solve_1d_functor_type ;
 
+// The solver works on the (float) sheet_type the rest of the program uses, or on a double sheet
+// that shadows it when we need more precision.
+typedef value_sheet_type< double >     double_sheet_type     ;
+
+// The conductivity of each cell, between 0 and 1, which scales the rates (see "Varying
+// conductivity" in finite_diff.h). It is float whatever precision we solve in.
+typedef value_sheet_type< float >      conductivity_sheet_type ;
+
+typedef basic_sheet_params_type< sheet_type >         sheet_params_type        ;
+typedef basic_sheet_params_type< double_sheet_type >  double_sheet_params_type ;
+
+typedef basic_solver_type< sheet_type >               solver_type              ;
+typedef basic_solver_type< double_sheet_type >        double_solver_type       ;
+
+// Or on fixed-point sheets (see uniform_scalar.h), which only the forward-diff heat solver uses.
+typedef value_sheet_type< uniform_scalar_16_type >    fixed16_sheet_type       ;
+typedef value_sheet_type< uniform_scalar_32_type >    fixed32_sheet_type       ;
+
+typedef fixed_solver_type< boost::int16_t >           fixed16_solver_type      ;
+typedef fixed_solver_type< boost::int32_t >           fixed32_solver_type      ;
+
+// Or on half-float sheets (see half_float.h), which store 16 bits and solve in float. These are
+// also only for the forward-diff heat solver.
+typedef value_sheet_type< half_float_type >           half_sheet_type          ;
+
 // _______________________________________________________________________________________________
 // Enum types
 
@@ -92,6 +133,10 @@ technique_type
  {  e_ortho_interleave
   , e_simultaneous_2d
   , e_wave_with_damping
+  , e_implicit_multigrid
+  , e_spectral_jump
+  , e_super_time_step
+  , e_wave_leapfrog
  };
 
   enum
@@ -99,8 +144,35 @@ method_type
  {  e_forward_diff
   , e_backward_diff
   , e_central_diff
+  , e_forward_diff_9_point   /* forward diff, 9-point isotropic stencil */
+  , e_forward_diff_4th_order /* forward diff, 4th-order stencil (2 cells each way) */
+ };
+
+// True if the technique and method are stable with any (positive) rate.
+bool is_stable_at_any_rate( technique_type, method_type);
+
+// The wide forward-diff stencils are only used by the simultaneous 2d and wave techniques.
+// The other techniques solve them as plain forward diff. This returns the method the
+// technique actually uses.
+method_type get_solved_method( technique_type, method_type);
+
+// The worst of the (positive) rates as a fraction of its stability limit. Below 1 is stable.
+double get_stable_rate_fraction( technique_type, method_type, double rate_x, double rate_y);
+
+  enum
+boundary_type
+ {  e_boundary_insulated  /* nothing leaks out the edges */
+  , e_boundary_fixed      /* the edge cells keep their values (Dirichlet) */
+  , e_boundary_periodic   /* the edges wrap around to the other side */
+  , e_boundary_absorbing  /* waves die out in a damping layer along the edges */
  };
 
+// Only the 2d forward-diff solves have the boundaries built in: simultaneous 2d and wave, and
+// the forward-diff multigrid and RKL2 solves that are built on them. Absorbing only does
+// anything for waves. The other solves have insulated edges. This returns the boundary the
+// technique actually uses.
+boundary_type get_solved_boundary( technique_type, method_type, boundary_type);
+
   enum
 last_solve_location_type
  {  e_not_saved
@@ -108,6 +180,15 @@ last_solve_location_type
   , e_in_extra
  };
 
+  enum
+precision_type
+ {  e_single_precision  /* solve in the float sheets */
+  , e_double_precision  /* solve in double shadows of the float sheets */
+  , e_fixed16_precision /* solve in 16-bit fixed-point shadows, if the solver can */
+  , e_fixed32_precision /* solve in 32-bit fixed-point shadows, if the solver can */
+  , e_half_precision    /* solve in 16-bit half-float shadows, if the solver can */
+ };
+
 // _______________________________________________________________________________________________
 // input_params_type
 
@@ -141,14 +222,35 @@ input_params_type
     bool        is_technique__ortho_interleave(  )  const { return technique_ == e_ortho_interleave ; }
     bool        is_technique__simultaneous_2d(   )  const { return technique_ == e_simultaneous_2d  ; }
     bool        is_technique__wave_with_damping( )  const { return technique_ == e_wave_with_damping; }
+    bool        is_technique__implicit_multigrid( ) const { return technique_ == e_implicit_multigrid; }
+    bool        is_technique__spectral_jump( )      const { return technique_ == e_spectral_jump; }
+    bool        is_technique__super_time_step( )    const { return technique_ == e_super_time_step; }
+    bool        is_technique__wave_leapfrog( )      const { return technique_ == e_wave_leapfrog; }
 
     method_type get_method( )                       const { return method_; }
     bool        is_method__forward_diff(  )         const { return method_ == e_forward_diff ; }
     bool        is_method__backward_diff( )         const { return method_ == e_backward_diff; }
     bool        is_method__central_diff(  )         const { return method_ == e_central_diff ; }
+    bool        is_method__forward_diff_9_point( )  const { return method_ == e_forward_diff_9_point  ; }
+    bool        is_method__forward_diff_4th_order( )
+                                                    const { return method_ == e_forward_diff_4th_order; }
 
     bool        is_method_parallel( )               const { return is_method_parallel_; }
 
+    boundary_type
+                get_boundary( )                     const { return boundary_; }
+    bool        is_boundary__insulated( )           const { return boundary_ == e_boundary_insulated; }
+    bool        is_boundary__fixed( )               const { return boundary_ == e_boundary_fixed    ; }
+    bool        is_boundary__periodic( )            const { return boundary_ == e_boundary_periodic ; }
+    bool        is_boundary__absorbing( )           const { return boundary_ == e_boundary_absorbing; }
+
+    precision_type
+                get_precision( )                    const { return precision_; }
+    bool        is_precision__double( )             const { return precision_ == e_double_precision; }
+    bool        is_precision__fixed16( )            const { return precision_ == e_fixed16_precision; }
+    bool        is_precision__fixed32( )            const { return precision_ == e_fixed32_precision; }
+    bool        is_precision__half( )               const { return precision_ == e_half_precision   ; }
+
     rate_type   get_damping( )                      const { return damping_; }
     rate_type   get_rate_x( )                       const { return rate_x_ ; }
     rate_type   get_rate_y( )                       const { return rate_y_ ; }
@@ -158,6 +260,11 @@ input_params_type
     bool        has_extra_passes( )                 const { return get_extra_pass_count( ) > 0; }
     bool        are_extra_passes_disabled( )        const { return are_extra_passes_disabled_; }
 
+    // Quiet tiles carry over from one solve to the next only if src is what the last solve left
+    // in trg, untouched (see tile_activity_type in finite_diff_solver.h).
+    bool        is_skipping_quiet_tiles( )          const { return is_skipping_quiet_tiles_; }
+    bool        is_src_from_last_solve( )           const { return is_src_from_last_solve_; }
+
     bool        is_extra_sheet_to_be_reset_if_not_used( )
                                                     const { return reset_if_not_used_; }
     bool        is_saving_history_worth_extra_copy( )
@@ -170,6 +277,8 @@ input_params_type
     technique_type  technique_                 ;
     method_type     method_                    ;
     bool            is_method_parallel_        ;
+    boundary_type   boundary_                  ;
+    precision_type  precision_                 ;
 
     rate_type       damping_                   ;
     rate_type       rate_x_                    ;
@@ -178,6 +287,9 @@ input_params_type
     size_type       extra_pass_count_          ;
     bool            are_extra_passes_disabled_ ;
 
+    bool            is_skipping_quiet_tiles_   ;
+    bool            is_src_from_last_solve_    ;
+
     bool            reset_if_not_used_         ;
     bool            copy_for_history_          ;
     bool            size_for_history_          ;
@@ -195,11 +307,19 @@ settable_input_params_type
     bool        set_technique( technique_type tech)       ;
     bool        set_method( method_type m)                ;
     bool        set__is_method_parallel( bool is = true)  ;
+    bool        set_boundary( boundary_type b)            ;
+    bool        set_precision( precision_type p)          ;
     bool        set_damping( rate_type)                   ;
     bool        set_rate_x( rate_type)                    ;
     bool        set_rate_y( rate_type)                    ;
     bool        set_extra_pass_count( size_type c)        ;
     bool        set__are_extra_passes_disabled( bool)     ;
+    bool        set__is_skipping_quiet_tiles( bool)       ;
+    bool        set__is_src_from_last_solve( bool)        ;
+
+    // Changes the technique without changing the history flags. calc_next(..) uses this when it
+    // solves one technique as another, so the solve keeps the history rules the caller set up.
+    bool        set_solved_technique( technique_type tech) ;
 
   // -------------------------------------------------------------------------------------------
   // Hide inherited member vars
@@ -207,6 +327,8 @@ settable_input_params_type
     input_params_type::technique_                 ;
     input_params_type::method_                    ;
     input_params_type::is_method_parallel_        ;
+    input_params_type::boundary_                  ;
+    input_params_type::precision_                 ;
 
     input_params_type::damping_                   ;
     input_params_type::rate_x_                    ;
@@ -215,26 +337,45 @@ settable_input_params_type
     input_params_type::extra_pass_count_          ;
     input_params_type::are_extra_passes_disabled_ ;
 
+    input_params_type::is_skipping_quiet_tiles_   ;
+    input_params_type::is_src_from_last_solve_    ;
+
     input_params_type::reset_if_not_used_         ;
     input_params_type::copy_for_history_          ;
     input_params_type::size_for_history_          ;
 };
 
 // _______________________________________________________________________________________________
-// sheet_params_type
+// basic_sheet_params_type
 
+  template< typename SHEET_TYPE >
   class
-sheet_params_type
+basic_sheet_params_type
 {
   // -------------------------------------------------------------------------------------------
   public:
-    /* ctor */  sheet_params_type
+    typedef SHEET_TYPE                  sheet_type                  ;
+    typedef typename SHEET_TYPE::size_type
+                                        size_type                   ;
+    typedef typename SHEET_TYPE::value_type
+                                        value_type                  ;
+
+  // -------------------------------------------------------------------------------------------
+  public:
+    /* ctor */  basic_sheet_params_type
                  (  sheet_type const &  src_sheet
                   , sheet_type       &  trg_sheet
                   , sheet_type       &  extra_sheet
+                  , conductivity_sheet_type const *
+                                        p_conductivity_sheet /* zero means the same conductivity everywhere */
+                  , sheet_type       *  p_velocity_sheet     /* zero unless solving the leapfrog wave */
                  )                                        : src_sheet_   ( src_sheet   )
                                                           , trg_sheet_   ( trg_sheet   )
                                                           , extra_sheet_ ( extra_sheet )
+                                                          , p_conductivity_sheet_
+                                                                         ( p_conductivity_sheet)
+                                                          , p_velocity_sheet_
+                                                                         ( p_velocity_sheet)
                                                           { d_assert( 0 != (& src_sheet  ));
                                                             d_assert( 0 != (& trg_sheet  ));
                                                             d_assert( 0 != (& extra_sheet));
@@ -244,6 +385,12 @@ sheet_params_type
                                                             d_assert( src_sheet.get_y_count( ) == trg_sheet.get_y_count( ));
                                                             d_assert( src_sheet.get_x_count( ) > 0);
                                                             d_assert( src_sheet.get_y_count( ) > 0);
+                                                            d_assert( (0 == p_conductivity_sheet) || (
+                                                                (p_conductivity_sheet->get_x_count( ) == src_sheet.get_x_count( )) &&
+                                                                (p_conductivity_sheet->get_y_count( ) == src_sheet.get_y_count( )) ));
+                                                            d_assert( (0 == p_velocity_sheet) || (
+                                                                (p_velocity_sheet->get_x_count( ) == src_sheet.get_x_count( )) &&
+                                                                (p_velocity_sheet->get_y_count( ) == src_sheet.get_y_count( )) ));
                                                           }
 
   // -------------------------------------------------------------------------------------------
@@ -251,6 +398,9 @@ sheet_params_type
     sheet_type const &  ref_src_sheet(   )          const { return src_sheet_  ; }
     sheet_type       &  ref_trg_sheet(   )          const { return trg_sheet_  ; }
     sheet_type       &  ref_extra_sheet( )          const { return extra_sheet_; }
+    conductivity_sheet_type const *
+                        get_conductivity_sheet( )   const { return p_conductivity_sheet_; }
+    sheet_type       *  get_velocity_sheet( )       const { return p_velocity_sheet_; }
 
     bool                are_src_trg_sheets_same( )  const { return (& src_sheet_) == (& trg_sheet_); }
     size_type           get_x_count( )              const { return trg_sheet_.get_x_count( ); }
@@ -264,7 +414,7 @@ sheet_params_type
     bool                maybe_size_extra_sheet( )   const { // Make sure the extra_sheet is correctly sized.
                                                             // extra_sheet is usually already set up, so we don't resize it often.
                                                             if ( ! is_extra_sheet_sized( ) ) {
-                                                                extra_sheet_.set_xy_counts( get_x_count( ), get_y_count( ), 0);
+                                                                extra_sheet_.set_xy_counts( get_x_count( ), get_y_count( ), value_type( 0));
                                                                 d_assert( is_extra_sheet_sized( ));
                                                                 return true;
                                                             }
@@ -276,6 +426,9 @@ sheet_params_type
     sheet_type const &  src_sheet_   ;
     sheet_type       &  trg_sheet_   ;
     sheet_type       &  extra_sheet_ ;
+    conductivity_sheet_type const *
+                        p_conductivity_sheet_ ;
+    sheet_type       *  p_velocity_sheet_     ;
 };
 
 // _______________________________________________________________________________________________
@@ -295,6 +448,9 @@ output_params_type
                                                          was_extra_sized_     = false;
                                                          solve_count_         = 0;
                                                          last_solve_location_ = e_not_saved;
+                                                         sub_step_count_      = 0;
+                                                         step_error_estimate_ = 0;
+                                                         sheet_stats_.clear( );
                                                        }
 
     bool &     ref_early_exit( )                       { return is_early_exit_; }
@@ -307,6 +463,7 @@ output_params_type
     void       set__was_extra_used( )                  { was_extra_used_  = true; }
     void       set__was_extra_sized( )                 { was_extra_sized_ = true; }
     void       inc_solve_count( )                      { ++ solve_count_; }
+    void       add_solve_count( size_type count)       { solve_count_ += count; }
 
     bool       is_last_solve_not_saved( )        const { return last_solve_location_ == e_not_saved; }
     bool       is_last_solve_saved_in_src( )     const { return last_solve_location_ == e_in_src   ; }
@@ -315,6 +472,23 @@ output_params_type
     void       set__is_last_solve_saved_in_src( )      { last_solve_location_ = e_in_src   ; }
     void       set__is_last_solve_saved_in_extra( )    { last_solve_location_ = e_in_extra ; }
 
+    // The most sub-steps any pass was split into, and the largest error estimate from a pass
+    // that was split (see basic_solver_type::get_stable_sub_step_count(..)).
+    size_type  get_sub_step_count( )             const { return sub_step_count_; }
+    double     get_step_error_estimate( )        const { return step_error_estimate_; }
+    void       note_sub_steps( size_type count, double error)
+                                                       { sub_step_count_      = std::max( sub_step_count_, count);
+                                                         step_error_estimate_ = std::max( step_error_estimate_, error);
+                                                       }
+
+    // Min, max, sum and sum of squares of the last generation (trg_sheet), gathered while it
+    // was solved. Empty if the solve exited early, or if the last pass had no trip thru the
+    // sheet to gather them in (only the forward-diff kernels and the clamped solves have one).
+    sheet_stats_type const &
+               get_sheet_stats( )                const { return sheet_stats_; }
+    sheet_stats_type &
+               ref_sheet_stats( )                      { return sheet_stats_; }
+
   // -------------------------------------------------------------------------------------------
   private:
     bool                      is_early_exit_       ;
@@ -322,23 +496,52 @@ output_params_type
     bool                      was_extra_sized_     ;
     size_type                 solve_count_         ;  /* zero before solve */
     last_solve_location_type  last_solve_location_ ;  /* is history available, and if so is it in trg_sheet or extra_sheet */
+    size_type                 sub_step_count_      ;  /* zero before solve, one if no pass was split */
+    double                    step_error_estimate_ ;  /* zero unless a pass was split */
+    sheet_stats_type          sheet_stats_         ;  /* empty before solve, and if not gathered */
 };
 
 // _______________________________________________________________________________________________
-// solver_type
+// basic_solver_type< SHEET_TYPE >
 
+  template< typename SHEET_TYPE >
   class
-solver_type
+basic_solver_type
   //
   // This is an algorithm class.
   // It runs in a worker thread. However the object is owned by an object in the UI thread,
   // and controlled from there. It is ctor'd and dtor'd from the UI thread.
+  //
+  // SHEET_TYPE is sheet_type (float) or double_sheet_type. The values are solved in the sheet's
+  // value_type. The methods are defined in heat_solver.cpp, which instantiates both.
 {
+  // -------------------------------------------------------------------------------------------
+  // Typedefs
+  //   These hide the namespace typedefs of the same names, which are all for sheet_type.
+  public:
+    typedef SHEET_TYPE                                  sheet_type            ;
+    typedef basic_sheet_params_type< sheet_type >       sheet_params_type     ;
+
+    typedef typename sheet_type::inner_const_iter       src_iter_type         ;
+    typedef typename sheet_type::inner_varia_iter       trg_iter_type         ;
+    typedef typename sheet_type::value_type             value_type            ;
+    typedef value_type                                  rate_type             ;
+    typedef typename sheet_type::size_type              size_type             ;
+
+    typedef std::vector< value_type >                   buf_type              ;
+    typedef typename buf_type::iterator                 buf_iter_type         ;
+
+    typedef calc_next_1d_functor_super_type
+             <  rate_type
+              , src_iter_type
+              , trg_iter_type
+             >                                          solve_1d_functor_type ;
+
   // -------------------------------------------------------------------------------------------
   // Constructor
   public:
-    /* ctor */  solver_type( )                          ;
-    /* dtor */  ~solver_type( )                         { }
+    /* ctor */  basic_solver_type( )                    ;
+    /* dtor */  ~basic_solver_type( )                   { }
 
   // -------------------------------------------------------------------------------------------
   // Controls
@@ -350,6 +553,12 @@ solver_type
     bool        not_early_exit( )                 const { return ! is_early_exit( ); }
     void        request_early_exit( )                   { output_params_.ref_early_exit( ) = true; }
 
+    // Call this when another solver takes over. Its solves leave our quiet tiles out of date.
+    void        forget_quiet_tiles( )                   { tile_activity_.clear( ); }
+    // Call this when the sheets' values are moved around between solves. The quiet tiles are
+    // still good, but not what we knew about which sheet holds which generation.
+    void        forget_quiet_tile_sheets( )             { tile_activity_.forget_sheets( ); }
+
   // -------------------------------------------------------------------------------------------
   // Solve calculations
   public:
@@ -360,12 +569,34 @@ solver_type
     void        calc_next_pass
                  (  technique_type      technique
                   , method_type         method
+                  , boundary_type       boundary
                   , bool                is_parallel_method
                   , rate_type           damping
                   , rate_type           rate_x
                   , rate_type           rate_y
                   , sheet_type const &  src_sheet
                   , sheet_type       &  trg_sheet
+                  , tile_activity_type *
+                                        p_tiles
+                  , sheet_stats_type *  p_stats
+                 )                                      ;
+
+  protected:
+    bool        is_tile_skipping_possible
+                 (  input_params_type const &  input_params
+                  , sheet_params_type const &  sheet_params
+                 )                                const ;
+    bool        maybe_calc_next_temporal_blocked
+                 (  input_params_type const &  input_params
+                  , sheet_type        const &  src_sheet
+                  , sheet_type              &  trg_sheet
+                  , sheet_type              &  extra_sheet
+                 )                                      ;
+    bool        maybe_calc_next_spectral_jump
+                 (  input_params_type const &  input_params
+                  , sheet_type        const &  src_sheet
+                  , sheet_type              &  trg_sheet
+                  , sheet_type              &  extra_sheet
                  )                                      ;
 
   protected:
@@ -382,6 +613,32 @@ solver_type
                   , size_type                 y_size
                  )                                      ;
     void        clear_buffers( )                        ;
+    void        calc_1d_functor_on_columns
+                 (  method_type               method
+                  , bool                      is_parallel_method
+                  , solve_1d_functor_type
+                                     const &  calc_1d_functor
+                  , rate_type                 damping
+                  , rate_type                 rate
+                  , sheet_type       const &  src_sheet
+                  , sheet_type             &  trg_sheet
+                 )                                      ;
+    void        calc_1d_varying_on_rows
+                 (  method_type               method
+                  , bool                      is_parallel_method
+                  , rate_type                 damping
+                  , rate_type                 rate
+                  , sheet_type       const &  src_sheet
+                  , sheet_type             &  trg_sheet
+                 )                                      ;
+    void        calc_1d_varying_on_columns
+                 (  method_type               method
+                  , bool                      is_parallel_method
+                  , rate_type                 damping
+                  , rate_type                 rate
+                  , sheet_type       const &  src_sheet
+                  , sheet_type             &  trg_sheet
+                 )                                      ;
 
   protected:
     void        calc_next_ortho_interleave
@@ -394,33 +651,156 @@ solver_type
                  )                                      ;
     void        calc_next_simultaneous_2d
                  (  method_type         method
+                  , boundary_type       boundary
                   , bool                is_parallel_method
                   , rate_type           x_rate
                   , rate_type           y_rate
                   , sheet_type const &  src_sheet
                   , sheet_type       &  trg_sheet
+                  , tile_activity_type *
+                                        p_tiles
+                  , rate_type           clamp_limit
+                  , sheet_stats_type *  p_stats
                  )                                      ;
     void        calc_next_wave_with_damping
                  (  method_type         method
+                  , boundary_type       boundary
                   , bool                is_parallel_method
                   , rate_type           damping
                   , rate_type           x_rate
                   , rate_type           y_rate
                   , sheet_type const &  src_sheet
                   , sheet_type       &  trg_sheet
+                  , sheet_type       *  p_velocity_sheet
+                  , tile_activity_type *
+                                        p_tiles
+                  , rate_type           clamp_limit
+                  , sheet_stats_type *  p_stats
+                 )                                      ;
+    void        calc_next_implicit_multigrid
+                 (  method_type         method
+                  , boundary_type       boundary
+                  , bool                is_parallel_method
+                  , rate_type           x_rate
+                  , rate_type           y_rate
+                  , sheet_type const &  src_sheet
+                  , sheet_type       &  trg_sheet
+                 )                                      ;
+    void        calc_next_spectral_jump
+                 (  method_type         method
+                  , bool                is_parallel_method
+                  , rate_type           x_rate
+                  , rate_type           y_rate
+                  , size_type           generation_count
+                  , sheet_type const &  src_sheet
+                  , sheet_type       &  trg_sheet
+                  , sheet_type       *  p_next_to_last_sheet
+                 )                                      ;
+    void        calc_next_super_time_step
+                 (  method_type         method
+                  , boundary_type       boundary
+                  , bool                is_parallel_method
+                  , rate_type           x_rate
+                  , rate_type           y_rate
+                  , sheet_type const &  src_sheet
+                  , sheet_type       &  trg_sheet
+                 )                                      ;
+    void        clear_technique_memory( technique_type in_use)
+                                                        ;
+
+  public:
+    // The number of RKL2 stages a super-step with these rates needs to be stable.
+    enum { e_max_super_stage_count = 256 };
+    static size_type
+                get_super_stage_count
+                 (  rate_type  rate_x
+                  , rate_type  rate_y
                  )                                      ;
 
   protected:
-    void        fix_out_of_bounds_if_necessary
+    void        calc_next_pass_once
+                 (  technique_type      technique
+                  , method_type         method
+                  , boundary_type       boundary
+                  , bool                is_parallel_method
+                  , rate_type           damping
+                  , rate_type           rate_x
+                  , rate_type           rate_y
+                  , sheet_type const &  src_sheet
+                  , sheet_type       &  trg_sheet
+                  , tile_activity_type *
+                                        p_tiles
+                  , rate_type           clamp_limit
+                  , sheet_stats_type *  p_stats
+                 )                                      ;
+    void        calc_next_pass_in_sub_steps
+                 (  technique_type      technique
+                  , method_type         method
+                  , boundary_type       boundary
+                  , bool                is_parallel_method
+                  , rate_type           damping
+                  , rate_type           rate_x
+                  , rate_type           rate_y
+                  , size_type           sub_step_count
+                  , sheet_type const &  src_sheet
+                  , sheet_type       &  trg_sheet
+                  , sheet_stats_type *  p_stats
+                 )                                      ;
+    static value_type
+                calc_step_error_estimate
+                 (  sheet_type const &  sheet_0
+                  , sheet_type const &  sheet_1
+                  , sheet_type const &  sheet_2
+                 )                                      ;
+
+  public:
+    // Stability limits. Above the limit a pass is split into sub-steps with smaller rates.
+    enum { e_max_sub_step_count = 1024, e_max_error_refine_count = 2 };
+
+    static size_type
+                get_stable_sub_step_count
+                 (  technique_type  technique
+                  , method_type     method
+                  , rate_type       rate_x
+                  , rate_type       rate_y
+                 )                                      ;
+    static rate_type
+                get_step_error_tolerance( )             { return rate_type( 1) / 128; }
+
+    // A tile that changes less than this in a pass is quiet (see tile_activity_type).
+    static rate_type
+                get_quiet_tile_tolerance( )             { return rate_type( 1) / (1 << 20); }
+
+  protected:
+    // Solves that might blow up are clamped to [-limit, +limit] (see get_clamp_limit(..)).
+    static rate_type
+                get_out_of_bounds_limit( )              { return 100; }
+    static rate_type
+                get_clamp_limit
                  (  technique_type  technique
                   , method_type     method
                   , rate_type       damping
                   , rate_type       rate_x
                   , rate_type       rate_y
-                  , sheet_type &    trg_sheet
                  )                                      ;
-    void        fix_severely_out_of_bounds_sheet
-                 (  sheet_type &  trg_sheet
+    void        clamp_and_measure_sheet
+                 (  bool                is_parallel
+                  , rate_type           clamp_limit
+                  , sheet_stats_type *  p_stats
+                  , sheet_type       &  trg_sheet
+                 )                                      ;
+    sheet_stats_type *
+                get_row_stats( size_type row_count)     ;
+    void        add_row_stats
+                 (  size_type           row_count
+                  , sheet_stats_type &  stats
+                 )                                const ;
+    static bool is_out_of_bounds_fix_needed
+                 (  technique_type  technique
+                  , method_type     method
+                  , rate_type       damping
+                  , rate_type       rate_x
+                  , rate_type       rate_y
                  )                                      ;
 
   // -------------------------------------------------------------------------------------------
@@ -433,6 +813,48 @@ solver_type
     buf_iter_type       buf_iter_a_                     ;
     buf_iter_type       buf_iter_b_                     ;
 
+    buf_type            column_strip_src_               ;
+    buf_type            column_strip_trg_               ;
+
+    // The conductivity map for the solve in calc_next(..), or zero if there isn't one.
+    // The varying-conductivity solves have their own buffers, and ortho interleave needs a
+    // sheet between its forward-diff x and y passes.
+    conductivity_sheet_type const *
+                        p_conductivity_sheet_           ;
+    buf_type            varying_buf_a_                  ;
+    buf_type            varying_buf_b_                  ;
+    sheet_type          varying_pass_sheet_             ;
+
+    // The velocity sheet for the leapfrog wave in calc_next(..), or zero if there isn't one.
+    // The velocity belongs to the caller, and carries over from one solve to the next.
+    sheet_type       *  p_velocity_sheet_               ;
+
+    // The tiles the 5-point forward-diff solves skip, carried over from one solve to the next.
+    tile_activity_type  tile_activity_                  ;
+
+    implicit_matrix_cache_type
+     <  rate_type
+     >                  implicit_matrices_              ;
+
+    multigrid::v_cycle_type
+     <  sheet_type
+     >                  multigrid_                      ;
+    sheet_type          multigrid_rhs_                  ;
+
+    sheet_type          sub_step_sheet_a_               ;
+    sheet_type          sub_step_sheet_b_               ;
+
+    std::vector
+     <  sheet_stats_type
+     >                  row_stats_                      ;
+
+    sheet_type          super_stage_sheets_[ 3 ]        ;
+    sheet_type          super_stage_diff_0_             ;
+
+    spectral::cosine_transform_type
+     <  sheet_type
+     >                  spectral_                       ;
+
     calc_next_1d_forward_diff_serial_functor_type
      <  rate_type
       , src_iter_type
@@ -473,7 +895,169 @@ solver_type
       , buf_iter_type
      >                  central_diff_parallel_functor_  ;
 
-}; /* end class solver_type */
+}; /* end class basic_solver_type */
+
+// _______________________________________________________________________________________________
+// fixed_solver_type< INT_TYPE >
+
+  template< typename INT_TYPE >
+  class
+fixed_solver_type
+  //
+  // Solves on sheets of uniform_scalar< INT_TYPE >. Only simultaneous 2D forward-diff heat is
+  // supported, and only with rates inside the forward-diff stability limit. Check can_solve(..)
+  // before calling calc_next(..).
+  //
+  // The arithmetic saturates, so the values never leave [-1, +1] and we never have to fix
+  // out-of-bounds sheets.
+  //
+  // The methods are defined in heat_solver.cpp, which instantiates the 16- and 32-bit solvers.
+{
+  // -------------------------------------------------------------------------------------------
+  // Typedefs
+  public:
+    typedef INT_TYPE                                    int_type              ;
+    typedef uniform_scalar< int_type >                  value_type            ;
+    typedef value_sheet_type< value_type >              sheet_type            ;
+    typedef basic_sheet_params_type< sheet_type >       sheet_params_type     ;
+
+  // -------------------------------------------------------------------------------------------
+  // Controls
+  public:
+    output_params_type const &
+                get_output_params( )              const { return output_params_; }
+
+    bool        is_early_exit( )                  const { return output_params_.is_early_exit( ); }
+    void        request_early_exit( )                   { output_params_.ref_early_exit( ) = true; }
+
+  // -------------------------------------------------------------------------------------------
+  // Solve calculations
+  public:
+    static bool can_solve( input_params_type const &)   ;
+
+    void        calc_next
+                 (  input_params_type const &  input_params
+                  , sheet_params_type const &  sheet_params
+                 )                                      ;
+
+  // -------------------------------------------------------------------------------------------
+  // Member vars
+  private:
+    output_params_type  output_params_ ;
+
+}; /* end class fixed_solver_type */
+
+// _______________________________________________________________________________________________
+// half_solver_type
+
+  class
+half_solver_type
+  //
+  // Solves on sheets of half_float_type. Like fixed_solver_type, only simultaneous 2D
+  // forward-diff heat is supported, and only with rates inside the forward-diff stability limit
+  // (the values would soon be infinite outside it). Check can_solve(..) before calling
+  // calc_next(..).
+  //
+  // The sheets are stored in half and solved in float a row at a time.
+{
+  // -------------------------------------------------------------------------------------------
+  // Typedefs
+  public:
+    typedef half_float_type                             value_type            ;
+    typedef half_sheet_type                             sheet_type            ;
+    typedef basic_sheet_params_type< sheet_type >       sheet_params_type     ;
+
+  // -------------------------------------------------------------------------------------------
+  // Controls
+  public:
+    output_params_type const &
+                get_output_params( )              const { return output_params_; }
+
+    bool        is_early_exit( )                  const { return output_params_.is_early_exit( ); }
+    void        request_early_exit( )                   { output_params_.ref_early_exit( ) = true; }
+
+  // -------------------------------------------------------------------------------------------
+  // Solve calculations
+  public:
+    static bool can_solve( input_params_type const &)   ;
+
+    void        calc_next
+                 (  input_params_type const &  input_params
+                  , sheet_params_type const &  sheet_params
+                 )                                      ;
+
+  // -------------------------------------------------------------------------------------------
+  // Member vars
+  private:
+    output_params_type  output_params_ ;
+
+}; /* end class half_solver_type */
+
+// _______________________________________________________________________________________________
+// shadow_sheets_type< SHEET_TYPE >
+
+  template< typename SHEET_TYPE >
+  class
+shadow_sheets_type
+  //
+  // Shadows of the (float) src, trg, and extra sheets, and the leapfrog velocity, in another
+  // value type, for the solvers that do not work on float sheets. See attach(..) in
+  // heat_solver.cpp. The methods are defined in heat_solver.cpp, which instantiates the types
+  // we need.
+{
+  // -------------------------------------------------------------------------------------------
+  public:
+    typedef SHEET_TYPE                                  shadow_sheet_type     ;
+    typedef basic_sheet_params_type< shadow_sheet_type >
+                                                        sheet_params_type     ;
+
+  // -------------------------------------------------------------------------------------------
+  public:
+    void        attach
+                 (  sheet_type const &  src_sheet
+                  , sheet_type const &  trg_sheet
+                  , sheet_type const &  extra_sheet
+                  , sheet_type const *  p_velocity_sheet
+                 )                                      ;
+    sheet_params_type
+                get_sheet_params
+                 (  conductivity_sheet_type const *
+                                        p_conductivity_sheet
+                 )                                      ;
+    void        copy_back
+                 (  sheet_type       &  trg_sheet
+                  , sheet_type       &  extra_sheet
+                  , sheet_type       *  p_velocity_sheet
+                 )                                const ;
+    void        release( )                              ;
+
+  // -------------------------------------------------------------------------------------------
+  // Member vars
+  private:
+    // Which shadow goes with which sheet changes from solve to solve.
+    shadow_sheet_type   shadows_[ 3 ]       ;
+    int                 shadow_indexes_[ 3 ] ; /* src, trg, extra */
+
+    // The leapfrog velocity always has the same shadow.
+    shadow_sheet_type   velocity_shadow_     ;
+    bool                is_velocity_attached_ ;
+
+}; /* end class shadow_sheets_type */
+
+// _______________________________________________________________________________________________
+// transform_job_type
+//
+//   A change to a sheet, like stamping a bell curve or normalizing, that control_type::transform(..)
+//   runs in the worker thread between solves. run( ) can map rows on the current row pool.
+
+  class
+transform_job_type
+{
+  public:
+    virtual     ~transform_job_type( )                  { }
+    virtual
+    void        run( )                            const = 0;
+};
 
 // _______________________________________________________________________________________________
 // control_type
@@ -500,9 +1084,26 @@ control_type
                  (  sheet_type const &  src_sheet
                   , sheet_type       &  trg_sheet
                   , sheet_type       &  extra_sheet
+                  , conductivity_sheet_type const *
+                                        p_conductivity_sheet /* zero means the same conductivity everywhere */
+                  , sheet_type       *  p_velocity_sheet     /* zero unless solving the leapfrog wave */
+                  , draw_buffer_type *  p_draw_buffer        /* zero means the caller publishes the result */
                   , bool                are_extra_passes_disabled
+                  , bool                is_src_from_last_solve /* src is the last solve's trg, unchanged */
+                  , bool                is_free_run_allowed    /* the worker can keep solving for the free-run slice */
                  )                                         ;
 
+    // Asks the worker to finish a free run after the solve it's working on now.
+    void        request_free_run_stop( )                   ;
+
+  // -------------------------------------------------------------------------------------------
+  // Sheet transforms
+  public:
+    // Runs *p_job in the worker thread and emits transform_finished( ) when it is done. Like
+    // calc_next(..), this is only called when we are not busy, so jobs and solves run one at a
+    // time in the order they are started. Deletes p_job when it is done.
+    void        transform( transform_job_type const * p_job) ;
+
   // -------------------------------------------------------------------------------------------
   // Status and statistics
   public:
@@ -518,6 +1119,14 @@ control_type
 
     bool        is_going_down( )                     const ; /* exiting or is_early_exit */
 
+    // How many of the generations from the last calc_next(..) were never published for drawing.
+    // This does not count the last generation, which is the caller's to publish if we didn't.
+    size_type   get_skipped_generation_count( )      const ;
+
+    // False if we did not publish the last generation because we published one less than a
+    // frame ago, or because there was nothing to publish it to.
+    bool        is_last_generation_published( )      const ;
+
   // -------------------------------------------------------------------------------------------
   // Param getters
   public:
@@ -526,13 +1135,38 @@ control_type
     bool        is_technique__ortho_interleave(  )   const { return get_technique( ) == e_ortho_interleave ; }
     bool        is_technique__simultaneous_2d(   )   const { return get_technique( ) == e_simultaneous_2d  ; }
     bool        is_technique__wave_with_damping( )   const { return get_technique( ) == e_wave_with_damping; }
+    bool        is_technique__implicit_multigrid( )  const { return get_technique( ) == e_implicit_multigrid; }
+    bool        is_technique__spectral_jump( )       const { return get_technique( ) == e_spectral_jump; }
+    bool        is_technique__super_time_step( )     const { return get_technique( ) == e_super_time_step; }
+    bool        is_technique__wave_leapfrog( )       const { return get_technique( ) == e_wave_leapfrog; }
 
     method_type get_method( )                        const { return input_params_.get_method( ); }
     bool        is_method__forward_diff(  )          const { return get_method( ) == e_forward_diff ; }
     bool        is_method__backward_diff( )          const { return get_method( ) == e_backward_diff; }
     bool        is_method__central_diff(  )          const { return get_method( ) == e_central_diff ; }
+    bool        is_method__forward_diff_9_point( )   const { return get_method( ) == e_forward_diff_9_point  ; }
+    bool        is_method__forward_diff_4th_order( ) const { return get_method( ) == e_forward_diff_4th_order; }
 
     bool        is_method_parallel( )                const { return input_params_.is_method_parallel( ); }
+    int         get_thread_count( )                  const { return row_pool_.get_requested_thread_count( ); } /* zero means one for each core */
+
+    // The master thread can map on the solver's threads between solves, when they are idle.
+    row_pool::pool_type *
+                get_row_pool( )                            { return & row_pool_; }
+
+    boundary_type
+                get_boundary( )                      const { return input_params_.get_boundary( ); }
+    bool        is_boundary__insulated( )            const { return get_boundary( ) == e_boundary_insulated; }
+    bool        is_boundary__fixed( )                const { return get_boundary( ) == e_boundary_fixed    ; }
+    bool        is_boundary__periodic( )             const { return get_boundary( ) == e_boundary_periodic ; }
+    bool        is_boundary__absorbing( )            const { return get_boundary( ) == e_boundary_absorbing; }
+
+    precision_type
+                get_precision( )                     const { return input_params_.get_precision( ); }
+    bool        is_precision__double( )              const { return get_precision( ) == e_double_precision ; }
+    bool        is_precision__fixed16( )             const { return get_precision( ) == e_fixed16_precision; }
+    bool        is_precision__fixed32( )             const { return get_precision( ) == e_fixed32_precision; }
+    bool        is_precision__half( )                const { return get_precision( ) == e_half_precision   ; }
 
     rate_type   get_damping( )                       const { return input_params_.get_damping( ); }
     rate_type   get_rate_x( )                        const { return input_params_.get_rate_x( ); }
@@ -542,6 +1176,8 @@ control_type
     size_type   get_pass_count( )                    const { return input_params_.get_pass_count( ); }
     bool        has_extra_passes( )                  const { return input_params_.has_extra_passes( ); }
     bool        are_extra_passes_disabled( )         const { return input_params_.are_extra_passes_disabled( ); }
+    bool        is_skipping_quiet_tiles( )           const { return input_params_.is_skipping_quiet_tiles( ); }
+    int         get_free_run_msecs( )                const { return free_run_msecs_; } /* zero means solve once */
 
   // -------------------------------------------------------------------------------------------
   // Param setters
@@ -549,40 +1185,84 @@ control_type
     void        set_rates( rate_type rx, rate_type ry)     ;
     void        set_technique( technique_type te)          ;
     void        set_method( method_type m)                 ;
+    void        set_boundary( boundary_type b)             ;
+    void        set_precision( precision_type p)           ;
+  protected:
+    void        set__is_precision( precision_type, bool is) ;
   signals:
     void        technique_is_changed( )                    ; /* signal */
     void        method_is_changed( )                       ; /* signal */
+    void        boundary_is_changed( )                     ; /* signal */
+    void        precision_is_changed( )                    ; /* signal */
 
   public:
     void        set_technique__ortho_interleave( )         { set_technique( e_ortho_interleave ); }
     void        set_technique__simultaneous_2d( )          { set_technique( e_simultaneous_2d  ); }
     void        set_technique__wave_with_damping( )        { set_technique( e_wave_with_damping); }
+    void        set_technique__implicit_multigrid( )       { set_technique( e_implicit_multigrid); }
+    void        set_technique__spectral_jump( )            { set_technique( e_spectral_jump); }
+    void        set_technique__super_time_step( )          { set_technique( e_super_time_step); }
+    void        set_technique__wave_leapfrog( )            { set_technique( e_wave_leapfrog); }
 
     void        set_method__forward_diff( )                { set_method( e_forward_diff ); }
     void        set_method__backward_diff( )               { set_method( e_backward_diff); }
     void        set_method__central_diff( )                { set_method( e_central_diff ); }
+    void        set_method__forward_diff_9_point( )        { set_method( e_forward_diff_9_point  ); }
+    void        set_method__forward_diff_4th_order( )      { set_method( e_forward_diff_4th_order); }
+
+    void        set_boundary__insulated( )                 { set_boundary( e_boundary_insulated); }
+    void        set_boundary__fixed( )                     { set_boundary( e_boundary_fixed    ); }
+    void        set_boundary__periodic( )                  { set_boundary( e_boundary_periodic ); }
+    void        set_boundary__absorbing( )                 { set_boundary( e_boundary_absorbing); }
   public slots:
     void        set_technique__ortho_interleave(  bool y)  { if ( y ) { set_technique__ortho_interleave(  ); } }
     void        set_technique__simultaneous_2d(   bool y)  { if ( y ) { set_technique__simultaneous_2d(   ); } }
     void        set_technique__wave_with_damping( bool y)  { if ( y ) { set_technique__wave_with_damping( ); } }
+    void        set_technique__implicit_multigrid( bool y) { if ( y ) { set_technique__implicit_multigrid( ); } }
+    void        set_technique__spectral_jump( bool y)      { if ( y ) { set_technique__spectral_jump( ); } }
+    void        set_technique__super_time_step( bool y)    { if ( y ) { set_technique__super_time_step( ); } }
+    void        set_technique__wave_leapfrog( bool y)      { if ( y ) { set_technique__wave_leapfrog( ); } }
 
     void        set_method__forward_diff(  bool is_chk)    { if ( is_chk ) { set_method__forward_diff(  ); } }
     void        set_method__backward_diff( bool is_chk)    { if ( is_chk ) { set_method__backward_diff( ); } }
     void        set_method__central_diff(  bool is_chk)    { if ( is_chk ) { set_method__central_diff(  ); } }
+    void        set_method__forward_diff_9_point( bool is_chk)
+                                                           { if ( is_chk ) { set_method__forward_diff_9_point( ); } }
+    void        set_method__forward_diff_4th_order( bool is_chk)
+                                                           { if ( is_chk ) { set_method__forward_diff_4th_order( ); } }
+
+    void        set_boundary__insulated( bool is_chk)      { if ( is_chk ) { set_boundary__insulated( ); } }
+    void        set_boundary__fixed(     bool is_chk)      { if ( is_chk ) { set_boundary__fixed(     ); } }
+    void        set_boundary__periodic(  bool is_chk)      { if ( is_chk ) { set_boundary__periodic(  ); } }
+    void        set_boundary__absorbing( bool is_chk)      { if ( is_chk ) { set_boundary__absorbing( ); } }
   public slots:
     void        set__is_method_parallel( bool is)          ;
+    void        set_thread_count( int c)                   ; /* zero means one for each core */
+    void        set__is_skipping_quiet_tiles( bool is)     ;
+    void        set__is_precision_double( bool is)         ;
+    void        set__is_precision_fixed16( bool is)        ;
+    void        set__is_precision_fixed32( bool is)        ;
+    void        set__is_precision_half( bool is)           ;
     void        set_damping( double d)                     ;
     void        set_pass_count( int c)                     ;
+    void        set_free_run_msecs( int ms)                ; /* zero means solve once */
 
   // -------------------------------------------------------------------------------------------
   // Slot
   private slots:
     void        finished__from_worker_thread( double)      ; /* cross thread, from worker to control */
+    void        transform_finished__from_worker_thread( )  ; /* cross thread, from worker to control */
 
   // -------------------------------------------------------------------------------------------
   // Signal
   signals:
     void        finished( )                                ; /* the outside world listens for this signal */
+    void        published( )                               ; /* a sheet was published in the middle of a free run */
+    void        transform_finished( )                      ; /* the job from transform(..) is done */
+
+  // -------------------------------------------------------------------------------------------
+  private:
+    void        start_worker( )                            ;
 
   // -------------------------------------------------------------------------------------------
   // Private member vars
@@ -595,6 +1275,12 @@ control_type
     double                      last_duration_ ;
     worker_thread_type *        p_worker_      ;
 
+    // How long the worker keeps solving, without reporting back, when free running is allowed.
+    int                         free_run_msecs_ ;
+
+    // The threads for the parallel solvers. The worker thread makes this its current pool.
+    row_pool::pool_type         row_pool_      ;
+
 } /* end class control_type */ ;
 
 // _______________________________________________________________________________________________
@@ -615,7 +1301,7 @@ worker_thread_type
   // -------------------------------------------------------------------------------------------
   // Ctor, only used by friend class
   protected:
-    /* ctor */  worker_thread_type( QObject * p_parent) ;
+    /* ctor */  worker_thread_type( QObject * p_parent, row_pool::pool_type * p_row_pool) ;
 
   // Dtor, always from the supertype
   private:
@@ -635,14 +1321,57 @@ worker_thread_type
                   , sheet_type        const &  src_sheet
                   , sheet_type              &  trg_sheet
                   , sheet_type              &  extra_sheet
+                  , conductivity_sheet_type const *
+                                               p_conductivity_sheet
+                  , sheet_type              *  p_velocity_sheet
+                  , draw_buffer_type        *  p_draw_buffer
+                  , double                     free_run_seconds /* zero means solve once */
+                 )                                      ;
+    void        start_transform__from_master_thread
+                 (  transform_job_type const *  p_job
                  )                                      ;
 
   // -------------------------------------------------------------------------------------------
   protected:
     output_params_type const &
-                get_output_params( )              const { return solver_.get_output_params( ); }
+                get_output_params( )              const ;
+    output_params_type const &
+                get_last_solve_output_params( )   const ;
+    size_type   get_skipped_generation_count( )   const { return skipped_generation_count_; }
+    bool        is_last_generation_published( )   const { return is_last_generation_published_; }
+
+    void        request_free_run_stop( )                { is_free_run_stop_requested_.fetchAndStoreOrdered( 1); }
+
+    void        request_early_exit( )                   { solver_.request_early_exit( );
+                                                          double_solver_.request_early_exit( );
+                                                          fixed16_solver_.request_early_exit( );
+                                                          fixed32_solver_.request_early_exit( );
+                                                          half_solver_.request_early_exit( );
+                                                        }
+
+  // -------------------------------------------------------------------------------------------
+  // Solve in the shadow sheets
+  protected:
+    void        calc_next_in_precision( )               ;
+    void        release_shadows_not_used( )             ;
+    void        forget_quiet_tile_sheets( )             ;
 
-    void        request_early_exit( )                   { solver_.request_early_exit( ); }
+  // -------------------------------------------------------------------------------------------
+  // Publish for drawing, at about the frame rate of the display
+  protected:
+    bool        maybe_publish( sheet_type const &)      ; /* returns true if it published */
+
+  // -------------------------------------------------------------------------------------------
+  // Keep solving without reporting back to the master thread
+  protected:
+    size_type   free_run( tick_point_type start_tick)   ; /* returns how many sheets it published */
+    bool        is_free_run_slice_left( tick_point_type start_tick)
+                                                        ;
+
+  // -------------------------------------------------------------------------------------------
+  // Run a sheet transform instead of a solve
+  protected:
+    void        run_transform( )                        ;
 
   // -------------------------------------------------------------------------------------------
   // Slot
@@ -654,17 +1383,57 @@ worker_thread_type
   signals:
     void        start__master_to_worker( )              ; /* cross-thread, from control to worker */
     void        finished__worker_to_master( double)     ; /* cross-thread, from worker to control */
+    void        published__worker_to_master( )          ; /* cross-thread, from worker to control */
+    void        transform_finished__worker_to_master( ) ; /* cross-thread, from worker to control */
 
   // -------------------------------------------------------------------------------------------
   // Private member vars
   private:
-    QSemaphore          init_wait_     ;
-    solver_type         solver_        ;
-    input_params_type   input_params_  ;
-
-    sheet_type const *  p_src_sheet_   ;
-    sheet_type       *  p_trg_sheet_   ;
-    sheet_type       *  p_extra_sheet_ ;
+    QSemaphore          init_wait_             ;
+    row_pool::pool_type * const
+                        p_row_pool_            ;
+    solver_type         solver_                ;
+    settable_input_params_type
+                        input_params_          ;
+
+    sheet_type const *  p_src_sheet_           ;
+    sheet_type       *  p_trg_sheet_           ;
+    sheet_type       *  p_extra_sheet_         ;
+    conductivity_sheet_type const *
+                        p_conductivity_sheet_  ;
+    sheet_type       *  p_velocity_sheet_      ;
+    draw_buffer_type *  p_draw_buffer_         ;
+
+    // Set instead of the sheets when the master thread starts a transform instead of a solve.
+    transform_job_type const *
+                        p_transform_job_       ;
+
+    // Solvers for the other precisions, and their shadows of the src, trg, and extra sheets.
+    double_solver_type  double_solver_         ;
+    fixed16_solver_type fixed16_solver_        ;
+    fixed32_solver_type fixed32_solver_        ;
+    half_solver_type    half_solver_           ;
+
+    shadow_sheets_type< double_sheet_type  >   double_shadows_  ;
+    shadow_sheets_type< fixed16_sheet_type >   fixed16_shadows_ ;
+    shadow_sheets_type< fixed32_sheet_type >   fixed32_shadows_ ;
+    shadow_sheets_type< half_sheet_type    >   half_shadows_    ;
+
+    // Which solver ran last, and has the output params.
+    precision_type      last_precision_        ;
+
+    // Free running. The spare sheet lets the solves go around without writing src, which belongs
+    // to the master thread. The output params add up all the solves in the free run.
+    double              free_run_seconds_      ;
+    QAtomicInt          is_free_run_stop_requested_ ;
+    sheet_type          free_run_sheet_        ;
+    output_params_type  free_run_output_params_ ;
+    bool                is_free_run_output_    ;
+    size_type           skipped_generation_count_ ;
+
+    // When we last published for drawing, in this solve or an earlier one.
+    tick_point_type     last_publish_tick_     ;
+    bool                is_last_generation_published_ ;
 
 } /* end class worker_thread_type */ ;
 
@@ -853,6 +853,12 @@ init_solve_control( )
         p_sheet_control_, SIGNAL( sheet_is_changed( )),
         this, SLOT( maybe_update_after_sheet_change( ))));
 
+    // A free-running solve publishes sheets before it's finished. The current sheet has not
+    // changed yet, but there is something new to draw.
+    d_verify( connect(
+        p_sheet_control_, SIGNAL( published_sheet_is_changed( )),
+        this, SLOT( maybe_update( ))));
+
     d_verify( connect(
         p_sheet_control_, SIGNAL( auto_solving_started( bool)),
         this, SLOT( maybe_update_after_auto_solve_stop( bool))));
@@ -0,0 +1,508 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// multigrid.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef MULTIGRID_H
+# define MULTIGRID_H
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// Geometric multigrid for the fully coupled 2D implicit heat step.
+//
+//   The ortho-interleave and simultaneous techniques split the 2D implicit step into 1D solves
+//   along the rows and columns. That is cheap but loses accuracy at large rates. Here we solve
+//   the whole 2D system
+//
+//     u - (rate_x * Dxx u) - (rate_y * Dyy u) = rhs
+//
+//   with insulated edges (an edge cell's missing neighbor is the cell itself), the same edges
+//   as the rest of the solvers.
+//
+//   The cells are the centers of the grid squares. Each coarser level has about half as many
+//   cells in each direction, and the sheet's copy_preserve_heights(..) (line_walker_type) moves
+//   values between levels: averaging down (restriction) and spreading up (prolongation).
+//   The rates on a coarser level shrink by the square of the size ratio.
+//
+//   The smoother is red-black Gauss-Seidel. Each color is a set of independent rows, so a
+//   parallel solve gives each thread a group of rows.
+//   The coarsest level is 2x2 (unless the sheet is thinner than that), and is solved exactly.
+//
+//   SHEET_TYPE is sheet_type (float) or value_sheet_type< double >.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <vector>
+# include <limits>
+# include <algorithm>
+# include <cmath>
+# include "debug.h"
+# include "row_pool.h"
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+namespace multigrid {
+
+typedef std::pair< std::size_t, std::size_t >  row_group_type ; /* [y_lo, y_hi_plus) */
+
+// _______________________________________________________________________________________________
+// gauss_seidel_functor_type< VALUE_TYPE >
+//
+//   One color of a red-black Gauss-Seidel sweep, on a group of rows.
+
+  template< typename VALUE_TYPE >
+  struct
+gauss_seidel_functor_type
+{
+    gauss_seidel_functor_type
+     (  VALUE_TYPE         *  p_u
+      , VALUE_TYPE const   *  p_f
+      , std::size_t const     x_count
+      , std::size_t const     y_count
+      , VALUE_TYPE  const     rate_x
+      , VALUE_TYPE  const     rate_y
+      , std::size_t const     color     // 0 or 1, updates the cells where ((x + y) % 2) == color
+     )
+      : p_u_      ( p_u     )
+      , p_f_      ( p_f     )
+      , x_count_  ( x_count )
+      , y_count_  ( y_count )
+      , rate_x_   ( rate_x  )
+      , rate_y_   ( rate_y  )
+      , color_    ( color   )
+      { }
+      VALUE_TYPE        *  const  p_u_     ;
+      VALUE_TYPE const  *  const  p_f_     ;
+      std::size_t          const  x_count_ ;
+      std::size_t          const  y_count_ ;
+      VALUE_TYPE           const  rate_x_  ;
+      VALUE_TYPE           const  rate_y_  ;
+      std::size_t          const  color_   ;
+
+      void
+    operator ()( row_group_type const & y_lo_hi_plus) const
+      {
+        for ( std::size_t y = y_lo_hi_plus.first ; y < y_lo_hi_plus.second ; y += 1 ) {
+            VALUE_TYPE       * const  p_u  = p_u_ + (y * x_count_);
+            VALUE_TYPE const * const  p_f  = p_f_ + (y * x_count_);
+            bool const  has_lo_row  = (y > 0);
+            bool const  has_hi_row  = ((y + 1) < y_count_);
+
+            for ( std::size_t x = (y + color_) % 2 ; x < x_count_ ; x += 2 ) {
+                VALUE_TYPE sum  = p_f[ x ];
+                VALUE_TYPE diag = 1;
+                if ( x > 0 )              { sum += rate_x_ * p_u[ x - 1 ];        diag += rate_x_; }
+                if ( (x + 1) < x_count_ ) { sum += rate_x_ * p_u[ x + 1 ];        diag += rate_x_; }
+                if ( has_lo_row )         { sum += rate_y_ * p_u[ x - x_count_ ]; diag += rate_y_; }
+                if ( has_hi_row )         { sum += rate_y_ * p_u[ x + x_count_ ]; diag += rate_y_; }
+                p_u[ x ] = sum / diag;
+            }
+        }
+      }
+};
+
+// _______________________________________________________________________________________________
+// residual_functor_type< VALUE_TYPE >
+//
+//   r = f - (A u), on a group of rows.
+
+  template< typename VALUE_TYPE >
+  struct
+residual_functor_type
+{
+    residual_functor_type
+     (  VALUE_TYPE const   *  p_u
+      , VALUE_TYPE const   *  p_f
+      , VALUE_TYPE         *  p_r
+      , std::size_t const     x_count
+      , std::size_t const     y_count
+      , VALUE_TYPE  const     rate_x
+      , VALUE_TYPE  const     rate_y
+     )
+      : p_u_      ( p_u     )
+      , p_f_      ( p_f     )
+      , p_r_      ( p_r     )
+      , x_count_  ( x_count )
+      , y_count_  ( y_count )
+      , rate_x_   ( rate_x  )
+      , rate_y_   ( rate_y  )
+      { }
+      VALUE_TYPE const  *  const  p_u_     ;
+      VALUE_TYPE const  *  const  p_f_     ;
+      VALUE_TYPE        *  const  p_r_     ;
+      std::size_t          const  x_count_ ;
+      std::size_t          const  y_count_ ;
+      VALUE_TYPE           const  rate_x_  ;
+      VALUE_TYPE           const  rate_y_  ;
+
+      void
+    operator ()( row_group_type const & y_lo_hi_plus) const
+      {
+        for ( std::size_t y = y_lo_hi_plus.first ; y < y_lo_hi_plus.second ; y += 1 ) {
+            VALUE_TYPE const * const  p_u  = p_u_ + (y * x_count_);
+            VALUE_TYPE const * const  p_f  = p_f_ + (y * x_count_);
+            VALUE_TYPE       * const  p_r  = p_r_ + (y * x_count_);
+            bool const  has_lo_row  = (y > 0);
+            bool const  has_hi_row  = ((y + 1) < y_count_);
+
+            for ( std::size_t x = 0 ; x < x_count_ ; x += 1 ) {
+                VALUE_TYPE const u     = p_u[ x ];
+                VALUE_TYPE       diff  = 0;
+                if ( x > 0 )              { diff += rate_x_ * (p_u[ x - 1 ]        - u); }
+                if ( (x + 1) < x_count_ ) { diff += rate_x_ * (p_u[ x + 1 ]        - u); }
+                if ( has_lo_row )         { diff += rate_y_ * (p_u[ x - x_count_ ] - u); }
+                if ( has_hi_row )         { diff += rate_y_ * (p_u[ x + x_count_ ] - u); }
+                p_r[ x ] = p_f[ x ] - (u - diff);
+            }
+        }
+      }
+};
+
+// _______________________________________________________________________________________________
+// v_cycle_type< SHEET_TYPE >
+//
+//   Keeps the coarse levels from one solve to the next, so we only allocate them again when
+//   the sheet size changes.
+
+  template< typename SHEET_TYPE >
+  class
+v_cycle_type
+{
+  // -------------------------------------------------------------------------------------------
+  public:
+    typedef SHEET_TYPE                          sheet_type ;
+    typedef typename sheet_type::value_type     value_type ;
+    typedef typename sheet_type::size_type      size_type  ;
+
+    // Smoothing sweeps before and after each coarse-grid correction, and on the coarsest level
+    // when it is not 2x2.
+    enum { e_pre_sweep_count = 2, e_post_sweep_count = 2, e_coarsest_sweep_count = 16 };
+
+    // We usually converge in well under this many V-cycles.
+    enum { e_max_cycle_count = 40 };
+
+  // -------------------------------------------------------------------------------------------
+  public:
+    /* ctor */  v_cycle_type( )                         : levels_( ), is_parallel_( false) { }
+
+    void        clear( )                                { levels_.clear( ); }
+
+    // Solves u - (rate_x * Dxx u) - (rate_y * Dyy u) = rhs for u, starting with the values
+    // in trg_sheet and leaving u there. rhs_sheet and trg_sheet cannot be the same sheet.
+    // Returns the number of V-cycles.
+    size_type   solve
+                 (  bool        const &  is_early_exit
+                  , bool                 is_parallel
+                  , value_type           rate_x
+                  , value_type           rate_y
+                  , sheet_type  const &  rhs_sheet
+                  , sheet_type        &  trg_sheet
+                 )                                      ;
+
+  // -------------------------------------------------------------------------------------------
+  protected:
+      struct
+    level_type
+    {
+        sheet_type  u_      ; /* solution (correction), not used on the finest level */
+        sheet_type  f_      ; /* rhs (restricted residual), not used on the finest level */
+        sheet_type  r_      ; /* residual, and then the correction from the coarser level */
+        value_type  rate_x_ ;
+        value_type  rate_y_ ;
+    };
+
+    void        set_up_levels
+                 (  size_type   x_count
+                  , size_type   y_count
+                  , value_type  rate_x
+                  , value_type  rate_y
+                 )                                      ;
+    void        do_v_cycle
+                 (  size_type           level_index
+                  , sheet_type &        u
+                  , sheet_type const &  f
+                 )                                      ;
+    void        smooth
+                 (  level_type const &  level
+                  , sheet_type &        u
+                  , sheet_type const &  f
+                  , size_type           sweep_count
+                 )                                const ;
+    void        solve_2x2
+                 (  level_type const &  level
+                  , sheet_type &        u
+                  , sheet_type const &  f
+                 )                                const ;
+    value_type  calc_residual
+                 (  level_type &        level
+                  , sheet_type const &  u
+                  , sheet_type const &  f
+                 )                                const ;
+
+      template< typename FUNCTOR_TYPE >
+    void        map_rows( FUNCTOR_TYPE const &, size_type x_count, size_type y_count)
+                                                  const ;
+
+  // -------------------------------------------------------------------------------------------
+  private:
+    std::vector< level_type >  levels_      ;
+    bool                       is_parallel_ ;
+};
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  typename v_cycle_type< SHEET_TYPE >::size_type
+  v_cycle_type< SHEET_TYPE >::
+solve
+ (  bool        const &  is_early_exit
+  , bool                 is_parallel
+  , value_type           rate_x
+  , value_type           rate_y
+  , sheet_type  const &  rhs_sheet
+  , sheet_type        &  trg_sheet
+ )
+{
+    d_assert( (& rhs_sheet) != (& trg_sheet));
+    d_assert( rhs_sheet.get_x_count( ) == trg_sheet.get_x_count( ));
+    d_assert( rhs_sheet.get_y_count( ) == trg_sheet.get_y_count( ));
+    d_assert( (rate_x >= 0) && (rate_y >= 0));
+    if ( rhs_sheet.is_reset( ) ) return 0;
+
+    is_parallel_ = is_parallel;
+    set_up_levels( rhs_sheet.get_x_count( ), rhs_sheet.get_y_count( ), rate_x, rate_y);
+
+    // Stop when the residual is down to rounding noise. The residual adds up terms as big as
+    // (rate * u), so the noise grows with the rates. |u| is never bigger than the biggest |rhs|.
+    value_type rhs_max = 0;
+    for ( typename sheet_type::const_iterator iter = rhs_sheet.begin( ) ; iter != rhs_sheet.end( ) ; ++ iter ) {
+        rhs_max = std::max( rhs_max, static_cast< value_type >( std::fabs( *iter)));
+    }
+    value_type const tolerance =
+        16 * std::numeric_limits< value_type >::epsilon( ) * (1 + (4 * (rate_x + rate_y))) * (1 + rhs_max);
+
+    size_type cycle_count = 0;
+    while ( (cycle_count < size_type( e_max_cycle_count)) && ! is_early_exit ) {
+        do_v_cycle( 0, trg_sheet, rhs_sheet);
+        cycle_count += 1;
+        if ( calc_residual( levels_[ 0 ], trg_sheet, rhs_sheet) <= tolerance ) break;
+    }
+    return cycle_count;
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+  v_cycle_type< SHEET_TYPE >::
+set_up_levels
+ (  size_type   x_count
+  , size_type   y_count
+  , value_type  rate_x
+  , value_type  rate_y
+ )
+{
+    // Keep the old levels if the sheet size has not changed.
+    if ( levels_.empty( ) ||
+         (levels_[ 0 ].r_.get_x_count( ) != x_count) ||
+         (levels_[ 0 ].r_.get_y_count( ) != y_count) )
+    {
+        // Count the levels first. The sheets in a level cannot be copied once they are sized
+        // (see the sheet_type copy ctor), so the vector must not grow after that.
+        size_type level_count = 1;
+        for ( size_type x = x_count, y = y_count ; (x > 2) || (y > 2) ; level_count += 1 ) {
+            if ( x > 2 ) { x = (x + 1) / 2; }
+            if ( y > 2 ) { y = (y + 1) / 2; }
+        }
+        levels_.clear( );
+        levels_.resize( level_count);
+
+        for ( size_type index = 0 ; index < level_count ; index += 1 ) {
+            level_type & level = levels_[ index ];
+            d_verify( level.r_.set_xy_counts( x_count, y_count, 0));
+            if ( index > 0 ) {
+                d_verify( level.u_.set_xy_counts( x_count, y_count, 0));
+                d_verify( level.f_.set_xy_counts( x_count, y_count, 0));
+            }
+            if ( x_count > 2 ) { x_count = (x_count + 1) / 2; }
+            if ( y_count > 2 ) { y_count = (y_count + 1) / 2; }
+        }
+    }
+
+    // The rates scale with the square of the cell size.
+    levels_[ 0 ].rate_x_ = rate_x;
+    levels_[ 0 ].rate_y_ = rate_y;
+    for ( size_type index = 1 ; index < levels_.size( ) ; index += 1 ) {
+        level_type const &  fine    = levels_[ index - 1 ];
+        level_type       &  coarse  = levels_[ index ];
+        value_type const    x_ratio = value_type( coarse.r_.get_x_count( )) / value_type( fine.r_.get_x_count( ));
+        value_type const    y_ratio = value_type( coarse.r_.get_y_count( )) / value_type( fine.r_.get_y_count( ));
+        coarse.rate_x_ = fine.rate_x_ * x_ratio * x_ratio;
+        coarse.rate_y_ = fine.rate_y_ * y_ratio * y_ratio;
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+  v_cycle_type< SHEET_TYPE >::
+do_v_cycle
+ (  size_type           level_index
+  , sheet_type &        u
+  , sheet_type const &  f
+ )
+{
+    level_type & level = levels_[ level_index ];
+    if ( (level_index + 1) == levels_.size( ) ) {
+        if ( (2 == u.get_x_count( )) && (2 == u.get_y_count( )) ) {
+            solve_2x2( level, u, f);
+        } else {
+            smooth( level, u, f, e_coarsest_sweep_count);
+        }
+        return;
+    }
+    level_type & coarse = levels_[ level_index + 1 ];
+
+    smooth( level, u, f, e_pre_sweep_count);
+
+    // Average the residual down to the coarse level, and solve there for the correction.
+    calc_residual( level, u, f);
+    d_verify( sheet_type::copy_preserve_heights( level.r_, coarse.f_));
+    coarse.u_.fill_sheet( 0);
+    do_v_cycle( level_index + 1, coarse.u_, coarse.f_);
+
+    // Spread the correction back up and add it in.
+    d_verify( sheet_type::copy_preserve_heights( coarse.u_, level.r_));
+    typename sheet_type::const_iterator  corr_iter  = level.r_.begin( );
+    for ( typename sheet_type::iterator iter = u.begin( ) ; iter != u.end( ) ; ++ iter, ++ corr_iter ) {
+        *iter += *corr_iter;
+    }
+
+    smooth( level, u, f, e_post_sweep_count);
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+  v_cycle_type< SHEET_TYPE >::
+smooth
+ (  level_type const &  level
+  , sheet_type &        u
+  , sheet_type const &  f
+  , size_type           sweep_count
+ ) const
+{
+    size_type const  x_count  = u.get_x_count( );
+    size_type const  y_count  = u.get_y_count( );
+    for ( size_type sweep = 0 ; sweep < sweep_count ; sweep += 1 ) {
+        for ( size_type color = 0 ; color < 2 ; color += 1 ) {
+            map_rows
+             (  gauss_seidel_functor_type< value_type >
+                 (  & (* u.begin( )), & (* f.begin( ))
+                  , x_count, y_count
+                  , level.rate_x_, level.rate_y_
+                  , color
+                 )
+              , x_count, y_count
+             );
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+  v_cycle_type< SHEET_TYPE >::
+solve_2x2
+ (  level_type const &  level
+  , sheet_type &        u
+  , sheet_type const &  f
+ ) const
+  // The coarsest level is usually 2x2, which we can solve exactly. Smoothing alone is very slow
+  // there when the sheet itself is tiny and the rates are big. The 4 cosine modes on 2x2 are
+  // sums and differences of the cells, and the system just divides each one by its eigenvalue.
+{
+    value_type const * const  p_f  = & (* f.begin( ));
+    value_type       * const  p_u  = & (* u.begin( ));
+
+    value_type const  mode_0   = p_f[ 0 ] + p_f[ 1 ] + p_f[ 2 ] + p_f[ 3 ];
+    value_type const  mode_x   = (p_f[ 0 ] - p_f[ 1 ] + p_f[ 2 ] - p_f[ 3 ]) / (1 + (2 * level.rate_x_));
+    value_type const  mode_y   = (p_f[ 0 ] + p_f[ 1 ] - p_f[ 2 ] - p_f[ 3 ]) / (1 + (2 * level.rate_y_));
+    value_type const  mode_xy  = (p_f[ 0 ] - p_f[ 1 ] - p_f[ 2 ] + p_f[ 3 ]) / (1 + (2 * level.rate_x_) + (2 * level.rate_y_));
+
+    p_u[ 0 ] = (mode_0 + mode_x + mode_y + mode_xy) / 4;
+    p_u[ 1 ] = (mode_0 - mode_x + mode_y - mode_xy) / 4;
+    p_u[ 2 ] = (mode_0 + mode_x - mode_y - mode_xy) / 4;
+    p_u[ 3 ] = (mode_0 - mode_x - mode_y + mode_xy) / 4;
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  typename v_cycle_type< SHEET_TYPE >::value_type
+  v_cycle_type< SHEET_TYPE >::
+calc_residual
+ (  level_type &        level
+  , sheet_type const &  u
+  , sheet_type const &  f
+ ) const
+  // Fills level.r_ and returns the largest (absolute) residual.
+{
+    size_type const  x_count  = u.get_x_count( );
+    size_type const  y_count  = u.get_y_count( );
+    map_rows
+     (  residual_functor_type< value_type >
+         (  & (* u.begin( )), & (* f.begin( )), & (* level.r_.begin( ))
+          , x_count, y_count
+          , level.rate_x_, level.rate_y_
+         )
+      , x_count, y_count
+     );
+
+    value_type max_residual = 0;
+    for ( typename sheet_type::const_iterator iter = level.r_.begin( ) ; iter != level.r_.end( ) ; ++ iter ) {
+        max_residual = std::max( max_residual, static_cast< value_type >( std::fabs( *iter)));
+    }
+    return max_residual;
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  template< typename FUNCTOR_TYPE >
+  void
+  v_cycle_type< SHEET_TYPE >::
+map_rows( FUNCTOR_TYPE const & functor, size_type x_count, size_type y_count) const
+  // Small levels are not worth splitting.
+{
+    row_pool::map_row_ranges
+     ( functor, y_count, x_count * sizeof( value_type), is_parallel_ && (y_count >= 64));
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+} /* end namespace multigrid */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef MULTIGRID_H
+//
+// multigrid.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
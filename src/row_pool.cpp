@@ -0,0 +1,491 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// row_pool.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+// _______________________________________________________________________________________________
+//
+// The pool threads sleep on start_wait_ between maps. A map hands out the ranges, bumps
+// job_serial_ and wakes them. The mapping thread works on its own range too, and then waits on
+// finish_wait_ until the last pool thread is done, so the job never outlives the map call.
+//
+// The ranges have their own mutexes so threads taking blocks from different ranges don't get in
+// each other's way. A thread never holds two range mutexes at once.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include "row_pool.h"
+# include <QtCore/QThreadStorage>
+
+// _______________________________________________________________________________________________
+//
+namespace row_pool {
+// _______________________________________________________________________________________________
+
+  class
+pool_thread_type
+  : public QThread
+  //
+  // One of the pool's threads. It has no signals or slots, so it is not a Q_OBJECT.
+{
+  public:
+    pool_thread_type( pool_type & pool, int index, unsigned job_serial)
+      : QThread     ( 0)
+      , pool_       ( pool)
+      , index_      ( index)
+      , job_serial_ ( job_serial)
+      { }
+
+  protected:
+    virtual
+      void
+    run( )
+      { pool_.thread_loop( index_, job_serial_); }
+
+  private:
+    pool_type &     pool_       ;
+    int      const  index_      ; /* which range is ours */
+    unsigned const  job_serial_ ; /* the last job before we started */
+};
+
+// _______________________________________________________________________________________________
+
+  /* ctor */
+  pool_type::
+pool_type( int thread_count)
+  //
+  // The threads are not started until the first map.
+  : mutex_                  ( )
+  , start_wait_             ( )
+  , finish_wait_            ( )
+  , requested_thread_count_ ( std::max( thread_count, 0))
+  , threads_                ( )
+  , ranges_                 ( 1, new range_type)
+  , p_job_                  ( 0)
+  , block_count_            ( 1)
+  , worker_count_           ( 0)
+  , busy_count_             ( 0)
+  , job_serial_             ( 0)
+  , is_mapping_             ( false)
+  , is_stopping_            ( false)
+{
+    ranges_[ 0 ]->lo = ranges_[ 0 ]->post = 0;
+}
+
+  /* dtor */
+  pool_type::
+~pool_type( )
+{
+    QMutexLocker lock( & mutex_);
+
+    // Nobody should be mapping as we go away.
+    d_assert( ! is_mapping_);
+    is_mapping_ = true;
+    stop_threads( );
+
+    for ( std::size_t index = 0 ; index < ranges_.size( ) ; ++ index ) {
+        delete ranges_[ index ];
+    }
+    ranges_.clear( );
+}
+
+// _______________________________________________________________________________________________
+
+  void
+  pool_type::
+set_thread_count( int thread_count)
+{
+    QMutexLocker lock( & mutex_);
+    requested_thread_count_ = std::max( thread_count, 0);
+}
+
+  int
+  pool_type::
+get_requested_thread_count( ) const
+{
+    QMutexLocker lock( & mutex_);
+    return requested_thread_count_;
+}
+
+  int
+  pool_type::
+get_thread_count( ) const
+{
+    int const requested = get_requested_thread_count( );
+    return (requested > 0) ? requested : std::max( QThread::idealThreadCount( ), 1);
+}
+
+// _______________________________________________________________________________________________
+
+  void
+  pool_type::
+map
+ (  job_type const &  job
+  , std::size_t       item_count
+  , std::size_t       block_count
+ )
+{
+    d_assert( block_count > 0);
+    if ( 0 == item_count ) return;
+    block_count = std::max< std::size_t >( block_count, 1);
+
+    int const          thread_count  = get_thread_count( );
+    std::size_t const  total_blocks  = ((item_count - 1) / block_count) + 1;
+
+    QMutexLocker lock( & mutex_);
+    if ( is_mapping_ || (thread_count <= 1) || (total_blocks <= 1) ) {
+        // Run it here, in the calling thread.
+        lock.unlock( );
+        job.run_block( 0, item_count);
+        return;
+    }
+    is_mapping_ = true;
+
+    // Start or stop threads if the thread count has changed.
+    if ( static_cast< int >( threads_.size( )) != (thread_count - 1) ) {
+        resize_threads( thread_count - 1);
+    }
+
+    // Give each thread a run of whole blocks. The threads past worker_count_ sit this one out.
+    worker_count_ = static_cast< int >( std::min< std::size_t >( thread_count, total_blocks));
+    for ( int index = 0 ; index < static_cast< int >( ranges_.size( )) ; ++ index ) {
+        range_type & range = *ranges_[ index ];
+        if ( index < worker_count_ ) {
+            std::size_t const  block_lo    = (total_blocks * index      ) / worker_count_;
+            std::size_t const  block_post  = (total_blocks * (index + 1)) / worker_count_;
+            range.lo   = std::min( item_count, block_lo   * block_count);
+            range.post = std::min( item_count, block_post * block_count);
+        } else {
+            range.lo = range.post = item_count;
+        }
+    }
+    p_job_       = & job;
+    block_count_ = block_count;
+    busy_count_  = worker_count_ - 1;
+    ++ job_serial_;
+    start_wait_.wakeAll( );
+    lock.unlock( );
+
+    // The calling thread does its share too.
+    work( 0);
+
+    // Wait for the pool threads. They can still be running blocks they stole from us.
+    lock.relock( );
+    while ( busy_count_ > 0 ) {
+        finish_wait_.wait( & mutex_);
+    }
+    p_job_      = 0;
+    is_mapping_ = false;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+  pool_type::
+thread_loop( int index, unsigned job_serial)
+  //
+  // This runs in pool thread (index - 1).
+{
+    QMutexLocker lock( & mutex_);
+    for ( ; ; ) {
+        while ( (job_serial == job_serial_) && (! is_stopping_) ) {
+            start_wait_.wait( & mutex_);
+        }
+        if ( is_stopping_ ) break;
+        job_serial = job_serial_;
+
+        if ( index < worker_count_ ) {
+            lock.unlock( );
+            work( index);
+            lock.relock( );
+
+            d_assert( busy_count_ > 0);
+            if ( 0 == -- busy_count_ ) {
+                finish_wait_.wakeAll( );
+            }
+        }
+    }
+}
+
+  void
+  pool_type::
+resize_threads( int thread_count)
+  //
+  // Called with mutex_ locked and is_mapping_ set, so nobody else is starting or stopping
+  // threads. We unlock the mutex while we wait for the old threads to stop.
+{
+    d_assert( is_mapping_);
+    stop_threads( );
+
+    ranges_.reserve( thread_count + 1);
+    while ( static_cast< int >( ranges_.size( )) < (thread_count + 1) ) {
+        ranges_.push_back( new range_type);
+        ranges_.back( )->lo = ranges_.back( )->post = 0;
+    }
+    while ( static_cast< int >( ranges_.size( )) > (thread_count + 1) ) {
+        delete ranges_.back( );
+        ranges_.pop_back( );
+    }
+
+    for ( int index = 0 ; index < thread_count ; ++ index ) {
+        threads_.push_back( new pool_thread_type( *this, index + 1, job_serial_));
+        threads_.back( )->start( );
+    }
+}
+
+  void
+  pool_type::
+stop_threads( )
+  //
+  // Called with mutex_ locked.
+{
+    if ( threads_.empty( ) ) return;
+
+    is_stopping_ = true;
+    start_wait_.wakeAll( );
+    mutex_.unlock( );
+    for ( std::size_t index = 0 ; index < threads_.size( ) ; ++ index ) {
+        threads_[ index ]->wait( );
+        delete threads_[ index ];
+    }
+    mutex_.lock( );
+    threads_.clear( );
+    is_stopping_ = false;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+  pool_type::
+work( int index)
+  //
+  // Runs blocks from our own range, and then from the others, until there are none left.
+{
+    std::size_t lo   = 0;
+    std::size_t post = 0;
+    for ( ; ; ) {
+        if ( take_block( index, lo, post) ) {
+            p_job_->run_block( lo, post);
+        } else
+        if ( ! steal( index) ) {
+            break;
+        }
+    }
+}
+
+  bool
+  pool_type::
+take_block( int index, std::size_t & lo, std::size_t & post)
+  //
+  // Takes the next block from the front of our own range.
+{
+    range_type & range = *ranges_[ index ];
+    QMutexLocker lock( & range.mutex);
+    if ( range.lo < range.post ) {
+        lo       = range.lo;
+        post     = std::min( range.post, lo + block_count_);
+        range.lo = post;
+        return true;
+    }
+    return false;
+}
+
+  bool
+  pool_type::
+steal( int index)
+  //
+  // Moves the back half of the biggest range left into our own (empty) range.
+  // Returns false if there was nothing left to steal.
+{
+    for ( ; ; ) {
+        // Find the biggest range. It can change before we lock it, so we check again below.
+        int          victim        = -1;
+        std::size_t  victim_count  = 0;
+        for ( int other = 0 ; other < worker_count_ ; ++ other ) {
+            if ( other == index ) continue;
+            range_type & range = *ranges_[ other ];
+            QMutexLocker lock( & range.mutex);
+            std::size_t const count = range.post - range.lo;
+            if ( count > victim_count ) {
+                victim       = other;
+                victim_count = count;
+            }
+        }
+        if ( victim < 0 ) return false;
+
+        // Take the back half, in whole blocks. If there's only one block left take it all.
+        std::size_t stolen_lo   = 0;
+        std::size_t stolen_post = 0;
+        {   range_type & range = *ranges_[ victim ];
+            QMutexLocker lock( & range.mutex);
+            std::size_t const count = range.post - range.lo;
+            if ( 0 == count ) continue; /* someone beat us to it, look again */
+            std::size_t const blocks = ((count - 1) / block_count_) + 1;
+            stolen_post = range.post;
+            stolen_lo   = (blocks <= 1) ? range.lo : (range.post - ((blocks / 2) * block_count_));
+            range.post  = stolen_lo;
+        }
+
+        range_type & own = *ranges_[ index ];
+        QMutexLocker lock( & own.mutex);
+        d_assert( own.lo == own.post);
+        own.lo   = stolen_lo;
+        own.post = stolen_post;
+        return true;
+    }
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// The current pool
+
+namespace /* anonymous */ {
+
+  struct
+current_pool_holder_type
+  //
+  // QThreadStorage<..> deletes what it holds when the thread exits, so we can't store the pool
+  // pointer there directly.
+{
+    current_pool_holder_type( ) : p_pool( 0) { }
+    pool_type *  p_pool ;
+};
+
+QThreadStorage< current_pool_holder_type * >  g_current_pool_holder ;
+
+  current_pool_holder_type &
+get_current_pool_holder( )
+{
+    if ( ! g_current_pool_holder.hasLocalData( ) ) {
+        g_current_pool_holder.setLocalData( new current_pool_holder_type);
+    }
+    return * g_current_pool_holder.localData( );
+}
+
+} /* end anonymous namespace */
+
+  pool_type *
+get_current_pool( )
+{
+    return g_current_pool_holder.hasLocalData( ) ? g_current_pool_holder.localData( )->p_pool : 0;
+}
+
+  std::size_t
+get_thread_count( )
+{
+    pool_type const * const p_pool = get_current_pool( );
+    int const thread_count = p_pool ? p_pool->get_thread_count( ) : QThread::idealThreadCount( );
+    return static_cast< std::size_t >( std::max( thread_count, 1));
+}
+
+  /* ctor */
+  scoped_current_pool_type::
+scoped_current_pool_type( pool_type * p_pool)
+  : p_saved_pool_ ( get_current_pool( ))
+{
+    get_current_pool_holder( ).p_pool = p_pool;
+}
+
+  /* dtor */
+  scoped_current_pool_type::
+~scoped_current_pool_type( )
+{
+    get_current_pool_holder( ).p_pool = p_saved_pool_;
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Rows
+
+  std::size_t
+get_row_block_count
+ (  pool_type const &  pool
+  , std::size_t        row_count
+  , std::size_t        row_byte_count
+ )
+{
+    std::size_t const  cache_rows     = row_block_byte_count / std::max< std::size_t >( 1, row_byte_count);
+    std::size_t const  balanced_rows  = row_count / (4 * static_cast< std::size_t >( pool.get_thread_count( )));
+    return std::max< std::size_t >( 1, std::min( cache_rows, balanced_rows));
+}
+
+  void
+map_rows
+ (  job_type const &   job
+  , std::size_t        row_count
+  , std::size_t        row_byte_count
+ )
+{
+    pool_type * const p_pool = get_current_pool( );
+    if ( 0 == p_pool ) {
+        if ( row_count > 0 ) {
+            job.run_block( 0, row_count);
+        }
+    } else {
+        p_pool->map( job, row_count, get_row_block_count( *p_pool, row_count, row_byte_count));
+    }
+}
+
+// _______________________________________________________________________________________________
+// Scratch slots
+
+  /* ctor */
+  slot_stack_type::
+slot_stack_type( std::size_t slot_count)
+  : mutex_      ( )
+  , give_wait_  ( )
+  , free_slots_ ( )
+  , slot_count_ ( std::max< std::size_t >( slot_count, 1))
+{
+    // Hand out the low slots first.
+    for ( std::size_t slot = slot_count_ ; slot > 0 ; -- slot ) {
+        free_slots_.push_back( slot - 1);
+    }
+}
+
+  std::size_t
+  slot_stack_type::
+take( )
+{
+    QMutexLocker lock( & mutex_);
+    while ( free_slots_.empty( ) ) {
+        give_wait_.wait( & mutex_);
+    }
+    std::size_t const slot = free_slots_.back( );
+    free_slots_.pop_back( );
+    return slot;
+}
+
+  void
+  slot_stack_type::
+give( std::size_t slot)
+{
+    QMutexLocker lock( & mutex_);
+    d_assert( slot < slot_count_);
+    d_assert( free_slots_.size( ) < slot_count_);
+    free_slots_.push_back( slot);
+    give_wait_.wakeOne( );
+}
+
+// _______________________________________________________________________________________________
+//
+} /* end namespace row_pool */
+// _______________________________________________________________________________________________
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// row_pool.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,378 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// row_pool.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef ROW_POOL_H
+# define ROW_POOL_H
+// _______________________________________________________________________________________________
+//
+//   A pool of solver threads that stay alive from one solve to the next.
+//
+//   The parallel solvers used to hand their rows to QtConcurrent::blockingMap(..), one task for
+//   each row. On a narrow sheet the scheduling costs about as much as the stencil, and the
+//   threads come from the global QThreadPool, which anything else in the program can use.
+//
+//   A map here splits the items (rows, or groups of rows) into one contiguous range for each
+//   thread, including the thread that asked for the map. Each thread works thru its own range
+//   from the front, a block at a time. A thread that runs out steals the back half of the
+//   biggest range left, so the pieces get smaller as the work runs out and the threads finish
+//   together. Rows are mapped in blocks of about row_block_byte_count bytes, so the scheduling
+//   is small next to the work even when the rows are short.
+//
+//   heat_solver::control_type owns a pool, and its worker thread makes it the current pool
+//   while it solves. Between solves the UI thread borrows it for the sheet transforms. The map
+//   functions at the bottom use the current pool, or QtConcurrent when the calling thread
+//   doesn't have one.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <cstddef>
+# include <vector>
+# include <algorithm>
+# include <iterator>
+# include <QtCore/QMutex>
+# include <QtCore/QWaitCondition>
+# include <QtCore/QThread>
+# include <QtCore/QtConcurrentMap>
+
+namespace row_pool {
+
+class pool_thread_type;
+
+// _______________________________________________________________________________________________
+
+// Rows are mapped in blocks of at least this many bytes (unless that leaves too few blocks).
+// About the size of the L1 data cache.
+std::size_t const  row_block_byte_count  = 32 * 1024;
+
+// _______________________________________________________________________________________________
+
+  class
+job_type
+  //
+  // Something to map. run_block(..) is called from many threads at once, each with its own
+  // block of items [lo, post).
+{
+  public:
+    virtual void    run_block( std::size_t lo, std::size_t post)     const = 0;
+
+  protected:
+    /* dtor */      ~job_type( )                                   { }
+};
+
+// _______________________________________________________________________________________________
+
+  class
+pool_type
+{
+  // ---------------------------------------------------------------------------------------
+  // Ctor/dtor
+  public:
+    explicit        pool_type( int thread_count /* zero means one for each core */) ;
+    /* dtor */      ~pool_type( )                                  ;
+
+  // Disable copy
+  private:
+    /* copy */      pool_type(  pool_type const &)                 ; // no implementation
+    void            operator =( pool_type const &)                 ; // no implementation
+
+  // ---------------------------------------------------------------------------------------
+  // Thread count
+  public:
+    // You can set this from any thread. It takes effect with the next map.
+    void            set_thread_count( int /* zero means one for each core */) ;
+    int             get_thread_count( )                      const ; /* the threads a map will use */
+    int             get_requested_thread_count( )            const ; /* zero means one for each core */
+
+  // ---------------------------------------------------------------------------------------
+  // Map
+  public:
+    // Runs job over items [0, item_count) in blocks of block_count (the last block can be
+    // shorter), using the pool threads and the calling thread. Returns when all the blocks
+    // are done. If the pool is already mapping (from another thread, or from inside a job)
+    // the job runs serially in the calling thread.
+    void            map
+                     (  job_type const &  job
+                      , std::size_t       item_count
+                      , std::size_t       block_count
+                     )                                             ;
+
+  // ---------------------------------------------------------------------------------------
+  // Private
+  private:
+    friend class pool_thread_type;
+
+      struct
+    range_type
+      // The items a thread has left to do, [lo, post).
+    {   QMutex       mutex ;
+        std::size_t  lo    ;
+        std::size_t  post  ;
+    };
+
+    void            thread_loop( int index, unsigned job_serial)   ;
+    void            resize_threads( int thread_count)              ;
+    void            stop_threads( )                                ;
+    void            work( int index)                               ;
+    bool            take_block( int index, std::size_t & lo, std::size_t & post) ;
+    bool            steal( int index)                              ;
+
+  // ---------------------------------------------------------------------------------------
+  // Member vars
+  private:
+    // Guards everything below except the insides of the ranges, which have their own mutexes.
+    mutable QMutex                      mutex_                  ;
+    QWaitCondition                      start_wait_             ; /* the pool threads wait here for a job */
+    QWaitCondition                      finish_wait_            ; /* the mapping thread waits here for the pool threads */
+
+    int                                 requested_thread_count_ ;
+    std::vector< pool_thread_type * >   threads_                ;
+    std::vector< range_type * >         ranges_                 ; /* the mapping thread's, then one for each pool thread */
+
+    job_type const *                    p_job_                  ;
+    std::size_t                         block_count_            ;
+    int                                 worker_count_           ; /* the threads working on this job */
+    int                                 busy_count_             ; /* the pool threads still working on it */
+    unsigned                            job_serial_             ;
+    bool                                is_mapping_             ;
+    bool                                is_stopping_            ;
+
+}; /* end class pool_type */
+
+// _______________________________________________________________________________________________
+// The current pool
+//
+//   Each thread can have a current pool. The solvers use it without having to pass it down
+//   thru every call.
+
+pool_type *         get_current_pool( )                            ; /* zero if none */
+
+// How many threads the current pool maps with. QThread::idealThreadCount( ) if there's no
+// current pool. Always at least 1.
+std::size_t         get_thread_count( )                            ;
+
+  class
+scoped_current_pool_type
+  //
+  // Makes a pool the calling thread's current pool while this is in scope.
+{
+  public:
+    explicit        scoped_current_pool_type( pool_type * p_pool)  ;
+    /* dtor */      ~scoped_current_pool_type( )                   ;
+
+  private:
+    /* copy */      scoped_current_pool_type(  scoped_current_pool_type const &) ; // no implementation
+    void            operator =( scoped_current_pool_type const &)  ; // no implementation
+
+    pool_type * const  p_saved_pool_ ;
+};
+
+// _______________________________________________________________________________________________
+// Rows
+//
+//   Rows are mapped in cache-sized blocks. But we leave each thread at least 4 blocks so there
+//   is something to steal.
+
+std::size_t         get_row_block_count
+                     (  pool_type const &  pool
+                      , std::size_t        row_count
+                      , std::size_t        row_byte_count
+                     )                                             ;
+
+// Maps job over rows [0, row_count) on the current pool. Runs the job in the calling thread
+// if there's no current pool.
+void                map_rows
+                     (  job_type const &   job
+                      , std::size_t        row_count
+                      , std::size_t        row_byte_count
+                     )                                             ;
+
+// _______________________________________________________________________________________________
+// Row ranges
+//
+//   Most of the solvers work on a run of rows at a time, with a functor that takes the rows as
+//   a std::pair< std::size_t, std::size_t >( lo, post). Each block that map_rows(..) makes is
+//   handed to the functor as one run.
+
+  template< typename FUNCTOR_TYPE >
+  class
+range_job_type
+  : public job_type
+{
+  public:
+    explicit
+    range_job_type( FUNCTOR_TYPE const & functor)
+      : functor_ ( functor)
+      { }
+    virtual
+      void
+    run_block( std::size_t lo, std::size_t post) const
+      { functor_( std::make_pair( lo, post)); }
+  private:
+    FUNCTOR_TYPE const &  functor_ ;
+};
+
+  template< typename FUNCTOR_TYPE >
+  void
+map_row_ranges
+ (  FUNCTOR_TYPE const &  functor
+  , std::size_t           row_count
+  , std::size_t           row_byte_count
+  , bool                  is_parallel
+ )
+  // Maps functor over rows [0, row_count) with map_rows(..). Unless is_parallel, the functor
+  // gets all the rows at once in the calling thread.
+{
+    range_job_type< FUNCTOR_TYPE > const job( functor);
+    if ( is_parallel ) {
+        map_rows( job, row_count, row_byte_count);
+    } else
+    if ( row_count > 0 ) {
+        job.run_block( 0, row_count);
+    }
+}
+
+// _______________________________________________________________________________________________
+// Scratch slots
+//
+//   The blocks of a map can run on any thread, so a job that needs scratch space can't tie it
+//   to a block or a thread. Instead it sets aside one slot of scratch space for each thread,
+//   and each block borrows a slot while it runs.
+
+  class
+slot_stack_type
+{
+  public:
+    explicit        slot_stack_type( std::size_t slot_count)       ;
+    std::size_t     get_slot_count( )                        const { return slot_count_; }
+
+    // If all the slots are out (the pool grew after they were counted), take( ) waits for
+    // another block to give one back.
+    std::size_t     take( )                                        ;
+    void            give( std::size_t slot)                        ;
+
+  private:
+    /* copy */      slot_stack_type(  slot_stack_type const &)     ; // no implementation
+    void            operator =( slot_stack_type const &)           ; // no implementation
+
+    QMutex                      mutex_      ;
+    QWaitCondition              give_wait_  ;
+    std::vector< std::size_t >  free_slots_ ;
+    std::size_t const           slot_count_ ;
+};
+
+  class
+scoped_slot_type
+  //
+  // Borrows a slot while this is in scope.
+{
+  public:
+    explicit
+    scoped_slot_type( slot_stack_type & scratch_slots)
+      : scratch_slots_ ( scratch_slots)
+      , slot_          ( scratch_slots.take( ))
+      { }
+    /* dtor */      ~scoped_slot_type( )                           { scratch_slots_.give( slot_); }
+    std::size_t     get( )                                   const { return slot_; }
+  private:
+    /* copy */      scoped_slot_type(  scoped_slot_type const &)   ; // no implementation
+    void            operator =( scoped_slot_type const &)          ; // no implementation
+    slot_stack_type &   scratch_slots_ ;
+    std::size_t const   slot_          ;
+};
+
+// _______________________________________________________________________________________________
+// Map functions
+//
+//   These are drop-in replacements for QtConcurrent::blockingMap(..) over random-access
+//   iterators. Like QtConcurrent, all the threads share one functor.
+
+  template< typename ITER_TYPE, typename FUNCTOR_TYPE >
+  class
+iter_job_type
+  : public job_type
+{
+  public:
+    iter_job_type( ITER_TYPE const & iter_lo, FUNCTOR_TYPE & functor)
+      : iter_lo_ ( iter_lo)
+      , functor_ ( functor)
+      { }
+
+    virtual
+      void
+    run_block( std::size_t lo, std::size_t post) const
+      { ITER_TYPE iter = iter_lo_;
+        std::advance( iter, lo);
+        for ( ; lo < post ; ++ lo, ++ iter ) {
+            functor_( *iter);
+        }
+      }
+
+  private:
+    ITER_TYPE       const  iter_lo_  ;
+    FUNCTOR_TYPE &         functor_  ;
+};
+
+  template< typename ITER_TYPE, typename FUNCTOR_TYPE >
+  void
+blocking_map
+ (  ITER_TYPE     iter_lo
+  , ITER_TYPE     iter_post
+  , FUNCTOR_TYPE  functor
+ )
+  // Maps one item at a time. Use this when each item is already a big piece of work, like the
+  // partitions of a long row in the partitioned solve.
+{
+    pool_type * const p_pool = get_current_pool( );
+    if ( 0 == p_pool ) {
+        QtConcurrent::blockingMap( iter_lo, iter_post, functor);
+    } else
+    if ( iter_lo < iter_post ) {
+        iter_job_type< ITER_TYPE, FUNCTOR_TYPE > const job( iter_lo, functor);
+        p_pool->map( job, static_cast< std::size_t >( std::distance( iter_lo, iter_post)), 1);
+    }
+}
+
+  template< typename ITER_TYPE, typename FUNCTOR_TYPE >
+  void
+blocking_map_rows
+ (  ITER_TYPE     iter_lo
+  , ITER_TYPE     iter_post
+  , FUNCTOR_TYPE  functor
+  , std::size_t   row_byte_count
+ )
+  // Maps rows in cache-sized blocks.
+{
+    pool_type * const p_pool = get_current_pool( );
+    if ( 0 == p_pool ) {
+        QtConcurrent::blockingMap( iter_lo, iter_post, functor);
+    } else
+    if ( iter_lo < iter_post ) {
+        std::size_t const row_count = static_cast< std::size_t >( std::distance( iter_lo, iter_post));
+        iter_job_type< ITER_TYPE, FUNCTOR_TYPE > const job( iter_lo, functor);
+        p_pool->map( job, row_count, get_row_block_count( *p_pool, row_count, row_byte_count));
+    }
+}
+
+} /* end namespace row_pool */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef ROW_POOL_H
+//
+// row_pool.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
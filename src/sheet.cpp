@@ -870,24 +870,13 @@ normalize
     value_type min_value;
     value_type max_value;
     if ( get_min_max_values( x_lo, x_hi_plus, y_lo, y_hi_plus, min_value, max_value) ) {
-        if ( min_value < max_value ) {
-            normalize_functor_type functor( min_value, max_value, trg_lo, trg_hi);
-            d_verify(
-                transform_rectangle(
-                    functor,
-                    x_lo, x_hi_plus,
-                    y_lo, y_hi_plus));
-            if ( p_trg_src_ratio ) {
-                *p_trg_src_ratio = functor.get_trg_src_ratio( );
-            }
-        } else {
-            // If min==max, we cannot spread the values out between trg_lo and trg_hi.
-            // So instead just set them all to the mid point.
-            d_assert( min_value == max_value);
-            d_verify(
-                fill_rectangle_coords( (trg_lo + trg_hi) / 2, x_lo, x_hi_plus, y_lo, y_hi_plus));
-        }
         // If get_min_max_value(..) didn't fail, then we know the rectangle coords are OK.
+        d_verify(
+            normalize_rectangle_with_min_max(
+                min_value, max_value,
+                x_lo, x_hi_plus,
+                y_lo, y_hi_plus,
+                trg_lo, trg_hi, p_trg_src_ratio));
         return true;
     }
 
@@ -895,6 +884,41 @@ normalize
     return false;
 }
 
+  bool
+  sheet_type::
+normalize_rectangle_with_min_max
+ (  value_type    min_value
+  , value_type    max_value
+  , size_type     x_lo
+  , size_type     x_hi_plus
+  , size_type     y_lo
+  , size_type     y_hi_plus
+  , value_type    trg_lo
+  , value_type    trg_hi
+  , value_type *  p_trg_src_ratio
+ )
+  // min_value and max_value must be the min/max in the rectangle.
+{
+    if ( p_trg_src_ratio ) {
+        *p_trg_src_ratio = 0;
+    }
+    if ( min_value < max_value ) {
+        normalize_functor_type functor( min_value, max_value, trg_lo, trg_hi);
+        if ( ! transform_rectangle( functor, x_lo, x_hi_plus, y_lo, y_hi_plus) ) {
+            return false;
+        }
+        if ( p_trg_src_ratio ) {
+            *p_trg_src_ratio = functor.get_trg_src_ratio( );
+        }
+        return true;
+    }
+
+    // If min==max, we cannot spread the values out between trg_lo and trg_hi.
+    // So instead just set them all to the mid point.
+    d_assert( min_value == max_value);
+    return fill_rectangle_coords( (trg_lo + trg_hi) / 2, x_lo, x_hi_plus, y_lo, y_hi_plus);
+}
+
   bool
   sheet_type::
 normalize
@@ -910,6 +934,32 @@ normalize
             trg_lo, trg_hi, p_trg_src_ratio);
 }
 
+  bool
+  sheet_type::
+normalize_with_min_max
+ (  value_type    min_value
+  , value_type    max_value
+  , value_type    trg_lo           /* = -1 */
+  , value_type    trg_hi           /* = +1 */
+  , value_type *  p_trg_src_ratio  /* =  0 */
+ )
+  // Same as normalize(..) except min_value and max_value are already known.
+{
+    d_assert( min_value <= max_value);
+    if ( p_trg_src_ratio ) {
+        *p_trg_src_ratio = 0;
+    }
+    if ( trg_lo == trg_hi ) {
+        return fill_rectangle_coords( trg_lo, 0, get_x_count( ), 0, get_y_count( ));
+    }
+    return
+        normalize_rectangle_with_min_max(
+            min_value, max_value,
+            0, get_x_count( ),
+            0, get_y_count( ),
+            trg_lo, trg_hi, p_trg_src_ratio);
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 // Copy (with line_walker_type so you can copy between sheets with different sizes)
@@ -56,6 +56,7 @@
 # include "debug.h"
 # include "util.h"
 # include "stride_iter.h"
+# include "row_pool.h"
 
 // _______________________________________________________________________________________________
 
@@ -288,6 +289,28 @@ sheet_type
                           , value_type *  p_trg_src_ratio  =  0
                          )                                  ;
 
+    // Like normalize(..) above when we already know the min/max values in the sheet (from the
+    // solver's stats), so we do not have to scan the sheet to find them.
+    bool                normalize_with_min_max
+                         (  value_type    min_value
+                          , value_type    max_value
+                          , value_type    trg_lo           = -1
+                          , value_type    trg_hi           = +1
+                          , value_type *  p_trg_src_ratio  =  0
+                         )                                  ;
+  protected:
+    bool                normalize_rectangle_with_min_max
+                         (  value_type    min_value
+                          , value_type    max_value
+                          , size_type     x_lo
+                          , size_type     x_hi_plus
+                          , size_type     y_lo
+                          , size_type     y_hi_plus
+                          , value_type    trg_lo
+                          , value_type    trg_hi
+                          , value_type *  p_trg_src_ratio
+                         )                                  ;
+
   // -------------------------------------------------------------------------------------------
   public:
                           template< typename COMBINE_FUNCTOR_TYPE >
@@ -717,6 +740,59 @@ scan_leaves_with_2d_index_functor_type
     { assign_functor_( v, calc_functor_( v, x, y)); }
 };
 
+// _______________________________________________________________________________________________
+
+  /* private job class, used in template method below */
+  template< typename ROW_FUNCTOR_TYPE >
+  class
+transform_rows_job_type
+  : public row_pool::job_type
+  //
+  // Transforms a block of rows. Each block works with its own copy of the functor, so the new
+  // values must only depend on the old value and (x, y), and not on the order of the calls.
+{
+  public:
+    typedef sheet_type::size_type            size_type          ;
+    typedef sheet_type::yx_varia_iter_type   yx_varia_iter_type ;
+    typedef sheet_type::x_varia_range_type   x_varia_range_type ;
+    typedef sheet_type::x_varia_iter_type    x_varia_iter_type  ;
+
+    transform_rows_job_type
+     (  ROW_FUNCTOR_TYPE    const &  functor
+      , yx_varia_iter_type  const &  yx_iter_lo
+      , size_type                    x_lo
+      , size_type                    y_lo
+     )
+      : functor_    ( functor)
+      , yx_iter_lo_ ( yx_iter_lo)
+      , x_lo_       ( x_lo)
+      , y_lo_       ( y_lo)
+      { }
+
+    virtual
+      void
+    run_block( std::size_t lo, std::size_t post) const
+      { ROW_FUNCTOR_TYPE  functor  = functor_;
+        yx_varia_iter_type yx_iter  = yx_iter_lo_ + lo;
+        for ( ; lo < post ; ++ lo, ++ yx_iter ) {
+            // Each row is a simple counted loop, which the compiler can unroll and vectorize.
+            x_varia_range_type const  x_range  = *yx_iter;
+            x_varia_iter_type         x_iter   = x_range.get_iter_lo( );
+            size_type const           x_post   = x_lo_ + x_range.get_count( );
+            size_type const           y        = y_lo_ + lo;
+            for ( size_type x = x_lo_ ; x < x_post ; ++ x, ++ x_iter ) {
+                functor( *x_iter, x, y);
+            }
+        }
+      }
+
+  private:
+    ROW_FUNCTOR_TYPE    const  functor_     ;
+    yx_varia_iter_type  const  yx_iter_lo_  ;
+    size_type           const  x_lo_        ;
+    size_type           const  y_lo_        ;
+};
+
 // _______________________________________________________________________________________________
 
   template
@@ -733,9 +809,11 @@ transform_rectangle
   , size_type                    y_lo
   , size_type                    y_hi_plus
  )
-  // Improve: Provide a parallel version of this function.
-  //
   // Instead of just scanning the values in the sheet, this sets them.
+  //
+  // The rows are split into blocks and mapped on the calling thread's current row pool
+  // (row_pool.h), so the functor has to be safe to copy and call from several threads at once.
+  // Without a current pool this runs in the calling thread.
   // The functor looks like this:
   //   op( old_value, x, y) -> new_value
   // The sheet is set to the new value at (x, y).
@@ -750,9 +828,15 @@ transform_rectangle
 {
     yx_varia_range_type const yx_range = get_range_yx( x_lo, x_hi_plus, y_lo, y_hi_plus);
     if ( yx_range.get_count( ) && yx_range.get_next_range( ).get_count( ) ) {
-        scan_leaves_with_2d_index_functor_type< CALC_NEW_VALUE_FUNCTOR_TYPE, ASSIGN_FUNCTOR_TYPE >
-            wrapper_functor( calc_new_value_functor, assign_functor);
-        scan_leaves_with_2d_index( yx_range, wrapper_functor, x_lo, y_lo);
+        typedef scan_leaves_with_2d_index_functor_type< CALC_NEW_VALUE_FUNCTOR_TYPE, ASSIGN_FUNCTOR_TYPE >
+            wrapper_functor_type;
+        transform_rows_job_type< wrapper_functor_type > const
+            job( wrapper_functor_type( calc_new_value_functor, assign_functor), yx_range.get_iter_lo( ), x_lo, y_lo);
+        row_pool::map_rows
+         (  job
+          , yx_range.get_count( )
+          , yx_range.get_next_range( ).get_count( ) * sizeof( value_type)
+         );
         return true;
     }
     return false;
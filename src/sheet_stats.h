@@ -0,0 +1,124 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// sheet_stats.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef SHEET_STATS_H
+# define SHEET_STATS_H
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// Summary of the values in a sheet: min, max, sum and sum of squares.
+//
+//   The solvers gather these a row at a time as they write each generation, so the rest of the
+//   app can read them without scanning the sheet again. They are only gathered in a pass the
+//   solve makes anyway, never in a pass of their own, so they are often empty (unknown).
+//   Each row (or group of rows) gets its own sheet_stats_type, and the rows are combined with
+//   add(..) when the solve is finished.
+//
+//   The sum of squares is the sheet's "energy". Sums are kept as doubles even for float
+//   sheets so the combine doesn't drift.
+//
+//   NaN values are not counted in min/max (the compares are false) but do poison the sums.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <cstddef>
+# include "debug.h"
+
+// _______________________________________________________________________________________________
+
+  class
+sheet_stats_type
+{
+  public:
+    /* ctor */          sheet_stats_type( )                 : min_value_( 0), max_value_( 0)
+                                                            , sum_( 0), sum_of_squares_( 0)
+                                                            , count_( 0)
+                                                            { }
+
+  public:
+    void                clear( )                            { min_value_      = 0;
+                                                              max_value_      = 0;
+                                                              sum_            = 0;
+                                                              sum_of_squares_ = 0;
+                                                              count_          = 0;
+                                                            }
+
+    // Empty means "unknown". Solvers that do not gather stats leave them empty.
+    bool                is_empty( )                   const { return 0 == count_; }
+
+    size_t              get_count( )                  const { return count_; }
+    double              get_min_value( )              const { d_assert( ! is_empty( )); return min_value_; }
+    double              get_max_value( )              const { d_assert( ! is_empty( )); return max_value_; }
+    double              get_sum( )                    const { return sum_; }
+    double              get_sum_of_squares( )         const { return sum_of_squares_; }
+    double              get_mean( )                   const { return is_empty( ) ? 0 : (sum_ / count_); }
+
+  public:
+    // Add the values in [iter, post). ITER is usually a row iterator on a sheet.
+    template< typename ITER >
+    void                add_values( ITER iter, ITER const & post)
+                                                            { if ( ! (iter != post) ) return;
+                                                              double lo    = is_empty( ) ? static_cast< double >( *iter) : min_value_;
+                                                              double hi    = is_empty( ) ? static_cast< double >( *iter) : max_value_;
+                                                              double sum   = 0;
+                                                              double sum_2 = 0;
+                                                              size_t count = 0;
+                                                              for ( ; iter != post ; ++ iter ) {
+                                                                double const value = static_cast< double >( *iter);
+                                                                if ( value < lo ) lo = value;
+                                                                if ( value > hi ) hi = value;
+                                                                sum   += value;
+                                                                sum_2 += value * value;
+                                                                count += 1;
+                                                              }
+                                                              min_value_       = lo;
+                                                              max_value_       = hi;
+                                                              sum_            += sum;
+                                                              sum_of_squares_ += sum_2;
+                                                              count_          += count;
+                                                            }
+
+    // Combine the stats from another part of the sheet.
+    void                add( sheet_stats_type const & that)
+                                                            { if ( that.is_empty( ) ) return;
+                                                              if ( is_empty( ) ) {
+                                                                *this = that;
+                                                                return;
+                                                              }
+                                                              if ( that.min_value_ < min_value_ ) min_value_ = that.min_value_;
+                                                              if ( that.max_value_ > max_value_ ) max_value_ = that.max_value_;
+                                                              sum_            += that.sum_;
+                                                              sum_of_squares_ += that.sum_of_squares_;
+                                                              count_          += that.count_;
+                                                            }
+
+  private:
+    double  min_value_       ;
+    double  max_value_       ;
+    double  sum_             ;
+    double  sum_of_squares_  ;
+    size_t  count_           ;
+};
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef SHEET_STATS_H
+//
+// sheet_stats.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -96,7 +96,6 @@
 
 # include "all.h"
 # include "solve_control.h"
-# include "angle_holder.h"
 
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
@@ -115,11 +114,17 @@ sheet_control_type( QObject * p_parent)
 
   , is_history_delta_in_extra_sheet_            ( false)
   , is_next_sheet_valid_history_                ( false)
+  , sheet_velocity_                             ( )
+  , is_velocity_valid_                          ( false)
+  , is_current_sheet_last_solved_               ( false)
 
   , is_next_solve_pending_                      ( false)
-  , are_edges_fixed_                            ( false)
+  , is_transform_pending_                       ( false)
+  , transform_history_scale_                    ( 0)
   , is_center_frozen_                           ( false)
   , is_vortex_on_                               ( false)
+  , is_insulating_wall_on_                      ( false)
+  , conductivity_sheet_                         ( )
 
   , is_auto_solving_                            ( false)
   , is_auto_solve_just_started_                 ( false)
@@ -127,6 +132,7 @@ sheet_control_type( QObject * p_parent)
   , p_heat_solver_                              ( 0)
 
   , generation_current_                         ( -1)
+  , skipped_generation_count_                   ( 0)
 
   , last_solve_tick_duration_                   ( date_time::get_invalid_tick_dur( ))
   , next_solve_start_tick_                      ( date_time::get_invalid_tick_pt( ))
@@ -147,42 +153,19 @@ sheet_control_type( QObject * p_parent)
   , p_wakeup_for_next_solve_                    ( 0)
 
   , is_draw_size_limited_                       ( true)
-  , is_limited_draw_sheet_written_              ( false)
   , xy_draw_size_limit_                         ( 10000)
   , x_draw_size_limit_                          ( 0)
   , y_draw_size_limit_                          ( 0)
   , ratio_xy_sheet_to_xy_limit_                 ( 1.0f)
-  , sheet_limited_draw_                         ( )
-
-  , is_requested_scale_sheet_                   ( false)
-  , requested_values_scale_                     ( 1.0f)
-  , requested_momentum_scale_                   ( 1.0f)
-  , is_requested_ramp_corner_to_corner_         ( false)
-  , is_requested_ramp_2_corners_                ( false)
-  , is_requested_ramp_4_corners_                ( false)
-  , is_requested_bell_corner_1_                 ( false)
-  , is_requested_bell_corner_2_                 ( false)
-  , is_requested_bell_corner_3_                 ( false)
-  , is_requested_bell_corner_4_                 ( false)
-  , is_requested_raindrop_up_                   ( false)
-  , is_requested_raindrop_down_                 ( false)
-  , is_requested_bell_curve_1_                  ( false)
-  , is_requested_bell_curve_2_                  ( false)
-  , is_requested_bell_curve_4_                  ( false)
-  , is_requested_sin_over_dist_1_               ( false)
-  , is_requested_sin_over_dist_2_               ( false)
-  , is_requested_sin_over_dist_4_               ( false)
-  , is_requested_delta_                         ( false)
-  , is_requested_stair_steps_                   ( false)
-  , is_requested_reverse_wave_                  ( false)
-  , is_requested_set_init_test_                 ( false)
-  , is_requested_set_sheet_random_noise_        ( false)
-  , is_requested_normalize_sheet_               ( false)
-  , is_requested_set_xy_sizes_                  ( false)
-  , is_requested_set_xy_sizes_with_value_       ( false)
-  , requested_set_xy_sizes_x_                   ( 0)
-  , requested_set_xy_sizes_y_                   ( 0)
-  , requested_set_xy_sizes_value_               ( 0)
+
+  , draw_buffer_                                ( )
+  , is_published_sheet_stale_                   ( true)
+  , is_solve_publishing_                        ( false)
+
+  , current_sheet_stats_                        ( )
+
+  , posted_requests_                            ( )
+  , deferred_requests_                          ( )
 {
     // Do this first. Some things (initializing the sheets) assume the solver exists.
     init_solver( );
@@ -260,6 +243,8 @@ init_solver( )
     d_assert( ! p_heat_solver_);
     p_heat_solver_ = new heat_solver_type( this);
     d_verify( connect( p_heat_solver_, SIGNAL( finished( )), this, SLOT( finished__from_solver( ))));
+    d_verify( connect( p_heat_solver_, SIGNAL( published( )), this, SIGNAL( published_sheet_is_changed( ))));
+    d_verify( connect( p_heat_solver_, SIGNAL( transform_finished( )), this, SLOT( finished_transform__from_solver( ))));
 }
 
 // _______________________________________________________________________________________________
@@ -276,7 +261,7 @@ start_auto_solving( )
         is_auto_solving_            = true;
         is_auto_solve_just_started_ = true;
 
-        if ( ! is_next_solve_pending( ) ) {
+        if ( ! is_next_solve_pending( ) && ! is_transform_pending( ) ) {
             solve_next( );
         }
 
@@ -304,6 +289,12 @@ stop_auto_solving( )
         // always be true when we get here.
         if ( is_next_solve_pending( ) ) {
             is_auto_solve_just_stopped_ = true;
+
+            // Don't wait for the rest of a free run.
+            get_heat_solver( )->request_free_run_stop( );
+        } else {
+            // The last solve may have left the drawing code a generation behind.
+            is_published_sheet_stale_ = true;
         }
 
         //emit auto_solving_stopped( );
@@ -339,7 +330,7 @@ single_step_solve( )
         d_assert( date_time::is_invalid_tick_pt( last_auto_solve_start_tick_ ));
         d_assert( date_time::is_invalid_tick_pt( last_auto_solve_finish_tick_));
 
-        if ( ! is_next_solve_pending( ) ) {
+        if ( ! is_next_solve_pending( ) && ! is_transform_pending( ) ) {
             solve_next( );
         }
     }
@@ -355,6 +346,7 @@ solve_next( )
     d_assert( p_sheet_current_ && p_sheet_next_ && p_sheet_extra_);
     d_assert( ! get_heat_solver( )->is_busy( ));
     d_assert( ! is_next_solve_pending( ));
+    d_assert( ! is_transform_pending( ));
     d_assert( ! is_auto_solve_just_stopped_);
 
     // Start the timers.
@@ -367,18 +359,51 @@ solve_next( )
         // or we can copy the src to the trg to create a history.
         // If (get_extra_pass_count( ) > 0) (and ! are_extra_passes_disabled) we should copy
         // to create the history.
-        copy_current_to_next_sheet( );
+        // If we were just solving the leapfrog wave the history is in the velocity.
+        if ( is_velocity_valid_ ) {
+            (*p_sheet_next_)  = (*p_sheet_current_);
+            (*p_sheet_next_) -= sheet_velocity_;
+        } else {
+            copy_current_to_next_sheet( );
+        }
         is_next_sheet_valid_history_ = true;
     }
 
+    // The drawing code should see the current sheet while we solve the next one.
+    maybe_publish_current_sheet( );
+
+    // The worker thread publishes the solved sheet itself, unless we change it after the solve.
+    // This is the same test as after_solve( ) uses.
+    is_solve_publishing_ =
+        ! ((is_next_sheet_valid_history_ && are_edges_fixed_after_solve( )) ||
+           is_center_frozen( ) ||
+           is_vortex_on( ));
+
     // Kick the solver thread.
-    // We disable extra passes when edges are fixed because otherwise wave-solve explodes and
-    // heat-solve looks pretty ugly.
+    // We disable extra passes when we have to fix the edges after the solve, because otherwise
+    // wave-solve explodes and heat-solve looks pretty ugly. Solves that fix the edges themselves
+    // keep them fixed every pass.
     // We disable extra passes when the center is frozen because it looks very bad. It also
     // generates some spurious waves but they don't have the energy to explode (except maybe
     // on very small sheets).
-    bool const are_extra_passes_disabled = are_edges_fixed( ) || is_center_frozen( );
-    get_heat_solver( )->calc_next( *p_sheet_current_, *p_sheet_next_, *p_sheet_extra_, are_extra_passes_disabled);
+    bool const are_extra_passes_disabled = are_edges_fixed_after_solve( ) || is_center_frozen( );
+
+    // When auto-solving, the worker can keep going for a while on its own and publish as it
+    // goes. Not if we have to change the sheet after every solve, or if a posted request is
+    // still waiting to be honored.
+    bool const is_free_run_allowed =
+        is_auto_solving( ) && is_solve_publishing_ && ! are_extra_passes_disabled &&
+        posted_requests_.empty( );
+
+    get_heat_solver( )->calc_next
+     (  *p_sheet_current_, *p_sheet_next_, *p_sheet_extra_
+      , maybe_get_conductivity_sheet( )
+      , maybe_get_velocity_sheet( )
+      , is_solve_publishing_ ? (& draw_buffer_) : 0
+      , are_extra_passes_disabled
+      , is_current_sheet_last_solved_
+      , is_free_run_allowed
+     );
 
     // We are now waiting for a finished__from_solver( ) signal.
     is_next_solve_pending_ = true;
@@ -399,7 +424,13 @@ finished__from_solver( )
 
     // Do not update the sheet if is_early_exit.
     if ( get_heat_solver( )->get_output_params( )->is_early_exit( ) ) {
-        is_next_sheet_valid_history_ = false;
+        // The leapfrog solve moves the velocity along as it goes, so it's only partly moved.
+        is_next_sheet_valid_history_  = false;
+        is_velocity_valid_            = false;
+        is_current_sheet_last_solved_ = false;
+        is_solve_publishing_          = false;
+        // A free run may have published sheets that we are not keeping.
+        is_published_sheet_stale_     = true;
         return;
     }
 
@@ -417,7 +448,8 @@ finished__from_solver( )
     is_auto_solve_just_stopped_ = false;
 
     // Start calculating the next generation immediately when we are auto-solving.
-    if ( is_auto_solving( ) ) {
+    // Unless a request started a transform. Then we start when it is done.
+    if ( is_auto_solving( ) && ! is_transform_pending( ) ) {
 
         // Improve: Slow down auto-solve.
         //
@@ -431,7 +463,7 @@ finished__from_solver( )
         //   Early exit when the app is shutting down.
         //   Very slow solve that the user wants to stop (1000 extra passes, hangs the machine).
         //   User wants to transform the sheet (flatten, normalized, etc).
-        //     Remember, all these transforms need to move into the worker thread.
+        //     Most of these transforms now run in the worker thread, but only between solves.
         //
         // We'll use the following:
         //   min_ticks_auto_solve_finish_to_start_
@@ -446,6 +478,37 @@ finished__from_solver( )
     }
 }
 
+// _______________________________________________________________________________________________
+
+  /* private slot */
+  void
+  sheet_control_type::
+finished_transform__from_solver( )
+  //
+  // The solver's worker thread is done with the job from transform_next_sheet(..).
+  // This signal is queued, like the finished( ) signal.
+{
+    d_assert( is_transform_pending( ));
+    is_transform_pending_ = false;
+
+    // The normalize transform tells us how much it scaled the values.
+    value_type const history_scale = transform_history_scale_;
+    transform_history_scale_ = 0;
+    if ( 0 != history_scale ) {
+        maybe_scale_saved_history( history_scale);
+    }
+
+    // This will emit the sheet_is_changed( ) signal.
+    after_transform( );
+
+    // Honor the requests posted after this one. This may start another transform.
+    honor_requests( );
+
+    if ( is_auto_solving( ) && ! are_requests_delayed( ) ) {
+        solve_next( );
+    }
+}
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 
@@ -673,134 +736,347 @@ are_requests_delayed( ) const
 {
     d_assert( p_sheet_next_);
     d_assert( p_sheet_current_);
-    return is_next_solve_pending( );
+    return is_next_solve_pending( ) || is_transform_pending( );
+}
+
+  void
+  sheet_control_type::
+post_or_honor_request( e_request_kind_type kind)
+{
+    request_type request = request_type( );
+    request.kind = kind;
+    post_or_honor_request( request);
+}
+
+  void
+  sheet_control_type::
+post_or_honor_request( request_type const & request)
+  //
+  // Honors the request now unless a solve is pending. Otherwise queues it until the solve is
+  // complete, and cuts a free-running solve short so the request waits for at most one more
+  // generation instead of the whole slice.
+{
+    if ( are_requests_delayed( ) ) {
+        posted_requests_.push_back( request);
+        get_heat_solver( )->request_free_run_stop( );
+    } else {
+        honor_request( request);
+    }
 }
 
   void
   sheet_control_type::
 honor_requests( )
+  //
+  // Honors the deferred requests and then the posted ones, oldest first. A request that cannot
+  // be honored yet is deferred and tried again after the next solve.
+  // A request that starts a transform in the worker thread holds up the rest. They are posted
+  // again, and honored when the transform is done.
 {
     d_assert( ! are_requests_delayed( ));
 
-    if ( is_requested_scale_sheet_ ) {
-        scale_sheet( requested_values_scale_, requested_momentum_scale_);
-        is_requested_scale_sheet_ = false;
-        requested_values_scale_   = 1.0f;
-        requested_momentum_scale_ = 1.0f;
-    }
+    request_list_type requests;
+    requests.swap( deferred_requests_);
+    requests.insert( requests.end( ), posted_requests_.begin( ), posted_requests_.end( ));
+    posted_requests_.clear( );
 
-    if ( is_requested_set_xy_sizes_ ) {
-        if ( is_requested_set_xy_sizes_with_value_ ) {
-            set_xy_sizes( requested_set_xy_sizes_x_, requested_set_xy_sizes_y_, requested_set_xy_sizes_value_);
-        } else {
-            set_xy_sizes( requested_set_xy_sizes_x_, requested_set_xy_sizes_y_);
+    request_list_type::const_iterator const  iter_post  = requests.end( );
+    for ( request_list_type::const_iterator iter = requests.begin( ) ; iter != iter_post ; ++ iter ) {
+        if ( are_requests_delayed( ) ) {
+            posted_requests_.assign( iter, iter_post);
+            break;
+        }
+        if ( ! honor_request( *iter) ) {
+            defer_request( *iter);
         }
-        is_requested_set_xy_sizes_            = false;
-        is_requested_set_xy_sizes_with_value_ = false;
-        requested_set_xy_sizes_x_             = 0;
-        requested_set_xy_sizes_y_             = 0;
-        requested_set_xy_sizes_value_         = 0;
     }
+}
 
-    if ( is_requested_bell_curve_1_ ) {
-        set_bell_curve_1( );
-        is_requested_bell_curve_1_ = false;
+  void
+  sheet_control_type::
+defer_request( request_type const & request)
+  //
+  // A request is only merged with one that's already deferred if doing it twice is the same as
+  // doing it once. Reversing the wave twice is the same as not reversing it at all, so a second
+  // reverse cancels the first. That also keeps the reverse-wave requests made while solving heat
+  // from piling up for the rest of the session.
+{
+    for ( request_list_type::iterator iter = deferred_requests_.begin( )
+        ; iter != deferred_requests_.end( )
+        ; ++ iter )
+    {
+        if ( iter->kind != request.kind ) continue;
+        if ( e_request_reverse_wave == request.kind ) {
+            deferred_requests_.erase( iter);
+            return;
+        }
+        if ( is_repeat_of_idempotent_request( *iter, request) ) return;
     }
-    if ( is_requested_bell_curve_2_ ) {
-        set_bell_curve_2( );
-        is_requested_bell_curve_2_ = false;
+    deferred_requests_.push_back( request);
+}
+
+  /* static */
+  bool
+  sheet_control_type::
+is_repeat_of_idempotent_request( request_type const & first, request_type const & second)
+  //
+  // True if the second request does nothing after the first. Most requests add to the sheet or
+  // scale it, and they always do something.
+{
+    if ( first.kind != second.kind ) return false;
+
+    e_request_kind_type const kind = first.kind;
+    if ( e_request_set_xy_sizes == kind ) {
+        return (first.x_size == second.x_size) && (first.y_size == second.y_size);
     }
-    if ( is_requested_bell_curve_4_ ) {
-        set_bell_curve_4( );
-        is_requested_bell_curve_4_ = false;
+    if ( e_request_set_xy_sizes_with_value == kind ) {
+        return
+            (first.x_size == second.x_size) && (first.y_size == second.y_size) &&
+            (first.init_value == second.init_value);
     }
+    return e_request_normalize_sheet == kind;
+}
+
+  bool
+  sheet_control_type::
+honor_request( request_type const & request)
+  //
+  // Returns false if the request cannot be honored yet.
+{
+    d_assert( ! are_requests_delayed( ));
+
+    // The solver's threads are idle between solves, so the sheet transforms that still run in
+    // this thread map their rows on the solver's pool.
+    row_pool::scoped_current_pool_type const scoped_pool( get_heat_solver( )->get_row_pool( ));
 
-    if ( is_requested_sin_over_dist_1_ ) {
+    e_request_kind_type const kind = request.kind;
+    if ( e_request_scale_sheet == kind ) {
+        scale_sheet( request.values_scale, request.momentum_scale);
+    } else
+    if ( e_request_set_xy_sizes == kind ) {
+        set_xy_sizes( request.x_size, request.y_size);
+    } else
+    if ( e_request_set_xy_sizes_with_value == kind ) {
+        set_xy_sizes( request.x_size, request.y_size, request.init_value);
+    } else
+    if ( e_request_bell_curve_1 == kind ) {
+        set_bell_curve_1( );
+    } else
+    if ( e_request_bell_curve_2 == kind ) {
+        set_bell_curve_2( );
+    } else
+    if ( e_request_bell_curve_4 == kind ) {
+        set_bell_curve_4( );
+    } else
+    if ( e_request_sin_over_dist_1 == kind ) {
         set_sin_over_dist_1( );
-        is_requested_sin_over_dist_1_ = false;
-    }
-    if ( is_requested_sin_over_dist_2_ ) {
+    } else
+    if ( e_request_sin_over_dist_2 == kind ) {
         set_sin_over_dist_2( );
-        is_requested_sin_over_dist_2_ = false;
-    }
-    if ( is_requested_sin_over_dist_4_ ) {
+    } else
+    if ( e_request_sin_over_dist_4 == kind ) {
         set_sin_over_dist_4( );
-        is_requested_sin_over_dist_4_ = false;
-    }
-
-    if ( is_requested_set_init_test_ ) {
+    } else
+    if ( e_request_set_init_test == kind ) {
         set_init_test( );
-        is_requested_set_init_test_ = false;
-    }
-
-    if ( is_requested_ramp_corner_to_corner_ ) {
+    } else
+    if ( e_request_ramp_corner_to_corner == kind ) {
         ramp_corner_to_corner( );
-        is_requested_ramp_corner_to_corner_ = false;
-    }
-
-    if ( is_requested_ramp_2_corners_ ) {
+    } else
+    if ( e_request_ramp_2_corners == kind ) {
         ramp_2_corners( );
-        is_requested_ramp_2_corners_ = false;
-    }
-
-    if ( is_requested_ramp_4_corners_ ) {
+    } else
+    if ( e_request_ramp_4_corners == kind ) {
         ramp_4_corners( );
-        is_requested_ramp_4_corners_ = false;
-    }
-
-    if ( is_requested_bell_corner_1_ ) {
+    } else
+    if ( e_request_bell_corner_1 == kind ) {
         bell_corner_1( );
-        is_requested_bell_corner_1_ = false;
-    }
-    if ( is_requested_bell_corner_2_ ) {
+    } else
+    if ( e_request_bell_corner_2 == kind ) {
         bell_corner_2( );
-        is_requested_bell_corner_2_ = false;
-    }
-    if ( is_requested_bell_corner_3_ ) {
+    } else
+    if ( e_request_bell_corner_3 == kind ) {
         bell_corner_3( );
-        is_requested_bell_corner_3_ = false;
-    }
-    if ( is_requested_bell_corner_4_ ) {
+    } else
+    if ( e_request_bell_corner_4 == kind ) {
         bell_corner_4( );
-        is_requested_bell_corner_4_ = false;
-    }
-
-    if ( is_requested_raindrop_up_ ) {
+    } else
+    if ( e_request_raindrop_up == kind ) {
         raindrop_up( );
-        is_requested_raindrop_up_ = false;
-    }
-    if ( is_requested_raindrop_down_ ) {
+    } else
+    if ( e_request_raindrop_down == kind ) {
         raindrop_down( );
-        is_requested_raindrop_down_ = false;
-    }
-
-    if ( is_requested_delta_ ) {
+    } else
+    if ( e_request_delta == kind ) {
         set_delta( );
-        is_requested_delta_ = false;
-    }
-
-    if ( is_requested_stair_steps_ ) {
+    } else
+    if ( e_request_stair_steps == kind ) {
         set_stair_steps( );
-        is_requested_stair_steps_ = false;
-    }
-
-    if ( is_requested_set_sheet_random_noise_ ) {
+    } else
+    if ( e_request_set_sheet_random_noise == kind ) {
         set_sheet_random_noise( );
-        is_requested_set_sheet_random_noise_ = false;
-    }
-
-    if ( is_requested_normalize_sheet_ ) {
+    } else
+    if ( e_request_normalize_sheet == kind ) {
         normalize_sheet( );
-        is_requested_normalize_sheet_ = false;
+    } else
+    if ( e_request_reverse_wave == kind ) {
+        return reverse_wave( );
+    } else
+    {
+        d_assert( false);
     }
+    return true;
+}
 
-    if ( is_requested_reverse_wave_ ) {
-        if ( reverse_wave( ) ) {
-            is_requested_reverse_wave_ = false;
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+//
+// Transform jobs
+//
+//   The transforms below change the next sheet in the solver's worker thread, between solves.
+//   They hand one of these jobs to transform_next_sheet(..), which starts it. The worker
+//   deletes the job when it is done.
+// _______________________________________________________________________________________________
+
+  namespace /* anonymous */ {
+
+  class
+fill_sheet_job_type
+  : public heat_solver::transform_job_type
+  //
+  // Calls one of the sheet_type::fill_*( ) methods, like fill_bell_curve_1( ).
+{
+  public:
+    typedef bool (sheet_type::* fill_method_type)( );
+
+    fill_sheet_job_type( sheet_type & sheet, fill_method_type p_fill)
+      : sheet_  ( sheet)
+      , p_fill_ ( p_fill)
+      { }
+
+    virtual
+      void
+    run( ) const
+      { (sheet_.*p_fill_)( ); }
+
+  private:
+    sheet_type        &  sheet_  ;
+    fill_method_type     p_fill_ ;
+};
+
+// _______________________________________________________________________________________________
+
+  template< typename CALC_NEW_VALUE_FUNCTOR_TYPE >
+  class
+transform_sheet_job_type
+  : public heat_solver::transform_job_type
+  //
+  // Transforms the sheet with a functor. Adds the new values to the old ones if is_sum.
+{
+  public:
+    transform_sheet_job_type
+     (  sheet_type                         &  sheet
+      , CALC_NEW_VALUE_FUNCTOR_TYPE const  &  functor
+      , bool                                  is_sum
+     )
+      : sheet_   ( sheet)
+      , functor_ ( functor)
+      , is_sum_  ( is_sum)
+      { }
+
+    virtual
+      void
+    run( ) const
+      { if ( is_sum_ ) {
+            sheet_.transform_sheet( functor_, util::assign_sum_type< sheet_type::value_type >( ));
+        } else {
+            sheet_.transform_sheet( functor_);
         }
-    }
+      }
+
+  private:
+    sheet_type                         &  sheet_   ;
+    CALC_NEW_VALUE_FUNCTOR_TYPE const     functor_ ;
+    bool                        const     is_sum_  ;
+};
+
+  template< typename CALC_NEW_VALUE_FUNCTOR_TYPE >
+  heat_solver::transform_job_type const *
+new_transform_sheet_job
+ (  sheet_type                         &  sheet
+  , CALC_NEW_VALUE_FUNCTOR_TYPE const  &  functor
+  , bool                                  is_sum  = false
+ )
+{
+    return new transform_sheet_job_type< CALC_NEW_VALUE_FUNCTOR_TYPE >( sheet, functor, is_sum);
 }
 
+// _______________________________________________________________________________________________
+
+  class
+scale_sheet_job_type
+  : public heat_solver::transform_job_type
+{
+  public:
+    scale_sheet_job_type( sheet_type & sheet, sheet_type::value_type scale)
+      : sheet_ ( sheet)
+      , scale_ ( scale)
+      { }
+
+    virtual
+      void
+    run( ) const
+      { sheet_ *= scale_; }
+
+  private:
+    sheet_type                    &  sheet_ ;
+    sheet_type::value_type const     scale_ ;
+};
+
+// _______________________________________________________________________________________________
+
+  class
+normalize_sheet_job_type
+  : public heat_solver::transform_job_type
+  //
+  // Normalizes the sheet to [-1, +1] and sets *p_scale to how much the values were scaled (or
+  // zero). The stats are from the last solve, and are empty if the sheet has changed since or
+  // the solve didn't gather them. Then we scan the sheet for the min/max here.
+{
+  public:
+    normalize_sheet_job_type
+     (  sheet_type                 &  sheet
+      , sheet_stats_type     const &  stats
+      , sheet_type::value_type     *  p_scale
+     )
+      : sheet_   ( sheet)
+      , stats_   ( stats)
+      , p_scale_ ( p_scale)
+      { d_assert( p_scale); }
+
+    virtual
+      void
+    run( ) const
+      { if ( stats_.is_empty( ) ) {
+            sheet_.normalize( -1, +1, p_scale_);
+        } else {
+            sheet_.normalize_with_min_max
+             (  static_cast< sheet_type::value_type >( stats_.get_min_value( ))
+              , static_cast< sheet_type::value_type >( stats_.get_max_value( ))
+              , -1, +1, p_scale_
+             );
+        }
+      }
+
+  private:
+    sheet_type                 &  sheet_   ;
+    sheet_stats_type     const    stats_   ;
+    sheet_type::value_type *
+                         const    p_scale_ ;
+};
+
+  } /* end namespace anonymous */
+
 // _______________________________________________________________________________________________
 // _______________________________________________________________________________________________
 //
@@ -832,11 +1108,7 @@ honor_requests( )
   sheet_control_type::
 request_set_init_test( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_set_init_test_ = true;
-    } else {
-        set_init_test( );
-    }
+    post_or_honor_request( e_request_set_init_test);
 }
 
   void
@@ -910,11 +1182,7 @@ set_init_test( )
   sheet_control_type::
 request_set_sheet_random_noise( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_set_sheet_random_noise_ = true;
-    } else {
-        set_sheet_random_noise( );
-    }
+    post_or_honor_request( e_request_set_sheet_random_noise);
 }
 
   void
@@ -957,26 +1225,23 @@ set_sheet_random_noise( )
   sheet_control_type::
 request_normalize_sheet( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_normalize_sheet_ = true;
-    } else {
-        normalize_sheet( );
-    }
+    post_or_honor_request( e_request_normalize_sheet);
 }
 
   void
   sheet_control_type::
 normalize_sheet( )
 {
-    prepare_for_transform( );
+    // The stats from the last solve tell us the min/max values without scanning the sheet.
+    // They are empty if the current sheet has changed since the solve, or if the solve had no
+    // pass to gather them in.
+    sheet_stats_type const stats = current_sheet_stats_;
 
-    value_type scale = 0;
-    p_sheet_next_->normalize( -1, +1, & scale);
-    if ( 0 != scale ) {
-        maybe_scale_saved_history( scale);
-    }
+    prepare_for_transform( );
 
-    after_transform( );
+    // The saved history is scaled to match when the job is done.
+    d_assert( 0 == transform_history_scale_);
+    transform_next_sheet( new normalize_sheet_job_type( *p_sheet_next_, stats, & transform_history_scale_));
 }
 
 // _______________________________________________________________________________________________
@@ -1036,13 +1301,11 @@ request_half_both( )
   sheet_control_type::
 request_scale_sheet( float values_scale, float momentum_scale)
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_scale_sheet_ = true;
-        requested_values_scale_   = values_scale  ;
-        requested_momentum_scale_ = momentum_scale;
-    } else {
-        scale_sheet( values_scale, momentum_scale);
-    }
+    request_type request = request_type( );
+    request.kind           = e_request_scale_sheet;
+    request.values_scale   = values_scale  ;
+    request.momentum_scale = momentum_scale;
+    post_or_honor_request( request);
 }
 
   void
@@ -1064,6 +1327,7 @@ scale_sheet( float values_scale, float momentum_scale)
     // Maybe discard all momentum.
     if ( is_flatten_momentum ) {
         is_next_sheet_valid_history_ = false;
+        is_velocity_valid_           = false;
 
         // If we're only discarding momentum we are done.
         if ( is_leave_values ) return;
@@ -1072,15 +1336,15 @@ scale_sheet( float values_scale, float momentum_scale)
     // We're going to need to increment the generation.
     prepare_for_transform( is_flatten_values ? e_flatten_next_sheet : e_copy_current_to_next_sheet);
 
-    // Take care of scaling.
-    if ( is_scale_values ) {
-        (*p_sheet_next_) *= values_scale;
-    }
+    // Take care of scaling. The history is saved in the extra sheet, which the job does not touch.
     if ( is_scale_momentum ) {
         maybe_scale_saved_history( momentum_scale);
     }
-
-    after_transform( );
+    if ( is_scale_values ) {
+        transform_next_sheet( new scale_sheet_job_type( *p_sheet_next_, values_scale));
+    } else {
+        after_transform( );
+    }
 }
 
 # if 0
@@ -1164,11 +1428,7 @@ scale_momentum( float scale)
   sheet_control_type::
 request_bell_curve_1( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_bell_curve_1_ = true;
-    } else {
-        set_bell_curve_1( );
-    }
+    post_or_honor_request( e_request_bell_curve_1);
 }
 
   /* slot */
@@ -1176,11 +1436,7 @@ request_bell_curve_1( )
   sheet_control_type::
 request_bell_curve_2( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_bell_curve_2_ = true;
-    } else {
-        set_bell_curve_2( );
-    }
+    post_or_honor_request( e_request_bell_curve_2);
 }
 
   /* slot */
@@ -1188,11 +1444,7 @@ request_bell_curve_2( )
   sheet_control_type::
 request_bell_curve_4( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_bell_curve_4_ = true;
-    } else {
-        set_bell_curve_4( );
-    }
+    post_or_honor_request( e_request_bell_curve_4);
 }
 
   void
@@ -1204,8 +1456,7 @@ set_bell_curve_1( )
     // It used to just set all the values without regard to the src, and we didn't need to
     // call copy_current_to_next_sheet( ) first.
     prepare_for_transform( );
-    p_sheet_next_->fill_bell_curve_1( );
-    after_transform( );
+    transform_next_sheet( new fill_sheet_job_type( *p_sheet_next_, & sheet_type::fill_bell_curve_1));
 }
 
   void
@@ -1213,8 +1464,7 @@ set_bell_curve_1( )
 set_bell_curve_2( )
 {
     prepare_for_transform( );
-    p_sheet_next_->fill_bell_curve_2( );
-    after_transform( );
+    transform_next_sheet( new fill_sheet_job_type( *p_sheet_next_, & sheet_type::fill_bell_curve_2));
 }
 
   void
@@ -1222,8 +1472,7 @@ set_bell_curve_2( )
 set_bell_curve_4( )
 {
     prepare_for_transform( );
-    p_sheet_next_->fill_bell_curve_4( );
-    after_transform( );
+    transform_next_sheet( new fill_sheet_job_type( *p_sheet_next_, & sheet_type::fill_bell_curve_4));
 }
 
 // _______________________________________________________________________________________________
@@ -1235,11 +1484,7 @@ set_bell_curve_4( )
   sheet_control_type::
 request_sin_over_dist_1( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_sin_over_dist_1_ = true;
-    } else {
-        set_sin_over_dist_1( );
-    }
+    post_or_honor_request( e_request_sin_over_dist_1);
 }
 
   /* slot */
@@ -1247,11 +1492,7 @@ request_sin_over_dist_1( )
   sheet_control_type::
 request_sin_over_dist_2( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_sin_over_dist_2_ = true;
-    } else {
-        set_sin_over_dist_2( );
-    }
+    post_or_honor_request( e_request_sin_over_dist_2);
 }
 
   /* slot */
@@ -1259,11 +1500,7 @@ request_sin_over_dist_2( )
   sheet_control_type::
 request_sin_over_dist_4( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_sin_over_dist_4_ = true;
-    } else {
-        set_sin_over_dist_4( );
-    }
+    post_or_honor_request( e_request_sin_over_dist_4);
 }
 
   void
@@ -1271,8 +1508,7 @@ request_sin_over_dist_4( )
 set_sin_over_dist_1( )
 {
     prepare_for_transform( );
-    p_sheet_next_->fill_sin_over_dist_1( );
-    after_transform( );
+    transform_next_sheet( new fill_sheet_job_type( *p_sheet_next_, & sheet_type::fill_sin_over_dist_1));
 }
 
   void
@@ -1280,8 +1516,7 @@ set_sin_over_dist_1( )
 set_sin_over_dist_2( )
 {
     prepare_for_transform( );
-    p_sheet_next_->fill_sin_over_dist_2( );
-    after_transform( );
+    transform_next_sheet( new fill_sheet_job_type( *p_sheet_next_, & sheet_type::fill_sin_over_dist_2));
 }
 
   void
@@ -1289,8 +1524,7 @@ set_sin_over_dist_2( )
 set_sin_over_dist_4( )
 {
     prepare_for_transform( );
-    p_sheet_next_->fill_sin_over_dist_4( );
-    after_transform( );
+    transform_next_sheet( new fill_sheet_job_type( *p_sheet_next_, & sheet_type::fill_sin_over_dist_4));
 }
 
 // _______________________________________________________________________________________________
@@ -1328,8 +1562,7 @@ corner_ramp_functor_type
 ramp_corner_to_corner( )
 {
     prepare_for_transform( );
-    p_sheet_next_->transform_sheet( corner_ramp_functor_type( *p_sheet_next_));
-    after_transform( );
+    transform_next_sheet( new_transform_sheet_job( *p_sheet_next_, corner_ramp_functor_type( *p_sheet_next_)));
 }
 
   /* slot */
@@ -1337,11 +1570,7 @@ ramp_corner_to_corner( )
   sheet_control_type::
 request_ramp_corner_to_corner( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_ramp_corner_to_corner_ = true;
-    } else {
-        ramp_corner_to_corner( );
-    }
+    post_or_honor_request( e_request_ramp_corner_to_corner);
 }
 
 // _______________________________________________________________________________________________
@@ -1351,11 +1580,7 @@ request_ramp_corner_to_corner( )
   sheet_control_type::
 request_ramp_2_corners( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_ramp_2_corners_ = true;
-    } else {
-        ramp_2_corners( );
-    }
+    post_or_honor_request( e_request_ramp_2_corners);
 }
 
   void
@@ -1421,11 +1646,7 @@ ramp_2_corners( )
   sheet_control_type::
 request_ramp_4_corners( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_ramp_4_corners_ = true;
-    } else {
-        ramp_4_corners( );
-    }
+    post_or_honor_request( e_request_ramp_4_corners);
 }
 
   void
@@ -1497,11 +1718,7 @@ ramp_4_corners( )
   sheet_control_type::
 request_bell_corner_1( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_bell_corner_1_ = true;
-    } else {
-        bell_corner_1( );
-    }
+    post_or_honor_request( e_request_bell_corner_1);
 }
 
   void
@@ -1512,17 +1729,18 @@ bell_corner_1( )
 
     value_type const  x_size  = static_cast< value_type >( p_sheet_next_->get_x_count( ));
     value_type const  y_size  = static_cast< value_type >( p_sheet_next_->get_y_count( ));
-    p_sheet_next_->transform_sheet
-     (  bell_curve_functor_type
-         (  0, 0  // corner
-          , x_size / 18
-          , y_size / 18
-          , 0, +1
+    transform_next_sheet
+     (  new_transform_sheet_job
+         (  *p_sheet_next_
+          , bell_curve_functor_type
+             (  0, 0  // corner
+              , x_size / 18
+              , y_size / 18
+              , 0, +1
+             )
+          , true /* add to the old values */
          )
-      , util::assign_sum_type< value_type >( )
      );
-
-    after_transform( );
 }
 
 // _______________________________________________________________________________________________
@@ -1532,11 +1750,7 @@ bell_corner_1( )
   sheet_control_type::
 request_bell_corner_2( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_bell_corner_2_ = true;
-    } else {
-        bell_corner_2( );
-    }
+    post_or_honor_request( e_request_bell_corner_2);
 }
 
   void
@@ -1547,17 +1761,18 @@ bell_corner_2( )
 
     value_type const  x_size  = static_cast< value_type >( p_sheet_next_->get_x_count( ));
     value_type const  y_size  = static_cast< value_type >( p_sheet_next_->get_y_count( ));
-    p_sheet_next_->transform_sheet
-     (  bell_curve_functor_type
-         (  0, 0  // corner
-          , x_size / 8
-          , y_size / 8
-          , 0, +1
+    transform_next_sheet
+     (  new_transform_sheet_job
+         (  *p_sheet_next_
+          , bell_curve_functor_type
+             (  0, 0  // corner
+              , x_size / 8
+              , y_size / 8
+              , 0, +1
+             )
+          , true /* add to the old values */
          )
-      , util::assign_sum_type< value_type >( )
      );
-
-    after_transform( );
 }
 
 // _______________________________________________________________________________________________
@@ -1567,11 +1782,7 @@ bell_corner_2( )
   sheet_control_type::
 request_bell_corner_3( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_bell_corner_3_ = true;
-    } else {
-        bell_corner_3( );
-    }
+    post_or_honor_request( e_request_bell_corner_3);
 }
 
   void
@@ -1582,17 +1793,18 @@ bell_corner_3( )
 
     value_type const  x_size  = static_cast< value_type >( p_sheet_next_->get_x_count( ));
     value_type const  y_size  = static_cast< value_type >( p_sheet_next_->get_y_count( ));
-    p_sheet_next_->transform_sheet
-     (  bell_curve_functor_type
-         (  0, 0  // corner
-          , x_size / 3
-          , y_size / 3
-          , 0, +1
+    transform_next_sheet
+     (  new_transform_sheet_job
+         (  *p_sheet_next_
+          , bell_curve_functor_type
+             (  0, 0  // corner
+              , x_size / 3
+              , y_size / 3
+              , 0, +1
+             )
+          , true /* add to the old values */
          )
-      , util::assign_sum_type< value_type >( )
      );
-
-    after_transform( );
 }
 
 // _______________________________________________________________________________________________
@@ -1602,11 +1814,7 @@ bell_corner_3( )
   sheet_control_type::
 request_bell_corner_4( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_bell_corner_4_ = true;
-    } else {
-        bell_corner_4( );
-    }
+    post_or_honor_request( e_request_bell_corner_4);
 }
 
   void
@@ -1617,17 +1825,18 @@ bell_corner_4( )
 
     value_type const  x_size  = static_cast< value_type >( p_sheet_next_->get_x_count( ));
     value_type const  y_size  = static_cast< value_type >( p_sheet_next_->get_y_count( ));
-    p_sheet_next_->transform_sheet
-     (  bell_curve_functor_type
-         (  0, y_size * 2 / 5
-          , x_size / 15
-          , y_size / 15
-          , 0, +1
+    transform_next_sheet
+     (  new_transform_sheet_job
+         (  *p_sheet_next_
+          , bell_curve_functor_type
+             (  0, y_size * 2 / 5
+              , x_size / 15
+              , y_size / 15
+              , 0, +1
+             )
+          , true /* add to the old values */
          )
-      , util::assign_sum_type< value_type >( )
      );
-
-    after_transform( );
 }
 
 // _______________________________________________________________________________________________
@@ -1639,11 +1848,7 @@ bell_corner_4( )
   sheet_control_type::
 request_raindrop_up( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_raindrop_up_ = true;
-    } else {
-        raindrop_up( );
-    }
+    post_or_honor_request( e_request_raindrop_up);
 }
 
   /* slot */
@@ -1651,11 +1856,7 @@ request_raindrop_up( )
   sheet_control_type::
 request_raindrop_down( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_raindrop_down_ = true;
-    } else {
-        raindrop_down( );
-    }
+    post_or_honor_request( e_request_raindrop_down);
 }
 
   void
@@ -1707,16 +1908,17 @@ raindrop_random
 
     prepare_for_transform( );
 
-    p_sheet_next_->transform_sheet
-     (  bell_curve_functor_type
-         (  x_center, y_center
-          , x_delta, y_delta
-          , 0, z_delta
+    transform_next_sheet
+     (  new_transform_sheet_job
+         (  *p_sheet_next_
+          , bell_curve_functor_type
+             (  x_center, y_center
+              , x_delta, y_delta
+              , 0, z_delta
+             )
+          , true /* add to the old values */
          )
-      , util::assign_sum_type< value_type >( )
      );
-
-    after_transform( );
 }
 
 // _______________________________________________________________________________________________
@@ -1728,11 +1930,7 @@ raindrop_random
   sheet_control_type::
 request_delta( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_delta_ = true;
-    } else {
-        set_delta( );
-    }
+    post_or_honor_request( e_request_delta);
 }
 
   void
@@ -1755,11 +1953,7 @@ set_delta( )
   sheet_control_type::
 request_stair_steps( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_stair_steps_ = true;
-    } else {
-        set_stair_steps( );
-    }
+    post_or_honor_request( e_request_stair_steps);
 }
 
   void
@@ -1835,11 +2029,7 @@ set_stair_steps( )
   sheet_control_type::
 request_reverse_wave( )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_reverse_wave_ = true;
-    } else {
-        reverse_wave( );
-    }
+    post_or_honor_request( e_request_reverse_wave);
 }
 
   bool
@@ -1849,7 +2039,7 @@ reverse_wave( )
   // Reverse the momentum of the wave.
   // Not very interesting if we're solving just heat and not wave.
 {
-    if ( is_next_sheet_valid_history_ ) {
+    if ( is_next_sheet_valid_history_ || is_velocity_valid_ ) {
         transform__reverse_wave( );
         return true;
     }
@@ -2065,7 +2255,9 @@ init_sheets( )
     p_sheet_extra_ = & sheet_c_;
 
     // There is no history yet.
-    is_next_sheet_valid_history_ = false;
+    is_next_sheet_valid_history_  = false;
+    is_velocity_valid_            = false;
+    is_current_sheet_last_solved_ = false;
 
     set_init_test( );
     d_assert( get_sheet_generation( ) == 0);
@@ -2080,15 +2272,12 @@ request_set_xy_sizes
   , float    /* value_type */  init_value
  )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_set_xy_sizes_            = true;
-        is_requested_set_xy_sizes_with_value_ = true;
-        requested_set_xy_sizes_x_             = x_size;
-        requested_set_xy_sizes_y_             = y_size;
-        requested_set_xy_sizes_value_         = init_value;
-    } else {
-        set_xy_sizes( x_size, y_size, init_value);
-    }
+    request_type request = request_type( );
+    request.kind           = e_request_set_xy_sizes_with_value;
+    request.x_size         = x_size;
+    request.y_size         = y_size;
+    request.init_value     = init_value;
+    post_or_honor_request( request);
 }
 
   void
@@ -2152,14 +2341,11 @@ request_set_xy_sizes
   , unsigned /* size_type */  y_size
  )
 {
-    if ( are_requests_delayed( ) ) {
-        is_requested_set_xy_sizes_            = true;
-        is_requested_set_xy_sizes_with_value_ = false;
-        requested_set_xy_sizes_x_             = x_size;
-        requested_set_xy_sizes_y_             = y_size;
-    } else {
-        set_xy_sizes( x_size, y_size);
-    }
+    request_type request = request_type( );
+    request.kind           = e_request_set_xy_sizes;
+    request.x_size         = x_size;
+    request.y_size         = y_size;
+    post_or_honor_request( request);
 }
 
   void
@@ -2187,6 +2373,10 @@ set_xy_sizes
     } else
     {
         prepare_for_transform( );
+        if ( is_velocity_valid_ ) {
+            // The velocity is a delta, like the history in the extra sheet below.
+            sheet_velocity_.change_xy_counts( x_size, y_size);
+        }
         if ( is_history_delta_in_extra_sheet_ ) {
             p_sheet_next_->change_xy_counts( x_size, y_size);
             p_sheet_extra_->change_xy_counts( x_size, y_size);
@@ -2314,12 +2504,10 @@ get_sheet_for_draw( )
     }
   # endif
 
-    // Check if we have a lower-resolution sheet to return for drawing.
-    sheet_type const * p_sheet_limited_draw = maybe_get_limited_draw_sheet( );
-    if ( p_sheet_limited_draw ) return * p_sheet_limited_draw;
-
-    // Return full-resolution sheet.
-    return * p_sheet_current_;
+    // Return the latest sheet published for drawing. This is shrunk if the draw size is
+    // limited. While a solve is pending this can be newer than the current sheet.
+    maybe_publish_current_sheet( );
+    return draw_buffer_.take_latest( );
 }
 
 // _______________________________________________________________________________________________
@@ -2349,6 +2537,14 @@ prepare_for_transform
         is_history_meaningful &&
         get_heat_solver( )->is_technique__wave_with_damping( ));
 
+    // The leapfrog velocity stays as it is thru the transform, unless the history is meaningless.
+    if ( ! is_history_meaningful ) {
+        is_velocity_valid_ = false;
+    } else
+    if ( get_heat_solver( )->is_technique__wave_leapfrog( ) ) {
+        maybe_set_velocity_from_history( );
+    }
+
     switch ( next_sheet_init ) {
       case e_copy_current_to_next_sheet:
         copy_current_to_next_sheet( );
@@ -2402,6 +2598,9 @@ after_transform( )
     // Should we increment the generation after a generation change, or only after a solve?
     increment_generation( );
 
+    // The solver cannot carry anything over from the last solve to the new current sheet.
+    is_current_sheet_last_solved_ = false;
+
     // These are experiments that should be moved if they are kept.
     // These should work whether on not history is valid, as long as the current sheet has
     // meaningful values (and not random noise) in it.
@@ -2427,12 +2626,28 @@ after_transform( )
     emit sheet_is_changed( );
 }
 
+  void
+  sheet_control_type::
+transform_next_sheet( heat_solver::transform_job_type const * p_job)
+  //
+  // Call this after prepare_for_transform(..) instead of changing the next sheet here and calling
+  // after_transform( ). The worker thread runs the job, and we call after_transform( ) when we
+  // hear it is done. Until then requests are delayed, like during a solve. The current sheet can
+  // still be drawn because the job only changes the next sheet.
+{
+    d_assert( p_job);
+    d_assert( ! are_requests_delayed( ));
+
+    is_transform_pending_ = true;
+    get_heat_solver( )->transform( p_job);
+}
+
   void
   sheet_control_type::
 transform__reverse_wave( )
 {
     // The caller should check this before invoking this function.
-    d_assert( is_next_sheet_valid_history_);
+    d_assert( is_next_sheet_valid_history_ || is_velocity_valid_);
 
     d_assert( ! is_history_delta_in_extra_sheet_);
     d_assert( ! is_next_solve_pending( ));
@@ -2442,6 +2657,17 @@ transform__reverse_wave( )
     // Should we increment the generation after a reverse_wave, or only after a solve?
     // Maybe we should count down backwards?
     increment_generation( );
+    is_current_sheet_last_solved_ = false;
+
+    // The leapfrog wave keeps its history in the velocity. Put the generation before back in the
+    // next sheet, and reverse that like the other wave. The next solve works the velocity out
+    // again from the history.
+    if ( is_velocity_valid_ ) {
+        (*p_sheet_next_)  = (*p_sheet_current_);
+        (*p_sheet_next_) -= sheet_velocity_;
+        is_next_sheet_valid_history_ = true;
+        is_velocity_valid_           = false;
+    }
 
     // These seem unnecessary when executing a wave reverse. But imagine this scenario:
     //   We are solving with the wave equation.
@@ -2490,6 +2716,7 @@ after_solve( )
         d_assert( static_cast< size_type >( solve_count) == solve_count_u);
         increment_generation( solve_count);
     }
+    skipped_generation_count_ = static_cast< gen_type >( get_heat_solver( )->get_skipped_generation_count( ));
 
     // These are experiments that should be moved if they are kept.
     // These should work whether on not history is valid, as long as the current sheet has
@@ -2497,6 +2724,11 @@ after_solve( )
     // These are OK even at generation zero (although we don't go thru here setting up gen zero).
     //
     // These move values from current to next.
+    // If any of them change the new sheet then the solver's stats no longer describe it.
+    bool const is_solved_sheet_changed =
+        (is_next_sheet_valid_history_ && are_edges_fixed_after_solve( )) ||
+        is_center_frozen( ) ||
+        is_vortex_on( );
     maybe_do_edge_fixing( );
     maybe_do_center_freeze( );
     maybe_do_vortex( );
@@ -2522,8 +2754,35 @@ after_solve( )
         is_next_sheet_valid_history_ = false;
     }
 
-    // If we have a lo-resolution drawing sheet, it will have to be set from the new current sheet.
+    // The drawing sheet will have to be published from the new current sheet. Unless the worker
+    // thread published it already and we haven't changed it (or the draw size) since.
+    // The worker does not publish more than about once a frame. If it skipped this generation
+    // the drawing code can keep the one before while we keep solving, instead of us copying
+    // this one. Once we stop it has to catch up (see stop_auto_solving( )).
     after_master_sheet_value_change( );
+    if ( is_solve_publishing_ && (! is_solved_sheet_changed) && is_published_draw_size_up_to_date( ) ) {
+        if ( get_heat_solver( )->is_last_generation_published( ) ) {
+            is_published_sheet_stale_ = false;
+        } else
+        if ( is_auto_solving( ) ) {
+            is_published_sheet_stale_ = false;
+            skipped_generation_count_ += 1;
+        }
+    }
+    is_solve_publishing_ = false;
+
+    // Keep the solver's stats for the new current sheet. The next solve can also start where
+    // this one left off.
+    if ( ! is_solved_sheet_changed ) {
+        current_sheet_stats_ = p_output_params->get_sheet_stats( );
+    }
+    is_current_sheet_last_solved_ = ! is_solved_sheet_changed;
+
+    // The leapfrog solve moved the velocity along with the sheet. But if we changed the sheet
+    // after the solve we work the velocity out again from the history, like the other wave.
+    if ( is_solved_sheet_changed ) {
+        is_velocity_valid_ = false;
+    }
 
     // Tell the world the current sheet now has different values.
     emit sheet_is_changed( );
@@ -2620,6 +2879,14 @@ maybe_scale_saved_history( value_type scale)
 {
     d_assert( p_sheet_extra_);
 
+    if ( is_velocity_valid_ ) {
+        if ( 0 == scale ) {
+            is_velocity_valid_ = false;
+        } else {
+            sheet_velocity_ *= scale;
+        }
+    }
+
     if ( is_history_delta_in_extra_sheet_ ) {
         if ( 0 == scale ) {
             is_history_delta_in_extra_sheet_ = false;
@@ -2656,28 +2923,89 @@ restore_history_in_extra_sheet_if_available( )
     }
 }
 
+  void
+  sheet_control_type::
+maybe_set_velocity_from_history( )
+  //
+  // If we don't have the leapfrog velocity we can work it out from the history in the next sheet.
+{
+    d_assert( p_sheet_current_);
+    d_assert( p_sheet_next_);
+
+    if ( (! is_velocity_valid_) && is_next_sheet_valid_history_ ) {
+        sheet_velocity_  = (*p_sheet_current_);
+        sheet_velocity_ -= (*p_sheet_next_);
+        is_velocity_valid_ = true;
+    }
+}
+
+  sheet_type *
+  sheet_control_type::
+maybe_get_velocity_sheet( )
+  //
+  // The velocity for the next solve, or zero if we are not solving the leapfrog wave.
+  //
+  // The leapfrog wave keeps the velocity from one solve to the next, so it never has to copy
+  // sheets around to set up the history. If we don't have a velocity we work it out from the
+  // history, or start with no velocity at all, like the other wave does.
+  // This is only called between solves.
+{
+    d_assert( p_sheet_current_);
+
+    if ( ! get_heat_solver( )->is_technique__wave_leapfrog( ) ) {
+        // The other solves move the sheet along without the velocity.
+        is_velocity_valid_ = false;
+        sheet_velocity_.reset( );
+        return 0;
+    }
+
+    maybe_set_velocity_from_history( );
+    if ( ! is_velocity_valid_ ) {
+        d_verify( sheet_velocity_.set_xy_counts( get_x_size( ), get_y_size( ), 0));
+        is_velocity_valid_ = true;
+    }
+    d_assert( sheet_velocity_.get_x_count( ) == p_sheet_current_->get_x_count( ));
+    d_assert( sheet_velocity_.get_y_count( ) == p_sheet_current_->get_y_count( ));
+    return & sheet_velocity_;
+}
+
 // _______________________________________________________________________________________________
 
-  /* slot */
-  void
+  bool
   sheet_control_type::
-set__are_edges_fixed( bool are_they)
+are_edges_fixed( ) const
+  //
+  // The fixed edges are the solver's fixed (Dirichlet) boundary.
 {
-    are_edges_fixed_ = are_they;
+    return p_heat_solver_ && p_heat_solver_->is_boundary__fixed( );
+}
+
+  bool
+  sheet_control_type::
+are_edges_fixed_after_solve( ) const
+  //
+  // Most solves fix the edges themselves, in the same sweep as the rest of the sheet. We only
+  // have to fix them for the techniques that solve with insulated edges (see
+  // heat_solver::get_solved_boundary(..)).
+{
+    return are_edges_fixed( ) &&
+        (heat_solver::e_boundary_fixed !=
+            heat_solver::get_solved_boundary
+             (  p_heat_solver_->get_technique( )
+              , p_heat_solver_->get_method( )
+              , heat_solver::e_boundary_fixed
+             ));
 }
 
   void
   sheet_control_type::
 maybe_do_edge_fixing( )
   //
-  // Fix the edges by copying the previous edge values to the next sheet.
+  // Fix the edges by copying the previous edge values to the next sheet, if the solver did not.
   // Only do this when is_next_sheet_valid_history_ is set, so that the experimental
   // transforms can change the edge values. The edges are only locked when we are solving.
-  //
-  // This (fixing the edges) should not be here. If it is useful it should be moved into
-  // the solver, and from there into the finite_diff functions.
 {
-    if ( is_next_sheet_valid_history_ && are_edges_fixed( ) ) {
+    if ( is_next_sheet_valid_history_ && are_edges_fixed_after_solve( ) ) {
         copy_current_edges_to_next_sheet( );
     }
 }
@@ -2686,8 +3014,8 @@ maybe_do_edge_fixing( )
   sheet_control_type::
 copy_current_edges_to_next_sheet( )
   //
-  // This is just an experiment. Otherwise it would be moved to heat_solver and maybe to the
-  // finite_diff solving code.
+  // This is the fallback for the solves without a fixed boundary built in. The others fix the
+  // edges as they solve (see the boundaries in finite_diff.h).
   //
   // Other experiments performed:
   //
@@ -2714,7 +3042,8 @@ copy_current_edges_to_next_sheet( )
   //
   //   Wave: Fixed and floating edges are easy. To make edges that damp and do not reflect we need
   //   to introduce several layers with slowly increasing damping until the outside edge has damping==1.
-  //   The more layers we have the smaller the residual reflection.
+  //   The more layers we have the smaller the residual reflection. This is now the solver's
+  //   absorbing boundary.
 {
     bool const is_big_enough__x_size = (get_x_size( ) > 2);
     bool const is_big_enough__y_size = (get_y_size( ) > 2);
@@ -2772,7 +3101,8 @@ set__is_center_frozen( bool is_it)
         // If we are not auto-solving we do the following so the frozen center shows up.
         // If we are not auto-solving this throws away history. But if we are auto-solving then
         // history is kept. This only matters if we are using history (solving the wave equation).
-        if ( is_center_frozen( ) && ! is_auto_solving( ) ) {
+        // If a solve or transform is pending the frozen center shows up after that.
+        if ( is_center_frozen( ) && ! is_auto_solving( ) && ! are_requests_delayed( ) ) {
             prepare_for_transform( );
             after_transform( );
         }
@@ -2801,8 +3131,9 @@ set__is_vortex_on( bool is_it)
     if ( is_it != is_vortex_on_ ) {
         is_vortex_on_ = is_it;
 
-        // If we are not auto-solving we do the following when we turn this on.
-        if ( is_vortex_on( ) && ! is_auto_solving( ) ) {
+        // If we are not auto-solving we do the following when we turn this on. Unless a solve or
+        // transform is pending. Then it shows up after that.
+        if ( is_vortex_on( ) && ! is_auto_solving( ) && ! are_requests_delayed( ) ) {
             prepare_for_transform( );
             after_transform( );
         }
@@ -2814,7 +3145,7 @@ set__is_vortex_on( bool is_it)
 maybe_do_vortex( )
 {
     if ( is_vortex_on( ) ) {
-        float      const  pi          = static_cast< float >( angle_holder::pi);
+        float      const  pi          = static_cast< float >( std::acos( static_cast< double >( -1)));
         float      const  angle       = pi * static_cast< float >( generation_current_ % 30) / 15;
 
         size_type  const  center_x    = get_x_size( ) / 2;
@@ -2830,6 +3161,54 @@ maybe_do_vortex( )
     }
 }
 
+// _______________________________________________________________________________________________
+
+  /* slot */
+  void
+  sheet_control_type::
+set__is_insulating_wall_on( bool is_it)
+  //
+  // The next solve picks this up. The wall does not change the sheet, so there is nothing to
+  // show until then.
+{
+    is_insulating_wall_on_ = is_it;
+}
+
+  heat_solver::conductivity_sheet_type const *
+  sheet_control_type::
+maybe_get_conductivity_sheet( )
+  //
+  // The conductivity map for the next solve, or zero if every cell conducts the same.
+  //
+  // This is just an experiment, like the vortex. The map is a wall down the middle of the sheet
+  // that conducts 1/64 as well as the rest, with a gap in the middle third. The map is rebuilt
+  // when the sheet changes size. This is only called between solves, when the solver is not
+  // reading the map.
+{
+    if ( ! is_insulating_wall_on( ) ) {
+        conductivity_sheet_.reset( );
+        return 0;
+    }
+
+    size_type const  x_count  = p_sheet_current_->get_x_count( );
+    size_type const  y_count  = p_sheet_current_->get_y_count( );
+    if ( (conductivity_sheet_.get_x_count( ) != x_count) || (conductivity_sheet_.get_y_count( ) != y_count) ) {
+        d_verify( conductivity_sheet_.set_xy_counts( x_count, y_count, 1));
+
+        size_type const  wall_width  = std::max< size_type >( 1, x_count / 32);
+        size_type const  wall_lo     = (x_count - wall_width) / 2;
+        size_type const  gap_lo      = y_count / 3;
+        size_type const  gap_hi      = y_count - gap_lo;
+        heat_solver::conductivity_sheet_type::iterator row = conductivity_sheet_.begin( );
+        for ( size_type y = 0 ; y < y_count ; y += 1, row += x_count ) {
+            if ( (y < gap_lo) || (y >= gap_hi) ) {
+                std::fill( row + wall_lo, row + (wall_lo + wall_width), 1.0f / 64);
+            }
+        }
+    }
+    return & conductivity_sheet_;
+}
+
 // _______________________________________________________________________________________________
 // Draw-size limits - limited resolution draw
 //
@@ -2845,24 +3224,36 @@ maybe_do_vortex( )
 //   The following member vars are calculated:
 //     x_draw_size_limit_
 //     y_draw_size_limit_
-//     sheet_limited_draw_
-//     is_limited_draw_sheet_written_
+//
+//   The draw buffer shrinks the sheets to the limits as they are published.
 
-  sheet_type const *
+  void
   sheet_control_type::
-maybe_get_limited_draw_sheet( )
+maybe_publish_current_sheet( )
+  //
+  // Publishes the current sheet for drawing if it's out-of-date. We cannot publish while a solve
+  // is pending because the worker thread may be publishing. But it will publish soon.
 {
-    // Check if we have a lower-resolution sheet to return for drawing.
-    if ( is_draw_size_limited( ) && get_x_draw_size_limit( ) && get_y_draw_size_limit( ) ) {
-        // Copy the values in the current sheet to the lo-res sheet if it's out-of-date.
-        if ( ! is_limited_draw_sheet_written_ ) {
-            d_verify( sheet_type::copy_preserve_heights( *p_sheet_current_, sheet_limited_draw_));
-            is_limited_draw_sheet_written_ = true;
+    if ( is_published_sheet_stale_ && ! is_next_solve_pending( ) ) {
+        if ( is_draw_size_limited( ) ) {
+            draw_buffer_.set_draw_size( get_x_draw_size_limit( ), get_y_draw_size_limit( ));
+        } else {
+            draw_buffer_.set_draw_size( 0, 0);
         }
-        // Return the lo-res drawing sheet.
-        return & sheet_limited_draw_;
+        draw_buffer_.publish( *p_sheet_current_);
+        is_published_sheet_stale_ = false;
     }
-    return 0;
+}
+
+  bool
+  sheet_control_type::
+is_published_draw_size_up_to_date( ) const
+{
+    return is_draw_size_limited( ) ?
+        ((draw_buffer_.get_x_draw_size( ) == get_x_draw_size_limit( )) &&
+         (draw_buffer_.get_y_draw_size( ) == get_y_draw_size_limit( ))) :
+        ((draw_buffer_.get_x_draw_size( ) == 0) &&
+         (draw_buffer_.get_y_draw_size( ) == 0)) ;
 }
 
   void
@@ -2872,8 +3263,6 @@ init_draw_size_limits( )
   // Sets these:
   //   x_draw_size_limit_
   //   y_draw_size_limit_
-  //   sheet_limited_draw_
-  //   is_limited_draw_sheet_written_
   //
   // Based on these:
   //   is_draw_size_limited_
@@ -2893,8 +3282,11 @@ after_master_sheet_size_change( )
   sheet_control_type::
 after_master_sheet_value_change( )
 {
-    // If we have a lo-resolution drawing sheet, it will have to be set from the new current sheet.
-    is_limited_draw_sheet_written_ = false;
+    // The drawing sheet will have to be published from the new current sheet.
+    is_published_sheet_stale_ = true;
+
+    // The stats are for the old values. after_solve( ) sets them again if it can.
+    current_sheet_stats_.clear( );
 }
 
   /* slot */
@@ -3042,31 +3434,11 @@ calc_x_and_y_draw_size_limits( )
   sheet_control_type::
 setup_sheet_limited_draw( )
   //
-  // Sets sheet_limited_draw_ and is_limited_draw_sheet_written_.
+  // The draw buffer is resized the next time we publish. If a solve is pending the worker thread
+  // publishes at the old size, and we publish again after the solve.
 {
-    bool is_draw_sheet_changed = false;
-
-    if ( is_draw_size_limited( ) && get_x_draw_size_limit( ) && get_y_draw_size_limit( ) ) {
-        if ( (get_x_draw_size_limit( ) != sheet_limited_draw_.get_x_count( )) ||
-             (get_y_draw_size_limit( ) != sheet_limited_draw_.get_y_count( )) )
-        {
-            if ( (! get_x_draw_size_limit( )) ||
-                 (! get_y_draw_size_limit( )) )
-            {
-                sheet_limited_draw_.reset( );
-            } else {
-                sheet_limited_draw_.set_xy_counts_raw_values( get_x_draw_size_limit( ), get_y_draw_size_limit( ));
-                is_limited_draw_sheet_written_ = false;
-            }
-            is_draw_sheet_changed = true;
-        }
-    } else
-    if ( sheet_limited_draw_.not_reset( ) ) {
-        sheet_limited_draw_.reset( );
-        is_draw_sheet_changed = true;
-    }
-
-    if ( is_draw_sheet_changed ) {
+    if ( ! is_published_draw_size_up_to_date( ) ) {
+        is_published_sheet_stale_ = true;
         emit draw_size_limit_is_changed( );
     }
 }
@@ -3078,16 +3450,10 @@ assert_draw_size_setup( ) const
 {
     if ( (0 == x_draw_size_limit_) || (0 == y_draw_size_limit_) ) {
         d_assert( (x_draw_size_limit_ == 0) && (y_draw_size_limit_ == 0));
-        d_assert( sheet_limited_draw_.is_reset( ));
     } else {
         d_assert( (x_draw_size_limit_ >= 2) && (y_draw_size_limit_ >= 2));
-        if ( is_draw_size_limited_ ) {
-            d_assert( sheet_limited_draw_.get_x_count( ) == x_draw_size_limit_);
-            d_assert( sheet_limited_draw_.get_y_count( ) == y_draw_size_limit_);
-        } else {
-            d_assert( sheet_limited_draw_.is_reset( ));
-        }
     }
+    d_assert( is_published_sheet_stale_ || is_published_draw_size_up_to_date( ));
 }
 # endif
 
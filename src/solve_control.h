@@ -27,9 +27,11 @@
 # include "moving_sum.h"
 # include "sheet.h"
 # include "heat_solver.h"
+# include "draw_buffer.h"
 
 # include <QtCore/QObject>
 # include <QtCore/QTimer>
+# include <vector>
 
 // _______________________________________________________________________________________________
 
@@ -95,6 +97,7 @@ sheet_control_type
 
   private slots:
     void            finished__from_solver( )                  ;
+    void            finished_transform__from_solver( )        ;
 
   signals:
     void            auto_solving_started( bool)               ;
@@ -280,6 +283,8 @@ sheet_control_type
 
     void            after_transform__cancel( )                ;
     void            after_transform( )                        ;
+    void            transform_next_sheet( heat_solver::transform_job_type const *)
+                                                              ;
     void            transform__reverse_wave( )                ;
     void            after_solve( )                            ;
 
@@ -291,20 +296,27 @@ sheet_control_type
     void            maybe_scale_saved_history( value_type)    ;
     void            restore_history_in_extra_sheet_if_available( )
                                                               ;
+    void            maybe_set_velocity_from_history( )        ;
+    sheet_type *    maybe_get_velocity_sheet( )               ;
 
     void            maybe_do_edge_fixing( )                   ;
     void            maybe_do_center_freeze( )                 ;
     void            maybe_do_vortex( )                        ;
+    heat_solver::conductivity_sheet_type const *
+                    maybe_get_conductivity_sheet( )           ;
   public slots:
-    void            set__are_edges_fixed( bool)               ;
     void            set__is_center_frozen( bool)              ;
     void            set__is_vortex_on( bool)                  ;
+    void            set__is_insulating_wall_on( bool)         ;
   public:
-    bool            are_edges_fixed( )                  const { return are_edges_fixed_; }
+    bool            are_edges_fixed( )                  const ;
+    bool            are_edges_fixed_after_solve( )      const ;
     bool            is_center_frozen( )                 const { return is_center_frozen_; }
     bool            is_vortex_on( )                     const { return is_vortex_on_; }
+    bool            is_insulating_wall_on( )            const { return is_insulating_wall_on_; }
     bool            is_auto_solving( )                  const { return is_auto_solving_; }
     bool            is_next_solve_pending( )            const { return is_next_solve_pending_; }
+    bool            is_transform_pending( )             const { return is_transform_pending_; }
     bool            is_sheet_change_expected_soon( tick_duration_type tick_count_to_wait)
                                                         const ;
 
@@ -312,10 +324,12 @@ sheet_control_type
     sheet_type const &
                     get_sheet_for_draw( )                     ;
     gen_type        get_sheet_generation( )             const { return generation_current_; }
+    gen_type        get_skipped_generation_count( )     const { return skipped_generation_count_; }
 
   signals:
     void            sheet_is_changed( )                       ;
     void            draw_size_limit_is_changed( )             ;
+    void            published_sheet_is_changed( )             ; /* in the middle of a free-running solve */
 
   // _______________________________________________________________________________________________
   // Draw-size limits - limited resolution draw
@@ -338,8 +352,8 @@ sheet_control_type
     void            set_xy_draw_size_limit( size_type)        ;
 
   protected:
-    sheet_type const *
-                    maybe_get_limited_draw_sheet( )           ;
+    void            maybe_publish_current_sheet( )            ;
+    bool            is_published_draw_size_up_to_date( ) const ;
 
     void            init_draw_size_limits( )                  ;
     void            after_master_sheet_value_change( )        ;
@@ -442,7 +456,8 @@ sheet_control_type
   // Sheets, arrays of numbers that we draw and solve
   private:
     // p_sheet_current_ alternates between pointing to sheet_a_ and sheet_b_.
-    // p_sheet_current_ is the sheet that is painted and read from the outside.
+    // p_sheet_current_ is the sheet that is read from the outside. It is painted thru a copy in
+    // draw_buffer_ (below).
     // p_sheet_current_ can be changed, but only when there is no solve currently in progress.
     sheet_type            *  p_sheet_current_                             ;
 
@@ -472,15 +487,36 @@ sheet_control_type
     bool                     is_history_delta_in_extra_sheet_             ;
     bool                     is_next_sheet_valid_history_                 ;
 
+    // The leapfrog wave keeps its history here instead of in the next sheet: how far each cell
+    // moved in the last generation. It stays with the current sheet thru the transforms that
+    // keep history, and thru size changes. Only used while solving the leapfrog wave.
+    sheet_type               sheet_velocity_                              ;
+    bool                     is_velocity_valid_                           ;
+
+    // True if the current sheet is just as the last solve left it. The solver can skip the
+    // tiles that were quiet in that solve.
+    bool                     is_current_sheet_last_solved_                ;
+
     // Is pending means the worker thread is currently performing a solve.
     // In this case the current sheet is locked. It can be read but not changed.
     bool                     is_next_solve_pending_                       ;
 
-    // True when the edges of the sheets are frozen in place.
-    bool                     are_edges_fixed_                             ;
+    // Is pending means the worker thread is changing the next sheet for a transform (see
+    // transform_next_sheet(..)). We call after_transform( ) when it is done.
+    bool                     is_transform_pending_                        ;
+
+    // Set by the normalize transform in the worker thread. If not zero we scale the saved history
+    // by this when the transform is done.
+    value_type               transform_history_scale_                     ;
+
     bool                     is_center_frozen_                            ;
     bool                     is_vortex_on_                                ;
 
+    // The conductivity of each cell, passed to the solver. Only used when the wall is on.
+    bool                     is_insulating_wall_on_                       ;
+    heat_solver::conductivity_sheet_type
+                             conductivity_sheet_                          ;
+
   // --------------------------------------------------------
   // Solving engine
   private:
@@ -494,6 +530,9 @@ sheet_control_type
     // The "current" generation is the result of the "last" solve.
     gen_type                 generation_current_                          ;
 
+    // How many generations the last solve went thru without publishing them for drawing.
+    gen_type                 skipped_generation_count_                    ;
+
   // --------------------------------------------------------
   // Timing statistics
   private:
@@ -542,52 +581,94 @@ sheet_control_type
   // Limited draw, to reduce the number of polygons used to draw
   private:
     bool                     is_draw_size_limited_                        ;
-    bool                     is_limited_draw_sheet_written_               ;
     size_type                xy_draw_size_limit_                          ;
     size_type                x_draw_size_limit_                           ;
     size_type                y_draw_size_limit_                           ;
     float                    ratio_xy_sheet_to_xy_limit_                  ;
-    sheet_type               sheet_limited_draw_                          ;
+
+  // --------------------------------------------------------
+  // The sheets we draw
+  private:
+    // The worker thread publishes solved sheets here as soon as they're done (but not more than
+    // about once a frame), and we publish the current sheet here after other changes. These are
+    // shrunk to the draw-size limits.
+    draw_buffer_type         draw_buffer_                                 ;
+
+    // True when the current sheet (or the draw size) has changed since we last published.
+    bool                     is_published_sheet_stale_                    ;
+
+    // True if the worker thread publishes the result of the pending solve.
+    bool                     is_solve_publishing_                         ;
+
+  // --------------------------------------------------------
+  // Stats (min/max etc) for the current sheet, from the solver
+  private:
+    // Empty unless the current sheet came straight from a solve that gathered stats.
+    sheet_stats_type         current_sheet_stats_                         ;
 
   // --------------------------------------------------------
   // Requests
   private:
-    // Requests to change sheet values are not honored until pending solve is complete.
-    // Improve: Requests should be kept in a queue.
-    // Improve: Requests should be honored in the worker thread, parallel if possible.
-    //   The UI thread should probably never change sheet values and only access them
-    //   in order to draw them.
-    bool                     is_requested_scale_sheet_                    ;
-    float                    requested_values_scale_                      ;
-    float                    requested_momentum_scale_                    ;
-
-    bool                     is_requested_ramp_corner_to_corner_          ;
-    bool                     is_requested_ramp_2_corners_                 ;
-    bool                     is_requested_ramp_4_corners_                 ;
-    bool                     is_requested_bell_corner_1_                  ;
-    bool                     is_requested_bell_corner_2_                  ;
-    bool                     is_requested_bell_corner_3_                  ;
-    bool                     is_requested_bell_corner_4_                  ;
-    bool                     is_requested_raindrop_up_                    ;
-    bool                     is_requested_raindrop_down_                  ;
-    bool                     is_requested_bell_curve_1_                   ;
-    bool                     is_requested_bell_curve_2_                   ;
-    bool                     is_requested_bell_curve_4_                   ;
-    bool                     is_requested_sin_over_dist_1_                ;
-    bool                     is_requested_sin_over_dist_2_                ;
-    bool                     is_requested_sin_over_dist_4_                ;
-    bool                     is_requested_delta_                          ;
-    bool                     is_requested_stair_steps_                    ;
-    bool                     is_requested_reverse_wave_                   ;
-    bool                     is_requested_set_init_test_                  ;
-    bool                     is_requested_set_sheet_random_noise_         ;
-    bool                     is_requested_normalize_sheet_                ;
-
-    bool                     is_requested_set_xy_sizes_                   ;
-    bool                     is_requested_set_xy_sizes_with_value_        ;
-    size_type                requested_set_xy_sizes_x_                    ;
-    size_type                requested_set_xy_sizes_y_                    ;
-    value_type               requested_set_xy_sizes_value_                ;
+    // Requests to change sheet values are not honored until the pending solve or transform is
+    // complete. Until then they wait in a list, and are honored oldest first between generations.
+    // Requests are posted and honored in the UI thread, so the lists need no locking.
+    // Most of the sheet transforms run in the worker thread, one generation at a time, and the
+    // rest of the list waits for them.
+    // Improve: The ramps, stair steps, random noise, and size changes still change the sheet in
+    //   the UI thread. The UI thread should probably never change sheet values and only access
+    //   them in order to draw them.
+    enum            e_request_kind_type
+                     {  e_request_scale_sheet
+                      , e_request_set_xy_sizes
+                      , e_request_set_xy_sizes_with_value
+                      , e_request_ramp_corner_to_corner
+                      , e_request_ramp_2_corners
+                      , e_request_ramp_4_corners
+                      , e_request_bell_corner_1
+                      , e_request_bell_corner_2
+                      , e_request_bell_corner_3
+                      , e_request_bell_corner_4
+                      , e_request_raindrop_up
+                      , e_request_raindrop_down
+                      , e_request_bell_curve_1
+                      , e_request_bell_curve_2
+                      , e_request_bell_curve_4
+                      , e_request_sin_over_dist_1
+                      , e_request_sin_over_dist_2
+                      , e_request_sin_over_dist_4
+                      , e_request_delta
+                      , e_request_stair_steps
+                      , e_request_reverse_wave
+                      , e_request_set_init_test
+                      , e_request_set_sheet_random_noise
+                      , e_request_normalize_sheet
+                     }                                        ;
+
+    // A request and its params. Only the params for the kind of request are meaningful.
+    struct          request_type
+                     {  e_request_kind_type     kind            ;
+                        float                   values_scale    ; /* scale_sheet */
+                        float                   momentum_scale  ;
+                        size_type               x_size          ; /* set_xy_sizes */
+                        size_type               y_size          ;
+                        value_type              init_value      ;
+                     }                                        ;
+
+    typedef std::vector< request_type >  request_list_type ;
+
+    void            post_or_honor_request( e_request_kind_type)  ;
+    void            post_or_honor_request( request_type const &) ;
+    bool            honor_request( request_type const &)         ;
+    void            defer_request( request_type const &)         ;
+    static bool     is_repeat_of_idempotent_request( request_type const &, request_type const &) ;
+
+    // Posted while a solve or transform is pending, oldest first.
+    request_list_type        posted_requests_                             ;
+
+    // Requests that could not be honored yet, like reversing a wave before there is one.
+    // Oldest first. Repeats are merged or cancelled (see defer_request(..)). These do not hold up
+    // a free run.
+    request_list_type        deferred_requests_                           ;
 
 }; /* end class sheet_control_type */
 
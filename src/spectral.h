@@ -0,0 +1,554 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// spectral.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef SPECTRAL_H
+# define SPECTRAL_H
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// 2D cosine transform (DCT-II) of a sheet, for jumping the heat solve many generations at once.
+//
+//   The sheets have insulated edges (an edge cell's missing neighbor is the cell itself). With
+//   those edges the cosine vectors
+//
+//     cos( pi * k * (x + 1/2) / n)     k = 0, 1, .. n-1
+//
+//   are the eigenvectors of the 1D second-difference operator, with eigenvalues
+//
+//     -(2 - 2 cos( pi * k / n))
+//
+//   So every generation of a (forward, backward or central diff) heat solve just scales each
+//   2D cosine mode by its own gain, and N generations scale it by gain^N. We transform the
+//   sheet once, scale the modes, and transform back.
+//
+//   Each 1D transform is done with an FFT of the same length (see dct_plan_type), so a sheet
+//   costs O(x*y*log(x*y)) for any size, and the cost does not depend on how many generations we
+//   jump. Both passes work on whole rows or columns, so they are mapped thru the row pool like
+//   the solvers.
+//
+//   SHEET_TYPE is sheet_type (float) or value_sheet_type< double >.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <vector>
+# include <complex>
+# include <algorithm>
+# include <cmath>
+# include "debug.h"
+# include "row_pool.h"
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+namespace spectral {
+
+typedef std::pair< std::size_t, std::size_t >  row_group_type ; /* [lo, hi_plus) */
+
+inline double   get_pi( )                               { return 3.14159265358979323846; }
+
+// _______________________________________________________________________________________________
+// dct_plan_type
+//
+//   Orthonormal DCT-II (forward) and DCT-III (inverse, the transpose) of length n:
+//     forward: trg[ k ] = s(k) * sum_x cos( pi * k * (x + 1/2) / n) * src[ x ]
+//     inverse: trg[ x ] = sum_k s(k) * cos( pi * k * (x + 1/2) / n) * src[ k ]
+//   where s(0) = sqrt( 1/n) and s(k) = sqrt( 2/n).
+//
+//   The DCT is a length-n FFT of the values reordered evens-up, odds-down, times a twiddle
+//   (Makhoul 1980). A power-of-2 n uses a radix-2 FFT. Any other n uses the chirp-z (Bluestein)
+//   form, which is a convolution done with radix-2 FFTs of length m >= 2n-1. Either way the
+//   transform is O(n log n). We work in double even for float sheets.
+//
+//   The plan is read-only once it's set up, so threads can share it. Each thread passes its
+//   own scratch, get_scratch_size( ) complex values.
+
+  class
+dct_plan_type
+{
+  public:
+    typedef std::complex< double >  complex_type ;
+
+    /* ctor */  dct_plan_type( )                        : n_( 0), m_( 0), twiddles_( ), roots_( )
+                                                        , chirps_( ), chirp_ffts_( )
+                                                        { }
+
+    void        set_up( std::size_t n)                  ;
+    std::size_t get_n( )                          const { return n_; }
+    std::size_t get_scratch_size( )               const { return m_; }
+
+    // In place on n values.
+    void        forward( double * p_values, complex_type * p_scratch)
+                                                  const ;
+    void        inverse( double * p_values, complex_type * p_scratch)
+                                                  const ;
+
+  protected:
+    void        fft( complex_type * p_values)     const ;
+    void        fft_pow2( complex_type * p_values)
+                                                  const ;
+
+  private:
+    std::size_t                  n_           ;
+    std::size_t                  m_           ; /* n_ if it's a power of 2, else the Bluestein length */
+    std::vector< complex_type >  twiddles_    ; /* n_ of them, exp( -i*pi*k / 2n) */
+    std::vector< complex_type >  roots_       ; /* m_/2 of them, exp( -2i*pi*j / m) */
+    std::vector< complex_type >  chirps_      ; /* Bluestein only, exp( -i*pi*j*j / n) */
+    std::vector< complex_type >  chirp_ffts_  ; /* Bluestein only, fft of the conjugate chirps */
+};
+
+// _______________________________________________________________________________________________
+
+  inline
+  void
+  dct_plan_type::
+set_up( std::size_t n)
+{
+    if ( n == n_ ) return;
+    d_assert( n > 0);
+    n_ = n;
+
+    m_ = 1;
+    while ( m_ < n_ ) m_ *= 2;
+    bool const is_pow2 = (m_ == n_);
+    if ( ! is_pow2 ) {
+        while ( m_ < ((2 * n_) - 1) ) m_ *= 2;
+    }
+
+    twiddles_.resize( n_);
+    for ( std::size_t k = 0 ; k < n_ ; k += 1 ) {
+        twiddles_[ k ] = std::polar( 1.0, (- get_pi( ) * k) / (2 * n_));
+    }
+    roots_.resize( m_ / 2);
+    for ( std::size_t j = 0 ; j < (m_ / 2) ; j += 1 ) {
+        roots_[ j ] = std::polar( 1.0, (-2 * get_pi( ) * j) / m_);
+    }
+
+    if ( is_pow2 ) {
+        std::vector< complex_type >( ).swap( chirps_    );
+        std::vector< complex_type >( ).swap( chirp_ffts_);
+    } else {
+        // j*j gets big, so we keep it mod 2n. The angle repeats every 2n.
+        chirps_.resize( n_);
+        for ( std::size_t j = 0, jj = 0 ; j < n_ ; jj = (jj + (2 * j) + 1) % (2 * n_), j += 1 ) {
+            chirps_[ j ] = std::polar( 1.0, (- get_pi( ) * jj) / n_);
+        }
+        chirp_ffts_.assign( m_, complex_type( 0));
+        chirp_ffts_[ 0 ] = std::conj( chirps_[ 0 ]);
+        for ( std::size_t j = 1 ; j < n_ ; j += 1 ) {
+            chirp_ffts_[ j ] = chirp_ffts_[ m_ - j ] = std::conj( chirps_[ j ]);
+        }
+        fft_pow2( & chirp_ffts_[ 0 ]);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  inline
+  void
+  dct_plan_type::
+forward( double * p_values, complex_type * p_scratch) const
+{
+    d_assert( n_ > 0);
+    for ( std::size_t j = 0 ; (2 * j) < n_ ; j += 1 ) {
+        p_scratch[ j ] = p_values[ 2 * j ];
+    }
+    for ( std::size_t j = 0 ; ((2 * j) + 1) < n_ ; j += 1 ) {
+        p_scratch[ n_ - 1 - j ] = p_values[ (2 * j) + 1 ];
+    }
+
+    fft( p_scratch);
+
+    double const  scale_0  = std::sqrt( 1.0 / n_);
+    double const  scale_k  = std::sqrt( 2.0 / n_);
+    for ( std::size_t k = 0 ; k < n_ ; k += 1 ) {
+        p_values[ k ] = ((k == 0) ? scale_0 : scale_k) * std::real( twiddles_[ k ] * p_scratch[ k ]);
+    }
+}
+
+  inline
+  void
+  dct_plan_type::
+inverse( double * p_values, complex_type * p_scratch) const
+  //
+  // Undoes forward(..). If C is the unscaled DCT-II of v (the reordered values), then the FFT of
+  // v is conj( twiddle[ k ]) * (C[ k ] - i*C[ n-k ]), with C[ n ] = 0. We take the inverse FFT
+  // as conj( fft( conj( ..))) / n.
+{
+    d_assert( n_ > 0);
+    double const  scale_0  = std::sqrt( 1.0 / n_);
+    double const  scale_k  = std::sqrt( 0.5 / n_);
+    for ( std::size_t k = 0 ; k < n_ ; k += 1 ) {
+        double const  c_k      = ((k == 0) ? scale_0 : scale_k) * p_values[ k ];
+        double const  c_n_k    = (k == 0) ? 0 : (scale_k * p_values[ n_ - k ]);
+        p_scratch[ k ] = std::conj( std::conj( twiddles_[ k ]) * complex_type( c_k, - c_n_k));
+    }
+
+    fft( p_scratch);
+
+    for ( std::size_t j = 0 ; (2 * j) < n_ ; j += 1 ) {
+        p_values[ 2 * j ] = std::real( p_scratch[ j ]);
+    }
+    for ( std::size_t j = 0 ; ((2 * j) + 1) < n_ ; j += 1 ) {
+        p_values[ (2 * j) + 1 ] = std::real( p_scratch[ n_ - 1 - j ]);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  inline
+  void
+  dct_plan_type::
+fft( complex_type * p_values) const
+  //
+  // Length-n FFT of the first n values. p_values has room for m values.
+{
+    if ( chirps_.empty( ) ) {
+        fft_pow2( p_values);
+        return;
+    }
+
+    // fft[ k ] = chirp[ k ] * sum_j (values[ j ] * chirp[ j ]) * conj( chirp[ k-j ])
+    for ( std::size_t j = 0 ; j < n_ ; j += 1 ) {
+        p_values[ j ] *= chirps_[ j ];
+    }
+    std::fill( p_values + n_, p_values + m_, complex_type( 0));
+
+    // Convolve, with the inverse FFT as conj( fft( conj( ..))) / m.
+    fft_pow2( p_values);
+    for ( std::size_t j = 0 ; j < m_ ; j += 1 ) {
+        p_values[ j ] = std::conj( p_values[ j ] * chirp_ffts_[ j ]);
+    }
+    fft_pow2( p_values);
+
+    double const scale = 1.0 / m_;
+    for ( std::size_t k = 0 ; k < n_ ; k += 1 ) {
+        p_values[ k ] = chirps_[ k ] * std::conj( p_values[ k ]) * scale;
+    }
+}
+
+  inline
+  void
+  dct_plan_type::
+fft_pow2( complex_type * p_values) const
+  //
+  // In-place radix-2 FFT of length m.
+{
+    for ( std::size_t i = 1, j = 0 ; i < m_ ; i += 1 ) {
+        std::size_t bit = m_ >> 1;
+        for ( ; j & bit ; bit >>= 1 ) j ^= bit;
+        j ^= bit;
+        if ( i < j ) std::swap( p_values[ i ], p_values[ j ]);
+    }
+
+    for ( std::size_t len = 2 ; len <= m_ ; len *= 2 ) {
+        std::size_t const  half  = len / 2;
+        std::size_t const  step  = m_ / len;
+        for ( std::size_t lo = 0 ; lo < m_ ; lo += len ) {
+            for ( std::size_t j = 0 ; j < half ; j += 1 ) {
+                complex_type const  a  = p_values[ lo + j ];
+                complex_type const  b  = p_values[ lo + j + half ] * roots_[ j * step ];
+                p_values[ lo + j        ] = a + b;
+                p_values[ lo + j + half ] = a - b;
+            }
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+// transform_rows_functor_type< VALUE_TYPE >
+//
+//   Transforms each row in a group with the x plan. src and trg can be the same.
+
+  template< typename VALUE_TYPE >
+  struct
+transform_rows_functor_type
+{
+    transform_rows_functor_type
+     (  dct_plan_type const &  plan
+      , VALUE_TYPE const    *  p_src
+      , VALUE_TYPE          *  p_trg
+      , bool        const      is_inverse
+     )
+      : plan_       ( plan       )
+      , p_src_      ( p_src      )
+      , p_trg_      ( p_trg      )
+      , is_inverse_ ( is_inverse )
+      { }
+      dct_plan_type     const &   plan_       ;
+      VALUE_TYPE const  *  const  p_src_      ;
+      VALUE_TYPE        *  const  p_trg_      ;
+      bool                 const  is_inverse_ ;
+
+      void
+    operator ()( row_group_type const & y_lo_hi_plus) const
+      {
+        std::size_t const  x_count  = plan_.get_n( );
+        std::vector< double >                        values  ( x_count);
+        std::vector< dct_plan_type::complex_type >   scratch ( plan_.get_scratch_size( ));
+        for ( std::size_t y = y_lo_hi_plus.first ; y < y_lo_hi_plus.second ; y += 1 ) {
+            std::copy( p_src_ + (y * x_count), p_src_ + ((y + 1) * x_count), values.begin( ));
+            if ( is_inverse_ ) {
+                plan_.inverse( & values[ 0 ], & scratch[ 0 ]);
+            } else {
+                plan_.forward( & values[ 0 ], & scratch[ 0 ]);
+            }
+            VALUE_TYPE * const  p_trg  = p_trg_ + (y * x_count);
+            for ( std::size_t x = 0 ; x < x_count ; x += 1 ) {
+                p_trg[ x ] = static_cast< VALUE_TYPE >( values[ x ]);
+            }
+        }
+      }
+};
+
+// _______________________________________________________________________________________________
+// transform_columns_functor_type< VALUE_TYPE >
+//
+//   Transforms each column in a group (of columns, not rows) with the y plan, in place. We copy
+//   a column out, transform it, and copy it back. Neighboring columns share cache lines, so the
+//   rows stay in cache across a group.
+
+  template< typename VALUE_TYPE >
+  struct
+transform_columns_functor_type
+{
+    transform_columns_functor_type
+     (  dct_plan_type const &  plan
+      , VALUE_TYPE          *  p_values
+      , std::size_t const      x_count
+      , bool        const      is_inverse
+     )
+      : plan_       ( plan       )
+      , p_values_   ( p_values   )
+      , x_count_    ( x_count    )
+      , is_inverse_ ( is_inverse )
+      { }
+      dct_plan_type     const &   plan_       ;
+      VALUE_TYPE        *  const  p_values_   ;
+      std::size_t          const  x_count_    ;
+      bool                 const  is_inverse_ ;
+
+      void
+    operator ()( row_group_type const & x_lo_hi_plus) const
+      {
+        std::size_t const  y_count  = plan_.get_n( );
+        std::vector< double >                        values  ( y_count);
+        std::vector< dct_plan_type::complex_type >   scratch ( plan_.get_scratch_size( ));
+        for ( std::size_t x = x_lo_hi_plus.first ; x < x_lo_hi_plus.second ; x += 1 ) {
+            VALUE_TYPE * const  p_column  = p_values_ + x;
+            for ( std::size_t y = 0 ; y < y_count ; y += 1 ) {
+                values[ y ] = p_column[ y * x_count_ ];
+            }
+            if ( is_inverse_ ) {
+                plan_.inverse( & values[ 0 ], & scratch[ 0 ]);
+            } else {
+                plan_.forward( & values[ 0 ], & scratch[ 0 ]);
+            }
+            for ( std::size_t y = 0 ; y < y_count ; y += 1 ) {
+                p_column[ y * x_count_ ] = static_cast< VALUE_TYPE >( values[ y ]);
+            }
+        }
+      }
+};
+
+// _______________________________________________________________________________________________
+// cosine_transform_type< SHEET_TYPE >
+//
+//   Usage:
+//     transform( src_sheet)  -- keeps the modes
+//     restore( gain, trg_sheet)  -- scales the modes by gain( x_eigen, y_eigen) and transforms back
+//
+//   restore(..) can be called more than once after transform(..), with different gains.
+//   The plans are kept until the sheet size changes.
+
+  template< typename SHEET_TYPE >
+  class
+cosine_transform_type
+{
+  // -------------------------------------------------------------------------------------------
+  public:
+    typedef SHEET_TYPE                          sheet_type ;
+    typedef typename sheet_type::value_type     value_type ;
+    typedef typename sheet_type::size_type      size_type  ;
+
+  // -------------------------------------------------------------------------------------------
+  public:
+    /* ctor */  cosine_transform_type( bool const & is_early_exit)
+                                                        : is_early_exit_( is_early_exit)
+                                                        , is_parallel_( false)
+                                                        , x_plan_( ), y_plan_( ), x_eigens_( ), y_eigens_( )
+                                                        , modes_( ), work_( )
+                                                        { }
+
+    void        clear( )                                ;
+
+    void        transform( bool is_parallel, sheet_type const & src_sheet)
+                                                        ;
+      template< typename GAIN_FUNCTOR_TYPE >
+    void        restore( GAIN_FUNCTOR_TYPE const & gain, sheet_type & trg_sheet)
+                                                        ;
+
+    // Eigenvalue of the 1D second difference (sign flipped, so it's >= 0) for mode k of n.
+    static value_type
+                get_eigen( size_type k, size_type n)    { return value_type( 2 - (2 * std::cos( (k * get_pi( )) / n))); }
+
+  // -------------------------------------------------------------------------------------------
+  protected:
+    static void set_up_plan( dct_plan_type & plan, std::vector< value_type > & eigens, size_type n)
+                                                        ;
+      template< typename FUNCTOR_TYPE >
+    void        map_rows( FUNCTOR_TYPE const &, size_type row_count, size_type row_byte_count)
+                                                  const ;
+
+    static value_type const *
+                get_ptr( sheet_type const & s)          { return & (* s.begin( )); }
+    static value_type *
+                get_ptr( sheet_type & s)                { return & (* s.begin( )); }
+
+  // -------------------------------------------------------------------------------------------
+  private:
+    bool const &                is_early_exit_  ;
+    bool                        is_parallel_    ;
+    dct_plan_type               x_plan_         ;
+    dct_plan_type               y_plan_         ;
+    std::vector< value_type >   x_eigens_       ;
+    std::vector< value_type >   y_eigens_       ;
+    sheet_type                  modes_          ;
+    sheet_type                  work_           ;
+};
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+  cosine_transform_type< SHEET_TYPE >::
+clear( )
+{
+    x_plan_ = dct_plan_type( );
+    y_plan_ = dct_plan_type( );
+    std::vector< value_type >( ).swap( x_eigens_);
+    std::vector< value_type >( ).swap( y_eigens_);
+    modes_.reset( );
+    work_ .reset( );
+}
+
+  /* static */
+  template< typename SHEET_TYPE >
+  void
+  cosine_transform_type< SHEET_TYPE >::
+set_up_plan( dct_plan_type & plan, std::vector< value_type > & eigens, size_type n)
+{
+    if ( eigens.size( ) == n ) return;
+
+    plan.set_up( n);
+    eigens.resize( n);
+    for ( size_type k = 0 ; k < n ; k += 1 ) {
+        eigens[ k ] = get_eigen( k, n);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+  cosine_transform_type< SHEET_TYPE >::
+transform( bool is_parallel, sheet_type const & src_sheet)
+{
+    if ( src_sheet.is_reset( ) || is_early_exit_ ) return;
+    is_parallel_ = is_parallel;
+
+    size_type const  x_count  = src_sheet.get_x_count( );
+    size_type const  y_count  = src_sheet.get_y_count( );
+    set_up_plan( x_plan_, x_eigens_, x_count);
+    set_up_plan( y_plan_, y_eigens_, y_count);
+    d_verify( modes_.set_xy_counts( x_count, y_count, 0));
+    d_verify( work_ .set_xy_counts( x_count, y_count, 0));
+
+    map_rows
+     (  transform_rows_functor_type< value_type >
+         ( x_plan_, get_ptr( src_sheet), get_ptr( modes_), false)
+      , y_count, x_count * sizeof( value_type)
+     );
+    if ( is_early_exit_ ) return;
+    map_rows
+     (  transform_columns_functor_type< value_type >
+         ( y_plan_, get_ptr( modes_), x_count, false)
+      , x_count, y_count * sizeof( value_type)
+     );
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  template< typename GAIN_FUNCTOR_TYPE >
+  void
+  cosine_transform_type< SHEET_TYPE >::
+restore( GAIN_FUNCTOR_TYPE const & gain, sheet_type & trg_sheet)
+{
+    if ( modes_.is_reset( ) || is_early_exit_ ) return;
+
+    size_type const  x_count  = modes_.get_x_count( );
+    size_type const  y_count  = modes_.get_y_count( );
+    d_assert( (x_count == trg_sheet.get_x_count( )) && (y_count == trg_sheet.get_y_count( )));
+
+    // Scale the modes. The gain usually needs a pow(..), so this is not trivial, but it is
+    // small next to the transforms.
+    for ( size_type ky = 0 ; ky < y_count ; ky += 1 ) {
+        value_type const * const  p_mode  = get_ptr( modes_ ) + (ky * x_count);
+        value_type       * const  p_work  = get_ptr( work_ ) + (ky * x_count);
+        for ( size_type kx = 0 ; kx < x_count ; kx += 1 ) {
+            p_work[ kx ] = p_mode[ kx ] * gain( x_eigens_[ kx ], y_eigens_[ ky ]);
+        }
+    }
+
+    if ( is_early_exit_ ) return;
+    map_rows
+     (  transform_columns_functor_type< value_type >
+         ( y_plan_, get_ptr( work_), x_count, true)
+      , x_count, y_count * sizeof( value_type)
+     );
+    if ( is_early_exit_ ) return;
+    map_rows
+     (  transform_rows_functor_type< value_type >
+         ( x_plan_, get_ptr( work_), get_ptr( trg_sheet), true)
+      , y_count, x_count * sizeof( value_type)
+     );
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  template< typename FUNCTOR_TYPE >
+  void
+  cosine_transform_type< SHEET_TYPE >::
+map_rows( FUNCTOR_TYPE const & functor, size_type row_count, size_type row_byte_count) const
+  // A "row" is a row or a column here, and row_byte_count is what it reads. Small sheets are not
+  // worth splitting.
+{
+    row_pool::map_row_ranges( functor, row_count, row_byte_count, is_parallel_ && (row_count >= 16));
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+} /* end namespace spectral */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef SPECTRAL_H
+//
+// spectral.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
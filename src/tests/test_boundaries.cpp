@@ -0,0 +1,322 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_boundaries.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the edge boundaries built into the 2d forward-diff solve.
+//
+// Each stencil and boundary, for heat and for the damped wave, is checked against a plain
+// double-precision solve that looks up the cells past the edges directly:
+//   insulated  -- mirror (the cell just outside an edge is the cell just inside it)
+//   fixed      -- mirror, then the edge cells keep their old values
+//   periodic   -- wrap (4th-order rows shorter than 4 cells keep mirrored ends)
+//   absorbing  -- mirror, with damping ramped up to 1 in a layer along the edges
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <vector>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+// _______________________________________________________________________________________________
+
+  long
+get_wrap_index( long index, long count)
+{
+    index %= count;
+    return (index < 0) ? (index + count) : index;
+}
+
+  double
+get_layer_damping( double damping, long dist_to_edge, long count)
+  //
+  // The absorbing layer is up to 16 cells wide (a quarter of the sheet at most), and ramps the
+  // damping up to 1 at the edge.
+{
+    long const  width  = std::min( 16L, count / 4);
+    if ( dist_to_edge >= width ) return damping;
+    double const  ramp  = double( width - dist_to_edge) / width;
+    return damping + ((1 - damping) * ramp * ramp);
+}
+
+  struct
+solve_case_type
+{
+    method_type     method     ;
+    boundary_type   boundary   ;
+    long            x_count    ;
+    long            y_count    ;
+    float           rate_x     ; /* float like the input params, so the reference uses the same rates */
+    float           rate_y     ;
+    float           damping    ; /* 1 means heat, the rest are waves */
+};
+
+  void
+calc_reference
+ (  solve_case_type const &        solve_case
+  , std::vector< double > const &  src
+  , std::vector< double > const &  old        // the generation before src, for the wave
+  , std::vector< double >       &  trg        // out
+ )
+{
+    long const  x_count  = solve_case.x_count;
+    long const  y_count  = solve_case.y_count;
+    double const  rate_x  = solve_case.rate_x;
+    double const  rate_y  = solve_case.rate_y;
+    bool const  is_periodic  = (e_boundary_periodic == solve_case.boundary);
+    bool const  is_wrap_x    = is_periodic && ((e_forward_diff_4th_order != solve_case.method) || (x_count >= 4));
+    bool const  is_wrap_y    = is_periodic;
+
+    trg.resize( src.size( ));
+    for ( long y = 0 ; y < y_count ; ++ y ) {
+        for ( long x = 0 ; x < x_count ; ++ x ) {
+# define CELL( X, Y) src[ ((is_wrap_y ? get_wrap_index( (Y), y_count) : test::get_mirror_index( (Y), y_count)) * x_count) + \
+                          (is_wrap_x ? get_wrap_index( (X), x_count) : test::get_mirror_index( (X), x_count)) ]
+            double const  center  = CELL( x, y);
+            double value = 0;
+            if ( e_forward_diff == solve_case.method ) {
+                value = center +
+                    (rate_x * (CELL( x - 1, y) + CELL( x + 1, y) - (2 * center))) +
+                    (rate_y * (CELL( x, y - 1) + CELL( x, y + 1) - (2 * center)));
+            } else
+            if ( e_forward_diff_9_point == solve_case.method ) {
+                double const  dxx  = CELL( x - 1, y) + CELL( x + 1, y) - (2 * center);
+                double const  dyy  = CELL( x, y - 1) + CELL( x, y + 1) - (2 * center);
+                double const  dxy  =
+                    (CELL( x - 1, y - 1) + CELL( x + 1, y - 1) + CELL( x - 1, y + 1) + CELL( x + 1, y + 1)) -
+                    (2 * (CELL( x, y - 1) + CELL( x, y + 1) + CELL( x - 1, y) + CELL( x + 1, y))) +
+                    (4 * center);
+                value = center + (rate_x * dxx) + (rate_y * dyy) + (((rate_x + rate_y) / 12) * dxy);
+            } else {
+                double const  dx  = (16 * (CELL( x - 1, y) + CELL( x + 1, y))) - (CELL( x - 2, y) + CELL( x + 2, y)) - (30 * center);
+                double const  dy  = (16 * (CELL( x, y - 1) + CELL( x, y + 1))) - (CELL( x, y - 2) + CELL( x, y + 2)) - (30 * center);
+                value = center + ((rate_x / 12) * dx) + ((rate_y / 12) * dy);
+            }
+# undef CELL
+            double damping = solve_case.damping;
+            if ( e_boundary_absorbing == solve_case.boundary ) {
+                damping =
+                    std::max
+                     (  get_layer_damping( solve_case.damping, std::min( x, x_count - 1 - x), x_count)
+                      , get_layer_damping( solve_case.damping, std::min( y, y_count - 1 - y), y_count)
+                     );
+            }
+            value += (1 - damping) * (center - old[ (y * x_count) + x ]);
+
+            // Fixed edges only on sides with a middle.
+            if ( (e_boundary_fixed == solve_case.boundary) &&
+                 (((y_count > 2) && ((0 == y) || ((y_count - 1) == y))) ||
+                  ((x_count > 2) && ((0 == x) || ((x_count - 1) == x)))) )
+            {
+                value = center;
+            }
+            trg[ (y * x_count) + x ] = value;
+        }
+    }
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  bool
+check_against_reference( solve_case_type const & solve_case, bool is_parallel, double tolerance)
+  //
+  // One pass against the reference. Heat with insulated or periodic edges keeps its total.
+{
+    bool const  is_wave  = (1 != solve_case.damping);
+
+    settable_input_params_type input_params;
+    input_params.set_technique( is_wave ? e_wave_with_damping : e_simultaneous_2d);
+    input_params.set_method( solve_case.method);
+    input_params.set_boundary( solve_case.boundary);
+    input_params.set_rate_x( solve_case.rate_x);
+    input_params.set_rate_y( solve_case.rate_y);
+    input_params.set_damping( solve_case.damping);
+    input_params.set__is_method_parallel( is_parallel);
+
+    // The wave reads the generation before src from trg.
+    SHEET_TYPE src;
+    d_verify( src.set_xy_counts( solve_case.x_count, solve_case.y_count, 0));
+    SHEET_TYPE trg;
+    d_verify( trg.set_xy_counts( solve_case.x_count, solve_case.y_count, 0));
+    for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+        src.begin( )[ index ] = test::get_init_value< float >( index);
+        trg.begin( )[ index ] = static_cast< float >( 0.5 * std::cos( index * 0.13));
+    }
+    std::vector< double > const  src_values( src.begin( ), src.end( ));
+    std::vector< double > const  old_values( is_wave ? std::vector< double >( trg.begin( ), trg.end( )) : src_values);
+
+    SHEET_TYPE extra;
+    SOLVER_TYPE solver;
+    solver.calc_next( input_params, typename SOLVER_TYPE::sheet_params_type( src, trg, extra, 0, 0));
+
+    std::vector< double > expected;
+    calc_reference( solve_case, src_values, old_values, expected);
+    double max_error  = 0;
+    double src_sum    = 0;
+    double trg_sum    = 0;
+    for ( std::size_t index = 0 ; index < expected.size( ) ; ++ index ) {
+        max_error = std::max( max_error, std::fabs( expected[ index ] - trg.begin( )[ index ]));
+        src_sum += src_values[ index ];
+        trg_sum += trg.begin( )[ index ];
+    }
+    bool const  is_conserved  =
+        is_wave ||
+        (e_boundary_fixed == solve_case.boundary) ||
+        (std::fabs( trg_sum - src_sum) < (1e-4 + (tolerance * expected.size( ))));
+    return (max_error < tolerance) && is_conserved;
+}
+
+  double
+get_wave_energy_left( boundary_type boundary)
+  //
+  // A pulse in the middle of an undamped wave, after its front has reached the edges and had
+  // time to come back. Returns the sum of squares left, as a fraction of the start.
+{
+    long const  count  = 160;
+    settable_input_params_type input_params;
+    input_params.set_technique( e_wave_with_damping);
+    input_params.set_method( e_forward_diff);
+    input_params.set_boundary( boundary);
+    input_params.set_rate_x( 0.2f);
+    input_params.set_rate_y( 0.2f);
+    input_params.set_damping( 0);
+
+    sheet_type sheet_a;
+    d_verify( sheet_a.set_xy_counts( count, count, 0));
+    double init_energy = 0;
+    for ( long y = 0 ; y < count ; ++ y ) {
+        for ( long x = 0 ; x < count ; ++ x ) {
+            double const  dist_2  = ((x - 80) * (x - 80)) + ((y - 80) * (y - 80));
+            float const   value   = static_cast< float >( std::exp( - dist_2 / 20));
+            sheet_a.begin( )[ (y * count) + x ] = value;
+            init_energy += value * value;
+        }
+    }
+    sheet_type sheet_b;
+    sheet_b = sheet_a;
+    sheet_type extra;
+    solver_type solver;
+    sheet_type * p_src = & sheet_a;
+    sheet_type * p_trg = & sheet_b;
+    for ( int generation = 0 ; generation < 600 ; ++ generation ) {
+        solver.calc_next( input_params, sheet_params_type( *p_src, *p_trg, extra, 0, 0));
+        std::swap( p_src, p_trg);
+    }
+    double energy = 0;
+    for ( size_type index = 0 ; index < p_src->get_xy_count( ) ; ++ index ) {
+        energy += p_src->begin( )[ index ] * p_src->begin( )[ index ];
+    }
+    return energy / init_energy;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_boundaries_match_reference( )
+  //
+  // Every stencil and boundary, heat and wave, float and double, serial and parallel, on sheets
+  // from big to 1x1.
+{
+    long const  sizes[ ][ 2 ] =
+     { { 157, 93 }, { 1, 1 }, { 2, 3 }, { 3, 2 }, { 2, 2 }, { 3, 3 }, { 5, 7 }, { 1, 9 }, { 9, 1 }, { 4, 4 }, { 64, 5 }, { 40, 70 } };
+    method_type const  methods[ ] = { e_forward_diff, e_forward_diff_9_point, e_forward_diff_4th_order };
+    float const        rates_x[ ] = { 0.2f , 0.3f , 0.2f };
+    float const        rates_y[ ] = { 0.25f, 0.25f, 0.1f };
+    boundary_type const  boundaries[ ] = { e_boundary_insulated, e_boundary_fixed, e_boundary_periodic, e_boundary_absorbing };
+
+    for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+      for ( std::size_t m = 0 ; m < (sizeof( methods) / sizeof( methods[ 0 ])) ; ++ m ) {
+        for ( std::size_t b = 0 ; b < (sizeof( boundaries) / sizeof( boundaries[ 0 ])) ; ++ b ) {
+          for ( std::size_t s = 0 ; s < (sizeof( sizes) / sizeof( sizes[ 0 ])) ; ++ s ) {
+            for ( int is_wave = 0 ; is_wave < 2 ; ++ is_wave ) {
+                // Absorbing edges are insulated for heat (see get_solved_boundary(..)).
+                if ( (e_boundary_absorbing == boundaries[ b ]) && ! is_wave ) continue;
+
+                solve_case_type solve_case =
+                 {  methods[ m ], boundaries[ b ], sizes[ s ][ 0 ], sizes[ s ][ 1 ]
+                  , rates_x[ m ], rates_y[ m ], is_wave ? 0.05f : 1.0f
+                 };
+                bool const  is_float_ok  =
+                    check_against_reference< sheet_type, solver_type >( solve_case, 0 != is_parallel, 3e-6);
+                solve_case.damping = is_wave ? 0.3f : 1.0f;
+                bool const  is_double_ok  =
+                    check_against_reference< double_sheet_type, double_solver_type >( solve_case, 0 != is_parallel, 1e-12);
+                if ( ! test_check( is_float_ok && is_double_ok) ) {
+                    std::fprintf( stderr, "  method %d, boundary %d, %ldx%ld, %s, %s\n",
+                        static_cast< int >( methods[ m ]), static_cast< int >( boundaries[ b ]),
+                        sizes[ s ][ 0 ], sizes[ s ][ 1 ], is_wave ? "wave" : "heat",
+                        is_parallel ? "parallel" : "serial");
+                }
+            }
+          }
+        }
+      }
+    }
+}
+
+  void
+test_absorbing_edges( )
+  //
+  // An undamped wave keeps its energy with insulated or periodic edges, and loses most of it
+  // into an absorbing layer. About half the energy is in motion at any time, so the sum of
+  // squares does not stay at 1.
+{
+    double const  insulated_left  = get_wave_energy_left( e_boundary_insulated);
+    double const  periodic_left   = get_wave_energy_left( e_boundary_periodic );
+    double const  absorbing_left  = get_wave_energy_left( e_boundary_absorbing);
+    test_check( insulated_left > 0.25);
+    test_check( periodic_left  > 0.25);
+    test_check( absorbing_left < (insulated_left / 10));
+}
+
+  void
+test_solved_boundary( )
+  //
+  // Only the 2d forward-diff solves have the boundaries built in, and absorbing is only for
+  // waves.
+{
+    test_check( e_boundary_fixed     == get_solved_boundary( e_simultaneous_2d   , e_forward_diff          , e_boundary_fixed    ));
+    test_check( e_boundary_periodic  == get_solved_boundary( e_simultaneous_2d   , e_forward_diff_4th_order, e_boundary_periodic ));
+    test_check( e_boundary_insulated == get_solved_boundary( e_simultaneous_2d   , e_forward_diff          , e_boundary_absorbing));
+    test_check( e_boundary_absorbing == get_solved_boundary( e_wave_with_damping , e_forward_diff_9_point  , e_boundary_absorbing));
+    test_check( e_boundary_insulated == get_solved_boundary( e_simultaneous_2d   , e_backward_diff         , e_boundary_fixed    ));
+    test_check( e_boundary_insulated == get_solved_boundary( e_ortho_interleave  , e_forward_diff          , e_boundary_periodic ));
+    test_check( e_boundary_insulated == get_solved_boundary( e_spectral_jump     , e_forward_diff          , e_boundary_fixed    ));
+    test_check( e_boundary_periodic  == get_solved_boundary( e_super_time_step   , e_forward_diff          , e_boundary_periodic ));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_match_reference(  "boundaries_match_reference", & test_boundaries_match_reference);
+test::registrar_type const  register_absorbing(        "absorbing_edges"           , & test_absorbing_edges           );
+test::registrar_type const  register_solved(           "solved_boundary"           , & test_solved_boundary           );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_boundaries.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
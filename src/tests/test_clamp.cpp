@@ -0,0 +1,252 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_clamp.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the out-of-bounds clamp.
+//
+// The forward-diff kernels clamp each value as they store it (assign3_clamp_type<..> in
+// finite_diff.h, and the same min/max in the vector kernels). That must give the same bits as
+// solving without the clamp and clamping afterwards. The other solves clamp in a row pass after
+// they solve.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <cstdio>
+# include <limits>
+# include <vector>
+# include "heat_solver.h"
+# include "cpu_features.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+float const  g_limit  = 100;
+
+// _______________________________________________________________________________________________
+
+// Big enough that a third of the results are past the limit.
+double const  g_init_amplitude  = 300;
+
+  float
+clamp( float value)
+  //
+  // Same tests in the same order as the kernels, so a NaN becomes +limit.
+{
+    value = (value < g_limit) ? value : g_limit;
+    value = (value > - g_limit) ? value : - g_limit;
+    return value;
+}
+
+  void
+clamp_all( std::vector< float > & values)
+{
+    for ( std::size_t index = 0 ; index < values.size( ) ; ++ index ) {
+        values[ index ] = clamp( values[ index ]);
+    }
+}
+
+  void
+solve_rows
+ (  float                   damping
+  , float                   clamp_limit
+  , std::vector< float > &  values       // return value, the solved rows end to end
+ )
+  //
+  // A middle row, an edge row and a thin strip, each from the same sources. The sources have a
+  // NaN, and the rows are an odd length so the vector kernels have tails.
+{
+    int const  count  = 37;
+    std::vector< float > src( count), side_a( count), side_b( count), trg( count);
+    for ( int index = 0 ; index < count ; ++ index ) {
+        src   [ index ] = test::get_init_value< float >( index, g_init_amplitude);
+        side_a[ index ] = test::get_init_value< float >( index + 50, g_init_amplitude);
+        side_b[ index ] = test::get_init_value< float >( index + 100, g_init_amplitude);
+    }
+    src[ 11 ] = std::numeric_limits< float >::quiet_NaN( );
+
+    values.clear( );
+    for ( int row = 0 ; row < 3 ; ++ row ) {
+        // Some dampings use the old trg values.
+        for ( int index = 0 ; index < count ; ++ index ) { trg[ index ] = test::get_init_value< float >( index + 7, g_init_amplitude); }
+        if ( 0 == row ) {
+            finite_difference::calc_next_generation_forward_difference_2d_middle
+             (  damping, 0.4f, 0.3f
+              , src.begin( ), src.end( ), side_a.begin( ), side_b.begin( )
+              , trg.begin( ), clamp_limit
+             );
+        } else
+        if ( 1 == row ) {
+            finite_difference::calc_next_generation_forward_difference_2d_edge
+             (  damping, 0.4f, 0.3f
+              , src.begin( ), src.end( ), side_a.begin( )
+              , trg.begin( ), clamp_limit
+             );
+        } else {
+            finite_difference::calc_next_generation_forward_difference_2d_thin_strip
+             (  damping, 0.4f
+              , src.begin( ), src.end( )
+              , trg.begin( ), clamp_limit
+             );
+        }
+        values.insert( values.end( ), trg.begin( ), trg.end( ));
+    }
+}
+
+  void
+solve_sheet
+ (  settable_input_params_type const &  input_params
+  , sheet_type                       &  trg            // out
+ )
+{
+    size_type const  x_count  = 157;
+    size_type const  y_count  =  93;
+    sheet_type src;
+    d_verify( src.set_xy_counts( x_count, y_count, 0));
+    for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+        src.begin( )[ index ] = test::get_init_value< float >( index, g_init_amplitude);
+    }
+    trg = src;
+    sheet_type extra;
+    extra = src;
+    solver_type solver;
+    solver.calc_next( input_params, sheet_params_type( src, trg, extra, 0, 0));
+}
+
+  bool
+is_inside_limit( sheet_type const & sheet, bool & is_at_limit)
+{
+    is_at_limit = false;
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        float const  value  = sheet.begin( )[ index ];
+        if ( ! ((value >= - g_limit) && (value <= g_limit)) ) return false;
+        if ( (value == g_limit) || (value == - g_limit) ) { is_at_limit = true; }
+    }
+    return true;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_clamp_functor( )
+{
+    finite_difference::assign3_clamp_type< finite_difference::assign3_set_type< float >, float > const
+        clamp_set( finite_difference::assign3_set_type< float >( ), g_limit);
+    float const  sides[ ] = { 5.0f, -99.5f, 150.0f, -150.0f, std::numeric_limits< float >::quiet_NaN( ) };
+    float const  wants[ ] = { 5.0f, -99.5f, 100.0f, -100.0f, 100.0f };
+    for ( std::size_t index = 0 ; index < (sizeof( sides) / sizeof( sides[ 0 ])) ; ++ index ) {
+        float trg = 0;
+        finite_difference::assign3_clamp_type< finite_difference::assign3_set_type< float >, float > functor = clamp_set;
+        functor( trg, 0.0f, sides[ index ]);
+        test_check( wants[ index ] == trg);
+    }
+}
+
+  void
+test_clamp_fused_in_kernels( )
+  //
+  // At each kernel level and damping, the clamp as we store is the same as clamping after.
+{
+    cpu_features::simd_level_type const  best_level  = cpu_features::get_simd_level( );
+    float const  dampings[ ] = { 1.0f, 0.0f, 0.3f };
+    for ( int level = cpu_features::e_scalar ; level <= best_level ; ++ level ) {
+        d_verify( finite_difference::simd::set_kernel_level( cpu_features::simd_level_type( level)));
+        for ( std::size_t index = 0 ; index < (sizeof( dampings) / sizeof( dampings[ 0 ])) ; ++ index ) {
+            std::vector< float >  after_values;
+            solve_rows( dampings[ index ], 0, after_values);
+            clamp_all( after_values);
+            std::vector< float >  fused_values;
+            solve_rows( dampings[ index ], g_limit, fused_values);
+            if ( ! test_check( test::is_same_bits( after_values, fused_values)) ) {
+                std::fprintf( stderr, "  damping %g, level %s\n", double( dampings[ index ]),
+                    cpu_features::get_simd_level_name( cpu_features::simd_level_type( level)));
+            }
+        }
+    }
+    d_verify( finite_difference::simd::set_kernel_level( best_level));
+}
+
+  void
+test_clamp_in_solver( )
+  //
+  // A wave with low damping and a heat solve with a negative rate are clamped, fused into the
+  // kernel and after the solve. Pools give the same bits. A stable heat solve is not clamped.
+{
+    settable_input_params_type wave_params;
+    wave_params.set_technique( e_wave_with_damping);
+    wave_params.set_method( e_forward_diff);
+    wave_params.set_rate_x( 0.3f);
+    wave_params.set_rate_y( 0.2f);
+    wave_params.set_damping( 0.1f);
+
+    settable_input_params_type negative_params;
+    negative_params.set_technique( e_ortho_interleave);
+    negative_params.set_method( e_backward_diff);
+    negative_params.set_rate_x( -0.3f);
+    negative_params.set_rate_y( 0.2f);
+
+    settable_input_params_type const * const  clamped_params[ ] = { & wave_params, & negative_params };
+    for ( std::size_t index = 0 ; index < (sizeof( clamped_params) / sizeof( clamped_params[ 0 ])) ; ++ index ) {
+        settable_input_params_type input_params = * clamped_params[ index ];
+        input_params.set__is_method_parallel( false);
+        sheet_type serial_trg;
+        solve_sheet( input_params, serial_trg);
+        bool is_at_limit = false;
+        test_check( is_inside_limit( serial_trg, is_at_limit));
+        test_check( is_at_limit);
+
+        input_params.set__is_method_parallel( true);
+        sheet_type parallel_trg;
+        solve_sheet( input_params, parallel_trg);
+        test_check(
+            test::is_same_bits
+             (  std::vector< float >( serial_trg.begin( ), serial_trg.end( ))
+              , std::vector< float >( parallel_trg.begin( ), parallel_trg.end( ))
+             ));
+    }
+
+    settable_input_params_type heat_params;
+    heat_params.set_technique( e_simultaneous_2d);
+    heat_params.set_method( e_forward_diff);
+    heat_params.set_rate_x( 0.2f);
+    heat_params.set_rate_y( 0.15f);
+    sheet_type heat_trg;
+    solve_sheet( heat_params, heat_trg);
+    float min_value = 0;
+    float max_value = 0;
+    heat_trg.get_min_max_values( min_value, max_value);
+    test_check( (min_value < - g_limit) && (max_value > g_limit));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_functor(     "clamp_functor"         , & test_clamp_functor         );
+test::registrar_type const  register_in_kernels(  "clamp_fused_in_kernels", & test_clamp_fused_in_kernels);
+test::registrar_type const  register_in_solver(   "clamp_in_solver"       , & test_clamp_in_solver       );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_clamp.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
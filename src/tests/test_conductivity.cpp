@@ -0,0 +1,446 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_conductivity.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the conductivity map (see "Varying conductivity" in finite_diff.h).
+//
+// The vector kernels are checked against the scalar kernel in test_simd_kernels.cpp. Here we
+// check what the map does to a solve:
+//   A map of all 1s solves like no map.
+//   The forward-diff step matches a plain double-precision solve with harmonic-mean faces.
+//   Every technique and method keeps the total heat, even with cells that do not conduct.
+//   A wall of cells that do not conduct keeps the heat on its side.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <vector>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+technique_type const  g_techniques[ ] =
+ {  e_ortho_interleave, e_simultaneous_2d, e_super_time_step, e_implicit_multigrid, e_spectral_jump };
+method_type const  g_methods[ ] = { e_forward_diff, e_backward_diff, e_central_diff };
+
+// _______________________________________________________________________________________________
+
+  void
+fill_conductivity( conductivity_sheet_type & conductivity_sheet, long x_count, long y_count)
+  //
+  // Between 1/2 and 1, with every 7th cell not conducting at all.
+{
+    d_verify( conductivity_sheet.set_xy_counts( x_count, y_count, 1.0f));
+    for ( size_type index = 0 ; index < conductivity_sheet.get_xy_count( ) ; ++ index ) {
+        double const  wave  = std::sin( index * 0.7);
+        conductivity_sheet.begin( )[ index ] =
+            (0 == (index % 7)) ? 0.0f : static_cast< float >( 0.5 + (0.5 * wave * wave));
+    }
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  void
+solve_sheet
+ (  settable_input_params_type const &  input_params
+  , long                                x_count
+  , long                                y_count
+  , conductivity_sheet_type const *     p_conductivity_sheet
+  , SHEET_TYPE                        & trg                   // out
+  , double                            & heat_gained           // out, trg total minus src total
+ )
+  //
+  // The wave reads the generation before src from trg.
+{
+    SHEET_TYPE src;
+    d_verify( src.set_xy_counts( x_count, y_count, 0));
+    d_verify( trg.set_xy_counts( x_count, y_count, 0));
+    double src_sum = 0;
+    for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+        src.begin( )[ index ] = test::get_init_value< float >( index);
+        trg.begin( )[ index ] = static_cast< float >( 0.5 * std::cos( index * 0.13));
+        src_sum += src.begin( )[ index ];
+    }
+    SHEET_TYPE extra;
+    SOLVER_TYPE solver;
+    solver.calc_next
+     (  input_params
+      , typename SOLVER_TYPE::sheet_params_type( src, trg, extra, p_conductivity_sheet, 0)
+     );
+    double trg_sum = 0;
+    for ( size_type index = 0 ; index < trg.get_xy_count( ) ; ++ index ) {
+        trg_sum += trg.begin( )[ index ];
+    }
+    heat_gained = trg_sum - src_sum;
+}
+
+  long
+get_neighbor_index( boundary_type boundary, long index, long count)
+  //
+  // Past a periodic edge we wrap, past the others we mirror (the neighbor is the cell itself).
+{
+    if ( e_boundary_periodic == boundary ) {
+        return (index < 0) ? (index + count) : ((index >= count) ? (index - count) : index);
+    }
+    return (index < 0) ? 0 : ((index >= count) ? (count - 1) : index);
+}
+
+  double
+get_face( double coef_a, double coef_b)
+{
+    return ((coef_a + coef_b) > 0) ? ((2 * coef_a * coef_b) / (coef_a + coef_b)) : 0;
+}
+
+  void
+calc_reference
+ (  boundary_type                  boundary
+  , long                           x_count
+  , long                           y_count
+  , double                         rate_x
+  , double                         rate_y
+  , double                         damping
+  , std::vector< double > const &  src
+  , std::vector< double > const &  old       // the generation before src, for the wave
+  , std::vector< double > const &  coefs
+  , std::vector< double >       &  trg       // out
+ )
+{
+    trg.resize( src.size( ));
+    for ( long y = 0 ; y < y_count ; ++ y ) {
+        for ( long x = 0 ; x < x_count ; ++ x ) {
+            long const  center      = (y * x_count) + x;
+            long const  neighbors[ 4 ] =
+             {  (y * x_count) + get_neighbor_index( boundary, x - 1, x_count)
+              , (y * x_count) + get_neighbor_index( boundary, x + 1, x_count)
+              , (get_neighbor_index( boundary, y - 1, y_count) * x_count) + x
+              , (get_neighbor_index( boundary, y + 1, y_count) * x_count) + x
+             };
+            double flow_x = 0;
+            double flow_y = 0;
+            for ( int side = 0 ; side < 4 ; ++ side ) {
+                double const  flow  =
+                    get_face( coefs[ center ], coefs[ neighbors[ side ] ]) * (src[ neighbors[ side ] ] - src[ center ]);
+                if ( side < 2 ) { flow_x += flow; } else { flow_y += flow; }
+            }
+            double value = src[ center ] + (rate_x * flow_x) + (rate_y * flow_y);
+            value += (1 - damping) * (src[ center ] - old[ center ]);
+
+            // Fixed edges only on sides with a middle.
+            if ( (e_boundary_fixed == boundary) &&
+                 (((y_count > 2) && ((0 == y) || ((y_count - 1) == y))) ||
+                  ((x_count > 2) && ((0 == x) || ((x_count - 1) == x)))) )
+            {
+                value = src[ center ];
+            }
+            trg[ center ] = value;
+        }
+    }
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  bool
+check_against_reference
+ (  boundary_type  boundary
+  , long           x_count
+  , long           y_count
+  , float          damping
+  , double         tolerance
+ )
+  //
+  // The serial and parallel solves give the same bits, and match the reference.
+{
+    float const  rate_x  = 0.2f;
+    float const  rate_y  = 0.15f;
+    settable_input_params_type input_params;
+    input_params.set_technique( (1 == damping) ? e_simultaneous_2d : e_wave_with_damping);
+    input_params.set_method( e_forward_diff);
+    input_params.set_boundary( boundary);
+    input_params.set_rate_x( rate_x);
+    input_params.set_rate_y( rate_y);
+    input_params.set_damping( damping);
+
+    conductivity_sheet_type conductivity_sheet;
+    fill_conductivity( conductivity_sheet, x_count, y_count);
+
+    double heat_gained = 0;
+    input_params.set__is_method_parallel( false);
+    SHEET_TYPE serial_trg;
+    solve_sheet< SHEET_TYPE, SOLVER_TYPE >( input_params, x_count, y_count, & conductivity_sheet, serial_trg, heat_gained);
+    input_params.set__is_method_parallel( true);
+    SHEET_TYPE parallel_trg;
+    solve_sheet< SHEET_TYPE, SOLVER_TYPE >( input_params, x_count, y_count, & conductivity_sheet, parallel_trg, heat_gained);
+
+    std::vector< double > src( x_count * y_count);
+    std::vector< double > old( x_count * y_count);
+    for ( long index = 0 ; index < (x_count * y_count) ; ++ index ) {
+        src[ index ] = test::get_init_value< float >( index);
+        old[ index ] = static_cast< float >( 0.5 * std::cos( index * 0.13));
+    }
+    std::vector< double > const  coefs( conductivity_sheet.begin( ), conductivity_sheet.end( ));
+    std::vector< double > expected;
+    calc_reference( boundary, x_count, y_count, rate_x, rate_y, damping, src, old, coefs, expected);
+
+    double max_error = 0;
+    for ( std::size_t index = 0 ; index < expected.size( ) ; ++ index ) {
+        max_error = std::max( max_error, std::fabs( expected[ index ] - serial_trg.begin( )[ index ]));
+    }
+    return (max_error < tolerance) && (0 == test::get_max_difference( serial_trg, parallel_trg));
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_face_conductivity( )
+  //
+  // The harmonic mean, the same both ways, and zero if either cell does not conduct.
+{
+    test_check( 1.0f == finite_difference::get_face_conductivity( 1.0f, 1.0f));
+    test_check( 0.5f == finite_difference::get_face_conductivity( 0.5f, 0.5f));
+    test_check( 0.0f == finite_difference::get_face_conductivity( 0.0f, 0.8f));
+    test_check( 0.0f == finite_difference::get_face_conductivity( 0.8f, 0.0f));
+    test_check( 0.0f == finite_difference::get_face_conductivity( 0.0f, 0.0f));
+    test_check( std::fabs( finite_difference::get_face_conductivity( 1.0, 0.5) - (2.0 / 3)) < 1e-15);
+    test_check(
+        finite_difference::get_face_conductivity( 0.3f, 0.9f) ==
+        finite_difference::get_face_conductivity( 0.9f, 0.3f));
+}
+
+  void
+test_uniform_map( )
+  //
+  // With every cell at 1 the map changes nothing. Spectral jump and multigrid only know one
+  // rate, so with a map they solve like simultaneous 2d, and the wide stencils solve as 5-point.
+{
+    long const  x_count  = 61;
+    long const  y_count  = 29;
+    conductivity_sheet_type ones_sheet;
+    d_verify( ones_sheet.set_xy_counts( x_count, y_count, 1.0f));
+
+    for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+      for ( std::size_t t = 0 ; t < (sizeof( g_techniques) / sizeof( g_techniques[ 0 ])) ; ++ t ) {
+        for ( std::size_t m = 0 ; m < (sizeof( g_methods) / sizeof( g_methods[ 0 ])) ; ++ m ) {
+            bool const  is_forward  = (e_forward_diff == g_methods[ m ]);
+            settable_input_params_type input_params;
+            input_params.set_technique( g_techniques[ t ]);
+            input_params.set_method( g_methods[ m ]);
+            input_params.set_rate_x( is_forward ? 0.2f : 1.7f);
+            input_params.set_rate_y( is_forward ? 0.15f : 0.9f);
+            input_params.set_extra_pass_count( 2);
+            input_params.set__is_method_parallel( 0 != is_parallel);
+
+            double heat_gained = 0;
+            sheet_type mapped_trg;
+            solve_sheet< sheet_type, solver_type >( input_params, x_count, y_count, & ones_sheet, mapped_trg, heat_gained);
+            if ( (e_spectral_jump == g_techniques[ t ]) || (e_implicit_multigrid == g_techniques[ t ]) ) {
+                input_params.set_technique( e_simultaneous_2d);
+            }
+            sheet_type plain_trg;
+            solve_sheet< sheet_type, solver_type >( input_params, x_count, y_count, 0, plain_trg, heat_gained);
+            if ( ! test_check( test::get_max_difference( mapped_trg, plain_trg) < 2e-6) ) {
+                std::fprintf( stderr, "  technique %d, method %d, %s\n",
+                    static_cast< int >( g_techniques[ t ]), static_cast< int >( g_methods[ m ]),
+                    is_parallel ? "parallel" : "serial");
+            }
+        }
+      }
+    }
+
+    // The wide stencils and the wave.
+    method_type const  wide_methods[ ] = { e_forward_diff_9_point, e_forward_diff_4th_order };
+    for ( std::size_t index = 0 ; index < (sizeof( wide_methods) / sizeof( wide_methods[ 0 ])) ; ++ index ) {
+        for ( int is_wave = 0 ; is_wave < 2 ; ++ is_wave ) {
+            settable_input_params_type input_params;
+            input_params.set_technique( is_wave ? e_wave_with_damping : e_simultaneous_2d);
+            input_params.set_method( wide_methods[ index ]);
+            input_params.set_rate_x( 0.2f);
+            input_params.set_rate_y( 0.15f);
+            input_params.set_damping( is_wave ? 0.1f : 1.0f);
+
+            double heat_gained = 0;
+            sheet_type mapped_trg;
+            solve_sheet< sheet_type, solver_type >( input_params, x_count, y_count, & ones_sheet, mapped_trg, heat_gained);
+            input_params.set_method( e_forward_diff);
+            sheet_type plain_trg;
+            solve_sheet< sheet_type, solver_type >( input_params, x_count, y_count, 0, plain_trg, heat_gained);
+            test_check( test::get_max_difference( mapped_trg, plain_trg) < 2e-6);
+        }
+    }
+}
+
+  void
+test_conductivity_match_reference( )
+  //
+  // The forward-diff step with a map, heat and wave, on each boundary, from big sheets to 1x1.
+{
+    long const  sizes[ ][ 2 ] =
+     { { 157, 93 }, { 1, 1 }, { 2, 3 }, { 3, 2 }, { 1, 9 }, { 9, 1 }, { 5, 7 }, { 64, 5 }, { 17, 13 } };
+    boundary_type const  boundaries[ ] = { e_boundary_insulated, e_boundary_fixed, e_boundary_periodic };
+
+    for ( std::size_t b = 0 ; b < (sizeof( boundaries) / sizeof( boundaries[ 0 ])) ; ++ b ) {
+      for ( std::size_t s = 0 ; s < (sizeof( sizes) / sizeof( sizes[ 0 ])) ; ++ s ) {
+        for ( int is_wave = 0 ; is_wave < 2 ; ++ is_wave ) {
+            float const  damping  = is_wave ? 0.3f : 1.0f;
+            bool const  is_float_ok  =
+                check_against_reference< sheet_type, solver_type >
+                 ( boundaries[ b ], sizes[ s ][ 0 ], sizes[ s ][ 1 ], damping, 3e-6);
+            bool const  is_double_ok  =
+                check_against_reference< double_sheet_type, double_solver_type >
+                 ( boundaries[ b ], sizes[ s ][ 0 ], sizes[ s ][ 1 ], damping, 1e-12);
+            if ( ! test_check( is_float_ok && is_double_ok) ) {
+                std::fprintf( stderr, "  boundary %d, %ldx%ld, %s\n",
+                    static_cast< int >( boundaries[ b ]), sizes[ s ][ 0 ], sizes[ s ][ 1 ],
+                    is_wave ? "wave" : "heat");
+            }
+        }
+      }
+    }
+}
+
+  void
+test_conductivity_conserves_heat( )
+  //
+  // Each technique and method, serial and parallel, float and double, with insulated edges.
+{
+    long const  sizes[ ][ 2 ] = { { 157, 93 }, { 2, 3 }, { 5, 7 }, { 64, 5 } };
+    for ( std::size_t s = 0 ; s < (sizeof( sizes) / sizeof( sizes[ 0 ])) ; ++ s ) {
+      long const  x_count  = sizes[ s ][ 0 ];
+      long const  y_count  = sizes[ s ][ 1 ];
+      conductivity_sheet_type conductivity_sheet;
+      fill_conductivity( conductivity_sheet, x_count, y_count);
+
+      for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+        for ( std::size_t t = 0 ; t < (sizeof( g_techniques) / sizeof( g_techniques[ 0 ])) ; ++ t ) {
+          for ( std::size_t m = 0 ; m < (sizeof( g_methods) / sizeof( g_methods[ 0 ])) ; ++ m ) {
+            bool const  is_forward  = (e_forward_diff == g_methods[ m ]);
+            settable_input_params_type input_params;
+            input_params.set_technique( g_techniques[ t ]);
+            input_params.set_method( g_methods[ m ]);
+            input_params.set_rate_x( is_forward ? 0.2f : 2.5f);
+            input_params.set_rate_y( is_forward ? 0.15f : 1.1f);
+            input_params.set_extra_pass_count( 1);
+            input_params.set__is_method_parallel( 0 != is_parallel);
+
+            double float_gained = 0;
+            sheet_type float_trg;
+            solve_sheet< sheet_type, solver_type >
+             ( input_params, x_count, y_count, & conductivity_sheet, float_trg, float_gained);
+            double double_gained = 0;
+            double_sheet_type double_trg;
+            solve_sheet< double_sheet_type, double_solver_type >
+             ( input_params, x_count, y_count, & conductivity_sheet, double_trg, double_gained);
+
+            double const  cell_count  = double( x_count * y_count);
+            if ( ! test_check(
+                    (std::fabs( float_gained ) < (1e-6 * (1 + cell_count))) &&
+                    (std::fabs( double_gained) < (1e-12 * (1 + cell_count)))) )
+            {
+                std::fprintf( stderr, "  technique %d, method %d, %ldx%ld, %s, gained %g %g\n",
+                    static_cast< int >( g_techniques[ t ]), static_cast< int >( g_methods[ m ]),
+                    x_count, y_count, is_parallel ? "parallel" : "serial", float_gained, double_gained);
+            }
+          }
+        }
+      }
+    }
+}
+
+  void
+test_insulating_wall( )
+  //
+  // The left side is hot and the right side cold, with a column of cells between them that do
+  // not conduct. After many passes no heat has crossed, and the left side has kept all of it
+  // (to float rounding over 50 passes).
+{
+    long const  x_count  = 40;
+    long const  y_count  = 30;
+    long const  wall_x   = 20;
+    conductivity_sheet_type conductivity_sheet;
+    d_verify( conductivity_sheet.set_xy_counts( x_count, y_count, 1.0f));
+    for ( long y = 0 ; y < y_count ; ++ y ) {
+        conductivity_sheet.begin( )[ (y * x_count) + wall_x ] = 0;
+    }
+
+    technique_type const  techniques[ ] = { e_simultaneous_2d, e_ortho_interleave, e_ortho_interleave, e_super_time_step };
+    method_type const     methods[ ]    = { e_forward_diff   , e_backward_diff   , e_central_diff    , e_forward_diff    };
+    for ( std::size_t index = 0 ; index < (sizeof( techniques) / sizeof( techniques[ 0 ])) ; ++ index ) {
+        bool const  is_forward  = (e_forward_diff == methods[ index ]) && (e_super_time_step != techniques[ index ]);
+        settable_input_params_type input_params;
+        input_params.set_technique( techniques[ index ]);
+        input_params.set_method( methods[ index ]);
+        input_params.set_rate_x( is_forward ? 0.2f : 3.0f);
+        input_params.set_rate_y( is_forward ? 0.2f : 3.0f);
+        input_params.set_extra_pass_count( 49);
+        input_params.set__is_method_parallel( true);
+
+        sheet_type src;
+        d_verify( src.set_xy_counts( x_count, y_count, 0));
+        double left_sum = 0;
+        for ( long y = 0 ; y < y_count ; ++ y ) {
+            for ( long x = 0 ; x < wall_x ; ++ x ) {
+                float const  value  = 1.0f + (0.5f * static_cast< float >( std::sin( (x * 0.7) + (y * 0.3))));
+                src.begin( )[ (y * x_count) + x ] = value;
+                left_sum += value;
+            }
+        }
+        sheet_type trg;
+        trg = src;
+        sheet_type extra;
+        solver_type solver;
+        solver.calc_next( input_params, sheet_params_type( src, trg, extra, & conductivity_sheet, 0));
+
+        double trg_left_sum = 0;
+        float  right_max    = 0;
+        for ( long y = 0 ; y < y_count ; ++ y ) {
+            for ( long x = 0 ; x < x_count ; ++ x ) {
+                float const  value  = trg.begin( )[ (y * x_count) + x ];
+                if ( x < wall_x ) {
+                    trg_left_sum += value;
+                } else {
+                    right_max = std::max( right_max, std::fabs( value));
+                }
+            }
+        }
+        if ( ! test_check( (0 == right_max) && (std::fabs( trg_left_sum - left_sum) < (1e-4 * left_sum))) ) {
+            std::fprintf( stderr, "  technique %d, method %d, right %g, left gained %g\n",
+                static_cast< int >( techniques[ index ]), static_cast< int >( methods[ index ]),
+                double( right_max), trg_left_sum - left_sum);
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_face(       "face_conductivity"           , & test_face_conductivity           );
+test::registrar_type const  register_uniform(    "conductivity_uniform_map"    , & test_uniform_map                 );
+test::registrar_type const  register_reference(  "conductivity_match_reference", & test_conductivity_match_reference);
+test::registrar_type const  register_conserves(  "conductivity_conserves_heat" , & test_conductivity_conserves_heat );
+test::registrar_type const  register_wall(       "insulating_wall"             , & test_insulating_wall             );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_conductivity.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
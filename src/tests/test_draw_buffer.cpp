@@ -0,0 +1,179 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_draw_buffer.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the triple buffer that hands solved sheets to the drawing code (draw_buffer.h).
+//
+// Each published sheet here is filled with its generation number, so a sheet the drawing side
+// takes tells us which generation it is, and whether it was torn (some cells from one
+// generation and some from another).
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <QtCore/QAtomicInt>
+# include <QtCore/QThread>
+# include "draw_buffer.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+// _______________________________________________________________________________________________
+
+  sheet_type
+make_generation( int generation, sheet_type::size_type x_count, sheet_type::size_type y_count)
+{
+    sheet_type sheet;
+    d_verify( sheet.set_xy_counts( x_count, y_count, static_cast< sheet_type::value_type >( generation)));
+    return sheet;
+}
+
+  int
+get_generation( sheet_type const & sheet)
+  //
+  // The generation a sheet holds. -1 if it's empty or torn.
+{
+    if ( sheet.is_reset( ) ) return -1;
+    sheet_type::value_type min_value = 0;
+    sheet_type::value_type max_value = 0;
+    d_verify( sheet.get_min_max_values( min_value, max_value));
+    return (min_value == max_value) ? static_cast< int >( min_value) : -1;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_draw_buffer_latest( )
+  //
+  // The drawing side always gets the latest sheet, and it stays put until the next take.
+{
+    draw_buffer_type buffer;
+    test_check( buffer.take_latest( ).is_reset( ));
+
+    buffer.publish( make_generation( 1, 8, 5));
+    test_check( 1 == get_generation( buffer.take_latest( )));
+    test_check( 1 == get_generation( buffer.take_latest( )));
+
+    // Publish a few without taking. We skip straight to the last one.
+    buffer.publish( make_generation( 2, 8, 5));
+    buffer.publish( make_generation( 3, 8, 5));
+    buffer.publish( make_generation( 4, 8, 5));
+    sheet_type const & taken = buffer.take_latest( );
+    test_check( 4 == get_generation( taken));
+
+    // The publisher never writes the sheet we're drawing.
+    buffer.publish( make_generation( 5, 8, 5));
+    buffer.publish( make_generation( 6, 8, 5));
+    buffer.publish( make_generation( 7, 8, 5));
+    test_check( 4 == get_generation( taken));
+    test_check( 7 == get_generation( buffer.take_latest( )));
+    test_check( 7 == get_generation( buffer.take_latest( )));
+}
+
+  void
+test_draw_buffer_draw_size( )
+  //
+  // With a draw size the published sheets are shrunk to it.
+{
+    draw_buffer_type buffer;
+    buffer.set_draw_size( 4, 3);
+    buffer.publish( make_generation( 9, 40, 30));
+    sheet_type const & small = buffer.take_latest( );
+    test_check( (4 == small.get_x_count( )) && (3 == small.get_y_count( )));
+    test_check( 9 == get_generation( small));
+
+    buffer.set_draw_size( 0, 0);
+    buffer.publish( make_generation( 10, 40, 30));
+    sheet_type const & full = buffer.take_latest( );
+    test_check( (40 == full.get_x_count( )) && (30 == full.get_y_count( )));
+    test_check( 10 == get_generation( full));
+}
+
+// _______________________________________________________________________________________________
+
+  class
+publish_thread_type
+  : public QThread
+  //
+  // Publishes generations 1 thru last_generation as fast as it can.
+{
+  public:
+    publish_thread_type( draw_buffer_type & buffer, int last_generation)
+      : buffer_          ( buffer)
+      , last_generation_ ( last_generation)
+      , is_done_         ( 0)
+      { }
+    bool            is_done( )                                     { return 0 != is_done_.fetchAndAddOrdered( 0); }
+  protected:
+    virtual
+      void
+    run( )
+      { for ( int generation = 1 ; generation <= last_generation_ ; ++ generation ) {
+            buffer_.publish( make_generation( generation, 33, 17));
+        }
+        is_done_.fetchAndStoreOrdered( 1);
+      }
+  private:
+    draw_buffer_type &  buffer_          ;
+    int const           last_generation_ ;
+    QAtomicInt          is_done_         ;
+};
+
+  void
+test_draw_buffer_two_threads( )
+  //
+  // One thread publishes while this one takes. We never see a torn sheet, the generations
+  // never go backwards, and once the publisher is done we see the last one.
+{
+    int const last_generation = 20000;
+    draw_buffer_type buffer;
+    publish_thread_type publisher( buffer, last_generation);
+    publisher.start( );
+
+    int  previous_generation  = 0;
+    int  torn_count           = 0;
+    int  backwards_count      = 0;
+    for ( bool is_done = false ; ! is_done ; ) {
+        is_done = publisher.is_done( );
+        sheet_type const & sheet = buffer.take_latest( );
+        if ( sheet.is_reset( ) ) continue;
+
+        int const generation = get_generation( sheet);
+        if ( generation < 0 ) { ++ torn_count; continue; }
+        if ( generation < previous_generation ) { ++ backwards_count; }
+        previous_generation = generation;
+    }
+    publisher.wait( );
+
+    test_check( 0 == torn_count);
+    test_check( 0 == backwards_count);
+    test_check( last_generation == previous_generation);
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_latest(      "draw_buffer_latest"     , & test_draw_buffer_latest     );
+test::registrar_type const  register_draw_size(   "draw_buffer_draw_size"  , & test_draw_buffer_draw_size  );
+test::registrar_type const  register_two_threads( "draw_buffer_two_threads", & test_draw_buffer_two_threads);
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_draw_buffer.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,724 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_finite_diff.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the cache-friendly ways of walking the sheet in finite_diff_solver.h, and for the
+// implicit solves that reuse a factored matrix.
+//
+// Each of these visits the cells in a different order than the plain solve, but calculates
+// every cell the same way. So the results must be the same bits as the plain solve.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <algorithm>
+# include <vector>
+# include "heat_solver.h"
+# include "finite_diff_solver.h"
+# include "row_pool.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+// _______________________________________________________________________________________________
+
+  void
+fill_sheet( sheet_type & sheet, size_type x_count, size_type y_count)
+{
+    d_verify( sheet.set_xy_counts( x_count, y_count, 0));
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        sheet.begin( )[ index ] = std::sin( index * 0.37f) + ((0 == (index % 7)) ? 1.0f : 0.0f);
+    }
+}
+
+  std::vector< float >
+get_values( sheet_type const & sheet)
+{
+    return std::vector< float >( sheet.begin( ), sheet.end( ));
+}
+
+  void
+solve_pass_by_pass
+ (  settable_input_params_type const &  input_params
+  , size_type                           generation_count
+  , sheet_type const &                  src_sheet
+  , sheet_type       &                  last_sheet
+  , sheet_type       &                  history_sheet
+ )
+  //
+  // The reference: generation_count calls to calc_next(..), one pass each.
+{
+    settable_input_params_type one_pass_params = input_params;
+    one_pass_params.set_extra_pass_count( 0);
+
+    history_sheet = src_sheet;
+    last_sheet    = src_sheet;
+    sheet_type extra_sheet;
+    solver_type solver;
+    for ( size_type generation = 0 ; generation < generation_count ; ++ generation ) {
+        sheet_type next_sheet;
+        next_sheet = last_sheet;
+        solver.calc_next( one_pass_params, sheet_params_type( last_sheet, next_sheet, extra_sheet, 0, 0));
+        history_sheet = last_sheet;
+        last_sheet    = next_sheet;
+    }
+}
+
+// _______________________________________________________________________________________________
+
+typedef std::vector< float >                     values_type      ;
+typedef values_type::const_iterator              src_iter_type    ;
+typedef values_type::iterator                    trg_iter_type    ;
+typedef stride_range< src_iter_type, 1 >         src_range_type   ;
+typedef stride_range< trg_iter_type, 1 >         trg_range_type   ;
+typedef calc_next_1d_functor_super_type< float, src_iter_type, trg_iter_type >
+                                                 functor_type     ;
+typedef implicit_matrix_cache_type< float >      matrix_cache_type ;
+
+  struct
+functors_type
+  //
+  // The 1d functors the solver uses for column passes, serial and parallel.
+{
+    explicit
+    functors_type( std::size_t buffer_count)
+      : is_early_exit     ( false)
+      , buffer_a          ( buffer_count)
+      , buffer_b          ( buffer_count)
+      , buf_iter_a        ( buffer_a.begin( ))
+      , buf_iter_b        ( buffer_b.begin( ))
+      , forward_serial    ( is_early_exit)
+      , forward_parallel  ( is_early_exit)
+      , backward_serial   ( is_early_exit, buf_iter_a, buf_iter_b, matrix_cache)
+      , backward_parallel ( is_early_exit, buf_iter_a, buf_iter_b, matrix_cache)
+      , central_serial    ( is_early_exit, buf_iter_a, buf_iter_b, matrix_cache)
+      , central_parallel  ( is_early_exit, buf_iter_a, buf_iter_b, matrix_cache)
+      { }
+
+    functor_type const &
+    get( std::size_t index) const
+      { functor_type const * const  p_functors[ ] =
+         {  & forward_serial , & forward_parallel
+          , & backward_serial, & backward_parallel
+          , & central_serial , & central_parallel
+         };
+        d_assert( index < get_count( ));
+        return *p_functors[ index ];
+      }
+
+    static std::size_t  get_count( )                      { return 6; }
+    static bool         is_forward( std::size_t index)    { return index < 2; }
+    static bool         is_central( std::size_t index)    { return index >= 4; }
+
+    bool               is_early_exit ;
+    values_type        buffer_a      ;
+    values_type        buffer_b      ;
+    trg_iter_type      buf_iter_a    ;  // the functors keep references to these
+    trg_iter_type      buf_iter_b    ;
+    matrix_cache_type  matrix_cache  ;
+
+    calc_next_1d_forward_diff_serial_functor_type<    float, src_iter_type, trg_iter_type >
+                       forward_serial    ;
+    calc_next_1d_forward_diff_parallel_functor_type<  float, src_iter_type, trg_iter_type >
+                       forward_parallel  ;
+    calc_next_1d_backward_diff_serial_functor_type<   float, src_iter_type, trg_iter_type, trg_iter_type >
+                       backward_serial   ;
+    calc_next_1d_backward_diff_parallel_functor_type< float, src_iter_type, trg_iter_type, trg_iter_type >
+                       backward_parallel ;
+    calc_next_1d_central_diff_serial_functor_type<    float, src_iter_type, trg_iter_type, trg_iter_type >
+                       central_serial    ;
+    calc_next_1d_central_diff_parallel_functor_type<  float, src_iter_type, trg_iter_type, trg_iter_type >
+                       central_parallel  ;
+};
+
+  void
+fill_values( values_type & values, std::size_t count, float phase)
+{
+    values.resize( count);
+    for ( std::size_t index = 0 ; index < count ; ++ index ) {
+        values[ index ] = std::sin( (index * 0.37f) + phase) + ((0 == (index % 7)) ? 1.0f : 0.0f);
+    }
+}
+
+  void
+solve_columns_directly
+ (  functor_type const &  functor
+  , float                 damping
+  , float                 rate
+  , std::size_t           x_count
+  , std::size_t           y_count
+  , src_iter_type         src_iter
+  , trg_iter_type         trg_iter
+ )
+  //
+  // The reference: the functor walks each column straight down the sheet.
+{
+    functor
+     (  damping, rate
+      , src_range_type( x_count, std::ptrdiff_t( 1), y_count, static_cast< std::ptrdiff_t >( x_count), src_iter)
+      , trg_range_type( x_count, std::ptrdiff_t( 1), y_count, static_cast< std::ptrdiff_t >( x_count), trg_iter)
+     );
+}
+
+  src_range_type
+get_rows( std::size_t row_count, std::size_t row_length, src_iter_type const & iter)
+  //
+  // row_count rows of row_length cells, one after the other.
+{
+    return
+        src_range_type
+         (  row_count, static_cast< std::ptrdiff_t >( row_length)
+          , row_length, std::ptrdiff_t( 1)
+          , iter
+         );
+}
+
+  double
+get_max_relative_difference( values_type const & expected, values_type const & actual)
+{
+    d_assert( expected.size( ) == actual.size( ));
+    double max_difference = 0;
+    for ( std::size_t index = 0 ; index < expected.size( ) ; ++ index ) {
+        double const  value  = expected[ index ];
+        max_difference = std::max( max_difference, std::fabs( value - actual[ index ]) / (1 + std::fabs( value)));
+    }
+    return max_difference;
+}
+
+  void
+solve_lines_one_by_one
+ (  bool                  is_central
+  , float                 damping
+  , float                 rate
+  , std::size_t           x_count
+  , std::size_t           y_count
+  , bool                  is_columns
+  , values_type const &   src        // can be the same as trg
+  , values_type        &  trg
+ )
+  //
+  // The reference for the implicit functors: copies each row (or column) out, solves it with
+  // finite_difference::calc_next_generation_backward/central_difference_1d(..), and copies it
+  // back.
+{
+    std::size_t    const  line_total    = is_columns ? x_count : y_count;
+    std::size_t    const  line_count    = is_columns ? y_count : x_count;
+    std::ptrdiff_t const  line_stride   = is_columns ? 1 : static_cast< std::ptrdiff_t >( x_count);
+    std::ptrdiff_t const  cell_stride   = is_columns ? static_cast< std::ptrdiff_t >( x_count) : 1;
+
+    values_type line_src( line_count);
+    values_type line_trg( line_count);
+    values_type temp_a( line_count);
+    values_type temp_b( line_count);
+    for ( std::size_t line = 0 ; line < line_total ; ++ line ) {
+        for ( std::size_t cell = 0 ; cell < line_count ; ++ cell ) {
+            std::ptrdiff_t const  index  = (line * line_stride) + (cell * cell_stride);
+            line_src[ cell ] = src[ index ];
+            line_trg[ cell ] = trg[ index ];
+        }
+        values_type const &  const_line_src  = line_src;
+        if ( is_central ) {
+            finite_difference::calc_next_generation_central_difference_1d
+             (  damping, rate, const_line_src.begin( ), const_line_src.end( ), line_trg.begin( )
+              , temp_a.begin( ), temp_b.begin( )
+             );
+        } else {
+            finite_difference::calc_next_generation_backward_difference_1d
+             (  damping, rate, const_line_src.begin( ), const_line_src.end( ), line_trg.begin( )
+              , temp_a.begin( ), temp_b.begin( )
+             );
+        }
+        for ( std::size_t cell = 0 ; cell < line_count ; ++ cell ) {
+            trg[ (line * line_stride) + (cell * cell_stride) ] = line_trg[ cell ];
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_forward_diff_blocked( )
+  //
+  // Temporal blocking (calc_next_2d_forward_diff_blocked(..)) leaves the same last generation
+  // and history as solving pass by pass. The bands are from 1 row up, so some bands are
+  // shorter than their slopes, and the sizes are odd so the last band is short.
+{
+    size_type const  size_cases[ ][ 2 ] = { { 2, 2 }, { 3, 5 }, { 17, 40 }, { 301, 129 } };
+    size_type const  band_row_counts[ ] = { 1, 4, 10, 100 };
+
+    settable_input_params_type input_params;
+    input_params.set_technique( e_simultaneous_2d);
+    input_params.set_method( e_forward_diff);
+    input_params.set_rate_x( 0.13f);
+    input_params.set_rate_y( 0.21f);
+
+    bool const  is_early_exit  = false;
+    for ( std::size_t size_index = 0 ; size_index < (sizeof( size_cases) / sizeof( size_cases[ 0 ])) ; ++ size_index ) {
+        size_type const  x_count  = size_cases[ size_index ][ 0 ];
+        size_type const  y_count  = size_cases[ size_index ][ 1 ];
+        sheet_type src_sheet;
+        fill_sheet( src_sheet, x_count, y_count);
+
+        for ( size_type generation_count = 2 ; generation_count < 7 ; generation_count += 2 ) {
+            sheet_type last_sheet;
+            sheet_type history_sheet;
+            solve_pass_by_pass( input_params, generation_count, src_sheet, last_sheet, history_sheet);
+
+            for ( std::size_t band_index = 0 ; band_index < (sizeof( band_row_counts) / sizeof( band_row_counts[ 0 ])) ; ++ band_index ) {
+                for ( int parallel_index = 0 ; parallel_index < 2 ; ++ parallel_index ) {
+                    sheet_type trg_sheet;
+                    d_verify( trg_sheet.set_xy_counts( x_count, y_count, -5));
+                    sheet_type trg_history_sheet;
+                    d_verify( trg_history_sheet.set_xy_counts( x_count, y_count, -5));
+                    calc_next_2d_forward_diff_blocked
+                     (  is_early_exit, (0 != parallel_index)
+                      , input_params.get_rate_x( ), input_params.get_rate_y( )
+                      , x_count, y_count
+                      , generation_count, band_row_counts[ band_index ]
+                      , static_cast< sheet_type const & >( src_sheet).begin( )
+                      , trg_sheet.begin( ), trg_history_sheet.begin( )
+                     );
+                    test_check( test::is_same_bits( get_values( last_sheet), get_values( trg_sheet)));
+                    test_check( test::is_same_bits( get_values( history_sheet), get_values( trg_history_sheet)));
+                }
+            }
+        }
+    }
+}
+
+  void
+test_forward_diff_blocked_solver( )
+  //
+  // A multi-pass solve on a sheet too big for the cache is blocked by the solver, and gives the
+  // same sheets as solving pass by pass.
+{
+    size_type const  x_count           = 700;
+    size_type const  y_count           = 520;
+    size_type const  generation_count  = 6;
+    test_check( 0 != get_forward_diff_2d_blocked_band_row_count( x_count, y_count, generation_count, 1024 * 1024));
+
+    sheet_type src_sheet;
+    fill_sheet( src_sheet, x_count, y_count);
+
+    for ( int parallel_index = 0 ; parallel_index < 2 ; ++ parallel_index ) {
+        settable_input_params_type input_params;
+        input_params.set_technique( e_simultaneous_2d);
+        input_params.set_method( e_forward_diff);
+        input_params.set_rate_x( 0.2f);
+        input_params.set_rate_y( 0.15f);
+        input_params.set__is_method_parallel( 0 != parallel_index);
+        input_params.set_extra_pass_count( static_cast< int >( generation_count - 1));
+
+        sheet_type last_sheet;
+        sheet_type history_sheet;
+        solve_pass_by_pass( input_params, generation_count, src_sheet, last_sheet, history_sheet);
+
+        sheet_type src;
+        src = src_sheet;
+        sheet_type trg;
+        trg = src_sheet;
+        sheet_type extra;
+        extra = src_sheet;
+        solver_type solver;
+        solver.calc_next( input_params, sheet_params_type( src, trg, extra, 0, 0));
+        test_check( solver.get_output_params( ).is_last_solve_saved_in_extra( ));
+        test_check( test::is_same_bits( get_values( last_sheet), get_values( trg)));
+        test_check( test::is_same_bits( get_values( history_sheet), get_values( extra)));
+    }
+}
+
+  void
+test_columns_by_strip( )
+  //
+  // A column pass copied into strips (calc_next_1d_columns_by_strip(..)) gives the same bits
+  // as walking the columns directly. For every 1d functor, when the solve sets trg, when it
+  // sums into trg, and when src and trg are the same sheet. Strips from 1 column up to more
+  // than the sheet, so the last strip is usually short.
+{
+    std::size_t const  x_counts[ ]      = { 2, 3, 17, 40, 301 };
+    std::size_t const  y_counts[ ]      = { 2, 3, 5, 40, 129 };
+    std::size_t const  strip_counts[ ]  = { 1, 8, 16, 50 };
+    float const        rate             = 0.3f;
+
+    for ( std::size_t x_index = 0 ; x_index < (sizeof( x_counts) / sizeof( x_counts[ 0 ])) ; ++ x_index ) {
+      for ( std::size_t y_index = 0 ; y_index < (sizeof( y_counts) / sizeof( y_counts[ 0 ])) ; ++ y_index ) {
+        std::size_t const  x_count  = x_counts[ x_index ];
+        std::size_t const  y_count  = y_counts[ y_index ];
+        functors_type functors( (x_count * y_count) + 8);
+        for ( std::size_t strip_index = 0 ; strip_index < (sizeof( strip_counts) / sizeof( strip_counts[ 0 ])) ; ++ strip_index ) {
+          for ( std::size_t functor_index = 0 ; functor_index < functors_type::get_count( ) ; ++ functor_index ) {
+            for ( int mode = 0 ; mode < 3 ; ++ mode ) {
+                // The forward-diff functors always set trg.
+                bool const  is_sum       = (1 == mode);
+                bool const  is_in_place  = (2 == mode);
+                if ( is_sum && functors_type::is_forward( functor_index) ) continue;
+
+                float const  damping  = is_sum ?
+                    finite_difference::get_no_init_damping_sum_value< float >( ) :
+                    finite_difference::get_no_init_damping_set_value< float >( );
+                functor_type const &  functor  = functors.get( functor_index);
+
+                values_type src;
+                fill_values( src, x_count * y_count, 0);
+                values_type expected;
+                fill_values( expected, x_count * y_count, 1);
+                if ( is_in_place ) { expected = src; }
+                values_type actual( expected);
+
+                solve_columns_directly
+                 (  functor, damping, rate, x_count, y_count
+                  , is_in_place ? static_cast< values_type const & >( expected).begin( ) : static_cast< values_type const & >( src).begin( )
+                  , expected.begin( )
+                 );
+                values_type strip_src;
+                values_type strip_trg;
+                calc_next_1d_columns_by_strip
+                 (  functor, damping, rate, x_count, y_count, strip_counts[ strip_index ]
+                  , is_in_place ? static_cast< values_type const & >( actual).begin( ) : static_cast< values_type const & >( src).begin( )
+                  , actual.begin( )
+                  , strip_src, strip_trg
+                 );
+                test_check( test::is_same_bits( expected, actual));
+            }
+          }
+        }
+      }
+    }
+
+    // Only a sheet too big for the cache is worth copying into strips.
+    test_check( 0 == get_column_strip_count( 256, 256, 1024 * 1024));
+    test_check( 0 != get_column_strip_count( 4096, 4096, 1024 * 1024));
+    test_check( 0 == (get_column_strip_count( 4096, 4096, 1024 * 1024) % 16));
+}
+
+  void
+test_columns_in_lanes( )
+  //
+  // The column kernels (try_calc_next_1d_columns_in_lanes(..)) give the same bits as the
+  // backward-diff and central-diff functors walking the columns, at each SIMD level, on one
+  // thread and on a pool. With no kernels (the scalar level) they do nothing and return false.
+{
+    std::size_t const  x_counts[ ]      = { 2, 3, 17, 40, 301 };
+    std::size_t const  y_counts[ ]      = { 2, 3, 5, 40, 129 };
+    std::size_t const  strip_counts[ ]  = { 0, 1, 16, 50 };
+    float const        dampings[ ]      =
+     {  finite_difference::get_no_init_damping_set_value< float >( )
+      , finite_difference::get_no_init_damping_sum_value< float >( )
+      , 0.0f, 1.0f, 0.3f
+     };
+    float const        rate             = 0.3f;
+
+    row_pool::pool_type pool( 4);
+    row_pool::scoped_current_pool_type const  current_pool( & pool);
+
+    cpu_features::simd_level_type const  best_level  = cpu_features::get_simd_level( );
+    for ( int level = cpu_features::e_scalar ; level <= best_level ; ++ level ) {
+      d_verify( finite_difference::simd::set_kernel_level( cpu_features::simd_level_type( level)));
+      bool const  is_kernel_expected  = (cpu_features::e_scalar != level);
+      for ( std::size_t x_index = 0 ; x_index < (sizeof( x_counts) / sizeof( x_counts[ 0 ])) ; ++ x_index ) {
+        for ( std::size_t y_index = 0 ; y_index < (sizeof( y_counts) / sizeof( y_counts[ 0 ])) ; ++ y_index ) {
+          std::size_t const  x_count  = x_counts[ x_index ];
+          std::size_t const  y_count  = y_counts[ y_index ];
+          functors_type functors( (x_count * y_count) + 8);
+          for ( std::size_t strip_index = 0 ; strip_index < (sizeof( strip_counts) / sizeof( strip_counts[ 0 ])) ; ++ strip_index ) {
+            for ( int is_central = 0 ; is_central < 2 ; ++ is_central ) {
+              for ( std::size_t damping_index = 0 ; damping_index <= (sizeof( dampings) / sizeof( dampings[ 0 ])) ; ++ damping_index ) {
+                // The last pass is in place, which only makes sense when the solve sets trg.
+                bool const   is_in_place  = ((sizeof( dampings) / sizeof( dampings[ 0 ])) == damping_index);
+                float const  damping      = is_in_place ? dampings[ 0 ] : dampings[ damping_index ];
+                for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+                    values_type src;
+                    fill_values( src, x_count * y_count, 0);
+                    values_type expected;
+                    fill_values( expected, x_count * y_count, 1);
+                    if ( is_in_place ) { expected = src; }
+                    values_type actual( expected);
+                    values_type const  before( actual);
+
+                    solve_columns_directly
+                     (  functors.get( is_central ? 4 : 2), damping, rate, x_count, y_count
+                      , is_in_place ? static_cast< values_type const & >( expected).begin( ) : static_cast< values_type const & >( src).begin( )
+                      , expected.begin( )
+                     );
+                    values_type scratch;
+                    bool const  is_solved  =
+                        try_calc_next_1d_columns_in_lanes
+                         (  functors.is_early_exit, 0 != is_parallel
+                          , is_central ? 2.0f : 1.0f, damping, rate
+                          , x_count, y_count, strip_counts[ strip_index ]
+                          , is_in_place ? static_cast< values_type const & >( actual).begin( ) : static_cast< values_type const & >( src).begin( )
+                          , 0
+                          , actual.begin( )
+                          , scratch
+                         );
+                    if ( ! test_check( is_kernel_expected == is_solved) ) continue;
+                    test_check( test::is_same_bits( is_solved ? expected : before, actual));
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    d_verify( finite_difference::simd::set_kernel_level( best_level));
+}
+
+  void
+test_implicit_matrix_cache( )
+  //
+  // The cache hands back the matrix it already factored, keeps two, and factors a new one in
+  // place of the older of the two.
+{
+    typedef matrix_cache_type::matrix_type  matrix_type ;
+    matrix_cache_type cache;
+
+    matrix_type const * const  p_backward  = & cache.get_matrix( 1.0f, 0.5f, 10);
+    matrix_type const * const  p_central   = & cache.get_matrix( 2.0f, 0.5f, 10);
+    test_check( p_backward != p_central);
+    test_check( p_backward->is_factored( 1.0f, 0.5f, 10));
+    test_check( p_central->is_factored( 2.0f, 0.5f, 10));
+    test_check( p_backward == & cache.get_matrix( 1.0f, 0.5f, 10));
+    test_check( p_central  == & cache.get_matrix( 2.0f, 0.5f, 10));
+
+    // A new rate takes the older slot. Then the old rate comes back in the other slot.
+    test_check( p_backward == & cache.get_matrix( 1.0f, 0.7f, 10));
+    test_check( p_backward->is_factored( 1.0f, 0.7f, 10));
+    test_check( p_central  == & cache.get_matrix( 2.0f, 0.5f, 10));
+    test_check( p_central  == & cache.get_matrix( 1.0f, 0.5f, 10));
+    test_check( p_central->is_factored( 1.0f, 0.5f, 10));
+
+    // A new count is a new matrix too.
+    test_check( p_backward == & cache.get_matrix( 1.0f, 0.5f, 11));
+    test_check( 11 == p_backward->get_count( ));
+
+    cache.clear( );
+    test_check( 0 == p_backward->get_count( ));
+    test_check( 0 == p_central->get_count( ));
+    test_check( p_backward == & cache.get_matrix( 2.0f, 0.5f, 10));
+}
+
+  void
+test_implicit_matches_lines( )
+  //
+  // The backward-diff and central-diff functors, which solve the rows with a factored matrix
+  // from the cache, give the same bits as solving each row on its own. Along rows and down
+  // columns, serial and parallel, with the dampings the solver uses, and in place. A negative
+  // rate goes thru the unfactored solver, and that must match too.
+{
+    std::size_t const  counts[ ]    = { 2, 3, 5, 17, 100 };
+    float const        rates[ ]     = { 0.1f, 0.7f, 3.0f, -0.3f };
+    float const        dampings[ ]  =
+     {  finite_difference::get_no_init_damping_set_value< float >( )
+      , finite_difference::get_no_init_damping_sum_value< float >( )
+      , 0.9f, 1.0f
+     };
+
+    row_pool::pool_type pool( 4);
+    row_pool::scoped_current_pool_type const  current_pool( & pool);
+
+    for ( std::size_t x_index = 0 ; x_index < (sizeof( counts) / sizeof( counts[ 0 ])) ; ++ x_index ) {
+      for ( std::size_t y_index = 0 ; y_index < (sizeof( counts) / sizeof( counts[ 0 ])) ; ++ y_index ) {
+        std::size_t const  x_count  = counts[ x_index ];
+        std::size_t const  y_count  = counts[ y_index ];
+        functors_type functors( (x_count * y_count) + x_count + y_count);
+        for ( std::size_t rate_index = 0 ; rate_index < (sizeof( rates) / sizeof( rates[ 0 ])) ; ++ rate_index ) {
+          for ( std::size_t damping_index = 0 ; damping_index <= (sizeof( dampings) / sizeof( dampings[ 0 ])) ; ++ damping_index ) {
+            // The last pass is in place, which only makes sense when the solve sets trg.
+            bool const   is_in_place  = ((sizeof( dampings) / sizeof( dampings[ 0 ])) == damping_index);
+            float const  damping      = is_in_place ? dampings[ 0 ] : dampings[ damping_index ];
+            float const  rate         = rates[ rate_index ];
+            for ( std::size_t functor_index = 2 ; functor_index < functors_type::get_count( ) ; ++ functor_index ) {
+              for ( int is_columns = 0 ; is_columns < 2 ; ++ is_columns ) {
+                values_type src;
+                fill_values( src, x_count * y_count, 0);
+                values_type expected;
+                fill_values( expected, x_count * y_count, 1);
+                if ( is_in_place ) { expected = src; }
+                values_type actual( expected);
+
+                solve_lines_one_by_one
+                 (  functors_type::is_central( functor_index), damping, rate, x_count, y_count
+                  , 0 != is_columns, is_in_place ? expected : src, expected
+                 );
+
+                src_iter_type const  src_iter  =
+                    is_in_place ? static_cast< values_type const & >( actual).begin( ) : static_cast< values_type const & >( src).begin( );
+                functor_type const &  functor   = functors.get( functor_index);
+                if ( is_columns ) {
+                    solve_columns_directly( functor, damping, rate, x_count, y_count, src_iter, actual.begin( ));
+                } else {
+                    std::ptrdiff_t const  row_stride  = static_cast< std::ptrdiff_t >( x_count);
+                    functor
+                     (  damping, rate
+                      , src_range_type( y_count, row_stride, x_count, std::ptrdiff_t( 1), src_iter)
+                      , trg_range_type( y_count, row_stride, x_count, std::ptrdiff_t( 1), actual.begin( ))
+                     );
+                }
+                if ( ! test_check( test::is_same_bits( expected, actual)) ) return;
+              }
+            }
+          }
+        }
+      }
+    }
+}
+
+  void
+test_implicit_partitioned( )
+  //
+  // Splitting long rows into pieces (calc_next_1d_implicit_partitioned(..)) matches the serial
+  // solve. Not to the bit, since the elimination runs in a different order. Along rows and down
+  // columns, with the dampings the solver uses, in place, and with pieces of unequal length.
+{
+    std::size_t const  lengths[ ]           = { 8192, 12289 };
+    std::size_t const  line_totals[ ]       = { 1, 3 };
+    std::size_t const  partition_counts[ ]  = { 2, 3, 5 };
+    float const        rates[ ]             = { 0.1f, 50.0f };
+    float const        dampings[ ]          =
+     {  finite_difference::get_no_init_damping_set_value< float >( )
+      , finite_difference::get_no_init_damping_sum_value< float >( )
+      , 0.9f
+     };
+
+    row_pool::pool_type pool( 4);
+    row_pool::scoped_current_pool_type const  current_pool( & pool);
+
+    for ( std::size_t length_index = 0 ; length_index < (sizeof( lengths) / sizeof( lengths[ 0 ])) ; ++ length_index ) {
+      for ( std::size_t total_index = 0 ; total_index < (sizeof( line_totals) / sizeof( line_totals[ 0 ])) ; ++ total_index ) {
+        for ( int is_columns = 0 ; is_columns < 2 ; ++ is_columns ) {
+          std::size_t const  x_count  = is_columns ? line_totals[ total_index ] : lengths[ length_index ];
+          std::size_t const  y_count  = is_columns ? lengths[ length_index ] : line_totals[ total_index ];
+          functors_type functors( 2 * x_count * y_count);
+          std::ptrdiff_t const  line_stride  = is_columns ? 1 : static_cast< std::ptrdiff_t >( x_count);
+          std::ptrdiff_t const  cell_stride  = is_columns ? static_cast< std::ptrdiff_t >( x_count) : 1;
+          std::size_t    const  line_total   = line_totals[ total_index ];
+          std::size_t    const  line_count   = lengths[ length_index ];
+
+          for ( std::size_t rate_index = 0 ; rate_index < (sizeof( rates) / sizeof( rates[ 0 ])) ; ++ rate_index ) {
+            for ( std::size_t damping_index = 0 ; damping_index <= (sizeof( dampings) / sizeof( dampings[ 0 ])) ; ++ damping_index ) {
+              // The last pass is in place, which only makes sense when the solve sets trg.
+              bool const   is_in_place  = ((sizeof( dampings) / sizeof( dampings[ 0 ])) == damping_index);
+              float const  damping      = is_in_place ? dampings[ 0 ] : dampings[ damping_index ];
+              float const  rate         = rates[ rate_index ];
+              for ( int is_central = 0 ; is_central < 2 ; ++ is_central ) {
+                for ( std::size_t count_index = 0 ; count_index < (sizeof( partition_counts) / sizeof( partition_counts[ 0 ])) ; ++ count_index ) {
+                    values_type src;
+                    fill_values( src, x_count * y_count, 0);
+                    values_type expected;
+                    fill_values( expected, x_count * y_count, 1);
+                    if ( is_in_place ) { expected = src; }
+                    values_type actual( expected);
+
+                    values_type const &  expected_src  = is_in_place ? expected : src;
+                    values_type const &  actual_src    = is_in_place ? actual   : src;
+                    functors.get( is_central ? 4 : 2)
+                     (  damping, rate
+                      , src_range_type( line_total, line_stride, line_count, cell_stride, expected_src.begin( ))
+                      , trg_range_type( line_total, line_stride, line_count, cell_stride, expected.begin( ))
+                     );
+                    calc_next_1d_implicit_partitioned
+                     (  functors.is_early_exit
+                      , is_central ? 2.0f : 1.0f, damping, rate
+                      , src_range_type( line_total, line_stride, line_count, cell_stride, actual_src.begin( ))
+                      , trg_range_type( line_total, line_stride, line_count, cell_stride, actual.begin( ))
+                      , functors.buf_iter_a, functors.buf_iter_b
+                      , partition_counts[ count_index ]
+                     );
+                    if ( ! test_check( get_max_relative_difference( expected, actual) < 1e-4) ) return;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+}
+
+  void
+test_implicit_partition_count( )
+  //
+  // The parallel functors only split rows when there are fewer rows than threads, at least 3
+  // threads, and pieces of at least 4096 cells. When they do split, the result still matches
+  // the serial functor.
+{
+    typedef calc_next_1d_backward_diff_parallel_functor_type< float, src_iter_type, trg_iter_type, trg_iter_type >
+                                                                 parallel_functor_type ;
+    values_type const  values( 40000);
+    src_iter_type const  iter  = values.begin( );
+
+    {   row_pool::pool_type pool( 4);
+        row_pool::scoped_current_pool_type const  current_pool( & pool);
+        test_check( 4 == parallel_functor_type::get_partition_count( 0.5f, get_rows( 2, 20000, iter)));
+        test_check( 2 == parallel_functor_type::get_partition_count( 0.5f, get_rows( 1, 8192, iter)));
+        test_check( 1 == parallel_functor_type::get_partition_count( 0.5f, get_rows( 1, 8191, iter)));
+        test_check( 1 == parallel_functor_type::get_partition_count( 0.5f, get_rows( 4, 10000, iter)));
+        test_check( 1 == parallel_functor_type::get_partition_count( -0.5f, get_rows( 1, 20000, iter)));
+
+        std::size_t const  x_count  = 20000;
+        std::size_t const  y_count  = 2;
+        functors_type functors( 2 * x_count * y_count);
+        values_type src;
+        fill_values( src, x_count * y_count, 0);
+        values_type expected( x_count * y_count);
+        values_type actual( x_count * y_count);
+        float const  damping  = finite_difference::get_no_init_damping_set_value< float >( );
+        std::ptrdiff_t const  row_stride  = static_cast< std::ptrdiff_t >( x_count);
+        for ( std::size_t functor_index = 2 ; functor_index < functors_type::get_count( ) ; functor_index += 2 ) {
+            functors.get( functor_index)
+             (  damping, 0.5f
+              , src_range_type( y_count, row_stride, x_count, std::ptrdiff_t( 1), static_cast< values_type const & >( src).begin( ))
+              , trg_range_type( y_count, row_stride, x_count, std::ptrdiff_t( 1), expected.begin( ))
+             );
+            functors.get( functor_index + 1)
+             (  damping, 0.5f
+              , src_range_type( y_count, row_stride, x_count, std::ptrdiff_t( 1), static_cast< values_type const & >( src).begin( ))
+              , trg_range_type( y_count, row_stride, x_count, std::ptrdiff_t( 1), actual.begin( ))
+             );
+            test_check( get_max_relative_difference( expected, actual) < 1e-4);
+        }
+    }
+
+    // Two threads don't pay for the extra arithmetic.
+    {   row_pool::pool_type pool( 2);
+        row_pool::scoped_current_pool_type const  current_pool( & pool);
+        test_check( 1 == parallel_functor_type::get_partition_count( 0.5f, get_rows( 1, 20000, iter)));
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_blocked(        "forward_diff_blocked"       , & test_forward_diff_blocked       );
+test::registrar_type const  register_blocked_solver( "forward_diff_blocked_solver", & test_forward_diff_blocked_solver);
+test::registrar_type const  register_by_strip(       "columns_by_strip"           , & test_columns_by_strip           );
+test::registrar_type const  register_in_lanes(       "columns_in_lanes"           , & test_columns_in_lanes           );
+test::registrar_type const  register_matrix_cache(   "implicit_matrix_cache"      , & test_implicit_matrix_cache      );
+test::registrar_type const  register_match_lines(    "implicit_matches_lines"     , & test_implicit_matches_lines     );
+test::registrar_type const  register_partitioned(    "implicit_partitioned"       , & test_implicit_partitioned       );
+test::registrar_type const  register_part_count(     "implicit_partition_count"   , & test_implicit_partition_count   );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_finite_diff.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,322 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_fixed_point.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for uniform_scalar< INT_INNER_T > (uniform_scalar.h) and the fixed-point solvers,
+// fixed16_solver_type and fixed32_solver_type.
+//
+// The solvers are checked cell by cell against the formula in finite_diff.h, worked out here in
+// 64-bit ints, and against the float solver.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <vector>
+# include <algorithm>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+// _______________________________________________________________________________________________
+
+  template< typename INT_TYPE >
+  INT_TYPE
+clamp_inner( boost::int64_t n)
+{
+    typedef uniform_scalar< INT_TYPE >  scalar_type ;
+    return static_cast< INT_TYPE >(
+        std::min< boost::int64_t >( scalar_type::get_int_inner_max( ),
+            std::max< boost::int64_t >( scalar_type::get_int_inner_min( ), n)));
+}
+
+  template< typename INT_TYPE >
+  void
+solve_one_generation
+ (  INT_TYPE                        rate_x
+  , INT_TYPE                        rate_y
+  , size_type                       x_count
+  , size_type                       y_count
+  , std::vector< INT_TYPE > const & src
+  , std::vector< INT_TYPE >       & trg
+ )
+  //
+  // The reference. Each cell becomes
+  //   src + round( rate_x * (lo + hi - 2 src) + rate_y * (side_a + side_b - 2 src))
+  // where an edge cell stands in for its missing neighbor. Both the change and the result
+  // saturate.
+{
+    typedef boost::int64_t  wide_type ;
+    int const        fraction_bit_count  = uniform_scalar< INT_TYPE >::fraction_bit_count;
+    wide_type const  half                = wide_type( 1) << (fraction_bit_count - 1);
+
+    trg.resize( src.size( ));
+    for ( size_type y = 0 ; y < y_count ; ++ y ) {
+        for ( size_type x = 0 ; x < x_count ; ++ x ) {
+            wide_type const  cell    = src[ (y * x_count) + x ];
+            wide_type const  lo      = (0 == x)             ? cell : src[ (y * x_count) + x - 1 ];
+            wide_type const  hi      = ((x + 1) == x_count) ? cell : src[ (y * x_count) + x + 1 ];
+            wide_type const  side_a  = (0 == y)             ? cell : src[ ((y - 1) * x_count) + x ];
+            wide_type const  side_b  = ((y + 1) == y_count) ? cell : src[ ((y + 1) * x_count) + x ];
+            wide_type const  sum     =
+                (rate_x * (lo + hi - (2 * cell))) + (rate_y * (side_a + side_b - (2 * cell))) + half;
+            INT_TYPE const   change  = clamp_inner< INT_TYPE >( sum >> fraction_bit_count);
+            trg[ (y * x_count) + x ] = clamp_inner< INT_TYPE >( cell + change);
+        }
+    }
+}
+
+  template< typename INT_TYPE >
+  std::vector< INT_TYPE >
+get_inner_values( value_sheet_type< uniform_scalar< INT_TYPE > > const & sheet)
+{
+    std::vector< INT_TYPE > values;
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        values.push_back( sheet.begin( )[ index ].get_inner( ));
+    }
+    return values;
+}
+
+  settable_input_params_type
+get_heat_input_params( int extra_pass_count, bool is_parallel)
+{
+    settable_input_params_type input_params  =
+        test::get_input_params( e_simultaneous_2d, e_forward_diff, 0.2f, 0.15f);
+    input_params.set__is_method_parallel( is_parallel);
+    input_params.set_extra_pass_count( extra_pass_count);
+    return input_params;
+}
+
+  void
+fill_float_sheet( sheet_type & sheet, size_type x_count, size_type y_count)
+{
+    d_verify( sheet.set_xy_counts( x_count, y_count, 0));
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        sheet.begin( )[ index ] = test::get_init_value< float >( index);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename INT_TYPE >
+  void
+check_fixed_solve_matches_cells( )
+{
+    typedef fixed_solver_type< INT_TYPE >           fixed_solver_type   ;
+    typedef typename fixed_solver_type::value_type  value_type          ;
+    typedef typename fixed_solver_type::sheet_type  fixed_sheet_type    ;
+    typedef typename fixed_solver_type::sheet_params_type
+                                                    fixed_params_type   ;
+
+    size_type const  size_cases[ ][ 2 ] = { { 1, 1 }, { 2, 3 }, { 1, 9 }, { 9, 1 }, { 17, 13 }, { 157, 93 } };
+    INT_TYPE const   rate_x  = value_type::convert_from_real( 0.2f);
+    INT_TYPE const   rate_y  = value_type::convert_from_real( 0.15f);
+
+    for ( std::size_t size_index = 0 ; size_index < (sizeof( size_cases) / sizeof( size_cases[ 0 ])) ; ++ size_index ) {
+        size_type const  x_count  = size_cases[ size_index ][ 0 ];
+        size_type const  y_count  = size_cases[ size_index ][ 1 ];
+        sheet_type float_src;
+        fill_float_sheet( float_src, x_count, y_count);
+
+        for ( int extra_pass_count = 0 ; extra_pass_count < 4 ; ++ extra_pass_count ) {
+            for ( int parallel_index = 0 ; parallel_index < 2 ; ++ parallel_index ) {
+                settable_input_params_type const  input_params  = get_heat_input_params( extra_pass_count, 0 != parallel_index);
+                test_check( fixed_solver_type::can_solve( input_params));
+
+                fixed_sheet_type src;
+                src.copy_from( float_src);
+                fixed_sheet_type trg;
+                d_verify( trg.set_xy_counts( x_count, y_count, value_type( 0)));
+                fixed_sheet_type extra;
+                d_verify( extra.set_xy_counts( x_count, y_count, value_type( 0)));
+                fixed_solver_type solver;
+                solver.calc_next( input_params, fixed_params_type( src, trg, extra, 0, 0));
+                output_params_type const & output_params = solver.get_output_params( );
+                test_check( static_cast< std::size_t >( extra_pass_count + 1) == output_params.get_solve_count( ));
+
+                // The last generation is in trg. After more than one pass the one before it is
+                // in extra.
+                std::vector< INT_TYPE > expected( get_inner_values( src));
+                std::vector< INT_TYPE > history;
+                for ( int pass = 0 ; pass <= extra_pass_count ; ++ pass ) {
+                    history.swap( expected);
+                    solve_one_generation( rate_x, rate_y, x_count, y_count, history, expected);
+                }
+                test_check( expected == get_inner_values( trg));
+                if ( extra_pass_count > 0 ) {
+                    test_check( output_params.is_last_solve_saved_in_extra( ));
+                    test_check( history == get_inner_values( extra));
+                }
+            }
+        }
+    }
+}
+
+  template< typename INT_TYPE >
+  double
+get_fixed_vs_float_difference( size_type generation_count)
+  //
+  // Solves generation_count generations in fixed point and in float, and returns the biggest
+  // difference between the two.
+{
+    typedef fixed_solver_type< INT_TYPE >           fixed_solver_type   ;
+    typedef typename fixed_solver_type::value_type  value_type          ;
+    typedef typename fixed_solver_type::sheet_type  fixed_sheet_type    ;
+    typedef typename fixed_solver_type::sheet_params_type
+                                                    fixed_params_type   ;
+
+    size_type const  x_count  = 301;
+    size_type const  y_count  = 203;
+    settable_input_params_type const  input_params  = get_heat_input_params( static_cast< int >( generation_count - 1), true);
+
+    sheet_type float_src;
+    fill_float_sheet( float_src, x_count, y_count);
+    fixed_sheet_type fixed_src;
+    fixed_src.copy_from( float_src);
+
+    sheet_type float_trg;
+    float_trg = float_src;
+    sheet_type float_extra;
+    solver_type float_solver;
+    float_solver.calc_next( input_params, sheet_params_type( float_src, float_trg, float_extra, 0, 0));
+
+    fixed_sheet_type fixed_trg;
+    d_verify( fixed_trg.set_xy_counts( x_count, y_count, value_type( 0)));
+    fixed_sheet_type fixed_extra;
+    fixed_solver_type fixed_solver;
+    fixed_solver.calc_next( input_params, fixed_params_type( fixed_src, fixed_trg, fixed_extra, 0, 0));
+
+    double max_difference = 0;
+    for ( size_type index = 0 ; index < float_trg.get_xy_count( ) ; ++ index ) {
+        max_difference =
+            std::max( max_difference, std::fabs( float_trg.begin( )[ index ] - to_real( fixed_trg.begin( )[ index ])));
+    }
+    return max_difference;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_uniform_scalar( )
+  //
+  // Conversions round to nearest, and the arithmetic saturates at the ends of [-1, +1).
+{
+    typedef uniform_scalar_16_type  scalar_type ;
+    double const  ulp  = std::ldexp( 1.0, -15);
+
+    // Every 16-bit value converts to real and back.
+    for ( boost::int32_t n = -32768 ; n <= 32767 ; ++ n ) {
+        scalar_type const  v  = scalar_type::from_inner( static_cast< boost::int16_t >( n));
+        if ( ! test_check( n == scalar_type( v.get_real( )).get_inner( )) ) return;
+    }
+
+    test_check(      1 == scalar_type( ulp * 0.51).get_inner( ));
+    test_check(      0 == scalar_type( ulp * 0.49).get_inner( ));
+    test_check(  32767 == scalar_type( 1.0).get_inner( ));
+    test_check( -32768 == scalar_type( -1.0).get_inner( ));
+    test_check( -32768 == scalar_type( -5.0).get_inner( ));
+
+    // The product rounds to nearest. Only (-1 * -1) saturates.
+    for ( boost::int32_t a = -32768 ; a <= 32767 ; a += 257 ) {
+        for ( boost::int32_t b = -32768 ; b <= 32767 ; b += 131 ) {
+            double const          exact     = std::floor( (double( a) * b / 32768.0) + 0.5);
+            boost::int16_t const  expected  = clamp_inner< boost::int16_t >( static_cast< boost::int64_t >( exact));
+            scalar_type const     product   =
+                scalar_type::from_inner( static_cast< boost::int16_t >( a)) * scalar_type::from_inner( static_cast< boost::int16_t >( b));
+            if ( ! test_check( expected == product.get_inner( )) ) return;
+        }
+    }
+    test_check( 32767 == (scalar_type( -1.0) * scalar_type( -1.0)).get_inner( ));
+
+    scalar_type const  biggest   = scalar_type::from_inner( 32767);
+    scalar_type const  smallest  = scalar_type::from_inner( -32768);
+    scalar_type const  one_ulp   = scalar_type::from_inner( 1);
+    test_check( biggest  == (biggest + one_ulp));
+    test_check( smallest == (smallest - one_ulp));
+    test_check( biggest  == (- smallest));
+    test_check( 0 == (biggest + smallest + one_ulp).get_inner( ));
+}
+
+  void
+test_fixed_solve_matches_cells( )
+  //
+  // The 16- and 32-bit solvers match the formula, to the bit, at odd and tiny sizes, for one to
+  // four passes, serial and parallel.
+{
+    check_fixed_solve_matches_cells< boost::int16_t >( );
+    check_fixed_solve_matches_cells< boost::int32_t >( );
+}
+
+  void
+test_fixed_solve_near_float( )
+  //
+  // After 20 generations the fixed-point sheets are still close to the float sheet. A 16-bit
+  // generation rounds to the nearest 2^-15, so it can drift by up to 2^-16 each generation.
+{
+    test_check( get_fixed_vs_float_difference< boost::int16_t >( 20) < (20 * std::ldexp( 1.0, -15)));
+    test_check( get_fixed_vs_float_difference< boost::int32_t >( 20) < 1e-6);
+}
+
+  void
+test_fixed_can_solve( )
+  //
+  // The fixed-point solvers only take insulated simultaneous-2d forward-diff heat, inside the
+  // stability limit.
+{
+    settable_input_params_type input_params = get_heat_input_params( 0, false);
+    test_check( fixed16_solver_type::can_solve( input_params));
+    test_check( fixed32_solver_type::can_solve( input_params));
+
+    input_params.set_rate_y( 0.3f);
+    test_check( ! fixed16_solver_type::can_solve( input_params));
+    test_check( ! fixed32_solver_type::can_solve( input_params));
+
+    input_params.set_rate_y( -0.1f);
+    test_check( ! fixed16_solver_type::can_solve( input_params));
+
+    input_params = get_heat_input_params( 0, false);
+    input_params.set_method( e_backward_diff);
+    test_check( ! fixed16_solver_type::can_solve( input_params));
+
+    input_params = get_heat_input_params( 0, false);
+    input_params.set_technique( e_ortho_interleave);
+    test_check( ! fixed32_solver_type::can_solve( input_params));
+
+    input_params = get_heat_input_params( 0, false);
+    input_params.set_boundary( e_boundary_periodic);
+    test_check( ! fixed16_solver_type::can_solve( input_params));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_uniform_scalar( "uniform_scalar"           , & test_uniform_scalar           );
+test::registrar_type const  register_matches_cells(  "fixed_solve_matches_cells", & test_fixed_solve_matches_cells);
+test::registrar_type const  register_near_float(     "fixed_solve_near_float"   , & test_fixed_solve_near_float   );
+test::registrar_type const  register_can_solve(      "fixed_can_solve"          , & test_fixed_can_solve          );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_fixed_point.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,349 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_free_run.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the free-running worker (see worker_thread_type::free_run(..) in heat_solver.cpp).
+//
+// A free run has to leave the sheets exactly as if sheet_control_type had asked for the same
+// solves one at a time, rotating its sheets after each one. So each test lets the worker free
+// run thru heat_solver::control_type, and then replays the same number of solves with a plain
+// solver_type and compares the bits.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <algorithm>
+# include <vector>
+# include "heat_solver.h"
+# include "draw_buffer.h"
+# include "date_time.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+// _______________________________________________________________________________________________
+
+  struct
+free_run_case_type
+{
+    technique_type  technique   ;
+    method_type     method      ;
+    int             pass_count  ;
+    double          damping     ;
+};
+
+free_run_case_type const  g_free_run_cases[ ] =
+ {  { e_simultaneous_2d  , e_forward_diff , 1, 1.00 }
+  , { e_simultaneous_2d  , e_forward_diff , 3, 1.00 }
+  , { e_ortho_interleave , e_backward_diff, 3, 1.00 }
+  , { e_wave_with_damping, e_forward_diff , 1, 0.05 }
+  , { e_wave_with_damping, e_forward_diff , 3, 0.05 }
+  , { e_wave_leapfrog    , e_forward_diff , 1, 0.05 }
+  , { e_wave_leapfrog    , e_forward_diff , 3, 0.05 }
+ };
+
+size_type const  g_x_count  = 120;
+size_type const  g_y_count  =  90;
+
+// _______________________________________________________________________________________________
+
+  struct
+start_sheets_type
+  //
+  // The sheets a free run starts with. The wave solves want a history in trg, and the leapfrog
+  // wave wants a velocity. The tests copy these with operator =, since sheet_type only
+  // copy-constructs empty sheets.
+{
+    sheet_type  src      ;
+    sheet_type  trg      ;
+    sheet_type  extra    ;
+    sheet_type  velocity ;
+
+    start_sheets_type( )
+      {
+        src     .set_xy_counts( g_x_count, g_y_count, 0);
+        trg     .set_xy_counts( g_x_count, g_y_count, 0);
+        extra   .set_xy_counts( g_x_count, g_y_count, 0);
+        velocity.set_xy_counts( g_x_count, g_y_count, 0);
+        for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+            double const x = static_cast< double >( index);
+            src.begin( )[ index ] = static_cast< float >( 0.60 * std::sin( x * 0.011) * std::cos( x * 0.29       ));
+            trg.begin( )[ index ] = static_cast< float >( 0.55 * std::sin( x * 0.011) * std::cos( x * 0.29 + 0.02));
+            velocity.begin( )[ index ] = src.begin( )[ index ] - trg.begin( )[ index ];
+        }
+      }
+};
+
+  bool
+is_same_sheet( sheet_type const & a, sheet_type const & b)
+{
+    return
+        (a.get_x_count( ) == b.get_x_count( )) &&
+        (a.get_y_count( ) == b.get_y_count( )) &&
+        test::is_same_bits(
+            std::vector< float >( a.begin( ), a.end( )),
+            std::vector< float >( b.begin( ), b.end( )));
+}
+
+  void
+set_control_params( control_type & control, free_run_case_type const & free_run_case)
+{
+    control.set_technique( free_run_case.technique);
+    control.set_method( free_run_case.method);
+    control.set_rates( 0.12f, 0.10f);
+    control.set_damping( free_run_case.damping);
+    control.set_pass_count( free_run_case.pass_count);
+    control.set__is_method_parallel( true);
+}
+
+// _______________________________________________________________________________________________
+
+  void
+check_against_one_at_a_time
+ (  free_run_case_type const &  free_run_case
+  , start_sheets_type  const &  start
+  , sheet_type         const &  trg
+  , sheet_type         const &  extra
+  , sheet_type         const &  velocity
+  , output_params_type const &  output_params
+ )
+  //
+  // Replays the free run one solve at a time, rotating the sheets the way
+  // sheet_control_type::after_solve( ) does, and checks that the free run ended up in the same
+  // place: the last generation in trg and the history (if any) in extra.
+{
+    size_type const  pass_count   = free_run_case.pass_count;
+    size_type const  solve_count  = output_params.get_solve_count( );
+    test_check( (solve_count > 0) && (0 == (solve_count % pass_count)));
+
+    bool const  is_leapfrog  = (e_wave_leapfrog == free_run_case.technique);
+
+    settable_input_params_type input_params;
+    input_params.set_technique( free_run_case.technique);
+    input_params.set_method( free_run_case.method);
+    input_params.set_rate_x( 0.12f);
+    input_params.set_rate_y( 0.10f);
+    input_params.set_damping( static_cast< rate_type >( free_run_case.damping));
+    input_params.set_extra_pass_count( pass_count - 1);
+    input_params.set__is_method_parallel( true);
+
+    sheet_type    current     ;  current    = start.src     ;
+    sheet_type    next        ;  next       = start.trg     ;
+    sheet_type    history     ;  history    = start.extra   ;
+    sheet_type    velocity_1  ;  velocity_1 = start.velocity;
+    sheet_type *  p_current   = & current     ;
+    sheet_type *  p_next      = & next        ;
+    sheet_type *  p_extra     = & history     ;
+
+    solver_type solver;
+    for ( size_type round = 0 ; round < (solve_count / pass_count) ; ++ round ) {
+        input_params.set__is_src_from_last_solve( round > 0);
+        solver.calc_next
+         (  input_params
+          , sheet_params_type( *p_current, *p_next, *p_extra, 0, is_leapfrog ? (& velocity_1) : 0)
+         );
+        std::swap( p_current, p_next);
+        if ( solver.get_output_params( ).is_last_solve_saved_in_extra( ) ) {
+            std::swap( p_extra, p_next);
+        }
+    }
+
+    test_check( is_same_sheet( trg, *p_current));
+    bool const is_history = ! solver.get_output_params( ).is_last_solve_not_saved( );
+    test_check( is_history == ! output_params.is_last_solve_not_saved( ));
+    if ( is_history && (solve_count > pass_count) ) {
+        test_check( output_params.is_last_solve_saved_in_extra( ));
+        test_check( is_same_sheet( extra, *p_next));
+    }
+    if ( is_leapfrog ) {
+        test_check( is_same_sheet( velocity, velocity_1));
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_free_run_matches_one_at_a_time( )
+  //
+  // A 30 ms free run solves many generations, and ends up where the same solves one at a time
+  // would. The master thread's src is never written. The last generation is published unless
+  // the free run published one less than a frame before.
+{
+    for ( std::size_t index = 0 ; index < (sizeof( g_free_run_cases) / sizeof( g_free_run_cases[ 0 ])) ; ++ index ) {
+        free_run_case_type const &  free_run_case  = g_free_run_cases[ index ];
+        bool const                  is_leapfrog    = (e_wave_leapfrog == free_run_case.technique);
+
+        start_sheets_type const  start;
+        sheet_type  src       ;  src      = start.src     ;
+        sheet_type  trg       ;  trg      = start.trg     ;
+        sheet_type  extra     ;  extra    = start.extra   ;
+        sheet_type  velocity  ;  velocity = start.velocity;
+
+        control_type control( 0);
+        set_control_params( control, free_run_case);
+        control.set_free_run_msecs( 30);
+
+        draw_buffer_type draw_buffer;
+        control.calc_next( src, trg, extra, 0, is_leapfrog ? (& velocity) : 0, & draw_buffer, false, false, true);
+        test::wait_for_signal( & control, SIGNAL( finished( )));
+
+        output_params_type const * const  p_output_params  = control.get_output_params( );
+        if ( ! test_check( 0 != p_output_params) ) continue;
+        size_type const  solve_count  = p_output_params->get_solve_count( );
+
+        test_check( solve_count > static_cast< size_type >( free_run_case.pass_count));
+        test_check( control.get_skipped_generation_count( ) < solve_count);
+        test_check( is_same_sheet( src, start.src));
+        if ( control.is_last_generation_published( ) ) {
+            test_check( is_same_sheet( draw_buffer.take_latest( ), trg));
+        } else {
+            test_check( ! is_same_sheet( draw_buffer.take_latest( ), trg));
+        }
+        check_against_one_at_a_time( free_run_case, start, trg, extra, velocity, *p_output_params);
+    }
+}
+
+  void
+test_free_run_off( )
+  //
+  // Without a free-run slice, without permission, or without a draw buffer to publish to, the
+  // worker solves once (all the passes) and reports back. Only the last pass is drawn.
+{
+    free_run_case_type const  free_run_case  = { e_simultaneous_2d, e_forward_diff, 3, 1.0 };
+    for ( int way = 0 ; way < 3 ; ++ way ) {
+        start_sheets_type const  start;
+        sheet_type  src    ;  src   = start.src  ;
+        sheet_type  trg    ;  trg   = start.trg  ;
+        sheet_type  extra  ;  extra = start.extra;
+
+        control_type control( 0);
+        set_control_params( control, free_run_case);
+        control.set_free_run_msecs( (0 == way) ? 0 : 30);
+
+        draw_buffer_type draw_buffer;
+        control.calc_next
+         (  src, trg, extra, 0, 0
+          , (2 == way) ? 0 : (& draw_buffer)
+          , false, false
+          , (1 != way) /* is_free_run_allowed */
+         );
+        test::wait_for_signal( & control, SIGNAL( finished( )));
+
+        output_params_type const * const  p_output_params  = control.get_output_params( );
+        if ( ! test_check( 0 != p_output_params) ) continue;
+        test_check( 3 == p_output_params->get_solve_count( ));
+        test_check( 2 == control.get_skipped_generation_count( ));
+        test_check( (2 != way) == control.is_last_generation_published( ));
+        check_against_one_at_a_time( free_run_case, start, trg, extra, sheet_type( ), *p_output_params);
+    }
+}
+
+  void
+test_free_run_stop( )
+  //
+  // request_free_run_stop( ) cuts a long free run short after the solve it's working on, and
+  // leaves the sheets as if that was the last solve all along.
+{
+    free_run_case_type const  free_run_case  = { e_wave_leapfrog, e_forward_diff, 1, 0.05 };
+    start_sheets_type const  start;
+    sheet_type  src       ;  src      = start.src     ;
+    sheet_type  trg       ;  trg      = start.trg     ;
+    sheet_type  extra     ;  extra    = start.extra   ;
+    sheet_type  velocity  ;  velocity = start.velocity;
+
+    control_type control( 0);
+    set_control_params( control, free_run_case);
+    control.set_free_run_msecs( 1000);
+
+    draw_buffer_type draw_buffer;
+    control.calc_next( src, trg, extra, 0, & velocity, & draw_buffer, false, false, true);
+    control.request_free_run_stop( );
+    test::wait_for_signal( & control, SIGNAL( finished( )));
+
+    output_params_type const * const  p_output_params  = control.get_output_params( );
+    if ( ! test_check( 0 != p_output_params) ) return;
+    check_against_one_at_a_time( free_run_case, start, trg, extra, velocity, *p_output_params);
+    test_check( control.get_last_duration__seconds( ) < 1.0);
+}
+
+  double
+get_seconds_since( tick_point_type tick)
+{
+    return date_time::convert_ticks_to_seconds( date_time::get_tick_now( ) - tick);
+}
+
+  void
+test_publish_at_frame_rate( )
+  //
+  // The worker does not publish the last generation if it published one less than a frame ago.
+  // The solves here are small and quick, so the second one comes right after the first.
+{
+    free_run_case_type const  free_run_case  = { e_simultaneous_2d, e_forward_diff, 1, 1.0 };
+    start_sheets_type const  start;
+    sheet_type  src    ;  src   = start.src  ;
+    sheet_type  trg    ;  trg   = start.trg  ;
+    sheet_type  extra  ;  extra = start.extra;
+
+    control_type control( 0);
+    set_control_params( control, free_run_case);
+    draw_buffer_type draw_buffer;
+
+    // The first solve always publishes.
+    tick_point_type const  first_start_tick  = date_time::get_tick_now( );
+    control.calc_next( src, trg, extra, 0, 0, & draw_buffer, false, false, false);
+    test::wait_for_signal( & control, SIGNAL( finished( )));
+    tick_point_type const  first_finish_tick  = date_time::get_tick_now( );
+    test_check( control.is_last_generation_published( ));
+    test_check( is_same_sheet( draw_buffer.take_latest( ), trg));
+    sheet_type first;
+    first = trg;
+
+    // Right away again. Skipped, unless this machine is too slow to tell.
+    src = trg;
+    control.calc_next( src, trg, extra, 0, 0, & draw_buffer, false, false, false);
+    test::wait_for_signal( & control, SIGNAL( finished( )));
+    if ( get_seconds_since( first_start_tick) < (1.0 / 60.0) ) {
+        test_check( ! control.is_last_generation_published( ));
+        test_check( is_same_sheet( draw_buffer.take_latest( ), first));
+    }
+
+    // After a frame it publishes again.
+    while ( get_seconds_since( first_finish_tick) < (1.5 / 60.0) ) { }
+    src = trg;
+    control.calc_next( src, trg, extra, 0, 0, & draw_buffer, false, false, false);
+    test::wait_for_signal( & control, SIGNAL( finished( )));
+    test_check( control.is_last_generation_published( ));
+    test_check( is_same_sheet( draw_buffer.take_latest( ), trg));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_matches( "free_run_matches"  , & test_free_run_matches_one_at_a_time);
+test::registrar_type const  register_off(     "free_run_off"      , & test_free_run_off                  );
+test::registrar_type const  register_stop(    "free_run_stop"     , & test_free_run_stop                 );
+test::registrar_type const  register_rate(    "publish_frame_rate", & test_publish_at_frame_rate         );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_free_run.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
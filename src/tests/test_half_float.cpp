@@ -0,0 +1,206 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_half_float.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for half_float_type (half_float.h) and the half-precision solver, half_solver_type.
+//
+// There are only 2^16 halves, so the conversions are checked at every one of them. The solver
+// is checked against the float solver, with the values rounded to half after every pass.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <cstring>
+# include <algorithm>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef half_float_type::bits_type  bits_type ;
+
+// _______________________________________________________________________________________________
+
+  bool
+is_nan_bits( bits_type bits)
+{
+    return (0x7c00u == (bits & 0x7c00u)) && (0 != (bits & 0x03ffu));
+}
+
+  float
+step_float( float f, int step)
+  //
+  // The float step ulps away from f (which must be finite and positive).
+{
+    boost::uint32_t f_bits = 0;
+    std::memcpy( & f_bits, & f, sizeof( f_bits));
+    f_bits += step;
+    std::memcpy( & f, & f_bits, sizeof( f));
+    return f;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_half_float_round_trip( )
+  //
+  // Every half converts to float and back to the same bits. NaNs stay NaN.
+{
+    for ( boost::uint32_t bits = 0 ; bits <= 0xffffu ; ++ bits ) {
+        bits_type const  half_bits  = static_cast< bits_type >( bits);
+        float const      f          = half_float_type::convert_to_float( half_bits);
+        if ( is_nan_bits( half_bits) ) {
+            if ( ! test_check( f != f) ) return;
+            if ( ! test_check( is_nan_bits( half_float_type::convert_from_float( f))) ) return;
+        } else {
+            if ( ! test_check( half_bits == half_float_type::convert_from_float( f)) ) return;
+        }
+    }
+}
+
+  void
+test_half_float_rounding( )
+  //
+  // A float between two neighboring halves rounds to the nearer one, and a tie rounds to the
+  // even one. Checked between every pair of finite halves, denormals included, and at the
+  // overflow to infinity.
+{
+    for ( bits_type bits = 0 ; bits < 0x7bffu ; ++ bits ) {
+        bits_type const  lo_bits    = bits;
+        bits_type const  hi_bits    = static_cast< bits_type >( bits + 1);
+        bits_type const  even_bits  = (0 == (bits & 1u)) ? lo_bits : hi_bits;
+
+        // Halves have 11 significant bits, so the midpoint is exact in float.
+        float const  mid  =
+            (half_float_type::convert_to_float( lo_bits) + half_float_type::convert_to_float( hi_bits)) / 2;
+        if ( ! test_check( even_bits == half_float_type::convert_from_float( mid)) ) return;
+        if ( ! test_check( lo_bits   == half_float_type::convert_from_float( step_float( mid, -1))) ) return;
+        if ( ! test_check( hi_bits   == half_float_type::convert_from_float( step_float( mid, +1))) ) return;
+
+        // Negatives are the same with the sign bit set.
+        if ( ! test_check( (0x8000u | even_bits) == half_float_type::convert_from_float( - mid)) ) return;
+    }
+
+    // 65504 is the biggest half. 65520 is half way to the next step up, and rounds to infinity.
+    test_check( 0x7bffu == half_float_type::convert_from_float( step_float( 65520.0f, -1)));
+    test_check( 0x7c00u == half_float_type::convert_from_float( 65520.0f));
+    test_check( 0xfc00u == half_float_type::convert_from_float( -1e10f));
+
+    // Anything under 2^-25 (half the smallest denormal) is zero.
+    test_check( 0x0001u == half_float_type::convert_from_float( step_float( std::ldexp( 1.0f, -25), +1)));
+    test_check( 0x0000u == half_float_type::convert_from_float( std::ldexp( 1.0f, -25)));
+    test_check( 0x0000u == half_float_type::convert_from_float( 1e-30f));
+}
+
+  void
+test_half_solve_matches_float( )
+  //
+  // A half solve gives the same bits as a float solve rounded to half after every pass. Odd
+  // and tiny sizes, one and three passes, serial and parallel.
+{
+    int const  size_cases[ ][ 2 ] = { { 1, 1 }, { 2, 3 }, { 1, 9 }, { 9, 1 }, { 17, 13 }, { 64, 5 }, { 157, 93 } };
+
+    for ( std::size_t size_index = 0 ; size_index < (sizeof( size_cases) / sizeof( size_cases[ 0 ])) ; ++ size_index ) {
+        int const  x_count  = size_cases[ size_index ][ 0 ];
+        int const  y_count  = size_cases[ size_index ][ 1 ];
+        for ( int extra_pass_count = 0 ; extra_pass_count < 3 ; extra_pass_count += 2 ) {
+            for ( int parallel_index = 0 ; parallel_index < 2 ; ++ parallel_index ) {
+                settable_input_params_type input_params;
+                input_params.set_technique( e_simultaneous_2d);
+                input_params.set_method( e_forward_diff);
+                input_params.set_rate_x( 0.2f);
+                input_params.set_rate_y( 0.15f);
+                input_params.set__is_method_parallel( 0 != parallel_index);
+                input_params.set_extra_pass_count( extra_pass_count);
+                input_params.set_precision( e_half_precision);
+                test_check( half_solver_type::can_solve( input_params));
+
+                half_sheet_type half_src;
+                d_verify( half_src.set_xy_counts( x_count, y_count, half_float_type( 0)));
+                for ( int index = 0 ; index < (x_count * y_count) ; ++ index ) {
+                    half_src.begin( )[ index ] = half_float_type( test::get_init_value< double >( index));
+                }
+
+                // The float solve, one pass at a time.
+                settable_input_params_type float_input_params = input_params;
+                float_input_params.set_extra_pass_count( 0);
+                float_input_params.set_precision( e_single_precision);
+                sheet_type float_src;
+                half_src.copy_to( float_src);
+                sheet_type float_trg;
+                float_trg = float_src;
+                sheet_type float_extra;
+                solver_type float_solver;
+                for ( int pass = 0 ; pass <= extra_pass_count ; ++ pass ) {
+                    float_solver.calc_next( float_input_params, sheet_params_type( float_src, float_trg, float_extra, 0, 0));
+                    half_sheet_type rounded;
+                    rounded.copy_from( float_trg);
+                    rounded.copy_to( float_src);
+                }
+
+                // The half solve, all passes at once.
+                half_sheet_type half_trg;
+                d_verify( half_trg.set_xy_counts( x_count, y_count, half_float_type( 0)));
+                half_sheet_type half_extra;
+                d_verify( half_extra.set_xy_counts( x_count, y_count, half_float_type( 0)));
+                half_solver_type half_solver;
+                half_solver.calc_next( input_params, half_solver_type::sheet_params_type( half_src, half_trg, half_extra, 0, 0));
+
+                test_check( static_cast< std::size_t >( extra_pass_count + 1) == half_solver.get_output_params( ).get_solve_count( ));
+                test_check( half_trg.is_rounded_same( float_src));
+            }
+        }
+    }
+}
+
+  void
+test_half_can_solve( )
+  //
+  // The half solver only takes forward-diff heat inside the stability limit.
+{
+    settable_input_params_type input_params;
+    input_params.set_technique( e_simultaneous_2d);
+    input_params.set_method( e_forward_diff);
+    input_params.set_rate_x( 0.2f);
+    input_params.set_rate_y( 0.25f);
+    test_check( half_solver_type::can_solve( input_params));
+
+    input_params.set_rate_y( 0.3f);
+    test_check( ! half_solver_type::can_solve( input_params));
+
+    input_params.set_rate_y( 0.25f);
+    input_params.set_method( e_central_diff);
+    test_check( ! half_solver_type::can_solve( input_params));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_round_trip(   "half_float_round_trip"   , & test_half_float_round_trip   );
+test::registrar_type const  register_rounding(     "half_float_rounding"     , & test_half_float_rounding     );
+test::registrar_type const  register_solve(        "half_solve_matches_float", & test_half_solve_matches_float);
+test::registrar_type const  register_can_solve(    "half_can_solve"          , & test_half_can_solve          );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_half_float.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,359 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_leapfrog.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the leapfrog wave (see "Leapfrog wave" in finite_diff.h).
+//
+// The vector kernel is checked against the scalar kernel in test_simd_kernels.cpp, and the free
+// run in test_free_run.cpp. Here we check the solves:
+//   The leapfrog wave follows the damped wave, which keeps its history in trg, for each stencil
+//   and boundary, with and without the conductivity map.
+//   The velocity is the step the last generation took, and is zero on fixed edges.
+//   One solve of many passes gives the same bits as many solves of one pass.
+//   The leapfrog never reads trg or extra, so they do not have to hold the history.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+boundary_type const  g_boundaries[ ] =
+ {  e_boundary_insulated, e_boundary_fixed, e_boundary_periodic, e_boundary_absorbing };
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+init_sheets
+ (  long          x_count
+  , long          y_count
+  , SHEET_TYPE &  current    // out
+  , SHEET_TYPE &  previous   // out, the generation before current
+  , SHEET_TYPE &  velocity   // out, current minus previous
+ )
+{
+    d_verify( current .set_xy_counts( x_count, y_count, 0));
+    d_verify( previous.set_xy_counts( x_count, y_count, 0));
+    d_verify( velocity.set_xy_counts( x_count, y_count, 0));
+    typedef typename SHEET_TYPE::value_type  value_type ;
+    for ( size_type index = 0 ; index < current.get_xy_count( ) ; ++ index ) {
+        current .begin( )[ index ] =
+            static_cast< value_type >( 0.6  * std::sin( index * 0.011) * std::cos( index * 0.29));
+        previous.begin( )[ index ] =
+            static_cast< value_type >( 0.55 * std::sin( index * 0.011) * std::cos( (index * 0.29) + 0.02));
+        velocity.begin( )[ index ] = current.begin( )[ index ] - previous.begin( )[ index ];
+    }
+}
+
+  template< typename SHEET_TYPE >
+  void
+fill_noise( SHEET_TYPE & sheet)
+{
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        sheet.begin( )[ index ] = static_cast< typename SHEET_TYPE::value_type >( std::sin( index * 1.7) * 3);
+    }
+}
+
+  void
+set_input_params
+ (  settable_input_params_type &  input_params   // out
+  , technique_type                technique
+  , method_type                   method
+  , boundary_type                 boundary
+  , bool                          is_parallel
+  , size_type                     pass_count
+  , float                         damping      = 0.02f
+ )
+{
+    input_params.set_technique( technique);
+    input_params.set_method( method);
+    input_params.set_boundary( boundary);
+    input_params.set_rate_x( 0.12f);
+    input_params.set_rate_y( 0.1f);
+    input_params.set_damping( damping);
+    input_params.set__is_method_parallel( is_parallel);
+    input_params.set_extra_pass_count( pass_count - 1);
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  void
+solve_generations
+ (  settable_input_params_type &     input_params
+  , size_type                        generation_count
+  , conductivity_sheet_type const *  p_conductivity_sheet
+  , SHEET_TYPE                    *  p_velocity            // zero for the damped wave
+  , SHEET_TYPE                    *& p_current             // in/out
+  , SHEET_TYPE                    *& p_next                // in/out, the damped wave's history
+  , SHEET_TYPE                    *& p_extra               // in/out
+ )
+  //
+  // Moves the sheets around the way sheet_control_type does after each solve.
+{
+    SOLVER_TYPE solver;
+    for ( size_type generation = 0 ; generation < generation_count ; ++ generation ) {
+        input_params.set__is_src_from_last_solve( generation > 0);
+        solver.calc_next
+         (  input_params
+          , typename SOLVER_TYPE::sheet_params_type
+             ( *p_current, *p_next, *p_extra, p_conductivity_sheet, p_velocity)
+         );
+        std::swap( p_current, p_next);
+        if ( solver.get_output_params( ).is_last_solve_saved_in_extra( ) ) {
+            std::swap( p_next, p_extra);
+        }
+    }
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  bool
+check_leapfrog_matches_wave
+ (  method_type                      method
+  , boundary_type                    boundary
+  , long                             x_count
+  , long                             y_count
+  , size_type                        pass_count
+  , float                            damping
+  , conductivity_sheet_type const *  p_conductivity_sheet
+  , double                           tolerance
+ )
+  //
+  // The serial and parallel leapfrog solves give the same bits, and follow the damped wave.
+{
+    size_type const  generation_count  = 40;
+
+    SHEET_TYPE wave_sheets[ 3 ];
+    SHEET_TYPE unused_velocity;
+    init_sheets( x_count, y_count, wave_sheets[ 0 ], wave_sheets[ 1 ], unused_velocity);
+    SHEET_TYPE * p_current  = & wave_sheets[ 0 ];
+    SHEET_TYPE * p_next     = & wave_sheets[ 1 ];
+    SHEET_TYPE * p_extra    = & wave_sheets[ 2 ];
+    settable_input_params_type input_params;
+    set_input_params( input_params, e_wave_with_damping, method, boundary, false, pass_count, damping);
+    solve_generations< SHEET_TYPE, SOLVER_TYPE >
+     ( input_params, generation_count, p_conductivity_sheet, 0, p_current, p_next, p_extra);
+    SHEET_TYPE const &  wave_result  = *p_current;
+
+    SHEET_TYPE leapfrog_results[ 2 ];
+    for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+        SHEET_TYPE leapfrog_sheets[ 3 ];
+        SHEET_TYPE velocity;
+        init_sheets( x_count, y_count, leapfrog_sheets[ 0 ], leapfrog_sheets[ 1 ], velocity);
+        p_current  = & leapfrog_sheets[ 0 ];
+        p_next     = & leapfrog_sheets[ 1 ];
+        p_extra    = & leapfrog_sheets[ 2 ];
+        set_input_params( input_params, e_wave_leapfrog, method, boundary, 0 != is_parallel, pass_count, damping);
+        solve_generations< SHEET_TYPE, SOLVER_TYPE >
+         ( input_params, generation_count, p_conductivity_sheet, & velocity, p_current, p_next, p_extra);
+        leapfrog_results[ is_parallel ] = *p_current;
+    }
+
+    return
+        (test::get_max_difference( wave_result, leapfrog_results[ 0 ]) < tolerance) &&
+        (0 == test::get_max_difference( leapfrog_results[ 0 ], leapfrog_results[ 1 ]));
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_leapfrog_matches_wave( )
+  //
+  // The leapfrog does the damped wave's arithmetic, so the two only differ by rounding, in float
+  // and in double. Damping under 0.3 clamps (see get_clamp_limit(..)), so we try both sides.
+{
+    long const  sizes[ ][ 2 ] = { { 157, 93 }, { 1, 9 }, { 9, 1 }, { 2, 5 }, { 3, 3 }, { 40, 70 } };
+    method_type const  methods[ ] = { e_forward_diff, e_forward_diff_9_point, e_forward_diff_4th_order };
+    size_type const  pass_counts[ ] = { 1, 2, 3 };
+    float const  dampings[ ] = { 0.02f, 0.4f };
+
+    for ( std::size_t s = 0 ; s < (sizeof( sizes) / sizeof( sizes[ 0 ])) ; ++ s ) {
+      long const  x_count  = sizes[ s ][ 0 ];
+      long const  y_count  = sizes[ s ][ 1 ];
+      conductivity_sheet_type conductivity_sheet;
+      d_verify( conductivity_sheet.set_xy_counts( x_count, y_count, 1.0f));
+      for ( size_type index = 0 ; index < conductivity_sheet.get_xy_count( ) ; ++ index ) {
+          conductivity_sheet.begin( )[ index ] = (0 == ((index / 5) % 3)) ? 1.0f : 0.3f;
+      }
+
+      for ( std::size_t m = 0 ; m < (sizeof( methods) / sizeof( methods[ 0 ])) ; ++ m ) {
+        for ( std::size_t b = 0 ; b < (sizeof( g_boundaries) / sizeof( g_boundaries[ 0 ])) ; ++ b ) {
+          for ( std::size_t p = 0 ; p < (sizeof( pass_counts) / sizeof( pass_counts[ 0 ])) ; ++ p ) {
+            // The map only works with the 5-point stencil.
+            for ( int is_mapped = 0 ; is_mapped < ((e_forward_diff == methods[ m ]) ? 2 : 1) ; ++ is_mapped ) {
+              for ( std::size_t d = 0 ; d < (sizeof( dampings) / sizeof( dampings[ 0 ])) ; ++ d ) {
+                conductivity_sheet_type const * const  p_conductivity_sheet  =
+                    is_mapped ? (& conductivity_sheet) : 0;
+                bool const  is_float_ok  =
+                    check_leapfrog_matches_wave< sheet_type, solver_type >
+                     (  methods[ m ], g_boundaries[ b ], x_count, y_count, pass_counts[ p ], dampings[ d ]
+                      , p_conductivity_sheet, 2e-5
+                     );
+                bool const  is_double_ok  =
+                    check_leapfrog_matches_wave< double_sheet_type, double_solver_type >
+                     (  methods[ m ], g_boundaries[ b ], x_count, y_count, pass_counts[ p ], dampings[ d ]
+                      , p_conductivity_sheet, 1e-12
+                     );
+                if ( ! test_check( is_float_ok && is_double_ok) ) {
+                    std::fprintf( stderr, "  method %d, boundary %d, %ldx%ld, %d passes, damping %g%s\n",
+                        static_cast< int >( methods[ m ]), static_cast< int >( g_boundaries[ b ]),
+                        x_count, y_count, static_cast< int >( pass_counts[ p ]), double( dampings[ d ]),
+                        is_mapped ? ", mapped" : "");
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+}
+
+  void
+test_leapfrog_velocity( )
+  //
+  // After each one-pass solve the velocity is the step from the last generation (to float
+  // rounding), and is exactly zero on fixed edges. Solving three passes at once gives the same
+  // sheet and velocity bits as three one-pass solves.
+{
+    long const  x_count  = 53;
+    long const  y_count  = 31;
+
+    for ( std::size_t b = 0 ; b < (sizeof( g_boundaries) / sizeof( g_boundaries[ 0 ])) ; ++ b ) {
+        boundary_type const  boundary  = g_boundaries[ b ];
+        sheet_type sheets[ 3 ];
+        sheet_type velocity;
+        init_sheets( x_count, y_count, sheets[ 0 ], sheets[ 1 ], velocity);
+        sheet_type * p_current  = & sheets[ 0 ];
+        sheet_type * p_next     = & sheets[ 1 ];
+        sheet_type * p_extra    = & sheets[ 2 ];
+        settable_input_params_type input_params;
+        set_input_params( input_params, e_wave_leapfrog, e_forward_diff, boundary, false, 1);
+
+        double max_error    = 0;
+        float  max_fixed_v  = 0;
+        for ( int generation = 0 ; generation < 30 ; ++ generation ) {
+            sheet_type previous;
+            previous = *p_current;
+            solve_generations< sheet_type, solver_type >
+             ( input_params, 1, 0, & velocity, p_current, p_next, p_extra);
+            for ( long y = 0 ; y < y_count ; ++ y ) {
+                for ( long x = 0 ; x < x_count ; ++ x ) {
+                    long  const  index  = (y * x_count) + x;
+                    float const  step   = p_current->begin( )[ index ] - previous.begin( )[ index ];
+                    max_error = std::max( max_error, std::fabs( double( velocity.begin( )[ index ]) - step));
+                    if ( (0 == x) || ((x_count - 1) == x) || (0 == y) || ((y_count - 1) == y) ) {
+                        max_fixed_v = std::max( max_fixed_v, std::fabs( velocity.begin( )[ index ]));
+                    }
+                }
+            }
+        }
+        bool const  is_fixed_ok  = (e_boundary_fixed != boundary) || (0 == max_fixed_v);
+
+        sheet_type three_sheets[ 3 ];
+        sheet_type three_velocity;
+        init_sheets( x_count, y_count, three_sheets[ 0 ], three_sheets[ 1 ], three_velocity);
+        sheet_type * p_three_current  = & three_sheets[ 0 ];
+        sheet_type * p_three_next     = & three_sheets[ 1 ];
+        sheet_type * p_three_extra    = & three_sheets[ 2 ];
+        set_input_params( input_params, e_wave_leapfrog, e_forward_diff, boundary, false, 3);
+        solve_generations< sheet_type, solver_type >
+         ( input_params, 10, 0, & three_velocity, p_three_current, p_three_next, p_three_extra);
+        bool const  is_passes_ok  =
+            (0 == test::get_max_difference( *p_current, *p_three_current)) &&
+            (0 == test::get_max_difference( velocity, three_velocity));
+
+        if ( ! test_check( (max_error < 1e-7) && is_fixed_ok && is_passes_ok) ) {
+            std::fprintf( stderr, "  boundary %d, velocity error %g, fixed velocity %g, passes %s\n",
+                static_cast< int >( boundary), max_error, double( max_fixed_v),
+                is_passes_ok ? "ok" : "differ");
+        }
+    }
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  bool
+check_leapfrog_ignores_trg( size_type pass_count, bool is_parallel)
+{
+    long const  x_count  = 47;
+    long const  y_count  = 35;
+
+    SHEET_TYPE results[ 2 ];
+    SHEET_TYPE velocities[ 2 ];
+    for ( int is_noisy = 0 ; is_noisy < 2 ; ++ is_noisy ) {
+        SHEET_TYPE sheets[ 3 ];
+        init_sheets( x_count, y_count, sheets[ 0 ], sheets[ 1 ], velocities[ is_noisy ]);
+        if ( is_noisy ) {
+            fill_noise( sheets[ 1 ]);
+            d_verify( sheets[ 2 ].set_xy_counts( x_count, y_count, 0));
+            fill_noise( sheets[ 2 ]);
+        }
+        SHEET_TYPE * p_current  = & sheets[ 0 ];
+        SHEET_TYPE * p_next     = & sheets[ 1 ];
+        SHEET_TYPE * p_extra    = & sheets[ 2 ];
+        settable_input_params_type input_params;
+        set_input_params( input_params, e_wave_leapfrog, e_forward_diff, e_boundary_insulated, is_parallel, pass_count);
+        solve_generations< SHEET_TYPE, SOLVER_TYPE >
+         ( input_params, 5, 0, & velocities[ is_noisy ], p_current, p_next, p_extra);
+        results[ is_noisy ] = *p_current;
+    }
+    return
+        (0 == test::get_max_difference( results[ 0 ], results[ 1 ])) &&
+        (0 == test::get_max_difference( velocities[ 0 ], velocities[ 1 ]));
+}
+
+  void
+test_leapfrog_ignores_trg( )
+  //
+  // The damped wave reads the generation before src from trg, and sets up the extra sheet for
+  // multi-pass solves. The leapfrog reads only src and the velocity, so noise in trg and extra
+  // changes nothing.
+{
+    for ( size_type pass_count = 1 ; pass_count <= 4 ; ++ pass_count ) {
+        for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+            bool const  is_float_ok   =
+                check_leapfrog_ignores_trg< sheet_type, solver_type >( pass_count, 0 != is_parallel);
+            bool const  is_double_ok  =
+                check_leapfrog_ignores_trg< double_sheet_type, double_solver_type >( pass_count, 0 != is_parallel);
+            if ( ! test_check( is_float_ok && is_double_ok) ) {
+                std::fprintf( stderr, "  %d passes, %s\n",
+                    static_cast< int >( pass_count), is_parallel ? "parallel" : "serial");
+            }
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_matches(  "leapfrog_matches_wave", & test_leapfrog_matches_wave);
+test::registrar_type const  register_velocity( "leapfrog_velocity"    , & test_leapfrog_velocity    );
+test::registrar_type const  register_ignores(  "leapfrog_ignores_trg" , & test_leapfrog_ignores_trg );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_leapfrog.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,141 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_main.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Runs the tests registered by the test_*.cpp files (see test_util.h).
+//
+//   heat_tests              -- runs every test
+//   heat_tests name ...     -- runs the named tests
+//
+// The main thread gets a row pool as its current pool, like the solver's worker thread.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cstdio>
+# include <cstring>
+# include <vector>
+# include <QtCore/QCoreApplication>
+# include <QtCore/QEventLoop>
+# include "row_pool.h"
+# include "test_util.h"
+
+namespace test {
+
+// _______________________________________________________________________________________________
+
+namespace /* anonymous */ {
+
+  struct
+registered_test_type
+{
+    char const *        p_name     ;
+    test_function_type  p_function ;
+};
+
+  std::vector< registered_test_type > &
+ref_registered_tests( )
+  //
+  // A function-local static, so it's built before the first registrar_type ctor uses it.
+{
+    static std::vector< registered_test_type > tests;
+    return tests;
+}
+
+int  g_failed_check_count = 0;
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+
+registrar_type::
+registrar_type( char const * p_name, test_function_type p_function)
+{
+    registered_test_type const test = { p_name, p_function };
+    ref_registered_tests( ).push_back( test);
+}
+
+  bool
+check( bool is_ok, char const * p_file, int line, char const * p_expression)
+{
+    if ( ! is_ok ) {
+        ++ g_failed_check_count;
+        std::fprintf( stderr, "%s(%d): check failed: %s\n", p_file, line, p_expression);
+    }
+    return is_ok;
+}
+
+  void
+wait_for_signal( QObject const * p_sender, char const * p_signal)
+{
+    QEventLoop loop;
+    d_verify( QObject::connect( p_sender, p_signal, & loop, SLOT( quit( ))));
+    loop.exec( );
+}
+
+// _______________________________________________________________________________________________
+
+namespace /* anonymous */ {
+
+  bool
+is_named( char const * p_name, int arg_count, char * * pp_args)
+{
+    if ( arg_count <= 1 ) return true;
+    for ( int index = 1 ; index < arg_count ; ++ index ) {
+        if ( 0 == std::strcmp( p_name, pp_args[ index ]) ) return true;
+    }
+    return false;
+}
+
+} /* end anonymous namespace */
+
+} /* end namespace test */
+
+// _______________________________________________________________________________________________
+
+  int
+main( int arg_count, char * * pp_args)
+{
+    QCoreApplication app( arg_count, pp_args);
+
+    row_pool::pool_type                       pool( 0);
+    row_pool::scoped_current_pool_type const  use_pool( & pool);
+
+    std::vector< test::registered_test_type > const & tests = test::ref_registered_tests( );
+    int failed_test_count = 0;
+    int run_test_count    = 0;
+    for ( std::size_t index = 0 ; index < tests.size( ) ; ++ index ) {
+        if ( ! test::is_named( tests[ index ].p_name, arg_count, pp_args) ) continue;
+
+        int const failed_before = test::g_failed_check_count;
+        tests[ index ].p_function( );
+        bool const is_ok = (failed_before == test::g_failed_check_count);
+
+        ++ run_test_count;
+        if ( ! is_ok ) { ++ failed_test_count; }
+        std::printf( "%-24s %s\n", tests[ index ].p_name, is_ok ? "ok" : "FAILED");
+    }
+
+    std::printf( "%d of %d tests failed\n", failed_test_count, run_test_count);
+    return (0 == failed_test_count) ? 0 : 1;
+}
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_main.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
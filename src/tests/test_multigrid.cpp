@@ -0,0 +1,225 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_multigrid.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the multigrid solve of the implicit heat step (multigrid.h, and the
+// e_implicit_multigrid technique in heat_solver.cpp).
+//
+// With insulated edges every product of cosines
+//   cos( pi * kx * (x + 1/2) / x_count) * cos( pi * ky * (y + 1/2) / y_count)
+// is an eigenvector of the 2D operator, so one implicit step just scales it. That gives us an
+// exact answer to check the whole technique against.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <algorithm>
+# include "heat_solver.h"
+# include "multigrid.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef double_sheet_type::size_type  size_type ;
+
+// _______________________________________________________________________________________________
+
+  struct
+size_case_type
+{
+    size_type  x_count ;
+    size_type  y_count ;
+};
+
+// Odd sizes, a long thin sheet, and sizes that aren't close to a power of 2.
+size_case_type const  g_size_cases[ ] =
+ {  {   2,   2 }
+  , {   7,   5 }
+  , {  64,  48 }
+  , { 129, 100 }
+  , { 300,   3 }
+  , { 257, 257 }
+ };
+
+// Forward diff is only stable up to about 0.25, so these are up to 200x past that.
+double const  g_rates[ ] = { 0.2, 5.0, 50.0 };
+
+  double
+get_max_residual
+ (  double_sheet_type const &  u
+  , double_sheet_type const &  f
+  , double                     rate_x
+  , double                     rate_y
+ )
+  //
+  // max | f - (u - (rate_x * Dxx u) - (rate_y * Dyy u)) |, worked out cell by cell.
+{
+    size_type const  x_count  = u.get_x_count( );
+    size_type const  y_count  = u.get_y_count( );
+    double max_residual = 0;
+    for ( size_type y = 0 ; y < y_count ; ++ y ) {
+        for ( size_type x = 0 ; x < x_count ; ++ x ) {
+            double const  center  = u.begin( )[ (y * x_count) + x ];
+            double const  lo_x    = (x > 0)             ? u.begin( )[ (y * x_count) + x - 1 ] : center;
+            double const  hi_x    = ((x + 1) < x_count) ? u.begin( )[ (y * x_count) + x + 1 ] : center;
+            double const  lo_y    = (y > 0)             ? u.begin( )[ ((y - 1) * x_count) + x ] : center;
+            double const  hi_y    = ((y + 1) < y_count) ? u.begin( )[ ((y + 1) * x_count) + x ] : center;
+            double const  a_u     =
+                center - (rate_x * (lo_x + hi_x - (2 * center))) - (rate_y * (lo_y + hi_y - (2 * center)));
+            max_residual = std::max( max_residual, std::fabs( f.begin( )[ (y * x_count) + x ] - a_u));
+        }
+    }
+    return max_residual;
+}
+
+  void
+fill_rough( double_sheet_type & sheet, size_type x_count, size_type y_count)
+  //
+  // Values with detail at every scale, so every level of the V-cycle has work to do.
+{
+    d_verify( sheet.set_xy_counts( x_count, y_count, 0));
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        double const i = static_cast< double >( index);
+        sheet.begin( )[ index ] = std::sin( i * 0.7) + (0.5 * std::cos( i * 0.013)) + (((index * 7919) % 13) / 13.0);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_multigrid_converges( )
+  //
+  // The V-cycles bring the residual down to rounding noise, at every size and rate, and the
+  // number of cycles doesn't grow with the size of the sheet.
+{
+    typedef multigrid::v_cycle_type< double_sheet_type >  v_cycle_type ;
+
+    v_cycle_type v_cycle;
+    for ( std::size_t size_index = 0 ; size_index < (sizeof( g_size_cases) / sizeof( g_size_cases[ 0 ])) ; ++ size_index ) {
+        size_case_type const &  size_case  = g_size_cases[ size_index ];
+        for ( std::size_t rate_index = 0 ; rate_index < (sizeof( g_rates) / sizeof( g_rates[ 0 ])) ; ++ rate_index ) {
+            double const  rate_x  = g_rates[ rate_index ];
+            double const  rate_y  = g_rates[ rate_index ] * 0.75;
+
+            double_sheet_type rhs;
+            fill_rough( rhs, size_case.x_count, size_case.y_count);
+            double_sheet_type u;
+            u = rhs;
+
+            bool const  is_early_exit  = false;
+            size_type const  cycle_count  = v_cycle.solve( is_early_exit, false, rate_x, rate_y, rhs, u);
+            test_check( (cycle_count > 0) && (cycle_count <= 12));
+            test_check( get_max_residual( u, rhs, rate_x, rate_y) < (1e-11 * (1 + rate_x + rate_y)));
+        }
+    }
+}
+
+  void
+test_multigrid_parallel( )
+  //
+  // Splitting the red-black sweeps across threads gives the same bits as one thread.
+{
+    typedef multigrid::v_cycle_type< double_sheet_type >  v_cycle_type ;
+
+    double_sheet_type rhs;
+    fill_rough( rhs, 211, 150);
+    double_sheet_type serial_u;
+    serial_u = rhs;
+    double_sheet_type parallel_u;
+    parallel_u = rhs;
+
+    bool const  is_early_exit  = false;
+    v_cycle_type serial_v_cycle;
+    v_cycle_type parallel_v_cycle;
+    test_check( serial_v_cycle.solve( is_early_exit, false, 20.0, 20.0, rhs, serial_u) ==
+                parallel_v_cycle.solve( is_early_exit, true, 20.0, 20.0, rhs, parallel_u));
+    test_check( std::equal( serial_u.begin( ), serial_u.end( ), parallel_u.begin( )));
+}
+
+  void
+test_multigrid_technique( )
+  //
+  // One e_implicit_multigrid solve scales a cosine mode by the exact gain, at rates far past
+  // where forward diff blows up.
+{
+    size_type const  x_count  = 96;
+    size_type const  y_count  = 80;
+    double const     pi       = std::acos( -1.0);
+
+    for ( int mode = 1 ; mode < 12 ; mode += 5 ) {
+        for ( std::size_t rate_index = 0 ; rate_index < (sizeof( g_rates) / sizeof( g_rates[ 0 ])) ; ++ rate_index ) {
+            for ( int method_index = 0 ; method_index < 2 ; ++ method_index ) {
+                method_type const  method  = (0 == method_index) ? e_backward_diff : e_central_diff;
+                double const       rate_x  = g_rates[ rate_index ];
+                double const       rate_y  = g_rates[ rate_index ] / 2;
+
+                double_sheet_type src;
+                d_verify( src.set_xy_counts( x_count, y_count, 0));
+                for ( size_type y = 0 ; y < y_count ; ++ y ) {
+                    for ( size_type x = 0 ; x < x_count ; ++ x ) {
+                        src.begin( )[ (y * x_count) + x ] =
+                            std::cos( pi * mode * (x + 0.5) / x_count) *
+                            std::cos( pi * (mode + 1) * (y + 0.5) / y_count);
+                    }
+                }
+
+                settable_input_params_type input_params;
+                input_params.set_technique( e_implicit_multigrid);
+                input_params.set_method( method);
+                input_params.set_rate_x( static_cast< rate_type >( rate_x));
+                input_params.set_rate_y( static_cast< rate_type >( rate_y));
+
+                double_sheet_type trg;
+                d_verify( trg.set_xy_counts( x_count, y_count, 0));
+                double_sheet_type extra;
+                double_solver_type solver;
+                solver.calc_next( input_params, double_sheet_params_type( src, trg, extra, 0, 0));
+
+                // The rates go thru rate_type (float) on the way in.
+                double const  x_eigen  = 4 * std::pow( std::sin( pi * mode       / (2.0 * x_count)), 2);
+                double const  y_eigen  = 4 * std::pow( std::sin( pi * (mode + 1) / (2.0 * y_count)), 2);
+                double const  decay    =
+                    (static_cast< rate_type >( rate_x) * x_eigen) + (static_cast< rate_type >( rate_y) * y_eigen);
+                double const  gain     =
+                    (e_backward_diff == method) ? (1 / (1 + decay)) : ((1 - (decay / 2)) / (1 + (decay / 2)));
+
+                double max_error = 0;
+                for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+                    max_error = std::max( max_error, std::fabs( trg.begin( )[ index ] - (gain * src.begin( )[ index ])));
+                }
+                test_check( max_error < 1e-9);
+            }
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_converges( "multigrid_converges", & test_multigrid_converges);
+test::registrar_type const  register_parallel(  "multigrid_parallel" , & test_multigrid_parallel );
+test::registrar_type const  register_technique( "multigrid_technique", & test_multigrid_technique);
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_multigrid.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
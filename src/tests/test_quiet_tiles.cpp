@@ -0,0 +1,386 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_quiet_tiles.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for skipping quiet tiles (see tile_activity_type in finite_diff_solver.h).
+//
+// tile_activity_type is checked on its own: which tiles wake, and when a skipped tile has to be
+// copied. Then the 2d forward-diff solve is run with and without the tiles, thru the functions
+// the solver uses and thru the solver itself. Skipping must stay close to the full solve, give
+// the same bits serial and parallel, and actually skip most of the sheet.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <vector>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+// A bit more than the solver's quiet-tile tolerance (2^-20) for each pass.
+double const  g_max_error_per_pass  = 2e-6;
+
+// _______________________________________________________________________________________________
+
+  template< typename SHEET_TYPE >
+  void
+set_drop( SHEET_TYPE & sheet, long x_count, long y_count, double center_x, double center_y, double height)
+  //
+  // Adds a narrow bell curve.
+{
+    for ( long y = 0 ; y < y_count ; ++ y ) {
+        for ( long x = 0 ; x < x_count ; ++ x ) {
+            double const  dist_2  = ((x - center_x) * (x - center_x)) + ((y - center_y) * (y - center_y));
+            sheet.begin( )[ (y * x_count) + x ] += static_cast< float >( height * std::exp( - dist_2 / 18));
+        }
+    }
+}
+
+  void
+solve_passes
+ (  bool                  is_parallel
+  , float                 damping
+  , int                   pass_count
+  , tile_activity_type *  p_tiles        // zero means solve every cell
+  , sheet_type          & result         // out
+  , std::size_t         & solved_count   // out, the tiles the last pass asked to solve next
+ )
+  //
+  // Solves a drop on a 257x190 sheet, going round two sheets like the solver does. The wave
+  // reads the older generation from trg.
+{
+    long const  x_count  = 257;
+    long const  y_count  = 190;
+    sheet_type sheet_a;
+    d_verify( sheet_a.set_xy_counts( x_count, y_count, 0));
+    set_drop( sheet_a, x_count, y_count, 85, 95, 1);
+    sheet_type sheet_b;
+    sheet_b = sheet_a;
+
+    if ( p_tiles ) { p_tiles->wake_all( x_count, y_count); }
+    typedef conductivity_sheet_type::yx_const_range_type  coef_range_type     ;
+    typedef sheet_type::yx_varia_range_type               velocity_range_type ;
+    bool const  is_early_exit  = false;
+    sheet_type * p_src = & sheet_a;
+    sheet_type * p_trg = & sheet_b;
+    solved_count = 0;
+    for ( int pass = 0 ; pass < pass_count ; ++ pass ) {
+        if ( p_tiles ) { p_tiles->start_pass( p_src, p_trg, float( 1) / (1 << 20)); }
+        sheet_type const & src = *p_src;
+        if ( is_parallel ) {
+            calc_next_2d_forward_diff_parallel
+             (  is_early_exit, finite_difference::e_stencil_5_point, finite_difference::e_boundary_insulated
+              , damping, 0.2f, 0.15f
+              , src.get_range_yx( ), p_trg->get_range_yx( )
+              , static_cast< coef_range_type const * >( 0), p_tiles
+              , static_cast< velocity_range_type const * >( 0), 0.0f, 0
+             );
+        } else {
+            calc_next_2d_forward_diff_serial
+             (  is_early_exit, finite_difference::e_stencil_5_point, finite_difference::e_boundary_insulated
+              , damping, 0.2f, 0.15f
+              , src.get_range_yx( ), p_trg->get_range_yx( )
+              , static_cast< coef_range_type const * >( 0), p_tiles
+              , static_cast< velocity_range_type const * >( 0), 0.0f, 0
+             );
+        }
+        if ( p_tiles ) { solved_count = p_tiles->finish_pass( ); }
+        std::swap( p_src, p_trg);
+    }
+    result = *p_src;
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  bool
+check_solver_skips
+ (  technique_type                   technique
+  , float                            damping
+  , long                             x_count
+  , long                             y_count
+  , bool                             is_parallel
+  , int                              pass_count       // in each solve
+  , int                              solve_count
+  , int                              drop_solve       // a 2nd drop before this solve, or -1
+  , conductivity_sheet_type const *  p_conductivity_sheet
+ )
+  //
+  // Solves with and without skipping, going round the sheets the way the solver's caller does.
+  // The second drop lands in a quiet part of the sheet and the tiles must wake up for it. The
+  // stats of the last solve must match a scan of the sheet.
+{
+    SHEET_TYPE results[ 2 ];
+    for ( int is_skipping = 0 ; is_skipping < 2 ; ++ is_skipping ) {
+        settable_input_params_type input_params;
+        input_params.set_technique( technique);
+        input_params.set_method( e_forward_diff);
+        input_params.set_rate_x( 0.2f);
+        input_params.set_rate_y( 0.15f);
+        input_params.set_damping( damping);
+        input_params.set_extra_pass_count( pass_count - 1);
+        input_params.set__is_method_parallel( is_parallel);
+        input_params.set__is_skipping_quiet_tiles( 0 != is_skipping);
+
+        SHEET_TYPE sheet_a;
+        d_verify( sheet_a.set_xy_counts( x_count, y_count, 0));
+        set_drop( sheet_a, x_count, y_count, x_count / 3, y_count / 2, 1);
+        SHEET_TYPE sheet_b;
+        sheet_b = sheet_a;
+        SHEET_TYPE sheet_c;
+        sheet_c = sheet_a;
+        SHEET_TYPE * p_src   = & sheet_a;
+        SHEET_TYPE * p_trg   = & sheet_b;
+        SHEET_TYPE * p_extra = & sheet_c;
+
+        SOLVER_TYPE solver;
+        bool is_src_from_last_solve = false;
+        for ( int solve = 0 ; solve < solve_count ; ++ solve ) {
+            if ( solve == drop_solve ) {
+                set_drop( *p_src, x_count, y_count, ((2 * x_count) / 3) + 5, y_count / 5, -0.7);
+                *p_trg = *p_src;
+                is_src_from_last_solve = false;
+            }
+            input_params.set__is_src_from_last_solve( is_src_from_last_solve);
+            solver.calc_next
+             (  input_params
+              , typename SOLVER_TYPE::sheet_params_type( *p_src, *p_trg, *p_extra, p_conductivity_sheet, 0)
+             );
+            std::swap( p_src, p_trg);
+            if ( solver.get_output_params( ).is_last_solve_saved_in_extra( ) ) {
+                std::swap( p_extra, p_trg);
+            }
+            is_src_from_last_solve = true;
+        }
+
+        sheet_stats_type const &  solver_stats  = solver.get_output_params( ).get_sheet_stats( );
+        sheet_stats_type scan_stats;
+        scan_stats.add_values( p_src->begin( ), p_src->end( ));
+        if ( solver_stats.is_empty( ) ||
+             (solver_stats.get_count( ) != scan_stats.get_count( )) ||
+             (solver_stats.get_min_value( ) != scan_stats.get_min_value( )) ||
+             (solver_stats.get_max_value( ) != scan_stats.get_max_value( )) ||
+             (std::fabs( solver_stats.get_sum( ) - scan_stats.get_sum( )) > (1e-6 * (1 + std::fabs( scan_stats.get_sum( ))))) )
+        {
+            return false;
+        }
+        results[ is_skipping ] = *p_src;
+    }
+    return test::get_max_difference( results[ 0 ], results[ 1 ]) < (g_max_error_per_pass * pass_count * solve_count);
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_tiles_wake_neighbors( )
+  //
+  // A tile that changed wakes itself and its 8 neighbours, and nothing else. Tiles at the edges
+  // have fewer neighbours.
+{
+    sheet_type src, trg;
+    tile_activity_type tiles;
+    tiles.wake_all( 100, 20);
+    test_check( 4 == tiles.get_tile_x_count( ));
+    for ( std::size_t y = 0 ; y < 20 ; ++ y ) {
+        for ( std::size_t tile_x = 0 ; tile_x < 4 ; ++ tile_x ) {
+            test_check( tiles.is_solved( tile_x, y));
+        }
+    }
+
+    // Tile (1, 1) changed, in row 9 only.
+    tiles.start_pass( & src, & trg, 0.5f);
+    for ( std::size_t y = 0 ; y < 20 ; ++ y ) {
+        for ( std::size_t tile_x = 0 ; tile_x < 4 ; ++ tile_x ) {
+            tiles.set_row_changed( tile_x, y, (1 == tile_x) && (9 == y));
+        }
+    }
+    test_check( 9 == tiles.finish_pass( ));
+    test_check( tiles.is_solved( 0, 0) && tiles.is_solved( 2, 19) && tiles.is_solved( 1, 12));
+    test_check( ! tiles.is_solved( 3, 0) && ! tiles.is_solved( 3, 19));
+
+    // Corner tile (3, 2) changed. Only the solved tiles' rows count, so (1, 1) goes quiet.
+    tiles.start_pass( & trg, & src, 0.5f);
+    for ( std::size_t y = 0 ; y < 20 ; ++ y ) {
+        for ( std::size_t tile_x = 0 ; tile_x < 4 ; ++ tile_x ) {
+            tiles.set_row_changed( tile_x, y, (3 == tile_x) && (19 == y));
+        }
+    }
+    test_check( 0 == tiles.finish_pass( ));
+
+    tiles.wake_all( 100, 20);
+    tiles.start_pass( & src, & trg, 0.5f);
+    for ( std::size_t y = 0 ; y < 20 ; ++ y ) {
+        for ( std::size_t tile_x = 0 ; tile_x < 4 ; ++ tile_x ) {
+            tiles.set_row_changed( tile_x, y, (3 == tile_x) && (19 == y));
+        }
+    }
+    test_check( 4 == tiles.finish_pass( ));
+    test_check( tiles.is_solved( 2, 8) && tiles.is_solved( 3, 19) && ! tiles.is_solved( 1, 19));
+
+    // Nothing changed.
+    tiles.start_pass( & trg, & src, 0.5f);
+    for ( std::size_t y = 0 ; y < 20 ; ++ y ) {
+        for ( std::size_t tile_x = 0 ; tile_x < 4 ; ++ tile_x ) {
+            tiles.set_row_changed( tile_x, y, false);
+        }
+    }
+    test_check( 0 == tiles.finish_pass( ));
+}
+
+  void
+test_tiles_copy_when_stale( )
+  //
+  // A skipped tile is copied into trg unless trg holds a generation from after the tile went
+  // quiet. Going round three sheets, the copies stop once every sheet has caught up.
+{
+    sheet_type sheets[ 3 ];
+    tile_activity_type tiles;
+    tiles.wake_all( 64, 8);
+
+    // Pass 1, A -> B: every tile solved, nothing changed, so they are all quiet from now on.
+    tiles.start_pass( & sheets[ 0 ], & sheets[ 1 ], 0.5f);
+    tiles.set_row_changed( 0, 0, false);
+    test_check( 0 == tiles.finish_pass( ));
+
+    // Pass 2, B -> C: C has never been written.
+    tiles.start_pass( & sheets[ 1 ], & sheets[ 2 ], 0.5f);
+    test_check( ! tiles.is_solved( 0, 0) && tiles.is_copy_needed( 0, 0) && tiles.is_copy_needed( 1, 7));
+    tiles.finish_pass( );
+
+    // Pass 3, C -> A: A holds the generation before the tiles went quiet.
+    tiles.start_pass( & sheets[ 2 ], & sheets[ 0 ], 0.5f);
+    test_check( tiles.is_copy_needed( 0, 0));
+    tiles.finish_pass( );
+
+    // Pass 4, A -> B: B was written when the tiles went quiet, so it already has their values.
+    tiles.start_pass( & sheets[ 0 ], & sheets[ 1 ], 0.5f);
+    test_check( ! tiles.is_copy_needed( 0, 0) && ! tiles.is_copy_needed( 1, 7));
+    tiles.finish_pass( );
+
+    // Going round two sheets, the copies stop after the first skipping pass.
+    tile_activity_type ring_tiles;
+    ring_tiles.wake_all( 64, 8);
+    ring_tiles.start_pass( & sheets[ 0 ], & sheets[ 1 ], 0.5f);
+    ring_tiles.finish_pass( );
+    ring_tiles.start_pass( & sheets[ 1 ], & sheets[ 0 ], 0.5f);
+    test_check( ring_tiles.is_copy_needed( 0, 0));
+    ring_tiles.finish_pass( );
+    ring_tiles.start_pass( & sheets[ 0 ], & sheets[ 1 ], 0.5f);
+    test_check( ! ring_tiles.is_copy_needed( 0, 0));
+    ring_tiles.finish_pass( );
+
+    // After forget_sheets( ) we don't know what any sheet holds.
+    tiles.forget_sheets( );
+    tiles.start_pass( & sheets[ 1 ], & sheets[ 2 ], 0.5f);
+    test_check( tiles.is_copy_needed( 0, 0));
+    tiles.finish_pass( );
+}
+
+  void
+test_tiles_skip_most_of_sheet( )
+  //
+  // After a drop spreads out for a while, most tiles are skipped. The wave spreads faster, so it
+  // skips fewer. The result stays close to the full solve, and the rows solved in parallel give
+  // the same bits as serial.
+{
+    float const   dampings[ ]              = { 1.0f, 0.01f };
+    double const  max_solved_fractions[ ]  = { 0.3 , 0.6   };
+    for ( std::size_t index = 0 ; index < (sizeof( dampings) / sizeof( dampings[ 0 ])) ; ++ index ) {
+        int const  pass_count  = 120;
+        std::size_t solved_count = 0;
+        sheet_type full_result;
+        solve_passes( false, dampings[ index ], pass_count, 0, full_result, solved_count);
+
+        tile_activity_type serial_tiles;
+        sheet_type serial_result;
+        solve_passes( false, dampings[ index ], pass_count, & serial_tiles, serial_result, solved_count);
+        tile_activity_type parallel_tiles;
+        sheet_type parallel_result;
+        std::size_t parallel_solved_count = 0;
+        solve_passes( true, dampings[ index ], pass_count, & parallel_tiles, parallel_result, parallel_solved_count);
+
+        std::size_t const  tile_count  = 9 * 24; // 257x190 in 32x8 tiles
+        double const  max_error  = test::get_max_difference( full_result, serial_result);
+        if ( ! test_check(
+                (max_error < (g_max_error_per_pass * pass_count)) &&
+                (solved_count < (max_solved_fractions[ index ] * tile_count)) &&
+                (solved_count == parallel_solved_count) &&
+                (0 == test::get_max_difference( serial_result, parallel_result))) )
+        {
+            std::fprintf( stderr, "  damping %g, error %g, solved %d of %d tiles\n",
+                double( dampings[ index ]), max_error, int( solved_count), int( tile_count));
+        }
+    }
+}
+
+  void
+test_solver_skips_quiet_tiles( )
+  //
+  // Thru the solver: heat and wave, several passes in a solve, a conductivity map, a 2nd drop,
+  // double, and small and thin sheets.
+{
+    long const  x_count  = 129;
+    long const  y_count  =  95;
+    conductivity_sheet_type conductivity_sheet;
+    d_verify( conductivity_sheet.set_xy_counts( x_count, y_count, 1.0f));
+    for ( long y = 0 ; y < y_count ; ++ y ) {
+        for ( long x = x_count / 2 ; x < ((x_count / 2) + 8) ; ++ x ) {
+            if ( (y < (y_count / 3)) || (y > ((2 * y_count) / 3)) ) {
+                conductivity_sheet.begin( )[ (y * x_count) + x ] = 1.0f / 64;
+            }
+        }
+    }
+
+    for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+        bool const  p  = (0 != is_parallel);
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_simultaneous_2d  , 1.00f, x_count, y_count, p, 1, 150, -1, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_simultaneous_2d  , 1.00f, x_count, y_count, p, 3,  50, -1, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_simultaneous_2d  , 1.00f, x_count, y_count, p, 1, 150, 75, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_wave_with_damping, 0.01f, x_count, y_count, p, 1, 150, -1, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_wave_with_damping, 0.01f, x_count, y_count, p, 4,  40, 20, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >
+                      ( e_simultaneous_2d  , 1.00f, x_count, y_count, p, 1, 150, -1, & conductivity_sheet)));
+        test_check( (check_solver_skips< sheet_type, solver_type >
+                      ( e_wave_with_damping, 0.01f, x_count, y_count, p, 1, 150, -1, & conductivity_sheet)));
+        test_check( (check_solver_skips< double_sheet_type, double_solver_type >
+                      ( e_simultaneous_2d  , 1.00f, x_count, y_count, p, 2,  75, -1, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_simultaneous_2d  , 1.00f,   5,   3, p, 1,  50, -1, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_simultaneous_2d  , 1.00f, 100,   1, p, 1,  50, -1, 0)));
+        test_check( (check_solver_skips< sheet_type, solver_type >( e_wave_with_damping, 0.02f,  33,   9, p, 1, 200, -1, 0)));
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_wake(    "tiles_wake_neighbors"   , & test_tiles_wake_neighbors    );
+test::registrar_type const  register_copy(    "tiles_copy_when_stale"  , & test_tiles_copy_when_stale   );
+test::registrar_type const  register_skip(    "tiles_skip_most_of_sheet", & test_tiles_skip_most_of_sheet);
+test::registrar_type const  register_solver(  "solver_skips_quiet_tiles", & test_solver_skips_quiet_tiles);
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_quiet_tiles.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,360 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_row_pool.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the work-stealing row pool (row_pool.h).
+//
+// A map must run every item exactly once, no matter how the threads split and steal the
+// ranges, and a parallel map must not hand out blocks bigger than it was asked for. The jobs
+// here make some items much slower than others so the threads that finish first have to steal.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <vector>
+# include <QtCore/QMutex>
+# include <QtCore/QThread>
+# include "row_pool.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+// _______________________________________________________________________________________________
+
+  class
+count_job_type
+  : public row_pool::job_type
+  //
+  // Counts how many times each item runs, and remembers the biggest block.
+{
+  public:
+    explicit
+    count_job_type( std::size_t item_count)
+      : mutex_            ( )
+      , run_counts_       ( item_count, 0)
+      , max_block_count_  ( 0)
+      , bad_block_count_  ( 0)
+      { }
+    /* dtor */
+    virtual         ~count_job_type( )                             { }
+
+    virtual
+      void
+    run_block( std::size_t lo, std::size_t post) const
+      {
+        // Items in the first eighth are slow.
+        volatile std::size_t spin = 0;
+        for ( std::size_t index = lo ; index < post ; ++ index ) {
+            if ( index < (run_counts_.size( ) / 8) ) {
+                for ( int count = 0 ; count < 20000 ; ++ count ) { spin += count; }
+            }
+        }
+
+        QMutexLocker lock( & mutex_);
+        if ( (lo >= post) || (post > run_counts_.size( )) ) {
+            ++ bad_block_count_;
+            return;
+        }
+        max_block_count_ = std::max( max_block_count_, post - lo);
+        for ( std::size_t index = lo ; index < post ; ++ index ) {
+            ++ run_counts_[ index ];
+        }
+      }
+
+      bool
+    is_each_run_once( ) const
+      {
+        for ( std::size_t index = 0 ; index < run_counts_.size( ) ; ++ index ) {
+            if ( 1 != run_counts_[ index ] ) return false;
+        }
+        return 0 == bad_block_count_;
+      }
+
+    std::size_t     get_max_block_count( )                   const { return max_block_count_; }
+
+  private:
+    mutable QMutex                  mutex_            ;
+    mutable std::vector< int >      run_counts_       ;
+    mutable std::size_t             max_block_count_  ;
+    mutable int                     bad_block_count_  ;
+};
+
+// _______________________________________________________________________________________________
+
+  void
+test_row_pool_map( )
+  //
+  // Every item runs once, for all sorts of thread counts, item counts and block counts.
+{
+    int         const  thread_counts[ ]  = { 1, 2, 3, 8 };
+    std::size_t const  item_counts[ ]    = { 0, 1, 2, 7, 64, 1001 };
+    std::size_t const  block_counts[ ]   = { 1, 3, 16, 5000 };
+
+    row_pool::pool_type pool( 1);
+    for ( std::size_t t = 0 ; t < (sizeof( thread_counts) / sizeof( thread_counts[ 0 ])) ; ++ t ) {
+        pool.set_thread_count( thread_counts[ t ]);
+        test_check( thread_counts[ t ] == pool.get_thread_count( ));
+
+        for ( std::size_t i = 0 ; i < (sizeof( item_counts) / sizeof( item_counts[ 0 ])) ; ++ i ) {
+            for ( std::size_t b = 0 ; b < (sizeof( block_counts) / sizeof( block_counts[ 0 ])) ; ++ b ) {
+                count_job_type const job( item_counts[ i ]);
+                pool.map( job, item_counts[ i ], block_counts[ b ]);
+                test_check( job.is_each_run_once( ));
+                // One thread runs the whole job in one call.
+                test_check( (1 == thread_counts[ t ]) || (job.get_max_block_count( ) <= block_counts[ b ]));
+            }
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  class
+nested_job_type
+  : public row_pool::job_type
+  //
+  // Each outer item maps its own inner job on the same pool. The pool is busy, so the inner
+  // maps run serially in whichever thread has the outer block.
+{
+  public:
+    nested_job_type( row_pool::pool_type & pool, std::size_t item_count)
+      : pool_       ( pool)
+      , inner_jobs_ ( )
+      {
+        for ( std::size_t index = 0 ; index < item_count ; ++ index ) {
+            inner_jobs_.push_back( new count_job_type( 37));
+        }
+      }
+    /* dtor */
+    ~nested_job_type( )
+      {
+        for ( std::size_t index = 0 ; index < inner_jobs_.size( ) ; ++ index ) {
+            delete inner_jobs_[ index ];
+        }
+      }
+
+    virtual
+      void
+    run_block( std::size_t lo, std::size_t post) const
+      {
+        for ( ; lo < post ; ++ lo ) {
+            pool_.map( *inner_jobs_[ lo ], 37, 4);
+        }
+      }
+
+      bool
+    is_each_run_once( ) const
+      {
+        for ( std::size_t index = 0 ; index < inner_jobs_.size( ) ; ++ index ) {
+            if ( ! inner_jobs_[ index ]->is_each_run_once( ) ) return false;
+        }
+        return true;
+      }
+
+  private:
+    /* copy */      nested_job_type(  nested_job_type const &)     ; // no implementation
+    void            operator =( nested_job_type const &)           ; // no implementation
+
+    row_pool::pool_type &               pool_       ;
+    std::vector< count_job_type * >     inner_jobs_ ;
+};
+
+  void
+test_row_pool_nested_map( )
+{
+    row_pool::pool_type pool( 4);
+    nested_job_type const job( pool, 23);
+    pool.map( job, 23, 2);
+    test_check( job.is_each_run_once( ));
+}
+
+// _______________________________________________________________________________________________
+
+  class
+map_thread_type
+  : public QThread
+  //
+  // Maps each of its jobs on a pool, from a thread of its own.
+{
+  public:
+    map_thread_type( row_pool::pool_type & pool, std::vector< count_job_type * > const & jobs)
+      : pool_  ( pool)
+      , jobs_  ( jobs)
+      { }
+  protected:
+    virtual
+      void
+    run( )
+      { for ( std::size_t index = 0 ; index < jobs_.size( ) ; ++ index ) {
+            pool_.map( *jobs_[ index ], 300, 8);
+        }
+      }
+  private:
+    row_pool::pool_type &                       pool_  ;
+    std::vector< count_job_type * > const &     jobs_  ;
+};
+
+  void
+test_row_pool_two_mapping_threads( )
+  //
+  // Two threads map on the same pool at once. Whichever one finds the pool busy runs its job
+  // serially, so both finish and all the jobs are complete.
+{
+    row_pool::pool_type pool( 3);
+    std::vector< count_job_type * > main_jobs, thread_jobs;
+    for ( int count = 0 ; count < 20 ; ++ count ) {
+        main_jobs  .push_back( new count_job_type( 300));
+        thread_jobs.push_back( new count_job_type( 300));
+    }
+
+    map_thread_type thread( pool, thread_jobs);
+    thread.start( );
+    for ( std::size_t index = 0 ; index < main_jobs.size( ) ; ++ index ) {
+        pool.map( *main_jobs[ index ], 300, 8);
+    }
+    thread.wait( );
+
+    for ( std::size_t index = 0 ; index < main_jobs.size( ) ; ++ index ) {
+        test_check( main_jobs  [ index ]->is_each_run_once( ));
+        test_check( thread_jobs[ index ]->is_each_run_once( ));
+        delete main_jobs  [ index ];
+        delete thread_jobs[ index ];
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_row_pool_block_count( )
+  //
+  // Blocks are about row_block_byte_count bytes, but each thread gets at least 4 of them.
+{
+    row_pool::pool_type pool( 4);
+    std::size_t const  row_bytes  = 1024;
+    std::size_t const  cache_rows = row_pool::row_block_byte_count / row_bytes;
+
+    // A tall sheet gets cache-sized blocks.
+    test_check( cache_rows == row_pool::get_row_block_count( pool, 100000, row_bytes));
+
+    // A short sheet gets smaller blocks, so there are 4 for each thread.
+    test_check( 2 == row_pool::get_row_block_count( pool, 32, row_bytes));
+
+    // Never zero, even for tiny sheets and huge rows.
+    test_check( 1 == row_pool::get_row_block_count( pool, 3, row_bytes));
+    test_check( 1 == row_pool::get_row_block_count( pool, 100000, 10 * row_pool::row_block_byte_count));
+    test_check( 1 == row_pool::get_row_block_count( pool, 0, 0));
+}
+
+  void
+test_row_pool_map_rows( )
+  //
+  // map_rows(..) uses the current pool, and runs in the calling thread when there isn't one.
+{
+    count_job_type const  job_no_pool( 500);
+    {   row_pool::scoped_current_pool_type const  no_pool( 0);
+        test_check( 0 == row_pool::get_current_pool( ));
+        row_pool::map_rows( job_no_pool, 500, 64);
+    }
+    test_check( job_no_pool.is_each_run_once( ));
+    test_check( 500 == job_no_pool.get_max_block_count( ));
+
+    row_pool::pool_type pool( 3);
+    count_job_type const  job_pool( 500);
+    {   row_pool::scoped_current_pool_type const  use_pool( & pool);
+        test_check( & pool == row_pool::get_current_pool( ));
+        test_check( 3 == row_pool::get_thread_count( ));
+        row_pool::map_rows( job_pool, 500, 64);
+    }
+    test_check( job_pool.is_each_run_once( ));
+    test_check( job_pool.get_max_block_count( ) <= row_pool::get_row_block_count( pool, 500, 64));
+}
+
+// _______________________________________________________________________________________________
+
+  class
+slot_job_type
+  : public row_pool::job_type
+  //
+  // Each block borrows a scratch slot and checks that no other block has it at the same time.
+{
+  public:
+    explicit
+    slot_job_type( std::size_t slot_count)
+      : slots_        ( slot_count)
+      , mutex_        ( )
+      , in_use_       ( slot_count, false)
+      , clash_count_  ( 0)
+      { }
+
+    virtual
+      void
+    run_block( std::size_t lo, std::size_t post) const
+      {
+        row_pool::scoped_slot_type const slot( slots_);
+        {   QMutexLocker lock( & mutex_);
+            if ( (slot.get( ) >= in_use_.size( )) || in_use_[ slot.get( ) ] ) { ++ clash_count_; return; }
+            in_use_[ slot.get( ) ] = true;
+        }
+        volatile std::size_t spin = 0;
+        for ( ; lo < post ; ++ lo ) {
+            for ( int count = 0 ; count < 2000 ; ++ count ) { spin += count; }
+        }
+        QMutexLocker lock( & mutex_);
+        in_use_[ slot.get( ) ] = false;
+      }
+
+    int             get_clash_count( )                       const { return clash_count_; }
+
+  private:
+    mutable row_pool::slot_stack_type   slots_        ;
+    mutable QMutex                      mutex_        ;
+    mutable std::vector< bool >         in_use_       ;
+    mutable int                         clash_count_  ;
+};
+
+  void
+test_row_pool_scratch_slots( )
+{
+    row_pool::pool_type pool( 4);
+
+    // One slot for each thread.
+    slot_job_type const  job( pool.get_thread_count( ));
+    pool.map( job, 400, 3);
+    test_check( 0 == job.get_clash_count( ));
+
+    // Fewer slots than threads: take( ) waits for a slot to come back.
+    slot_job_type const  short_job( 2);
+    pool.map( short_job, 400, 3);
+    test_check( 0 == short_job.get_clash_count( ));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_map(           "row_pool_map"             , & test_row_pool_map                );
+test::registrar_type const  register_nested_map(    "row_pool_nested_map"      , & test_row_pool_nested_map         );
+test::registrar_type const  register_two_threads(   "row_pool_two_threads"     , & test_row_pool_two_mapping_threads);
+test::registrar_type const  register_block_count(   "row_pool_block_count"     , & test_row_pool_block_count        );
+test::registrar_type const  register_map_rows(      "row_pool_map_rows"        , & test_row_pool_map_rows           );
+test::registrar_type const  register_scratch_slots( "row_pool_scratch_slots"   , & test_row_pool_scratch_slots      );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_row_pool.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
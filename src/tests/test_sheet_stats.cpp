@@ -0,0 +1,264 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_sheet_stats.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the sheet stats (sheet_stats.h) the solvers publish with each generation.
+//
+// Whatever way a solve gathers them (row by row in the forward-diff kernels, or in a row pass
+// after the solve), they must describe the sheet it leaves behind: the same min and max, and
+// the same sums up to the order they were added in.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <vector>
+# include "heat_solver.h"
+# include "sheet_stats.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+size_type const  g_x_count  = 157;
+size_type const  g_y_count  =  93;
+
+// _______________________________________________________________________________________________
+
+  bool
+is_close( double a, double b)
+{
+    return std::fabs( a - b) <= (1e-9 * (1 + std::fabs( b)));
+}
+
+  template< typename SHEET_TYPE >
+  bool
+is_same_stats( sheet_stats_type const & solved_stats, SHEET_TYPE const & sheet)
+  //
+  // The solver's stats against a scan of the sheet.
+{
+    sheet_stats_type scan_stats;
+    scan_stats.add_values( sheet.begin( ), sheet.end( ));
+    return
+        (! solved_stats.is_empty( )) &&
+        (solved_stats.get_count( ) == scan_stats.get_count( )) &&
+        (solved_stats.get_min_value( ) == scan_stats.get_min_value( )) &&
+        (solved_stats.get_max_value( ) == scan_stats.get_max_value( )) &&
+        is_close( solved_stats.get_sum( ), scan_stats.get_sum( )) &&
+        is_close( solved_stats.get_sum_of_squares( ), scan_stats.get_sum_of_squares( ));
+}
+
+  struct
+solve_case_type
+{
+    technique_type  technique         ;
+    method_type     method            ;
+    float           rate              ;
+    float           damping           ;
+    int             extra_pass_count  ;
+    bool            is_measured       ;  /* false if the solve has no pass to gather stats in */
+};
+
+solve_case_type const  g_solve_cases[ ] =
+ {  { e_simultaneous_2d   , e_forward_diff , 0.2f, 1.0f, 0, true  }  /* measured in the kernels */
+  , { e_simultaneous_2d   , e_forward_diff , 0.2f, 1.0f, 6, true  }  /* multi-pass, too small to block */
+  , { e_simultaneous_2d   , e_forward_diff , 0.9f, 1.0f, 0, true  }  /* stable sub-steps */
+  , { e_simultaneous_2d   , e_backward_diff, 0.9f, 1.0f, 2, false }
+  , { e_simultaneous_2d   , e_central_diff , 0.4f, 1.0f, 0, false }
+  , { e_ortho_interleave  , e_central_diff , 0.4f, 1.0f, 0, false }
+  , { e_implicit_multigrid, e_backward_diff, 2.0f, 1.0f, 0, false }
+  , { e_spectral_jump     , e_forward_diff , 0.3f, 1.0f, 3, false }
+  , { e_super_time_step   , e_forward_diff , 3.0f, 1.0f, 0, false }
+  , { e_wave_with_damping , e_forward_diff , 0.4f, 0.1f, 0, true  }  /* clamped in the kernels */
+  , { e_wave_with_damping , e_backward_diff, 0.4f, 0.1f, 0, true  }  /* clamped after the solve */
+ };
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  void
+check_solve_case( solve_case_type const & solve_case, bool is_parallel)
+  //
+  // A few generations in a row, each checked against the sheet it made. The solves that would
+  // need an extra trip thru the sheet to measure it must leave the stats empty instead.
+{
+    settable_input_params_type input_params;
+    input_params.set_technique( solve_case.technique);
+    input_params.set_method( solve_case.method);
+    input_params.set_rate_x( solve_case.rate);
+    input_params.set_rate_y( solve_case.rate * 0.7f);
+    input_params.set_damping( solve_case.damping);
+    input_params.set_extra_pass_count( solve_case.extra_pass_count);
+    input_params.set__is_method_parallel( is_parallel);
+
+    SHEET_TYPE sheet_a;
+    d_verify( sheet_a.set_xy_counts( g_x_count, g_y_count, 0));
+    for ( size_type index = 0 ; index < sheet_a.get_xy_count( ) ; ++ index ) {
+        sheet_a.begin( )[ index ] = test::get_init_value< double >( index);
+    }
+    SHEET_TYPE sheet_b;
+    sheet_b = sheet_a;
+    SHEET_TYPE extra;
+    extra = sheet_a;
+
+    SOLVER_TYPE solver;
+    SHEET_TYPE * p_src = & sheet_a;
+    SHEET_TYPE * p_trg = & sheet_b;
+    for ( int generation = 0 ; generation < 3 ; ++ generation ) {
+        solver.calc_next( input_params, typename SOLVER_TYPE::sheet_params_type( *p_src, *p_trg, extra, 0, 0));
+        sheet_stats_type const &  stats  = solver.get_output_params( ).get_sheet_stats( );
+        if ( ! test_check( solve_case.is_measured ? is_same_stats( stats, *p_trg) : stats.is_empty( )) ) {
+            std::fprintf( stderr, "  technique %d, method %d, extra passes %d, %s, generation %d\n",
+                static_cast< int >( solve_case.technique), static_cast< int >( solve_case.method),
+                solve_case.extra_pass_count, is_parallel ? "parallel" : "serial", generation);
+        }
+        std::swap( p_src, p_trg);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_sheet_stats_add( )
+  //
+  // Stats gathered in pieces and combined are the stats of the whole.
+{
+    std::vector< float > values;
+    for ( size_type index = 0 ; index < 1000 ; ++ index ) {
+        values.push_back( test::get_init_value< float >( index));
+    }
+    values[ 400 ] =  2.5f;
+    values[ 900 ] = -3.0f;
+
+    sheet_stats_type whole;
+    test_check( whole.is_empty( ));
+    test_check( 0 == whole.get_mean( ));
+    whole.add_values( values.begin( ), values.end( ));
+    test_check( 1000 == whole.get_count( ));
+    test_check( -3.0 == whole.get_min_value( ));
+    test_check(  2.5 == whole.get_max_value( ));
+
+    sheet_stats_type pieces;
+    std::size_t const  cuts[ ] = { 0, 1, 333, 333, 700, 1000 };
+    for ( std::size_t index = 1 ; index < (sizeof( cuts) / sizeof( cuts[ 0 ])) ; ++ index ) {
+        sheet_stats_type piece;
+        piece.add_values( values.begin( ) + cuts[ index - 1 ], values.begin( ) + cuts[ index ]);
+        pieces.add( piece);
+    }
+    test_check( pieces.get_count( ) == whole.get_count( ));
+    test_check( pieces.get_min_value( ) == whole.get_min_value( ));
+    test_check( pieces.get_max_value( ) == whole.get_max_value( ));
+    test_check( is_close( pieces.get_sum( ), whole.get_sum( )));
+    test_check( is_close( pieces.get_sum_of_squares( ), whole.get_sum_of_squares( )));
+    test_check( is_close( pieces.get_mean( ), whole.get_sum( ) / 1000));
+
+    // A piece that is all positive (or all negative) still sets min (or max) from its values.
+    sheet_stats_type positive;
+    positive.add_values( values.begin( ) + 400, values.begin( ) + 401);
+    test_check( (2.5 == positive.get_min_value( )) && (2.5 == positive.get_max_value( )));
+
+    pieces.clear( );
+    test_check( pieces.is_empty( ));
+    test_check( (0 == pieces.get_sum( )) && (0 == pieces.get_sum_of_squares( )));
+}
+
+  void
+test_solver_stats_match_sheet( )
+  //
+  // Each technique, serial and parallel, float and double.
+{
+    for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+        for ( std::size_t index = 0 ; index < (sizeof( g_solve_cases) / sizeof( g_solve_cases[ 0 ])) ; ++ index ) {
+            check_solve_case< sheet_type, solver_type >( g_solve_cases[ index ], 0 != is_parallel);
+        }
+        check_solve_case< double_sheet_type, double_solver_type >( g_solve_cases[ 0 ], 0 != is_parallel);
+    }
+}
+
+  void
+test_fixed_solver_stats_empty( )
+  //
+  // The fixed-point solvers do not gather stats, so they say "unknown".
+{
+    settable_input_params_type input_params;
+    input_params.set_technique( e_simultaneous_2d);
+    input_params.set_method( e_forward_diff);
+    input_params.set_rate_x( 0.2f);
+    input_params.set_rate_y( 0.15f);
+    d_verify( fixed16_solver_type::can_solve( input_params));
+
+    fixed16_sheet_type src;
+    d_verify( src.set_xy_counts( g_x_count, g_y_count, uniform_scalar_16_type( 0)));
+    for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+        src.begin( )[ index ] = uniform_scalar_16_type( test::get_init_value< float >( index));
+    }
+    fixed16_sheet_type trg;
+    trg = src;
+    fixed16_sheet_type extra;
+    extra = src;
+    fixed16_solver_type solver;
+    solver.calc_next( input_params, fixed16_solver_type::sheet_params_type( src, trg, extra, 0, 0));
+    test_check( 1 == solver.get_output_params( ).get_solve_count( ));
+    test_check( solver.get_output_params( ).get_sheet_stats( ).is_empty( ));
+}
+
+  void
+test_normalize_with_min_max( )
+  //
+  // Given the true min and max, normalize_with_min_max(..) is the same as normalize(..).
+{
+    sheet_type scanned;
+    d_verify( scanned.set_xy_counts( 31, 17, 0));
+    for ( size_type index = 0 ; index < scanned.get_xy_count( ) ; ++ index ) {
+        scanned.begin( )[ index ] = 3 * std::sin( index * 0.3f);
+    }
+    sheet_type given;
+    given = scanned;
+
+    float min_value = 0;
+    float max_value = 0;
+    given.get_min_max_values( min_value, max_value);
+
+    float scanned_ratio = 0;
+    float given_ratio   = 0;
+    test_check( scanned.normalize( -1, +1, & scanned_ratio));
+    test_check( given.normalize_with_min_max( min_value, max_value, -1, +1, & given_ratio));
+    test_check( scanned_ratio == given_ratio);
+    test_check(
+        test::is_same_bits
+         (  std::vector< float >( scanned.begin( ), scanned.end( ))
+          , std::vector< float >( given.begin( ), given.end( ))
+         ));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_add(          "sheet_stats_add"          , & test_sheet_stats_add          );
+test::registrar_type const  register_match_sheet(  "solver_stats_match_sheet" , & test_solver_stats_match_sheet );
+test::registrar_type const  register_fixed_empty(  "fixed_solver_stats_empty" , & test_fixed_solver_stats_empty );
+test::registrar_type const  register_normalize(    "normalize_with_min_max"   , & test_normalize_with_min_max   );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_sheet_stats.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
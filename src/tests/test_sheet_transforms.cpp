@@ -0,0 +1,153 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_sheet_transforms.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the sheet transforms (sheet.h) mapped on the row pool.
+//
+// sheet_type::transform_rectangle(..) splits the rows into blocks and maps them on the current
+// row pool. Each cell is still calculated the same way, so the sheet must come out the same,
+// bit for bit, with or without a pool.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <vector>
+# include "sheet.h"
+# include "row_pool.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+typedef sheet_type::size_type   size_type  ;
+typedef sheet_type::value_type  value_type ;
+
+// Big enough that the rows are split into many blocks.
+size_type const  g_x_count  = 1001;
+size_type const  g_y_count  =  703;
+
+// _______________________________________________________________________________________________
+
+  struct
+ramp_functor_type
+  //
+  // A new value that depends on the old one and on where the cell is.
+{
+      value_type
+    operator ()( value_type old_value, size_type x, size_type y) const
+      { return old_value + (0.001f * x) - (0.002f * y); }
+};
+
+  struct
+coords_functor_type
+  //
+  // A new value that is just where the cell is.
+{
+      value_type
+    operator ()( value_type, size_type x, size_type y) const
+      { return static_cast< value_type >( x + (10000 * y)); }
+};
+
+  void
+run_transforms( sheet_type & sheet)
+  //
+  // The fills, scales and normalize all end up in transform_rectangle(..).
+{
+    d_verify( sheet.set_xy_counts( g_x_count, g_y_count, 0.1f));
+    d_verify( sheet.fill_bell_curve_4( ));
+    d_verify( sheet.fill_sin_over_dist_2( ));
+    d_verify( sheet.scale_sheet( 0.7f));
+    d_verify( sheet.transform_rectangle( ramp_functor_type( ), 13, 901, 7, 699));
+    d_verify( sheet.fill_rectangle_coords( 0.25f, 100, 103, 50, 600));
+    d_verify( sheet.normalize( ));
+}
+
+  bool
+is_same_bits( sheet_type const & a, sheet_type const & b)
+{
+    return
+        test::is_same_bits
+         (  std::vector< float >( a.begin( ), a.end( ))
+          , std::vector< float >( b.begin( ), b.end( ))
+         );
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_sheet_transforms_on_pool( )
+  //
+  // The transforms give the same bits on pools of 1 and 4 threads as they do with no pool.
+{
+    sheet_type serial_sheet;
+    {   row_pool::scoped_current_pool_type const  no_pool( 0);
+        run_transforms( serial_sheet);
+    }
+
+    std::size_t const  thread_counts[ ] = { 1, 4 };
+    for ( std::size_t index = 0 ; index < (sizeof( thread_counts) / sizeof( thread_counts[ 0 ])) ; ++ index ) {
+        row_pool::pool_type pool( thread_counts[ index ]);
+        row_pool::scoped_current_pool_type const  current_pool( & pool);
+        sheet_type pool_sheet;
+        run_transforms( pool_sheet);
+        test_check( is_same_bits( serial_sheet, pool_sheet));
+    }
+}
+
+  void
+test_sheet_transform_coords( )
+  //
+  // Each block gets the right x and y for its cells, and nothing outside the rectangle is
+  // touched.
+{
+    size_type const  x_lo       =  17;
+    size_type const  x_hi_plus  = 950;
+    size_type const  y_lo       =   3;
+    size_type const  y_hi_plus  = 701;
+
+    row_pool::pool_type pool( 4);
+    row_pool::scoped_current_pool_type const  current_pool( & pool);
+
+    sheet_type sheet;
+    d_verify( sheet.set_xy_counts( g_x_count, g_y_count, -1.0f));
+    test_check( sheet.transform_rectangle( coords_functor_type( ), x_lo, x_hi_plus, y_lo, y_hi_plus));
+
+    size_type bad_count = 0;
+    for ( size_type y = 0 ; y < g_y_count ; ++ y ) {
+        for ( size_type x = 0 ; x < g_x_count ; ++ x ) {
+            bool const        is_inside  = (x >= x_lo) && (x < x_hi_plus) && (y >= y_lo) && (y < y_hi_plus);
+            value_type const  expected   = is_inside ? static_cast< value_type >( x + (10000 * y)) : -1.0f;
+            if ( sheet.get_at( x, y) != expected ) { ++ bad_count; }
+        }
+    }
+    test_check( 0 == bad_count);
+
+    // An empty rectangle does nothing.
+    test_check( ! sheet.transform_rectangle( coords_functor_type( ), 5, 5, 0, g_y_count));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_on_pool( "sheet_transforms_on_pool", & test_sheet_transforms_on_pool);
+test::registrar_type const  register_coords(  "sheet_transform_coords"  , & test_sheet_transform_coords  );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_sheet_transforms.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
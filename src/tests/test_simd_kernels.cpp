@@ -0,0 +1,383 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_simd_kernels.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// The vector kernels (finite_diff_simd_kernels.h) must give exactly the same bits as the plain
+// C++ code. These tests run the same solves with the scalar code and then with the kernels for
+// each level this CPU can run (SSE2, AVX2, AVX-512), and compare the sheets bit for bit.
+//
+// The solves are picked so each kernel in the table runs:
+//   forward_diff_2d_middle, _edge      -- 5-point heat, and the wave (damped, and clamped)
+//   forward_diff_thin_strip            -- one-row sheets, and the 1D forward-diff passes
+//   forward_diff_2d_9_point, _4th_order
+//   forward_diff_2d_varying            -- heat with a conductivity map
+//   leapfrog_velocity                  -- the leapfrog wave
+//   *_diff_columns, *_columns_varying  -- the implicit column passes, with and without a map
+//   forward_diff_2d_fixed16            -- the 16-bit fixed-point solver
+//
+// The implicit row passes solve with a factored matrix (see get_factored_matrix(..) in
+// finite_diff_solver.h), so they do not reach the 1D implicit kernels or the tridiagonal
+// kernels. Those are tested on their own rows, thru the functions in finite_diff.h that use
+// them:
+//   backward_diff_1d, central_diff_1d  -- calc_next_generation_*_difference_1d(..)
+//   solve_tridiagonal_set, _sum        -- solve_matrix_destructive(..)
+//
+// The sheets are odd sizes, so the kernels also run their leftover (not a whole vector) cells.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <cstdio>
+# include <cstring>
+# include <vector>
+# include "heat_solver.h"
+# include "finite_diff.h"
+# include "finite_diff_simd.h"
+# include "cpu_features.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+// _______________________________________________________________________________________________
+
+  struct
+solve_case_type
+{
+    technique_type  technique   ;
+    method_type     method      ;
+    boundary_type   boundary    ;
+    int             x_count     ;
+    int             y_count     ;
+    double          rate_x      ;
+    double          rate_y      ;
+    double          damping     ;
+    int             extra_pass_count ;
+    bool            is_varying  ; /* with a conductivity map */
+    bool            is_parallel ;
+    float           init_scale  ; /* 300 pushes the wave past its clamp limit (100) */
+};
+
+solve_case_type const  g_solve_cases[ ] =
+ {  { e_simultaneous_2d  , e_forward_diff          , e_boundary_insulated, 157,  93, 0.20, 0.15, 1.0, 0, false, false,   1 }
+  , { e_simultaneous_2d  , e_forward_diff          , e_boundary_insulated, 157,  93, 0.20, 0.15, 1.0, 2, false, true ,   1 }
+  , { e_simultaneous_2d  , e_forward_diff          , e_boundary_insulated,  37,   1, 0.20, 0.15, 1.0, 0, false, false,   1 }
+  , { e_simultaneous_2d  , e_forward_diff          , e_boundary_insulated,  37,   2, 0.20, 0.15, 1.0, 0, false, false,   1 }
+  , { e_simultaneous_2d  , e_forward_diff          , e_boundary_fixed    ,  61,  29, 0.20, 0.15, 1.0, 0, false, true ,   1 }
+  , { e_simultaneous_2d  , e_forward_diff          , e_boundary_periodic ,  61,  29, 0.20, 0.15, 1.0, 0, false, true ,   1 }
+  , { e_simultaneous_2d  , e_forward_diff          , e_boundary_insulated, 157,  93, 0.20, 0.15, 1.0, 0, true , true ,   1 }
+  , { e_simultaneous_2d  , e_forward_diff_9_point  , e_boundary_insulated, 157,  93, 0.30, 0.25, 1.0, 0, false, true ,   1 }
+  , { e_simultaneous_2d  , e_forward_diff_4th_order, e_boundary_insulated, 157,  93, 0.20, 0.10, 1.0, 0, false, true ,   1 }
+  , { e_simultaneous_2d  , e_forward_diff          , e_boundary_insulated, 157,  93, 0.90, 0.70, 1.0, 0, false, true ,   1 }
+  , { e_ortho_interleave , e_forward_diff          , e_boundary_insulated, 157,  93, 0.30, 0.20, 1.0, 0, false, true ,   1 }
+  , { e_ortho_interleave , e_backward_diff         , e_boundary_insulated, 157,  93, 2.00, 1.50, 1.0, 0, false, false,   1 }
+  , { e_ortho_interleave , e_backward_diff         , e_boundary_insulated, 157,  93, 2.00, 1.50, 1.0, 0, false, true ,   1 }
+  , { e_ortho_interleave , e_central_diff          , e_boundary_insulated, 157,  93, 0.40, 0.30, 1.0, 0, false, true ,   1 }
+  , { e_ortho_interleave , e_backward_diff         , e_boundary_insulated, 157,  93, 2.00, 1.50, 1.0, 0, true , true ,   1 }
+  , { e_ortho_interleave , e_central_diff          , e_boundary_insulated, 157,  93, 0.40, 0.30, 1.0, 0, true , false,   1 }
+  , { e_ortho_interleave , e_backward_diff         , e_boundary_insulated,   5,   7, 2.00, 1.50, 1.0, 0, false, false,   1 }
+  , { e_wave_with_damping, e_forward_diff          , e_boundary_insulated, 157,  93, 0.30, 0.20, 0.1, 0, false, true ,   1 }
+  , { e_wave_with_damping, e_forward_diff          , e_boundary_insulated, 157,  93, 0.30, 0.20, 0.1, 0, false, true , 300 }
+  , { e_wave_with_damping, e_forward_diff          , e_boundary_absorbing, 157,  93, 0.30, 0.20, 0.1, 0, false, true ,   1 }
+  , { e_wave_leapfrog    , e_forward_diff          , e_boundary_insulated, 157,  93, 0.30, 0.20, 0.1, 0, false, true ,   1 }
+  , { e_wave_leapfrog    , e_forward_diff          , e_boundary_insulated, 157,  93, 0.30, 0.20, 0.1, 0, false, true , 300 }
+  , { e_wave_leapfrog    , e_forward_diff_9_point  , e_boundary_insulated, 157,  93, 0.30, 0.20, 0.1, 0, false, true ,   1 }
+  , { e_implicit_multigrid, e_forward_diff         , e_boundary_insulated, 157,  93, 5.00, 4.00, 1.0, 0, false, true ,   1 }
+  , { e_super_time_step  , e_forward_diff          , e_boundary_insulated, 157,  93, 3.00, 2.00, 1.0, 0, false, true ,   1 }
+ };
+
+// _______________________________________________________________________________________________
+
+  void
+append_sheet( std::vector< float > & values, sheet_type const & sheet)
+{
+    values.insert( values.end( ), sheet.begin( ), sheet.end( ));
+}
+
+  void
+solve_at_level
+ (  cpu_features::simd_level_type  level
+  , solve_case_type const &        solve_case
+  , std::vector< float > &         values      // return value, the solved sheets end to end
+ )
+{
+    d_verify( finite_difference::simd::set_kernel_level( level));
+
+    settable_input_params_type input_params;
+    input_params.set_technique( solve_case.technique);
+    input_params.set_method( solve_case.method);
+    input_params.set_boundary( solve_case.boundary);
+    input_params.set_rate_x( solve_case.rate_x);
+    input_params.set_rate_y( solve_case.rate_y);
+    input_params.set_damping( solve_case.damping);
+    input_params.set_extra_pass_count( solve_case.extra_pass_count);
+    input_params.set__is_method_parallel( solve_case.is_parallel);
+
+    size_type const  x_count  = solve_case.x_count;
+    size_type const  y_count  = solve_case.y_count;
+    sheet_type src_sheet, trg_sheet, extra_sheet, velocity_sheet;
+    src_sheet  .set_xy_counts( x_count, y_count, 0);
+    trg_sheet  .set_xy_counts( x_count, y_count, 0);
+    extra_sheet.set_xy_counts( x_count, y_count, 0);
+    for ( size_type index = 0 ; index < src_sheet.get_xy_count( ) ; ++ index ) {
+        src_sheet.begin( )[ index ] = solve_case.init_scale * test::get_init_value< float >( index);
+    }
+
+    // The wave solves keep the last generation in extra (and the leapfrog its velocity).
+    bool const is_leapfrog = (e_wave_leapfrog == solve_case.technique);
+    if ( is_leapfrog || (e_wave_with_damping == solve_case.technique) ) {
+        for ( size_type index = 0 ; index < extra_sheet.get_xy_count( ) ; ++ index ) {
+            extra_sheet.begin( )[ index ] = - solve_case.init_scale * test::get_init_value< float >( index + 3);
+        }
+    }
+    if ( is_leapfrog ) {
+        velocity_sheet.set_xy_counts( x_count, y_count, 0);
+        for ( size_type index = 0 ; index < velocity_sheet.get_xy_count( ) ; ++ index ) {
+            velocity_sheet.begin( )[ index ] =
+                0.1f * solve_case.init_scale * test::get_init_value< float >( index + 7);
+        }
+    }
+
+    conductivity_sheet_type conductivity_sheet;
+    if ( solve_case.is_varying ) {
+        conductivity_sheet.set_xy_counts( x_count, y_count, 1.0f);
+        for ( size_type index = 0 ; index < conductivity_sheet.get_xy_count( ) ; ++ index ) {
+            conductivity_sheet.begin( )[ index ] = 0.5f + (0.5f * test::get_init_value< float >( index + 11));
+        }
+    }
+
+    solver_type solver;
+    solver.calc_next
+     (  input_params
+      , sheet_params_type
+         (  src_sheet, trg_sheet, extra_sheet
+          , solve_case.is_varying ? (& conductivity_sheet) : 0
+          , is_leapfrog ? (& velocity_sheet) : 0
+         )
+     );
+
+    values.clear( );
+    append_sheet( values, src_sheet  );
+    append_sheet( values, trg_sheet  );
+    append_sheet( values, extra_sheet);
+    if ( is_leapfrog ) { append_sheet( values, velocity_sheet); }
+}
+
+  void
+solve_fixed16_at_level
+ (  cpu_features::simd_level_type  level
+  , int                            x_count
+  , int                            y_count
+  , std::vector< float > &         values      // return value, the solved sheets end to end
+ )
+{
+    d_verify( finite_difference::simd::set_kernel_level( level));
+
+    settable_input_params_type input_params;
+    input_params.set_technique( e_simultaneous_2d);
+    input_params.set_method( e_forward_diff);
+    input_params.set_rate_x( 0.2);
+    input_params.set_rate_y( 0.15);
+    input_params.set_extra_pass_count( 2);
+    input_params.set__is_method_parallel( true);
+
+    fixed16_sheet_type src_sheet, trg_sheet, extra_sheet;
+    src_sheet  .set_xy_counts( x_count, y_count, uniform_scalar_16_type( 0));
+    trg_sheet  .set_xy_counts( x_count, y_count, uniform_scalar_16_type( 0));
+    extra_sheet.set_xy_counts( x_count, y_count, uniform_scalar_16_type( 0));
+    for ( size_type index = 0 ; index < src_sheet.get_xy_count( ) ; ++ index ) {
+        src_sheet.begin( )[ index ] = uniform_scalar_16_type( test::get_init_value< float >( index));
+    }
+
+    fixed16_solver_type solver;
+    d_verify( fixed16_solver_type::can_solve( input_params));
+    solver.calc_next
+     (  input_params
+      , fixed16_solver_type::sheet_params_type( src_sheet, trg_sheet, extra_sheet, 0, 0)
+     );
+
+    // 16-bit fixed-point values are exactly floats.
+    sheet_type trg_float, extra_float;
+    trg_sheet  .copy_to( trg_float  );
+    extra_sheet.copy_to( extra_float);
+    values.clear( );
+    append_sheet( values, trg_float  );
+    append_sheet( values, extra_float);
+}
+
+  void
+solve_rows_at_level
+ (  cpu_features::simd_level_type  level
+  , int                            count
+  , std::vector< float > &         values      // return value, the solved rows end to end
+ )
+  //
+  // The 1D implicit solves, with each kind of damping, and the tridiagonal solve.
+{
+    d_verify( finite_difference::simd::set_kernel_level( level));
+
+    std::vector< float > src( count), trg( count), temp_a( count), temp_b( count);
+    for ( int index = 0 ; index < count ; ++ index ) {
+        src[ index ] = test::get_init_value< float >( index);
+    }
+
+    values.clear( );
+    float const dampings[ ] = { 1.0f, 0.5f, 0.0f };
+    for ( std::size_t index = 0 ; index < (sizeof( dampings) / sizeof( dampings[ 0 ])) ; ++ index ) {
+        // Some dampings use the old trg values.
+        for ( int i = 0 ; i < count ; ++ i ) { trg[ i ] = test::get_init_value< float >( i + 5); }
+        finite_difference::calc_next_generation_backward_difference_1d
+         ( dampings[ index ], 1.5f, src.begin( ), src.end( ), trg.begin( ), temp_a.begin( ), temp_b.begin( ));
+        values.insert( values.end( ), trg.begin( ), trg.end( ));
+
+        for ( int i = 0 ; i < count ; ++ i ) { trg[ i ] = test::get_init_value< float >( i + 5); }
+        finite_difference::calc_next_generation_central_difference_1d
+         ( dampings[ index ], 0.4f, src.begin( ), src.end( ), trg.begin( ), temp_a.begin( ), temp_b.begin( ));
+        values.insert( values.end( ), trg.begin( ), trg.end( ));
+    }
+
+    // The tridiagonal solves destroy the diagonal and src, so they get fresh copies.
+    for ( int is_sum = 0 ; is_sum < 2 ; ++ is_sum ) {
+        std::vector< float > diag( count, 4.0f), src_copy( src);
+        for ( int i = 0 ; i < count ; ++ i ) { trg[ i ] = test::get_init_value< float >( i + 5); }
+        if ( is_sum ) {
+            finite_difference::solve_matrix_destructive
+             ( util::assign_sum_type< float >( ), 1.5f, count, diag.begin( ), src_copy.begin( ), trg.begin( ));
+        } else {
+            finite_difference::solve_matrix_destructive
+             ( util::assign_set_type< float >( ), 1.5f, count, diag.begin( ), src_copy.begin( ), trg.begin( ));
+        }
+        values.insert( values.end( ), trg.begin( ), trg.end( ));
+    }
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_simd_kernels_match_scalar( )
+{
+    cpu_features::simd_level_type const  best_level  = cpu_features::get_simd_level( );
+    std::vector< float >  scalar_values;
+    std::vector< float >  simd_values;
+
+    for ( std::size_t index = 0 ; index < (sizeof( g_solve_cases) / sizeof( g_solve_cases[ 0 ])) ; ++ index ) {
+        solve_at_level( cpu_features::e_scalar, g_solve_cases[ index ], scalar_values);
+        for ( int level = cpu_features::e_sse2 ; level <= best_level ; ++ level ) {
+            solve_at_level( cpu_features::simd_level_type( level), g_solve_cases[ index ], simd_values);
+            if ( ! test_check( test::is_same_bits( scalar_values, simd_values)) ) {
+                std::fprintf( stderr, "  solve case %d, level %s\n", static_cast< int >( index),
+                    cpu_features::get_simd_level_name( cpu_features::simd_level_type( level)));
+            }
+        }
+    }
+
+    int const fixed16_sizes[ ][ 2 ] = { { 157, 93 }, { 37, 1 }, { 5, 7 } };
+    for ( std::size_t index = 0 ; index < (sizeof( fixed16_sizes) / sizeof( fixed16_sizes[ 0 ])) ; ++ index ) {
+        int const  x_count  = fixed16_sizes[ index ][ 0 ];
+        int const  y_count  = fixed16_sizes[ index ][ 1 ];
+        solve_fixed16_at_level( cpu_features::e_scalar, x_count, y_count, scalar_values);
+        for ( int level = cpu_features::e_sse2 ; level <= best_level ; ++ level ) {
+            solve_fixed16_at_level( cpu_features::simd_level_type( level), x_count, y_count, simd_values);
+            test_check( test::is_same_bits( scalar_values, simd_values));
+        }
+    }
+
+    // The 1D solvers need at least two cells (the solver never asks for fewer).
+    int const row_counts[ ] = { 2, 3, 17, 157 };
+    for ( std::size_t index = 0 ; index < (sizeof( row_counts) / sizeof( row_counts[ 0 ])) ; ++ index ) {
+        solve_rows_at_level( cpu_features::e_scalar, row_counts[ index ], scalar_values);
+        for ( int level = cpu_features::e_sse2 ; level <= best_level ; ++ level ) {
+            solve_rows_at_level( cpu_features::simd_level_type( level), row_counts[ index ], simd_values);
+            test_check( test::is_same_bits( scalar_values, simd_values));
+        }
+    }
+
+    d_verify( finite_difference::simd::set_kernel_level( best_level));
+}
+
+  void
+test_simd_kernel_levels( )
+  //
+  // We can switch to any level up to the CPU's, and no higher.
+{
+    cpu_features::simd_level_type const  best_level  = cpu_features::get_simd_level( );
+    for ( int level = cpu_features::e_scalar ; level <= cpu_features::e_avx512 ; ++ level ) {
+        bool const is_set = finite_difference::simd::set_kernel_level( cpu_features::simd_level_type( level));
+        test_check( is_set == (level <= best_level));
+        if ( is_set ) {
+            test_check( level == finite_difference::simd::get_kernels( ).level);
+            test_check( level == linear_algebra::simd::get_kernels( ).level);
+            test_check( (cpu_features::e_scalar == level) == (0 == finite_difference::simd::get_kernels( ).forward_diff_2d_middle));
+        }
+    }
+    d_verify( finite_difference::simd::set_kernel_level( best_level));
+}
+
+  void
+test_simd_kernel_tables( )
+  //
+  // Each vector level fills in every kernel in both tables, so no solver falls back to the
+  // scalar code by accident. The scalar level leaves them all zero. Each level has its own name.
+{
+    cpu_features::simd_level_type const  best_level  = cpu_features::get_simd_level( );
+    for ( int level = cpu_features::e_scalar ; level <= best_level ; ++ level ) {
+        d_verify( finite_difference::simd::set_kernel_level( cpu_features::simd_level_type( level)));
+        finite_difference::simd::kernels_type const &  fd  = finite_difference::simd::get_kernels( );
+        linear_algebra::simd::kernels_type    const &  la  = linear_algebra::simd::get_kernels( );
+
+        bool const  is_vector  = (cpu_features::e_scalar != level);
+        test_check( is_vector == (0 != fd.forward_diff_2d_middle       ));
+        test_check( is_vector == (0 != fd.forward_diff_2d_edge         ));
+        test_check( is_vector == (0 != fd.forward_diff_thin_strip      ));
+        test_check( is_vector == (0 != fd.forward_diff_2d_9_point      ));
+        test_check( is_vector == (0 != fd.forward_diff_2d_4th_order    ));
+        test_check( is_vector == (0 != fd.forward_diff_2d_varying      ));
+        test_check( is_vector == (0 != fd.leapfrog_velocity            ));
+        test_check( is_vector == (0 != fd.backward_diff_1d             ));
+        test_check( is_vector == (0 != fd.central_diff_1d              ));
+        test_check( is_vector == (0 != fd.backward_diff_columns        ));
+        test_check( is_vector == (0 != fd.central_diff_columns         ));
+        test_check( is_vector == (0 != fd.backward_diff_columns_varying));
+        test_check( is_vector == (0 != fd.central_diff_columns_varying ));
+        test_check( is_vector == (0 != fd.forward_diff_2d_fixed16      ));
+        test_check( is_vector == (0 != la.solve_tridiagonal_set        ));
+        test_check( is_vector == (0 != la.solve_tridiagonal_sum        ));
+    }
+    d_verify( finite_difference::simd::set_kernel_level( best_level));
+
+    for ( int level = cpu_features::e_scalar ; level <= cpu_features::e_avx512 ; ++ level ) {
+        char const * const  p_name  = cpu_features::get_simd_level_name( cpu_features::simd_level_type( level));
+        test_check( 0 != p_name[ 0 ]);
+        for ( int other = cpu_features::e_scalar ; other < level ; ++ other ) {
+            test_check( 0 != std::strcmp( p_name, cpu_features::get_simd_level_name( cpu_features::simd_level_type( other))));
+        }
+    }
+}
+
+test::registrar_type const  register_match_scalar( "simd_kernels_match_scalar", & test_simd_kernels_match_scalar);
+test::registrar_type const  register_levels(       "simd_kernel_levels"       , & test_simd_kernel_levels       );
+test::registrar_type const  register_tables(       "simd_kernel_tables"       , & test_simd_kernel_tables       );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_simd_kernels.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
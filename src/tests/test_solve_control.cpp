@@ -0,0 +1,194 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_solve_control.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the sheet requests in sheet_control_type (solve_control.h).
+//
+// Requests made while a solve or a transform is pending wait in a list, and are honored oldest
+// first when it is done. These tests post requests that do not commute (resize-and-fill and
+// scale), so the values in the sheet afterwards tell us the order they were honored in. The
+// generation count tells us how many of them were honored.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include "solve_control.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+typedef sheet_control_type::gen_type  gen_type ;
+
+// _______________________________________________________________________________________________
+
+  void
+init_control( sheet_control_type & control)
+  //
+  // One plain heat pass per solve, and draw the whole sheet.
+{
+    control.get_heat_solver( )->set_technique( heat_solver::e_simultaneous_2d);
+    control.get_heat_solver( )->set_method( heat_solver::e_forward_diff);
+    control.get_heat_solver( )->set_pass_count( 1);
+    control.set__is_draw_size_limited( false);
+}
+
+  void
+wait_until_idle( sheet_control_type & control)
+  //
+  // Every pending solve or transform ends with sheet_is_changed( ), and may start another.
+{
+    while ( control.is_next_solve_pending( ) || control.is_transform_pending( ) ) {
+        test::wait_for_signal( & control, SIGNAL( sheet_is_changed( )));
+    }
+}
+
+  gen_type
+get_last_solve_count( sheet_control_type & control)
+{
+    heat_solver::output_params_type const * const
+        p_output_params = control.get_heat_solver( )->get_output_params( );
+    return p_output_params ? static_cast< gen_type >( p_output_params->get_solve_count( )) : 0;
+}
+
+  bool
+is_sheet_filled
+ (  sheet_control_type &   control
+  , sheet_type::size_type  x_count
+  , sheet_type::size_type  y_count
+  , sheet_type::value_type value
+ )
+{
+    sheet_type const & sheet = control.get_sheet_for_draw( );
+    sheet_type::value_type min_value = 0;
+    sheet_type::value_type max_value = 0;
+    return
+        (sheet.get_x_count( ) == x_count) &&
+        (sheet.get_y_count( ) == y_count) &&
+        sheet.get_min_max_values( min_value, max_value) &&
+        (min_value == value) &&
+        (max_value == value);
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_sheet_requests_now( )
+  //
+  // With nothing pending, a request is honored right away.
+{
+    sheet_control_type control;
+    init_control( control);
+    gen_type const generation = control.get_sheet_generation( );
+
+    control.request_set_xy_sizes( 12, 10, 1.5f);
+    test_check( ! control.is_transform_pending( ));
+    test_check( is_sheet_filled( control, 12, 10, 1.5f));
+    test_check( generation + 1 == control.get_sheet_generation( ));
+}
+
+  void
+test_sheet_requests_in_order( )
+  //
+  // Requests posted during a solve are honored oldest first when it is done. The scale runs in
+  // the worker thread, and the requests after it wait for it.
+{
+    sheet_control_type control;
+    init_control( control);
+    control.request_set_xy_sizes( 12, 10, 1.0f);
+
+    gen_type const generation = control.get_sheet_generation( );
+    control.single_step_solve( );
+    test_check( control.is_next_solve_pending( ));
+
+    control.request_scale_sheet( 2.0f, 1.0f);
+    control.request_set_xy_sizes( 9, 7, 0.5f);
+    control.request_scale_sheet( 3.0f, 1.0f);
+    wait_until_idle( control);
+
+    // Fill with 0.5 and then scale by 3. Any other order leaves something else.
+    test_check( is_sheet_filled( control, 9, 7, 1.5f));
+    test_check( generation + get_last_solve_count( control) + 3 == control.get_sheet_generation( ));
+
+    // Again, with the transform between two resizes.
+    control.single_step_solve( );
+    control.request_set_xy_sizes( 5, 4, 0.25f);
+    control.request_scale_sheet( 4.0f, 1.0f);
+    control.request_set_xy_sizes( 6, 4, 0.75f);
+    wait_until_idle( control);
+    test_check( is_sheet_filled( control, 6, 4, 0.75f));
+}
+
+  void
+test_sheet_requests_deferred( )
+  //
+  // A request that can't be honored yet does not hold up the ones after it. It is tried again
+  // after the next solve. Reversing the wave twice is the same as not reversing it, so of three
+  // reverse requests only one is left.
+{
+    sheet_control_type control;
+    init_control( control);
+    control.request_set_xy_sizes( 12, 10, 1.0f);
+
+    // The resize throws away the history, so the wave can't be reversed after it.
+    gen_type generation = control.get_sheet_generation( );
+    control.single_step_solve( );
+    control.request_set_xy_sizes( 11, 9, 1.0f);
+    control.request_reverse_wave( );
+    control.request_reverse_wave( );
+    control.request_reverse_wave( );
+    control.request_scale_sheet( 2.0f, 1.0f);
+    wait_until_idle( control);
+    test_check( is_sheet_filled( control, 11, 9, 2.0f));
+    test_check( generation + get_last_solve_count( control) + 2 == control.get_sheet_generation( ));
+
+    // The next solve leaves history, so the reverse is honored now. Only once.
+    generation = control.get_sheet_generation( );
+    control.single_step_solve( );
+    wait_until_idle( control);
+    test_check( generation + get_last_solve_count( control) + 1 == control.get_sheet_generation( ));
+
+    // And it's not tried again.
+    generation = control.get_sheet_generation( );
+    control.single_step_solve( );
+    wait_until_idle( control);
+    test_check( generation + get_last_solve_count( control) == control.get_sheet_generation( ));
+
+    // Two reverse requests cancel, so there is nothing to honor after the next solve.
+    control.single_step_solve( );
+    control.request_set_xy_sizes( 11, 9, 1.0f);
+    control.request_reverse_wave( );
+    control.request_reverse_wave( );
+    wait_until_idle( control);
+    generation = control.get_sheet_generation( );
+    control.single_step_solve( );
+    wait_until_idle( control);
+    test_check( generation + get_last_solve_count( control) == control.get_sheet_generation( ));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_now(      "sheet_requests_now"     , & test_sheet_requests_now     );
+test::registrar_type const  register_in_order( "sheet_requests_in_order", & test_sheet_requests_in_order);
+test::registrar_type const  register_deferred( "sheet_requests_deferred", & test_sheet_requests_deferred);
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_solve_control.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,228 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_spectral.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the cosine transforms in spectral.h, and the e_spectral_jump technique in
+// heat_solver.cpp.
+//
+// The transforms are checked against the sum in the definition. The technique is checked
+// against the pass-by-pass solve, and against the exact gain of a cosine mode.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <vector>
+# include <algorithm>
+# include "heat_solver.h"
+# include "spectral.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef double_sheet_type::size_type  size_type ;
+
+// _______________________________________________________________________________________________
+
+  void
+solve
+ (  technique_type              technique
+  , method_type                 method
+  , bool                        is_parallel
+  , double                      rate_x
+  , double                      rate_y
+  , size_type                   generation_count
+  , double_sheet_type const &   src_sheet
+  , double_sheet_type        &  result_sheet
+  , double_sheet_type        &  history_sheet
+ )
+  //
+  // Solves generation_count generations of src_sheet in one calc_next(..). The last generation
+  // goes in result_sheet, and the one before it (the history) in history_sheet.
+{
+    settable_input_params_type input_params;
+    input_params.set_technique( technique);
+    input_params.set_method( method);
+    input_params.set__is_method_parallel( is_parallel);
+    input_params.set_rate_x( static_cast< rate_type >( rate_x));
+    input_params.set_rate_y( static_cast< rate_type >( rate_y));
+    input_params.set_extra_pass_count( static_cast< int >( generation_count - 1));
+
+    double_sheet_type src;
+    src = src_sheet;
+    double_sheet_type trg;
+    trg = src_sheet;
+    double_sheet_type extra;
+    extra = src_sheet;
+    double_solver_type solver;
+    solver.calc_next( input_params, double_sheet_params_type( src, trg, extra, 0, 0));
+    output_params_type const & output_params = solver.get_output_params( );
+    test_check( generation_count == output_params.get_solve_count( ));
+    result_sheet  = trg;
+    history_sheet = output_params.is_last_solve_saved_in_extra( ) ? extra : src;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_spectral_transform( )
+  //
+  // The FFT-based transforms match the definition, and inverse(..) undoes forward(..). The
+  // sizes include 1, primes, powers of 2 and their neighbors, since each takes its own path.
+{
+    std::size_t const  sizes[ ] = { 1, 2, 3, 5, 8, 12, 16, 17, 31, 64, 100, 127, 128, 129, 256, 1000 };
+    double const       pi       = spectral::get_pi( );
+
+    for ( std::size_t size_index = 0 ; size_index < (sizeof( sizes) / sizeof( sizes[ 0 ])) ; ++ size_index ) {
+        std::size_t const  n  = sizes[ size_index ];
+        spectral::dct_plan_type plan;
+        plan.set_up( n);
+        std::vector< spectral::dct_plan_type::complex_type > scratch( plan.get_scratch_size( ));
+
+        std::vector< double > values( n);
+        for ( std::size_t x = 0 ; x < n ; ++ x ) {
+            values[ x ] = std::sin( (x * 1.7) + 0.3) + static_cast< double >( x % 3);
+        }
+        std::vector< double > transformed( values);
+        plan.forward( & transformed[ 0 ], & scratch[ 0 ]);
+
+        double max_error = 0;
+        for ( std::size_t k = 0 ; k < n ; ++ k ) {
+            double sum = 0;
+            for ( std::size_t x = 0 ; x < n ; ++ x ) {
+                sum += std::cos( pi * k * (x + 0.5) / n) * values[ x ];
+            }
+            double const  expected  = std::sqrt( ((0 == k) ? 1.0 : 2.0) / n) * sum;
+            max_error = std::max( max_error, std::fabs( expected - transformed[ k ]));
+        }
+        test_check( max_error < 1e-11);
+
+        plan.inverse( & transformed[ 0 ], & scratch[ 0 ]);
+        max_error = 0;
+        for ( std::size_t x = 0 ; x < n ; ++ x ) {
+            max_error = std::max( max_error, std::fabs( values[ x ] - transformed[ x ]));
+        }
+        test_check( max_error < 1e-11);
+    }
+}
+
+  void
+test_spectral_matches_passes( )
+  //
+  // Jumping N generations gives the same sheets (to rounding) as solving N forward-diff passes
+  // one at a time, including the history the wave technique would need. Odd sizes, serial and
+  // parallel.
+{
+    size_type const  size_cases[ ][ 2 ] = { { 1, 1 }, { 7, 5 }, { 64, 48 }, { 157, 93 } };
+    size_type const  generation_counts[ ] = { 1, 2, 9 };
+
+    for ( std::size_t size_index = 0 ; size_index < (sizeof( size_cases) / sizeof( size_cases[ 0 ])) ; ++ size_index ) {
+        size_type const  x_count  = size_cases[ size_index ][ 0 ];
+        size_type const  y_count  = size_cases[ size_index ][ 1 ];
+
+        double_sheet_type src;
+        d_verify( src.set_xy_counts( x_count, y_count, 0));
+        for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+            src.begin( )[ index ] = test::get_init_value< double >( index);
+        }
+
+        for ( std::size_t count_index = 0 ; count_index < (sizeof( generation_counts) / sizeof( generation_counts[ 0 ])) ; ++ count_index ) {
+            for ( int parallel_index = 0 ; parallel_index < 2 ; ++ parallel_index ) {
+                bool const  is_parallel  = (0 != parallel_index);
+                double_sheet_type passes;
+                double_sheet_type passes_history;
+                solve( e_simultaneous_2d, e_forward_diff, is_parallel, 0.2, 0.15,
+                    generation_counts[ count_index ], src, passes, passes_history);
+                double_sheet_type jump;
+                double_sheet_type jump_history;
+                solve( e_spectral_jump, e_forward_diff, is_parallel, 0.2, 0.15,
+                    generation_counts[ count_index ], src, jump, jump_history);
+                test_check( test::get_max_difference( passes, jump) < 1e-12);
+                test_check( test::get_max_difference( passes_history, jump_history) < 1e-12);
+            }
+        }
+    }
+}
+
+  void
+test_spectral_gain( )
+  //
+  // A cosine mode is scaled by gain^N, where gain is the exact one-generation gain of the
+  // method. The big rates are split into stable sub-steps for forward diff.
+{
+    size_type const  x_count           = 90;
+    size_type const  y_count           = 70;
+    size_type const  generation_count  = 8;
+    double const     rates[ ]          = { 0.2, 5.0, 50.0 };
+    double const     pi                = spectral::get_pi( );
+
+    for ( int mode = 1 ; mode < 12 ; mode += 5 ) {
+        double_sheet_type src;
+        d_verify( src.set_xy_counts( x_count, y_count, 0));
+        for ( size_type y = 0 ; y < y_count ; ++ y ) {
+            for ( size_type x = 0 ; x < x_count ; ++ x ) {
+                src.begin( )[ (y * x_count) + x ] =
+                    std::cos( pi * mode * (x + 0.5) / x_count) *
+                    std::cos( pi * (mode + 1) * (y + 0.5) / y_count);
+            }
+        }
+
+        double const  x_eigen  = 4 * std::pow( std::sin( pi * mode       / (2.0 * x_count)), 2);
+        double const  y_eigen  = 4 * std::pow( std::sin( pi * (mode + 1) / (2.0 * y_count)), 2);
+
+        for ( std::size_t rate_index = 0 ; rate_index < (sizeof( rates) / sizeof( rates[ 0 ])) ; ++ rate_index ) {
+            for ( int method_index = 0 ; method_index < 2 ; ++ method_index ) {
+                method_type const  method  = (0 == method_index) ? e_backward_diff : e_central_diff;
+                double const       rate_x  = rates[ rate_index ];
+                double const       rate_y  = rates[ rate_index ] / 2;
+
+                double_sheet_type result;
+                double_sheet_type history;
+                solve( e_spectral_jump, method, false, rate_x, rate_y, generation_count, src, result, history);
+
+                // The rates go thru rate_type (float) on the way in.
+                double const  decay  =
+                    (static_cast< rate_type >( rate_x) * x_eigen) + (static_cast< rate_type >( rate_y) * y_eigen);
+                double const  gain   =
+                    (e_backward_diff == method) ? (1 / (1 + decay)) : ((1 - (decay / 2)) / (1 + (decay / 2)));
+                double const  total  = std::pow( gain, static_cast< double >( generation_count));
+
+                double max_error = 0;
+                for ( size_type index = 0 ; index < src.get_xy_count( ) ; ++ index ) {
+                    max_error = std::max( max_error, std::fabs( result.begin( )[ index ] - (total * src.begin( )[ index ])));
+                }
+                test_check( max_error < 1e-12);
+            }
+        }
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_transform(      "spectral_transform"     , & test_spectral_transform     );
+test::registrar_type const  register_matches_passes( "spectral_matches_passes", & test_spectral_matches_passes);
+test::registrar_type const  register_gain(           "spectral_gain"          , & test_spectral_gain          );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_spectral.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,304 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_stencils.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the 9-point and 4th-order forward-diff stencils.
+//
+// The solves are checked against a plain double-precision version of each stencil, with the
+// insulated edges mirrored the same way (the cell just outside an edge is the cell just inside
+// it). The sheets go down to 1x1, so the mirror reaches all the way across.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <vector>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+double const  g_pi  = 3.14159265358979323846;
+
+// _______________________________________________________________________________________________
+
+  void
+calc_reference
+ (  method_type                    method
+  , double                         rate_x
+  , double                         rate_y
+  , long                           x_count
+  , long                           y_count
+  , std::vector< double > const &  src
+  , std::vector< double >       &  trg      // out
+ )
+{
+    trg.resize( src.size( ));
+    for ( long y = 0 ; y < y_count ; ++ y ) {
+        for ( long x = 0 ; x < x_count ; ++ x ) {
+# define CELL( X, Y) src[ (test::get_mirror_index( (Y), y_count) * x_count) + test::get_mirror_index( (X), x_count) ]
+            double const  center  = CELL( x, y);
+            double value = 0;
+            if ( e_forward_diff_9_point == method ) {
+                double const  dxx  = CELL( x - 1, y) + CELL( x + 1, y) - (2 * center);
+                double const  dyy  = CELL( x, y - 1) + CELL( x, y + 1) - (2 * center);
+                double const  dxy  =
+                    (CELL( x - 1, y - 1) + CELL( x + 1, y - 1) + CELL( x - 1, y + 1) + CELL( x + 1, y + 1)) -
+                    (2 * (CELL( x, y - 1) + CELL( x, y + 1) + CELL( x - 1, y) + CELL( x + 1, y))) +
+                    (4 * center);
+                value = center + (rate_x * dxx) + (rate_y * dyy) + (((rate_x + rate_y) / 12) * dxy);
+            } else {
+                double const  dx  = (16 * (CELL( x - 1, y) + CELL( x + 1, y))) - (CELL( x - 2, y) + CELL( x + 2, y)) - (30 * center);
+                double const  dy  = (16 * (CELL( x, y - 1) + CELL( x, y + 1))) - (CELL( x, y - 2) + CELL( x, y + 2)) - (30 * center);
+                value = center + ((rate_x / 12) * dx) + ((rate_y / 12) * dy);
+            }
+# undef CELL
+            trg[ (y * x_count) + x ] = value;
+        }
+    }
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  void
+solve_once
+ (  settable_input_params_type const &  input_params
+  , SHEET_TYPE                const &  init_sheet
+  , SHEET_TYPE                      &  trg           // out
+ )
+{
+    SHEET_TYPE src;
+    src = init_sheet;
+    trg = init_sheet;
+    SHEET_TYPE extra;
+    extra = init_sheet;
+    SOLVER_TYPE solver;
+    solver.calc_next( input_params, typename SOLVER_TYPE::sheet_params_type( src, trg, extra, 0, 0));
+}
+
+  template< typename SHEET_TYPE, typename SOLVER_TYPE >
+  bool
+check_against_reference
+ (  method_type  method
+  , long         x_count
+  , long         y_count
+  , float        rate_x
+  , float        rate_y
+  , bool         is_parallel
+  , double       tolerance
+ )
+  //
+  // One pass against the reference, and the total heat stays put.
+{
+    SHEET_TYPE init_sheet;
+    d_verify( init_sheet.set_xy_counts( x_count, y_count, 0));
+    for ( size_type index = 0 ; index < init_sheet.get_xy_count( ) ; ++ index ) {
+        init_sheet.begin( )[ index ] = test::get_init_value< float >( index);
+    }
+    settable_input_params_type input_params = test::get_input_params( e_simultaneous_2d, method, rate_x, rate_y);
+    input_params.set__is_method_parallel( is_parallel);
+    SHEET_TYPE trg;
+    solve_once< SHEET_TYPE, SOLVER_TYPE >( input_params, init_sheet, trg);
+
+    std::vector< double > const  src( init_sheet.begin( ), init_sheet.end( ));
+    std::vector< double >        expected;
+    calc_reference( method, rate_x, rate_y, x_count, y_count, src, expected);
+    double max_error  = 0;
+    double src_sum    = 0;
+    double trg_sum    = 0;
+    for ( std::size_t index = 0 ; index < src.size( ) ; ++ index ) {
+        max_error = std::max( max_error, std::fabs( expected[ index ] - trg.begin( )[ index ]));
+        src_sum += src[ index ];
+        trg_sum += trg.begin( )[ index ];
+    }
+    return (max_error < tolerance) && (std::fabs( trg_sum - src_sum) < (1e-4 + (tolerance * src.size( ))));
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_stencils_match_reference( )
+  //
+  // Both stencils, float and double, serial and parallel, on sheets from big to 1x1.
+{
+    long const  sizes[ ][ 2 ] =
+     { { 157, 93 }, { 1, 1 }, { 2, 3 }, { 3, 2 }, { 5, 7 }, { 1, 9 }, { 9, 1 }, { 4, 4 }, { 17, 13 }, { 64, 5 } };
+    method_type const  methods[ ] = { e_forward_diff_9_point, e_forward_diff_4th_order };
+    for ( int is_parallel = 0 ; is_parallel < 2 ; ++ is_parallel ) {
+        for ( std::size_t m = 0 ; m < (sizeof( methods) / sizeof( methods[ 0 ])) ; ++ m ) {
+            float const  rate_x  = (e_forward_diff_9_point == methods[ m ]) ? 0.3f  : 0.2f;
+            float const  rate_y  = (e_forward_diff_9_point == methods[ m ]) ? 0.25f : 0.1f;
+            for ( std::size_t s = 0 ; s < (sizeof( sizes) / sizeof( sizes[ 0 ])) ; ++ s ) {
+                long const  x_count  = sizes[ s ][ 0 ];
+                long const  y_count  = sizes[ s ][ 1 ];
+                bool const  is_float_ok   =
+                    check_against_reference< sheet_type, solver_type >
+                     ( methods[ m ], x_count, y_count, rate_x, rate_y, 0 != is_parallel, 2e-6);
+                bool const  is_double_ok  =
+                    check_against_reference< double_sheet_type, double_solver_type >
+                     ( methods[ m ], x_count, y_count, rate_x, rate_y, 0 != is_parallel, 1e-12);
+                if ( ! test_check( is_float_ok && is_double_ok) ) {
+                    std::fprintf( stderr, "  method %d, %ldx%ld, %s\n", static_cast< int >( methods[ m ]),
+                        x_count, y_count, is_parallel ? "parallel" : "serial");
+                }
+            }
+        }
+    }
+}
+
+  void
+test_fourth_order_accuracy( )
+  //
+  // A cosine along x is an eigenmode of the Laplacian, with eigenvalue -theta*theta. With the
+  // exact Laplacian one forward-diff step scales it by (1 - rate * theta * theta). The 5-point
+  // stencil is off from that by about rate * theta^4 / 12, and the 4th-order stencil by about
+  // rate * theta^6 / 90.
+{
+    long const        x_count  = 157;
+    long const        y_count  = 5;
+    size_type const   waves    = 12;
+    double const      theta    = (g_pi * waves) / x_count;
+    float const       rate     = 0.15f;
+
+    double_sheet_type mode;
+    d_verify( mode.set_xy_counts( x_count, y_count, 0));
+    for ( long y = 0 ; y < y_count ; ++ y ) {
+        for ( long x = 0 ; x < x_count ; ++ x ) {
+            mode.begin( )[ (y * x_count) + x ] = std::cos( theta * (x + 0.5));
+        }
+    }
+    double const  exact_gain  = 1 - (rate * theta * theta);
+
+    method_type const  methods[ ] = { e_forward_diff, e_forward_diff_9_point, e_forward_diff_4th_order };
+    double errors[ 3 ] = { 0, 0, 0 };
+    for ( std::size_t m = 0 ; m < (sizeof( methods) / sizeof( methods[ 0 ])) ; ++ m ) {
+        double_sheet_type trg;
+        solve_once< double_sheet_type, double_solver_type >
+         ( test::get_input_params( e_simultaneous_2d, methods[ m ], rate, rate), mode, trg);
+        for ( size_type index = 0 ; index < mode.get_xy_count( ) ; ++ index ) {
+            errors[ m ] = std::max( errors[ m ], std::fabs( trg.begin( )[ index ] - (exact_gain * mode.begin( )[ index ])));
+        }
+    }
+    // The 9-point stencil is the same as the 5-point when nothing changes along y.
+    test_check( std::fabs( errors[ 1 ] - errors[ 0 ]) < 1e-12);
+    test_check( errors[ 2 ] < (errors[ 0 ] / 20));
+}
+
+  void
+test_stencils_stay_bounded( )
+  //
+  // A checkerboard (the fastest growing mode) just inside each stencil's limit does not grow
+  // in 2000 generations.
+{
+    method_type const  methods[ ] = { e_forward_diff_9_point, e_forward_diff_4th_order };
+    float const        rates_x[ ] = { 0.49f, 0.185f };
+    float const        rates_y[ ] = { 0.25f, 0.185f };
+    for ( std::size_t m = 0 ; m < (sizeof( methods) / sizeof( methods[ 0 ])) ; ++ m ) {
+        settable_input_params_type const  input_params  =
+            test::get_input_params( e_simultaneous_2d, methods[ m ], rates_x[ m ], rates_y[ m ]);
+
+        sheet_type sheet_a;
+        d_verify( sheet_a.set_xy_counts( 64, 48, 0));
+        for ( size_type index = 0 ; index < sheet_a.get_xy_count( ) ; ++ index ) {
+            sheet_a.begin( )[ index ] = (0 == (((index / 64) + index) % 2)) ? -1.0f : 1.0f;
+        }
+        sheet_type sheet_b;
+        sheet_b = sheet_a;
+        sheet_type extra;
+        solver_type solver;
+        sheet_type * p_src = & sheet_a;
+        sheet_type * p_trg = & sheet_b;
+        for ( int generation = 0 ; generation < 2000 ; ++ generation ) {
+            solver.calc_next( input_params, sheet_params_type( *p_src, *p_trg, extra, 0, 0));
+            std::swap( p_src, p_trg);
+        }
+        test_check( 1 == solver.get_output_params( ).get_sub_step_count( ));
+        float min_value = 0;
+        float max_value = 0;
+        p_src->get_min_max_values( min_value, max_value);
+        test_check( (min_value >= -1.0001f) && (max_value <= 1.0001f));
+    }
+}
+
+  void
+test_stencils_solved_method( )
+  //
+  // The techniques with the 5-point operator built in solve the wide stencils as plain forward
+  // diff, and multi-pass solves of the wide stencils are that many single passes.
+{
+    test_check( e_forward_diff           == get_solved_method( e_ortho_interleave  , e_forward_diff_9_point  ));
+    test_check( e_forward_diff           == get_solved_method( e_implicit_multigrid, e_forward_diff_4th_order));
+    test_check( e_forward_diff           == get_solved_method( e_spectral_jump     , e_forward_diff_9_point  ));
+    test_check( e_forward_diff           == get_solved_method( e_super_time_step   , e_forward_diff_4th_order));
+    test_check( e_forward_diff_9_point   == get_solved_method( e_simultaneous_2d   , e_forward_diff_9_point  ));
+    test_check( e_forward_diff_4th_order == get_solved_method( e_wave_with_damping , e_forward_diff_4th_order));
+
+    sheet_type init_sheet;
+    d_verify( init_sheet.set_xy_counts( 157, 93, 0));
+    for ( size_type index = 0 ; index < init_sheet.get_xy_count( ) ; ++ index ) {
+        init_sheet.begin( )[ index ] = test::get_init_value< float >( index);
+    }
+
+    sheet_type wide_trg;
+    solve_once< sheet_type, solver_type >( test::get_input_params( e_ortho_interleave, e_forward_diff_9_point, 0.3f, 0.2f), init_sheet, wide_trg);
+    sheet_type plain_trg;
+    solve_once< sheet_type, solver_type >( test::get_input_params( e_ortho_interleave, e_forward_diff, 0.3f, 0.2f), init_sheet, plain_trg);
+    test_check(
+        test::is_same_bits
+         (  std::vector< float >( wide_trg.begin( ), wide_trg.end( ))
+          , std::vector< float >( plain_trg.begin( ), plain_trg.end( ))
+         ));
+
+    settable_input_params_type input_params = test::get_input_params( e_simultaneous_2d, e_forward_diff_9_point, 0.2f, 0.2f);
+    input_params.set_extra_pass_count( 5);
+    sheet_type multi_trg;
+    solve_once< sheet_type, solver_type >( input_params, init_sheet, multi_trg);
+
+    input_params.set_extra_pass_count( 0);
+    sheet_type single_trg;
+    single_trg = init_sheet;
+    for ( int pass = 0 ; pass < 6 ; ++ pass ) {
+        sheet_type next;
+        solve_once< sheet_type, solver_type >( input_params, single_trg, next);
+        single_trg = next;
+    }
+    test_check(
+        test::is_same_bits
+         (  std::vector< float >( multi_trg.begin( ), multi_trg.end( ))
+          , std::vector< float >( single_trg.begin( ), single_trg.end( ))
+         ));
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_match_reference(  "stencils_match_reference" , & test_stencils_match_reference );
+test::registrar_type const  register_fourth_order(     "fourth_order_accuracy"    , & test_fourth_order_accuracy    );
+test::registrar_type const  register_stay_bounded(     "stencils_stay_bounded"    , & test_stencils_stay_bounded    );
+test::registrar_type const  register_solved_method(    "stencils_solved_method"   , & test_stencils_solved_method   );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_stencils.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
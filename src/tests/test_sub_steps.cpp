@@ -0,0 +1,306 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_sub_steps.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the stable sub-steps in heat_solver.cpp.
+//
+// A pass with rates past the stability limit is split into sub-steps with smaller rates. That
+// must be the same, bit for bit, as solving that many small passes one at a time.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <vector>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+size_type const  g_x_count  = 157;
+size_type const  g_y_count  =  93;
+
+// _______________________________________________________________________________________________
+
+  void
+fill_smooth( sheet_type & sheet)
+  //
+  // A few long waves, so the sub-steps agree with each other and there's no refining.
+{
+    d_verify( sheet.set_xy_counts( g_x_count, g_y_count, 0));
+    for ( size_type y = 0 ; y < g_y_count ; ++ y ) {
+        for ( size_type x = 0 ; x < g_x_count ; ++ x ) {
+            sheet.begin( )[ (y * g_x_count) + x ] =
+                static_cast< float >(
+                    (0.5 * std::cos( (x + 0.5) * 0.04) * std::cos( (y + 0.5) * 0.07)) +
+                    (0.3 * std::sin( (x + 0.5) * 0.02 + (y + 0.5) * 0.03)));
+        }
+    }
+}
+
+  void
+fill_checkerboard( sheet_type & sheet)
+  //
+  // The mode that forward diff damps the least, so the error estimate is big.
+{
+    d_verify( sheet.set_xy_counts( g_x_count, g_y_count, 0));
+    for ( size_type y = 0 ; y < g_y_count ; ++ y ) {
+        for ( size_type x = 0 ; x < g_x_count ; ++ x ) {
+            sheet.begin( )[ (y * g_x_count) + x ] = (0 == ((x + y) % 2)) ? 0.9f : -0.9f;
+        }
+    }
+}
+
+  void
+solve_small_passes
+ (  settable_input_params_type const &  input_params    // the full rates
+  , size_type                           pass_count
+  , bool                                is_in_place
+  , sheet_type                       &  sheet           // in and out
+ )
+  //
+  // The reference: pass_count passes one at a time, each with (rate / pass_count).
+{
+    settable_input_params_type small_params = input_params;
+    small_params.set_extra_pass_count( 0);
+    small_params.set_rate_x( input_params.get_rate_x( ) / rate_type( pass_count));
+    small_params.set_rate_y( input_params.get_rate_y( ) / rate_type( pass_count));
+
+    solver_type solver;
+    sheet_type trg;
+    trg = sheet;
+    sheet_type extra;
+    for ( size_type pass = 0 ; pass < pass_count ; ++ pass ) {
+        if ( is_in_place ) {
+            solver.calc_next( small_params, sheet_params_type( sheet, sheet, extra, 0, 0));
+        } else {
+            solver.calc_next( small_params, sheet_params_type( sheet, trg, extra, 0, 0));
+            sheet = trg;
+        }
+        test_check( 1 == solver.get_output_params( ).get_sub_step_count( ));
+    }
+}
+
+  size_type
+check_split_pass
+ (  settable_input_params_type const &  input_params
+  , bool                                is_in_place
+  , sheet_type                const &  init_sheet
+ )
+  //
+  // Solves one pass with input_params, and checks it against the same number of small passes.
+  // Returns the sub-step count.
+{
+    sheet_type src;
+    src = init_sheet;
+    sheet_type trg;
+    trg = init_sheet;
+    sheet_type extra;
+    solver_type solver;
+    if ( is_in_place ) {
+        solver.calc_next( input_params, sheet_params_type( src, src, extra, 0, 0));
+    } else {
+        solver.calc_next( input_params, sheet_params_type( src, trg, extra, 0, 0));
+    }
+    size_type const  sub_step_count  = solver.get_output_params( ).get_sub_step_count( );
+
+    sheet_type expected;
+    expected = init_sheet;
+    solve_small_passes( input_params, sub_step_count, is_in_place, expected);
+    test_check(
+        test::is_same_bits
+         (  std::vector< float >( expected.begin( ), expected.end( ))
+          , is_in_place ?
+              std::vector< float >( src.begin( ), src.end( )) :
+              std::vector< float >( trg.begin( ), trg.end( ))
+         ));
+    return sub_step_count;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_sub_step_count( )
+  //
+  // The smallest count that brings each sub-step inside the stability limit.
+{
+    // Forward diff: (rate_x + rate_y) < 1/2. Right on the limit is not inside it.
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff, 0.2f, 0.15f));
+    test_check(    2 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff, 0.25f, 0.25f));
+    test_check(   11 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff, 3.0f, 2.0f));
+
+    // Each 1D pass on its own.
+    test_check(    7 == solver_type::get_stable_sub_step_count( e_ortho_interleave, e_forward_diff, 3.0f, 2.0f));
+    test_check(    7 == solver_type::get_stable_sub_step_count( e_ortho_interleave, e_central_diff, 2.0f, 3.0f));
+
+    // The 9-point and 4th-order stencils.
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff_9_point, 0.45f, 0.2f));
+    test_check(    2 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff_9_point, 0.4f, 0.4f));
+    test_check(    2 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff_4th_order, 0.2f, 0.2f));
+
+    // Stable at any rate.
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_backward_diff, 30.0f, 30.0f));
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_implicit_multigrid, e_central_diff, 30.0f, 30.0f));
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_spectral_jump, e_central_diff, 30.0f, 30.0f));
+    test_check(  121 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_central_diff, 30.0f, 30.0f));
+
+    // Never split: waves, negative rates. And there's a cap.
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_wave_with_damping, e_forward_diff, 3.0f, 3.0f));
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_wave_leapfrog, e_forward_diff, 3.0f, 3.0f));
+    test_check(    1 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff, -3.0f, 0.2f));
+    test_check( 1024 == solver_type::get_stable_sub_step_count( e_simultaneous_2d, e_forward_diff, 1000.0f, 1000.0f));
+}
+
+  void
+test_sub_steps_match_small_passes( )
+  //
+  // A split pass is the same as the small passes, including in place. A smooth sheet needs only
+  // the stable count.
+{
+    sheet_type smooth;
+    fill_smooth( smooth);
+
+    settable_input_params_type input_params = test::get_input_params( e_simultaneous_2d, e_forward_diff, 3.0f, 2.1f);
+    test_check( 11 == check_split_pass( input_params, false, smooth));
+
+    input_params = test::get_input_params( e_ortho_interleave, e_forward_diff, 3.0f, 2.1f);
+    test_check( 7 == check_split_pass( input_params, true, smooth));
+
+    input_params = test::get_input_params( e_simultaneous_2d, e_central_diff, 3.0f, 2.1f);
+    test_check( 11 == check_split_pass( input_params, false, smooth));
+
+    input_params = test::get_input_params( e_simultaneous_2d, e_forward_diff, 0.2f, 0.15f);
+    test_check( 1 == check_split_pass( input_params, false, smooth));
+}
+
+  void
+test_sub_steps_refine( )
+  //
+  // When the first two sub-steps disagree too much the pass starts over with twice as many,
+  // at most twice. Starting over must not disturb an in-place (interleave) solve.
+{
+    sheet_type checkerboard;
+    fill_checkerboard( checkerboard);
+
+    // The stable count is 2.
+    settable_input_params_type input_params = test::get_input_params( e_simultaneous_2d, e_forward_diff, 0.3f, 0.3f);
+    test_check( 8 == check_split_pass( input_params, false, checkerboard));
+
+    input_params = test::get_input_params( e_ortho_interleave, e_forward_diff, 0.6f, 0.6f);
+    test_check( 8 == check_split_pass( input_params, true, checkerboard));
+
+    // The estimate is reported, and is past the tolerance since we gave up refining.
+    sheet_type src;
+    src = checkerboard;
+    sheet_type trg;
+    trg = checkerboard;
+    sheet_type extra;
+    solver_type solver;
+    input_params = test::get_input_params( e_simultaneous_2d, e_forward_diff, 0.3f, 0.3f);
+    solver.calc_next( input_params, sheet_params_type( src, trg, extra, 0, 0));
+    test_check( solver.get_output_params( ).get_step_error_estimate( ) > solver_type::get_step_error_tolerance( ));
+}
+
+  void
+test_sub_steps_multi_pass( )
+  //
+  // Each pass of a multi-pass solve is split. The history (in extra) is the last full pass,
+  // not the last sub-step.
+{
+    sheet_type smooth;
+    fill_smooth( smooth);
+    settable_input_params_type input_params = test::get_input_params( e_simultaneous_2d, e_forward_diff, 3.0f, 2.1f);
+    input_params.set_extra_pass_count( 2);
+
+    sheet_type src;
+    src = smooth;
+    sheet_type trg;
+    trg = smooth;
+    sheet_type extra;
+    extra = smooth;
+    solver_type solver;
+    solver.calc_next( input_params, sheet_params_type( src, trg, extra, 0, 0));
+    output_params_type const & output_params = solver.get_output_params( );
+    test_check( 3 == output_params.get_solve_count( ));
+    test_check( 11 == output_params.get_sub_step_count( ));
+    test_check( output_params.is_last_solve_saved_in_extra( ));
+
+    sheet_type history;
+    history = smooth;
+    solve_small_passes( input_params, 11, false, history);
+    solve_small_passes( input_params, 11, false, history);
+    sheet_type expected;
+    expected = history;
+    solve_small_passes( input_params, 11, false, expected);
+    test_check( test::is_same_bits( std::vector< float >( expected.begin( ), expected.end( )), std::vector< float >( trg.begin( ), trg.end( ))));
+    test_check( test::is_same_bits( std::vector< float >( history.begin( ), history.end( )), std::vector< float >( extra.begin( ), extra.end( ))));
+}
+
+  void
+test_sub_steps_stay_bounded( )
+  //
+  // Far past the limit, the split solve still acts like heat: no new highs or lows, and with
+  // insulated edges the total heat stays put.
+{
+    sheet_type smooth;
+    fill_smooth( smooth);
+    float init_min = 0;
+    float init_max = 0;
+    smooth.get_min_max_values( init_min, init_max);
+    double init_sum = 0;
+    for ( size_type index = 0 ; index < smooth.get_xy_count( ) ; ++ index ) { init_sum += smooth.begin( )[ index ]; }
+
+    method_type const  methods[ ] = { e_forward_diff, e_central_diff };
+    for ( std::size_t index = 0 ; index < (sizeof( methods) / sizeof( methods[ 0 ])) ; ++ index ) {
+        sheet_type src;
+        src = smooth;
+        sheet_type trg;
+        trg = smooth;
+        sheet_type extra;
+        solver_type solver;
+        solver.calc_next( test::get_input_params( e_simultaneous_2d, methods[ index ], 30.0f, 20.0f), sheet_params_type( src, trg, extra, 0, 0));
+        test_check( 101 <= solver.get_output_params( ).get_sub_step_count( ));
+
+        float min_value = 0;
+        float max_value = 0;
+        trg.get_min_max_values( min_value, max_value);
+        test_check( (min_value >= init_min) && (max_value <= init_max));
+        double sum = 0;
+        for ( size_type cell = 0 ; cell < trg.get_xy_count( ) ; ++ cell ) { sum += trg.begin( )[ cell ]; }
+        test_check( std::fabs( sum - init_sum) < 1e-2);
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_count(          "sub_step_count"              , & test_sub_step_count              );
+test::registrar_type const  register_match_small(    "sub_steps_match_small_passes", & test_sub_steps_match_small_passes);
+test::registrar_type const  register_refine(         "sub_steps_refine"            , & test_sub_steps_refine            );
+test::registrar_type const  register_multi_pass(     "sub_steps_multi_pass"        , & test_sub_steps_multi_pass        );
+test::registrar_type const  register_stay_bounded(   "sub_steps_stay_bounded"      , & test_sub_steps_stay_bounded      );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_sub_steps.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,280 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_super_steps.cpp
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+// _______________________________________________________________________________________________
+//
+// Tests for the RKL2 super-time-step technique in heat_solver.cpp.
+//
+// A cosine that fits the insulated edges is an eigenmode of the 5-point stencil. Each forward-
+// diff stencil only scales it, and so does the whole super-step, by a gain that should be close
+// to the exact decay exp(-(rate_x * eigen_x + rate_y * eigen_y)) and never bigger than 1.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include "all.h"
+# include <cmath>
+# include <vector>
+# include "heat_solver.h"
+# include "test_util.h"
+
+namespace /* anonymous */ {
+
+using namespace heat_solver;
+
+typedef sheet_type::size_type  size_type ;
+
+size_type const  g_x_count  = 157;
+size_type const  g_y_count  =  93;
+
+double const  g_pi  = 3.14159265358979323846;
+
+// _______________________________________________________________________________________________
+
+  double
+get_eigen( size_type wave_count, size_type count)
+  //
+  // How much one stencil with rate 1 takes away from the cosine with wave_count half-waves.
+{
+    return 2 - (2 * std::cos( (g_pi * wave_count) / count));
+}
+
+  void
+fill_eigenmode( sheet_type & sheet, size_type x_waves, size_type y_waves)
+{
+    d_verify( sheet.set_xy_counts( g_x_count, g_y_count, 0));
+    for ( size_type y = 0 ; y < g_y_count ; ++ y ) {
+        for ( size_type x = 0 ; x < g_x_count ; ++ x ) {
+            sheet.begin( )[ (y * g_x_count) + x ] =
+                static_cast< float >(
+                    0.9 *
+                    std::cos( (g_pi * x_waves * (x + 0.5)) / g_x_count) *
+                    std::cos( (g_pi * y_waves * (y + 0.5)) / g_y_count));
+        }
+    }
+}
+
+  void
+fill_noise( sheet_type & sheet)
+  //
+  // Every mode at once, from a small linear congruential generator.
+{
+    d_verify( sheet.set_xy_counts( g_x_count, g_y_count, 0));
+    unsigned long seed = 12345;
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        seed = ((seed * 1103515245UL) + 12345UL) & 0x7fffffffUL;
+        sheet.begin( )[ index ] = static_cast< float >( (double( seed) / 0x7fffffffUL) - 0.5);
+    }
+}
+
+  void
+solve_once
+ (  settable_input_params_type const &  input_params
+  , sheet_type                const &  init_sheet
+  , sheet_type                      &  trg            // out
+  , size_type                       *  p_sub_steps    // out, can be null
+ )
+{
+    sheet_type src;
+    src = init_sheet;
+    trg = init_sheet;
+    sheet_type extra;
+    solver_type solver;
+    solver.calc_next( input_params, sheet_params_type( src, trg, extra, 0, 0));
+    if ( p_sub_steps ) { *p_sub_steps = solver.get_output_params( ).get_sub_step_count( ); }
+}
+
+  double
+get_sum_of_squares( sheet_type const & sheet)
+{
+    double sum = 0;
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) {
+        double const  value  = sheet.begin( )[ index ];
+        sum += value * value;
+    }
+    return sum;
+}
+
+  double
+get_sum( sheet_type const & sheet)
+{
+    double sum = 0;
+    for ( size_type index = 0 ; index < sheet.get_xy_count( ) ; ++ index ) { sum += sheet.begin( )[ index ]; }
+    return sum;
+}
+
+// _______________________________________________________________________________________________
+
+  void
+test_super_stage_count( )
+  //
+  // The smallest s (at least 2) with (s*s + s - 2) >= 8 * (rate_x + rate_y), up to the cap.
+{
+    test_check(   2 == solver_type::get_super_stage_count( 0.0f, 0.0f));
+    test_check(   2 == solver_type::get_super_stage_count( 0.25f, 0.25f));
+    test_check(   3 == solver_type::get_super_stage_count( 0.3f, 0.3f));
+    test_check(   6 == solver_type::get_super_stage_count( 3.0f, 2.0f));
+    test_check(   8 == solver_type::get_super_stage_count( 5.0f, 3.5f));
+    test_check( 256 == solver_type::get_super_stage_count( 10000.0f, 10000.0f));
+
+    for ( int step = 1 ; step <= 2000 ; ++ step ) {
+        float const      rate   = 0.037f * step;
+        double const     need   = 8 * (double( rate) + double( rate * 0.6f));
+        size_type const  count  = solver_type::get_super_stage_count( rate, rate * 0.6f);
+        test_check( double( (count * count) + count - 2) >= need);
+        test_check( (2 == count) || (double( ((count - 1) * (count - 1)) + (count - 1) - 2) < need));
+    }
+}
+
+  void
+test_super_step_eigenmode( )
+  //
+  // A long wave decays by about exp(-z) in one step, where the plain forward-diff stencil would
+  // need many. The step is never split. RKL2 is second order, so the error in one step grows
+  // as z*z*z. A first-order step (like backward diff) would be off by about z*z/2.
+{
+    test_check( 1 == solver_type::get_stable_sub_step_count( e_super_time_step, e_forward_diff, 30.0f, 20.0f));
+
+    size_type const  x_waves  = 3;
+    size_type const  y_waves  = 2;
+    sheet_type mode;
+    fill_eigenmode( mode, x_waves, y_waves);
+
+    float const  rates[ ] = { 0.1f, 1.0f, 5.0f, 20.0f };
+    for ( std::size_t index = 0 ; index < (sizeof( rates) / sizeof( rates[ 0 ])) ; ++ index ) {
+        float const  rate_x  = rates[ index ];
+        float const  rate_y  = rates[ index ] * 0.7f;
+        sheet_type trg;
+        size_type sub_steps = 0;
+        solve_once( test::get_input_params( e_super_time_step, e_forward_diff, rate_x, rate_y), mode, trg, & sub_steps);
+        test_check( 1 == sub_steps);
+
+        double const  z         = (rate_x * get_eigen( x_waves, g_x_count)) + (rate_y * get_eigen( y_waves, g_y_count));
+        double const  expected  = std::exp( -z);
+        double max_error = 0;
+        for ( size_type cell = 0 ; cell < mode.get_xy_count( ) ; ++ cell ) {
+            double const  error  = std::fabs( trg.begin( )[ cell ] - (expected * mode.begin( )[ cell ]));
+            if ( error > max_error ) { max_error = error; }
+        }
+        test_check( max_error < (1e-6 + ((z * z * z) / 10)));
+    }
+}
+
+  void
+test_super_step_stable( )
+  //
+  // Far past the forward-diff limit, on noise and on the shortest waves: the sum of squares
+  // never grows, and with insulated edges the total heat stays put. The shortest wave is the
+  // one a plain forward-diff stencil would blow up.
+{
+    sheet_type noise;
+    fill_noise( noise);
+    double const  noise_squares  = get_sum_of_squares( noise);
+    double const  noise_sum      = get_sum( noise);
+
+    sheet_type stiff;
+    fill_eigenmode( stiff, g_x_count - 1, g_y_count - 1);
+    double const  stiff_squares  = get_sum_of_squares( stiff);
+
+    float const  rates[ ] = { 0.3f, 3.0f, 50.0f, 400.0f };
+    for ( std::size_t index = 0 ; index < (sizeof( rates) / sizeof( rates[ 0 ])) ; ++ index ) {
+        settable_input_params_type const  input_params  =
+            test::get_input_params( e_super_time_step, e_forward_diff, rates[ index ], rates[ index ] * 0.6f);
+
+        sheet_type trg;
+        solve_once( input_params, noise, trg, 0);
+        test_check( get_sum_of_squares( trg) <= noise_squares);
+        test_check( std::fabs( get_sum( trg) - noise_sum) < 1e-2);
+
+        solve_once( input_params, stiff, trg, 0);
+        test_check( get_sum_of_squares( trg) <= stiff_squares);
+    }
+}
+
+  void
+test_super_step_parallel( )
+  //
+  // The parallel stencil gives the same bits as the serial one, and the double solver agrees
+  // with the float solver.
+{
+    sheet_type noise;
+    fill_noise( noise);
+
+    settable_input_params_type input_params = test::get_input_params( e_super_time_step, e_forward_diff, 5.0f, 3.5f);
+    sheet_type serial_trg;
+    solve_once( input_params, noise, serial_trg, 0);
+
+    input_params.set__is_method_parallel( true);
+    sheet_type parallel_trg;
+    solve_once( input_params, noise, parallel_trg, 0);
+    test_check(
+        test::is_same_bits
+         (  std::vector< float >( serial_trg.begin( ), serial_trg.end( ))
+          , std::vector< float >( parallel_trg.begin( ), parallel_trg.end( ))
+         ));
+
+    double_sheet_type double_src;
+    d_verify( double_src.set_xy_counts( g_x_count, g_y_count, 0));
+    for ( size_type index = 0 ; index < noise.get_xy_count( ) ; ++ index ) { double_src.begin( )[ index ] = noise.begin( )[ index ]; }
+    double_sheet_type double_trg;
+    double_trg = double_src;
+    double_sheet_type double_extra;
+    double_solver_type double_solver;
+    double_solver.calc_next( input_params, double_sheet_params_type( double_src, double_trg, double_extra, 0, 0));
+    double max_error = 0;
+    for ( size_type index = 0 ; index < noise.get_xy_count( ) ; ++ index ) {
+        double const  error  = std::fabs( double_trg.begin( )[ index ] - serial_trg.begin( )[ index ]);
+        if ( error > max_error ) { max_error = error; }
+    }
+    test_check( max_error < 1e-5);
+}
+
+  void
+test_super_step_other_methods( )
+  //
+  // Backward and central diff are not explicit, so they solve like simultaneous 2d.
+{
+    sheet_type noise;
+    fill_noise( noise);
+
+    method_type const  methods[ ] = { e_backward_diff, e_central_diff };
+    for ( std::size_t index = 0 ; index < (sizeof( methods) / sizeof( methods[ 0 ])) ; ++ index ) {
+        sheet_type super_trg;
+        solve_once( test::get_input_params( e_super_time_step, methods[ index ], 0.2f, 0.15f), noise, super_trg, 0);
+        sheet_type simultaneous_trg;
+        solve_once( test::get_input_params( e_simultaneous_2d, methods[ index ], 0.2f, 0.15f), noise, simultaneous_trg, 0);
+        test_check(
+            test::is_same_bits
+             (  std::vector< float >( super_trg.begin( ), super_trg.end( ))
+              , std::vector< float >( simultaneous_trg.begin( ), simultaneous_trg.end( ))
+             ));
+    }
+}
+
+// _______________________________________________________________________________________________
+
+test::registrar_type const  register_stage_count(    "super_stage_count"        , & test_super_stage_count        );
+test::registrar_type const  register_eigenmode(      "super_step_eigenmode"     , & test_super_step_eigenmode     );
+test::registrar_type const  register_stable(         "super_step_stable"        , & test_super_step_stable        );
+test::registrar_type const  register_parallel(       "super_step_parallel"      , & test_super_step_parallel      );
+test::registrar_type const  register_other_methods(  "super_step_other_methods" , & test_super_step_other_methods );
+
+} /* end anonymous namespace */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_super_steps.cpp - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -0,0 +1,150 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// test_util.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010. <nealabq@gmail.com> nealabq.com
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef TEST_UTIL_H
+# define TEST_UTIL_H
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// A very small test harness.
+//
+//   Each test_*.cpp file registers its tests with a registrar_type at namespace scope:
+//
+//     namespace /* anonymous */ {
+//       void test_something( ) { test_check( 2 == (1 + 1)); }
+//       test::registrar_type const register_something( "something", & test_something);
+//     }
+//
+//   test_main.cpp runs them all (or the ones named on the command line), and exits with 1 if
+//   any check fails. A failed check prints its file, line and expression, and the test keeps
+//   going so you see all the failures at once.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <algorithm>
+# include <cmath>
+# include <cstddef>
+# include <cstring>
+# include <vector>
+# include "heat_solver.h"
+
+class QObject;
+
+namespace test {
+
+// _______________________________________________________________________________________________
+
+typedef void (* test_function_type)( );
+
+  class
+registrar_type
+{
+  public:
+    /* ctor */          registrar_type( char const * p_name, test_function_type p_function) ;
+};
+
+// Records a failed check if is_ok is false. Returns is_ok.
+bool  check( bool is_ok, char const * p_file, int line, char const * p_expression) ;
+
+# define test_check( is_ok) test::check( (is_ok), __FILE__, __LINE__, # is_ok)
+
+// Runs an event loop until p_sender emits p_signal (from SIGNAL( ..)). The solver's worker
+// thread reports back thru queued signals, so this is how a test waits for a solve.
+void  wait_for_signal( QObject const * p_sender, char const * p_signal) ;
+
+// _______________________________________________________________________________________________
+// Bit compare
+//
+//   True if the two float sequences have exactly the same bits (so -0 is not 0, and a NaN
+//   equals the same NaN).
+
+  inline
+  bool
+is_same_bits( std::vector< float > const & a, std::vector< float > const & b)
+{
+    return
+        (a.size( ) == b.size( )) &&
+        (a.empty( ) || (0 == std::memcmp( & a[ 0 ], & b[ 0 ], a.size( ) * sizeof( float))));
+}
+
+// _______________________________________________________________________________________________
+// Sheet helpers shared by the solver tests
+//
+//   get_init_value(..) is a smooth wave with a faster ripple on it, so every stencil has
+//   something to do. It is worked out in double and rounded once to VALUE_TYPE, so a test can
+//   put the same values in a float sheet and in its double-precision reference.
+//
+//   get_mirror_index(..) reflects index off the edges until it lands inside [0, count), the way
+//   insulated edges see the cells past them.
+
+  template< typename VALUE_TYPE >
+  VALUE_TYPE
+get_init_value( std::size_t index, double amplitude = 0.9)
+{
+    return static_cast< VALUE_TYPE >( amplitude * std::sin( index * 0.01) * std::cos( index * 0.37));
+}
+
+  template< typename SHEET_TYPE >
+  double
+get_max_difference( SHEET_TYPE const & sheet_a, SHEET_TYPE const & sheet_b)
+{
+    d_assert( sheet_a.get_xy_count( ) == sheet_b.get_xy_count( ));
+    double max_difference = 0;
+    for ( std::size_t index = 0 ; index < sheet_a.get_xy_count( ) ; ++ index ) {
+        max_difference =
+            std::max( max_difference, std::fabs( double( sheet_a.begin( )[ index ]) - sheet_b.begin( )[ index ]));
+    }
+    return max_difference;
+}
+
+  inline
+  long
+get_mirror_index( long index, long count)
+{
+    long const  period  = 2 * count;
+    index %= period;
+    if ( index < 0 ) { index += period; }
+    return (index < count) ? index : (period - 1 - index);
+}
+
+  inline
+  heat_solver::settable_input_params_type
+get_input_params
+ (  heat_solver::technique_type  technique
+  , heat_solver::method_type     method
+  , float                        rate_x
+  , float                        rate_y
+ )
+{
+    heat_solver::settable_input_params_type input_params;
+    input_params.set_technique( technique);
+    input_params.set_method( method);
+    input_params.set_rate_x( rate_x);
+    input_params.set_rate_y( rate_y);
+    return input_params;
+}
+
+// _______________________________________________________________________________________________
+
+} /* end namespace test */
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef TEST_UTIL_H
+//
+// test_util.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
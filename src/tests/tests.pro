@@ -0,0 +1,78 @@
+# Qt profile file for the tests
+# Used to generate makefiles
+#
+#   Copyright (c) Neal Binnendyk 2009, 2010.
+#     <nealabq@gmail.com>
+#     <http://nealabq.com/>
+#
+#   |=== GPL License Notice ====================================================================|
+#   | This code is free software: you can redistribute it and/or modify it under the terms      |
+#   | of the GNU General Public License as published by the Free Software Foundation, either    |
+#   | version 3 of the License, or (at your option) any later version.                          |
+#   |                                                                                           |
+#   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+#   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+#   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+#   |=== END License Notice ====================================================================|
+#
+# Builds heat_tests, a console app that runs the solver tests without the GL window.
+#   qmake tests.pro && make && ./heat_tests
+
+TARGET = heat_tests
+TEMPLATE = app
+
+CONFIG += qt thread exceptions stl console warn_on debug_and_release
+CONFIG -= app_bundle
+QT = core
+
+DEFINES += QT_THREAD_SUPPORT
+DEFINES += QT_NO_USING_NAMESPACE
+DEFINES += QT_ASCII_CAST_WARNINGS
+DEFINES += QT_MOC_COMPAT
+
+win32:DEFINES += WIN32
+win32:DEFINES += _SECURE_SCL=0
+
+CONFIG(release, debug|release) {
+  DEFINES += NDEBUG
+}
+
+win32:INCLUDEPATH = c:/boost_1_39_0
+INCLUDEPATH += ..
+
+HEADERS =                          \
+  test_util.h                      \
+  ../heat_solver.h                 \
+  ../solve_control.h
+
+SOURCES =                          \
+  test_boundaries.cpp              \
+  test_clamp.cpp                   \
+  test_conductivity.cpp            \
+  test_draw_buffer.cpp             \
+  test_finite_diff.cpp             \
+  test_fixed_point.cpp             \
+  test_free_run.cpp                \
+  test_half_float.cpp              \
+  test_leapfrog.cpp                \
+  test_main.cpp                    \
+  test_multigrid.cpp               \
+  test_quiet_tiles.cpp             \
+  test_row_pool.cpp                \
+  test_sheet_stats.cpp             \
+  test_sheet_transforms.cpp        \
+  test_simd_kernels.cpp            \
+  test_solve_control.cpp           \
+  test_spectral.cpp                \
+  test_stencils.cpp                \
+  test_sub_steps.cpp               \
+  test_super_steps.cpp             \
+  ../cpu_features.cpp              \
+  ../date_time.cpp                 \
+  ../draw_buffer.cpp               \
+  ../finite_diff_simd.cpp          \
+  ../heat_solver.cpp               \
+  ../line_walker.cpp               \
+  ../row_pool.cpp                  \
+  ../sheet.cpp                     \
+  ../solve_control.cpp
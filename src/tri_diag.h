@@ -22,6 +22,7 @@
 // _______________________________________________________________________________________________
 // ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 
+# include <iterator>
 # include "util.h"
 
 namespace linear_algebra {
@@ -425,6 +426,274 @@ solve_tridiagonal_destructive
     d_assert( out_vect_first == out_vect);
 }
 
+// _______________________________________________________________________________________________
+// factor_tridiagonal
+//  (  count
+//   , sub_diag_value, diag_values, super_diag_value
+//   , scale_vect
+//  )
+// solve_tridiagonal_factored
+//  (  assign_functor_type (2-param)
+//   , count
+//   , scale_vect, diag_values, super_diag_value
+//   , in_vect
+//   , out_vect
+//  )
+//
+//   The same solve as solve_tridiagonal_destructive(..) above, split in two.
+//
+//   factor_tridiagonal(..) is the part that only depends on the matrix. It eliminates the
+//   sub-diagonal, leaving the new diagonal in diag_vect and the scale factors in scale_vect.
+//   This is an LU factorization: scale_vect is the sub-diagonal of L, and diag_vect and
+//   super_diag_value are the diagonals of U.
+//
+//   solve_tridiagonal_factored(..) does the rest for one in_vect. It does not change the factored
+//   matrix, so if you solve many vectors with the same matrix you only have to factor it once.
+//   The arithmetic is the same as solve_tridiagonal_destructive(..), so the results are the same.
+
+  template
+   <  typename ITEM_TYPE
+    , typename DIAG_ITER_TYPE       // readable and writable, input and output
+    , typename SCALE_ITER_TYPE      // writable, output
+   >
+  void
+factor_tridiagonal
+ (  std::size_t     const  count             // number of items in diag_vect
+  , ITEM_TYPE       const  sub_diag_value    // value filling the sub-diagonal
+  , DIAG_ITER_TYPE         diag_vect         // main diagonal, no zero entries
+  , ITEM_TYPE       const  super_diag_value  // value filling the super-diagonal
+  , SCALE_ITER_TYPE        scale_vect        // (count - 1) scale factors
+ )
+{
+    d_assert( 0 < count);
+    DIAG_ITER_TYPE const diag_vect_last = diag_vect + (count - 1);
+
+    while ( diag_vect != diag_vect_last ) {
+        // No values in diag_vect should be zero.
+        d_assert( 0 != (*diag_vect));
+        ITEM_TYPE const scale = sub_diag_value / (*diag_vect);
+        (*scale_vect) = scale;
+        ++ scale_vect;
+
+        ++ diag_vect;
+        (*diag_vect) -= scale * super_diag_value;
+    }
+    d_assert( 0 != (*diag_vect));
+}
+
+  template
+   <  typename ASSIGN_FUNCTOR_TYPE
+    , typename ITEM_TYPE
+    , typename SCALE_ITER_TYPE      // readable, from factor_tridiagonal(..)
+    , typename DIAG_ITER_TYPE       // readable, from factor_tridiagonal(..)
+    , typename IN_VECT_ITER_TYPE    // readable and writable, used as input and temp storage
+    , typename OUT_VECT_ITER_TYPE   // writable, output
+   >
+  void
+solve_tridiagonal_factored
+ (  ASSIGN_FUNCTOR_TYPE    assign_functor    // used to assign final value to out_vect
+  , std::size_t     const  count             // number of items in each of the vectors below
+  , SCALE_ITER_TYPE        scale_vect        // (count - 1) scale factors
+  , DIAG_ITER_TYPE         diag_vect         // factored main diagonal
+  , ITEM_TYPE       const  super_diag_value  // value filling the super-diagonal
+  , IN_VECT_ITER_TYPE      in_vect           // vector on other side of equal sign
+  , OUT_VECT_ITER_TYPE     out_vect          // vector to be solved
+ )
+  // out_vect can be the same as in_vect.
+{
+    d_assert( 0 < count);
+    std::size_t const count_minus = count - 1;
+
+    // Forward iteration, only over in_vect.
+    IN_VECT_ITER_TYPE const in_vect_first = in_vect;
+    IN_VECT_ITER_TYPE const in_vect_last  = in_vect + count_minus;
+    while ( in_vect != in_vect_last ) {
+        ITEM_TYPE const delta = (*scale_vect) * (*in_vect);
+        ++ scale_vect;
+        ++ in_vect;
+        (*in_vect) -= delta;
+    }
+
+    // Sweep backwards assigning items in out_vect.
+    diag_vect += count_minus;
+    out_vect  += count_minus;
+    ITEM_TYPE out_vect_value = (*in_vect) / (*diag_vect);
+    while ( in_vect != in_vect_first ) {
+        assign_functor( *out_vect, out_vect_value);
+        -- out_vect;
+        -- diag_vect;
+        -- in_vect;
+        out_vect_value = ((*in_vect) - (super_diag_value * out_vect_value)) / (*diag_vect);
+    }
+    assign_functor( *out_vect, out_vect_value);
+}
+
+// _______________________________________________________________________________________________
+// reduce_tridiagonal_partition
+//  (  count
+//   , sub_diag_value, diag_values, super_diag_value
+//   , in_vect
+//   , sub_out_vect, super_out_vect
+//  )
+// solve_tridiagonal_unit_destructive
+//  (  count
+//   , sub_vect, super_vect
+//   , in_vect
+//  )
+// finish_tridiagonal_partition
+//  (  assign_functor_type (2-param)
+//   , count
+//   , sub_vect, super_vect, in_vect
+//   , first_value, last_value
+//   , out_vect
+//  )
+//
+//   Solves one long system as several partitions that can be worked on at the same time.
+//   Each solve above is one long chain of dependencies, so a single row can only use one thread.
+//
+//   1. reduce_tridiagonal_partition(..) eliminates everything inside one partition (a run of
+//      rows in the big system). Afterwards each row i in the partition says:
+//        x[i] + (sub_out[i] * x[first]) + (super_out[i] * x[last]) == in[i]
+//      where first and last are the first and last rows of the partition. Except the first
+//      row refers to the row just before the partition instead of x[first], and the last row
+//      refers to the row just after the partition instead of x[last].
+//   2. The first and last rows of all the partitions make a small tridiagonal system with 1 on
+//      the diagonal. Solve it with solve_tridiagonal_unit_destructive(..).
+//   3. finish_tridiagonal_partition(..) uses the solved first and last values to find the rest
+//      of the values in one partition.
+//
+//   Steps 1 and 3 don't share anything between partitions. Step 2 is only 2 rows per partition.
+//
+//   This does about twice the arithmetic of solve_tridiagonal_destructive(..), and the results
+//   are only close to (not exactly) the same. Like that solver it doesn't pivot, so the matrix
+//   should be diagonally dominant. Every partition must be at least 3 rows.
+
+  template
+   <  typename ITEM_TYPE
+    , typename DIAG_ITER_TYPE       // readable
+    , typename IN_VECT_ITER_TYPE    // readable and writable, input and output
+    , typename OUT_VECT_ITER_TYPE   // writable, output
+   >
+  void
+reduce_tridiagonal_partition
+ (  std::size_t         const  count             // rows in this partition, at least 3
+  , ITEM_TYPE           const  sub_diag_value    // value filling the sub-diagonal
+  , DIAG_ITER_TYPE             diag_vect         // main diagonal, not changed
+  , ITEM_TYPE           const  super_diag_value  // value filling the super-diagonal
+  , IN_VECT_ITER_TYPE          in_vect           // right-hand side, reduced in place
+  , OUT_VECT_ITER_TYPE         sub_out_vect      // coefficients of the first value
+  , OUT_VECT_ITER_TYPE         super_out_vect    // coefficients of the last value
+ )
+{
+    d_assert( count >= 3);
+
+    // The first two rows only need to be scaled.
+    // Row 0 keeps its sub-diagonal, which refers to the row before the partition.
+    // Row 1's sub-diagonal refers to row 0, the first row of the partition.
+    for ( std::size_t index = 0 ; index < 2 ; ++ index ) {
+        d_assert( 0 != diag_vect[ index ]);
+        sub_out_vect  [ index ]  = sub_diag_value   / diag_vect[ index ];
+        super_out_vect[ index ]  = super_diag_value / diag_vect[ index ];
+        in_vect       [ index ] /= diag_vect[ index ];
+    }
+
+    // Forward iteration. Eliminate the sub-diagonal, which leaves a column that refers to the
+    // first row. The super-diagonal still refers to the next row.
+    for ( std::size_t index = 2 ; index < count ; ++ index ) {
+        ITEM_TYPE const pivot = diag_vect[ index ] - (sub_diag_value * super_out_vect[ index - 1 ]);
+        d_assert( 0 != pivot);
+        in_vect       [ index ] = (in_vect[ index ] - (sub_diag_value * in_vect[ index - 1 ])) / pivot;
+        sub_out_vect  [ index ] = - (sub_diag_value * sub_out_vect[ index - 1 ]) / pivot;
+        super_out_vect[ index ] = super_diag_value / pivot;
+    }
+
+    // Backward iteration. Eliminate the super-diagonal, which leaves a column that refers to the
+    // last row. The last row keeps its super-diagonal, which refers to the row after the
+    // partition. And row (count - 2) already refers to the last row.
+    for ( std::size_t index = count - 3 ; index > 0 ; -- index ) {
+        ITEM_TYPE const scale = super_out_vect[ index ];
+        in_vect       [ index ] -= scale * in_vect       [ index + 1 ];
+        sub_out_vect  [ index ] -= scale * sub_out_vect  [ index + 1 ];
+        super_out_vect[ index ]  = - scale * super_out_vect[ index + 1 ];
+    }
+
+    // Row 0 refers to row 1. Replace that with the first and last rows.
+    {   ITEM_TYPE const scale = super_out_vect[ 0 ];
+        ITEM_TYPE const pivot = 1 - (scale * sub_out_vect[ 1 ]);
+        d_assert( 0 != pivot);
+        in_vect       [ 0 ] = (in_vect[ 0 ] - (scale * in_vect[ 1 ])) / pivot;
+        sub_out_vect  [ 0 ] = sub_out_vect[ 0 ] / pivot;
+        super_out_vect[ 0 ] = - (scale * super_out_vect[ 1 ]) / pivot;
+    }
+}
+
+  template
+   <  typename SUB_ITER_TYPE        // readable
+    , typename SUPER_ITER_TYPE      // readable and writable, used as temp storage
+    , typename IN_VECT_ITER_TYPE    // readable and writable, input and output
+   >
+  void
+solve_tridiagonal_unit_destructive
+ (  std::size_t         const  count             // number of items in each of the vectors below
+  , SUB_ITER_TYPE              sub_vect          // sub-diagonal, the first item is not used
+  , SUPER_ITER_TYPE            super_vect        // super-diagonal, the last item is not used
+  , IN_VECT_ITER_TYPE          in_vect           // right-hand side, replaced with the solution
+ )
+  // Solves a tridiagonal system with 1 in every diagonal position.
+  // The sub- and super-diagonals can vary.
+{
+    typedef typename std::iterator_traits< IN_VECT_ITER_TYPE >::value_type item_type;
+    d_assert( 0 < count);
+
+    // Forward iteration.
+    for ( std::size_t index = 1 ; index < count ; ++ index ) {
+        item_type const pivot = 1 - (sub_vect[ index ] * super_vect[ index - 1 ]);
+        d_assert( 0 != pivot);
+        super_vect[ index ] /= pivot;
+        in_vect   [ index ]  = (in_vect[ index ] - (sub_vect[ index ] * in_vect[ index - 1 ])) / pivot;
+    }
+
+    // Sweep backwards.
+    for ( std::size_t index = count - 1 ; index > 0 ; -- index ) {
+        in_vect[ index - 1 ] -= super_vect[ index - 1 ] * in_vect[ index ];
+    }
+}
+
+  template
+   <  typename ASSIGN_FUNCTOR_TYPE
+    , typename ITEM_TYPE
+    , typename COEF_ITER_TYPE       // readable, from reduce_tridiagonal_partition(..)
+    , typename IN_VECT_ITER_TYPE    // readable, from reduce_tridiagonal_partition(..)
+    , typename OUT_VECT_ITER_TYPE   // writable, output
+   >
+  void
+finish_tridiagonal_partition
+ (  ASSIGN_FUNCTOR_TYPE        assign_functor    // used to assign final value to out_vect
+  , std::size_t         const  count             // rows in this partition
+  , COEF_ITER_TYPE             sub_vect          // coefficients of the first value
+  , COEF_ITER_TYPE             super_vect        // coefficients of the last value
+  , IN_VECT_ITER_TYPE          in_vect           // reduced right-hand side
+  , ITEM_TYPE           const  first_value       // solved value of the first row
+  , ITEM_TYPE           const  last_value        // solved value of the last row
+  , OUT_VECT_ITER_TYPE         out_vect          // this partition of the vector to be solved
+ )
+{
+    d_assert( count >= 3);
+    assign_functor( *out_vect, first_value);
+    for ( std::size_t index = count - 2 ; index ; -- index ) {
+        ++ sub_vect;
+        ++ super_vect;
+        ++ in_vect;
+        ++ out_vect;
+        assign_functor
+         (  *out_vect
+          , (*in_vect) - ((*sub_vect) * first_value) - ((*super_vect) * last_value)
+         );
+    }
+    ++ out_vect;
+    assign_functor( *out_vect, last_value);
+}
+
 // _______________________________________________________________________________________________
 // solve_tridiagonal_destructive_extra_careful
 //  (  assign2_functor_type (2-param)
@@ -0,0 +1,184 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// uniform_scalar.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef UNIFORM_SCALAR_H
+# define UNIFORM_SCALAR_H
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// uniform_scalar< INT_INNER_T >
+//
+//   A signed integer that represents the interval -1<=x<1, so inner value n means
+//   n / 2^(bits-1). This is fixed point with no integer bits.
+//
+//   float is great if you're going to swing wildly to very large and very small numbers.
+//   But float is not uniform. It is very dense around zero and very sparse at the outer edges.
+//   If we limit some float values to [-1..1] we are throwing away the exponent bits, and accuracy
+//   near 1 is a lot less than accuracy near zero. A uniform scalar uses all its bits, spread
+//   evenly across the interval.
+//
+//   It cannot represent anything outside the interval, so all the arithmetic saturates: results
+//   that would be too big are clamped to the ends of the interval. +1 is not representable and
+//   becomes the largest value just under +1.
+//
+//   We assume >> on a negative signed integer is an arithmetic shift (it is on every compiler
+//   we build with, although the standard leaves it up to the implementation).
+//
+//   Improve: The other intervals (0<=x<1, 0<=x<2, -1<=x<=1) and a 1/x bit.
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+
+# include <cmath>
+# include <boost/cstdint.hpp>
+# include <boost/integer_traits.hpp>
+# include "debug.h"
+
+// _______________________________________________________________________________________________
+// uniform_scalar_traits< INT_INNER_T >
+//
+//   int_wide_type holds the product of two inner values, and the sum of a few such products.
+
+  template< typename INT_INNER_T >
+  struct
+uniform_scalar_traits
+  { /* only the specializations below are defined */ };
+
+  template< >
+  struct
+uniform_scalar_traits< boost::int16_t >
+  { typedef boost::int32_t  int_wide_type; };
+
+  template< >
+  struct
+uniform_scalar_traits< boost::int32_t >
+  { typedef boost::int64_t  int_wide_type; };
+
+// _______________________________________________________________________________________________
+// uniform_scalar< INT_INNER_T >
+
+  template< typename INT_INNER_T >
+  class
+uniform_scalar
+{
+  // -------------------------------------------------------------------------------------------
+  // Typedefs and constants
+  public:
+    typedef uniform_scalar< INT_INNER_T >        this_type      ;
+    typedef INT_INNER_T                          int_inner_type ;
+    typedef typename uniform_scalar_traits< int_inner_type >::int_wide_type
+                                                 int_wide_type  ;
+
+    enum { fraction_bit_count = (sizeof( int_inner_type) * 8) - 1 };
+
+    static int_inner_type get_int_inner_min( )  { return boost::integer_traits< int_inner_type >::const_min; }
+    static int_inner_type get_int_inner_max( )  { return boost::integer_traits< int_inner_type >::const_max; }
+
+    // 2^fraction_bit_count, the inner value that would be +1 if we could represent it.
+    static int_wide_type  get_int_wide_one( )   { return int_wide_type( 1) << fraction_bit_count; }
+
+  // -------------------------------------------------------------------------------------------
+  // Ctors
+  public:
+    /* ctor */          uniform_scalar( )                   : int_inner_value_( 0) { }
+    explicit            uniform_scalar( double real)        : int_inner_value_( convert_from_real( real)) { }
+
+    static this_type    from_inner( int_inner_type n)       { this_type v; v.int_inner_value_ = n; return v; }
+
+  // -------------------------------------------------------------------------------------------
+  // Getters
+  public:
+    int_inner_type      get_inner( )                  const { return int_inner_value_; }
+    double              get_real( )                   const { return double( int_inner_value_) / double( get_int_wide_one( )); }
+
+  // -------------------------------------------------------------------------------------------
+  // Conversions, rounded to nearest and saturated
+  public:
+    static int_inner_type
+                        convert_from_real( double real)     { double const scaled = std::floor( (real * double( get_int_wide_one( ))) + 0.5);
+                                                              if ( scaled <= double( get_int_inner_min( )) ) return get_int_inner_min( );
+                                                              if ( scaled >= double( get_int_inner_max( )) ) return get_int_inner_max( );
+                                                              return static_cast< int_inner_type >( scaled);
+                                                            }
+
+    static int_inner_type
+                        saturate( int_wide_type n)          { if ( n < int_wide_type( get_int_inner_min( )) ) return get_int_inner_min( );
+                                                              if ( n > int_wide_type( get_int_inner_max( )) ) return get_int_inner_max( );
+                                                              return static_cast< int_inner_type >( n);
+                                                            }
+
+    // (a * b) rounded back to the inner scale. Only (-1 * -1) saturates.
+    static int_inner_type
+                        multiply_inner( int_inner_type a, int_inner_type b)
+                                                            { int_wide_type const half = get_int_wide_one( ) >> 1;
+                                                              return saturate( ((int_wide_type( a) * b) + half) >> fraction_bit_count);
+                                                            }
+
+  // -------------------------------------------------------------------------------------------
+  // Saturating arithmetic
+  public:
+    this_type           operator +( this_type b)      const { return from_inner( saturate( int_wide_type( get_inner( )) + b.get_inner( ))); }
+    this_type           operator -( this_type b)      const { return from_inner( saturate( int_wide_type( get_inner( )) - b.get_inner( ))); }
+    this_type           operator *( this_type b)      const { return from_inner( multiply_inner( get_inner( ), b.get_inner( ))); }
+    this_type           operator -( )                 const { return from_inner( saturate( - int_wide_type( get_inner( )))); }
+
+    this_type &         operator +=( this_type b)           { return *this = *this + b; }
+    this_type &         operator -=( this_type b)           { return *this = *this - b; }
+    this_type &         operator *=( this_type b)           { return *this = *this * b; }
+
+  // -------------------------------------------------------------------------------------------
+  // Compare
+  public:
+    bool                operator ==( this_type b)     const { return get_inner( ) == b.get_inner( ); }
+    bool                operator !=( this_type b)     const { return get_inner( ) != b.get_inner( ); }
+    bool                operator < ( this_type b)     const { return get_inner( ) <  b.get_inner( ); }
+    bool                operator > ( this_type b)     const { return get_inner( ) >  b.get_inner( ); }
+    bool                operator <=( this_type b)     const { return get_inner( ) <= b.get_inner( ); }
+    bool                operator >=( this_type b)     const { return get_inner( ) >= b.get_inner( ); }
+
+  // -------------------------------------------------------------------------------------------
+  // Member var
+  private:
+    int_inner_type  int_inner_value_ ;
+
+}; /* end class uniform_scalar */
+
+// _______________________________________________________________________________________________
+
+typedef uniform_scalar< boost::int16_t >  uniform_scalar_16_type ;
+typedef uniform_scalar< boost::int32_t >  uniform_scalar_32_type ;
+
+// The sheets are stored as the bare inner values, so the vector kernels can treat them as ints.
+d_static_assert( sizeof( uniform_scalar_16_type) == sizeof( boost::int16_t));
+d_static_assert( sizeof( uniform_scalar_32_type) == sizeof( boost::int32_t));
+
+// Overload of to_real(..) (see value_sheet.h).
+  template< typename INT_INNER_T >
+  inline
+  double
+to_real( uniform_scalar< INT_INNER_T > const & v)
+{
+    return v.get_real( );
+}
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef UNIFORM_SCALAR_H
+//
+// uniform_scalar.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
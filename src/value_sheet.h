@@ -0,0 +1,438 @@
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// value_sheet.h
+//
+//   Copyright (c) Neal Binnendyk 2009, 2010.
+//     <nealabq@gmail.com>
+//     <http://nealabq.com/>
+//
+//   |=== GPL License Notice ====================================================================|
+//   | This code is free software: you can redistribute it and/or modify it under the terms      |
+//   | of the GNU General Public License as published by the Free Software Foundation, either    |
+//   | version 3 of the License, or (at your option) any later version.                          |
+//   |                                                                                           |
+//   | This code is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;    |
+//   | without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. |
+//   | See the GNU General Public License for more details: <http://www.gnu.org/licenses/>       |
+//   |=== END License Notice ====================================================================|
+//
+# pragma once
+# ifndef VALUE_SHEET_H
+# define VALUE_SHEET_H
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+// value_sheet_type< VALUE_TYPE >
+//
+//   A sheet of any value type (double for example). This is only the part of sheet_type that
+//   the solver uses, so the solver can be instantiated on it. sheet_type is still the sheet
+//   the rest of the program (drawing, xml, the sheet transforms) uses, so this also copies
+//   values to and from a sheet_type.
+//
+//   It would be nicer if sheet_type itself was a template. But the drawing code and all the
+//   sheet transforms assume float, and they'd all have to be templates too.
+//
+//   VALUE_TYPE does not have to be a built-in number. It only needs:
+//     VALUE_TYPE( double)  - convert from a real (explicit is fine)
+//     to_real( v)          - convert to a real (overload the template below)
+//   and for the solver (or min/max and normalize) the arithmetic and compare operators.
+
+# include <algorithm>
+
+# include "sheet.h"
+# include "line_walker.h"
+
+// _______________________________________________________________________________________________
+// to_real( v)
+//
+//   Converts a sheet value to a built-in real type. Overload this for value types that are not
+//   built-in numbers (see uniform_scalar.h).
+
+  template< typename VALUE_TYPE >
+  inline
+  VALUE_TYPE
+to_real( VALUE_TYPE v)
+{
+    return v;
+}
+
+// _______________________________________________________________________________________________
+
+  template< typename VALUE_TYPE >
+  class
+value_sheet_type
+{
+  // -------------------------------------------------------------------------------------------
+  // Private Typedef
+  private:
+    typedef value_sheet_type< VALUE_TYPE >       this_type           ;
+
+  // -------------------------------------------------------------------------------------------
+  // Std collection typedefs
+  public:
+    typedef VALUE_TYPE                           value_type          ;
+    typedef std::vector< value_type >            inner_type          ;
+
+    typedef typename inner_type::size_type       size_type           ;
+    typedef typename inner_type::difference_type difference_type     ;
+    typedef typename inner_type::iterator        iterator            ;
+    typedef typename inner_type::const_iterator  const_iterator      ;
+
+  // -------------------------------------------------------------------------------------------
+  // 2D iterator types
+  public:
+    typedef difference_type                      diff_type           ;
+
+    typedef const_iterator                       inner_const_iter    ;
+    typedef iterator                             inner_varia_iter    ;
+
+    typedef stride_range< inner_varia_iter, 1 >  yx_varia_range_type ;
+    typedef stride_range< inner_varia_iter, 1 >  xy_varia_range_type ;
+    typedef stride_range< inner_const_iter, 1 >  yx_const_range_type ;
+    typedef stride_range< inner_const_iter, 1 >  xy_const_range_type ;
+
+    typedef stride_range< inner_varia_iter, 0 >  x_varia_range_type  ;
+    typedef stride_range< inner_const_iter, 0 >  x_const_range_type  ;
+    typedef stride_iter<  inner_varia_iter, 1 >  yx_varia_iter_type  ;
+    typedef stride_iter<  inner_const_iter, 1 >  yx_const_iter_type  ;
+
+  // -------------------------------------------------------------------------------------------
+  // Ctors and dtor
+  public:
+    /* ctor */          value_sheet_type( )                 : x_count_ ( size_type( 0))
+                                                            , y_count_ ( size_type( 0))
+                                                            , array_   ( )
+                                                            { }
+    /* default copy ctor and ass-op */
+
+  // -------------------------------------------------------------------------------------------
+  // Reset
+  public:
+    bool                is_reset( )                   const { return 0 == get_x_count( ); }
+    bool                not_reset( )                  const { return ! is_reset( ); }
+    void                reset( )                            ;
+
+  // -------------------------------------------------------------------------------------------
+  // Size and fill
+  public:
+    bool                set_xy_counts
+                         (  size_type   x_count
+                          , size_type   y_count
+                          , value_type  init_value
+                         )                                  ;
+    bool                fill_sheet( value_type v)           { if ( is_reset( ) ) return false;
+                                                              std::fill( begin( ), end( ), v);
+                                                              return true;
+                                                            }
+
+  // -------------------------------------------------------------------------------------------
+  // Min/max and normalize, used to pull an exploding sheet back in bounds.
+  public:
+    bool                get_min_max_values
+                         (  value_type &  return_min_value
+                          , value_type &  return_max_value
+                         )                            const ;
+    bool                normalize
+                         (  value_type  trg_lo
+                          , value_type  trg_hi
+                         )                                  ;
+
+  // -------------------------------------------------------------------------------------------
+  // Copy to and from a (float) sheet_type
+  public:
+    void                copy_from( sheet_type const &)      ;
+    void                copy_to( sheet_type &)        const ;
+
+    // True if the values here, rounded to sheet_type values, are exactly the values in the sheet.
+    bool                is_rounded_same( sheet_type const &)
+                                                      const ;
+
+  // -------------------------------------------------------------------------------------------
+  // Copy between sheets of different sizes, like sheet_type::copy_preserve_heights(..)
+  public:
+    static bool         copy_preserve_heights
+                         (  this_type const &  src_sheet
+                          , this_type       &  trg_sheet
+                         )                                  ;
+
+  // -------------------------------------------------------------------------------------------
+  // Iterators and ranges
+  public:
+    const_iterator      begin( )                      const { return array_.begin( ); }
+    iterator            begin( )                            { return array_.begin( ); }
+    const_iterator      end( )                        const { return array_.end( ); }
+    iterator            end( )                              { return array_.end( ); }
+
+    diff_type           get_x_stride( )               const { return 1; }
+    diff_type           get_y_stride( )               const { return static_cast< diff_type >( get_x_count( )); }
+
+    xy_varia_range_type get_range_xy( )                     { return xy_varia_range_type(
+                                                                get_x_count( ), get_x_stride( ),
+                                                                get_y_count( ), get_y_stride( ),
+                                                                begin( ));
+                                                            }
+    xy_const_range_type get_range_xy( )               const { return xy_const_range_type(
+                                                                get_x_count( ), get_x_stride( ),
+                                                                get_y_count( ), get_y_stride( ),
+                                                                begin( ));
+                                                            }
+    yx_varia_range_type get_range_yx( )                     { return yx_varia_range_type(
+                                                                get_y_count( ), get_y_stride( ),
+                                                                get_x_count( ), get_x_stride( ),
+                                                                begin( ));
+                                                            }
+    yx_const_range_type get_range_yx( )               const { return yx_const_range_type(
+                                                                get_y_count( ), get_y_stride( ),
+                                                                get_x_count( ), get_x_stride( ),
+                                                                begin( ));
+                                                            }
+
+  // -------------------------------------------------------------------------------------------
+  // Getters for dimensions
+  public:
+    size_type           get_x_count( )                const { return x_count_; }
+    size_type           get_y_count( )                const { return y_count_; }
+    size_type           get_xy_count( )               const { return get_x_count( ) * get_y_count( ); }
+
+  // -------------------------------------------------------------------------------------------
+  // Member vars
+  private:
+    size_type   x_count_ ;
+    size_type   y_count_ ;
+    inner_type  array_   ;
+
+}; /* end class value_sheet_type */
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Reset and size
+
+  template< typename VALUE_TYPE >
+  void
+  value_sheet_type< VALUE_TYPE >::
+reset( )
+{
+    if ( not_reset( ) ) {
+        x_count_ = size_type( 0);
+        y_count_ = size_type( 0);
+
+        // Run the dtor to actually free the memory (see sheet_type::reset( )).
+        util::apply_dtor( & array_);
+        util::apply_default_ctor( & array_);
+    }
+    d_assert( is_reset( ));
+}
+
+  template< typename VALUE_TYPE >
+  bool
+  value_sheet_type< VALUE_TYPE >::
+set_xy_counts( size_type x_count, size_type y_count, value_type init_value)
+{
+    // It's not legal to ask for a zero and non-zero dimension together.
+    if ( (x_count && ! y_count) || (y_count && ! x_count) ) {
+        d_assert( false);
+        return false;
+    }
+
+    if ( (x_count != get_x_count( )) || (y_count != get_y_count( )) ) {
+        reset( );
+        if ( x_count && y_count ) {
+            x_count_ = x_count;
+            y_count_ = y_count;
+            array_.resize( get_xy_count( ));
+        }
+    }
+    fill_sheet( init_value);
+    return true;
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Min/max and normalize
+
+  template< typename VALUE_TYPE >
+  bool
+  value_sheet_type< VALUE_TYPE >::
+get_min_max_values
+ (  value_type &  return_min_value
+  , value_type &  return_max_value
+ ) const
+{
+    if ( is_reset( ) ) return false;
+
+    value_type min_value = *begin( );
+    value_type max_value = *begin( );
+    for ( const_iterator iter = begin( ) ; iter != end( ) ; ++ iter ) {
+        if ( *iter < min_value ) { min_value = *iter; }
+        if ( *iter > max_value ) { max_value = *iter; }
+    }
+    return_min_value = min_value;
+    return_max_value = max_value;
+    return true;
+}
+
+  template< typename VALUE_TYPE >
+  bool
+  value_sheet_type< VALUE_TYPE >::
+normalize( value_type trg_lo, value_type trg_hi)
+  //
+  // Same as sheet_type::normalize( trg_lo, trg_hi).
+{
+    value_type src_lo = 0;
+    value_type src_hi = 0;
+    if ( ! get_min_max_values( src_lo, src_hi) ) return false;
+
+    if ( (trg_lo == trg_hi) || (src_lo == src_hi) ) {
+        return fill_sheet( (trg_lo + trg_hi) / 2);
+    }
+
+    value_type const trg_src_ratio = (trg_hi - trg_lo) / (src_hi - src_lo);
+    for ( iterator iter = begin( ) ; iter != end( ) ; ++ iter ) {
+        *iter = ((*iter - src_lo) * trg_src_ratio) + trg_lo;
+    }
+    return true;
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Copy to and from sheet_type
+
+  template< typename VALUE_TYPE >
+  void
+  value_sheet_type< VALUE_TYPE >::
+copy_from( sheet_type const & src_sheet)
+{
+    if ( src_sheet.is_reset( ) ) {
+        reset( );
+    } else {
+        d_verify( set_xy_counts( src_sheet.get_x_count( ), src_sheet.get_y_count( ), value_type( 0)));
+        iterator trg_iter = begin( );
+        for ( sheet_type::const_iterator iter = src_sheet.begin( ) ; iter != src_sheet.end( ) ; ++ iter, ++ trg_iter ) {
+            *trg_iter = value_type( *iter);
+        }
+    }
+}
+
+  template< typename VALUE_TYPE >
+  void
+  value_sheet_type< VALUE_TYPE >::
+copy_to( sheet_type & trg_sheet) const
+{
+    if ( is_reset( ) ) {
+        trg_sheet.reset( );
+        return;
+    }
+
+    if ( (trg_sheet.get_x_count( ) != get_x_count( )) || (trg_sheet.get_y_count( ) != get_y_count( )) ) {
+        d_verify( trg_sheet.set_xy_counts_raw_values( get_x_count( ), get_y_count( )));
+    }
+    sheet_type::iterator trg_iter = trg_sheet.begin( );
+    for ( const_iterator iter = begin( ) ; iter != end( ) ; ++ iter, ++ trg_iter ) {
+        *trg_iter = static_cast< sheet_type::value_type >( to_real( *iter));
+    }
+}
+
+  template< typename VALUE_TYPE >
+  bool
+  value_sheet_type< VALUE_TYPE >::
+is_rounded_same( sheet_type const & sheet) const
+  //
+  // Usually the answer is no after looking at the first few values.
+{
+    if ( (sheet.get_x_count( ) != get_x_count( )) || (sheet.get_y_count( ) != get_y_count( )) ) {
+        return false;
+    }
+    sheet_type::const_iterator iter = sheet.begin( );
+    for ( const_iterator this_iter = begin( ) ; this_iter != end( ) ; ++ this_iter, ++ iter ) {
+        if ( static_cast< sheet_type::value_type >( to_real( *this_iter)) != *iter ) return false;
+    }
+    return true;
+}
+
+// _______________________________________________________________________________________________
+// _______________________________________________________________________________________________
+// Copy with line_walker_type
+//
+//   This is copy_preserve_heights_assign_functor from sheet.cpp, for any value_sheet_type.
+
+  template< typename SHEET_TYPE >
+  struct
+value_sheet_copy_preserve_heights_functor
+{
+    typedef typename SHEET_TYPE::size_type           size_type          ;
+    typedef typename SHEET_TYPE::value_type          value_type         ;
+    typedef typename SHEET_TYPE::yx_const_iter_type  yx_const_iter_type ;
+    typedef typename SHEET_TYPE::yx_varia_iter_type  yx_varia_iter_type ;
+    typedef typename SHEET_TYPE::x_const_range_type  x_const_range_type ;
+    typedef typename SHEET_TYPE::x_varia_range_type  x_varia_range_type ;
+
+    /* functor function (for line_walker_type copy templates) */
+    void
+  operator ()
+   (  line_walker_type   const &  walker
+    , yx_const_iter_type const &  src_yx_iter
+    , yx_varia_iter_type const &  trg_yx_iter
+    , bool                     /* is_new_src */
+    , bool                        is_new_trg
+   )
+    {   x_const_range_type const  src_x_range  = *src_yx_iter;
+        x_varia_range_type const  trg_x_range  = *trg_yx_iter;
+        size_type          const  src_x_count  = src_x_range.get_count( );
+        size_type          const  trg_x_count  = trg_x_range.get_count( );
+
+        if ( walker.is_trg_width_fully_covered( ) ) {
+            d_verify( is_new_trg ?
+              line_walker_type::copy_preserve_area(       src_x_range.get_iter_lo( ), src_x_count, trg_x_range.get_iter_lo( ), trg_x_count) :
+              line_walker_type::accumulate_preserve_area( src_x_range.get_iter_lo( ), src_x_count, trg_x_range.get_iter_lo( ), trg_x_count) );
+        } else
+        /* we have to scale */ {
+            value_type const scale_factor = walker.template get_trg_overlap_ratio< value_type >( );
+            d_verify( is_new_trg ?
+              line_walker_type::scaled_copy_preserve_area(       scale_factor, src_x_range.get_iter_lo( ), src_x_count, trg_x_range.get_iter_lo( ), trg_x_count) :
+              line_walker_type::scaled_accumulate_preserve_area( scale_factor, src_x_range.get_iter_lo( ), src_x_count, trg_x_range.get_iter_lo( ), trg_x_count) );
+        }
+    }
+
+    /* functor function (for line_walker_type copy templates) */
+    void
+  operator ()
+   (  yx_const_iter_type const &  src_yx_iter
+    , yx_varia_iter_type const &  trg_yx_iter
+   )
+    {   x_const_range_type const  src_x_range  = *src_yx_iter;
+        x_varia_range_type const  trg_x_range  = *trg_yx_iter;
+        line_walker_type::copy_preserve_area
+         (  src_x_range.get_iter_lo( ), src_x_range.get_count( )
+          , trg_x_range.get_iter_lo( ), trg_x_range.get_count( )
+         );
+    }
+};
+
+  /* static method */
+  template< typename VALUE_TYPE >
+  bool
+  value_sheet_type< VALUE_TYPE >::
+copy_preserve_heights
+ (  this_type const &  src_sheet
+  , this_type       &  trg_sheet
+ )
+{
+    if ( src_sheet.is_reset( ) && trg_sheet.is_reset( ) ) return true;
+    if ( src_sheet.is_reset( ) || trg_sheet.is_reset( ) ) return false;
+
+    yx_const_range_type  src_range  = src_sheet.get_range_yx( );
+    yx_varia_range_type  trg_range  = trg_sheet.get_range_yx( );
+    return
+      line_walker_type::copy
+       (  value_sheet_copy_preserve_heights_functor< this_type >( )
+        , src_range.get_iter_lo( ), src_range.get_count( )
+        , trg_range.get_iter_lo( ), trg_range.get_count( )
+       );
+}
+
+// _______________________________________________________________________________________________
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+# endif // ifndef VALUE_SHEET_H
+//
+// value_sheet.h - End of File
+// _______________________________________________________________________________________________
+// |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||